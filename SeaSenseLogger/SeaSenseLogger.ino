@@ -22,6 +22,8 @@
 #include <ArduinoJson.h>
 #include <time.h>
 #include <esp_ota_ops.h>
+#include <esp_heap_caps.h>
+#include <atomic>
 
 // Configuration
 #include "config/hardware_config.h"
@@ -31,15 +33,23 @@
 // Sensors
 #include "src/sensors/SensorInterface.h"
 #include "src/sensors/EZOSensor.h"
-#include "src/sensors/EZO_RTD.h"
-#include "src/sensors/EZO_EC.h"
-#include "src/sensors/EZO_pH.h"
-#include "src/sensors/EZO_DO.h"
+#include "src/sensors/WaterSensors.h"
 #include "src/sensors/GPSModule.h"
 #include "src/sensors/NMEA2000GPS.h"
 #include "src/sensors/NMEA2000Environment.h"
 #include "src/sensors/BNO085Module.h"
+#include "src/sensors/CompensationManager.h"
+#include "src/sensors/QualityControl.h"
+#include "src/sensors/DerivedVariables.h"
 #include "src/sensors/WindCorrection.h"
+#include "src/sensors/ReadCoalescer.h"
+
+// NMEA2000 output
+#include "src/n2k/N2kTxScheduler.h"
+#include "src/n2k/N2kWaterQualityEmitter.h"
+
+// Live data broadcast
+#include "src/broadcast/UdpBroadcaster.h"
 
 // Storage
 #include "src/storage/StorageInterface.h"
@@ -70,20 +80,69 @@
 
 // System Health (watchdog, boot loop protection, error tracking)
 #include "src/system/SystemHealth.h"
+#include "src/system/PowerManager.h"
+#include "src/system/RecoveryManager.h"
+#include "src/system/TimeService.h"
+#include "src/system/EventLog.h"
+#include "src/system/FlightRecorder.h"
+
+// Input capture (raw GPS/CAN/IMU streams to SD for host replay)
+#include "src/replay/CaptureRecorder.h"
 
 // ============================================================================
 // Global Variables
 // ============================================================================
 
-// Sensors
-EZO_RTD tempSensor;
-EZO_EC ecSensor;
-EZO_pH phSensor;
-EZO_DO doSensor;
+// Water sensors: the compile-time list in WaterSensors.h. pH and DO are
+// nullptr when compiled out (FEATURE_PH / FEATURE_DO)
+WaterSensors waterSensors;
+EZO_RTD& tempSensor = waterSensors.get<EZO_RTD>();
+EZO_EC& ecSensor = waterSensors.get<EZO_EC>();
+EZO_pH* const phSensor = waterSensors.find<EZO_pH>();
+EZO_DO* const doSensor = waterSensors.find<EZO_DO>();
 GPSModule gps(GPS_RX_PIN, GPS_TX_PIN);
+
+// Optional subsystems. Without the feature only the declaration remains, so
+// uses inside `if constexpr (FEATURE_X)` still compile but are never linked
+#if FEATURE_N2K
 NMEA2000GPS n2kGPS;
 NMEA2000Environment n2kEnv;
+
+// Outbound PGNs: the emitter decides what is due, the scheduler paces the bus
+N2kTxScheduler n2kTx(&n2kGPS);
+N2kWaterQualityEmitter n2kEmitter(&n2kTx);
+#else
+extern NMEA2000GPS n2kGPS;
+extern NMEA2000Environment n2kEnv;
+extern N2kTxScheduler n2kTx;
+extern N2kWaterQualityEmitter n2kEmitter;
+#endif
+
+#if FEATURE_IMU
 BNO085Module imu;
+#else
+extern BNO085Module imu;
+#endif
+
+// Each measurement cycle as UDP broadcasts (one send per interface, any number of listeners)
+#if FEATURE_UDP_LIVE
+UdpBroadcaster udpLive(UDP_LIVE_NMEA_PORT, UDP_LIVE_BINARY_PORT);
+#else
+extern UdpBroadcaster udpLive;
+#endif
+
+// Only re-send T/S/P compensation when it has moved
+CompensationManager compensation(&ecSensor, phSensor, doSensor);
+
+// Web sensor reads share one acquisition (and the measurement cycle's)
+ReadCoalescer sensorReads(SENSOR_READ_FRESH_MS);
+
+// QARTOD-style QC flags for every logged measurement
+QualityControl qualityControl;
+std::atomic<uint8_t> qcResetMask(0);    // 1 << QcChannel; set by the web task, applied in loop()
+
+// DO saturation, sound speed and true wind, stamped on every record
+DerivedVariables derivedVars;
 
 // Storage
 StorageManager storage(SPIFFS_CIRCULAR_BUFFER_SIZE, SD_CS_PIN);
@@ -92,13 +151,13 @@ StorageManager storage(SPIFFS_CIRCULAR_BUFFER_SIZE, SD_CS_PIN);
 ConfigManager configManager;
 
 // Calibration
-CalibrationManager calibration(&tempSensor, &ecSensor, &phSensor, &doSensor);
+CalibrationManager calibration(&tempSensor, &ecSensor, phSensor, doSensor);
 
 // Pump controller
 PumpController pumpController(&tempSensor, &ecSensor);
 
 // Web server
-SeaSenseWebServer webServer(&tempSensor, &ecSensor, &storage, &calibration, &pumpController, &configManager, &phSensor, &doSensor);
+SeaSenseWebServer webServer(&tempSensor, &ecSensor, &storage, &calibration, &pumpController, &configManager, phSensor, doSensor);
 
 // API Uploader
 APIUploader apiUploader(&storage);
@@ -107,11 +166,34 @@ APIUploader apiUploader(&storage);
 SerialCommands serialCommands(&tempSensor, &ecSensor, &gps, &storage, &apiUploader, &webServer, &pumpController);
 
 // OTA Manager (for backend-triggered updates)
+#if FEATURE_OTA
 OTAManager otaManager;
+#else
+extern OTAManager otaManager;
+#endif
 
 // System Health
 SystemHealth systemHealth;
 
+// Power Manager (light sleep + frequency scaling between cycles)
+PowerManager powerManager;
+
+// Recovery Manager (graduated per-subsystem recovery)
+RecoveryManager recoveryManager;
+
+// Time Service (64-bit monotonic clock disciplined from GPS/N2K/NTP)
+TimeService timeService;
+
+// Event log (LOG_* ring, written out by logDrainTask)
+EventLog eventLog;
+
+// Flight recorder (RTC memory: loop stages, heap and warnings across a crash)
+RTC_NOINIT_ATTR FlightRecord g_flightRecord;
+FlightRecorder flightRecorder(g_flightRecord);
+
+// Input capture (started/stopped with the CAPTURE serial command)
+CaptureRecorder captureRecorder;
+
 // Device configuration
 JsonDocument deviceConfigDoc;
 bool configLoaded = false;
@@ -121,6 +203,7 @@ unsigned long sensorSamplingIntervalMs = 900000;  // Default 15 minutes
 bool skipMeasurementIfStationary = false;
 float stationaryDeltaMeters = 100.0f;
 bool nmeaOutputEnabled = false;  // outbound PGN emission gate (default off)
+volatile bool n2kResetRequested = false;  // set by the web task, consumed in loop()
 
 // Last persisted measurement position (for movement gating)
 bool hasLastMeasurementGPS = false;
@@ -136,14 +219,18 @@ portMUX_TYPE g_timerMux = portMUX_INITIALIZER_UNLOCKED;
 // Mutex for I2C bus access (web sensor reads vs loop reads)
 SemaphoreHandle_t g_i2cMutex = NULL;
 
-// System epoch for calibration age checks (updated from GPS when fix available)
-time_t g_systemEpoch = 0;
-
 // Breadcrumbs for runtime diagnostics (/api/status)
 volatile unsigned long g_lastLoopStartMs = 0;
 volatile unsigned long g_maxLoopGapMs = 0;
+unsigned long g_lastIdleMs = 0;     // planned sleep/yield ending the previous loop()
 const char* g_loopStage = "boot";
 
+// Breadcrumb for /api/status and the flight recorder (stage must be a literal)
+void setLoopStage(const char* stage) {
+    g_loopStage = stage;
+    flightRecorder.stage(stage, millis());
+}
+
 // ============================================================================
 // Device Configuration Functions
 // ============================================================================
@@ -217,15 +304,7 @@ bool updateSensorCalibration(
     if (!configLoaded) return false;
 
     // Build ISO 8601 timestamp
-    String timestamp = "";
-    if (g_systemEpoch > 0) {
-        struct tm* t = gmtime(&g_systemEpoch);
-        char buf[25];
-        snprintf(buf, sizeof(buf), "%04d-%02d-%02dT%02d:%02d:%02dZ",
-                 t->tm_year + 1900, t->tm_mon + 1, t->tm_mday,
-                 t->tm_hour, t->tm_min, t->tm_sec);
-        timestamp = String(buf);
-    }
+    String timestamp = timeService.nowUTC(millis());
 
     // Find sensor in deviceConfigDoc and append calibration entry
     JsonArray sensors = deviceConfigDoc["sensors"].as<JsonArray>();
@@ -238,11 +317,15 @@ bool updateSensorCalibration(
             if (calibrationValue != 0) entry["value"] = calibrationValue;
             if (note.length() > 0)     entry["note"]  = note;
 
-            // Update in-memory calibration date on the matching sensor object
-            if      (sensorType == "Temperature")        tempSensor.setCalibrationDate(timestamp);
-            else if (sensorType == "Conductivity")       ecSensor.setCalibrationDate(timestamp);
-            else if (sensorType == "pH")                 phSensor.setCalibrationDate(timestamp);
-            else if (sensorType == "Dissolved Oxygen")   doSensor.setCalibrationDate(timestamp);
+            // Update in-memory calibration date on the matching sensor object;
+            // readings shift with a new calibration, so QC history starts over
+            waterSensors.forEach([&](auto& probe) {
+                using Traits = SensorTraits<std::decay_t<decltype(probe)>>;
+                if (sensorType == Traits::TYPE) {
+                    probe.setCalibrationDate(timestamp);
+                    qcResetMask.fetch_or(1 << (uint8_t)Traits::QC);
+                }
+            });
 
             // Persist to SPIFFS
             saveDeviceConfig();
@@ -323,41 +406,45 @@ bool isSensorEnabled(const String& sensorType) {
 
 // GPS source: prefer NMEA2000 network, fall back to onboard NEO-6M
 bool activeGPSHasValidFix() {
-    if (n2kGPS.hasValidFix()) return true;
+    if constexpr (FEATURE_N2K) {
+        if (n2kGPS.hasValidFix()) return true;
+    }
     return gps.hasValidFix();
 }
 
+// True when the fix comes from the NMEA2000 network
+bool activeGPSIsN2K() {
+    if constexpr (FEATURE_N2K) {
+        return n2kGPS.hasValidFix();
+    }
+    return false;
+}
+
 GPSData activeGPSGetData() {
-    if (n2kGPS.hasValidFix()) return n2kGPS.getData();
+    if constexpr (FEATURE_N2K) {
+        if (n2kGPS.hasValidFix()) return n2kGPS.getData();
+    }
     return gps.getData();
 }
 
 String activeGPSGetTimeUTC() {
-    if (n2kGPS.hasValidFix()) return n2kGPS.getTimeUTC();
+    if constexpr (FEATURE_N2K) {
+        if (n2kGPS.hasValidFix()) return n2kGPS.getTimeUTC();
+    }
     return gps.getTimeUTC();
 }
 
 unsigned long activeGPSGetAgeMs() {
-    if (n2kGPS.hasValidFix()) return n2kGPS.getAgeMs();
+    if constexpr (FEATURE_N2K) {
+        if (n2kGPS.hasValidFix()) return n2kGPS.getAgeMs();
+    }
     return gps.getAgeMs();
 }
 
-// Best available UTC timestamp: GPS first, then NTP, then empty
+// UTC timestamp from the time service (GPS/N2K first, then NTP), empty
+// before the first sync; such records get back-filled once it arrives
 String getSystemTimeUTC() {
-    String gpsTime = activeGPSGetTimeUTC();
-    if (gpsTime.length() > 0) return gpsTime;
-
-    // NTP-synced system clock (available after WiFi connects and APIUploader syncs)
-    time_t now = time(nullptr);
-    if (now > 1000000000UL) {
-        struct tm timeinfo;
-        gmtime_r(&now, &timeinfo);
-        char buf[25];
-        strftime(buf, sizeof(buf), "%Y-%m-%dT%H:%M:%SZ", &timeinfo);
-        return String(buf);
-    }
-
-    return "";
+    return timeService.nowUTC(millis());
 }
 
 // ============================================================================
@@ -365,7 +452,9 @@ String getSystemTimeUTC() {
 // ============================================================================
 
 void n2kMsgForward(const tN2kMsg& msg) {
-    n2kEnv.handleMsg(msg);
+    if constexpr (FEATURE_N2K) {
+        n2kEnv.handleMsg(msg);
+    }
 }
 
 // ============================================================================
@@ -377,7 +466,22 @@ void webServerTask(void* pvParameters) {
     for (;;) {
         webServer.handleClient();
         webServer.checkWiFiReconnect();
-        vTaskDelay(1);  // 1ms yield — ~1000 handle cycles/sec
+        // 1ms while someone is on the AP, otherwise a slower poll so the
+        // core can idle at a scaled-down clock
+        vTaskDelay(pdMS_TO_TICKS(powerManager.getWebPollMs()));
+    }
+}
+
+// ============================================================================
+// Log Drain Task (Core 0)
+// Formats LOG_* events and writes them to serial/SD, so loop() never waits
+// on the UART.
+// ============================================================================
+
+void logDrainTask(void* pvParameters) {
+    for (;;) {
+        eventLog.drain(LOG_DRAIN_BATCH, storage.isSDMounted());
+        vTaskDelay(pdMS_TO_TICKS(LOG_DRAIN_INTERVAL_MS));
     }
 }
 
@@ -394,6 +498,9 @@ void setup() {
     Serial.println("   SeaSense Logger - Starting Up");
     Serial.println("===========================================");
 
+    // Start the log drain first: LOG_* events queue until it runs
+    xTaskCreatePinnedToCore(logDrainTask, "LogDrain", LOG_TASK_STACK_SIZE, NULL, LOG_TASK_PRIORITY, NULL, 0);
+
     // Initialize LED
     pinMode(LED_PIN, OUTPUT);
     digitalWrite(LED_PIN, HIGH);
@@ -401,6 +508,10 @@ void setup() {
     // Initialize system health (watchdog + boot loop detection)
     systemHealth.begin(WDT_TIMEOUT_MS, BOOT_LOOP_THRESHOLD, BOOT_LOOP_WINDOW_MS);
 
+    // Keep what the last boot was doing before it went down, then start recording
+    flightRecorder.begin(systemHealth.getRebootCount(), FIRMWARE_VERSION);
+    eventLog.setWarningHook([](const LogEntry& e) { flightRecorder.recordLog(e); });
+
     // Safe mode detection: if boot loop detected, skip non-essential subsystems
     if (systemHealth.isInSafeMode()) {
         Serial.println();
@@ -480,53 +591,54 @@ void setup() {
         Serial.println("[SENSORS] Conductivity sensor disabled by config");
     }
 
-    if (phSensor.begin()) {
-        Serial.println("[SENSORS] EZO-pH sensor initialized");
-        Serial.print("[SENSORS] - Serial: ");
-        Serial.println(phSensor.getSerialNumber());
-        Serial.print("[SENSORS] - Calibration: ");
-        Serial.println(phSensor.getLastCalibrationDate());
-    } else {
-        phSensor.setEnabled(false);  // Prevent blocking read attempts on missing sensor
-        Serial.println("[SENSORS] EZO-pH not detected - disabled");
+    if constexpr (FEATURE_PH) {
+        if (phSensor->begin()) {
+            Serial.println("[SENSORS] EZO-pH sensor initialized");
+            Serial.print("[SENSORS] - Serial: ");
+            Serial.println(phSensor->getSerialNumber());
+            Serial.print("[SENSORS] - Calibration: ");
+            Serial.println(phSensor->getLastCalibrationDate());
+        } else {
+            phSensor->setEnabled(false);  // Prevent blocking read attempts on missing sensor
+            Serial.println("[SENSORS] EZO-pH not detected - disabled");
+        }
     }
 
-    if (doSensor.begin()) {
-        Serial.println("[SENSORS] EZO-DO Dissolved Oxygen sensor initialized");
-        Serial.print("[SENSORS] - Serial: ");
-        Serial.println(doSensor.getSerialNumber());
-        Serial.print("[SENSORS] - Calibration: ");
-        Serial.println(doSensor.getLastCalibrationDate());
-    } else {
-        doSensor.setEnabled(false);  // Prevent blocking read attempts on missing sensor
-        Serial.println("[SENSORS] EZO-DO not detected - disabled");
+    if constexpr (FEATURE_DO) {
+        if (doSensor->begin()) {
+            Serial.println("[SENSORS] EZO-DO Dissolved Oxygen sensor initialized");
+            Serial.print("[SENSORS] - Serial: ");
+            Serial.println(doSensor->getSerialNumber());
+            Serial.print("[SENSORS] - Calibration: ");
+            Serial.println(doSensor->getLastCalibrationDate());
+        } else {
+            doSensor->setEnabled(false);  // Prevent blocking read attempts on missing sensor
+            Serial.println("[SENSORS] EZO-DO not detected - disabled");
+        }
     }
 
+    // Learned stability noise floors (NVS already initialised by SystemHealth)
+    calibration.begin();
+
     // Boot-time EZO ↔ SPIFFS calibration consistency check
     // EZO sensor is the truth for "is it calibrated"; SPIFFS is the history store.
     Serial.println("\n[CONFIG] Checking EZO calibration vs SPIFFS history...");
-    struct CalCheck { EZOSensor* sensor; const char* type; const char* label; };
-    CalCheck calChecks[] = {
-        { &tempSensor, "Temperature", "EZO-RTD" },
-        { &ecSensor,   "Conductivity", "EZO-EC" },
-        { &phSensor,   "pH", "EZO-pH" },
-        { &doSensor,   "Dissolved Oxygen", "EZO-DO" }
-    };
-    for (auto& chk : calChecks) {
-        if (!chk.sensor->isEnabled()) continue;
-        int pts = chk.sensor->getCalibrationPoints();
-        if (pts < 0) continue;  // sensor not responding
-        JsonObject meta = getSensorMetadata(chk.type);
+    waterSensors.forEach([](auto& probe) {
+        using Traits = SensorTraits<std::decay_t<decltype(probe)>>;
+        if (!probe.isEnabled()) return;
+        int pts = probe.getCalibrationPoints();
+        if (pts < 0) return;  // sensor not responding
+        JsonObject meta = getSensorMetadata(Traits::TYPE);
         bool spiffsEmpty = meta.isNull() || !meta["calibration"].is<JsonArray>()
                            || meta["calibration"].as<JsonArray>().size() == 0;
         if (pts > 0 && spiffsEmpty) {
             Serial.printf("[CONFIG] Warning: %s has %d-point calibration but no history in SPIFFS\n",
-                          chk.label, pts);
+                          Traits::MODEL, pts);
         } else if (pts == 0 && !spiffsEmpty) {
             Serial.printf("[CONFIG] Note: %s has SPIFFS history but EZO reports uncalibrated\n",
-                          chk.label);
+                          Traits::MODEL);
         }
-    }
+    });
 
     // Initialize GPS (waits ~1.5s for NMEA data to detect module)
     Serial.println("\n[GPS] Probing GPS module...");
@@ -538,8 +650,8 @@ void setup() {
 
     // Initialize BNO085 IMU (optional — N2K attitude fallback if absent)
     // Retry up to 3 times — sensor may not respond on first probe after cold boot
-    Serial.println("\n[IMU] Probing BNO085...");
-    {
+    if constexpr (FEATURE_IMU) {
+        Serial.println("\n[IMU] Probing BNO085...");
         bool imuOk = false;
         for (int attempt = 0; attempt < 3 && !imuOk; attempt++) {
             if (attempt > 0) {
@@ -587,6 +699,31 @@ void setup() {
     Serial.print("[CONFIG] NMEA2000 outbound PGN output: ");
     Serial.println(nmeaOutputEnabled ? "enabled" : "disabled");
 
+    // Apply runtime settings when the web UI publishes a new config snapshot
+    configManager.subscribe([](const ConfigManager::Snapshot& cfg, const ConfigManager::Snapshot& prev) {
+        nmeaOutputEnabled = cfg.nmea.outputEnabled;
+        if constexpr (FEATURE_N2K) {
+            if (cfg.nmea.outputEnabled != prev.nmea.outputEnabled) {
+                if (!nmeaOutputEnabled) {
+                    // The queues belong to loop(); drop them there
+                    n2kResetRequested = true;
+                } else if (!n2kGPS.isTransmitReady()) {
+                    Serial.println("[N2K] Output enabled; takes effect after restart (bus is listen-only)");
+                }
+            }
+        }
+        if (cfg.sampling.sensorIntervalMs != prev.sampling.sensorIntervalMs ||
+            cfg.sampling.skipIfStationary != prev.sampling.skipIfStationary ||
+            cfg.sampling.stationaryDeltaMeters != prev.sampling.stationaryDeltaMeters) {
+            sensorSamplingIntervalMs = cfg.sampling.sensorIntervalMs;
+            skipMeasurementIfStationary = cfg.sampling.skipIfStationary;
+            stationaryDeltaMeters = cfg.sampling.stationaryDeltaMeters;
+            portENTER_CRITICAL(&g_timerMux);
+            lastSensorReadAt = millis();  // reschedule from now so the dashboard countdown matches
+            portEXIT_CRITICAL(&g_timerMux);
+        }
+    });
+
     // Initialize storage
     if (!storage.begin()) {
         Serial.println("[ERROR] No storage systems available!");
@@ -631,45 +768,44 @@ void setup() {
     }
 
     // Register backend-triggered OTA callback
-    apiUploader.setOTACallback([](const String& version) {
-        // Skip OTA if pump is actively running (safety)
-        if (pumpController.isEnabled()) {
-            PumpState pumpState = pumpController.getState();
-            if (pumpState == PumpState::FLUSHING ||
-                pumpState == PumpState::MEASURING) {
-                Serial.println("[OTA] Skipping backend OTA — pump active, will retry next upload");
-                return;
+    if constexpr (FEATURE_OTA) {
+        apiUploader.setOTACallback([](const String& version) {
+            // Skip OTA if pump is actively running (safety)
+            if (pumpController.isEnabled()) {
+                PumpState pumpState = pumpController.getState();
+                if (pumpState == PumpState::FLUSHING ||
+                    pumpState == PumpState::MEASURING) {
+                    Serial.println("[OTA] Skipping backend OTA — pump active, will retry next upload");
+                    return;
+                }
             }
-        }
 
-        Serial.print("[OTA] Backend triggered update to version: ");
-        Serial.println(version);
+            Serial.print("[OTA] Backend triggered update to version: ");
+            Serial.println(version);
 
-        // Use GitHub Releases API to resolve download URL
-        OTAManager::UpdateInfo info = otaManager.checkForUpdate(FIRMWARE_VERSION);
-        if (!info.available || info.url.isEmpty()) {
-            Serial.println("[OTA] No matching release found on GitHub");
-            return;
-        }
+            // Use GitHub Releases API to resolve download URL
+            OTAManager::UpdateInfo info = otaManager.checkForUpdate(FIRMWARE_VERSION);
+            if (!info.available || info.url.isEmpty()) {
+                Serial.println("[OTA] No matching release found on GitHub");
+                return;
+            }
 
-        Serial.print("[OTA] Downloading from: ");
-        Serial.println(info.url);
+            Serial.print("[OTA] Downloading from: ");
+            Serial.println(info.url);
 
-        if (otaManager.updateFromUrl(info.url)) {
-            Serial.println("[OTA] Update successful, restarting...");
-            delay(1000);
-            ESP.restart();
-        } else {
-            Serial.print("[OTA] Update failed: ");
-            Serial.println(otaManager.getErrorMessage());
-        }
-    });
+            // Download in the background; loop() restarts once it has flashed
+            if (!otaManager.startUpdateFromUrl(info.url, info.fallbackUrl)) {
+                Serial.print("[OTA] Update failed to start: ");
+                Serial.println(otaManager.getErrorMessage());
+            }
+        });
+    }
 
     // Initialize NMEA2000 GPS listener
     // Run in a separate task with timeout — CAN bus init can hang indefinitely
     // on cold boot when no transceiver is connected, triggering the watchdog
-    Serial.println("\n[N2K] Initializing NMEA2000 GPS listener...");
-    {
+    if constexpr (FEATURE_N2K) {
+        Serial.println("\n[N2K] Initializing NMEA2000 GPS listener...");
         struct N2KInitCtx { SemaphoreHandle_t sem; bool ok; };
         static N2KInitCtx n2kCtx;
         n2kCtx.sem = xSemaphoreCreateBinary();
@@ -678,7 +814,7 @@ void setup() {
         TaskHandle_t n2kTaskHandle = NULL;
         xTaskCreate([](void* p) {
             auto* c = (N2KInitCtx*)p;
-            c->ok = n2kGPS.begin();
+            c->ok = n2kGPS.begin(nmeaOutputEnabled);
             xSemaphoreGive(c->sem);
             vTaskDelete(NULL);
         }, "N2KInit", 4096, &n2kCtx, 1, &n2kTaskHandle);
@@ -712,6 +848,12 @@ void setup() {
 
     } // end !isInSafeMode() — API, NMEA2000, I2C mutex, pump
 
+    // Recovery ladders for each subsystem
+    setupRecovery();
+
+    // Frequency scaling and light-sleep wake sources
+    powerManager.begin();
+
     Serial.println("\n===========================================");
     if (systemHealth.isInSafeMode()) {
         Serial.println("   SeaSense Logger - SAFE MODE");
@@ -785,6 +927,194 @@ void resetI2CBus() {
     Serial.println("[I2C] Bus reset performed");
 }
 
+// Recovery actions per subsystem. Rungs without a handler are skipped;
+// RETRY needs none (the next cycle simply tries again).
+void setupRecovery() {
+    // Sensor bus: SCL clock-out, then re-probe every enabled sensor.
+    // Critical: escalates to a reboot once disabled.
+    recoveryManager.setHandler(Subsystem::I2C, RecoveryAction::RESET, []() {
+        bool locked = g_i2cMutex && xSemaphoreTake(g_i2cMutex, pdMS_TO_TICKS(2000));
+        resetI2CBus();
+        compensation.invalidateAll();
+        if (locked) xSemaphoreGive(g_i2cMutex);
+        return true;
+    });
+    recoveryManager.setHandler(Subsystem::I2C, RecoveryAction::REINIT, []() {
+        bool locked = g_i2cMutex && xSemaphoreTake(g_i2cMutex, pdMS_TO_TICKS(2000));
+        resetI2CBus();
+        bool found = false;
+        waterSensors.forEach([&found](auto& probe) {
+            systemHealth.feedWatchdog();
+            if (probe.isEnabled() && probe.begin()) found = true;
+        });
+        compensation.invalidateAll();
+        if (locked) xSemaphoreGive(g_i2cMutex);
+        return found;
+    });
+
+    // SD card: remount, full SPI re-init, then fall back to SPIFFS only
+    recoveryManager.setHandler(Subsystem::SD, RecoveryAction::RESET, []() {
+        return storage.remountSD();
+    });
+    recoveryManager.setHandler(Subsystem::SD, RecoveryAction::REINIT, []() {
+        return storage.reinitSD();
+    });
+    recoveryManager.setHandler(Subsystem::SD, RecoveryAction::DISABLE, []() {
+        storage.disableSD();
+        return true;
+    });
+
+    // SPIFFS: remount (no REINIT — a reformat would drop the upload queue)
+    recoveryManager.setHandler(Subsystem::SPIFFS, RecoveryAction::RESET, []() {
+        return storage.remountSPIFFS();
+    });
+    recoveryManager.setHandler(Subsystem::SPIFFS, RecoveryAction::DISABLE, []() {
+        storage.disableSPIFFS();
+        return true;
+    });
+
+    // WiFi station: the web task already retries every minute; escalate to
+    // an immediate reconnect, then a radio restart, then stop trying (AP stays up)
+    recoveryManager.setHandler(Subsystem::WIFI, RecoveryAction::RESET, []() {
+        webServer.requestStationReset();
+        return true;
+    });
+    recoveryManager.setHandler(Subsystem::WIFI, RecoveryAction::REINIT, []() {
+        webServer.setStationEnabled(true);
+        webServer.requestWiFiRestart();
+        return true;
+    });
+    recoveryManager.setHandler(Subsystem::WIFI, RecoveryAction::DISABLE, []() {
+        webServer.setStationEnabled(false);
+        return true;
+    });
+
+    // Onboard GPS: re-open the UART
+    recoveryManager.setHandler(Subsystem::GPS, RecoveryAction::REINIT, []() {
+        return gps.begin(GPS_BAUD_RATE);
+    });
+
+    // IMU: re-run the SH2 handshake
+    if constexpr (FEATURE_IMU) {
+        recoveryManager.setHandler(Subsystem::IMU, RecoveryAction::REINIT, []() {
+            bool locked = g_i2cMutex && xSemaphoreTake(g_i2cMutex, pdMS_TO_TICKS(2000));
+            bool ok = imu.begin();
+            if (locked) xSemaphoreGive(g_i2cMutex);
+            return ok;
+        });
+    }
+
+    // N2K: no actions — re-initialising the CAN driver can hang (see setup()),
+    // so the bus is only tracked and reported
+}
+
+// Feed the recovery manager with health of subsystems that have no
+// natural success/failure point in loop(). A source is only tracked once
+// it has delivered data, so absent hardware never counts as failing.
+void pollSubsystemHealth(unsigned long now) {
+    static unsigned long lastPoll = 0;
+    if (now - lastPoll < RECOVERY_POLL_INTERVAL_MS) return;
+    lastPoll = now;
+
+    if (webServer.isStationConfigured()) {
+        if (webServer.isWiFiConnected()) {
+            recoveryManager.reportSuccess(Subsystem::WIFI, now);
+        } else {
+            recoveryManager.reportFailure(Subsystem::WIFI, now);
+        }
+    }
+
+    unsigned long gpsAge = gps.getAgeMs();
+    if (gpsAge != ULONG_MAX || recoveryManager.isMonitored(Subsystem::GPS)) {
+        if (gpsAge < RECOVERY_GPS_STALE_MS) {
+            recoveryManager.reportSuccess(Subsystem::GPS, now);
+        } else {
+            recoveryManager.reportFailure(Subsystem::GPS, now);
+        }
+    }
+
+    if constexpr (FEATURE_N2K) {
+        unsigned long n2kAge = n2kGPS.getAgeMs();
+        if (n2kAge != ULONG_MAX) {
+            if (n2kAge < RECOVERY_GPS_STALE_MS) {
+                recoveryManager.reportSuccess(Subsystem::N2K, now);
+            } else {
+                recoveryManager.reportFailure(Subsystem::N2K, now);
+            }
+        }
+    }
+
+    if constexpr (FEATURE_IMU) {
+        if (imu.isInitialized()) {
+            if (imu.getOrientationAgeMs() < RECOVERY_IMU_STALE_MS) {
+                recoveryManager.reportSuccess(Subsystem::IMU, now);
+            } else {
+                recoveryManager.reportFailure(Subsystem::IMU, now);
+            }
+        } else if (recoveryManager.isMonitored(Subsystem::IMU)) {
+            recoveryManager.reportFailure(Subsystem::IMU, now);
+        }
+    }
+}
+
+// Collect the next deadline across pump, sampling and upload for the
+// power manager, plus anything that must keep the CPU awake
+void schedulePowerDeadlines() {
+    powerManager.beginCycle(millis());
+    powerManager.setRadioState(WiFi.softAPgetStationNum(), webServer.isWiFiConnected());
+
+    if (pumpController.isEnabled()) {
+        switch (pumpController.getState()) {
+            case PumpState::IDLE: {
+                // Next cycle starts with the flush, not the measurement
+                unsigned long untilMeasure = pumpController.getTimeUntilNextMeasurementMs();
+                unsigned long flushMs = pumpController.getConfig().flushDurationMs;
+                powerManager.wakeWithin(untilMeasure > flushMs ? untilMeasure - flushMs : 0, "pump");
+                break;
+            }
+            case PumpState::FLUSHING:
+                powerManager.wakeForMeasurement(pumpController.getPhaseRemainingMs(), "flush");
+                break;
+            case PumpState::MEASURING:
+                powerManager.stayAwake("measuring");
+                break;
+            default:
+                break;  // paused or error: nothing scheduled
+        }
+    } else {
+        unsigned long lastRead;
+        portENTER_CRITICAL(&g_timerMux);
+        lastRead = lastSensorReadAt;
+        portEXIT_CRITICAL(&g_timerMux);
+        unsigned long elapsed = millis() - lastRead;
+        powerManager.wakeForMeasurement(
+            elapsed < sensorSamplingIntervalMs ? sensorSamplingIntervalMs - elapsed : 0, "sampling");
+    }
+
+    powerManager.wakeWithin(apiUploader.getTimeUntilNext(), "upload");
+
+    if (calibration.needsUpdate()) {
+        powerManager.stayAwake("calibration");
+    }
+    if (OTAManager::isUpdateInProgress()) {
+        powerManager.stayAwake("ota");
+    }
+    if (timeService.isSynced() && storage.isBackfillPending()) {
+        powerManager.stayAwake("backfill");
+    }
+}
+
+// Short quality label for the per-sensor log lines
+const char* sensorQualityLabel(SensorQuality quality) {
+    switch (quality) {
+        case SensorQuality::GOOD:           return "GOOD";
+        case SensorQuality::FAIR:           return "FAIR";
+        case SensorQuality::POOR:           return "POOR";
+        case SensorQuality::NOT_CALIBRATED: return "NOT_CAL";
+        default:                            return "ERROR";
+    }
+}
+
 float distanceMeters(float lat1, float lon1, float lat2, float lon2) {
     // Haversine distance in meters
     const float R = 6371000.0f;
@@ -802,14 +1132,28 @@ float distanceMeters(float lat1, float lon1, float lat2, float lon2) {
 
 void loop() {
     unsigned long now = millis();
+    unsigned long gap = 0;
     if (g_lastLoopStartMs != 0) {
-        unsigned long gap = now - g_lastLoopStartMs;
+        // Start to start, less the planned idle: loop gap stats measure work
+        gap = now - g_lastLoopStartMs;
+        gap = gap > g_lastIdleMs ? gap - g_lastIdleMs : 0;
         if (gap > g_maxLoopGapMs) g_maxLoopGapMs = gap;
     }
     g_lastLoopStartMs = now;
+    g_lastIdleMs = 0;
+
+    flightRecorder.loopStart(now, gap);
+    static unsigned long lastFlightSample = 0;
+    if (now - lastFlightSample >= FLIGHT_SAMPLE_INTERVAL_MS) {
+        lastFlightSample = now;
+        int64_t epochMs = timeService.epochMs(now);
+        flightRecorder.sample(now, ESP.getFreeHeap(), ESP.getMinFreeHeap(),
+                              heap_caps_get_largest_free_block(MALLOC_CAP_8BIT),
+                              epochMs > 0 ? (uint32_t)(epochMs / 1000) : 0);
+    }
 
     // Feed watchdog first — if anything below hangs, WDT will reboot
-    g_loopStage = "loop:start";
+    setLoopStage("loop:start");
     systemHealth.feedWatchdog();
 
     // Safe mode: only web server runs (on Core 0), nothing to do here
@@ -819,42 +1163,86 @@ void loop() {
     }
 
     // Update GPS sources (must be called frequently)
-    g_loopStage = "gps:update";
+    setLoopStage("gps:update");
     gps.update();
-    n2kGPS.update();
+    if constexpr (FEATURE_N2K) {
+        n2kGPS.update();
+
+        // Output switched off from the web UI: drop queued frames and
+        // emitter state here, on the core that owns them
+        if (n2kResetRequested) {
+            n2kResetRequested = false;
+            n2kTx.clear();
+            n2kEmitter.reset();
+        }
+
+        // Outbound PGNs: enqueue what is due, then hand the bus its frame budget
+        if (nmeaOutputEnabled && n2kGPS.isTransmitReady()) {
+            n2kEmitter.update(millis());
+        }
+        n2kTx.process(millis());
+    }
+
+    // QC history dropped after a recalibration; the web task only marks
+    // the channel, the filters are owned by the measurement cycle
+    uint8_t qcResets = qcResetMask.exchange(0);
+    for (uint8_t ch = 0; qcResets != 0 && ch < (uint8_t)QcChannel::COUNT; ch++) {
+        if (qcResets & (1 << ch)) {
+            qualityControl.reset((QcChannel)ch);
+        }
+    }
 
     // Update IMU (non-blocking drain of SH2 event queue)
-    if (imu.isInitialized()) {
-        g_loopStage = "imu:update";
-        bool locked = g_i2cMutex && xSemaphoreTake(g_i2cMutex, pdMS_TO_TICKS(50));
-        imu.update();
-        if (locked) xSemaphoreGive(g_i2cMutex);
+    if constexpr (FEATURE_IMU) {
+        if (imu.isInitialized()) {
+            setLoopStage("imu:update");
+            bool locked = g_i2cMutex && xSemaphoreTake(g_i2cMutex, pdMS_TO_TICKS(50));
+            imu.update();
+            if (locked) xSemaphoreGive(g_i2cMutex);
+        }
     }
 
-    // Keep system epoch current for calibration age checks
+    // Discipline the time service from GNSS on each new GPS second (NTP is
+    // fed by the API uploader); the service rate-limits re-anchoring itself
+    setLoopStage("time:sync");
+    timeService.update(now);
     if (activeGPSHasValidFix()) {
+        static time_t lastGnssEpoch = 0;
         GPSData gpsData = activeGPSGetData();
-        if (gpsData.epoch > 0 && gpsData.epoch != g_systemEpoch) {
-            g_systemEpoch = gpsData.epoch;
-            EZOSensor::setSystemEpoch(g_systemEpoch);
-
-            // Stamp deploy_date on first valid GPS time (persists across reboots)
-            configManager.stampDeployDate(activeGPSGetTimeUTC());
+        if (gpsData.epoch > 0 && gpsData.epoch != lastGnssEpoch) {
+            lastGnssEpoch = gpsData.epoch;
+            timeService.sync(activeGPSIsN2K() ? TimeSource::N2K : TimeSource::GPS,
+                             (int64_t)gpsData.epoch * 1000, millis() - activeGPSGetAgeMs());
         }
-    } else {
-        // No GPS fix — populate from NTP if available and not yet set
-        time_t ntpNow = time(nullptr);
-        if (ntpNow > 1000000000UL && g_systemEpoch == 0) {
-            g_systemEpoch = ntpNow;
-            EZOSensor::setSystemEpoch(g_systemEpoch);
+    }
+    if (timeService.isSynced()) {
+        // Calibration age checks
+        EZOSensor::setSystemEpoch((time_t)(timeService.epochMs(now) / 1000));
 
-            // Also stamp deploy_date from NTP when GPS is unavailable
+        // Stamp deploy_date on first valid time (persists across reboots)
+        static bool deployDateChecked = false;
+        if (!deployDateChecked) {
             configManager.stampDeployDate(getSystemTimeUTC());
+            deployDateChecked = true;
+        }
+
+        // Records stored before the first sync: repair a batch per pass
+        if (storage.isBackfillPending()) {
+            setLoopStage("time:backfill");
+            storage.backfillTimestamps(timeService, now, TIME_BACKFILL_BATCH);
         }
     }
 
+    // Closed SD segments move into the compressed archive, a batch per pass
+    static unsigned long lastCompactMs = 0;
+    if (now - lastCompactMs >= ARCHIVE_COMPACT_INTERVAL_MS) {
+        lastCompactMs = now;
+        setLoopStage("storage:compact");
+        storage.compactArchive(ARCHIVE_COMPACT_BATCH);
+    }
+
     // Advance pump state machine
-    g_loopStage = "pump:update";
+    setLoopStage("pump:update");
     pumpController.update();
 
     // Determine whether to read sensors and whether to persist the results.
@@ -885,55 +1273,49 @@ void loop() {
     }
 
     if (doSensorRead) {
-        g_loopStage = "sensors:cycle";
+        setLoopStage("sensors:cycle");
         // Blink LED to show activity
         digitalWrite(LED_PIN, HIGH);
 
-        Serial.println("\n--- Sensor Reading ---");
-        Serial.print("Time: ");
-        Serial.print(now);
-        Serial.println(" ms");
+        LOG_INFO("SENSOR", "--- Sensor Reading at %lu ms ---", now);
 
         // Get GPS data from active source (NMEA2000 preferred, onboard fallback)
         GPSData gpsData = activeGPSGetData();
-        const bool gpsFromN2K = n2kGPS.hasValidFix();
+        const bool gpsFromN2K = activeGPSIsN2K();
         if (activeGPSHasValidFix()) {
-            Serial.print("GPS [");
-            Serial.print(gpsFromN2K ? "N2K" : "NEO");
-            Serial.print("]: ");
-            Serial.print(gpsData.latitude, 6);
-            Serial.print("° N, ");
-            Serial.print(gpsData.longitude, 6);
-            Serial.print("° E");
-            Serial.print(" (");
-            Serial.print(gpsData.satellites);
-            Serial.print(" sats, HDOP: ");
-            Serial.print(gpsData.hdop, 1);
-            Serial.println(")");
-            Serial.print("GPS Time: ");
-            Serial.println(activeGPSGetTimeUTC());
+            LOG_INFO("GPS", "%s: %.6f° N, %.6f° E (%d sats, HDOP: %.1f)",
+                     gpsFromN2K ? "N2K" : "NEO", gpsData.latitude, gpsData.longitude,
+                     gpsData.satellites, gpsData.hdop);
+            if (eventLog.isEnabled(LogLevel::DEBUG)) {
+                LOG_DEBUG("GPS", "Time: %s", activeGPSGetTimeUTC());
+            }
         } else {
-            Serial.print("GPS: ");
-            Serial.println(gps.getStatusString());
+            LOG_INFO("GPS", "%s", gps.getStatusString());
         }
 
         // Snapshot NMEA2000 environmental data from boat instruments
-        N2kEnvironmentData envData = n2kEnv.getSnapshot();
-        if (n2kEnv.hasAnyData()) {
-            Serial.print("N2K Env: ");
-            Serial.println(n2kEnv.getStatusString());
+        N2kEnvironmentData envData;
+        if constexpr (FEATURE_N2K) {
+            envData = n2kEnv.getSnapshot();
+            if (n2kEnv.hasAnyData() && eventLog.isEnabled(LogLevel::DEBUG)) {
+                LOG_DEBUG("N2K", "Env: %s", n2kEnv.getStatusString());
+            }
         }
 
         // Snapshot IMU at same moment as wind data for synchronized correction
-        IMUData imuData = imu.getSnapshot();
-        if (imuData.hasOrientation) {
-            Serial.print("IMU: ");
-            Serial.println(imu.getStatusString());
+        IMUData imuData;
+        if constexpr (FEATURE_IMU) {
+            imuData = imu.getSnapshot();
+            if (imuData.hasOrientation && eventLog.isEnabled(LogLevel::DEBUG)) {
+                LOG_DEBUG("IMU", "%s", imu.getStatusString());
+            }
         }
 
-        // Track consecutive sensor failures for I2C bus reset
-        static uint8_t consecutiveSensorFails = 0;
-        uint8_t sensorFailsThisCycle = 0;
+        // Successful reads this cycle, for sensor bus health
+        uint8_t sensorReadsOk = 0;
+        uint8_t sensorReadsSkipped = 0;   // circuit breaker open, not attempted
+        uint8_t sensorReadMask = 0;       // bit per SensorTraits INDEX, shared with web reads
+        LiveSnapshot liveSnap;            // this cycle for UDP listeners
 
         // GPS NaN guard helper
         const bool gpsValid = activeGPSHasValidFix()
@@ -946,14 +1328,11 @@ void loop() {
                 float deltaM = distanceMeters(lastMeasurementLat, lastMeasurementLon, gpsData.latitude, gpsData.longitude);
                 if (deltaM < stationaryDeltaMeters) {
                     skipByMotionGate = true;
-                    Serial.print("[SAMPLING] Skipping cycle (stationary, Δ=");
-                    Serial.print(deltaM, 1);
-                    Serial.print("m < ");
-                    Serial.print(stationaryDeltaMeters, 1);
-                    Serial.println("m)");
+                    LOG_INFO("SAMPLING", "Skipping cycle (stationary, Δ=%.1fm < %.1fm)",
+                             deltaM, stationaryDeltaMeters);
                 }
             } else if (!gpsValid) {
-                Serial.println("[SAMPLING] Motion gate enabled, but GPS fix invalid — measuring anyway");
+                LOG_WARN("SAMPLING", "Motion gate enabled, but GPS fix invalid — measuring anyway");
             }
         }
 
@@ -965,208 +1344,138 @@ void loop() {
             // Acquire I2C mutex for sensor reads (prevents collision with web server)
             bool i2cLocked = (g_i2cMutex != NULL) && xSemaphoreTake(g_i2cMutex, pdMS_TO_TICKS(2000));
 
-        // Read temperature
-        g_loopStage = "sensor:temp";
-        systemHealth.feedWatchdog();
-        if (tempSensor.isEnabled() && tempSensor.read()) {
-            SensorData tempData = tempSensor.getData();
-
-            Serial.print("Temperature: ");
-            Serial.print(tempData.value, 2);
-            Serial.print(" ");
-            Serial.print(tempData.unit);
-            Serial.print(" [");
-            Serial.print(tempData.quality == SensorQuality::GOOD ? "GOOD" :
-                        tempData.quality == SensorQuality::FAIR ? "FAIR" :
-                        tempData.quality == SensorQuality::POOR ? "POOR" :
-                        tempData.quality == SensorQuality::NOT_CALIBRATED ? "NOT_CAL" : "ERROR");
-            Serial.println("]");
-
-            // Set temperature compensation for EC, pH, and DO sensors
-            ecSensor.setTemperatureCompensation(tempData.value);
-            phSensor.setTemperatureCompensation(tempData.value);
-            doSensor.setTemperatureCompensation(tempData.value);
-
-            // Create DataRecord with GPS + environmental data
-            DataRecord record = sensorDataToRecord(tempData, getSystemTimeUTC());
-            if (gpsValid) {
-                record.latitude = gpsData.latitude;
-                record.longitude = gpsData.longitude;
-                record.altitude = gpsData.altitude;
-                record.gps_satellites = gpsData.satellites;
-                record.gps_hdop = gpsData.hdop;
-            }
-            stampEnvironmentData(record, envData);
-            applyIMUAndWindCorrection(record, imuData);
-
-            // Log to storage (pump-driven and fallback modes only)
-            if (saveToStorage && !storage.writeRecord(record)) {
-                Serial.println("[STORAGE] Failed to log temperature");
-            }
-        } else {
-            Serial.println("Temperature: READ FAILED");
-            sensorFailsThisCycle++;
-            systemHealth.recordError(ErrorType::SENSOR);
-        }
-
-        systemHealth.feedWatchdog();
-
-        // Read conductivity
-        g_loopStage = "sensor:ec";
-        systemHealth.feedWatchdog();
-        if (ecSensor.isEnabled() && ecSensor.read()) {
-            SensorData ecData = ecSensor.getData();
-
-            Serial.print("Conductivity: ");
-            Serial.print(ecData.value, 0);
-            Serial.print(" ");
-            Serial.print(ecData.unit);
-            Serial.print(" [");
-            Serial.print(ecData.quality == SensorQuality::GOOD ? "GOOD" :
-                        ecData.quality == SensorQuality::FAIR ? "FAIR" :
-                        ecData.quality == SensorQuality::POOR ? "POOR" :
-                        ecData.quality == SensorQuality::NOT_CALIBRATED ? "NOT_CAL" : "ERROR");
-            Serial.println("]");
-
-            // Calculate and display salinity
-            float salinity = ecSensor.getSalinity();
-            Serial.print("Salinity: ");
-            Serial.print(salinity, 2);
-            Serial.println(" PSU");
-
-            // Create DataRecord with GPS + environmental data
-            DataRecord ecRecord = sensorDataToRecord(ecData, getSystemTimeUTC());
-            if (gpsValid) {
-                ecRecord.latitude = gpsData.latitude;
-                ecRecord.longitude = gpsData.longitude;
-                ecRecord.altitude = gpsData.altitude;
-                ecRecord.gps_satellites = gpsData.satellites;
-                ecRecord.gps_hdop = gpsData.hdop;
-            }
-            stampEnvironmentData(ecRecord, envData);
-            applyIMUAndWindCorrection(ecRecord, imuData);
-
-            // Log to storage (pump-driven and fallback modes only)
-            if (saveToStorage && !storage.writeRecord(ecRecord)) {
-                Serial.println("[STORAGE] Failed to log conductivity");
+        // Derived values only combine readings taken in this cycle
+        derivedVars.beginCycle();
+
+        // Read each probe in WaterSensors order. The body is instantiated per
+        // probe type: direct calls, and compiled-out probes cost nothing
+        waterSensors.forEach([&](auto& probe) {
+            using Probe = std::decay_t<decltype(probe)>;
+            using Traits = SensorTraits<Probe>;
+            setLoopStage(Traits::STAGE);
+            systemHealth.feedWatchdog();
+
+            // DO: set salinity compensation BEFORE read
+            if constexpr (std::is_same<Probe, EZO_DO>::value) {
+                if (probe.isEnabled()) {
+                    compensation.applySalinity(ecSensor.getSalinity());
+                    // Atmospheric pressure compensation (Henry's Law: ~3-4% DO correction for weather variation)
+                    if (!isnan(envData.baroPressure)) {
+                        compensation.applyPressure(envData.baroPressure / 1000.0f);  // Pa → kPa
+                    }
+                }
             }
-        } else {
-            Serial.println("Conductivity: READ FAILED");
-            sensorFailsThisCycle++;
-            systemHealth.recordError(ErrorType::SENSOR);
-        }
 
-        systemHealth.feedWatchdog();
-
-        // Read pH
-        g_loopStage = "sensor:ph";
-        systemHealth.feedWatchdog();
-        if (phSensor.isEnabled() && phSensor.read()) {
-            SensorData phData = phSensor.getData();
-
-            Serial.print("pH: ");
-            Serial.print(phData.value, 2);
-            Serial.print(" ");
-            Serial.print(phData.unit);
-            Serial.print(" [");
-            Serial.print(phData.quality == SensorQuality::GOOD ? "GOOD" :
-                        phData.quality == SensorQuality::FAIR ? "FAIR" :
-                        phData.quality == SensorQuality::POOR ? "POOR" :
-                        phData.quality == SensorQuality::NOT_CALIBRATED ? "NOT_CAL" : "ERROR");
-            Serial.println("]");
-
-            // Create DataRecord with GPS + environmental data
-            DataRecord phRecord = sensorDataToRecord(phData, getSystemTimeUTC());
-            if (gpsValid) {
-                phRecord.latitude = gpsData.latitude;
-                phRecord.longitude = gpsData.longitude;
-                phRecord.altitude = gpsData.altitude;
-                phRecord.gps_satellites = gpsData.satellites;
-                phRecord.gps_hdop = gpsData.hdop;
-            }
-            stampEnvironmentData(phRecord, envData);
-            applyIMUAndWindCorrection(phRecord, imuData);
+            if (probe.isEnabled() && probe.read()) {
+                sensorReadsOk++;
+                sensorReadMask |= 1 << Traits::INDEX;
+                SensorData data = probe.getData();
+                liveSnap.set(Traits::LIVE, data.value);
+
+                LOG_INFO("SENSOR", Traits::LOG_FORMAT, data.value, data.unit, sensorQualityLabel(data.quality));
+
+                if constexpr (std::is_same<Probe, EZO_RTD>::value) {
+                    // Temperature compensation for EC, pH, and DO (skipped if unchanged)
+                    compensation.applyTemperature(data.value);
+                    derivedVars.setInput(DerivedVar::TEMPERATURE, data.value, millis());
+                } else if constexpr (std::is_same<Probe, EZO_EC>::value) {
+                    // Calculate and display salinity
+                    float salinity = probe.getSalinity();
+                    LOG_INFO("SENSOR", "Salinity: %.2f PSU", salinity);
+                    liveSnap.set(LiveField::SALINITY, salinity);
+                    derivedVars.setInput(DerivedVar::SALINITY, salinity, millis());
+                } else if constexpr (std::is_same<Probe, EZO_DO>::value) {
+                    derivedVars.setInput(DerivedVar::DISSOLVED_OXYGEN, data.value, millis());
+                }
 
-            // Log to storage (pump-driven and fallback modes only)
-            if (saveToStorage && !storage.writeRecord(phRecord)) {
-                Serial.println("[STORAGE] Failed to log pH");
+                // Create DataRecord with GPS + environmental data
+                DataRecord record = sensorDataToRecord(data, getSystemTimeUTC());
+                if (gpsValid) {
+                    record.latitude = gpsData.latitude;
+                    record.longitude = gpsData.longitude;
+                    record.altitude = gpsData.altitude;
+                    record.gps_satellites = gpsData.satellites;
+                    record.gps_hdop = gpsData.hdop;
+                }
+                stampEnvironmentData(record, envData);
+                applyIMUAndWindCorrection(record, imuData);
+                derivedVars.apply(record, millis());
+                // Probe temperature is cross-checked against the boat's transducer
+                float reference = Traits::QC == QcChannel::TEMPERATURE ? envData.waterTempExternal : NAN;
+                record.qcFlags = qualityControl.evaluate(Traits::QC, data.value, millis(), reference).packed;
+
+                // Log to storage (pump-driven and fallback modes only)
+                if (saveToStorage && !storage.writeRecord(record)) {
+                    LOG_ERROR("STORAGE", "Failed to log %s", Traits::TYPE);
+                }
+            } else if (probe.isEnabled() && probe.wasSkipped()) {
+                sensorReadsSkipped++;
+                LOG_WARN("SENSOR", "%s: SKIPPED (breaker open)", Traits::TYPE);
+            } else {
+                LOG_ERROR("SENSOR", "%s: READ FAILED", Traits::TYPE);
+                if constexpr (Traits::COMPENSATED) {
+                    compensation.invalidate(Traits::COMP);  // may have reset to defaults
+                }
+                systemHealth.recordError(ErrorType::SENSOR);
             }
-        } else {
-            Serial.println("pH: READ FAILED");
-            sensorFailsThisCycle++;
-            systemHealth.recordError(ErrorType::SENSOR);
-        }
 
-        systemHealth.feedWatchdog();
+            systemHealth.feedWatchdog();
+        });
 
-        // Read dissolved oxygen (set salinity compensation BEFORE read)
-        g_loopStage = "sensor:do";
-        systemHealth.feedWatchdog();
-        if (doSensor.isEnabled()) {
-            doSensor.setSalinityCompensation(ecSensor.getSalinity());
-            // Atmospheric pressure compensation (Henry's Law: ~3-4% DO correction for weather variation)
-            if (!isnan(envData.baroPressure)) {
-                doSensor.setPressureCompensation(envData.baroPressure / 1000.0f);  // Pa → kPa
-            }
-        }
-        if (doSensor.isEnabled() && doSensor.read()) {
-            SensorData doData = doSensor.getData();
-
-            Serial.print("Dissolved Oxygen: ");
-            Serial.print(doData.value, 2);
-            Serial.print(" ");
-            Serial.print(doData.unit);
-            Serial.print(" [");
-            Serial.print(doData.quality == SensorQuality::GOOD ? "GOOD" :
-                        doData.quality == SensorQuality::FAIR ? "FAIR" :
-                        doData.quality == SensorQuality::POOR ? "POOR" :
-                        doData.quality == SensorQuality::NOT_CALIBRATED ? "NOT_CAL" : "ERROR");
-            Serial.println("]");
-
-            // Create DataRecord with GPS + environmental data
-            DataRecord doRecord = sensorDataToRecord(doData, getSystemTimeUTC());
-            if (gpsValid) {
-                doRecord.latitude = gpsData.latitude;
-                doRecord.longitude = gpsData.longitude;
-                doRecord.altitude = gpsData.altitude;
-                doRecord.gps_satellites = gpsData.satellites;
-                doRecord.gps_hdop = gpsData.hdop;
-            }
-            stampEnvironmentData(doRecord, envData);
-            applyIMUAndWindCorrection(doRecord, imuData);
-
-            // Log to storage (pump-driven and fallback modes only)
-            if (saveToStorage && !storage.writeRecord(doRecord)) {
-                Serial.println("[STORAGE] Failed to log dissolved oxygen");
-            }
-        } else {
-            Serial.println("Dissolved Oxygen: READ FAILED");
-            sensorFailsThisCycle++;
-            systemHealth.recordError(ErrorType::SENSOR);
-        }
+        // Web requests waiting on the bus join this cycle's readings
+        sensorReads.record(millis(), sensorReadMask);
 
         // Release I2C mutex after all sensor reads
         if (i2cLocked) {
             xSemaphoreGive(g_i2cMutex);
         }
 
-        Serial.println("----------------------");
-
-        // I2C bus reset if all sensors are consistently failing
-        if (sensorFailsThisCycle > 0) {
-            consecutiveSensorFails += sensorFailsThisCycle;
-        } else {
-            consecutiveSensorFails = 0;
+        // Sensor bus health: a cycle where every attempted sensor failed points
+        // at the bus (stuck slave, lost pull-up), not at a single probe.
+        // Reads skipped by a sensor's breaker say nothing about the bus.
+        uint8_t sensorsAttempted = waterSensors.enabledCount() - sensorReadsSkipped;
+        if (sensorsAttempted > 0) {
+            if (sensorReadsOk > 0) {
+                recoveryManager.reportSuccess(Subsystem::I2C, millis());
+            } else {
+                recoveryManager.reportFailure(Subsystem::I2C, millis());
+            }
         }
 
-        if (consecutiveSensorFails >= I2C_BUS_RESET_THRESHOLD) {
-            resetI2CBus();
-            consecutiveSensorFails = 0;
+        // Broadcast this cycle and its context to listeners on the boat network
+        if constexpr (FEATURE_UDP_LIVE) {
+            if (sensorReadsOk > 0) {
+                time_t epoch = (time_t)(timeService.epochMs(millis()) / 1000);
+                liveSnap.epoch = epoch > 1000000000 ? (uint32_t)epoch : 0;
+                if (gpsValid) {
+                    liveSnap.latitude = gpsData.latitude;
+                    liveSnap.longitude = gpsData.longitude;
+                }
+                liveSnap.set(LiveField::SOG, envData.sog);
+                liveSnap.set(LiveField::COG, envData.cogTrue);
+                liveSnap.set(LiveField::STW, envData.speedThroughWater);
+                liveSnap.set(LiveField::DEPTH, envData.waterDepth);
+                liveSnap.set(LiveField::WIND_SPEED_TRUE, envData.windSpeedTrue);
+                liveSnap.set(LiveField::WIND_ANGLE_TRUE, envData.windAngleTrue);
+                liveSnap.set(LiveField::AIR_TEMP, envData.airTemp);
+                liveSnap.set(LiveField::BARO_PRESSURE, envData.baroPressure);
+                udpLive.publish(liveSnap);
+            }
         }
 
-        // TODO: Generate NMEA2000 PGNs (when enabled)
-        if (nmeaOutputEnabled) {
-            // TODO: emit outbound NMEA2000 PGNs
+        // Publish this cycle's water quality on NMEA2000 (queued, sent from
+        // the loop by n2kTx at its own pace)
+        if constexpr (FEATURE_N2K) {
+            if (nmeaOutputEnabled) {
+                time_t epoch = (time_t)(timeService.epochMs(millis()) / 1000);
+                n2kEmitter.setReadings(
+                    tempSensor.isValid() ? tempSensor.getValue() : NAN,
+                    ecSensor.isValid() ? ecSensor.getSalinity() : NAN,
+                    gpsValid ? gpsData.latitude : NAN,
+                    gpsValid ? gpsData.longitude : NAN,
+                    epoch > 1000000000 ? epoch : 0,
+                    millis());
+            }
         }
 
         // Notify pump that all sensors have been read this cycle
@@ -1187,26 +1496,54 @@ void loop() {
     systemHealth.feedWatchdog();
 
     // Process API upload (non-blocking)
-    g_loopStage = "upload:process";
+    setLoopStage("upload:process");
     apiUploader.process();
 
     // Feed watchdog before calibration
     systemHealth.feedWatchdog();
 
-    // Update calibration state machine (acquire I2C mutex to prevent
-    // collision with web server running on Core 0)
-    g_loopStage = "calibration:update";
-    if (calibration.isCalibrating()) {
+    // Advance the calibration sessions (acquire I2C mutex to prevent
+    // collision with web server running on Core 0). Non-blocking: probe
+    // reads are requested in one pass and collected in a later one
+    setLoopStage("calibration:update");
+    if (calibration.needsUpdate()) {
         bool calLocked = (g_i2cMutex != NULL) && xSemaphoreTake(g_i2cMutex, pdMS_TO_TICKS(2000));
         calibration.update();
         if (calLocked) xSemaphoreGive(g_i2cMutex);
-    } else {
-        calibration.update();
     }
 
     // Handle serial commands
-    g_loopStage = "serial:process";
+    setLoopStage("serial:process");
     serialCommands.process();
 
-    g_loopStage = "loop:idle";
+    // Write buffered capture records to SD
+    setLoopStage("capture:process");
+    captureRecorder.process(millis());
+
+    // Escalate failing subsystems (bus resets, remounts, reconnects)
+    setLoopStage("recovery:process");
+    pollSubsystemHealth(millis());
+    recoveryManager.process(millis());
+    if (recoveryManager.isRebootRequested() && !OTAManager::isUpdateInProgress()) {
+        LOG_ERROR("RECOVERY", "%s unrecoverable, restarting...", recoveryManager.getRebootReason());
+        eventLog.flush(storage.isSDMounted());
+        delay(1000);
+        ESP.restart();
+    }
+
+    // A background OTA has flashed the new image — reboot here, between
+    // cycles, rather than from the OTA task in the middle of a storage write
+    if (OTAManager::isRestartPending()) {
+        LOG_INFO("OTA", "New firmware ready, restarting...");
+        eventLog.flush(storage.isSDMounted());
+        delay(1000);
+        ESP.restart();
+    }
+
+    // Sleep or yield until the next deadline instead of spinning
+    setLoopStage("loop:idle");
+    schedulePowerDeadlines();
+    unsigned long idleStart = millis();
+    powerManager.idle();
+    g_lastIdleMs = millis() - idleStart;
 }
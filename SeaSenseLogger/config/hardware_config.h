@@ -19,6 +19,35 @@
 #define API_URL_LIVE "https://seasense.projectseasense.org"
 #define API_URL_TEST "https://test-api.projectseasense.org"
 
+// ============================================================================
+// Feature Selection (compile time)
+// ============================================================================
+
+// A disabled feature's objects, drivers and library code are not linked.
+// Override per boat: ./scripts/build.sh s3 -DFEATURE_IMU=0 -DFEATURE_N2K=0
+
+#ifndef FEATURE_PH
+#define FEATURE_PH 1                      // EZO-pH probe
+#endif
+#ifndef FEATURE_DO
+#define FEATURE_DO 1                      // EZO-DO probe
+#endif
+#ifndef FEATURE_IMU
+#define FEATURE_IMU 1                     // BNO085 hull IMU (wind motion correction)
+#endif
+#ifndef FEATURE_N2K
+#define FEATURE_N2K 1                     // NMEA2000 GPS/instrument input and PGN output
+#endif
+#ifndef FEATURE_OTA
+#define FEATURE_OTA 1                     // Firmware update from the backend or web UI
+#endif
+#ifndef FEATURE_UDP_LIVE
+#define FEATURE_UDP_LIVE 1                // UDP broadcast of each cycle (NMEA0183 + binary)
+#endif
+#ifndef FEATURE_MQTT_UPLOAD
+#define FEATURE_MQTT_UPLOAD 0             // Stream uploads over MQTT instead of HTTPS POST batches
+#endif
+
 // ============================================================================
 // I2C Configuration - Atlas Scientific EZO Sensors
 // ============================================================================
@@ -107,6 +136,93 @@
 #define EZO_DO_RESPONSE_TIME_MS 1000       // EZO-DO response time
 #define NMEA2000_METADATA_INTERVAL_MS 60000  // Send metadata PGNs every 60 seconds
 
+// ============================================================================
+// Calibration Stability Detection
+// ============================================================================
+
+#define CAL_SETTLE_DELAY_MS 1000          // Ignore readings right after the probe is placed
+#define CAL_SAMPLE_INTERVAL_MS 500        // Minimum spacing between stability samples
+#define CAL_STABILITY_MIN_SAMPLES 5       // Shortest window that can be declared stable
+#define CAL_DRIFT_HORIZON_S 10.0f         // Reading must not drift more than tolerance over this
+#define CAL_STABILITY_TIMEOUT_MS 60000    // Give up waiting for a stable reading
+#define CAL_NOISE_FLOOR_ALPHA 0.3f        // Weight of the newest session in the learned noise floor
+#define CAL_MAX_READ_FAILURES 3           // Consecutive failed reads before a session fails
+
+// ============================================================================
+// EZO Compensation (T/S/P commands re-sent only when the value moves)
+// ============================================================================
+
+#define COMP_TEMP_HYSTERESIS_C 0.05f        // ~0.1% EC error at 2%/°C
+#define COMP_SALINITY_HYSTERESIS_PSU 0.5f   // DO solubility changes ~0.6% per 10 PSU
+#define COMP_PRESSURE_HYSTERESIS_KPA 0.2f   // ~0.2% DO
+#define COMP_RESYNC_INTERVAL_MS 3600000     // Re-send everything hourly (undetected EZO resets)
+
+// ============================================================================
+// EZO Circuit Breaker (stop paying hard timeouts for a hung sensor)
+// ============================================================================
+
+#define EZO_BREAKER_FAILURE_THRESHOLD 3     // Consecutive failed reads before the breaker opens
+#define EZO_BREAKER_BASE_OPEN_MS 60000      // First open period; doubles after each failed probe
+#define EZO_BREAKER_MAX_OPEN_MS 3600000     // Open period cap (1 h)
+
+// ============================================================================
+// Web Sensor Reads (coalesced: I2C traffic does not grow with clients)
+// ============================================================================
+
+#define SENSOR_READ_FRESH_MS 3000           // Web reads within this of the last completed read share it
+#define SENSOR_READ_BUS_WAIT_MS 5000        // Wait out an in-flight cycle (4 probes x ~1 s) and join it
+
+// ============================================================================
+// Web Data Sync (offline web app pulls new records from /api/data/changes)
+// ============================================================================
+
+#define DATA_CHANGES_MAX_RECORDS 200        // Records per /api/data/changes response
+#define DATA_RECORDS_BATCH 4                // Records held at a time while writing /api/data/records
+
+// ============================================================================
+// UDP Live Broadcast (each measurement cycle to the boat network)
+// ============================================================================
+
+#define UDP_LIVE_NMEA_PORT 10110            // NMEA0183 over IP (OpenCPN, chartplotter apps)
+#define UDP_LIVE_BINARY_PORT 10111          // Binary datagram (LiveMessage.h)
+
+// ============================================================================
+// MQTT Upload Transport (FEATURE_MQTT_UPLOAD)
+// ============================================================================
+
+// Topics: <prefix>/<partner id>/<device guid>/datapoints and .../health.
+// Client id is the device GUID; username the partner id, password the API key
+#define MQTT_BROKER_HOST ""                 // Empty: host of the configured API URL
+#define MQTT_BROKER_PORT 8883
+#define MQTT_USE_TLS 1
+#define MQTT_TOPIC_PREFIX "seasense"
+#define MQTT_KEEPALIVE_S 60
+#define MQTT_INFLIGHT_WINDOW 4              // Unacked QoS1 publishes (max 8)
+#define MQTT_RECORDS_PER_PUBLISH 8          // About one measurement cycle per message
+#define MQTT_ACK_TIMEOUT_MS 20000           // No PUBACK/PINGRESP: reconnect and redeliver
+#define MQTT_RECONNECT_MIN_MS 2000
+#define MQTT_RECONNECT_MAX_MS 300000
+
+// ============================================================================
+// Quality Control (QARTOD-style flags on every record)
+// ============================================================================
+
+#define QC_CLIMATOLOGY_MIN_SAMPLES 24       // Accepted values before the climatology test runs
+#define QC_CLIMATOLOGY_ALPHA 0.02f          // Weight of a new value in the running mean/variance
+#define QC_CLIMATOLOGY_SIGMA 4.0f           // Suspect beyond this many sigma from the mean
+#define QC_FLAT_SUSPECT_COUNT 3             // Consecutive repeats of one value: suspect
+#define QC_FLAT_FAIL_COUNT 6                // ... and fail
+#define QC_HISTORY_MAX_GAP_MS 7200000       // Spike/rate-of-change restart after a 2 h gap
+#define QC_MV_TEMP_DIFF_C 2.0f              // Probe vs boat water temperature transducer
+#define QC_MV_COMPANION_MAX_AGE_MS 120000   // Temperature/EC result must be from this cycle
+
+// ============================================================================
+// Derived Variables (DO saturation, sound speed, true wind)
+// ============================================================================
+
+#define DERIVED_INPUT_MAX_AGE_MS 120000     // Sensor inputs must be from this cycle
+#define DERIVED_INTAKE_DEPTH_M 0.5f         // Water intake depth for sound speed
+
 // ============================================================================
 // WiFi Configuration
 // ============================================================================
@@ -124,11 +240,43 @@
 #define WIFI_STATION_CONNECT_TIMEOUT_MS 10000  // 10 seconds
 #define WIFI_STATION_RECONNECT_INTERVAL_MS 60000  // Try to reconnect every 60 seconds
 
+// Web API: gzip streamed JSON responses for clients that accept it
+// (responses shorter than one JsonStream buffer always go out plain)
+#define WEB_GZIP_ENABLED true
+
 // NTP Configuration (for API time sync)
 #define NTP_SERVER "pool.ntp.org"
 #define NTP_GMT_OFFSET_SEC 0       // UTC offset (0 for UTC)
 #define NTP_DAYLIGHT_OFFSET_SEC 0  // Daylight saving offset
 
+// ============================================================================
+// Time Service
+// ============================================================================
+
+// GPS/N2K time re-anchors the clock at most this often (NTP: on each sync)
+#define TIME_RESYNC_INTERVAL_MS 600000UL      // 10 minutes
+
+// NTP is ignored while a GNSS sync is younger than this
+#define TIME_GNSS_HOLDOVER_MS 3600000UL       // 1 hour
+
+// Drift is only estimated over spans at least this long (GPS time has
+// whole-second resolution; ~100 ms of jitter over an hour is ~30 ppm)
+#define TIME_DRIFT_MIN_SPAN_MS 3600000UL      // 1 hour
+#define TIME_DRIFT_GAIN 0.25f                 // Fraction of each measured error applied
+#define TIME_MAX_DRIFT_PPM 200.0f             // Clamp (ESP32 crystal is ~±20 ppm)
+
+// Records written before the first sync are repaired in place, this many
+// per loop() pass
+#define TIME_BACKFILL_BATCH 20
+
+// Back-fill gives up once the data file has failed to open for this long
+// (the placeholders stay; uploads and segment close stop waiting on it)
+#define TIME_BACKFILL_GIVE_UP_MS 60000
+
+// Uploads waiting on the back-fill look again after this long (not a
+// failure: the retry backoff is left alone)
+#define TIME_BACKFILL_RECHECK_MS 5000
+
 // ============================================================================
 // Serial Configuration
 // ============================================================================
@@ -146,6 +294,13 @@
 #define SD_CSV_FILENAME "/sd/seasense_data.csv"
 #define SD_WRITE_BUFFER_SIZE 512
 
+// SD archive: the live CSV is closed as a segment at this many records, then
+// compacted in the background into Gorilla-compressed columnar blocks
+#define ARCHIVE_SEGMENT_RECORDS 4096
+#define ARCHIVE_BLOCK_RECORDS 512           // records per compressed block
+#define ARCHIVE_COMPACT_BATCH 32            // segment lines per compaction pass
+#define ARCHIVE_COMPACT_INTERVAL_MS 1000UL  // between compaction passes
+
 // ============================================================================
 // NMEA2000 Device Identification
 // ============================================================================
@@ -156,6 +311,29 @@
 #define NMEA2000_DEVICE_CLASS 60         // Sensor/Communication Interface
 #define NMEA2000_INDUSTRY_GROUP 4        // Marine industry
 
+// Product information (PGN 126996, also used for the library's own responses)
+#define N2K_PRODUCT_CODE 1
+#define N2K_MODEL_ID "SeaSense Logger"
+#define N2K_MODEL_SERIAL "SEASENSE-001"
+#define N2K_SOFTWARE_VERSION "2.0.0"
+#define N2K_HARDWARE_VERSION "1.0"
+
+// ============================================================================
+// NMEA2000 Output (water quality PGNs, only when output is enabled)
+// ============================================================================
+
+#define N2K_PREFERRED_ADDRESS 35          // Source address to claim; the library moves on if taken
+#define N2K_TX_QUEUE_LEN 16               // Messages waiting for the bus
+#define N2K_TX_HW_QUEUE_LEN 16            // TWAI driver transmit queue (frames)
+#define N2K_TX_FRAMES_PER_SEC 50          // Our share of the bus (~2% at 250 kbps)
+#define N2K_TX_BURST_FRAMES 20            // Token bucket depth: one full product-info message
+#define N2K_TX_MAX_RETRIES 25             // Refused frames before a message is dropped
+
+#define N2K_TEMPERATURE_INSTANCE 0
+#define N2K_WATER_TX_INTERVAL_MS 2000     // 130312/130316 repeat rate (spec: 2 s)
+#define N2K_SALINITY_TX_INTERVAL_MS 10000 // 130321 repeat rate
+#define N2K_VALUE_MAX_AGE_MS 1800000      // Stop repeating a reading older than 30 min
+
 // ============================================================================
 // System Health / Watchdog Configuration
 // ============================================================================
@@ -163,11 +341,99 @@
 #define WDT_TIMEOUT_MS 30000              // 30 second watchdog timeout
 #define BOOT_LOOP_THRESHOLD 5             // Consecutive reboots before safe mode
 #define BOOT_LOOP_WINDOW_MS 120000        // 2 min stable operation clears counter
-#define I2C_BUS_RESET_THRESHOLD 8         // Consecutive sensor fails before bus reset
 #define EZO_HARD_TIMEOUT_MS 3000          // Absolute max wait for any EZO command
 #define API_CONNECT_TIMEOUT_MS 5000       // HTTP connect timeout (DNS + TCP)
 #define WEB_SERVER_TASK_STACK_SIZE 16384  // Stack for Core 0 web server task
 
+// ============================================================================
+// Recovery (graduated per-subsystem escalation)
+// ============================================================================
+
+// Ladder: retry -> reset -> reinit -> disable -> reboot (critical subsystems only)
+#define RECOVERY_BACKOFF_BASE_MS 5000        // Wait after the first action, doubles per level
+#define RECOVERY_BACKOFF_MAX_MS 300000       // Backoff cap (5 min)
+#define RECOVERY_PROBE_INTERVAL_MS 600000    // Re-probe a disabled subsystem every 10 min
+#define RECOVERY_REBOOT_MIN_UPTIME_MS 3600000  // No recovery reboot in the first hour (no reboot storms)
+#define RECOVERY_POLL_INTERVAL_MS 10000      // Health polling for WiFi/GPS/N2K/IMU from loop()
+
+// Consecutive failures before a subsystem counts as degraded
+#define RECOVERY_I2C_FAILURE_THRESHOLD 1     // Measurement cycles where every sensor failed
+#define RECOVERY_SD_FAILURE_THRESHOLD 1      // Failed SD writes
+#define RECOVERY_SPIFFS_FAILURE_THRESHOLD 2  // Failed SPIFFS writes
+#define RECOVERY_WIFI_FAILURE_THRESHOLD 12   // Polls without a station link (2 min)
+#define RECOVERY_STALE_FAILURE_THRESHOLD 3   // Polls with stale GPS/N2K/IMU data
+
+#define RECOVERY_GPS_STALE_MS 10000          // Onboard/N2K position older than this is stale
+#define RECOVERY_IMU_STALE_MS 5000           // IMU orientation older than this is stale
+
+// ============================================================================
+// OTA Update Configuration
+// ============================================================================
+
+#define OTA_TASK_STACK_SIZE 8192          // Background download task (Core 0)
+#define OTA_TASK_PRIORITY 1               // Same as web server task; never starves loop()
+#define OTA_DOWNLOAD_BUFFER_SIZE 4096     // Network read chunk (heap, freed after update)
+#define OTA_MAX_RESUME_ATTEMPTS 8         // HTTP Range resumes before giving up
+#define OTA_RESUME_BACKOFF_MS 2000        // Base delay between resumes (doubles, max 30s)
+#define OTA_STALL_TIMEOUT_MS 15000        // No bytes for this long = dropped link
+
+// ============================================================================
+// Power Management
+// ============================================================================
+
+#define POWER_LIGHT_SLEEP_ENABLED 1       // Light sleep between cycles when the radio is idle
+#define POWER_CPU_MAX_MHZ 240             // Frequency scaling range
+#define POWER_CPU_MIN_MHZ 80              // APB stays at 80 MHz: UART/I2C timing unaffected
+#define POWER_IDLE_SLICE_MS 20            // loop() yield when it can't sleep
+#define POWER_MIN_LIGHT_SLEEP_MS 500      // Shorter gaps aren't worth the wake-up cost
+#define POWER_MAX_LIGHT_SLEEP_MS 3000     // Cap so the AP keeps beaconing often enough to be found
+#define POWER_MEASURE_PREWAKE_MS 2000     // Wake before a measurement for fresh GPS/N2K data
+#define POWER_EARLY_WAKE_LIMIT 3          // Consecutive early wakes (busy CAN bus) before backing off
+#define POWER_EARLY_WAKE_BACKOFF_MS 60000 // No light sleep for this long after that
+#define POWER_WEB_POLL_ACTIVE_MS 1        // Web task poll while an AP client is connected
+#define POWER_WEB_POLL_IDLE_MS 20         // Web task poll otherwise
+
+// Board-level current estimates for the energy report (measure your build)
+#define POWER_CURRENT_ACTIVE_MA 110.0f
+#define POWER_CURRENT_IDLE_MA 45.0f
+#define POWER_CURRENT_SLEEP_MA 8.0f
+
+// ============================================================================
+// Input Capture (record GPS/CAN/IMU streams to SD for host replay)
+// ============================================================================
+
+#define CAPTURE_DIR "/capture"
+#define CAPTURE_BUFFER_SIZE 16384         // RAM buffer, allocated only while capturing
+#define CAPTURE_FLUSH_INTERVAL_MS 1000    // Write to SD at least this often (or when half full)
+#define CAPTURE_MAX_FILE_BYTES 67108864   // Stop at 64 MB
+
+// ============================================================================
+// Flight Recorder (RTC memory, survives watchdog/panic resets)
+// ============================================================================
+
+#define FLIGHT_STAGE_HISTORY 48           // Loop stage transitions kept (~4 loop passes)
+#define FLIGHT_STAGE_NAMES 32             // Distinct stage names
+#define FLIGHT_EVENT_HISTORY 16           // Last warnings/errors from the event log
+#define FLIGHT_SAMPLE_INTERVAL_MS 1000    // Heap/clock sample from loop()
+
+// ============================================================================
+// Event Log (deferred LOG_* output: serial, SD, /api/logs)
+// ============================================================================
+
+#define LOG_RING_SIZE 128                 // Events kept in RAM (power of two, ~110 bytes each)
+#define LOG_DEFAULT_LEVEL 2               // 0 error, 1 warn, 2 info, 3 debug (runtime: LOG / /api/logs/level)
+#define LOG_SD_DEFAULT_LEVEL 1            // Warnings and errors are also kept on SD
+#define LOG_TASK_STACK_SIZE 4096          // Drain task (Core 0)
+#define LOG_TASK_PRIORITY 1               // Same as web server task; never starves loop()
+#define LOG_DRAIN_INTERVAL_MS 20          // Drain task wake-up
+#define LOG_DRAIN_BATCH 16                // Events formatted per wake-up
+#define LOG_LINE_BYTES 160                // Formatted line, longer ones are truncated
+#define LOG_SD_FILE "/log.txt"
+#define LOG_SD_OLD_FILE "/log.old"        // Previous log after rotation
+#define LOG_SD_MAX_BYTES 1048576          // Rotate at 1 MB
+#define LOG_SD_BUFFER_BYTES 2048          // SD lines batched in RAM
+#define LOG_SD_FLUSH_INTERVAL_MS 10000    // ... and written at least this often
+
 // ============================================================================
 // Debug Configuration
 // ============================================================================
@@ -5,8 +5,12 @@ set -euo pipefail
 # Usage:
 #   ./scripts/build.sh s3
 #   ./scripts/build.sh s3-octal
+#   ./scripts/build.sh s3 -DFEATURE_IMU=0 -DFEATURE_N2K=0   (drop subsystems,
+#                                      see "Feature Selection" in hardware_config.h)
 
 TARGET="${1:-s3}"
+shift || true
+EXTRA_FLAGS="$*"
 SKETCH_DIR="$(cd "$(dirname "$0")/.." && pwd)"
 
 case "$TARGET" in
@@ -24,4 +28,9 @@ case "$TARGET" in
 esac
 
 echo "FQBN: $FQBN"
-arduino-cli compile --fqbn "$FQBN" "$SKETCH_DIR"
+ARGS=(--fqbn "$FQBN")
+if [ -n "$EXTRA_FLAGS" ]; then
+  echo "Flags: $EXTRA_FLAGS"
+  ARGS+=(--build-property "compiler.cpp.extra_flags=$EXTRA_FLAGS")
+fi
+arduino-cli compile "${ARGS[@]}" "$SKETCH_DIR"
@@ -4,10 +4,17 @@
 
 #include "APIUploader.h"
 #include "../system/SystemHealth.h"
+#include "../system/TimeService.h"
+#include "../system/EventLog.h"
+#include "../system/FlightRecorder.h"
+#include "../sensors/QualityControl.h"
+#include "../storage/RecordSchema.h"
 #include "../config/ConfigManager.h"
 #include "../../config/hardware_config.h"
 #include "../../config/secrets.h"
 #include <ArduinoJson.h>
+#include <esp_sntp.h>
+#include <sys/time.h>
 // Note: gzip compression removed — ESP32-targz didn't support ESP32-S3,
 // and ROM miniz disables zlib APIs. Payloads are sent uncompressed.
 
@@ -21,6 +28,17 @@ const unsigned long RETRY_INTERVALS[] = {
 };
 const uint8_t MAX_RETRY_INTERVALS = 5;
 
+// Host part of an http(s) URL
+static String hostFromUrl(const String& url) {
+    int start = url.indexOf("://");
+    start = (start < 0) ? 0 : start + 3;
+    int end = start;
+    while (end < (int)url.length() && url[end] != '/' && url[end] != ':') {
+        end++;
+    }
+    return url.substring(start, end);
+}
+
 // ============================================================================
 // Constructor
 // ============================================================================
@@ -32,17 +50,27 @@ APIUploader::APIUploader(StorageManager* storage)
       _lastScheduledTime(0),
       _currentIntervalMs(0),
       _retryCount(0),
-      _timeSynced(false),
-      _bootTimeEpoch(0),
       _historyCount(0),
       _historyHead(0),
       _totalBytesSent(0),
       _lastPayloadBytes(0),
       _lastAttemptTime(0),
       _lastError(""),
-      _forcePending(false)
+      _forcePending(false),
+      _mqtt(&_mqttLink),
+      _mqttQueued(0),
+      _mqttStore(nullptr),
+      _mqttNextRecord(0),
+      _mqttHealthDue(true),
+      _mqttWasConnected(false),
+      _postMortemPacketId(0),
+      _mqttIntervalStart(0),
+      _mqttIntervalRecords(0),
+      _mqttIntervalBytes(0),
+      _mqttLastAckedMillis(0)
 {
     memset(_uploadHistory, 0, sizeof(_uploadHistory));
+    memset(_mqttBatches, 0, sizeof(_mqttBatches));
 }
 
 // ============================================================================
@@ -66,6 +94,15 @@ bool APIUploader::begin(const UploadConfig& config) {
     Serial.print("[API] Batch size: ");
     Serial.println(_config.batchSize);
 
+    if constexpr (FEATURE_MQTT_UPLOAD) {
+        configureMqtt();
+        _mqttIntervalStart = millis();
+        Serial.print("[API] Transport: MQTT ");
+        Serial.print(_mqttLink.getHost());
+        Serial.print(":");
+        Serial.println(_mqttLink.getPort());
+    }
+
     // Initial NTP sync attempt
     if (isWiFiConnected()) {
         if (syncNTP()) {
@@ -91,6 +128,11 @@ void APIUploader::process() {
 
     unsigned long now = millis();
 
+    if constexpr (FEATURE_MQTT_UPLOAD) {
+        processMqtt(now);
+        return;
+    }
+
     // Check if it's time for next upload (elapsed-time pattern, rollover-safe),
     // unless a forced upload was queued from the web UI.
     if (!_forcePending && (now - _lastScheduledTime < _currentIntervalMs)) {
@@ -110,16 +152,8 @@ void APIUploader::process() {
         return;
     }
 
-    // Sync NTP if not already synced
-    if (!_timeSynced) {
-        _status = UploadStatus::SYNCING_TIME;
-        if (!syncNTP()) {
-            _status = UploadStatus::ERROR_NO_TIME;
-            _lastError = "NTP time sync failed";
-            Serial.println("[API] NTP sync failed, cannot upload without timestamps");
-            scheduleRetry();
-            return;
-        }
+    if (!prepareTimestamps(now)) {
+        return;
     }
 
     // Query data from storage — use record count to skip already-uploaded records.
@@ -129,8 +163,12 @@ void APIUploader::process() {
     StorageStats stats = _storage->getStats();
     uint32_t alreadyUploaded = stats.totalRecords - stats.recordsSinceUpload;
 
-    // Read only the batch we need, skipping already-uploaded records in storage
-    std::vector<DataRecord> records = _storage->readRecords(0, _config.batchSize, alreadyUploaded);
+    // Read only the batch we need, skipping already-uploaded records in storage;
+    // the payload has no use for the satellite count, unit or quality columns
+    RecordQuery query;
+    query.fields = RecordField::ALL & ~(RecordField::GPS_SATELLITES | RecordField::UNIT
+                                        | RecordField::QUALITY);
+    std::vector<DataRecord> records = _storage->queryRecords(query, _config.batchSize, alreadyUploaded);
 
     if (records.empty()) {
         _status = UploadStatus::ERROR_NO_DATA;
@@ -141,16 +179,15 @@ void APIUploader::process() {
         return;
     }
 
-    Serial.print("[API] Uploading ");
-    Serial.print(records.size());
-    Serial.print(" of ");
-    Serial.print(stats.recordsSinceUpload);
-    Serial.println(" pending records...");
+    LOG_INFO("API", "Uploading %u of %lu pending records...",
+             (unsigned)records.size(), (unsigned long)stats.recordsSinceUpload);
 
     // Feed watchdog before building payload
     systemHealth.feedWatchdog();
 
-    // Build payload
+    // Build payload (carries the last crash's flight record until one succeeds)
+    extern FlightRecorder flightRecorder;
+    bool withPostMortem = flightRecorder.hasPostMortem();
     String payload = buildPayload(records);
 
     // Feed watchdog before uploading
@@ -163,48 +200,29 @@ void APIUploader::process() {
     bool ok = uploadPayload(payload);
     unsigned long uploadDur = millis() - uploadStart;
 
-    // Record history entry (in-memory)
-    UploadRecord rec;
-    rec.startMs      = uploadStart;
-    rec.durationMs   = uploadDur;
-    rec.success      = ok;
-    rec.recordCount  = ok ? (uint32_t)records.size() : 0;
-    rec.payloadBytes = _lastPayloadBytes;
-    _uploadHistory[_historyHead] = rec;
-    _historyHead = (_historyHead + 1) % UPLOAD_HISTORY_SIZE;
-    if (_historyCount < UPLOAD_HISTORY_SIZE) _historyCount++;
+    recordHistory(uploadStart, uploadDur, ok, ok ? (uint32_t)records.size() : 0, _lastPayloadBytes);
     if (ok) _totalBytesSent += _lastPayloadBytes;
 
-    // Persist history entry to SPIFFS (survives reboots)
-    {
-        time_t recEpoch = time(nullptr);
-        SPIFFSStorage::PersistedUploadRecord prec;
-        prec.epochTime = (recEpoch > 1000000000) ? (int64_t)recEpoch : 0;
-        prec.durationMs = uploadDur;
-        prec.success = ok;
-        prec.recordCount = ok ? (uint32_t)records.size() : 0;
-        prec.payloadBytes = _lastPayloadBytes;
-        _storage->addUploadHistoryRecord(prec);
-    }
-
     if (ok) {
         _status = UploadStatus::SUCCESS;
         _lastError = "";
         _lastUploadTime = now;
 
-        // Mark these records as uploaded (persists count to SPIFFS metadata)
-        _storage->setLastUploadedMillis(records[records.size() - 1].millis);
+        // Mark these records as uploaded (persists count to SPIFFS metadata);
+        // records past the batch stay pending for the next one
+        _storage->advanceUploadCursor(records.size(), records[records.size() - 1].millis);
 
         // Persist last successful upload epoch (survives reboots, unlike millis)
-        time_t nowEpoch = time(nullptr);
-        if (nowEpoch > 1000000000) _storage->setLastSuccessEpoch((int64_t)nowEpoch);
+        extern TimeService timeService;
+        _storage->setLastSuccessEpoch(timeService.epochMs(millis()) / 1000);
 
         // Update persistent lifetime upload counter
         _storage->addBytesUploaded(_lastPayloadBytes);
 
-        Serial.print("[API] Upload successful! ");
-        Serial.print(records.size());
-        Serial.println(" records uploaded");
+        LOG_INFO("API", "Upload successful! %u records uploaded", (unsigned)records.size());
+        if (withPostMortem) {
+            flightRecorder.clearPostMortem();
+        }
 
         // Reset retry and schedule next upload (elapsed-time pattern)
         resetRetry();
@@ -213,8 +231,7 @@ void APIUploader::process() {
     } else {
         _status = UploadStatus::ERROR_API;
         // _lastError already set by uploadPayload()
-        Serial.print("[API] Upload failed: ");
-        Serial.println(_lastError);
+        LOG_WARN("API", "Upload failed: %s", _lastError);
         extern SystemHealth systemHealth;
         systemHealth.recordError(ErrorType::API);
         scheduleRetry();
@@ -251,14 +268,37 @@ unsigned long APIUploader::getTimeUntilNext() const {
     if (elapsed >= _currentIntervalMs) {
         return 0;
     }
-    return _currentIntervalMs - elapsed;
+    unsigned long next = _currentIntervalMs - elapsed;
+
+    // The session needs the loop for pings, reconnects and waiting acks.
+    // Publishes waiting for a connection only need it when the backoff or
+    // CONNACK timeout is up
+    if constexpr (FEATURE_MQTT_UPLOAD) {
+        if (_mqtt.isConnected() && _mqtt.getInFlight() > 0) {
+            return 0;
+        }
+        next = min(next, _mqtt.getTimeUntilDue(now));
+    }
+    return next;
+}
+
+void APIUploader::setDeviceGUID(const String& guid) {
+    _config.deviceGUID = guid;
+
+    // New client id and topics: reconnect as the new device
+    if constexpr (FEATURE_MQTT_UPLOAD) {
+        if (_config.enabled) {
+            _mqtt.disconnect(millis(), "Device GUID changed");
+            configureMqtt();
+        }
+    }
 }
 
 void APIUploader::forceUpload() {
     _forcePending = true;
     _lastScheduledTime = 0;
     _currentIntervalMs = 0;
-    Serial.println("[API] Forced upload queued");
+    LOG_INFO("API", "Forced upload queued");
 }
 
 // ============================================================================
@@ -269,19 +309,53 @@ bool APIUploader::isWiFiConnected() const {
     return (WiFi.status() == WL_CONNECTED);
 }
 
+bool APIUploader::prepareTimestamps(unsigned long now) {
+    // Time normally comes from GPS/N2K; NTP when nothing has synced yet or
+    // GNSS has been silent for the holdover period
+    extern TimeService timeService;
+    if (!timeService.isSynced()) {
+        _status = UploadStatus::SYNCING_TIME;
+        if (!syncNTP()) {
+            _status = UploadStatus::ERROR_NO_TIME;
+            _lastError = "NTP time sync failed";
+            LOG_ERROR("API", "NTP sync failed, cannot upload without timestamps");
+            scheduleRetry();
+            return false;
+        }
+    } else if (timeService.getLastSyncAgeMs(now) >= TIME_GNSS_HOLDOVER_MS) {
+        syncNTP();  // best effort: holdover keeps running if it fails
+    }
+
+    // Records stored before the sync are still being stamped by loop()
+    if (_storage->isBackfillPending()) {
+        _status = UploadStatus::SYNCING_TIME;
+        DEBUG_API_PRINTLN("Timestamp back-fill pending, upload deferred");
+        _lastScheduledTime = now;
+        _currentIntervalMs = TIME_BACKFILL_RECHECK_MS;
+        return false;
+    }
+    return true;
+}
+
 bool APIUploader::syncNTP() {
     DEBUG_API_PRINTLN("Syncing NTP...");
 
+    // The system clock may already hold GPS time (set by the time service),
+    // so wait for SNTP itself to report a completed sync
+    sntp_set_sync_status(SNTP_SYNC_STATUS_RESET);
     configTime(NTP_GMT_OFFSET_SEC, NTP_DAYLIGHT_OFFSET_SEC, NTP_SERVER);
 
     // Non-blocking wait for time sync (max 5 seconds)
     extern SystemHealth systemHealth;
-    unsigned long deadline = millis() + 5000;
-    while (millis() < deadline) {
-        time_t now = time(nullptr);
-        if (now > 1000000000) {  // Valid timestamp
-            _bootTimeEpoch = now - (millis() / 1000);
-            _timeSynced = true;
+    extern TimeService timeService;
+    unsigned long start = millis();
+    while (millis() - start < 5000) {
+        struct timeval tv;
+        gettimeofday(&tv, nullptr);
+        time_t now = tv.tv_sec;
+        if (sntp_get_sync_status() == SNTP_SYNC_STATUS_COMPLETED && now > 1000000000) {
+            timeService.sync(TimeSource::NTP,
+                             (int64_t)tv.tv_sec * 1000 + tv.tv_usec / 1000, millis());
 
             struct tm timeinfo;
             localtime_r(&now, &timeinfo);
@@ -297,29 +371,22 @@ bool APIUploader::syncNTP() {
     return false;
 }
 
-String APIUploader::millisToUTC(unsigned long millisTimestamp) const {
-    if (!_timeSynced) {
-        return "";
-    }
-
-    // Calculate absolute epoch time
-    time_t epoch = _bootTimeEpoch + (millisTimestamp / 1000);
-
-    // Convert to ISO 8601 format
-    struct tm timeinfo;
-    gmtime_r(&epoch, &timeinfo);
-
-    char buffer[32];
-    strftime(buffer, sizeof(buffer), "%Y-%m-%dT%H:%M:%SZ", &timeinfo);
-
-    return String(buffer);
+bool APIUploader::isTimeSynced() const {
+    extern TimeService timeService;
+    return timeService.isSynced();
 }
 
 String APIUploader::buildPayload(const std::vector<DataRecord>& records) const {
     JsonDocument doc;
+    addMetadata(doc["metadata"].to<JsonObject>());
+    addDatapoints(records, doc["datapoints"].to<JsonArray>());
+
+    String payload;
+    serializeJson(doc, payload);
+    return payload;
+}
 
-    // Metadata
-    JsonObject metadata = doc["metadata"].to<JsonObject>();
+void APIUploader::addMetadata(JsonObject metadata) const {
     metadata["schema_version"] = "1.0";
     metadata["partner_id"] = _config.partnerID;
     metadata["device_guid"] = _config.deviceGUID;
@@ -327,7 +394,8 @@ String APIUploader::buildPayload(const std::vector<DataRecord>& records) const {
     JsonObject collector = metadata["collector"].to<JsonObject>();
     collector["device"] = "SeaSense ESP32 Logger";
     collector["firmware_version"] = FIRMWARE_VERSION;
-    collector["export_generated_at_utc"] = millisToUTC(millis());
+    extern TimeService timeService;
+    collector["export_generated_at_utc"] = timeService.nowUTC(millis());
 
     // Device health telemetry (piggybacks on every upload)
     extern SystemHealth systemHealth;
@@ -342,10 +410,12 @@ String APIUploader::buildPayload(const std::vector<DataRecord>& records) const {
     health["sd_errors"] = systemHealth.getErrorCount(ErrorType::SD);
     health["api_errors"] = systemHealth.getErrorCount(ErrorType::API);
     health["wifi_errors"] = systemHealth.getErrorCount(ErrorType::WIFI);
+    addPostMortem(health);
 
     // Deployment metadata
     extern ConfigManager configManager;
-    ConfigManager::DeploymentConfig dep = configManager.getDeploymentConfig();
+    ConfigManager::SnapshotPtr cfg = configManager.snapshot();
+    const ConfigManager::DeploymentConfig& dep = cfg->deployment;
     if (dep.deployDate.length() > 0) {
         metadata["deploy_date"] = dep.deployDate;
     }
@@ -355,16 +425,20 @@ String APIUploader::buildPayload(const std::vector<DataRecord>& records) const {
     if (dep.depthCm > 0) {
         metadata["depth_cm"] = dep.depthCm;
     }
+}
 
-    // Datapoints
-    JsonArray datapoints = doc["datapoints"].to<JsonArray>();
-
+void APIUploader::addDatapoints(const std::vector<DataRecord>& records, JsonArray datapoints) const {
     for (const DataRecord& record : records) {
         JsonObject dp = datapoints.add<JsonObject>();
 
-        // Timestamp (from GPS or NTP)
-        String utcTime = record.timestampUTC.length() > 0 ? record.timestampUTC : millisToUTC(record.millis);
-        dp["timestamp_utc"] = utcTime;
+        // Timestamp (from the time service, or back-filled after sync).
+        // Empty only for records from an earlier boot that never synced:
+        // their millis() can't be placed in time, so send null
+        if (record.timestampUTC.length() > 0) {
+            dp["timestamp_utc"] = record.timestampUTC;
+        } else {
+            dp["timestamp_utc"] = nullptr;
+        }
 
         // GPS location data (if available and not NaN)
         if (!isnan(record.latitude) && !isnan(record.longitude)
@@ -392,38 +466,92 @@ String APIUploader::buildPayload(const std::vector<DataRecord>& records) const {
             dp["water_dissolved_oxygen_mg_l"] = record.value;
         }
 
-        // Metadata fields (forward compatibility)
-        dp["sensor_model"] = record.sensorModel;
-        dp["sensor_serial"] = record.sensorSerial;
-        dp["sensor_instance"] = record.sensorInstance;
-        dp["calibration_date"] = record.calibrationDate;
-
-        // NMEA2000 environmental context (only include non-NaN fields)
-        if (!isnan(record.windSpeedTrue))     dp["wind_speed_true_ms"] = record.windSpeedTrue;
-        if (!isnan(record.windAngleTrue))     dp["wind_angle_true_deg"] = record.windAngleTrue;
-        if (!isnan(record.windSpeedApparent)) dp["wind_speed_app_ms"] = record.windSpeedApparent;
-        if (!isnan(record.windAngleApparent)) dp["wind_angle_app_deg"] = record.windAngleApparent;
-        if (!isnan(record.waterDepth))        dp["water_depth_m"] = record.waterDepth;
-        if (!isnan(record.speedThroughWater)) dp["speed_through_water_ms"] = record.speedThroughWater;
-        if (!isnan(record.waterTempExternal)) dp["water_temp_external_c"] = record.waterTempExternal;
-        if (!isnan(record.airTemp))           dp["air_temp_c"] = record.airTemp;
-        if (!isnan(record.baroPressure))      dp["baro_pressure_pa"] = record.baroPressure;
-        if (!isnan(record.humidity))          dp["humidity_pct"] = record.humidity;
-        if (!isnan(record.cogTrue))           dp["cog_true_deg"] = record.cogTrue;
-        if (!isnan(record.sog))              dp["sog_ms"] = record.sog;
-        if (!isnan(record.heading))           dp["heading_true_deg"] = record.heading;
-        if (!isnan(record.pitch))             dp["pitch_deg"] = record.pitch;
-        if (!isnan(record.roll))              dp["roll_deg"] = record.roll;
-        if (!isnan(record.windSpeedCorrected)) dp["wind_speed_corr_ms"] = record.windSpeedCorrected;
-        if (!isnan(record.windAngleCorrected)) dp["wind_angle_corr_deg"] = record.windAngleCorrected;
-        if (!isnan(record.linAccelX))          dp["lin_accel_x"] = record.linAccelX;
-        if (!isnan(record.linAccelY))          dp["lin_accel_y"] = record.linAccelY;
-        if (!isnan(record.linAccelZ))          dp["lin_accel_z"] = record.linAccelZ;
+        // QARTOD QC: aggregate flag plus one digit per test
+        QcFlags qc(record.qcFlags);
+        if (qc.isSet()) {
+            dp["qc_flag"] = (int)qc.aggregate();
+            dp["qc_flags"] = qc.toString();
+        }
+
+        // Sensor metadata, NMEA2000 environmental context and derived
+        // values: every schema field with an upload key (NaN left out)
+        RecordSchema::toJSON(record, dp);
     }
+}
 
-    String payload;
-    serializeJson(doc, payload);
-    return payload;
+void APIUploader::addPostMortem(JsonObject health) const {
+    extern FlightRecorder flightRecorder;
+    if (!flightRecorder.hasPostMortem()) {
+        return;
+    }
+    JsonObject pm = health["post_mortem"].to<JsonObject>();
+    char hex[11];
+
+    if (flightRecorder.hasPostMortemRecord()) {
+        const FlightRecord& r = flightRecorder.getPostMortem();
+        pm["firmware_version"] = r.firmware;
+        pm["boot_count"] = r.bootCount;
+        pm["reset_reason"] = SystemHealth::resetReasonName((esp_reset_reason_t)r.resetReason);
+        pm["uptime_ms"] = r.lastMs;
+        if (r.epoch > 0) {
+            pm["epoch"] = r.epoch;
+        }
+        pm["stage"] = FlightRecorder::stageName(r, r.stage);
+        pm["stage_entered_ms"] = r.stageStartMs;
+
+        JsonObject heap = pm["heap"].to<JsonObject>();
+        heap["free"] = r.freeHeap;
+        heap["min_free"] = r.minFreeHeap;
+        heap["largest_block"] = r.largestBlock;
+
+        JsonObject loopStats = pm["loop"].to<JsonObject>();
+        loopStats["count"] = r.loopCount;
+        loopStats["last_gap_ms"] = r.lastGapMs;
+        loopStats["max_gap_ms"] = r.maxGapMs;
+
+        JsonArray stages = pm["stages"].to<JsonArray>();
+        for (uint8_t i = 0; i < r.stageCount; i++) {
+            const FlightStage& st = FlightRecorder::stageAt(r, i);
+            JsonObject row = stages.add<JsonObject>();
+            row["name"] = FlightRecorder::stageName(r, st.name);
+            row["at_ms"] = st.startMs;
+            row["dur_ms"] = st.durationMs;
+        }
+
+        JsonObject slowest = pm["stage_max_ms"].to<JsonObject>();
+        for (uint8_t i = 0; i < r.nameCount; i++) {
+            if (r.stageMaxMs[i] > 0) {
+                slowest[r.names[i]] = r.stageMaxMs[i];
+            }
+        }
+
+        JsonArray events = pm["events"].to<JsonArray>();
+        for (uint8_t i = 0; i < r.eventCount; i++) {
+            const FlightEvent& ev = FlightRecorder::eventAt(r, i);
+            JsonObject e = events.add<JsonObject>();
+            e["ms"] = ev.ms;
+            e["level"] = EventLog::levelName((LogLevel)ev.level);
+            e["tag"] = ev.tag;
+            e["msg"] = ev.msg;
+        }
+    }
+
+    const CoredumpSummary& cd = flightRecorder.getCoredump();
+    JsonObject core = pm["coredump"].to<JsonObject>();
+    core["present"] = cd.present;
+    if (cd.present) {
+        core["size"] = cd.size;
+        core["task"] = cd.task;
+        snprintf(hex, sizeof(hex), "0x%08lx", (unsigned long)cd.pc);
+        core["pc"] = hex;
+        JsonArray bt = core["backtrace"].to<JsonArray>();
+        for (uint8_t i = 0; i < cd.depth; i++) {
+            snprintf(hex, sizeof(hex), "0x%08lx", (unsigned long)cd.backtrace[i]);
+            bt.add(hex);
+        }
+        core["corrupted"] = cd.corrupted;
+        core["elf_sha256"] = cd.elfSha;
+    }
 }
 
 bool APIUploader::uploadPayload(const String& payload) {
@@ -436,9 +564,7 @@ bool APIUploader::uploadPayload(const String& payload) {
     http.setConnectTimeout(API_CONNECT_TIMEOUT_MS);  // Fast DNS/connect failure
     http.setTimeout(10000);  // 10 second response timeout
 
-    Serial.print("[API] Payload size: ");
-    Serial.print(payload.length());
-    Serial.println(" bytes");
+    LOG_INFO("API", "Payload size: %u bytes", (unsigned)payload.length());
 
     // Send payload uncompressed
     _lastPayloadBytes = payload.length();
@@ -463,8 +589,7 @@ bool APIUploader::uploadPayload(const String& payload) {
                 if (otaVersion && strlen(otaVersion) > 0) {
                     String ver(otaVersion);
                     if (ver != FIRMWARE_VERSION) {
-                        Serial.print("[API] Backend requests OTA update to version: ");
-                        Serial.println(ver);
+                        LOG_INFO("API", "Backend requests OTA update to version: %s", ver);
                         http.end();
                         _otaCallback(ver);
                         return success;
@@ -474,33 +599,28 @@ bool APIUploader::uploadPayload(const String& payload) {
         }
     } else if (httpCode == 401 || httpCode == 403) {
         _lastError = "Authentication failed (HTTP " + String(httpCode) + ") - check API key";
-        Serial.print("[API] Auth error: ");
-        Serial.println(http.getString());
+        LOG_ERROR("API", "Auth error: %s", http.getString());
     } else if (httpCode == 400) {
         String body = http.getString();
         _lastError = "Bad request (400): " + body.substring(0, 80);
-        Serial.print("[API] Bad request: ");
-        Serial.println(body);
+        LOG_ERROR("API", "Bad request: %s", body);
     } else if (httpCode == 404) {
         _lastError = "Endpoint not found (404) - check API URL";
-        Serial.println("[API] 404 - endpoint not found");
+        LOG_ERROR("API", "404 - endpoint not found");
     } else if (httpCode == 429) {
         _lastError = "Rate limited (429) - too many requests";
-        Serial.println("[API] Rate limited");
+        LOG_WARN("API", "Rate limited");
     } else if (httpCode >= 500) {
         _lastError = "Server error (HTTP " + String(httpCode) + ")";
-        Serial.print("[API] Server error: ");
-        Serial.println(http.getString());
+        LOG_WARN("API", "Server error %d: %s", httpCode, http.getString());
     } else if (httpCode > 0) {
         _lastError = "Unexpected response (HTTP " + String(httpCode) + ")";
-        Serial.print("[API] HTTP " + String(httpCode) + ": ");
-        Serial.println(http.getString());
+        LOG_WARN("API", "HTTP %d: %s", httpCode, http.getString());
     } else {
         // Negative codes are HTTPClient errors (connection failures)
         String errStr = http.errorToString(httpCode);
         _lastError = errStr;
-        Serial.print("[API] Connection error: ");
-        Serial.println(errStr);
+        LOG_WARN("API", "Connection error: %s", errStr);
     }
 
     http.end();
@@ -527,7 +647,260 @@ void APIUploader::resetRetry() {
     _retryCount = 0;
 }
 
+void APIUploader::recordHistory(unsigned long startMs, unsigned long durationMs, bool success,
+                                uint32_t recordCount, size_t payloadBytes) {
+    // In-memory entry
+    UploadRecord rec;
+    rec.startMs      = startMs;
+    rec.durationMs   = durationMs;
+    rec.success      = success;
+    rec.recordCount  = recordCount;
+    rec.payloadBytes = payloadBytes;
+    _uploadHistory[_historyHead] = rec;
+    _historyHead = (_historyHead + 1) % UPLOAD_HISTORY_SIZE;
+    if (_historyCount < UPLOAD_HISTORY_SIZE) _historyCount++;
+
+    // Persist history entry to SPIFFS (survives reboots)
+    extern TimeService timeService;
+    SPIFFSStorage::PersistedUploadRecord prec;
+    prec.epochTime = timeService.epochMs(startMs) / 1000;
+    prec.durationMs = durationMs;
+    prec.success = success;
+    prec.recordCount = recordCount;
+    prec.payloadBytes = payloadBytes;
+    _storage->addUploadHistoryRecord(prec);
+}
+
 const UploadRecord* APIUploader::getUploadHistory(uint8_t& count) const {
     count = _historyCount;
     return _uploadHistory;
 }
+
+// ============================================================================
+// MQTT Transport
+// ============================================================================
+
+void APIUploader::configureMqtt() {
+    String host = MQTT_BROKER_HOST;
+    if (host.length() == 0) {
+        host = hostFromUrl(_config.apiUrl);
+    }
+    _mqttLink.setBroker(host, MQTT_BROKER_PORT, MQTT_USE_TLS);
+
+    String base = String(MQTT_TOPIC_PREFIX) + "/" + _config.partnerID + "/" + _config.deviceGUID;
+    _mqttDataTopic = base + "/datapoints";
+    _mqttHealthTopic = base + "/health";
+
+    MqttSessionConfig cfg;
+    cfg.clientId = _config.deviceGUID;
+    cfg.username = _config.partnerID;
+    cfg.password = _config.apiKey;
+    cfg.keepAliveSec = MQTT_KEEPALIVE_S;
+    cfg.window = MQTT_INFLIGHT_WINDOW;
+    cfg.connectTimeoutMs = API_CONNECT_TIMEOUT_MS * 2;
+    cfg.ackTimeoutMs = MQTT_ACK_TIMEOUT_MS;
+    cfg.reconnectMinMs = MQTT_RECONNECT_MIN_MS;
+    cfg.reconnectMaxMs = MQTT_RECONNECT_MAX_MS;
+    _mqtt.configure(cfg);
+    _mqtt.onAck([this](uint16_t packetId, uint32_t records, unsigned long lastMillis, size_t bytes) {
+        onMqttAck(packetId, records, lastMillis, bytes);
+    });
+}
+
+void APIUploader::processMqtt(unsigned long now) {
+    if (!isWiFiConnected()) {
+        _mqtt.disconnect(now, "No WiFi connection");
+        _status = UploadStatus::ERROR_NO_WIFI;
+        _lastError = "No WiFi connection";
+        return;
+    }
+
+    // Once per upload interval: time checks, history entry, health message
+    if (_forcePending || (now - _lastScheduledTime >= _currentIntervalMs)) {
+        _lastAttemptTime = now;
+        _forcePending = false;
+        flushMqttInterval(now);
+        if (prepareTimestamps(now)) {
+            resetRetry();
+            _lastScheduledTime = now;
+            _currentIntervalMs = _config.intervalMs;
+            _mqttHealthDue = true;
+        }
+    }
+
+    // Acks, keepalive, reconnect with backoff
+    extern SystemHealth systemHealth;
+    systemHealth.feedWatchdog();
+    _mqtt.poll(now);
+
+    if (_mqtt.isConnected() != _mqttWasConnected) {
+        _mqttWasConnected = _mqtt.isConnected();
+        if (_mqttWasConnected) {
+            LOG_INFO("API", "MQTT connected to %s (session %s)", _mqttLink.getHost(),
+                     _mqtt.wasSessionPresent() ? "resumed" : "new");
+        } else {
+            LOG_WARN("API", "MQTT connection lost: %s", _mqtt.getLastError());
+            systemHealth.recordError(ErrorType::API);
+        }
+    }
+
+    extern TimeService timeService;
+    if (!timeService.isSynced() || _storage->isBackfillPending()) {
+        return;     // status from prepareTimestamps()
+    }
+    if (!_mqtt.isConnected()) {
+        if (_mqtt.getState() == MqttState::CONNECTING) {
+            _status = UploadStatus::UPLOADING;
+        } else {
+            _status = UploadStatus::ERROR_API;
+            _lastError = _mqtt.getLastError();
+        }
+        return;
+    }
+
+    if (_mqttHealthDue && _mqtt.canPublish()) {
+        publishHealth();
+    }
+    fillMqttWindow();
+
+    if (_mqtt.getInFlight() > 0) {
+        _status = UploadStatus::UPLOADING;
+    } else {
+        _status = _mqtt.getAckedCount() > 0 ? UploadStatus::SUCCESS : UploadStatus::IDLE;
+    }
+    _lastError = "";
+}
+
+void APIUploader::fillMqttWindow() {
+    uint32_t total, pending;
+    _storage->getUploadProgress(total, pending);
+    const IStorage* store;
+    uint32_t cursor;
+    _storage->getUploadPosition(store, cursor);
+
+    // Cleared, trimmed past the cursor or another store since the records in
+    // flight were queued: they are not the next pending ones any more, so
+    // start again from the cursor (their acks are dropped in onMqttAck())
+    if (store != _mqttStore || cursor + _mqttQueued != _mqttNextRecord) {
+        if (_mqttQueued > 0) {
+            LOG_WARN("API", "MQTT: storage changed, %lu records in flight dropped",
+                     (unsigned long)_mqttQueued);
+        }
+        _mqttStore = store;
+        _mqttQueued = 0;
+        _mqttNextRecord = cursor;
+    }
+    if (pending <= _mqttQueued) {
+        return;
+    }
+
+    RecordQuery query;
+    query.fields = RecordField::ALL & ~(RecordField::GPS_SATELLITES | RecordField::UNIT
+                                        | RecordField::QUALITY);
+    extern SystemHealth systemHealth;
+
+    // Records past the ones in flight, a cycle's worth per message
+    while (_mqtt.canPublish() && pending > _mqttQueued) {
+        uint32_t count = min(pending - _mqttQueued, (uint32_t)MQTT_RECORDS_PER_PUBLISH);
+        std::vector<DataRecord> records =
+            _storage->queryRecords(query, count, total - pending + _mqttQueued);
+        if (records.empty()) {
+            break;
+        }
+
+        JsonDocument doc;
+        addDatapoints(records, doc["datapoints"].to<JsonArray>());
+        String payload;
+        serializeJson(doc, payload);
+
+        uint16_t packetId = _mqtt.publish(_mqttDataTopic, payload, records.size(),
+                                          records.back().millis);
+        if (packetId == 0) {
+            break;
+        }
+        for (MqttBatch& batch : _mqttBatches) {
+            if (batch.packetId == 0) {
+                batch = MqttBatch{packetId, store, _mqttNextRecord};
+                break;
+            }
+        }
+        _mqttQueued += records.size();
+        _mqttNextRecord += records.size();
+        systemHealth.feedWatchdog();
+    }
+}
+
+void APIUploader::publishHealth() {
+    JsonDocument doc;
+    addMetadata(doc["metadata"].to<JsonObject>());
+    String payload;
+    serializeJson(doc, payload);
+
+    // Retained: the broker hands the latest to anyone who subscribes
+    extern FlightRecorder flightRecorder;
+    bool withPostMortem = flightRecorder.hasPostMortem();
+    uint16_t packetId = _mqtt.publish(_mqttHealthTopic, payload, 0, 0, true);
+    if (packetId != 0) {
+        _mqttHealthDue = false;
+        if (withPostMortem) {
+            _postMortemPacketId = packetId;
+        }
+    }
+}
+
+void APIUploader::onMqttAck(uint16_t packetId, uint32_t records, unsigned long lastMillis, size_t bytes) {
+    // Only records that are still the next pending ones of the same store
+    // move the cursor; an ack for records cleared or trimmed meanwhile is not
+    // for the records now at those positions
+    bool current = false;
+    if (records > 0) {
+        const IStorage* store;
+        uint32_t cursor;
+        _storage->getUploadPosition(store, cursor);
+        for (MqttBatch& batch : _mqttBatches) {
+            if (batch.packetId == packetId) {
+                current = batch.store == store && batch.firstRecord == cursor;
+                batch.packetId = 0;
+                break;
+            }
+        }
+    }
+    if (current) {
+        // Saved with the interval's history entry, not on every ack
+        _storage->advanceUploadCursor(records, lastMillis, false);
+        _mqttQueued -= min(records, _mqttQueued);
+        _mqttIntervalRecords += records;
+        _mqttLastAckedMillis = lastMillis;
+        _lastUploadTime = millis();
+    }
+    _mqttIntervalBytes += bytes;
+    _totalBytesSent += bytes;
+
+    if (packetId == _postMortemPacketId) {
+        extern FlightRecorder flightRecorder;
+        flightRecorder.clearPostMortem();
+        _postMortemPacketId = 0;
+    }
+}
+
+void APIUploader::flushMqttInterval(unsigned long now) {
+    if (_mqttIntervalRecords == 0 && _mqttIntervalBytes == 0) {
+        _mqttIntervalStart = now;
+        return;
+    }
+
+    recordHistory(_mqttIntervalStart, now - _mqttIntervalStart, true,
+                  _mqttIntervalRecords, _mqttIntervalBytes);
+    if (_mqttIntervalRecords > 0) {
+        _storage->advanceUploadCursor(0, _mqttLastAckedMillis);
+    }
+    extern TimeService timeService;
+    _storage->setLastSuccessEpoch(timeService.epochMs(millis()) / 1000);
+    _storage->addBytesUploaded(_mqttIntervalBytes);
+
+    LOG_INFO("API", "MQTT: %lu records acknowledged, %u bytes",
+             (unsigned long)_mqttIntervalRecords, (unsigned)_mqttIntervalBytes);
+    _mqttIntervalStart = now;
+    _mqttIntervalRecords = 0;
+    _mqttIntervalBytes = 0;
+}
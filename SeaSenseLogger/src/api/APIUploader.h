@@ -6,6 +6,9 @@
  * - Progress tracking (resume after connection loss)
  * - Gentle retry with exponential backoff
  * - NTP time sync for absolute timestamps
+ * - Optional MQTT transport (FEATURE_MQTT_UPLOAD): records stream over a
+ *   persistent QoS1 session as they are stored, and broker acks move the
+ *   upload cursor
  */
 
 #ifndef API_UPLOADER_H
@@ -16,7 +19,10 @@
 #include <HTTPClient.h>
 #include <time.h>
 #include <functional>
+#include <ArduinoJson.h>
 #include "../storage/StorageManager.h"
+#include "MqttSession.h"
+#include "WiFiMqttLink.h"
 
 using OTACallback = std::function<void(const String& version)>;
 
@@ -108,15 +114,16 @@ public:
 
     /**
      * Get time until next upload
-     * @return Milliseconds until next upload attempt
+     * @return Milliseconds until next upload attempt (MQTT: or until the
+     *         session's next keepalive, reconnect or ack deadline)
      */
     unsigned long getTimeUntilNext() const;
 
     /**
-     * Check if NTP time is synchronized
+     * Check if the time service is synchronized (GPS, N2K or NTP)
      * @return true if time is synced
      */
-    bool isTimeSynced() const { return _timeSynced; }
+    bool isTimeSynced() const;
 
     /**
      * Get current retry count
@@ -140,7 +147,7 @@ public:
      * Update device GUID for subsequent uploads
      * Called after GUID regeneration so next upload uses the new value
      */
-    void setDeviceGUID(const String& guid) { _config.deviceGUID = guid; }
+    void setDeviceGUID(const String& guid);
 
     /**
      * Register callback for backend-triggered OTA updates
@@ -171,6 +178,10 @@ public:
     /** True when a forced upload has been queued and not yet processed */
     bool isForcePending() const { return _forcePending; }
 
+    /** MQTT transport state (FEATURE_MQTT_UPLOAD) */
+    const MqttSession& getMqttSession() const { return _mqtt; }
+    const WiFiMqttLink& getMqttLink() const { return _mqttLink; }
+
 private:
     StorageManager* _storage;
     UploadConfig _config;
@@ -181,8 +192,6 @@ private:
     unsigned long _lastScheduledTime;   // millis() anchor for elapsed-time pattern
     unsigned long _currentIntervalMs;   // active interval (normal or retry backoff)
     uint8_t _retryCount;
-    bool _timeSynced;
-    time_t _bootTimeEpoch;  // Epoch time when ESP32 booted
     String _lastError;      // Descriptive last error message
 
     // Upload history (in-memory, also persisted to SPIFFS metadata)
@@ -195,6 +204,29 @@ private:
     bool _forcePending;         // force-upload request queued
     OTACallback _otaCallback;   // backend-triggered OTA callback
 
+    // MQTT transport
+    WiFiMqttLink _mqttLink;
+    MqttSession _mqtt;
+    String _mqttDataTopic;
+    String _mqttHealthTopic;
+    uint32_t _mqttQueued;           // records handed to the session, not yet acked
+    const IStorage* _mqttStore;     // store _mqttQueued counts records of
+    uint32_t _mqttNextRecord;       // number of the next record to publish
+                                    // (StorageManager::getUploadPosition())
+    struct MqttBatch {              // data publish in flight
+        uint16_t packetId;          // 0 = free
+        const IStorage* store;
+        uint32_t firstRecord;
+    };
+    MqttBatch _mqttBatches[MqttSession::MAX_INFLIGHT];
+    bool _mqttHealthDue;            // health message owed for this interval
+    bool _mqttWasConnected;
+    uint16_t _postMortemPacketId;   // health publish carrying the post-mortem
+    unsigned long _mqttIntervalStart;
+    uint32_t _mqttIntervalRecords;  // acked this interval (one history entry)
+    size_t _mqttIntervalBytes;
+    unsigned long _mqttLastAckedMillis;
+
     /**
      * Check if WiFi is connected
      * @return true if connected
@@ -202,17 +234,19 @@ private:
     bool isWiFiConnected() const;
 
     /**
-     * Sync time with NTP server
+     * Sync time with NTP server and hand it to the time service
      * @return true if successful
      */
     bool syncNTP();
 
     /**
-     * Convert millis() to absolute UTC timestamp
-     * @param millisTimestamp millis() timestamp
-     * @return ISO 8601 formatted UTC timestamp
+     * Sync time if needed and wait for the timestamp back-fill: records
+     * only leave the device with absolute timestamps
+     * @return true if ready (else status set and the next attempt scheduled:
+     *         retry backoff after an NTP failure, a short re-check while the
+     *         back-fill runs)
      */
-    String millisToUTC(unsigned long millisTimestamp) const;
+    bool prepareTimestamps(unsigned long now);
 
     /**
      * Build API payload from data records
@@ -221,6 +255,22 @@ private:
      */
     String buildPayload(const std::vector<DataRecord>& records) const;
 
+    /** Collector, device health and deployment block */
+    void addMetadata(JsonObject metadata) const;
+
+    /** One API datapoint per record */
+    void addDatapoints(const std::vector<DataRecord>& records, JsonArray datapoints) const;
+
+    /** Add an upload history entry (memory and SPIFFS) */
+    void recordHistory(unsigned long startMs, unsigned long durationMs, bool success,
+                       uint32_t recordCount, size_t payloadBytes);
+
+    /**
+     * Add the previous boot's flight record and coredump summary to the
+     * device_health block, if there is one waiting
+     */
+    void addPostMortem(JsonObject health) const;
+
     /**
      * Upload payload to API
      * @param payload JSON payload
@@ -237,6 +287,24 @@ private:
      * Reset retry count and timing
      */
     void resetRetry();
+
+    /** Broker, topics and session settings from the upload config */
+    void configureMqtt();
+
+    /** process() for the MQTT transport */
+    void processMqtt(unsigned long now);
+
+    /** Publish pending records while the in-flight window has room */
+    void fillMqttWindow();
+
+    /** Metadata (device health, post-mortem) to the retained health topic */
+    void publishHealth();
+
+    /** Session ack: advance the upload cursor if the records are still the next pending ones */
+    void onMqttAck(uint16_t packetId, uint32_t records, unsigned long lastMillis, size_t bytes);
+
+    /** One history entry and a cursor save for the interval's acks */
+    void flushMqttInterval(unsigned long now);
 };
 
 #endif // API_UPLOADER_H
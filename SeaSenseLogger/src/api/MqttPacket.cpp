@@ -0,0 +1,281 @@
+/**
+ * SeaSense Logger - MQTT 3.1.1 Packet Codec Implementation
+ */
+
+#include "MqttPacket.h"
+#include <string.h>
+
+// CONNECT flags
+static const uint8_t CONNECT_CLEAN_SESSION = 0x02;
+static const uint8_t CONNECT_PASSWORD = 0x40;
+static const uint8_t CONNECT_USERNAME = 0x80;
+
+static const uint8_t PROTOCOL_LEVEL_311 = 4;
+
+static size_t putU16(uint8_t* out, uint16_t v) {
+    out[0] = (uint8_t)(v >> 8);
+    out[1] = (uint8_t)(v & 0xFF);
+    return 2;
+}
+
+static uint16_t getU16(const uint8_t* in) {
+    return (uint16_t)((in[0] << 8) | in[1]);
+}
+
+// Length-prefixed UTF-8 string
+static size_t putString(uint8_t* out, const char* s, size_t len) {
+    putU16(out, (uint16_t)len);
+    memcpy(out + 2, s, len);
+    return 2 + len;
+}
+
+static bool getString(const uint8_t* body, size_t len, size_t& pos,
+                      const char*& s, size_t& sLen) {
+    if (pos + 2 > len) {
+        return false;
+    }
+    sLen = getU16(body + pos);
+    pos += 2;
+    if (pos + sLen > len) {
+        return false;
+    }
+    s = (const char*)(body + pos);
+    pos += sLen;
+    return true;
+}
+
+// Fixed header: first byte and the remaining length
+static size_t putFixedHeader(uint8_t first, uint32_t remaining, uint8_t* out, size_t cap) {
+    uint8_t len[4];
+    size_t lenBytes = mqttEncodeLength(remaining, len);
+    if (lenBytes == 0 || cap < 1 + lenBytes) {
+        return 0;
+    }
+    out[0] = first;
+    memcpy(out + 1, len, lenBytes);
+    return 1 + lenBytes;
+}
+
+size_t mqttEncodeLength(uint32_t len, uint8_t* out) {
+    if (len > MQTT_MAX_REMAINING_LENGTH) {
+        return 0;
+    }
+    size_t n = 0;
+    do {
+        uint8_t digit = len % 128;
+        len /= 128;
+        if (len > 0) {
+            digit |= 0x80;
+        }
+        out[n++] = digit;
+    } while (len > 0);
+    return n;
+}
+
+size_t mqttEncodeConnect(const MqttConnectOptions& opt, uint8_t* out, size_t cap) {
+    size_t idLen = strlen(opt.clientId);
+    size_t userLen = opt.username ? strlen(opt.username) : 0;
+    bool withPassword = opt.username && opt.password;
+    size_t passLen = withPassword ? strlen(opt.password) : 0;
+
+    // "MQTT", level, flags, keepalive; then the payload strings
+    uint32_t remaining = 6 + 1 + 1 + 2 + 2 + idLen;
+    if (opt.username) remaining += 2 + userLen;
+    if (withPassword) remaining += 2 + passLen;
+
+    size_t pos = putFixedHeader((uint8_t)MqttPacketType::CONNECT << 4, remaining, out, cap);
+    if (pos == 0 || cap < pos + remaining) {
+        return 0;
+    }
+
+    uint8_t flags = opt.cleanSession ? CONNECT_CLEAN_SESSION : 0;
+    if (opt.username) flags |= CONNECT_USERNAME;
+    if (withPassword) flags |= CONNECT_PASSWORD;
+
+    pos += putString(out + pos, "MQTT", 4);
+    out[pos++] = PROTOCOL_LEVEL_311;
+    out[pos++] = flags;
+    pos += putU16(out + pos, opt.keepAliveSec);
+    pos += putString(out + pos, opt.clientId, idLen);
+    if (opt.username) pos += putString(out + pos, opt.username, userLen);
+    if (withPassword) pos += putString(out + pos, opt.password, passLen);
+    return pos;
+}
+
+size_t mqttEncodePublishHeader(const char* topic, size_t payloadLen, uint8_t qos,
+                               bool dup, bool retain, uint16_t packetId,
+                               uint8_t* out, size_t cap) {
+    size_t topicLen = strlen(topic);
+    size_t variable = 2 + topicLen + (qos > 0 ? 2 : 0);
+    if (payloadLen > MQTT_MAX_REMAINING_LENGTH - variable) {
+        return 0;
+    }
+
+    uint8_t first = ((uint8_t)MqttPacketType::PUBLISH << 4) | ((qos & 0x03) << 1);
+    if (dup) first |= 0x08;
+    if (retain) first |= 0x01;
+
+    size_t pos = putFixedHeader(first, (uint32_t)(variable + payloadLen), out, cap);
+    if (pos == 0 || cap < pos + variable) {
+        return 0;
+    }
+    pos += putString(out + pos, topic, topicLen);
+    if (qos > 0) {
+        pos += putU16(out + pos, packetId);
+    }
+    return pos;
+}
+
+size_t mqttEncodeAck(MqttPacketType type, uint16_t packetId, uint8_t* out, size_t cap) {
+    if (cap < 4) {
+        return 0;
+    }
+    out[0] = (uint8_t)type << 4;
+    out[1] = 2;
+    putU16(out + 2, packetId);
+    return 4;
+}
+
+size_t mqttEncodeEmpty(MqttPacketType type, uint8_t* out, size_t cap) {
+    if (cap < 2) {
+        return 0;
+    }
+    out[0] = (uint8_t)type << 4;
+    out[1] = 0;
+    return 2;
+}
+
+bool mqttParseConnack(const uint8_t* body, size_t len, bool& sessionPresent, uint8_t& returnCode) {
+    if (len != 2) {
+        return false;
+    }
+    sessionPresent = (body[0] & 0x01) != 0;
+    returnCode = body[1];
+    return true;
+}
+
+bool mqttParsePacketId(const uint8_t* body, size_t len, uint16_t& packetId) {
+    if (len != 2) {
+        return false;
+    }
+    packetId = getU16(body);
+    return true;
+}
+
+bool mqttParseConnect(const uint8_t* body, size_t len, MqttConnectInfo& info) {
+    size_t pos = 0;
+    const char* protocol;
+    size_t protocolLen;
+    if (!getString(body, len, pos, protocol, protocolLen)
+        || protocolLen != 4 || memcmp(protocol, "MQTT", 4) != 0
+        || pos + 4 > len) {
+        return false;
+    }
+    info.protocolLevel = body[pos++];
+    uint8_t flags = body[pos++];
+    info.cleanSession = (flags & CONNECT_CLEAN_SESSION) != 0;
+    info.keepAliveSec = getU16(body + pos);
+    pos += 2;
+
+    if (!getString(body, len, pos, info.clientId, info.clientIdLen)) {
+        return false;
+    }
+    info.username = nullptr;
+    info.usernameLen = 0;
+    info.password = nullptr;
+    info.passwordLen = 0;
+    if ((flags & CONNECT_USERNAME)
+        && !getString(body, len, pos, info.username, info.usernameLen)) {
+        return false;
+    }
+    if ((flags & CONNECT_PASSWORD)
+        && !getString(body, len, pos, info.password, info.passwordLen)) {
+        return false;
+    }
+    return pos == len;
+}
+
+bool mqttParsePublish(uint8_t flags, const uint8_t* body, size_t len, MqttPublishInfo& info) {
+    info.qos = (flags >> 1) & 0x03;
+    info.dup = (flags & 0x08) != 0;
+    info.retain = (flags & 0x01) != 0;
+    if (info.qos > 2) {
+        return false;
+    }
+
+    size_t pos = 0;
+    if (!getString(body, len, pos, info.topic, info.topicLen)) {
+        return false;
+    }
+    info.packetId = 0;
+    if (info.qos > 0) {
+        if (pos + 2 > len) {
+            return false;
+        }
+        info.packetId = getU16(body + pos);
+        pos += 2;
+    }
+    info.payload = body + pos;
+    info.payloadLen = len - pos;
+    return true;
+}
+
+// ============================================================================
+// MqttReader
+// ============================================================================
+
+MqttReader::MqttReader(uint8_t* buf, size_t cap)
+    : _buf(buf),
+      _cap(cap)
+{
+    reset();
+}
+
+void MqttReader::reset() {
+    _stage = Stage::HEADER;
+    _header = 0;
+    _length = 0;
+    _received = 0;
+    _lengthBytes = 0;
+    _malformed = false;
+}
+
+bool MqttReader::push(uint8_t b) {
+    switch (_stage) {
+        case Stage::HEADER:
+            _header = b;
+            _length = 0;
+            _received = 0;
+            _lengthBytes = 0;
+            _stage = Stage::LENGTH;
+            return false;
+
+        case Stage::LENGTH:
+            if (_lengthBytes == 4) {
+                _malformed = true;
+                _stage = Stage::HEADER;
+                return false;
+            }
+            _length |= (uint32_t)(b & 0x7F) << (7 * _lengthBytes++);
+            if (b & 0x80) {
+                return false;
+            }
+            if (_length == 0) {
+                _stage = Stage::HEADER;
+                return true;
+            }
+            _stage = Stage::BODY;
+            return false;
+
+        case Stage::BODY:
+            if (_received < _cap) {
+                _buf[_received] = b;
+            }
+            if (++_received < _length) {
+                return false;
+            }
+            _stage = Stage::HEADER;
+            return true;
+    }
+    return false;
+}
@@ -0,0 +1,153 @@
+/**
+ * SeaSense Logger - MQTT 3.1.1 Packet Codec
+ *
+ * The control packets the uploader's MQTT transport needs, encoded into and
+ * parsed from plain byte buffers:
+ *   CONNECT / CONNACK      persistent session (clean session 0)
+ *   PUBLISH / PUBACK       QoS1 delivery, 16-bit packet identifiers
+ *   PINGREQ / PINGRESP     keepalive
+ *   DISCONNECT
+ * Every packet is a fixed header (type << 4 | flags, remaining length as a
+ * 1-4 byte varint) followed by a variable header and payload.
+ *
+ * Kept free of WiFi so the session and a stand-in broker run on the host.
+ */
+
+#ifndef SEASENSE_MQTT_PACKET_H
+#define SEASENSE_MQTT_PACKET_H
+
+#include <Arduino.h>
+
+#define MQTT_MAX_REMAINING_LENGTH 268435455UL
+#define MQTT_PUBLISH_HEADER_MAX 256     // fixed header + topic + packet id
+
+enum class MqttPacketType : uint8_t {
+    CONNECT = 1,
+    CONNACK = 2,
+    PUBLISH = 3,
+    PUBACK = 4,
+    PINGREQ = 12,
+    PINGRESP = 13,
+    DISCONNECT = 14
+};
+
+// CONNACK return codes
+#define MQTT_CONNACK_ACCEPTED 0
+#define MQTT_CONNACK_BAD_PROTOCOL 1
+#define MQTT_CONNACK_ID_REJECTED 2
+#define MQTT_CONNACK_UNAVAILABLE 3
+#define MQTT_CONNACK_BAD_CREDENTIALS 4
+#define MQTT_CONNACK_NOT_AUTHORIZED 5
+
+struct MqttConnectOptions {
+    const char* clientId = "";
+    const char* username = nullptr;     // nullptr = not sent
+    const char* password = nullptr;     // only sent with a username
+    uint16_t keepAliveSec = 60;
+    bool cleanSession = false;
+};
+
+/**
+ * Encode a remaining length
+ * @return Bytes written (1-4), 0 if len is over the protocol limit
+ */
+size_t mqttEncodeLength(uint32_t len, uint8_t* out);
+
+size_t mqttEncodeConnect(const MqttConnectOptions& opt, uint8_t* out, size_t cap);
+
+/**
+ * PUBLISH up to the payload: fixed header, topic and (QoS > 0) packet id.
+ * The payload is written to the link right after it, so it never has to be
+ * copied into a packet buffer
+ * @return Bytes written (0 if out is too small)
+ */
+size_t mqttEncodePublishHeader(const char* topic, size_t payloadLen, uint8_t qos,
+                               bool dup, bool retain, uint16_t packetId,
+                               uint8_t* out, size_t cap);
+
+/**
+ * Two-byte-body packets carrying a packet id (PUBACK)
+ */
+size_t mqttEncodeAck(MqttPacketType type, uint16_t packetId, uint8_t* out, size_t cap);
+
+/**
+ * Packets with no body (PINGREQ, PINGRESP, DISCONNECT)
+ */
+size_t mqttEncodeEmpty(MqttPacketType type, uint8_t* out, size_t cap);
+
+bool mqttParseConnack(const uint8_t* body, size_t len, bool& sessionPresent, uint8_t& returnCode);
+
+bool mqttParsePacketId(const uint8_t* body, size_t len, uint16_t& packetId);
+
+/**
+ * CONNECT fields as received (pointers into body, not terminated)
+ */
+struct MqttConnectInfo {
+    uint8_t protocolLevel;
+    bool cleanSession;
+    uint16_t keepAliveSec;
+    const char* clientId;
+    size_t clientIdLen;
+    const char* username;               // nullptr if absent
+    size_t usernameLen;
+    const char* password;               // nullptr if absent
+    size_t passwordLen;
+};
+
+bool mqttParseConnect(const uint8_t* body, size_t len, MqttConnectInfo& info);
+
+/**
+ * PUBLISH fields as received (pointers into body)
+ */
+struct MqttPublishInfo {
+    uint8_t qos;
+    bool dup;
+    bool retain;
+    const char* topic;
+    size_t topicLen;
+    uint16_t packetId;                  // 0 for QoS0
+    const uint8_t* payload;
+    size_t payloadLen;
+};
+
+bool mqttParsePublish(uint8_t flags, const uint8_t* body, size_t len, MqttPublishInfo& info);
+
+/**
+ * Reassembles packets from a byte stream, one byte at a time. Bodies longer
+ * than the buffer are consumed but cut short (isTruncated())
+ */
+class MqttReader {
+public:
+    MqttReader(uint8_t* buf, size_t cap);
+
+    /**
+     * Take the next byte
+     * @return true when it completed a packet (valid until the next push)
+     */
+    bool push(uint8_t b);
+
+    void reset();
+
+    MqttPacketType type() const { return (MqttPacketType)(_header >> 4); }
+    uint8_t flags() const { return _header & 0x0F; }
+    const uint8_t* body() const { return _buf; }
+    size_t length() const { return _length < _cap ? _length : _cap; }
+    bool isTruncated() const { return _length > _cap; }
+
+    /** A remaining length longer than four bytes: the stream is not MQTT */
+    bool isMalformed() const { return _malformed; }
+
+private:
+    uint8_t* _buf;
+    size_t _cap;
+
+    enum class Stage : uint8_t { HEADER, LENGTH, BODY };
+    Stage _stage;
+    uint8_t _header;
+    uint32_t _length;
+    uint32_t _received;
+    uint8_t _lengthBytes;
+    bool _malformed;
+};
+
+#endif // SEASENSE_MQTT_PACKET_H
@@ -0,0 +1,377 @@
+/**
+ * SeaSense Logger - MQTT Upload Session Implementation
+ */
+
+#include "MqttSession.h"
+
+MqttSession::MqttSession(MqttLink* link)
+    : _link(link),
+      _configured(false),
+      _state(MqttState::DISCONNECTED),
+      _sessionPresent(false),
+      _stateSinceMs(0),
+      _backoffMs(0),
+      _lastSendMs(0),
+      _pingSentMs(0),
+      _pingPending(false),
+      _head(0),
+      _count(0),
+      _nextPacketId(1),
+      _reader(_rxBuf, sizeof(_rxBuf)),
+      _published(0),
+      _acked(0),
+      _redelivered(0),
+      _connects(0),
+      _bytesSent(0)
+{
+}
+
+void MqttSession::configure(const MqttSessionConfig& config) {
+    _config = config;
+    if (_config.window < 1) _config.window = 1;
+    if (_config.window > MAX_INFLIGHT) _config.window = MAX_INFLIGHT;
+    _configured = true;
+}
+
+// ============================================================================
+// Public Methods
+// ============================================================================
+
+void MqttSession::poll(unsigned long now) {
+    if (!_configured) {
+        return;
+    }
+
+    if (_state == MqttState::DISCONNECTED) {
+        if (now - _stateSinceMs >= _backoffMs) {
+            connect(now);
+        }
+        return;
+    }
+
+    // Whatever the broker sent since the last poll
+    uint8_t buf[128];
+    size_t n;
+    while ((n = _link->read(buf, sizeof(buf))) > 0) {
+        for (size_t i = 0; i < n; i++) {
+            if (_reader.push(buf[i])) {
+                handlePacket(now);
+                if (_state == MqttState::DISCONNECTED) {
+                    return;
+                }
+            } else if (_reader.isMalformed()) {
+                drop(now, "Malformed packet from broker");
+                return;
+            }
+        }
+    }
+
+    if (!_link->isOpen()) {
+        drop(now, "Connection lost");
+        return;
+    }
+
+    if (_state == MqttState::CONNECTING) {
+        if (now - _stateSinceMs >= _config.connectTimeoutMs) {
+            drop(now, "No CONNACK from broker");
+        }
+        return;
+    }
+
+    // A broker that stops acking gets a fresh connection; the unacked
+    // publishes go out again once it is up
+    if (_count > 0 && at(0).sent && now - at(0).sentMs >= _config.ackTimeoutMs) {
+        drop(now, "PUBACK timeout");
+        return;
+    }
+
+    if (_pingPending) {
+        if (now - _pingSentMs >= _config.ackTimeoutMs) {
+            drop(now, "PINGRESP timeout");
+        }
+    } else if (_config.keepAliveSec > 0
+               && now - _lastSendMs >= (unsigned long)_config.keepAliveSec * 1000UL) {
+        uint8_t ping[2];
+        size_t len = mqttEncodeEmpty(MqttPacketType::PINGREQ, ping, sizeof(ping));
+        if (sendRaw(ping, len, now)) {
+            _pingPending = true;
+            _pingSentMs = now;
+        }
+    }
+}
+
+uint16_t MqttSession::publish(const String& topic, const String& payload,
+                              uint32_t records, unsigned long lastMillis, bool retain) {
+    if (!canPublish()) {
+        return 0;
+    }
+
+    Outgoing& msg = at(_count);
+    msg.topic = topic;
+    msg.payload = payload;
+    msg.packetId = allocatePacketId();
+    msg.retain = retain;
+    msg.sent = false;
+    msg.acked = false;
+    msg.records = records;
+    msg.lastMillis = lastMillis;
+    msg.sentMs = 0;
+    msg.bytes = 0;
+    _count++;
+    _published++;
+
+    if (_state == MqttState::CONNECTED) {
+        send(msg, false, millis());
+    }
+    return msg.packetId;
+}
+
+void MqttSession::disconnect(unsigned long now, const char* reason) {
+    if (_state == MqttState::DISCONNECTED) {
+        return;
+    }
+    if (_state == MqttState::CONNECTED) {
+        uint8_t packet[2];
+        size_t len = mqttEncodeEmpty(MqttPacketType::DISCONNECT, packet, sizeof(packet));
+        _link->write(packet, len);
+    }
+    drop(now, reason);
+}
+
+const char* MqttSession::getStateString() const {
+    switch (_state) {
+        case MqttState::DISCONNECTED:   return "disconnected";
+        case MqttState::CONNECTING:     return "connecting";
+        case MqttState::CONNECTED:      return "connected";
+        default:                        return "unknown";
+    }
+}
+
+unsigned long MqttSession::getTimeUntilDue(unsigned long now) const {
+    auto remaining = [now](unsigned long since, unsigned long period) -> unsigned long {
+        unsigned long elapsed = now - since;
+        return elapsed >= period ? 0 : period - elapsed;
+    };
+
+    switch (_state) {
+        case MqttState::DISCONNECTED:
+            return remaining(_stateSinceMs, _backoffMs);
+        case MqttState::CONNECTING:
+            return remaining(_stateSinceMs, _config.connectTimeoutMs);
+        case MqttState::CONNECTED:
+        default: {
+            unsigned long due = _pingPending
+                ? remaining(_pingSentMs, _config.ackTimeoutMs)
+                : remaining(_lastSendMs, (unsigned long)_config.keepAliveSec * 1000UL);
+            if (_count > 0 && at(0).sent) {
+                unsigned long ack = remaining(at(0).sentMs, _config.ackTimeoutMs);
+                if (ack < due) due = ack;
+            }
+            return due;
+        }
+    }
+}
+
+uint32_t MqttSession::getInFlightRecords() const {
+    uint32_t records = 0;
+    for (uint8_t i = 0; i < _count; i++) {
+        records += at(i).records;
+    }
+    return records;
+}
+
+// ============================================================================
+// Private Methods
+// ============================================================================
+
+void MqttSession::connect(unsigned long now) {
+    _stateSinceMs = now;
+    _reader.reset();
+    _pingPending = false;
+
+    if (!_link->open()) {
+        _lastError = "Broker unreachable";
+        _backoffMs = _backoffMs == 0
+            ? _config.reconnectMinMs
+            : min(_backoffMs * 2, _config.reconnectMaxMs);
+        return;
+    }
+
+    MqttConnectOptions opt;
+    opt.clientId = _config.clientId.c_str();
+    if (_config.username.length() > 0) {
+        opt.username = _config.username.c_str();
+        opt.password = _config.password.c_str();
+    }
+    opt.keepAliveSec = _config.keepAliveSec;
+    opt.cleanSession = false;
+
+    uint8_t packet[320];
+    size_t len = mqttEncodeConnect(opt, packet, sizeof(packet));
+    if (len == 0) {
+        _link->close();
+        _lastError = "CONNECT too large";
+        _backoffMs = _config.reconnectMaxMs;
+        return;
+    }
+    _state = MqttState::CONNECTING;
+    sendRaw(packet, len, now);
+}
+
+void MqttSession::drop(unsigned long now, const String& reason) {
+    _link->close();
+    _state = MqttState::DISCONNECTED;
+    _stateSinceMs = now;
+    _pingPending = false;
+    _lastError = reason;
+    _backoffMs = _backoffMs == 0
+        ? _config.reconnectMinMs
+        : min(_backoffMs * 2, _config.reconnectMaxMs);
+
+    // Everything unacked is resent (DUP) after the next CONNACK
+    for (uint8_t i = 0; i < _count; i++) {
+        at(i).sent = false;
+    }
+}
+
+void MqttSession::handlePacket(unsigned long now) {
+    uint16_t packetId;
+    switch (_reader.type()) {
+        case MqttPacketType::CONNACK:
+            if (_state == MqttState::CONNECTING) {
+                handleConnack(now);
+            }
+            break;
+        case MqttPacketType::PUBACK:
+            if (_state == MqttState::CONNECTED
+                && mqttParsePacketId(_reader.body(), _reader.length(), packetId)) {
+                handlePuback(packetId);
+            }
+            break;
+        case MqttPacketType::PINGRESP:
+            _pingPending = false;
+            break;
+        default:
+            // Nothing is subscribed; anything else is ignored
+            break;
+    }
+}
+
+void MqttSession::handleConnack(unsigned long now) {
+    bool sessionPresent;
+    uint8_t rc;
+    if (!mqttParseConnack(_reader.body(), _reader.length(), sessionPresent, rc)) {
+        drop(now, "Malformed CONNACK");
+        return;
+    }
+    if (rc != MQTT_CONNACK_ACCEPTED) {
+        switch (rc) {
+            case MQTT_CONNACK_BAD_PROTOCOL:     drop(now, "Broker refused: protocol version"); break;
+            case MQTT_CONNACK_ID_REJECTED:      drop(now, "Broker refused: client id"); break;
+            case MQTT_CONNACK_UNAVAILABLE:      drop(now, "Broker refused: server unavailable"); break;
+            case MQTT_CONNACK_BAD_CREDENTIALS:  drop(now, "Broker refused: bad username or password"); break;
+            case MQTT_CONNACK_NOT_AUTHORIZED:   drop(now, "Broker refused: not authorized"); break;
+            default:                            drop(now, "Broker refused: code " + String(rc)); break;
+        }
+        // Retrying quickly won't change the answer
+        _backoffMs = _config.reconnectMaxMs;
+        return;
+    }
+
+    _state = MqttState::CONNECTED;
+    _stateSinceMs = now;
+    _sessionPresent = sessionPresent;
+    _backoffMs = 0;
+    _lastError = "";
+    _connects++;
+
+    // Publishes queued while offline, and unacked ones again (DUP)
+    for (uint8_t i = 0; i < _count && _state == MqttState::CONNECTED; i++) {
+        Outgoing& msg = at(i);
+        send(msg, msg.bytes > 0, now);
+    }
+}
+
+void MqttSession::handlePuback(uint16_t packetId) {
+    for (uint8_t i = 0; i < _count; i++) {
+        Outgoing& msg = at(i);
+        if (msg.packetId == packetId && msg.sent) {
+            msg.acked = true;
+            break;
+        }
+    }
+
+    // Report in publish order: an ack for a later publish waits for the
+    // earlier ones, so the records reported are always a prefix
+    while (_count > 0 && at(0).acked) {
+        Outgoing& msg = at(0);
+        uint16_t id = msg.packetId;
+        uint32_t records = msg.records;
+        unsigned long lastMillis = msg.lastMillis;
+        size_t bytes = msg.bytes;
+        msg.topic = "";
+        msg.payload = "";
+        _head = (_head + 1) % MAX_INFLIGHT;
+        _count--;
+        _acked++;
+        if (_onAck) {
+            _onAck(id, records, lastMillis, bytes);
+        }
+    }
+}
+
+bool MqttSession::send(Outgoing& msg, bool dup, unsigned long now) {
+    uint8_t header[MQTT_PUBLISH_HEADER_MAX];
+    size_t len = mqttEncodePublishHeader(msg.topic.c_str(), msg.payload.length(), 1, dup,
+                                         msg.retain, msg.packetId, header, sizeof(header));
+    if (len == 0) {
+        drop(now, "PUBLISH too large");
+        return false;
+    }
+    if (!sendRaw(header, len, now)
+        || !sendRaw((const uint8_t*)msg.payload.c_str(), msg.payload.length(), now)) {
+        return false;
+    }
+
+    if (msg.bytes == 0) {
+        msg.bytes = len + msg.payload.length();
+    } else {
+        _redelivered++;
+    }
+    msg.sent = true;
+    msg.sentMs = now;
+    return true;
+}
+
+bool MqttSession::sendRaw(const uint8_t* data, size_t len, unsigned long now) {
+    if (len == 0) {
+        return true;
+    }
+    size_t written = _link->write(data, len);
+    _bytesSent += written;
+    if (written != len) {
+        drop(now, "Write failed");
+        return false;
+    }
+    _lastSendMs = now;
+    return true;
+}
+
+uint16_t MqttSession::allocatePacketId() {
+    while (true) {
+        uint16_t id = _nextPacketId++;
+        if (_nextPacketId == 0) {
+            _nextPacketId = 1;
+        }
+        bool inUse = false;
+        for (uint8_t i = 0; i < _count; i++) {
+            if (at(i).packetId == id) {
+                inUse = true;
+                break;
+            }
+        }
+        if (!inUse) {
+            return id;
+        }
+    }
+}
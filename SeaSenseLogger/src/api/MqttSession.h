@@ -0,0 +1,179 @@
+/**
+ * SeaSense Logger - MQTT Upload Session
+ *
+ * Client side of a persistent MQTT 3.1.1 session used by APIUploader to
+ * stream records instead of POSTing batches:
+ * - One TLS connection kept open, CONNECT with clean session 0 so the
+ *   broker keeps the session across reconnects
+ * - QoS1 publishes, up to `window` in flight; each carries a record count
+ * - Acks are reported in publish order only (a PUBACK that overtakes an
+ *   earlier one waits), so the caller can move the storage upload cursor
+ *   by exactly the acknowledged records
+ * - After a reconnect every unacked publish is sent again with DUP set
+ * - Keepalive pings, ack/CONNACK timeouts, reconnect with doubling backoff
+ *
+ * The socket is behind MqttLink so the session runs against a stand-in
+ * broker on the host.
+ */
+
+#ifndef SEASENSE_MQTT_SESSION_H
+#define SEASENSE_MQTT_SESSION_H
+
+#include <Arduino.h>
+#include <functional>
+#include "MqttPacket.h"
+
+/**
+ * Byte stream to the broker (non-blocking reads)
+ */
+class MqttLink {
+public:
+    virtual ~MqttLink() {}
+
+    /** Open the connection (TCP/TLS); may block for the handshake */
+    virtual bool open() = 0;
+    virtual bool isOpen() = 0;
+
+    /** @return Bytes read, 0 if none are waiting */
+    virtual size_t read(uint8_t* buf, size_t len) = 0;
+
+    /** @return Bytes written (short = connection failed) */
+    virtual size_t write(const uint8_t* buf, size_t len) = 0;
+
+    virtual void close() = 0;
+};
+
+struct MqttSessionConfig {
+    String clientId;
+    String username;                    // empty = none
+    String password;
+    uint16_t keepAliveSec = 60;
+    uint8_t window = 4;                 // publishes in flight (1..MAX_INFLIGHT)
+    unsigned long connectTimeoutMs = 10000;     // CONNECT → CONNACK
+    unsigned long ackTimeoutMs = 20000;         // PUBLISH → PUBACK, PINGREQ → PINGRESP
+    unsigned long reconnectMinMs = 2000;
+    unsigned long reconnectMaxMs = 60000;
+};
+
+enum class MqttState : uint8_t {
+    DISCONNECTED,
+    CONNECTING,         // CONNECT sent, waiting for CONNACK
+    CONNECTED
+};
+
+/**
+ * Called for each acknowledged publish, in publish order
+ * @param packetId Id publish() returned
+ * @param records Record count given to publish()
+ * @param lastMillis millis() of the last record given to publish()
+ * @param bytes Wire bytes of the publish (first transmission)
+ */
+using MqttAckCallback = std::function<void(uint16_t packetId, uint32_t records,
+                                           unsigned long lastMillis, size_t bytes)>;
+
+class MqttSession {
+public:
+    static const uint8_t MAX_INFLIGHT = 8;
+
+    explicit MqttSession(MqttLink* link);
+
+    void configure(const MqttSessionConfig& config);
+    void onAck(MqttAckCallback cb) { _onAck = cb; }
+
+    /**
+     * Drive the session: read acks, keepalive, timeouts, reconnect.
+     * Call every loop; connects by itself once configured
+     */
+    void poll(unsigned long now);
+
+    /**
+     * Queue a QoS1 publish (sent right away while connected, else after the
+     * next CONNACK)
+     * @return Packet id, 0 if the window is full
+     */
+    uint16_t publish(const String& topic, const String& payload,
+                     uint32_t records, unsigned long lastMillis, bool retain = false);
+
+    /**
+     * Close the connection (DISCONNECT first if connected). Unacked
+     * publishes stay queued for the next connection
+     */
+    void disconnect(unsigned long now, const char* reason);
+
+    /** Room for another publish */
+    bool canPublish() const { return _count < _config.window; }
+
+    MqttState getState() const { return _state; }
+    bool isConnected() const { return _state == MqttState::CONNECTED; }
+    const char* getStateString() const;
+
+    /** Milliseconds until poll() has timed work to do (ping, retry, timeout) */
+    unsigned long getTimeUntilDue(unsigned long now) const;
+
+    // Status
+    uint8_t getInFlight() const { return _count; }
+    uint32_t getInFlightRecords() const;
+    bool wasSessionPresent() const { return _sessionPresent; }
+    uint32_t getPublishedCount() const { return _published; }
+    uint32_t getAckedCount() const { return _acked; }
+    uint32_t getRedeliveredCount() const { return _redelivered; }
+    uint32_t getConnectCount() const { return _connects; }
+    unsigned long getBytesSent() const { return _bytesSent; }
+    const String& getLastError() const { return _lastError; }
+
+private:
+    struct Outgoing {
+        String topic;
+        String payload;
+        uint16_t packetId;
+        bool retain;
+        bool sent;                      // sent on the current connection
+        bool acked;
+        uint32_t records;
+        unsigned long lastMillis;
+        unsigned long sentMs;
+        size_t bytes;
+    };
+
+    MqttLink* _link;
+    MqttSessionConfig _config;
+    bool _configured;
+    MqttAckCallback _onAck;
+
+    MqttState _state;
+    bool _sessionPresent;
+    unsigned long _stateSinceMs;        // CONNECT sent / connection lost
+    unsigned long _backoffMs;
+    unsigned long _lastSendMs;
+    unsigned long _pingSentMs;
+    bool _pingPending;
+
+    // In-flight publishes, oldest first (ring)
+    Outgoing _queue[MAX_INFLIGHT];
+    uint8_t _head;
+    uint8_t _count;
+    uint16_t _nextPacketId;
+
+    uint8_t _rxBuf[64];                 // CONNACK/PUBACK/PINGRESP bodies
+    MqttReader _reader;
+
+    uint32_t _published;
+    uint32_t _acked;
+    uint32_t _redelivered;
+    uint32_t _connects;
+    unsigned long _bytesSent;
+    String _lastError;
+
+    void connect(unsigned long now);
+    void drop(unsigned long now, const String& reason);
+    void handlePacket(unsigned long now);
+    void handleConnack(unsigned long now);
+    void handlePuback(uint16_t packetId);
+    bool send(Outgoing& msg, bool dup, unsigned long now);
+    bool sendRaw(const uint8_t* data, size_t len, unsigned long now);
+    uint16_t allocatePacketId();
+    Outgoing& at(uint8_t i) { return _queue[(_head + i) % MAX_INFLIGHT]; }
+    const Outgoing& at(uint8_t i) const { return _queue[(_head + i) % MAX_INFLIGHT]; }
+};
+
+#endif // SEASENSE_MQTT_SESSION_H
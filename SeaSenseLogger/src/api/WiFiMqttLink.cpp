@@ -0,0 +1,58 @@
+/**
+ * SeaSense Logger - MQTT Link over WiFi Implementation
+ */
+
+#include "WiFiMqttLink.h"
+#include "../../config/hardware_config.h"
+
+WiFiMqttLink::WiFiMqttLink()
+    : _port(0),
+      _tls(true)
+{
+}
+
+void WiFiMqttLink::setBroker(const String& host, uint16_t port, bool tls) {
+    close();
+    _host = host;
+    _port = port;
+    _tls = tls;
+}
+
+bool WiFiMqttLink::open() {
+    if (_host.length() == 0 || WiFi.status() != WL_CONNECTED) {
+        return false;
+    }
+    close();
+
+    if (_tls) {
+        // Same trust as the HTTPS uploads: HTTPClient is given no CA
+        // certificate either, so the server certificate is not checked
+        _tlsClient.setInsecure();
+    }
+    if (!client().connect(_host.c_str(), _port, API_CONNECT_TIMEOUT_MS)) {
+        return false;
+    }
+    client().setNoDelay(true);
+    return true;
+}
+
+bool WiFiMqttLink::isOpen() {
+    return client().connected();
+}
+
+size_t WiFiMqttLink::read(uint8_t* buf, size_t len) {
+    int available = client().available();
+    if (available <= 0) {
+        return 0;
+    }
+    int n = client().read(buf, min((size_t)available, len));
+    return n > 0 ? (size_t)n : 0;
+}
+
+size_t WiFiMqttLink::write(const uint8_t* buf, size_t len) {
+    return client().write(buf, len);
+}
+
+void WiFiMqttLink::close() {
+    client().stop();
+}
@@ -0,0 +1,42 @@
+/**
+ * SeaSense Logger - MQTT Link over WiFi
+ *
+ * TCP or TLS connection to the broker for MqttSession. Nagle is off so a
+ * small PUBLISH leaves at once instead of waiting for the previous ack.
+ */
+
+#ifndef SEASENSE_WIFI_MQTT_LINK_H
+#define SEASENSE_WIFI_MQTT_LINK_H
+
+#include <Arduino.h>
+#include <WiFi.h>
+#include <WiFiClientSecure.h>
+#include "MqttSession.h"
+
+class WiFiMqttLink : public MqttLink {
+public:
+    WiFiMqttLink();
+
+    void setBroker(const String& host, uint16_t port, bool tls);
+
+    const String& getHost() const { return _host; }
+    uint16_t getPort() const { return _port; }
+    bool usesTls() const { return _tls; }
+
+    bool open() override;
+    bool isOpen() override;
+    size_t read(uint8_t* buf, size_t len) override;
+    size_t write(const uint8_t* buf, size_t len) override;
+    void close() override;
+
+private:
+    WiFiClient _tcpClient;
+    WiFiClientSecure _tlsClient;
+    String _host;
+    uint16_t _port;
+    bool _tls;
+
+    WiFiClient& client() { return _tls ? _tlsClient : _tcpClient; }
+};
+
+#endif // SEASENSE_WIFI_MQTT_LINK_H
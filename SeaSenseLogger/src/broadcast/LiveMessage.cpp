@@ -0,0 +1,140 @@
+/**
+ * SeaSense Logger - Live Data Messages Implementation
+ */
+
+#include "LiveMessage.h"
+#include <limits.h>
+#include <stdio.h>
+#include <string.h>
+
+void LiveSnapshot::clear() {
+    epoch = 0;
+    latitude = NAN;
+    longitude = NAN;
+    for (int i = 0; i < (int)LiveField::COUNT; i++) {
+        fields[i] = NAN;
+    }
+}
+
+uint8_t nmeaChecksum(const char* body, size_t len) {
+    uint8_t sum = 0;
+    for (size_t i = 0; i < len; i++) {
+        sum ^= (uint8_t)body[i];
+    }
+    return sum;
+}
+
+// ============================================================================
+// NMEA0183
+// ============================================================================
+
+// Append "$<body>*hh\r\n"; false if it does not fit
+static bool appendSentence(char* out, size_t cap, size_t& len, const char* body) {
+    size_t bodyLen = strlen(body);
+    if (len + bodyLen + 6 >= cap) {
+        return false;
+    }
+    int n = snprintf(out + len, cap - len, "$%s*%02X\r\n", body, nmeaChecksum(body, bodyLen));
+    len += (size_t)n;
+    return true;
+}
+
+// One XDR generic measurement, if measured
+static bool appendXdr(char* out, size_t cap, size_t& len, float value, int decimals, const char* name) {
+    if (isnan(value)) {
+        return true;
+    }
+    char body[48];
+    snprintf(body, sizeof(body), "YXXDR,G,%.*f,,%s", decimals, value, name);
+    return appendSentence(out, cap, len, body);
+}
+
+size_t buildLiveNmea(const LiveSnapshot& snap, char* out, size_t cap) {
+    size_t len = 0;
+    bool ok = true;
+
+    float temp = snap.get(LiveField::WATER_TEMP);
+    if (!isnan(temp)) {
+        char body[32];
+        snprintf(body, sizeof(body), "YXMTW,%.2f,C", temp);
+        ok = appendSentence(out, cap, len, body);
+    }
+    ok = ok && appendXdr(out, cap, len, snap.get(LiveField::CONDUCTIVITY), 0, "COND");
+    ok = ok && appendXdr(out, cap, len, snap.get(LiveField::SALINITY), 2, "SALN");
+    ok = ok && appendXdr(out, cap, len, snap.get(LiveField::PH), 2, "PH");
+    ok = ok && appendXdr(out, cap, len, snap.get(LiveField::DISSOLVED_OXYGEN), 2, "DOXY");
+
+    return ok ? len : 0;
+}
+
+// ============================================================================
+// Binary datagram
+// ============================================================================
+
+static void put16(uint8_t* p, uint16_t v) {
+    p[0] = v & 0xFF;
+    p[1] = v >> 8;
+}
+
+static void put32(uint8_t* p, uint32_t v) {
+    for (int i = 0; i < 4; i++) {
+        p[i] = (v >> (8 * i)) & 0xFF;
+    }
+}
+
+static uint32_t get32(const uint8_t* p) {
+    return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+static int32_t toE7(double degrees) {
+    if (isnan(degrees)) {
+        return INT32_MIN;
+    }
+    return (int32_t)lround(degrees * 1e7);
+}
+
+size_t buildLiveDatagram(const LiveSnapshot& snap, uint16_t seq, uint8_t* out, size_t cap) {
+    const uint8_t count = (uint8_t)LiveField::COUNT;
+    size_t len = LIVE_DATAGRAM_HEADER + 4 * count;
+    if (cap < len) {
+        return 0;
+    }
+    out[0] = 'S';
+    out[1] = 'S';
+    out[2] = LIVE_DATAGRAM_VERSION;
+    out[3] = count;
+    put16(out + 4, seq);
+    put32(out + 6, snap.epoch);
+    put32(out + 10, (uint32_t)toE7(snap.latitude));
+    put32(out + 14, (uint32_t)toE7(snap.longitude));
+    for (uint8_t i = 0; i < count; i++) {
+        uint32_t bits;
+        memcpy(&bits, &snap.fields[i], sizeof(bits));
+        put32(out + LIVE_DATAGRAM_HEADER + 4 * i, bits);
+    }
+    return len;
+}
+
+bool parseLiveDatagram(const uint8_t* data, size_t len, LiveSnapshot& snap, uint16_t& seq) {
+    if (len < LIVE_DATAGRAM_HEADER || data[0] != 'S' || data[1] != 'S' ||
+        data[2] != LIVE_DATAGRAM_VERSION) {
+        return false;
+    }
+    uint8_t count = data[3];
+    if (len < LIVE_DATAGRAM_HEADER + 4u * count) {
+        return false;
+    }
+
+    snap.clear();
+    seq = (uint16_t)(data[4] | (data[5] << 8));
+    snap.epoch = get32(data + 6);
+    int32_t lat = (int32_t)get32(data + 10);
+    int32_t lon = (int32_t)get32(data + 14);
+    snap.latitude = lat == INT32_MIN ? NAN : lat / 1e7;
+    snap.longitude = lon == INT32_MIN ? NAN : lon / 1e7;
+    for (uint8_t i = 0; i < count && i < (uint8_t)LiveField::COUNT; i++) {
+        uint32_t bits = get32(data + LIVE_DATAGRAM_HEADER + 4 * i);
+        memcpy(&snap.fields[i], &bits, sizeof(bits));
+    }
+    return true;
+}
@@ -0,0 +1,94 @@
+/**
+ * SeaSense Logger - Live Data Messages
+ *
+ * What one measurement cycle puts on the boat network, as two payloads:
+ * - NMEA0183 text (talker YX, one datagram, sentences CRLF-separated):
+ *     $YXMTW,18.31,C*hh                 water temperature
+ *     $YXXDR,G,52310,,COND*hh           conductivity, µS/cm
+ *     $YXXDR,G,35.12,,SALN*hh           salinity, PSU
+ *     $YXXDR,G,8.12,,PH*hh              pH
+ *     $YXXDR,G,7.85,,DOXY*hh            dissolved oxygen, mg/L
+ *   Only measured values get a sentence.
+ * - A compact binary datagram with the readings and the context they were
+ *   taken in (position, time, boat instruments), little-endian:
+ *     0  'S' 'S'   magic
+ *     2  u8        version (LIVE_DATAGRAM_VERSION)
+ *     3  u8        number of float fields that follow the header
+ *     4  u16       sequence
+ *     6  u32       UTC epoch seconds, 0 if unknown
+ *     10 i32, i32  latitude, longitude in 1e-7 degrees, INT32_MIN if unknown
+ *     18 f32[n]    LiveField order, NaN if unknown
+ *   Receivers read the fields they know and skip the rest, so fields can
+ *   be appended without a version change.
+ *
+ * Kept free of WiFi so encoders and parser build and run on the host.
+ */
+
+#ifndef SEASENSE_LIVE_MESSAGE_H
+#define SEASENSE_LIVE_MESSAGE_H
+
+#include <Arduino.h>
+#include <math.h>
+
+#define LIVE_DATAGRAM_VERSION 1
+#define LIVE_DATAGRAM_HEADER 18
+#define LIVE_NMEA_MAX 512               // all sentences of one cycle
+
+// Float fields of the binary datagram, in wire order. The four probes come
+// first; each probe's field is its SensorTraits LIVE
+enum class LiveField : uint8_t {
+    WATER_TEMP = 0,     // °C (probe)
+    CONDUCTIVITY,       // µS/cm
+    PH,
+    DISSOLVED_OXYGEN,   // mg/L
+    SALINITY,           // PSU
+    SOG,                // m/s
+    COG,                // degrees true
+    STW,                // m/s
+    DEPTH,              // m below transducer
+    WIND_SPEED_TRUE,    // m/s
+    WIND_ANGLE_TRUE,    // degrees
+    AIR_TEMP,           // °C
+    BARO_PRESSURE,      // Pa
+    COUNT
+};
+
+#define LIVE_DATAGRAM_MAX (LIVE_DATAGRAM_HEADER + 4 * (int)LiveField::COUNT)
+
+struct LiveSnapshot {
+    uint32_t epoch = 0;                 // UTC seconds, 0 if unknown
+    double latitude = NAN;
+    double longitude = NAN;
+    float fields[(int)LiveField::COUNT];
+
+    LiveSnapshot() { clear(); }
+
+    void clear();
+    float get(LiveField f) const { return fields[(int)f]; }
+    void set(LiveField f, float v) { fields[(int)f] = v; }
+};
+
+/**
+ * NMEA0183 checksum: XOR of the characters between '$' and '*'
+ */
+uint8_t nmeaChecksum(const char* body, size_t len);
+
+/**
+ * Build the NMEA0183 sentences for a snapshot
+ * @return Bytes written (0 if nothing was measured or out is too small)
+ */
+size_t buildLiveNmea(const LiveSnapshot& snap, char* out, size_t cap);
+
+/**
+ * Build the binary datagram
+ * @return Bytes written (0 if out is too small)
+ */
+size_t buildLiveDatagram(const LiveSnapshot& snap, uint16_t seq, uint8_t* out, size_t cap);
+
+/**
+ * Parse a binary datagram (fields this build does not know are skipped)
+ * @return false if it is not a live datagram
+ */
+bool parseLiveDatagram(const uint8_t* data, size_t len, LiveSnapshot& snap, uint16_t& seq);
+
+#endif // SEASENSE_LIVE_MESSAGE_H
@@ -0,0 +1,61 @@
+/**
+ * SeaSense Logger - UDP Live Data Broadcaster Implementation
+ */
+
+#include "UdpBroadcaster.h"
+
+UdpBroadcaster::UdpBroadcaster(uint16_t nmeaPort, uint16_t binaryPort)
+    : _nmeaPort(nmeaPort),
+      _binaryPort(binaryPort),
+      _seq(0),
+      _published(0),
+      _datagrams(0),
+      _errors(0)
+{
+}
+
+void UdpBroadcaster::publish(const LiveSnapshot& snap) {
+    // Broadcast address of each interface that is up
+    IPAddress targets[2];
+    uint8_t targetCount = 0;
+    wifi_mode_t mode = WiFi.getMode();
+    if (mode == WIFI_AP || mode == WIFI_AP_STA) {
+        targets[targetCount++] = WiFi.softAPBroadcastIP();
+    }
+    if ((mode == WIFI_STA || mode == WIFI_AP_STA) && WiFi.status() == WL_CONNECTED) {
+        targets[targetCount++] = WiFi.broadcastIP();
+    }
+    if (targetCount == 0) {
+        return;
+    }
+
+    char nmea[LIVE_NMEA_MAX];
+    size_t nmeaLen = buildLiveNmea(snap, nmea, sizeof(nmea));
+    uint8_t datagram[LIVE_DATAGRAM_MAX];
+    size_t datagramLen = buildLiveDatagram(snap, _seq++, datagram, sizeof(datagram));
+
+    bool sent = false;
+    for (uint8_t i = 0; i < targetCount; i++) {
+        if (nmeaLen > 0) {
+            sent |= send(targets[i], _nmeaPort, (const uint8_t*)nmea, nmeaLen);
+        }
+        sent |= send(targets[i], _binaryPort, datagram, datagramLen);
+    }
+    if (sent) {
+        _published++;
+    }
+}
+
+bool UdpBroadcaster::send(const IPAddress& to, uint16_t port, const uint8_t* data, size_t len) {
+    if (!_udp.beginPacket(to, port)) {
+        _errors++;
+        return false;
+    }
+    _udp.write(data, len);
+    if (!_udp.endPacket()) {
+        _errors++;
+        return false;
+    }
+    _datagrams++;
+    return true;
+}
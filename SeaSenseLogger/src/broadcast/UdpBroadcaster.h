@@ -0,0 +1,50 @@
+/**
+ * SeaSense Logger - UDP Live Data Broadcaster
+ *
+ * Pushes each measurement cycle to the boat network so chartplotter apps,
+ * OpenCPN and loggers don't have to poll the web server. Every cycle sends
+ * one NMEA0183 datagram (UDP_LIVE_NMEA_PORT) and one binary datagram
+ * (UDP_LIVE_BINARY_PORT) as subnet broadcasts on each active interface
+ * (own AP, boat WiFi). The cost is the same for one listener or twenty,
+ * and nothing is sent while no interface is up.
+ */
+
+#ifndef SEASENSE_UDP_BROADCASTER_H
+#define SEASENSE_UDP_BROADCASTER_H
+
+#include <Arduino.h>
+#include <WiFi.h>
+#include <WiFiUdp.h>
+#include "LiveMessage.h"
+
+class UdpBroadcaster {
+public:
+    UdpBroadcaster(uint16_t nmeaPort, uint16_t binaryPort);
+
+    /**
+     * Send a cycle's snapshot on every active interface
+     */
+    void publish(const LiveSnapshot& snap);
+
+    uint16_t getNmeaPort() const { return _nmeaPort; }
+    uint16_t getBinaryPort() const { return _binaryPort; }
+
+    // Status
+    uint32_t getPublishedCount() const { return _published; }
+    uint32_t getDatagramCount() const { return _datagrams; }
+    uint32_t getErrorCount() const { return _errors; }
+
+private:
+    WiFiUDP _udp;
+    uint16_t _nmeaPort;
+    uint16_t _binaryPort;
+    uint16_t _seq;
+
+    uint32_t _published;            // snapshots sent on at least one interface
+    uint32_t _datagrams;
+    uint32_t _errors;
+
+    bool send(const IPAddress& to, uint16_t port, const uint8_t* data, size_t len);
+};
+
+#endif // SEASENSE_UDP_BROADCASTER_H
@@ -0,0 +1,76 @@
+/**
+ * SeaSense Logger - Split-Phase Acquisition Scheduler Implementation
+ */
+
+#include "AcquisitionScheduler.h"
+
+AcquisitionScheduler::AcquisitionScheduler(unsigned long sampleIntervalMs)
+    : _intervalMs(sampleIntervalMs),
+      _sampled(0),
+      _pending(0),
+      _requestedAt(0),
+      _waitMs(0),
+      _batches(0),
+      _samples(0)
+{
+    for (uint8_t i = 0; i < MAX_CHANNELS; i++) {
+        _responseMs[i] = 0;
+        _lastRequest[i] = 0;
+    }
+}
+
+void AcquisitionScheduler::setResponseTime(uint8_t channel, unsigned long ms) {
+    if (channel < MAX_CHANNELS) {
+        _responseMs[channel] = ms;
+    }
+}
+
+void AcquisitionScheduler::resetChannel(uint8_t channel) {
+    if (channel < MAX_CHANNELS) {
+        _sampled &= ~(1U << channel);
+    }
+}
+
+void AcquisitionScheduler::poll(unsigned long now, uint8_t activeMask, RequestFn request, CollectFn collect) {
+    // Collect phase: every module of the batch has had its response time.
+    // Channels that went inactive meanwhile are still collected, so no
+    // module is left holding a result for the next command
+    if (_pending) {
+        if (now - _requestedAt < _waitMs) {
+            return;
+        }
+        uint8_t batch = _pending;
+        _pending = 0;
+        for (uint8_t i = 0; i < MAX_CHANNELS; i++) {
+            if (batch & (1U << i)) {
+                collect(i);
+                _samples++;
+            }
+        }
+        return;
+    }
+
+    // Request phase: start every due channel together
+    _waitMs = 0;
+    for (uint8_t i = 0; i < MAX_CHANNELS; i++) {
+        uint8_t bit = 1U << i;
+        if (!(activeMask & bit)) {
+            continue;
+        }
+        if ((_sampled & bit) && now - _lastRequest[i] < _intervalMs) {
+            continue;
+        }
+        _lastRequest[i] = now;
+        _sampled |= bit;
+        if (request(i)) {
+            _pending |= bit;
+            if (_responseMs[i] > _waitMs) {
+                _waitMs = _responseMs[i];
+            }
+        }
+    }
+    if (_pending) {
+        _requestedAt = now;
+        _batches++;
+    }
+}
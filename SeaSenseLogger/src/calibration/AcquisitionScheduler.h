@@ -0,0 +1,79 @@
+/**
+ * SeaSense Logger - Split-Phase Acquisition Scheduler
+ *
+ * Reads several EZO modules in the time of one. A blocking read costs the
+ * module's full response time (~1 s) on the bus, so reading four probes one
+ * after another takes four seconds per sample. Here every due channel gets
+ * its read command in one pass (request phase), the modules convert in
+ * parallel, and one later pass fetches all results (collect phase) once the
+ * slowest module's response time has passed. Nothing blocks in between.
+ *
+ * Each channel is sampled at most once per sample interval. The scheduler
+ * only decides timing; the caller's callbacks do the I2C work.
+ * Pure logic, no hardware dependencies — fully testable on native.
+ */
+
+#ifndef ACQUISITION_SCHEDULER_H
+#define ACQUISITION_SCHEDULER_H
+
+#include <stdint.h>
+#include <functional>
+
+class AcquisitionScheduler {
+public:
+    static const uint8_t MAX_CHANNELS = 8;
+
+    // Send the read command for a channel; false = failed, nothing to collect
+    typedef std::function<bool(uint8_t channel)> RequestFn;
+    // Fetch the result of an earlier request
+    typedef std::function<void(uint8_t channel)> CollectFn;
+
+    /**
+     * @param sampleIntervalMs Minimum spacing between samples of one channel
+     */
+    explicit AcquisitionScheduler(unsigned long sampleIntervalMs);
+
+    /**
+     * Conversion time of a channel's module
+     */
+    void setResponseTime(uint8_t channel, unsigned long ms);
+
+    /**
+     * Advance the schedule. Call often; returns without bus traffic unless a
+     * phase is due. Collects a finished batch, otherwise requests every
+     * channel in activeMask that is due for a sample.
+     * @param activeMask Bit per channel that wants samples
+     */
+    void poll(unsigned long now, uint8_t activeMask, RequestFn request, CollectFn collect);
+
+    /**
+     * Forget sample times (a channel starts a new session)
+     */
+    void resetChannel(uint8_t channel);
+
+    /** Requests sent and waiting to be collected */
+    bool isPending() const { return _pending != 0; }
+    uint8_t getPendingMask() const { return _pending; }
+
+    /** When the batch being (or last) collected was requested */
+    unsigned long getRequestedAt() const { return _requestedAt; }
+
+    // Status
+    uint32_t getBatchCount() const { return _batches; }
+    uint32_t getSampleCount() const { return _samples; }
+
+private:
+    unsigned long _intervalMs;
+    unsigned long _responseMs[MAX_CHANNELS];
+    unsigned long _lastRequest[MAX_CHANNELS];
+    uint8_t _sampled;           // bit per channel with a _lastRequest
+
+    uint8_t _pending;           // channels requested in the current batch
+    unsigned long _requestedAt;
+    unsigned long _waitMs;      // slowest response time in the batch
+
+    uint32_t _batches;
+    uint32_t _samples;
+};
+
+#endif // ACQUISITION_SCHEDULER_H
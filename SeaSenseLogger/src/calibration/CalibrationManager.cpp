@@ -3,6 +3,12 @@
  */
 
 #include "CalibrationManager.h"
+#include "../../config/hardware_config.h"
+#include <string.h>
+
+static const char* NVS_NAMESPACE = "calibration";
+static const char* NOISE_FLOOR_KEYS[] = {"nf_temp", "nf_ec", "nf_ph", "nf_do"};
+static const char* SENSOR_KEYS[] = {"temperature", "conductivity", "ph", "dissolved_oxygen"};
 
 // Implemented in SeaSenseLogger.ino
 extern bool updateSensorCalibration(const String& sensorType,
@@ -19,10 +25,71 @@ CalibrationManager::CalibrationManager(EZO_RTD* tempSensor, EZO_EC* ecSensor, EZ
       _ecSensor(ecSensor),
       _phSensor(phSensor),
       _doSensor(doSensor),
-      _stabilityIndex(0),
-      _lastReadingTime(0)
+      _scheduler(CAL_SAMPLE_INTERVAL_MS),
+      _nvsReady(false),
+      _nvsHandle(0)
 {
-    resetState();
+    for (int i = 0; i < SENSOR_COUNT; i++) {
+        _noiseFloors[i] = 0.0f;
+        EZOSensor* sensor = sensorAt(i);
+        if (sensor) {
+            _scheduler.setResponseTime(i, sensor->getResponseTime());
+        }
+        resetState(i);
+    }
+}
+
+void CalibrationManager::begin() {
+    _nvsReady = (nvs_open(NVS_NAMESPACE, NVS_READWRITE, &_nvsHandle) == ESP_OK);
+    if (!_nvsReady) {
+        Serial.println("[CALIBRATION] NVS unavailable - noise floors will not persist");
+        return;
+    }
+
+    // Floats are stored as their raw bits in a u32 slot
+    for (int i = 0; i < SENSOR_COUNT; i++) {
+        uint32_t bits;
+        if (nvs_get_u32(_nvsHandle, NOISE_FLOOR_KEYS[i], &bits) == ESP_OK) {
+            float value;
+            memcpy(&value, &bits, sizeof(value));
+            if (!isnan(value) && value >= 0.0f) {
+                _noiseFloors[i] = value;
+            }
+        }
+    }
+}
+
+float CalibrationManager::getNoiseFloor(const String& sensorType) const {
+    int idx = sensorIndex(sensorType);
+    return (idx >= 0) ? _noiseFloors[idx] : 0.0f;
+}
+
+CalibrationState CalibrationManager::getState(const String& sensorType) const {
+    int idx = sensorIndex(sensorType);
+    if (idx < 0) {
+        CalibrationState idle = {};
+        idle.predictedValue = NAN;
+        return idle;
+    }
+    return _states[idx];
+}
+
+bool CalibrationManager::isCalibrating() const {
+    for (int i = 0; i < SENSOR_COUNT; i++) {
+        if (isActive(_states[i])) {
+            return true;
+        }
+    }
+    return false;
+}
+
+bool CalibrationManager::isCalibrating(const String& sensorType) const {
+    int idx = sensorIndex(sensorType);
+    return idx >= 0 && isActive(_states[idx]);
+}
+
+const char* CalibrationManager::sensorKey(int idx) {
+    return (idx >= 0 && idx < SENSOR_COUNT) ? SENSOR_KEYS[idx] : "";
 }
 
 // ============================================================================
@@ -34,41 +101,50 @@ bool CalibrationManager::startCalibration(
     CalibrationType calibrationType,
     float referenceValue
 ) {
-    // Check if already calibrating
-    if (isCalibrating()) {
+    // One session per sensor; others may be running
+    int idx = sensorIndex(sensorType);
+    if (idx < 0 || isActive(_states[idx])) {
         return false;
     }
 
     // Reset state
-    resetState();
+    resetState(idx);
+    CalibrationState& state = _states[idx];
 
     // Set calibration parameters
-    _state.sensorType = sensorType;
-    _state.type = calibrationType;
-    _state.referenceValue = referenceValue;
-    _state.startTime = millis();
-    _state.status = CalibrationStatus::PREPARING;
+    state.sensorType = sensorType;
+    state.type = calibrationType;
+    state.referenceValue = referenceValue;
+    state.startTime = millis();
+    state.status = CalibrationStatus::PREPARING;
 
     // Set initial message
     if (calibrationType == CalibrationType::EC_DRY) {
-        _state.message = "Remove probe from liquid and ensure it is dry";
+        state.message = "Remove probe from liquid and ensure it is dry";
     } else if (calibrationType == CalibrationType::TEMPERATURE_SINGLE) {
-        _state.message = "Place probe in reference temperature environment";
+        state.message = "Place probe in reference temperature environment";
     } else if (calibrationType == CalibrationType::PH_MID) {
-        _state.message = "Place probe in pH " + String(referenceValue, 2) + " buffer solution";
+        state.message = "Place probe in pH " + String(referenceValue, 2) + " buffer solution";
     } else if (calibrationType == CalibrationType::PH_LOW) {
-        _state.message = "Place probe in pH " + String(referenceValue, 2) + " buffer solution";
+        state.message = "Place probe in pH " + String(referenceValue, 2) + " buffer solution";
     } else if (calibrationType == CalibrationType::PH_HIGH) {
-        _state.message = "Place probe in pH " + String(referenceValue, 2) + " buffer solution";
+        state.message = "Place probe in pH " + String(referenceValue, 2) + " buffer solution";
     } else if (calibrationType == CalibrationType::DO_ATMOSPHERIC) {
-        _state.message = "Hold probe in air, ensure membrane is dry";
+        state.message = "Hold probe in air, ensure membrane is dry";
     } else if (calibrationType == CalibrationType::DO_ZERO) {
-        _state.message = "Place probe in 0 mg/L sodium sulfite solution";
+        state.message = "Place probe in 0 mg/L sodium sulfite solution";
     } else {
-        _state.message = "Place probe in calibration solution (" +
+        state.message = "Place probe in calibration solution (" +
                         String(referenceValue, 0) + " \xC2\xB5S/cm)";
     }
 
+    // The operator is at the probe now: give it a fresh breaker so update()
+    // actually reads it instead of failing on a skip left over from the field
+    EZOSensor* sensor = sensorAt(idx);
+    if (sensor) {
+        sensor->resetBreaker();
+    }
+
     Serial.print("[CALIBRATION] Starting ");
     Serial.print(sensorType);
     Serial.print(" calibration, type=");
@@ -78,94 +154,164 @@ bool CalibrationManager::startCalibration(
 }
 
 void CalibrationManager::update() {
-    if (!isCalibrating()) {
+    if (!needsUpdate()) {
         return;
     }
 
-    unsigned long now = millis();
+    uint8_t activeMask = 0;
+    for (int i = 0; i < SENSOR_COUNT; i++) {
+        if (isActive(_states[i])) {
+            activeMask |= 1 << i;
+        }
+    }
 
-    // Read current sensor value
-    float currentValue = 0.0;
-    bool readSuccess = false;
+    _scheduler.poll(millis(), activeMask,
+                    [this](uint8_t idx) { return requestSample(idx); },
+                    [this](uint8_t idx) { collectSample(idx); });
+}
 
-    if (_state.sensorType == "temperature" && _tempSensor) {
-        if (_tempSensor->read()) {
-            currentValue = _tempSensor->getValue();
-            readSuccess = true;
-        }
-    } else if (_state.sensorType == "conductivity" && _ecSensor) {
-        if (_ecSensor->read()) {
-            currentValue = _ecSensor->getValue();
-            readSuccess = true;
-        }
-    } else if (_state.sensorType == "ph" && _phSensor) {
-        if (_phSensor->read()) {
-            currentValue = _phSensor->getValue();
-            readSuccess = true;
-        }
-    } else if (_state.sensorType == "dissolved_oxygen" && _doSensor) {
-        if (_doSensor->read()) {
-            currentValue = _doSensor->getValue();
-            readSuccess = true;
-        }
+void CalibrationManager::cancel() {
+    for (int i = 0; i < SENSOR_COUNT; i++) {
+        cancel(SENSOR_KEYS[i]);
+    }
+}
+
+void CalibrationManager::cancel(const String& sensorType) {
+    int idx = sensorIndex(sensorType);
+    if (idx >= 0 && isActive(_states[idx])) {
+        Serial.print("[CALIBRATION] Cancelled ");
+        Serial.println(sensorType);
+        _states[idx].status = CalibrationStatus::ERROR;
+        _states[idx].message = "Calibration cancelled by user";
+        _states[idx].success = false;
     }
+}
 
-    if (!readSuccess) {
-        _state.status = CalibrationStatus::ERROR;
-        _state.message = "Failed to read sensor";
-        _state.success = false;
+// ============================================================================
+// Private Methods
+// ============================================================================
+
+EZOSensor* CalibrationManager::sensorAt(int idx) const {
+    switch (idx) {
+        case 0: return _tempSensor;
+        case 1: return _ecSensor;
+        case 2: return _phSensor;
+        case 3: return _doSensor;
+        default: return nullptr;
+    }
+}
+
+bool CalibrationManager::requestSample(uint8_t idx) {
+    EZOSensor* sensor = sensorAt(idx);
+    if (sensor && sensor->requestRead()) {
+        return true;
+    }
+    sampleFailed(idx);
+    return false;
+}
+
+void CalibrationManager::collectSample(uint8_t idx) {
+    EZOSensor* sensor = sensorAt(idx);
+    bool ok = sensor && sensor->collectRead();
+    if (!isActive(_states[idx])) {
+        return;     // cancelled while the read was out
+    }
+    if ((long)(_scheduler.getRequestedAt() - _states[idx].startTime) < 0) {
+        return;     // requested for a session that ended; the new one has not sampled yet
+    }
+    if (!ok) {
+        sampleFailed(idx);
+        return;
+    }
+    _readFailures[idx] = 0;
+    step(idx, sensor->getValue(), millis());
+}
+
+// Another bus user (a web read, calibration info) can talk to the module
+// between request and collect, so a single failed read is not fatal
+void CalibrationManager::sampleFailed(int idx) {
+    CalibrationState& state = _states[idx];
+    if (!isActive(state)) {
         return;
     }
+    if (++_readFailures[idx] >= CAL_MAX_READ_FAILURES) {
+        state.status = CalibrationStatus::ERROR;
+        state.message = "Failed to read sensor";
+        state.success = false;
+    }
+}
 
-    _state.currentReading = currentValue;
+void CalibrationManager::step(int idx, float currentValue, unsigned long now) {
+    CalibrationState& state = _states[idx];
+    StabilityDetector& detector = _detectors[idx];
+    state.currentReading = currentValue;
 
     // State machine
-    switch (_state.status) {
+    switch (state.status) {
         case CalibrationStatus::PREPARING:
-            // Wait a few seconds before checking stability
-            if (now - _state.startTime > 3000) {
-                _state.status = CalibrationStatus::WAITING_STABLE;
-                _state.message = "Waiting for reading to stabilize...";
-                Serial.println("[CALIBRATION] Waiting for stable reading");
+            // Let the initial splash settle before sampling; the detector
+            // restarts its window on any later transient by itself
+            if (now - state.startTime > CAL_SETTLE_DELAY_MS) {
+                prepareDetector(idx);
+                state.status = CalibrationStatus::WAITING_STABLE;
+                state.message = "Waiting for reading to stabilize...";
+                Serial.print("[CALIBRATION] ");
+                Serial.print(state.sensorType);
+                Serial.println(": waiting for stable reading");
             }
             break;
 
         case CalibrationStatus::WAITING_STABLE: {
-            // Timeout after 60 seconds of waiting for stability
-            if (now - _state.startTime > 60000) {
-                _state.status = CalibrationStatus::ERROR;
-                _state.message = "Timed out waiting for stable reading (CV=" +
-                               String(_lastCV, 2) + "%). Try reducing agitation.";
-                _state.success = false;
-                Serial.print("[CALIBRATION] Timeout — CV: ");
-                Serial.print(_lastCV, 2);
-                Serial.println("%");
+            // Timeout waiting for stability
+            if (now - state.startTime > CAL_STABILITY_TIMEOUT_MS) {
+                state.status = CalibrationStatus::ERROR;
+                state.message = "Timed out waiting for stable reading (noise=" +
+                               String(detector.getNoise(), 3) + ", need <" +
+                               String(detector.getTolerance(), 3) +
+                               "). Try reducing agitation.";
+                state.success = false;
+                Serial.print("[CALIBRATION] ");
+                Serial.print(state.sensorType);
+                Serial.print(": timeout — noise: ");
+                Serial.print(detector.getNoise(), 4);
+                Serial.print(", drift: ");
+                Serial.println(detector.getDrift(), 4);
                 break;
             }
             // Check if reading is stable
-            if (isReadingStable(currentValue)) {
-                _state.status = CalibrationStatus::CALIBRATING;
-                _state.message = "Performing calibration...";
-                _state.stableTime = now;
-                Serial.println("[CALIBRATION] Reading stable, performing calibration");
+            if (isReadingStable(idx, currentValue, now)) {
+                state.status = CalibrationStatus::CALIBRATING;
+                state.message = "Performing calibration...";
+                state.stableTime = now;
+                Serial.print("[CALIBRATION] ");
+                Serial.print(state.sensorType);
+                Serial.println(": reading stable, performing calibration");
 
                 // Perform calibration
-                if (performCalibration()) {
-                    _state.status = CalibrationStatus::COMPLETE;
-                    _state.message = "Calibration successful!";
-                    _state.success = true;
-                    Serial.println("[CALIBRATION] Success!");
+                if (performCalibration(idx)) {
+                    state.status = CalibrationStatus::COMPLETE;
+                    state.message = "Calibration successful!";
+                    state.success = true;
+                    Serial.print("[CALIBRATION] ");
+                    Serial.print(state.sensorType);
+                    Serial.println(": success!");
                 } else {
-                    _state.status = CalibrationStatus::ERROR;
-                    _state.message = "Calibration command failed — sensor rejected the command";
-                    _state.success = false;
-                    Serial.println("[CALIBRATION] Failed!");
+                    state.status = CalibrationStatus::ERROR;
+                    state.message = "Calibration command failed — sensor rejected the command";
+                    state.success = false;
+                    Serial.print("[CALIBRATION] ");
+                    Serial.print(state.sensorType);
+                    Serial.println(": failed!");
+                }
+            } else if (detector.getSampleCount() >= 3) {
+                // Show drift progress so user can see how close to stability
+                float drift = detector.getDrift();
+                state.message = "Stabilizing... drift " + String(drift, 3) +
+                               " (need <" + String(detector.getTolerance(), 3) +
+                               ") — " + String(currentValue, 2);
+                if (!isnan(state.predictedValue)) {
+                    state.message += ", settling to " + String(state.predictedValue, 2);
                 }
-            } else {
-                // Show CV progress so user can see how close to stability
-                _state.message = "Stabilizing... CV=" + String(_lastCV, 2) +
-                               "% (need <" + String(_lastCVTarget, 1) +
-                               "%) — " + String(currentValue, 1);
             }
             break;
         }
@@ -183,92 +329,90 @@ void CalibrationManager::update() {
     }
 }
 
-void CalibrationManager::cancel() {
-    if (isCalibrating()) {
-        Serial.println("[CALIBRATION] Cancelled");
-        _state.status = CalibrationStatus::ERROR;
-        _state.message = "Calibration cancelled by user";
-        _state.success = false;
-    }
-}
-
-// ============================================================================
-// Private Methods
-// ============================================================================
-
-bool CalibrationManager::isReadingStable(float currentValue) {
-    unsigned long now = millis();
-
-    // Only sample every 500ms
-    if (now - _lastReadingTime < 500) {
-        return false;
-    }
-    _lastReadingTime = now;
+// Samples arrive no faster than CAL_SAMPLE_INTERVAL_MS (the scheduler
+// spaces them)
+bool CalibrationManager::isReadingStable(int idx, float currentValue, unsigned long now) {
+    CalibrationState& state = _states[idx];
+    StabilityDetector& detector = _detectors[idx];
 
-    // Add to circular stability buffer
-    _stabilityBuffer[_stabilityIndex] = currentValue;
-    _stabilityIndex = (_stabilityIndex + 1) % STABILITY_SAMPLES;
+    detector.addSample((now - state.startTime) / 1000.0f, currentValue);
+    state.predictedValue = detector.getPredictedValue();
 
-    // Minimum time in WAITING_STABLE: need full buffer + at least 5s total
-    unsigned long minStableMs = STABILITY_SAMPLES * 500 + 3000;
-    if (now - _state.startTime < minStableMs) {
-        return false;
-    }
+    bool stable = detector.isStable();
 
-    // Calculate mean and coefficient of variation (CV)
-    float mean = 0;
-    for (int i = 0; i < STABILITY_SAMPLES; i++) {
-        mean += _stabilityBuffer[i];
+    if (stable) {
+        Serial.print("[CALIBRATION] ");
+        Serial.print(state.sensorType);
+        Serial.print(": reading stable ");
+        Serial.print(detector.getMean(), 3);
+        Serial.print(" (noise: ");
+        Serial.print(detector.getNoise(), 4);
+        Serial.print(", slope: ");
+        Serial.print(detector.getSlope(), 5);
+        Serial.print("/s, ");
+        Serial.print(detector.getSampleCount());
+        Serial.println(" samples)");
+        learnNoiseFloor(idx, detector.getNoise());
     }
-    mean /= STABILITY_SAMPLES;
 
-    float variance = 0;
-    for (int i = 0; i < STABILITY_SAMPLES; i++) {
-        float diff = _stabilityBuffer[i] - mean;
-        variance += diff * diff;
-    }
-    variance /= STABILITY_SAMPLES;
+    return stable;
+}
 
-    // Use percentage-based threshold (coefficient of variation)
-    // CV = sqrt(variance) / |mean|, but we compare variance against (mean * pct)^2
+void CalibrationManager::prepareDetector(int idx) {
+    // Relative tolerance per sensor; the absolute minimum covers readings
+    // near zero (EC dry, DO zero)
+    const String& sensorType = _states[idx].sensorType;
     float pct = 0.002f;  // default: 0.2% for temperature
-    if (_state.sensorType == "conductivity") {
+    if (sensorType == "conductivity") {
         pct = 0.005f;    // 0.5% — e.g. ±750 µS at 150000 (stirred high-EC)
-    } else if (_state.sensorType == "ph") {
+    } else if (sensorType == "ph") {
         pct = 0.005f;    // 0.5% — e.g. ±0.035 at pH 7
-    } else if (_state.sensorType == "dissolved_oxygen") {
+    } else if (sensorType == "dissolved_oxygen") {
         pct = 0.005f;    // 0.5% — e.g. ±0.04 at 8 mg/L
     }
 
-    // Threshold = (mean * pct)^2, with a small floor to avoid div-by-zero
-    float absMean = fabs(mean);
-    float limit = absMean * pct;
-    float threshold = (limit > 0.001f) ? limit * limit : 0.001f;
+    StabilityDetector& detector = _detectors[idx];
+    detector.reset();
+    detector.setTolerance(pct, 0.03f);
+    detector.setMinSamples(CAL_STABILITY_MIN_SAMPLES);
+    detector.setDriftHorizon(CAL_DRIFT_HORIZON_S);
+    detector.setNoiseFloor(_noiseFloors[idx]);
+}
 
-    // Track CV for status messages and timeout reporting
-    _lastCV = (absMean > 0.001f) ? sqrt(variance) / absMean * 100.0f : 0.0f;
-    _lastCVTarget = pct * 100.0f;
+void CalibrationManager::learnNoiseFloor(int idx, float sigma) {
+    if (idx < 0 || isnan(sigma)) {
+        return;
+    }
 
-    bool stable = (variance < threshold);
+    float& nf = _noiseFloors[idx];
+    nf = (nf > 0.0f)
+        ? nf + CAL_NOISE_FLOOR_ALPHA * (sigma - nf)
+        : sigma;
 
-    if (stable) {
-        Serial.print("[CALIBRATION] Reading stable: ");
-        Serial.print(mean, 2);
-        Serial.print(" (CV: ");
-        Serial.print(_lastCV, 3);
-        Serial.println("%)");
+    if (_nvsReady) {
+        uint32_t bits;
+        memcpy(&bits, &nf, sizeof(bits));
+        nvs_set_u32(_nvsHandle, NOISE_FLOOR_KEYS[idx], bits);
+        nvs_commit(_nvsHandle);
     }
+}
 
-    return stable;
+int CalibrationManager::sensorIndex(const String& sensorType) {
+    if (sensorType == "temperature") return 0;
+    if (sensorType == "conductivity") return 1;
+    if (sensorType == "ph") return 2;
+    if (sensorType == "dissolved_oxygen") return 3;
+    return -1;
 }
 
-bool CalibrationManager::performCalibration() {
+bool CalibrationManager::performCalibration(int idx) {
+    const CalibrationState& state = _states[idx];
     bool success = false;
 
-    switch (_state.type) {
+    switch (state.type) {
         case CalibrationType::TEMPERATURE_SINGLE:
             if (_tempSensor) {
-                success = _tempSensor->calibrate(_state.referenceValue);
+                success = _tempSensor->calibrate(state.referenceValue);
             }
             break;
 
@@ -280,37 +424,37 @@ bool CalibrationManager::performCalibration() {
 
         case CalibrationType::EC_SINGLE:
             if (_ecSensor) {
-                success = _ecSensor->calibrateSinglePoint(_state.referenceValue);
+                success = _ecSensor->calibrateSinglePoint(state.referenceValue);
             }
             break;
 
         case CalibrationType::EC_TWO_LOW:
             if (_ecSensor) {
-                success = _ecSensor->calibrateLowPoint(_state.referenceValue);
+                success = _ecSensor->calibrateLowPoint(state.referenceValue);
             }
             break;
 
         case CalibrationType::EC_TWO_HIGH:
             if (_ecSensor) {
-                success = _ecSensor->calibrateHighPoint(_state.referenceValue);
+                success = _ecSensor->calibrateHighPoint(state.referenceValue);
             }
             break;
 
         case CalibrationType::PH_MID:
             if (_phSensor) {
-                success = _phSensor->calibrateMidPoint(_state.referenceValue);
+                success = _phSensor->calibrateMidPoint(state.referenceValue);
             }
             break;
 
         case CalibrationType::PH_LOW:
             if (_phSensor) {
-                success = _phSensor->calibrateLowPoint(_state.referenceValue);
+                success = _phSensor->calibrateLowPoint(state.referenceValue);
             }
             break;
 
         case CalibrationType::PH_HIGH:
             if (_phSensor) {
-                success = _phSensor->calibrateHighPoint(_state.referenceValue);
+                success = _phSensor->calibrateHighPoint(state.referenceValue);
             }
             break;
 
@@ -334,7 +478,7 @@ bool CalibrationManager::performCalibration() {
     if (success) {
         // Map CalibrationType to a human-readable string for the log
         String calTypeStr;
-        switch (_state.type) {
+        switch (state.type) {
             case CalibrationType::TEMPERATURE_SINGLE: calTypeStr = "single";       break;
             case CalibrationType::EC_DRY:             calTypeStr = "dry";          break;
             case CalibrationType::EC_SINGLE:          calTypeStr = "single";       break;
@@ -349,33 +493,31 @@ bool CalibrationManager::performCalibration() {
         }
         // Sensor type strings must match what getSensorMetadata() expects
         String sensorType;
-        if (_state.sensorType == "temperature") sensorType = "Temperature";
-        else if (_state.sensorType == "conductivity") sensorType = "Conductivity";
-        else if (_state.sensorType == "ph") sensorType = "pH";
-        else if (_state.sensorType == "dissolved_oxygen") sensorType = "Dissolved Oxygen";
-        else sensorType = _state.sensorType;
-        updateSensorCalibration(sensorType, calTypeStr, _state.referenceValue, "");
+        if (state.sensorType == "temperature") sensorType = "Temperature";
+        else if (state.sensorType == "conductivity") sensorType = "Conductivity";
+        else if (state.sensorType == "ph") sensorType = "pH";
+        else if (state.sensorType == "dissolved_oxygen") sensorType = "Dissolved Oxygen";
+        else sensorType = state.sensorType;
+        updateSensorCalibration(sensorType, calTypeStr, state.referenceValue, "");
     }
 
     return success;
 }
 
-void CalibrationManager::resetState() {
-    _state.status = CalibrationStatus::IDLE;
-    _state.type = CalibrationType::NONE;
-    _state.sensorType = "";
-    _state.referenceValue = 0.0;
-    _state.currentReading = 0.0;
-    _state.startTime = 0;
-    _state.stableTime = 0;
-    _state.message = "";
-    _state.success = false;
-
-    _stabilityIndex = 0;
-    _lastReadingTime = 0;
-    _lastCV = 0.0;
-    _lastCVTarget = 0.0;
-    for (int i = 0; i < STABILITY_SAMPLES; i++) {
-        _stabilityBuffer[i] = 0.0;
-    }
+void CalibrationManager::resetState(int idx) {
+    CalibrationState& state = _states[idx];
+    state.status = CalibrationStatus::IDLE;
+    state.type = CalibrationType::NONE;
+    state.sensorType = "";
+    state.referenceValue = 0.0;
+    state.currentReading = 0.0;
+    state.predictedValue = NAN;
+    state.startTime = 0;
+    state.stableTime = 0;
+    state.message = "";
+    state.success = false;
+
+    _readFailures[idx] = 0;
+    _detectors[idx].reset();
+    _scheduler.resetChannel(idx);
 }
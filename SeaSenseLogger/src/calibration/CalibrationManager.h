@@ -5,12 +5,20 @@
  * - Guided calibration procedures
  * - Status tracking and progress updates
  * - Automatic metadata updates
+ * - Streaming stability detection with learned per-sensor noise floors
+ * - One session per sensor, running concurrently: all probes being
+ *   calibrated are sampled together through a split-phase
+ *   AcquisitionScheduler, so a four-sensor service takes as long as the
+ *   slowest probe rather than the sum
  */
 
 #ifndef CALIBRATION_MANAGER_H
 #define CALIBRATION_MANAGER_H
 
 #include <Arduino.h>
+#include <nvs.h>
+#include "StabilityDetector.h"
+#include "AcquisitionScheduler.h"
 #include "../sensors/EZO_RTD.h"
 #include "../sensors/EZO_EC.h"
 #include "../sensors/EZO_pH.h"
@@ -46,7 +54,7 @@ enum class CalibrationType {
 };
 
 /**
- * Calibration state
+ * Calibration state (one per sensor session)
  */
 struct CalibrationState {
     CalibrationStatus status;
@@ -54,6 +62,7 @@ struct CalibrationState {
     String sensorType;          // "temperature", "conductivity", "ph", or "dissolved_oxygen"
     float referenceValue;       // Expected value for calibration
     float currentReading;       // Current sensor reading
+    float predictedValue;       // Extrapolated settling value (NAN until a fit exists)
     unsigned long startTime;    // When calibration started
     unsigned long stableTime;   // When reading became stable
     String message;             // Status message
@@ -72,11 +81,17 @@ public:
     CalibrationManager(EZO_RTD* tempSensor, EZO_EC* ecSensor, EZO_pH* phSensor = nullptr, EZO_DO* doSensor = nullptr);
 
     /**
-     * Start calibration procedure
-     * @param sensorType "temperature" or "conductivity"
+     * Load learned noise floors from NVS.
+     * Call after SystemHealth::begin() has initialised NVS.
+     */
+    void begin();
+
+    /**
+     * Start a calibration session. Sessions for other sensors may be running.
+     * @param sensorType "temperature", "conductivity", "ph" or "dissolved_oxygen"
      * @param calibrationType Type of calibration
      * @param referenceValue Reference value (for single/two-point)
-     * @return true if calibration started successfully
+     * @return true if calibration started (false if this sensor is already calibrating)
      */
     bool startCalibration(
         const String& sensorType,
@@ -85,64 +100,138 @@ public:
     );
 
     /**
-     * Update calibration state machine
-     * Call this periodically (e.g., every 100ms)
+     * Advance every session. Never waits for a probe: read commands go out
+     * in one pass and are collected in a later one.
+     * Call this often (every loop pass), holding the I2C bus while needsUpdate().
      */
     void update();
 
     /**
-     * Get current calibration state
-     * @return CalibrationState structure
+     * Calibrating, or reads still to be collected
+     */
+    bool needsUpdate() const { return isCalibrating() || _scheduler.isPending(); }
+
+    /**
+     * Get a sensor's session state (IDLE if it never started)
+     * @param sensorType "temperature", "conductivity", "ph" or "dissolved_oxygen"
      */
-    CalibrationState getState() const { return _state; }
+    CalibrationState getState(const String& sensorType) const;
 
     /**
-     * Check if calibration is in progress
+     * Check if any calibration is in progress
      * @return true if calibrating
      */
-    bool isCalibrating() const {
-        return _state.status != CalibrationStatus::IDLE &&
-               _state.status != CalibrationStatus::COMPLETE &&
-               _state.status != CalibrationStatus::ERROR;
-    }
+    bool isCalibrating() const;
+
+    /**
+     * Check if a sensor's calibration is in progress
+     */
+    bool isCalibrating(const String& sensorType) const;
 
     /**
-     * Cancel current calibration
+     * Cancel every calibration in progress
      */
     void cancel();
 
+    /**
+     * Cancel one sensor's calibration
+     */
+    void cancel(const String& sensorType);
+
+    /**
+     * Learned measurement noise (std dev) for a sensor, 0 if not yet learned
+     * @param sensorType "temperature", "conductivity", "ph" or "dissolved_oxygen"
+     */
+    float getNoiseFloor(const String& sensorType) const;
+
+    /**
+     * Shared read scheduler (batch and sample counts for status)
+     */
+    const AcquisitionScheduler& getScheduler() const { return _scheduler; }
+
+    static const int SENSOR_COUNT = 4;
+
+    /**
+     * Session key of a sensor slot ("temperature", ...)
+     */
+    static const char* sensorKey(int idx);
+
 private:
     EZO_RTD* _tempSensor;
     EZO_EC* _ecSensor;
     EZO_pH* _phSensor;
     EZO_DO* _doSensor;
-    CalibrationState _state;
 
-    // Stability detection
-    static const int STABILITY_SAMPLES = 10;
-    float _stabilityBuffer[STABILITY_SAMPLES];
-    int _stabilityIndex;
-    unsigned long _lastReadingTime;
-    float _lastCV;          // Last computed CV (%) for status messages
-    float _lastCVTarget;    // Target CV threshold (%) for status messages
+    // One session per sensor slot (sensorIndex order)
+    CalibrationState _states[SENSOR_COUNT];
+    StabilityDetector _detectors[SENSOR_COUNT];
+    uint8_t _readFailures[SENSOR_COUNT];   // consecutive failed reads this session
+    AcquisitionScheduler _scheduler;
+
+    float _noiseFloors[SENSOR_COUNT];   // Learned per-sensor noise, persisted in NVS
+    bool _nvsReady;
+    nvs_handle_t _nvsHandle;
+
+    static bool isActive(const CalibrationState& state) {
+        return state.status != CalibrationStatus::IDLE &&
+               state.status != CalibrationStatus::COMPLETE &&
+               state.status != CalibrationStatus::ERROR;
+    }
+
+    /**
+     * The probe behind a sensor slot (nullptr if not fitted)
+     */
+    EZOSensor* sensorAt(int idx) const;
+
+    /**
+     * Scheduler callbacks: send a session's read command, collect its result
+     */
+    bool requestSample(uint8_t idx);
+    void collectSample(uint8_t idx);
+
+    /**
+     * A read failed; the session fails after CAL_MAX_READ_FAILURES in a row
+     */
+    void sampleFailed(int idx);
+
+    /**
+     * Run a session's state machine on a new reading
+     */
+    void step(int idx, float currentValue, unsigned long now);
 
     /**
      * Check if sensor reading is stable
      * @param currentValue Current sensor reading
      * @return true if stable
      */
-    bool isReadingStable(float currentValue);
+    bool isReadingStable(int idx, float currentValue, unsigned long now);
+
+    /**
+     * Configure the session's detector (tolerance, noise floor)
+     */
+    void prepareDetector(int idx);
+
+    /**
+     * Fold the noise of a stable window into the sensor's floor and persist it
+     */
+    void learnNoiseFloor(int idx, float sigma);
+
+    /**
+     * Map sensor type to session / noise floor slot
+     * @return index, or -1 if unknown
+     */
+    static int sensorIndex(const String& sensorType);
 
     /**
      * Perform the actual calibration command
      * @return true if successful
      */
-    bool performCalibration();
+    bool performCalibration(int idx);
 
     /**
-     * Reset calibration state
+     * Reset a session to IDLE
      */
-    void resetState();
+    void resetState(int idx);
 };
 
 #endif // CALIBRATION_MANAGER_H
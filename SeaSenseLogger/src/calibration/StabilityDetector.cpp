@@ -0,0 +1,231 @@
+/**
+ * SeaSense Logger - Streaming Stability Detector Implementation
+ */
+
+#include "StabilityDetector.h"
+#include <math.h>
+
+// A sample this many noise-sigmas off the fitted line is a step, not noise
+static const float STEP_SIGMAS = 4.0f;
+
+// Extrapolate only when each segment-to-segment change shrinks by at least
+// this ratio (slower decays are too close to linear drift to trust)
+static const float MAX_DECAY_RATIO = 0.85f;
+
+StabilityDetector::StabilityDetector()
+    : _relTol(0.002f),
+      _absTol(0.001f),
+      _noiseFloor(0.0f),
+      _horizon(10.0f),
+      _minSamples(6)
+{
+    reset();
+}
+
+void StabilityDetector::reset() {
+    _head = 0;
+    _count = 0;
+    _resets = 0;
+    _meanT = 0.0;
+    _meanY = 0.0;
+    _m2T = 0.0;
+    _m2Y = 0.0;
+    _cTY = 0.0;
+    _sumSqDiff = 0.0;
+}
+
+void StabilityDetector::setTolerance(float relative, float absoluteMin) {
+    _relTol = relative;
+    _absTol = absoluteMin;
+}
+
+void StabilityDetector::addSample(float tSeconds, float value) {
+    if (isnan(value) || isnan(tSeconds)) {
+        return;
+    }
+
+    // Transient: restart the window so the old level doesn't dilute the new one
+    if (_count >= 3 && isStep(tSeconds, value)) {
+        uint8_t resets = _resets;
+        reset();
+        _resets = resets + 1;
+    }
+
+    if (_count == MAX_SAMPLES) {
+        popOldest();
+    }
+    push(tSeconds, value);
+}
+
+bool StabilityDetector::isStable() const {
+    if (_count < _minSamples) {
+        return false;
+    }
+
+    float tol = getTolerance();
+
+    // Quiet about a straight line and not expected to move more than tol
+    // over the horizon
+    if (getNoise() <= tol && getDrift() <= tol) {
+        return true;
+    }
+
+    // Still converging, but the remaining settling is inside tolerance.
+    // The curve doesn't fit a line, so judge noise from successive differences.
+    float predicted;
+    float lastSegmentMean;
+    if (getShortTermNoise() <= tol && fitExponential(predicted, lastSegmentMean)) {
+        return fabsf(predicted - lastSegmentMean) <= tol * 0.5f;
+    }
+
+    return false;
+}
+
+float StabilityDetector::getSlope() const {
+    if (_count < 2 || _m2T <= 0.0) {
+        return 0.0f;
+    }
+    return (float)(_cTY / _m2T);
+}
+
+float StabilityDetector::getNoise() const {
+    if (_count < 3) {
+        return 0.0f;
+    }
+    double explained = (_m2T > 0.0) ? (_cTY * _cTY / _m2T) : 0.0;
+    double residual = _m2Y - explained;
+    if (residual < 0.0) residual = 0.0;
+    return (float)sqrt(residual / (_count - 2));
+}
+
+float StabilityDetector::getShortTermNoise() const {
+    if (_count < 2) {
+        return 0.0f;
+    }
+    // Var(y[i+1] - y[i]) = 2 sigma^2 for white noise; a smooth trend adds
+    // only its (small) per-sample step
+    return (float)sqrt(_sumSqDiff / (2.0 * (_count - 1)));
+}
+
+float StabilityDetector::getTolerance() const {
+    float tol = fabsf((float)_meanY) * _relTol;
+    return (tol > _absTol) ? tol : _absTol;
+}
+
+float StabilityDetector::getDrift() const {
+    if (_count < 3 || _m2T <= 0.0) {
+        return INFINITY;
+    }
+    // Two standard errors on the slope: a short window can't claim "flat"
+    // with more confidence than the sensor's noise allows
+    float slopeErr = effectiveNoise() / (float)sqrt(_m2T);
+    return (fabsf(getSlope()) + 2.0f * slopeErr) * _horizon;
+}
+
+float StabilityDetector::getPredictedValue() const {
+    float predicted;
+    float lastSegmentMean;
+    return fitExponential(predicted, lastSegmentMean) ? predicted : NAN;
+}
+
+// ============================================================================
+// Private
+// ============================================================================
+
+void StabilityDetector::push(float t, float y) {
+    if (_count > 0) {
+        float diff = y - _ring[(_head + _count - 1) % MAX_SAMPLES].y;
+        _sumSqDiff += (double)diff * diff;
+    }
+    _ring[(_head + _count) % MAX_SAMPLES] = {t, y};
+    _count++;
+
+    double n = _count;
+    double dt = t - _meanT;
+    double dy = y - _meanY;
+    _meanT += dt / n;
+    _meanY += dy / n;
+    _m2T += dt * (t - _meanT);
+    _m2Y += dy * (y - _meanY);
+    _cTY += dt * (y - _meanY);
+}
+
+void StabilityDetector::popOldest() {
+    if (_count == 0) {
+        return;
+    }
+    const Sample old = _ring[_head];
+    _head = (_head + 1) % MAX_SAMPLES;
+    _count--;
+
+    if (_count == 0) {
+        _meanT = _meanY = _m2T = _m2Y = _cTY = _sumSqDiff = 0.0;
+        return;
+    }
+
+    float diff = _ring[_head].y - old.y;
+    _sumSqDiff -= (double)diff * diff;
+    if (_sumSqDiff < 0.0) _sumSqDiff = 0.0;
+
+    // Welford update run backwards
+    double n = _count;
+    double dt = old.t - _meanT;
+    double dy = old.y - _meanY;
+    _meanT -= dt / n;
+    _meanY -= dy / n;
+    _m2T -= dt * (old.t - _meanT);
+    _m2Y -= dy * (old.y - _meanY);
+    _cTY -= dt * (old.y - _meanY);
+    if (_m2T < 0.0) _m2T = 0.0;
+    if (_m2Y < 0.0) _m2Y = 0.0;
+}
+
+bool StabilityDetector::isStep(float t, float y) const {
+    float predicted = (float)(_meanY + getSlope() * (t - _meanT));
+    // Never call a change inside half the tolerance a step — quantised
+    // readings can show zero noise over a short window
+    float scale = effectiveNoise();
+    float halfTol = getTolerance() * 0.5f;
+    if (scale < halfTol) scale = halfTol;
+    return fabsf(y - predicted) > STEP_SIGMAS * scale;
+}
+
+float StabilityDetector::effectiveNoise() const {
+    float noise = getNoise();
+    return (noise > _noiseFloor) ? noise : _noiseFloor;
+}
+
+bool StabilityDetector::fitExponential(float& predicted, float& lastSegmentMean) const {
+    uint8_t seg = _count / 3;
+    if (seg < 3) {
+        return false;
+    }
+
+    // Means of the three most recent equal segments, oldest first
+    float s[3] = {0.0f, 0.0f, 0.0f};
+    uint8_t start = _count - seg * 3;
+    for (uint8_t k = 0; k < 3; k++) {
+        float sum = 0.0f;
+        for (uint8_t i = 0; i < seg; i++) {
+            sum += _ring[(_head + start + k * seg + i) % MAX_SAMPLES].y;
+        }
+        s[k] = sum / seg;
+    }
+
+    // y = y_inf + A*exp(-t/tau) sampled at equal spacing gives geometric
+    // differences d2 = r*d1; the remaining change after s3 is d2*r/(1-r)
+    float d1 = s[1] - s[0];
+    float d2 = s[2] - s[1];
+    float significant = 2.0f * getShortTermNoise() / sqrtf((float)seg);
+    if (fabsf(d1) <= significant || d1 * d2 <= 0.0f) {
+        return false;
+    }
+    float r = d2 / d1;
+    if (r >= MAX_DECAY_RATIO) {
+        return false;
+    }
+
+    predicted = s[2] + d2 * r / (1.0f - r);
+    lastSegmentMean = s[2];
+    return true;
+}
@@ -0,0 +1,109 @@
+/**
+ * SeaSense Logger - Streaming Stability Detector for Calibration
+ *
+ * Decides when a probe reading has settled, incrementally per sample:
+ * - Welford mean/variance and a least-squares slope over a sliding window
+ *   (O(1) per sample, samples added and removed without re-summing)
+ * - Adaptive window: grows while the signal is steady, restarts on a step
+ *   (probe moved, bubble, stirring) so old samples never mask a transient
+ * - Exponential-fit extrapolation of the settling value from three window
+ *   segments, so a slowly converging probe can pass once the remaining
+ *   settling is inside tolerance
+ *
+ * A per-sensor noise floor (learned from earlier calibrations) keeps the
+ * detector from trusting an optimistic noise estimate from a short window.
+ * Pure math, no hardware dependencies — fully testable on native.
+ */
+
+#ifndef STABILITY_DETECTOR_H
+#define STABILITY_DETECTOR_H
+
+#include <stdint.h>
+
+class StabilityDetector {
+public:
+    static const uint8_t MAX_SAMPLES = 32;
+
+    StabilityDetector();
+
+    /**
+     * Clear the window (keeps tolerance and noise floor)
+     */
+    void reset();
+
+    /**
+     * Set the stability tolerance: max(|mean| * relative, absoluteMin)
+     */
+    void setTolerance(float relative, float absoluteMin);
+
+    /**
+     * Known measurement noise (standard deviation) for this sensor, 0 if unknown
+     */
+    void setNoiseFloor(float sigma) { _noiseFloor = (sigma > 0.0f) ? sigma : 0.0f; }
+
+    /**
+     * Minimum samples before stability can be declared
+     */
+    void setMinSamples(uint8_t n) { _minSamples = (n < 3) ? 3 : (n > MAX_SAMPLES ? MAX_SAMPLES : n); }
+
+    /**
+     * Drift horizon: the reading must not be expected to move more than the
+     * tolerance over this many seconds
+     */
+    void setDriftHorizon(float seconds) { _horizon = seconds; }
+
+    /**
+     * Add a reading
+     * @param tSeconds Sample time in seconds (monotonic)
+     * @param value Sensor reading
+     */
+    void addSample(float tSeconds, float value);
+
+    /**
+     * True when the window is long enough, quiet enough, and not drifting
+     */
+    bool isStable() const;
+
+    uint8_t getSampleCount() const { return _count; }
+    float getMean() const { return (float)_meanY; }
+    float getSlope() const;             // units per second
+    float getNoise() const;             // residual std dev about the fitted line
+    float getShortTermNoise() const;    // from successive differences, trend-insensitive
+    float getTolerance() const;
+    float getDrift() const;             // |slope| * horizon, with slope uncertainty
+    float getPredictedValue() const;    // extrapolated settling value, NAN if no fit
+    uint8_t getResetCount() const { return _resets; }
+
+private:
+    struct Sample {
+        float t;
+        float y;
+    };
+
+    Sample _ring[MAX_SAMPLES];
+    uint8_t _head;      // index of the oldest sample
+    uint8_t _count;
+    uint8_t _resets;
+
+    // Bivariate Welford state over the window
+    double _meanT;
+    double _meanY;
+    double _m2T;
+    double _m2Y;
+    double _cTY;
+    double _sumSqDiff;  // sum of squared successive differences in the window
+
+    float _relTol;
+    float _absTol;
+    float _noiseFloor;
+    float _horizon;
+    uint8_t _minSamples;
+
+    void push(float t, float y);
+    void popOldest();
+    bool isStep(float t, float y) const;
+    bool fitExponential(float& predicted, float& lastSegmentMean) const;
+    float effectiveNoise() const;
+};
+
+#endif // STABILITY_DETECTOR_H
@@ -5,6 +5,8 @@
 #include "SerialCommands.h"
 #include "../webui/WebServer.h"
 #include "../system/SystemHealth.h"
+#include "../replay/CaptureRecorder.h"
+#include "../system/EventLog.h"
 #include <Wire.h>
 
 // ============================================================================
@@ -78,6 +80,10 @@ void SerialCommands::processCommand(const String& command) {
             args = command.substring(4);  // Use original command (not uppercase)
         }
         cmdPump(args);
+    } else if (cmd.startsWith("CAPTURE")) {
+        cmdCapture(cmd.substring(7));
+    } else if (cmd.startsWith("LOG")) {
+        cmdLog(cmd.substring(3));
     } else if (cmd == "HELP" || cmd == "?") {
         cmdHelp();
     } else if (cmd.length() > 0) {
@@ -101,8 +107,10 @@ void SerialCommands::cmdDump() {
     Serial.println(stats.totalRecords);
     Serial.println();
 
-    // Read all records
-    std::vector<DataRecord> records = _storage->readRecords(0, 10000);
+    // Read all records (only the columns printed below)
+    RecordQuery query;
+    query.fields = RecordField::BASE;
+    std::vector<DataRecord> records = _storage->queryRecords(query, 10000);
 
     if (records.empty()) {
         Serial.println("No data available");
@@ -549,6 +557,59 @@ void SerialCommands::cmdPump(const String& args) {
     }
 }
 
+void SerialCommands::cmdCapture(const String& args) {
+    extern CaptureRecorder captureRecorder;
+
+    String cmd = args;
+    cmd.trim();
+
+    if (cmd == "START") {
+        if (!_storage || !_storage->isSDMounted()) {
+            Serial.println("ERROR: SD card not mounted");
+            return;
+        }
+        if (!captureRecorder.start(millis())) {
+            Serial.print("ERROR: ");
+            Serial.println(captureRecorder.getLastError());
+        }
+
+    } else if (cmd == "STOP") {
+        if (!captureRecorder.isActive()) {
+            Serial.println("No capture running");
+            return;
+        }
+        captureRecorder.stop();
+
+    } else if (cmd == "" || cmd == "STATUS") {
+        printHeader("INPUT CAPTURE");
+        Serial.print("State: ");
+        Serial.println(captureRecorder.isActive() ? "RECORDING" : "IDLE");
+        if (captureRecorder.getFileName().length() > 0) {
+            Serial.print("File: ");
+            Serial.println(captureRecorder.getFileName());
+            Serial.print("Records: ");
+            Serial.println(captureRecorder.getRecordCount());
+            Serial.print("Bytes written: ");
+            Serial.println(captureRecorder.getBytesWritten());
+            Serial.print("Dropped: ");
+            Serial.println(captureRecorder.getDroppedCount());
+        }
+        if (captureRecorder.getLastError().length() > 0) {
+            Serial.print("Last error: ");
+            Serial.println(captureRecorder.getLastError());
+        }
+
+    } else {
+        Serial.print("Unknown CAPTURE subcommand: ");
+        Serial.println(cmd);
+        Serial.println();
+        Serial.println("Available CAPTURE subcommands:");
+        Serial.println("  CAPTURE [STATUS] - Show capture status");
+        Serial.println("  CAPTURE START    - Record GPS/CAN/IMU input to SD");
+        Serial.println("  CAPTURE STOP     - Stop recording");
+    }
+}
+
 void SerialCommands::cmdHelp() {
     printHeader("AVAILABLE COMMANDS");
 
@@ -558,11 +619,52 @@ void SerialCommands::cmdHelp() {
     Serial.println("TEST         - Read sensors without logging");
     Serial.println("SCAN         - Scan I2C bus for connected devices");
     Serial.println("PUMP [cmd]   - Pump control (STATUS, START, STOP, PAUSE, RESUME, etc.)");
+    Serial.println("CAPTURE [cmd]- Record raw GPS/CAN/IMU input to SD (START, STOP, STATUS)");
+    Serial.println("LOG [level]  - Event log verbosity (ERROR, WARN, INFO, DEBUG; SD <level>)");
     Serial.println("HELP         - Show this help message");
     Serial.println();
     Serial.println("Type any command and press Enter");
 }
 
+void SerialCommands::cmdLog(const String& args) {
+    String cmd = args;
+    cmd.trim();
+
+    LogLevel level;
+    if (cmd == "" || cmd == "STATUS") {
+        printHeader("EVENT LOG");
+        Serial.print("Level: ");
+        Serial.println(EventLog::levelName(eventLog.getLevel()));
+        Serial.print("SD level: ");
+        Serial.println(EventLog::levelName(eventLog.getSdLevel()));
+        Serial.print("Captured: ");
+        Serial.println(eventLog.getCapturedCount());
+        Serial.print("Lost: ");
+        Serial.println(eventLog.getLostCount());
+        Serial.print("Pending: ");
+        Serial.println(eventLog.getPendingCount());
+
+    } else if (cmd.startsWith("SD ") && EventLog::parseLevel(cmd.substring(3), level)) {
+        eventLog.setSdLevel(level);
+        Serial.print("SD log level: ");
+        Serial.println(EventLog::levelName(level));
+
+    } else if (EventLog::parseLevel(cmd, level)) {
+        eventLog.setLevel(level);
+        Serial.print("Log level: ");
+        Serial.println(EventLog::levelName(level));
+
+    } else {
+        Serial.print("Unknown LOG subcommand: ");
+        Serial.println(cmd);
+        Serial.println();
+        Serial.println("Available LOG subcommands:");
+        Serial.println("  LOG [STATUS]   - Show levels and counters");
+        Serial.println("  LOG <level>    - ERROR, WARN, INFO or DEBUG (until reboot)");
+        Serial.println("  LOG SD <level> - Least severe level also written to SD");
+    }
+}
+
 void SerialCommands::printHeader(const String& title) {
     printSeparator();
     Serial.println(title);
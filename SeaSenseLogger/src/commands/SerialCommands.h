@@ -99,6 +99,16 @@ private:
      */
     void cmdPump(const String& args);
 
+    /**
+     * CAPTURE - Record raw input streams for host replay
+     */
+    void cmdCapture(const String& args);
+
+    /**
+     * LOG - Event log verbosity (serial and SD)
+     */
+    void cmdLog(const String& args);
+
     /**
      * Print formatted output
      */
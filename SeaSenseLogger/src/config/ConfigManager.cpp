@@ -18,8 +18,12 @@ const char* ConfigManager::CONFIG_FILE = "/settings.json";
 // Constructor
 // ============================================================================
 
-ConfigManager::ConfigManager() {
-    // Constructor empty - initialization happens in begin()
+ConfigManager::ConfigManager()
+    : _version(0),
+      _updateDepth(0),
+      _updatePending(false)
+{
+    // Config values are initialized in begin()
 }
 
 // ============================================================================
@@ -42,6 +46,7 @@ bool ConfigManager::begin() {
         esp_task_wdt_add(NULL);     // re-subscribe
         if (!ok) {
             Serial.println("[CONFIG ERROR] Failed to mount SPIFFS after format");
+            publishSnapshot();  // run on defaults
             return false;
         }
         Serial.println("[CONFIG] SPIFFS formatted successfully");
@@ -53,9 +58,11 @@ bool ConfigManager::begin() {
         if (loadFromFile()) {
             Serial.println("[CONFIG] Configuration loaded successfully");
             if (ensureDeviceGUID()) saveToFile();  // persist if GUID was just generated
+            publishSnapshot();
             return true;
         } else {
             Serial.println("[CONFIG WARNING] Failed to load config, using defaults");
+            publishSnapshot();
             return false;
         }
     } else {
@@ -63,6 +70,7 @@ bool ConfigManager::begin() {
         Serial.println("[CONFIG] Creating default configuration file...");
         ensureDeviceGUID();  // generate GUID on first boot
         saveToFile();
+        publishSnapshot();
         return true;
     }
 }
@@ -74,15 +82,28 @@ bool ConfigManager::save() {
 bool ConfigManager::reset() {
     Serial.println("[CONFIG] Resetting to defaults...");
     setDefaults();
+    publishSnapshot();
     return saveToFile();
 }
 
+void ConfigManager::beginUpdate() {
+    _updateDepth++;
+}
+
+void ConfigManager::commitUpdate() {
+    if (_updateDepth > 0) _updateDepth--;
+    if (_updateDepth == 0 && _updatePending) {
+        publishSnapshot();
+    }
+}
+
 ConfigManager::WiFiConfig ConfigManager::getWiFiConfig() const {
     return _wifi;
 }
 
 void ConfigManager::setWiFiConfig(const WiFiConfig& config) {
     _wifi = config;
+    publishSnapshot();
 }
 
 ConfigManager::APIConfig ConfigManager::getAPIConfig() const {
@@ -92,6 +113,7 @@ ConfigManager::APIConfig ConfigManager::getAPIConfig() const {
 void ConfigManager::setAPIConfig(const APIConfig& config) {
     _api = config;
     clampConfig();
+    publishSnapshot();
 }
 
 ConfigManager::DeviceConfig ConfigManager::getDeviceConfig() const {
@@ -100,6 +122,7 @@ ConfigManager::DeviceConfig ConfigManager::getDeviceConfig() const {
 
 void ConfigManager::setDeviceConfig(const DeviceConfig& config) {
     _device = config;
+    publishSnapshot();
 }
 
 PumpConfig ConfigManager::getPumpConfig() const {
@@ -109,6 +132,7 @@ PumpConfig ConfigManager::getPumpConfig() const {
 void ConfigManager::setPumpConfig(const PumpConfig& config) {
     _pump = config;
     clampConfig();
+    publishSnapshot();
 }
 
 ConfigManager::SamplingConfig ConfigManager::getSamplingConfig() const {
@@ -118,6 +142,7 @@ ConfigManager::SamplingConfig ConfigManager::getSamplingConfig() const {
 void ConfigManager::setSamplingConfig(const SamplingConfig& config) {
     _sampling = config;
     clampConfig();
+    publishSnapshot();
 }
 
 ConfigManager::GPSConfig ConfigManager::getGPSConfig() const {
@@ -126,6 +151,7 @@ ConfigManager::GPSConfig ConfigManager::getGPSConfig() const {
 
 void ConfigManager::setGPSConfig(const GPSConfig& config) {
     _gps = config;
+    publishSnapshot();
 }
 
 ConfigManager::NMEAConfig ConfigManager::getNMEAConfig() const {
@@ -134,6 +160,7 @@ ConfigManager::NMEAConfig ConfigManager::getNMEAConfig() const {
 
 void ConfigManager::setNMEAConfig(const NMEAConfig& config) {
     _nmea = config;
+    publishSnapshot();
 }
 
 ConfigManager::DeploymentConfig ConfigManager::getDeploymentConfig() const {
@@ -142,6 +169,7 @@ ConfigManager::DeploymentConfig ConfigManager::getDeploymentConfig() const {
 
 void ConfigManager::setDeploymentConfig(const DeploymentConfig& config) {
     _deployment = config;
+    publishSnapshot();
 }
 
 bool ConfigManager::stampDeployDate(const String& utcTimestamp) {
@@ -151,6 +179,7 @@ bool ConfigManager::stampDeployDate(const String& utcTimestamp) {
     _deployment.deployDate = utcTimestamp;
     Serial.print("[CONFIG] Deploy date stamped: ");
     Serial.println(utcTimestamp);
+    publishSnapshot();
     saveToFile();
     return true;
 }
@@ -159,6 +188,26 @@ bool ConfigManager::stampDeployDate(const String& utcTimestamp) {
 // Private Methods
 // ============================================================================
 
+void ConfigManager::publishSnapshot() {
+    if (_updateDepth > 0) {
+        _updatePending = true;
+        return;
+    }
+    _updatePending = false;
+
+    Snapshot next;
+    next.version = ++_version;
+    next.wifi = _wifi;
+    next.api = _api;
+    next.device = _device;
+    next.pump = _pump;
+    next.sampling = _sampling;
+    next.gps = _gps;
+    next.nmea = _nmea;
+    next.deployment = _deployment;
+    _snapshots.publish(next);
+}
+
 bool ConfigManager::loadFromFile() {
     File file = SPIFFS.open(CONFIG_FILE, "r");
     if (!file) {
@@ -438,6 +487,7 @@ bool ConfigManager::ensureDeviceGUID() {
 
 String ConfigManager::regenerateDeviceGUID() {
     _device.deviceGUID = generateDeviceGUID();
+    publishSnapshot();
     saveToFile();
     Serial.print("[CONFIG] Regenerated device GUID: ");
     Serial.println(_device.deviceGUID);
@@ -10,6 +10,7 @@
 
 #include <Arduino.h>
 #include "../pump/PumpController.h"
+#include "ConfigSnapshot.h"
 
 class ConfigManager {
 public:
@@ -75,6 +76,27 @@ public:
         float depthCm;          // Sensor depth below waterline in cm
     };
 
+    /**
+     * Immutable, versioned copy of the whole configuration.
+     * Published atomically after every change; see snapshot().
+     */
+    struct Snapshot {
+        uint32_t version;       // 0 until begin(), +1 per publish
+        WiFiConfig wifi;
+        APIConfig api;
+        DeviceConfig device;
+        PumpConfig pump;
+        SamplingConfig sampling;
+        GPSConfig gps;
+        NMEAConfig nmea;
+        DeploymentConfig deployment;
+
+        Snapshot() : version(0) {}
+    };
+
+    typedef ConfigSnapshotStore<Snapshot>::Ptr SnapshotPtr;
+    typedef ConfigSnapshotStore<Snapshot>::Listener SnapshotListener;
+
     /**
      * Constructor
      */
@@ -98,6 +120,42 @@ public:
      */
     bool reset();
 
+    /**
+     * Get the current configuration snapshot
+     * Atomic pointer load (briefly locked inside libstdc++); the settings
+     * themselves are shared, not copied. Safe from any core or task. Hold
+     * the pointer for as long as one consistent view is needed.
+     * @return Shared pointer to an immutable Snapshot (never null)
+     */
+    SnapshotPtr snapshot() const { return _snapshots.load(); }
+
+    /**
+     * Get the version of the current snapshot
+     * @return Monotonic version counter (0 before begin())
+     */
+    uint32_t getVersion() const { return _snapshots.load()->version; }
+
+    /**
+     * Subscribe to configuration changes
+     * Listener runs in the writer's context (usually the web server task)
+     * with the new and previous snapshots. Register during setup only.
+     * @param listener Callback(current, previous)
+     * @return false if the listener table is full
+     */
+    bool subscribe(const SnapshotListener& listener) { return _snapshots.subscribe(listener); }
+
+    /**
+     * Group several setters into one published snapshot
+     * Setters called between beginUpdate() and commitUpdate() are
+     * published (and notified) once, on commitUpdate().
+     */
+    void beginUpdate();
+
+    /**
+     * Publish changes accumulated since beginUpdate()
+     */
+    void commitUpdate();
+
     /**
      * Get WiFi configuration
      * @return WiFiConfig struct
@@ -220,6 +278,18 @@ private:
     NMEAConfig _nmea;
     DeploymentConfig _deployment;
 
+    // Published snapshots (the members above are the writer's working copy)
+    ConfigSnapshotStore<Snapshot> _snapshots;
+    uint32_t _version;
+    uint8_t _updateDepth;
+    bool _updatePending;
+
+    /**
+     * Publish the working copy as a new snapshot, or defer it if an
+     * update batch is open
+     */
+    void publishSnapshot();
+
     /**
      * Load configuration from SPIFFS file
      * @return true if successful
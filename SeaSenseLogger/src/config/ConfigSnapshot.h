@@ -0,0 +1,80 @@
+/**
+ * SeaSense Logger - Versioned Configuration Snapshots
+ *
+ * RCU-style holder for immutable configuration snapshots:
+ * - Writers build a complete new snapshot and publish it with one atomic swap
+ * - Readers take a reference-counted pointer to the one shared immutable
+ *   copy instead of copying the settings. The pointer load/swap is atomic
+ *   but not lock-free: libstdc++ guards shared_ptr atomics with a small
+ *   internal mutex pool, held only for the pointer copy
+ * - Old snapshots are freed when the last reader drops its pointer
+ * - Subscribers are notified (in the writer's context) after each publish
+ *
+ * Readers on either core can hold a snapshot across a whole operation
+ * (e.g. building an upload payload) and see one consistent version even
+ * if the web UI saves new settings in the meantime.
+ */
+
+#ifndef CONFIG_SNAPSHOT_H
+#define CONFIG_SNAPSHOT_H
+
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <stdint.h>
+
+template <typename T>
+class ConfigSnapshotStore {
+public:
+    typedef std::shared_ptr<const T> Ptr;
+    typedef std::function<void(const T& current, const T& previous)> Listener;
+
+    static const uint8_t MAX_LISTENERS = 8;
+
+    ConfigSnapshotStore()
+        : _current(std::make_shared<const T>()),
+          _listenerCount(0)
+    {
+    }
+
+    /**
+     * Get the current snapshot (atomic pointer load, never null)
+     * @return Shared pointer to an immutable snapshot
+     */
+    Ptr load() const {
+        return std::atomic_load_explicit(&_current, std::memory_order_acquire);
+    }
+
+    /**
+     * Publish a new snapshot and notify subscribers
+     * The caller stamps the version; see ConfigManager::publishSnapshot()
+     * @param next Fully built snapshot
+     */
+    void publish(const T& next) {
+        Ptr fresh = std::make_shared<const T>(next);
+        Ptr previous = std::atomic_exchange_explicit(&_current, fresh, std::memory_order_acq_rel);
+        for (uint8_t i = 0; i < _listenerCount; i++) {
+            _listeners[i](*fresh, *previous);
+        }
+    }
+
+    /**
+     * Register a change listener
+     * Call during setup only; the listener table is not guarded.
+     * @return false if the listener table is full
+     */
+    bool subscribe(const Listener& listener) {
+        if (_listenerCount >= MAX_LISTENERS) return false;
+        _listeners[_listenerCount++] = listener;
+        return true;
+    }
+
+    uint8_t getListenerCount() const { return _listenerCount; }
+
+private:
+    Ptr _current;
+    Listener _listeners[MAX_LISTENERS];
+    uint8_t _listenerCount;
+};
+
+#endif // CONFIG_SNAPSHOT_H
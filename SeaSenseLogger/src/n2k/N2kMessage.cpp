@@ -0,0 +1,141 @@
+/**
+ * SeaSense Logger - NMEA2000 Outbound Messages Implementation
+ */
+
+#include "N2kMessage.h"
+#include <math.h>
+#include <string.h>
+
+// NMEA2000 database version reported in 126996 (2.100)
+#define N2K_DATABASE_VERSION 2100
+
+void N2kMessage::clear(uint32_t pgnNumber, uint8_t prio, bool fast) {
+    pgn = pgnNumber;
+    priority = prio & 0x07;
+    destination = N2K_BROADCAST;
+    fastPacket = fast;
+    length = 0;
+}
+
+bool N2kMessage::add1(uint8_t v) {
+    if (length >= N2K_MAX_PAYLOAD) return false;
+    data[length++] = v;
+    return true;
+}
+
+bool N2kMessage::add2(uint16_t v) {
+    return add1(v & 0xFF) && add1(v >> 8);
+}
+
+bool N2kMessage::add3(uint32_t v) {
+    return add1(v & 0xFF) && add1((v >> 8) & 0xFF) && add1((v >> 16) & 0xFF);
+}
+
+bool N2kMessage::add4(uint32_t v) {
+    return add2(v & 0xFFFF) && add2(v >> 16);
+}
+
+bool N2kMessage::addFloat(float v) {
+    uint32_t bits;
+    memcpy(&bits, &v, sizeof(bits));
+    return add4(bits);
+}
+
+bool N2kMessage::addFixedString(const char* s, uint8_t width) {
+    size_t n = s ? strlen(s) : 0;
+    for (uint8_t i = 0; i < width; i++) {
+        if (!add1(i < n ? (uint8_t)s[i] : 0xFF)) return false;
+    }
+    return true;
+}
+
+bool N2kMessage::addStringLAU(const char* s) {
+    size_t n = s ? strlen(s) : 0;
+    if (n > 253) n = 253;
+    if (!add1((uint8_t)(n + 2)) || !add1(0x01)) return false;   // length incl. header, ASCII
+    for (size_t i = 0; i < n; i++) {
+        if (!add1((uint8_t)s[i])) return false;
+    }
+    return true;
+}
+
+// ============================================================================
+// Field scaling (NAN / out of range -> not available)
+// ============================================================================
+
+static uint32_t scaleUnsigned(double value, double resolution, uint32_t notAvailable) {
+    if (isnan(value)) return notAvailable;
+    double raw = round(value / resolution);
+    if (raw < 0 || raw >= (double)notAvailable - 2) return notAvailable;
+    return (uint32_t)raw;
+}
+
+static uint32_t scaleSigned32(double value, double resolution) {
+    if (isnan(value)) return 0x7FFFFFFF;
+    double raw = round(value / resolution);
+    if (raw < -2147483647.0 || raw > 2147483645.0) return 0x7FFFFFFF;
+    return (uint32_t)(int32_t)raw;
+}
+
+static double toKelvin(float tempC) {
+    return isnan(tempC) ? NAN : (double)tempC + 273.15;
+}
+
+// ============================================================================
+// Encoders
+// ============================================================================
+
+void buildPGN130312(N2kMessage& msg, uint8_t sid, uint8_t instance, uint8_t source, float tempC) {
+    msg.clear(130312, 5, false);
+    msg.add1(sid);
+    msg.add1(instance);
+    msg.add1(source);
+    msg.add2(scaleUnsigned(toKelvin(tempC), 0.01, 0xFFFF));
+    msg.add2(0xFFFF);                   // set temperature
+    msg.add1(0xFF);                     // reserved
+}
+
+void buildPGN130316(N2kMessage& msg, uint8_t sid, uint8_t instance, uint8_t source, float tempC) {
+    msg.clear(130316, 5, false);
+    msg.add1(sid);
+    msg.add1(instance);
+    msg.add1(source);
+    msg.add3(scaleUnsigned(toKelvin(tempC), 0.001, 0xFFFFFF));
+    msg.add2(0xFFFF);                   // set temperature
+}
+
+void buildPGN130321(N2kMessage& msg, time_t epoch, double lat, double lon,
+                    float salinity, float tempC, const char* stationId, const char* stationName) {
+    msg.clear(130321, 6, true);
+    msg.add1(0xF0);                     // mode 0 (autonomous), reserved
+    if (epoch > 0) {
+        msg.add2((uint16_t)(epoch / 86400));
+        msg.add4((uint32_t)(epoch % 86400) * 10000);
+    } else {
+        msg.add2(0xFFFF);
+        msg.add4(0xFFFFFFFF);
+    }
+    msg.add4(scaleSigned32(lat, 1e-7));
+    msg.add4(scaleSigned32(lon, 1e-7));
+    if (isnan(salinity)) {
+        msg.add4(0xFFFFFFFF);
+    } else {
+        msg.addFloat(salinity);
+    }
+    msg.add2(scaleUnsigned(toKelvin(tempC), 0.01, 0xFFFF));
+    msg.addStringLAU(stationId);
+    msg.addStringLAU(stationName);
+}
+
+void buildPGN126996(N2kMessage& msg, uint16_t productCode, const char* modelId,
+                    const char* softwareVersion, const char* modelVersion, const char* serialCode) {
+    msg.clear(126996, 6, true);
+    msg.add2(N2K_DATABASE_VERSION);
+    msg.add2(productCode);
+    msg.addFixedString(modelId, 32);
+    msg.addFixedString(softwareVersion, 32);
+    msg.addFixedString(modelVersion, 32);
+    msg.addFixedString(serialCode, 32);
+    msg.add1(1);                        // certification level
+    msg.add1(1);                        // load equivalency (50 mA)
+}
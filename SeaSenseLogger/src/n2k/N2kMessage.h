@@ -0,0 +1,76 @@
+/**
+ * SeaSense Logger - NMEA2000 Outbound Messages
+ *
+ * A PGN payload ready for the transmit scheduler, plus encoders for the
+ * PGNs the logger publishes. Kept free of the NMEA2000 library so the whole
+ * transmit path builds and runs on the host.
+ *
+ * PGNs (field layouts per the public canboat database):
+ * - 130312 Temperature (single frame, still what most displays read)
+ * - 130316 Temperature, Extended Range (single frame, 0.001 K)
+ * - 130321 Salinity Station Data (fast-packet)
+ * - 126996 Product Information (fast-packet)
+ *
+ * Multi-byte fields are little-endian; "not available" is all ones
+ * (0x7F.. for signed fields).
+ */
+
+#ifndef SEASENSE_N2K_MESSAGE_H
+#define SEASENSE_N2K_MESSAGE_H
+
+#include <Arduino.h>
+
+#define N2K_MAX_PAYLOAD 223             // fast-packet limit: 6 + 31 * 7
+#define N2K_BROADCAST 255
+
+// Temperature source (130312/130316 field 3)
+#define N2K_TEMP_SOURCE_SEA 0
+
+struct N2kMessage {
+    uint32_t pgn;
+    uint8_t priority;                   // 0 (highest) .. 7
+    uint8_t destination;                // N2K_BROADCAST for PDU2 PGNs
+    bool fastPacket;
+    uint8_t length;
+    uint8_t data[N2K_MAX_PAYLOAD];
+
+    void clear(uint32_t pgnNumber, uint8_t prio, bool fast);
+
+    // Appenders; return false once the payload is full
+    bool add1(uint8_t v);
+    bool add2(uint16_t v);
+    bool add3(uint32_t v);
+    bool add4(uint32_t v);
+    bool addFloat(float v);
+    bool addFixedString(const char* s, uint8_t width);   // padded with 0xFF
+    bool addStringLAU(const char* s);                    // length + ASCII control byte
+};
+
+/**
+ * PGN 130312 Temperature
+ * @param tempC Water temperature, NAN if not available
+ */
+void buildPGN130312(N2kMessage& msg, uint8_t sid, uint8_t instance, uint8_t source, float tempC);
+
+/**
+ * PGN 130316 Temperature, Extended Range
+ */
+void buildPGN130316(N2kMessage& msg, uint8_t sid, uint8_t instance, uint8_t source, float tempC);
+
+/**
+ * PGN 130321 Salinity Station Data
+ * @param epoch Measurement time (UTC), 0 if unknown
+ * @param lat, lon Station position in degrees, NAN if unknown
+ * @param salinity Practical salinity (reported in ppt), NAN if unknown
+ * @param tempC Water temperature, NAN if unknown
+ */
+void buildPGN130321(N2kMessage& msg, time_t epoch, double lat, double lon,
+                    float salinity, float tempC, const char* stationId, const char* stationName);
+
+/**
+ * PGN 126996 Product Information
+ */
+void buildPGN126996(N2kMessage& msg, uint16_t productCode, const char* modelId,
+                    const char* softwareVersion, const char* modelVersion, const char* serialCode);
+
+#endif // SEASENSE_N2K_MESSAGE_H
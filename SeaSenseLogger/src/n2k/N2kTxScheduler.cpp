@@ -0,0 +1,202 @@
+/**
+ * SeaSense Logger - NMEA2000 Transmit Scheduler Implementation
+ */
+
+#include "N2kTxScheduler.h"
+#include <string.h>
+
+N2kTxScheduler::N2kTxScheduler(N2kCanBus* bus)
+    : _bus(bus),
+      _count(0),
+      _nextOrder(0),
+      _active(-1),
+      _nextFrame(0),
+      _activeSeq(0),
+      _refusals(0),
+      _tokens(N2K_TX_BURST_FRAMES),
+      _lastRefill(0),
+      _bucketStarted(false)
+{
+    memset(_seq, 0, sizeof(_seq));
+    memset(&_stats, 0, sizeof(_stats));
+}
+
+bool N2kTxScheduler::enqueue(const N2kMessage& msg) {
+    if (!_bus || !_bus->isTransmitReady()) {
+        _stats.droppedNotReady++;
+        return false;
+    }
+
+    // Fresh data supersedes what is still waiting for the same PGN, unless
+    // that message is already half on the wire
+    for (uint8_t i = 0; i < _count; i++) {
+        if (_queue[i].pgn == msg.pgn && _queue[i].destination == msg.destination && i != _active) {
+            _queue[i] = msg;
+            _stats.replaced++;
+            return true;
+        }
+    }
+
+    if (_count >= N2K_TX_QUEUE_LEN) {
+        _stats.droppedQueueFull++;
+        return false;
+    }
+    _queue[_count] = msg;
+    _order[_count] = _nextOrder++;
+    _count++;
+    _stats.enqueued++;
+    return true;
+}
+
+void N2kTxScheduler::process(unsigned long now) {
+    refill(now);
+    if (!_bus || _count == 0) {
+        return;
+    }
+    if (!_bus->isTransmitReady()) {
+        clear();        // address lost or bus closed: the data would be stale anyway
+        return;
+    }
+
+    uint8_t frame[8];
+    while (_tokens > 0 && _count > 0) {
+        if (_active < 0) {
+            _active = pickNext();
+            _nextFrame = 0;
+            _refusals = 0;
+            _activeSeq = _queue[_active].fastPacket ? nextSequence(_queue[_active].pgn) : 0;
+        }
+
+        const N2kMessage& msg = _queue[_active];
+        uint8_t len = buildFrame(msg, _nextFrame, _activeSeq, frame);
+        uint32_t id = canId(msg.priority, msg.pgn, _bus->getSourceAddress(), msg.destination);
+
+        if (!_bus->sendFrame(id, frame, len)) {
+            // Controller queue full (or bus-off): try again next pass
+            _stats.retries++;
+            if (++_refusals >= N2K_TX_MAX_RETRIES) {
+                _stats.droppedBusError++;
+                remove(_active);
+                _active = -1;
+            }
+            return;
+        }
+
+        _tokens--;
+        _stats.sentFrames++;
+        _refusals = 0;
+        if (++_nextFrame >= frameCount(msg)) {
+            _stats.sentMessages++;
+            remove(_active);
+            _active = -1;
+        }
+    }
+}
+
+void N2kTxScheduler::clear() {
+    _count = 0;
+    _active = -1;
+}
+
+uint32_t N2kTxScheduler::canId(uint8_t priority, uint32_t pgn, uint8_t source, uint8_t destination) {
+    uint8_t pf = (pgn >> 8) & 0xFF;
+    uint32_t id = ((uint32_t)(priority & 0x07) << 26) | ((pgn & 0x3FF00) << 8) | source;
+    if (pf < 240) {
+        id |= (uint32_t)destination << 8;       // PDU1: addressed
+    } else {
+        id |= (pgn & 0xFF) << 8;                // PDU2: group extension
+    }
+    return id;
+}
+
+// ============================================================================
+// Private
+// ============================================================================
+
+int8_t N2kTxScheduler::pickNext() const {
+    int8_t best = 0;
+    for (uint8_t i = 1; i < _count; i++) {
+        if (_queue[i].priority < _queue[best].priority ||
+            (_queue[i].priority == _queue[best].priority && _order[i] < _order[best])) {
+            best = i;
+        }
+    }
+    return best;
+}
+
+void N2kTxScheduler::remove(uint8_t index) {
+    for (uint8_t i = index; i + 1 < _count; i++) {
+        _queue[i] = _queue[i + 1];
+        _order[i] = _order[i + 1];
+    }
+    _count--;
+}
+
+uint8_t N2kTxScheduler::nextSequence(uint32_t pgn) {
+    for (uint8_t i = 0; i < 8; i++) {
+        if (_seq[i].pgn == pgn) {
+            _seq[i].seq = (_seq[i].seq + 1) & 0x07;
+            return _seq[i].seq;
+        }
+    }
+    // Take a free slot, or recycle the first one
+    for (uint8_t i = 0; i < 8; i++) {
+        if (_seq[i].pgn == 0) {
+            _seq[i].pgn = pgn;
+            _seq[i].seq = 0;
+            return 0;
+        }
+    }
+    _seq[0].pgn = pgn;
+    _seq[0].seq = 0;
+    return 0;
+}
+
+uint8_t N2kTxScheduler::frameCount(const N2kMessage& msg) const {
+    if (!msg.fastPacket) {
+        return 1;
+    }
+    // First frame carries 6 payload bytes, the rest 7 each
+    if (msg.length <= 6) {
+        return 1;
+    }
+    return 1 + (msg.length - 6 + 6) / 7;
+}
+
+uint8_t N2kTxScheduler::buildFrame(const N2kMessage& msg, uint8_t frame, uint8_t seq, uint8_t* out) const {
+    if (!msg.fastPacket) {
+        uint8_t len = msg.length < 8 ? msg.length : 8;
+        memcpy(out, msg.data, len);
+        return len;
+    }
+
+    memset(out, 0xFF, 8);
+    out[0] = (uint8_t)((seq << 5) | (frame & 0x1F));
+    if (frame == 0) {
+        out[1] = msg.length;
+        uint8_t n = msg.length < 6 ? msg.length : 6;
+        memcpy(out + 2, msg.data, n);
+    } else {
+        uint16_t offset = 6 + (uint16_t)(frame - 1) * 7;
+        uint8_t n = (msg.length - offset) < 7 ? (msg.length - offset) : 7;
+        memcpy(out + 1, msg.data + offset, n);
+    }
+    return 8;
+}
+
+void N2kTxScheduler::refill(unsigned long now) {
+    if (!_bucketStarted) {
+        _bucketStarted = true;
+        _lastRefill = now;
+        return;
+    }
+    unsigned long elapsed = now - _lastRefill;
+    uint32_t earned = (uint32_t)((uint64_t)elapsed * N2K_TX_FRAMES_PER_SEC / 1000);
+    if (earned == 0) {
+        return;
+    }
+    // Advance only by the time that was converted into tokens
+    _lastRefill += (unsigned long)((uint64_t)earned * 1000 / N2K_TX_FRAMES_PER_SEC);
+    uint32_t tokens = _tokens + earned;
+    _tokens = tokens > N2K_TX_BURST_FRAMES ? N2K_TX_BURST_FRAMES : tokens;
+}
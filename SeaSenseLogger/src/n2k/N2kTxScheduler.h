@@ -0,0 +1,119 @@
+/**
+ * SeaSense Logger - NMEA2000 Transmit Scheduler
+ *
+ * Decouples PGN output from sampling: callers enqueue() messages and return
+ * immediately; process() runs from loop() and feeds frames to the bus.
+ * - Priority-ordered queue (NMEA priority, FIFO within a priority); a newer
+ *   message for the same PGN replaces the queued one instead of piling up
+ * - Token-bucket rate limit (N2K_TX_FRAMES_PER_SEC, N2K_TX_BURST_FRAMES)
+ * - Fast-packet framing for payloads over 8 bytes, 3-bit sequence per PGN
+ * - Never waits for the bus: a refused frame is retried on the next pass,
+ *   and a message the bus keeps refusing is dropped and counted
+ *
+ * Frames go to an N2kCanBus; the device uses the TWAI driver, the native
+ * tests a virtual bus that records frames.
+ */
+
+#ifndef SEASENSE_N2K_TX_SCHEDULER_H
+#define SEASENSE_N2K_TX_SCHEDULER_H
+
+#include <Arduino.h>
+#include "N2kMessage.h"
+#include "../../config/hardware_config.h"
+
+/**
+ * Frame-level CAN output
+ */
+class N2kCanBus {
+public:
+    virtual ~N2kCanBus() {}
+
+    /**
+     * Queue one frame without blocking
+     * @return false if the controller can't take it right now
+     */
+    virtual bool sendFrame(uint32_t canId, const uint8_t* data, uint8_t len) = 0;
+
+    /**
+     * Our claimed source address
+     */
+    virtual uint8_t getSourceAddress() const = 0;
+
+    /**
+     * Bus open for transmit and address claimed
+     */
+    virtual bool isTransmitReady() const = 0;
+};
+
+class N2kTxScheduler {
+public:
+    struct Stats {
+        uint32_t enqueued;
+        uint32_t replaced;          // superseded by a newer message for the same PGN
+        uint32_t sentMessages;
+        uint32_t sentFrames;
+        uint32_t droppedQueueFull;
+        uint32_t droppedBusError;   // bus refused the frame N2K_TX_MAX_RETRIES times
+        uint32_t droppedNotReady;   // enqueued while the bus can't transmit
+        uint32_t retries;
+    };
+
+    explicit N2kTxScheduler(N2kCanBus* bus);
+
+    /**
+     * Queue a message for transmission; never blocks
+     * @return false if it was dropped
+     */
+    bool enqueue(const N2kMessage& msg);
+
+    /**
+     * Send due frames within the rate budget. Call every loop() pass.
+     */
+    void process(unsigned long now);
+
+    /**
+     * Discard everything queued (e.g. output disabled)
+     */
+    void clear();
+
+    uint8_t getQueueDepth() const { return _count; }
+    const Stats& getStats() const { return _stats; }
+
+    /**
+     * 29-bit CAN identifier for a PGN
+     */
+    static uint32_t canId(uint8_t priority, uint32_t pgn, uint8_t source, uint8_t destination);
+
+private:
+    N2kCanBus* _bus;
+    N2kMessage _queue[N2K_TX_QUEUE_LEN];
+    uint32_t _order[N2K_TX_QUEUE_LEN];  // enqueue order, FIFO within a priority
+    uint8_t _count;
+    uint32_t _nextOrder;
+
+    // Message being framed (fast-packet frames must stay in order)
+    int8_t _active;
+    uint8_t _nextFrame;
+    uint8_t _activeSeq;
+    uint8_t _refusals;
+
+    // Fast-packet sequence counters, one per recently sent PGN
+    struct SeqSlot { uint32_t pgn; uint8_t seq; };
+    SeqSlot _seq[8];
+
+    // Token bucket
+    uint16_t _tokens;
+    unsigned long _lastRefill;
+    bool _bucketStarted;
+
+    Stats _stats;
+
+    int8_t pickNext() const;
+    void remove(uint8_t index);
+    uint8_t nextSequence(uint32_t pgn);
+    uint8_t frameCount(const N2kMessage& msg) const;
+    uint8_t buildFrame(const N2kMessage& msg, uint8_t frame, uint8_t seq, uint8_t* out) const;
+    void refill(unsigned long now);
+};
+
+#endif // SEASENSE_N2K_TX_SCHEDULER_H
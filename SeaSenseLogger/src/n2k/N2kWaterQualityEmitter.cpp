@@ -0,0 +1,90 @@
+/**
+ * SeaSense Logger - NMEA2000 Water Quality Emitter Implementation
+ */
+
+#include "N2kWaterQualityEmitter.h"
+#include <math.h>
+
+N2kWaterQualityEmitter::N2kWaterQualityEmitter(N2kTxScheduler* scheduler)
+    : _scheduler(scheduler),
+      _lastProductTx(0),
+      _productSent(false),
+      _sid(0),
+      _published(0)
+{
+    reset();
+}
+
+void N2kWaterQualityEmitter::setReadings(float waterTempC, float salinity, double lat, double lon,
+                                         time_t epoch, unsigned long now) {
+    _tempC = waterTempC;
+    _salinity = salinity;
+    _lat = lat;
+    _lon = lon;
+    _epoch = epoch;
+    _readingAt = now;
+    _hasReading = !isnan(waterTempC) || !isnan(salinity);
+    _readingPending = _hasReading;
+    _sid = (_sid + 1) % 253;        // 253-255 are reserved
+}
+
+void N2kWaterQualityEmitter::update(unsigned long now) {
+    if (!_productSent || now - _lastProductTx >= NMEA2000_METADATA_INTERVAL_MS) {
+        N2kMessage msg;
+        buildPGN126996(msg, N2K_PRODUCT_CODE, N2K_MODEL_ID, N2K_SOFTWARE_VERSION,
+                       N2K_HARDWARE_VERSION, N2K_MODEL_SERIAL);
+        send(msg);
+        _lastProductTx = now;
+        _productSent = true;
+    }
+
+    if (!_hasReading) {
+        return;
+    }
+    if (now - _readingAt >= N2K_VALUE_MAX_AGE_MS) {
+        _hasReading = false;
+        return;
+    }
+
+    bool fresh = _readingPending;
+    _readingPending = false;
+
+    if (!isnan(_tempC) && (fresh || now - _lastWaterTx >= N2K_WATER_TX_INTERVAL_MS)) {
+        N2kMessage msg;
+        buildPGN130312(msg, _sid, N2K_TEMPERATURE_INSTANCE, N2K_TEMP_SOURCE_SEA, _tempC);
+        send(msg);
+        buildPGN130316(msg, _sid, N2K_TEMPERATURE_INSTANCE, N2K_TEMP_SOURCE_SEA, _tempC);
+        send(msg);
+        _lastWaterTx = now;
+    }
+
+    if (!isnan(_salinity) && (fresh || now - _lastSalinityTx >= N2K_SALINITY_TX_INTERVAL_MS)) {
+        N2kMessage msg;
+        buildPGN130321(msg, _epoch, _lat, _lon, _salinity, _tempC, N2K_MODEL_SERIAL, N2K_MODEL_ID);
+        send(msg);
+        _lastSalinityTx = now;
+    }
+}
+
+void N2kWaterQualityEmitter::reset() {
+    _tempC = NAN;
+    _salinity = NAN;
+    _lat = NAN;
+    _lon = NAN;
+    _epoch = 0;
+    _readingAt = 0;
+    _hasReading = false;
+    _readingPending = false;
+    _lastWaterTx = 0;
+    _lastSalinityTx = 0;
+}
+
+// ============================================================================
+// Private
+// ============================================================================
+
+void N2kWaterQualityEmitter::send(const N2kMessage& msg) {
+    if (_scheduler && _scheduler->enqueue(msg)) {
+        _published++;
+    }
+}
@@ -0,0 +1,67 @@
+/**
+ * SeaSense Logger - NMEA2000 Water Quality Emitter
+ *
+ * Decides what goes on the bus and when; the scheduler decides how.
+ * - Each measurement cycle hands over its readings with setReadings()
+ * - Water temperature (130312 + 130316) repeats every N2K_WATER_TX_INTERVAL_MS
+ *   and salinity (130321) every N2K_SALINITY_TX_INTERVAL_MS, so displays
+ *   don't time out between slow sampling cycles
+ * - A reading older than N2K_VALUE_MAX_AGE_MS is no longer repeated
+ * - Product information (126996) every NMEA2000_METADATA_INTERVAL_MS
+ *
+ * update() only enqueues; nothing here touches the bus.
+ */
+
+#ifndef SEASENSE_N2K_WATER_QUALITY_EMITTER_H
+#define SEASENSE_N2K_WATER_QUALITY_EMITTER_H
+
+#include <Arduino.h>
+#include <time.h>
+#include "N2kTxScheduler.h"
+
+class N2kWaterQualityEmitter {
+public:
+    explicit N2kWaterQualityEmitter(N2kTxScheduler* scheduler);
+
+    /**
+     * Readings from a measurement cycle; NAN for anything not measured
+     * @param epoch UTC time of the measurement, 0 if unknown
+     */
+    void setReadings(float waterTempC, float salinity, double lat, double lon,
+                     time_t epoch, unsigned long now);
+
+    /**
+     * Enqueue whatever is due. Call every loop() pass while output is enabled.
+     */
+    void update(unsigned long now);
+
+    /**
+     * Forget the readings (output disabled, nothing stale when re-enabled)
+     */
+    void reset();
+
+    uint32_t getPublishedCount() const { return _published; }
+
+private:
+    N2kTxScheduler* _scheduler;
+
+    float _tempC;
+    float _salinity;
+    double _lat;
+    double _lon;
+    time_t _epoch;
+    unsigned long _readingAt;
+    bool _hasReading;
+
+    unsigned long _lastWaterTx;
+    unsigned long _lastSalinityTx;
+    unsigned long _lastProductTx;
+    bool _productSent;
+    bool _readingPending;           // new reading not sent yet: send now
+    uint8_t _sid;
+    uint32_t _published;
+
+    void send(const N2kMessage& msg);
+};
+
+#endif // SEASENSE_N2K_WATER_QUALITY_EMITTER_H
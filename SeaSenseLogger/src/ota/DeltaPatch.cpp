@@ -0,0 +1,175 @@
+/**
+ * SeaSense Logger - OTA Delta Patch Applier Implementation
+ */
+
+#include "DeltaPatch.h"
+#include <string.h>
+
+static const uint8_t PATCH_MAGIC[4] = {'S', 'S', 'D', 'P'};
+static const uint8_t PATCH_VERSION = 1;
+
+DeltaPatch::DeltaPatch()
+    : _state(State::HEADER),
+      _scratchLen(0),
+      _scratchNeed(HEADER_SIZE),
+      _op(OP_END),
+      _sourceSize(0),
+      _targetSize(0),
+      _produced(0),
+      _insertRemaining(0),
+      _copied(0),
+      _inserted(0)
+{
+}
+
+bool DeltaPatch::isPatch(const uint8_t* data, size_t len) {
+    return len >= sizeof(PATCH_MAGIC) && memcmp(data, PATCH_MAGIC, sizeof(PATCH_MAGIC)) == 0;
+}
+
+void DeltaPatch::begin(SourceReader source, Sink sink) {
+    _source = source;
+    _sink = sink;
+    _state = State::HEADER;
+    _errorMessage = "";
+    _scratchLen = 0;
+    _scratchNeed = HEADER_SIZE;
+    _op = OP_END;
+    _sourceSize = 0;
+    _targetSize = 0;
+    _produced = 0;
+    _insertRemaining = 0;
+    _copied = 0;
+    _inserted = 0;
+}
+
+bool DeltaPatch::feed(const uint8_t* data, size_t len) {
+    size_t i = 0;
+    while (i < len) {
+        switch (_state) {
+            case State::HEADER:
+            case State::ARGS: {
+                size_t take = _scratchNeed - _scratchLen;
+                if (take > len - i) take = len - i;
+                memcpy(_scratch + _scratchLen, data + i, take);
+                _scratchLen += take;
+                i += take;
+                if (_scratchLen < _scratchNeed) break;
+
+                if (_state == State::HEADER) {
+                    if (!parseHeader()) return false;
+                    _state = State::OPCODE;
+                } else if (!executeOp()) {
+                    return false;
+                }
+                break;
+            }
+
+            case State::OPCODE:
+                _op = data[i++];
+                _scratchLen = 0;
+                if (_op == OP_END) {
+                    if (_produced != _targetSize) {
+                        return fail("Patch ended at " + String((unsigned long)_produced) +
+                                    " of " + String((unsigned long)_targetSize) + " bytes");
+                    }
+                    _state = State::DONE;
+                } else if (_op == OP_COPY) {
+                    _scratchNeed = 8;
+                    _state = State::ARGS;
+                } else if (_op == OP_INSERT) {
+                    _scratchNeed = 4;
+                    _state = State::ARGS;
+                } else {
+                    return fail("Unknown patch op " + String((int)_op));
+                }
+                break;
+
+            case State::INSERT_DATA: {
+                size_t take = _insertRemaining;
+                if (take > len - i) take = len - i;
+                if (!emit(data + i, take)) return false;
+                _inserted += take;
+                _insertRemaining -= take;
+                i += take;
+                if (_insertRemaining == 0) _state = State::OPCODE;
+                break;
+            }
+
+            case State::DONE:
+                return fail("Trailing bytes after patch END");
+
+            case State::ERROR:
+                return false;
+        }
+    }
+    return true;
+}
+
+// ============================================================================
+// Private
+// ============================================================================
+
+bool DeltaPatch::fail(const String& message) {
+    _state = State::ERROR;
+    _errorMessage = message;
+    return false;
+}
+
+bool DeltaPatch::parseHeader() {
+    if (!isPatch(_scratch, HEADER_SIZE)) {
+        return fail("Bad patch magic");
+    }
+    if (_scratch[4] != PATCH_VERSION) {
+        return fail("Unsupported patch version " + String(_scratch[4]));
+    }
+    _sourceSize = readU32(_scratch + 8);
+    _targetSize = readU32(_scratch + 12);
+    if (_targetSize == 0) {
+        return fail("Patch target size is zero");
+    }
+    return true;
+}
+
+bool DeltaPatch::executeOp() {
+    if (_op == OP_INSERT) {
+        _insertRemaining = readU32(_scratch);
+        _state = (_insertRemaining > 0) ? State::INSERT_DATA : State::OPCODE;
+        return true;
+    }
+
+    // OP_COPY
+    uint32_t srcOffset = readU32(_scratch);
+    uint32_t length = readU32(_scratch + 4);
+    if (srcOffset > _sourceSize || length > _sourceSize - srcOffset) {
+        return fail("Copy outside source image");
+    }
+
+    uint8_t buf[COPY_CHUNK];
+    while (length > 0) {
+        size_t n = (length < COPY_CHUNK) ? length : COPY_CHUNK;
+        if (!_source || !_source(srcOffset, buf, n)) {
+            return fail("Source read failed at " + String((unsigned long)srcOffset));
+        }
+        if (!emit(buf, n)) return false;
+        _copied += n;
+        srcOffset += n;
+        length -= n;
+    }
+    _state = State::OPCODE;
+    return true;
+}
+
+bool DeltaPatch::emit(const uint8_t* data, size_t len) {
+    if (len > _targetSize - _produced) {
+        return fail("Patch output exceeds target size");
+    }
+    if (!_sink || !_sink(data, len)) {
+        return fail("Patch output write failed");
+    }
+    _produced += len;
+    return true;
+}
+
+uint32_t DeltaPatch::readU32(const uint8_t* p) {
+    return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
@@ -0,0 +1,103 @@
+/**
+ * SeaSense Logger - OTA Delta Patch Applier
+ *
+ * Streams a binary delta against the running firmware partition so a
+ * fleet update only downloads the bytes that changed.
+ *
+ * Patch format (all integers little-endian):
+ *   Header (16 bytes):
+ *     "SSDP"          magic
+ *     u8  version     (1)
+ *     u8  reserved[3]
+ *     u32 sourceSize  bytes of the running image the patch was built against
+ *     u32 targetSize  bytes of the new image
+ *   Ops, repeated until END:
+ *     0x01 COPY   u32 srcOffset, u32 length   — copy from running image
+ *     0x02 INSERT u32 length, <length bytes>  — literal new bytes
+ *     0x00 END
+ *
+ * The applier is a byte-at-a-time state machine, so network chunks can split
+ * headers and ops anywhere. The rebuilt image is still checked by the
+ * bootloader image verification in Update.end(), so a patch applied to the
+ * wrong source image fails there and the running firmware is left alone.
+ */
+
+#ifndef SEASENSE_DELTA_PATCH_H
+#define SEASENSE_DELTA_PATCH_H
+
+#include <Arduino.h>
+#include <functional>
+
+class DeltaPatch {
+public:
+    // Reads `len` bytes of the running image at `offset` into `buf`
+    typedef std::function<bool(uint32_t offset, uint8_t* buf, size_t len)> SourceReader;
+    // Receives rebuilt image bytes in order
+    typedef std::function<bool(const uint8_t* data, size_t len)> Sink;
+
+    static const size_t HEADER_SIZE = 16;
+
+    DeltaPatch();
+
+    /**
+     * Check whether a stream starts with the patch magic
+     * @param data First bytes of the stream
+     * @param len Number of bytes available (needs at least 4)
+     */
+    static bool isPatch(const uint8_t* data, size_t len);
+
+    /**
+     * Reset and prepare for a new patch stream
+     */
+    void begin(SourceReader source, Sink sink);
+
+    /**
+     * Feed the next chunk of patch bytes
+     * @return false on malformed patch, out-of-range copy or sink failure
+     */
+    bool feed(const uint8_t* data, size_t len);
+
+    bool isHeaderParsed() const { return _state != State::HEADER; }
+    bool isComplete() const { return _state == State::DONE; }
+    bool hasError() const { return _state == State::ERROR; }
+    String getErrorMessage() const { return _errorMessage; }
+
+    uint32_t getSourceSize() const { return _sourceSize; }
+    uint32_t getTargetSize() const { return _targetSize; }
+    uint32_t getProduced() const { return _produced; }
+    uint32_t getCopiedBytes() const { return _copied; }
+    uint32_t getInsertedBytes() const { return _inserted; }
+
+private:
+    enum class State { HEADER, OPCODE, ARGS, INSERT_DATA, DONE, ERROR };
+
+    static const uint8_t OP_END = 0x00;
+    static const uint8_t OP_COPY = 0x01;
+    static const uint8_t OP_INSERT = 0x02;
+    static const size_t COPY_CHUNK = 256;
+
+    SourceReader _source;
+    Sink _sink;
+    State _state;
+    String _errorMessage;
+
+    uint8_t _scratch[HEADER_SIZE];  // header / op argument accumulator
+    size_t _scratchLen;
+    size_t _scratchNeed;
+    uint8_t _op;
+
+    uint32_t _sourceSize;
+    uint32_t _targetSize;
+    uint32_t _produced;
+    uint32_t _insertRemaining;
+    uint32_t _copied;
+    uint32_t _inserted;
+
+    bool fail(const String& message);
+    bool parseHeader();
+    bool executeOp();
+    bool emit(const uint8_t* data, size_t len);
+    static uint32_t readU32(const uint8_t* p);
+};
+
+#endif // SEASENSE_DELTA_PATCH_H
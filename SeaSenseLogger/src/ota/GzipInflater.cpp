@@ -0,0 +1,239 @@
+/**
+ * SeaSense Logger - Streaming gzip Decompressor Implementation
+ */
+
+#include "GzipInflater.h"
+#include <string.h>
+
+#ifndef NATIVE_TEST
+#include "rom/miniz.h"
+#else
+// Host builds inflate with zlib (raw deflate) in place of the ROM tinfl
+#include <zlib.h>
+#define TINFL_LZ_DICT_SIZE 32768
+#endif
+
+GzipInflater::GzipInflater()
+    : _headerDone(false),
+      _complete(false),
+      _inflated(0),
+      _stage(HeaderStage::FIXED),
+      _fixedLen(0),
+      _flags(0),
+      _skipRemaining(0),
+      _extraLenLen(0),
+      _decomp(nullptr),
+      _dict(nullptr),
+      _dictOfs(0)
+{
+}
+
+GzipInflater::~GzipInflater() {
+    end();
+}
+
+bool GzipInflater::isGzip(const uint8_t* data, size_t len) {
+    return len >= 3 && data[0] == 0x1F && data[1] == 0x8B && data[2] == 0x08;
+}
+
+bool GzipInflater::begin(Sink sink) {
+    end();
+    _sink = sink;
+    _errorMessage = "";
+    _headerDone = false;
+    _complete = false;
+    _inflated = 0;
+    _stage = HeaderStage::FIXED;
+    _fixedLen = 0;
+    _flags = 0;
+    _skipRemaining = 0;
+    _extraLenLen = 0;
+    _dictOfs = 0;
+
+#ifndef NATIVE_TEST
+    _decomp = malloc(sizeof(tinfl_decompressor));
+    _dict = (uint8_t*)malloc(TINFL_LZ_DICT_SIZE);
+    if (!_decomp || !_dict) {
+        end();
+        return fail("Out of memory for gzip inflater");
+    }
+    tinfl_init((tinfl_decompressor*)_decomp);
+#else
+    z_stream* zs = (z_stream*)calloc(1, sizeof(z_stream));
+    _dict = (uint8_t*)malloc(TINFL_LZ_DICT_SIZE);
+    if (!zs || !_dict || inflateInit2(zs, -MAX_WBITS) != Z_OK) {
+        free(zs);
+        end();
+        return fail("Out of memory for gzip inflater");
+    }
+    _decomp = zs;
+#endif
+    return true;
+}
+
+void GzipInflater::end() {
+#ifdef NATIVE_TEST
+    if (_decomp) inflateEnd((z_stream*)_decomp);
+#endif
+    if (_decomp) { free(_decomp); _decomp = nullptr; }
+    if (_dict) { free(_dict); _dict = nullptr; }
+}
+
+bool GzipInflater::feed(const uint8_t* data, size_t len) {
+    if (_errorMessage.length() > 0) return false;
+    if (_complete) return true;  // gzip trailer (CRC32 + ISIZE) — ignored
+
+    if (!_headerDone) {
+        size_t used = parseHeader(data, len);
+        if (_errorMessage.length() > 0) return false;
+        data += used;
+        len -= used;
+        if (!_headerDone || len == 0) return true;
+    }
+    return inflate(data, len);
+}
+
+// ============================================================================
+// Private
+// ============================================================================
+
+bool GzipInflater::fail(const String& message) {
+    _errorMessage = message;
+    Serial.print("[OTA] gzip: ");
+    Serial.println(message);
+    return false;
+}
+
+size_t GzipInflater::parseHeader(const uint8_t* data, size_t len) {
+    size_t i = 0;
+    while (i < len && _stage != HeaderStage::DONE) {
+        switch (_stage) {
+            case HeaderStage::FIXED:
+                _fixed[_fixedLen++] = data[i++];
+                if (_fixedLen < sizeof(_fixed)) break;
+                if (!isGzip(_fixed, _fixedLen)) {
+                    fail("Not a gzip/deflate stream");
+                    return i;
+                }
+                _flags = _fixed[3];
+                _stage = (_flags & FLAG_EXTRA) ? HeaderStage::EXTRA_LEN : HeaderStage::NAME;
+                break;
+
+            case HeaderStage::EXTRA_LEN:
+                _extraLenBytes[_extraLenLen++] = data[i++];
+                if (_extraLenLen < 2) break;
+                _skipRemaining = (uint16_t)(_extraLenBytes[0] | (_extraLenBytes[1] << 8));
+                _stage = HeaderStage::EXTRA;
+                break;
+
+            case HeaderStage::EXTRA: {
+                size_t take = _skipRemaining;
+                if (take > len - i) take = len - i;
+                i += take;
+                _skipRemaining -= take;
+                if (_skipRemaining == 0) _stage = HeaderStage::NAME;
+                break;
+            }
+
+            case HeaderStage::NAME:
+                if (!(_flags & FLAG_NAME)) { _stage = HeaderStage::COMMENT; break; }
+                if (data[i++] == 0) _flags &= ~FLAG_NAME;  // next pass moves on
+                break;
+
+            case HeaderStage::COMMENT:
+                if (!(_flags & FLAG_COMMENT)) {
+                    _skipRemaining = (_flags & FLAG_HCRC) ? 2 : 0;
+                    _stage = HeaderStage::HCRC;
+                    break;
+                }
+                if (data[i++] == 0) _flags &= ~FLAG_COMMENT;
+                break;
+
+            case HeaderStage::HCRC: {
+                size_t take = _skipRemaining;
+                if (take > len - i) take = len - i;
+                i += take;
+                _skipRemaining -= take;
+                if (_skipRemaining == 0) _stage = HeaderStage::DONE;
+                break;
+            }
+
+            case HeaderStage::DONE:
+                break;
+        }
+    }
+
+    // Flag-dependent stages with nothing to consume can finish at a chunk edge
+    if (_stage == HeaderStage::NAME && !(_flags & FLAG_NAME)) _stage = HeaderStage::COMMENT;
+    if (_stage == HeaderStage::COMMENT && !(_flags & FLAG_COMMENT)) {
+        _skipRemaining = (_flags & FLAG_HCRC) ? 2 : 0;
+        _stage = HeaderStage::HCRC;
+    }
+    if (_stage == HeaderStage::HCRC && _skipRemaining == 0) _stage = HeaderStage::DONE;
+
+    _headerDone = (_stage == HeaderStage::DONE);
+    return i;
+}
+
+bool GzipInflater::inflate(const uint8_t* data, size_t len) {
+#ifndef NATIVE_TEST
+    tinfl_decompressor* decomp = (tinfl_decompressor*)_decomp;
+    while (true) {
+        size_t inBytes = len;
+        size_t outBytes = TINFL_LZ_DICT_SIZE - _dictOfs;
+        tinfl_status status = tinfl_decompress(decomp, data, &inBytes,
+                                               _dict, _dict + _dictOfs, &outBytes,
+                                               TINFL_FLAG_HAS_MORE_INPUT);
+        data += inBytes;
+        len -= inBytes;
+
+        if (outBytes > 0) {
+            if (!_sink || !_sink(_dict + _dictOfs, outBytes)) {
+                return fail("Inflated write failed");
+            }
+            _inflated += outBytes;
+            _dictOfs = (_dictOfs + outBytes) & (TINFL_LZ_DICT_SIZE - 1);
+        }
+
+        if (status < TINFL_STATUS_DONE) {
+            return fail("Corrupt deflate stream (" + String((int)status) + ")");
+        }
+        if (status == TINFL_STATUS_DONE) {
+            _complete = true;
+            return true;
+        }
+        if (status == TINFL_STATUS_NEEDS_MORE_INPUT && len == 0) {
+            return true;
+        }
+        // TINFL_STATUS_HAS_MORE_OUTPUT: window full, loop to flush
+    }
+#else
+    z_stream* zs = (z_stream*)_decomp;
+    zs->next_in = (Bytef*)data;
+    zs->avail_in = (uInt)len;
+    while (true) {
+        zs->next_out = _dict;
+        zs->avail_out = TINFL_LZ_DICT_SIZE;
+        int status = ::inflate(zs, Z_NO_FLUSH);
+        size_t outBytes = TINFL_LZ_DICT_SIZE - zs->avail_out;
+
+        if (outBytes > 0) {
+            if (!_sink || !_sink(_dict, outBytes)) {
+                return fail("Inflated write failed");
+            }
+            _inflated += outBytes;
+        }
+
+        if (status == Z_STREAM_END) {
+            _complete = true;
+            return true;
+        }
+        if (status != Z_OK && status != Z_BUF_ERROR) {
+            return fail("Corrupt deflate stream (" + String(status) + ")");
+        }
+        if (zs->avail_in == 0 && zs->avail_out > 0) {
+            return true;
+        }
+    }
+#endif
+}
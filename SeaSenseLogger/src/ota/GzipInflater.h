@@ -0,0 +1,92 @@
+/**
+ * SeaSense Logger - Streaming gzip Decompressor for OTA
+ *
+ * Inflates a gzip-compressed firmware image chunk by chunk as it arrives
+ * from the network, using the miniz "tinfl" inflater in the ESP32 ROM
+ * (ESP32-targz was dropped because it does not support the S3).
+ *
+ * Memory: one 32 KB dictionary + the tinfl state (~11 KB), heap-allocated
+ * in begin() and released in end(), so nothing is held outside an update.
+ *
+ * The gzip trailer (CRC32 + size) is not checked here; Update.end() runs
+ * the bootloader's SHA-256 image verification on the inflated image.
+ *
+ * Host test builds inflate with zlib instead of the ROM tinfl (link -lz).
+ */
+
+#ifndef SEASENSE_GZIP_INFLATER_H
+#define SEASENSE_GZIP_INFLATER_H
+
+#include <Arduino.h>
+#include <functional>
+
+class GzipInflater {
+public:
+    // Receives inflated bytes in order
+    typedef std::function<bool(const uint8_t* data, size_t len)> Sink;
+
+    GzipInflater();
+    ~GzipInflater();
+
+    /**
+     * Check whether a stream starts with the gzip magic (1f 8b, deflate)
+     */
+    static bool isGzip(const uint8_t* data, size_t len);
+
+    /**
+     * Allocate buffers and reset state
+     * @return false if out of memory
+     */
+    bool begin(Sink sink);
+
+    /**
+     * Feed the next chunk of compressed bytes
+     * @return false on corrupt stream or sink failure
+     */
+    bool feed(const uint8_t* data, size_t len);
+
+    /**
+     * Release buffers
+     */
+    void end();
+
+    bool isHeaderParsed() const { return _headerDone; }
+    bool isComplete() const { return _complete; }
+    String getErrorMessage() const { return _errorMessage; }
+    uint32_t getInflatedBytes() const { return _inflated; }
+
+private:
+    // gzip header flags (RFC 1952)
+    static const uint8_t FLAG_HCRC = 0x02;
+    static const uint8_t FLAG_EXTRA = 0x04;
+    static const uint8_t FLAG_NAME = 0x08;
+    static const uint8_t FLAG_COMMENT = 0x10;
+
+    enum class HeaderStage { FIXED, EXTRA_LEN, EXTRA, NAME, COMMENT, HCRC, DONE };
+
+    Sink _sink;
+    String _errorMessage;
+    bool _headerDone;
+    bool _complete;
+    uint32_t _inflated;
+
+    // Header parser
+    HeaderStage _stage;
+    uint8_t _fixed[10];
+    size_t _fixedLen;
+    uint8_t _flags;
+    uint16_t _skipRemaining;
+    uint8_t _extraLenBytes[2];
+    size_t _extraLenLen;
+
+    // Inflater state
+    void* _decomp;      // tinfl_decompressor* (z_stream* on the host)
+    uint8_t* _dict;     // 32 KB circular output window
+    size_t _dictOfs;
+
+    size_t parseHeader(const uint8_t* data, size_t len);
+    bool inflate(const uint8_t* data, size_t len);
+    bool fail(const String& message);
+};
+
+#endif // SEASENSE_GZIP_INFLATER_H
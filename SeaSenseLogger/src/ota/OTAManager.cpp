@@ -3,20 +3,49 @@
  */
 
 #include "OTAManager.h"
+#include "../../config/hardware_config.h"
+
+#include <ArduinoJson.h>
 
 #ifndef NATIVE_TEST
 #include <WiFi.h>
-#include <ArduinoJson.h>
+#include <esp_ota_ops.h>
+#include <esp_partition.h>
 #endif
 
+std::atomic<bool> OTAManager::_updateActive(false);
+volatile bool OTAManager::_restartPending = false;
+
 OTAManager::OTAManager()
     : _state(State::IDLE),
       _progress(0),
       _totalSize(0),
-      _written(0)
+      _written(0),
+      _flashWritten(0),
+      _throughputBps(0),
+      _resumeCount(0),
+      _transferStartMs(0),
+      _ownsUpdate(false),
+      _flashBegun(false),
+      _transportKnown(false),
+      _compressed(false),
+      _imageKnown(false),
+      _delta(false),
+      _sniffInLen(0),
+      _sniffOutLen(0),
+      _taskRunning(false)
 {
 }
 
+OTAManager::~OTAManager() {
+    if (_ownsUpdate) {
+#ifndef NATIVE_TEST
+        if (_flashBegun) Update.abort();
+#endif
+        releaseUpdate();
+    }
+}
+
 String OTAManager::parseVersionFromTag(const String& tag) {
     if (tag.startsWith("fw-")) {
         return tag.substring(3);
@@ -32,6 +61,14 @@ size_t OTAManager::getMaxFirmwareSize() const {
 #endif
 }
 
+String OTAManager::getImageFormat() const {
+    if (!_transportKnown) return "unknown";
+    if (_compressed && _delta) return "gzip+delta";
+    if (_compressed) return "gzip";
+    if (_delta) return "delta";
+    return "bin";
+}
+
 void OTAManager::setError(const String& message) {
     _state = State::ERROR;
     _errorMessage = message;
@@ -39,10 +76,46 @@ void OTAManager::setError(const String& message) {
     Serial.println(message);
 }
 
+void OTAManager::failUpdate(const String& message) {
+    setError(message);
+    cleanupUpdate();
+}
+
+void OTAManager::cleanupUpdate() {
+#ifndef NATIVE_TEST
+    if (_flashBegun) Update.abort();
+#endif
+    _flashBegun = false;
+    _gzip.end();
+    releaseUpdate();
+}
+
 void OTAManager::updateProgress() {
     if (_totalSize > 0) {
         _progress = (uint8_t)((_written * 100) / _totalSize);
     }
+    unsigned long elapsed = millis() - _transferStartMs;
+    if (elapsed > 0) {
+        _throughputBps = (uint32_t)(((uint64_t)_written * 1000) / elapsed);
+    }
+}
+
+bool OTAManager::claimUpdate() {
+    // Not reentrant: a second begin() on the instance that already holds the
+    // claim (web upload during a background install) must not restart it
+    if (_ownsUpdate) return false;
+    bool expected = false;
+    if (!_updateActive.compare_exchange_strong(expected, true)) {
+        return false;
+    }
+    _ownsUpdate = true;
+    return true;
+}
+
+void OTAManager::releaseUpdate() {
+    if (!_ownsUpdate) return;
+    _ownsUpdate = false;
+    _updateActive.store(false);
 }
 
 // ============================================================================
@@ -50,7 +123,7 @@ void OTAManager::updateProgress() {
 // ============================================================================
 
 OTAManager::UpdateInfo OTAManager::checkForUpdate(const String& currentVersion) {
-    UpdateInfo info = {false, "", ""};
+    UpdateInfo info = {false, "", "", ""};
 
 #ifndef NATIVE_TEST
     _state = State::CHECKING;
@@ -71,75 +144,122 @@ OTAManager::UpdateInfo OTAManager::checkForUpdate(const String& currentVersion)
     String payload = http.getString();
     http.end();
 
-    // Parse JSON response
+    String error;
+    info = parseRelease(payload, currentVersion, error);
+    if (!error.isEmpty()) {
+        setError(error);
+        return info;
+    }
+
+    if (info.available) {
+        Serial.print("[OTA] Update available: ");
+        Serial.print(info.version);
+        Serial.print(" (");
+        Serial.print(info.fallbackUrl.isEmpty() ? "full image" : "delta");
+        Serial.println(")");
+    } else {
+        Serial.println("[OTA] Firmware is up to date");
+    }
+
+    _state = State::IDLE;
+#endif
+
+    return info;
+}
+
+// Smallest download first: a delta built against the running version, then
+// the gzipped image, then the plain one. With a delta, the best full image
+// is kept as the fallback in case the patch doesn't apply.
+OTAManager::UpdateInfo OTAManager::parseRelease(const String& payload,
+                                                const String& currentVersion,
+                                                String& error) {
+    UpdateInfo info = {false, "", "", ""};
+
     JsonDocument doc;
     DeserializationError err = deserializeJson(doc, payload);
     if (err) {
-        setError("JSON parse error: " + String(err.c_str()));
+        error = "JSON parse error: " + String(err.c_str());
         return info;
     }
 
     String tagName = doc["tag_name"] | "";
     if (tagName.isEmpty()) {
-        setError("No tag_name in release");
+        error = "No tag_name in release";
         return info;
     }
-
     String remoteVersion = parseVersionFromTag(tagName);
 
-    // Find .bin asset
+    // e.g. seasense-abc1234-from-9f8e7d6.ssdp[.gz]
+    String deltaSuffix = "-from-" + currentVersion + ".ssdp";
+    String deltaUrl, gzipUrl, binUrl;
     JsonArray assets = doc["assets"];
     for (JsonObject asset : assets) {
         String name = asset["name"] | "";
-        if (name.endsWith(".bin")) {
-            info.url = asset["browser_download_url"] | "";
-            break;
+        String url = asset["browser_download_url"] | "";
+        if (url.isEmpty()) continue;
+        if (!currentVersion.isEmpty() &&
+            (name.endsWith(deltaSuffix) || name.endsWith(deltaSuffix + ".gz"))) {
+            if (deltaUrl.isEmpty()) deltaUrl = url;
+        } else if (name.endsWith(".bin.gz")) {
+            if (gzipUrl.isEmpty()) gzipUrl = url;
+        } else if (name.endsWith(".bin")) {
+            if (binUrl.isEmpty()) binUrl = url;
         }
     }
 
-    if (info.url.isEmpty()) {
-        setError("No .bin asset in release");
+    String fullUrl = gzipUrl.isEmpty() ? binUrl : gzipUrl;
+    if (fullUrl.isEmpty() && deltaUrl.isEmpty()) {
+        error = "No .bin or .bin.gz asset in release";
         return info;
     }
+    if (!deltaUrl.isEmpty()) {
+        info.url = deltaUrl;
+        info.fallbackUrl = fullUrl;
+    } else {
+        info.url = fullUrl;
+    }
 
-    // Compare versions
     if (currentVersion.isEmpty() || remoteVersion != currentVersion) {
         info.available = true;
         info.version = remoteVersion;
-        Serial.print("[OTA] Update available: ");
-        Serial.println(remoteVersion);
-    } else {
-        Serial.println("[OTA] Firmware is up to date");
     }
-
-    _state = State::IDLE;
-#endif
-
     return info;
 }
 
 // ============================================================================
-// Manual upload — chunked writes from browser
+// Image pipeline — manual upload chunks and server downloads both land here
 // ============================================================================
 
 bool OTAManager::begin(size_t fileSize) {
+    if (_ownsUpdate) {
+        // Leave the running update's state and error alone
+        Serial.println("[OTA] begin() refused: this instance is already receiving");
+        return false;
+    }
     size_t maxSize = getMaxFirmwareSize();
     if (fileSize > maxSize) {
         setError("Firmware too large: " + String((unsigned long)fileSize) + " bytes, max " + String((unsigned long)maxSize) + " bytes");
         return false;
     }
+    if (!claimUpdate()) {
+        setError("Another update is already in progress");
+        return false;
+    }
 
     _totalSize = fileSize;
     _written = 0;
+    _flashWritten = 0;
     _progress = 0;
+    _throughputBps = 0;
+    _transferStartMs = millis();
     _errorMessage = "";
-
-#ifndef NATIVE_TEST
-    if (!Update.begin(fileSize)) {
-        setError("Update.begin() failed");
-        return false;
-    }
-#endif
+    _flashBegun = false;
+    _transportKnown = false;
+    _compressed = false;
+    _imageKnown = false;
+    _delta = false;
+    _sniffInLen = 0;
+    _sniffOutLen = 0;
 
     _state = State::RECEIVING;
     Serial.print("[OTA] Begin upload, size: ");
@@ -152,13 +272,9 @@ bool OTAManager::writeChunk(const uint8_t* data, size_t length) {
         return false;
     }
 
-#ifndef NATIVE_TEST
-    size_t written = Update.write(const_cast<uint8_t*>(data), length);
-    if (written != length) {
-        setError("Write failed: wrote " + String((unsigned long)written) + " of " + String((unsigned long)length));
+    if (!routeTransport(data, length)) {
         return false;
     }
-#endif
 
     _written += length;
     updateProgress();
@@ -170,107 +286,360 @@ bool OTAManager::end() {
         return false;
     }
 
+    if (!flushSniffBuffers()) return false;
+
+    if (_compressed && !_gzip.isComplete()) {
+        failUpdate("Truncated gzip image");
+        return false;
+    }
+    if (_delta && !_patch.isComplete()) {
+        failUpdate("Truncated delta patch: " + String((unsigned long)_patch.getProduced()) +
+                   " of " + String((unsigned long)_patch.getTargetSize()) + " bytes");
+        return false;
+    }
+
 #ifndef NATIVE_TEST
+    if (!_flashBegun) {
+        failUpdate("Empty firmware image");
+        return false;
+    }
     if (!Update.end(true)) {
-        setError("Update.end() failed");
+        failUpdate("Update.end() failed");
         return false;
     }
 #endif
+    _flashBegun = false;
+    _gzip.end();
+    releaseUpdate();
 
     _state = State::SUCCESS;
     _progress = 100;
-    Serial.println("[OTA] Update complete, restarting...");
+    Serial.print("[OTA] Update complete (");
+    Serial.print(getImageFormat());
+    Serial.print(", ");
+    Serial.print((unsigned long)_written);
+    Serial.print(" bytes received, ");
+    Serial.print((unsigned long)_flashWritten);
+    Serial.print(" flashed, ");
+    Serial.print((unsigned long)(_throughputBps / 1024));
+    Serial.println(" KB/s)");
+    return true;
+}
+
+// Collect the first 4 bytes of a stage so its format can be detected even
+// if the first chunk is tiny. Returns true once 4 bytes are buffered.
+bool OTAManager::sniff(uint8_t* buf, uint8_t& have, const uint8_t*& data, size_t& length) {
+    while (have < 4 && length > 0) {
+        buf[have++] = *data++;
+        length--;
+    }
+    return have == 4;
+}
+
+bool OTAManager::routeTransport(const uint8_t* data, size_t length) {
+    if (!_transportKnown) {
+        if (!sniff(_sniffIn, _sniffInLen, data, length)) return true;
+        _transportKnown = true;
+        _compressed = GzipInflater::isGzip(_sniffIn, _sniffInLen);
+        if (_compressed) {
+            if (!_gzip.begin([this](const uint8_t* d, size_t n) { return routeImage(d, n); })) {
+                failUpdate(_gzip.getErrorMessage());
+                return false;
+            }
+        }
+        if (!routeTransport(_sniffIn, _sniffInLen)) return false;
+    }
+    if (length == 0) return true;
+
+    if (_compressed) {
+        if (!_gzip.feed(data, length)) {
+            if (_state == State::RECEIVING) failUpdate(_gzip.getErrorMessage());
+            return false;
+        }
+        return true;
+    }
+    return routeImage(data, length);
+}
+
+bool OTAManager::routeImage(const uint8_t* data, size_t length) {
+    if (!_imageKnown) {
+        if (!sniff(_sniffOut, _sniffOutLen, data, length)) return true;
+        _imageKnown = true;
+        _delta = DeltaPatch::isPatch(_sniffOut, _sniffOutLen);
+        if (_delta) {
+            _patch.begin(readRunningImage,
+                         [this](const uint8_t* d, size_t n) { return writeImage(d, n); });
+        }
+        if (!routeImage(_sniffOut, _sniffOutLen)) return false;
+    }
+    if (length == 0) return true;
+
+    if (_delta) {
+        if (!_patch.feed(data, length)) {
+            if (_state == State::RECEIVING) failUpdate(_patch.getErrorMessage());
+            return false;
+        }
+        return true;
+    }
+    return writeImage(data, length);
+}
+
+bool OTAManager::writeImage(const uint8_t* data, size_t length) {
+#ifndef NATIVE_TEST
+    if (!_flashBegun) {
+        size_t imageSize = UPDATE_SIZE_UNKNOWN;
+        if (_delta) {
+            imageSize = _patch.getTargetSize();
+        } else if (!_compressed) {
+            imageSize = _totalSize;
+        }
+        if (!Update.begin(imageSize)) {
+            failUpdate("Update.begin() failed");
+            return false;
+        }
+        _flashBegun = true;
+    }
+
+    size_t written = Update.write(const_cast<uint8_t*>(data), length);
+    if (written != length) {
+        failUpdate("Write failed: wrote " + String((unsigned long)written) + " of " + String((unsigned long)length));
+        return false;
+    }
+#else
+    (void)data;
+    _flashBegun = true;
+#endif
+    _flashWritten += length;
+    return true;
+}
+
+bool OTAManager::flushSniffBuffers() {
+    // Streams shorter than 4 bytes never completed detection — treat as raw
+    if (!_transportKnown && _sniffInLen > 0) {
+        _transportKnown = true;
+        _compressed = false;
+        if (!routeImage(_sniffIn, _sniffInLen)) return false;
+    }
+    if (!_imageKnown && _sniffOutLen > 0) {
+        _imageKnown = true;
+        _delta = false;
+        if (!writeImage(_sniffOut, _sniffOutLen)) return false;
+    }
     return true;
 }
 
+bool OTAManager::readRunningImage(uint32_t offset, uint8_t* buf, size_t length) {
+#ifndef NATIVE_TEST
+    const esp_partition_t* running = esp_ota_get_running_partition();
+    if (!running || offset + length > running->size) return false;
+    return esp_partition_read(running, offset, buf, length) == ESP_OK;
+#else
+    (void)offset;
+    (void)buf;
+    (void)length;
+    return false;
+#endif
+}
+
 // ============================================================================
-// Server update — download .bin from URL and flash
+// Server update — download from URL with Range resume
 // ============================================================================
 
 bool OTAManager::updateFromUrl(const String& url) {
 #ifndef NATIVE_TEST
-    _state = State::RECEIVING;
-    _written = 0;
-    _progress = 0;
-    _errorMessage = "";
-
     Serial.print("[OTA] Downloading from: ");
     Serial.println(url);
 
-    HTTPClient http;
-    http.begin(url);
-    http.addHeader("User-Agent", "SeaSense-ESP32");
-    http.setFollowRedirects(HTTPC_FORCE_FOLLOW_REDIRECTS);
-    http.setTimeout(30000);
+    _resumeCount = 0;
+    _totalSize = 0;  // learned from the first response
+    _written = 0;
 
-    int httpCode = http.GET();
-    if (httpCode != 200) {
-        setError("Download failed: HTTP " + String(httpCode));
+    uint8_t* buf = (uint8_t*)malloc(OTA_DOWNLOAD_BUFFER_SIZE);
+    if (!buf) {
+        setError("Out of memory for download buffer");
         return false;
     }
 
-    int contentLength = http.getSize();
-    if (contentLength <= 0) {
-        setError("Invalid content length");
-        http.end();
-        return false;
-    }
+    bool ok = false;
+    while (true) {
+        DownloadResult result = downloadOnce(url, buf);
+        if (result == DownloadResult::COMPLETE) {
+            ok = end();
+            break;
+        }
+        if (result == DownloadResult::FATAL) {
+            cleanupUpdate();  // error already recorded
+            break;
+        }
+        if (_resumeCount >= OTA_MAX_RESUME_ATTEMPTS) {
+            if (_state == State::RECEIVING) {
+                failUpdate("Download failed after " + String(_resumeCount) + " resumes");
+            }
+            break;
+        }
 
-    size_t maxSize = getMaxFirmwareSize();
-    if ((size_t)contentLength > maxSize) {
-        setError("Firmware too large: " + String(contentLength) + " bytes, max " + String((unsigned long)maxSize) + " bytes");
-        http.end();
-        return false;
+        _resumeCount++;
+        unsigned long backoff = (unsigned long)OTA_RESUME_BACKOFF_MS << (_resumeCount - 1);
+        if (backoff > 30000) backoff = 30000;
+        Serial.print("[OTA] Link dropped at ");
+        Serial.print((unsigned long)_written);
+        Serial.print(" bytes, resuming in ");
+        Serial.print(backoff / 1000);
+        Serial.println("s");
+        delay(backoff);
     }
 
-    _totalSize = contentLength;
+    free(buf);
+    return ok;
+#else
+    (void)url;
+    return false;
+#endif
+}
+
+#ifndef NATIVE_TEST
+OTAManager::DownloadResult OTAManager::downloadOnce(const String& url, uint8_t* buf) {
+    HTTPClient http;
+    http.begin(url);
+    http.addHeader("User-Agent", "SeaSense-ESP32");
+    http.setFollowRedirects(HTTPC_FORCE_FOLLOW_REDIRECTS);
+    http.setTimeout(OTA_STALL_TIMEOUT_MS);
+    if (_written > 0) {
+        http.addHeader("Range", "bytes=" + String((unsigned long)_written) + "-");
+    }
 
-    if (!Update.begin(contentLength)) {
-        setError("Update.begin() failed");
+    int httpCode = http.GET();
+    size_t skip = 0;
+
+    if (httpCode == 206 && _written > 0) {
+        // Resumed where we left off
+    } else if (httpCode == 200) {
+        if (_written > 0) {
+            // Server ignored Range — discard what we already have
+            skip = _written;
+            Serial.println("[OTA] Server does not support Range, skipping received bytes");
+        } else {
+            int contentLength = http.getSize();
+            if (contentLength <= 0) {
+                setError("Invalid content length");
+                http.end();
+                return DownloadResult::FATAL;
+            }
+            if (!begin((size_t)contentLength)) {
+                http.end();
+                return DownloadResult::FATAL;
+            }
+        }
+    } else {
         http.end();
-        return false;
+        // Negative codes are connection errors — worth a retry only as a
+        // resume; a server unreachable before the first byte is an error
+        // (_state is already RECEIVING from startUpdateFromUrl())
+        if (httpCode < 0 && _written > 0) {
+            return DownloadResult::RETRY;
+        }
+        setError("Download failed: HTTP " + String(httpCode));
+        return DownloadResult::FATAL;
     }
 
+    // Nothing to resume from until the first byte has arrived
+    auto linkLost = [&]() {
+        http.end();
+        if (_written > 0) {
+            return DownloadResult::RETRY;
+        }
+        setError("Download failed: connection lost before any data");
+        return DownloadResult::FATAL;
+    };
+
     WiFiClient* stream = http.getStreamPtr();
-    uint8_t buf[1024];
+    unsigned long lastData = millis();
     while (_written < _totalSize) {
         size_t available = stream->available();
         if (available == 0) {
+            if (!http.connected() || millis() - lastData > OTA_STALL_TIMEOUT_MS) {
+                return linkLost();
+            }
             delay(1);
             continue;
         }
-        size_t toRead = (available < sizeof(buf)) ? available : sizeof(buf);
+
+        size_t toRead = (available < OTA_DOWNLOAD_BUFFER_SIZE) ? available : OTA_DOWNLOAD_BUFFER_SIZE;
+        if (skip > 0 && toRead > skip) toRead = skip;
         size_t bytesRead = stream->readBytes(buf, toRead);
         if (bytesRead == 0) {
-            setError("Stream read timeout");
-            Update.abort();
-            http.end();
-            return false;
+            return linkLost();
+        }
+        lastData = millis();
+
+        if (skip > 0) {
+            skip -= bytesRead;
+            continue;
         }
-        size_t written = Update.write(buf, bytesRead);
-        if (written != bytesRead) {
-            setError("Update write failed");
-            Update.abort();
+        if (!writeChunk(buf, bytesRead)) {
             http.end();
-            return false;
+            return DownloadResult::FATAL;
         }
-        _written += bytesRead;
-        updateProgress();
     }
 
-    if (!Update.end(true)) {
-        setError("Update.end() failed");
-        http.end();
+    http.end();
+    return DownloadResult::COMPLETE;
+}
+
+void OTAManager::backgroundTask(void* param) {
+    OTAManager* self = (OTAManager*)param;
+    bool ok = self->updateFromUrl(self->_pendingUrl);
+    // A delta that didn't apply (or wouldn't download): install the full
+    // image instead. Not after abort(), which leaves the state IDLE.
+    if (!ok && self->_state == State::ERROR && !self->_pendingFallbackUrl.isEmpty()) {
+        Serial.print("[OTA] Delta update failed (");
+        Serial.print(self->_errorMessage);
+        Serial.println("), falling back to the full image");
+        self->_errorMessage = "";
+        self->_progress = 0;
+        self->_state = State::RECEIVING;
+        ok = self->updateFromUrl(self->_pendingFallbackUrl);
+    }
+    if (ok) {
+        Serial.println("[OTA] Background update finished, restart pending");
+        _restartPending = true;
+    }
+    self->_taskRunning = false;
+    vTaskDelete(NULL);
+}
+#endif
+
+bool OTAManager::startUpdateFromUrl(const String& url, const String& fallbackUrl) {
+#ifndef NATIVE_TEST
+    if (_taskRunning || _ownsUpdate) {
+        // Leave the running update's state and error alone
+        Serial.println("[OTA] Background update refused: this instance is already receiving");
+        return false;
+    }
+    if (_updateActive.load()) {
+        setError("Another update is already in progress");
         return false;
     }
 
-    http.end();
-    _state = State::SUCCESS;
-    _progress = 100;
-    Serial.println("[OTA] Update complete, restarting...");
+    _pendingUrl = url;
+    _pendingFallbackUrl = fallbackUrl;
+    _errorMessage = "";
+    _progress = 0;
+    _state = State::RECEIVING;
+    _taskRunning = true;
+
+    BaseType_t ok = xTaskCreatePinnedToCore(
+        backgroundTask, "OTA", OTA_TASK_STACK_SIZE, this, OTA_TASK_PRIORITY, NULL, 0);
+    if (ok != pdPASS) {
+        _taskRunning = false;
+        setError("Failed to start OTA task");
+        return false;
+    }
+    Serial.println("[OTA] Background download started");
     return true;
 #else
     (void)url;
+    (void)fallbackUrl;
     return false;
 #endif
 }
@@ -281,14 +650,16 @@ bool OTAManager::updateFromUrl(const String& url) {
 
 void OTAManager::abort() {
 #ifndef NATIVE_TEST
-    if (_state == State::RECEIVING) {
+    if (_state == State::RECEIVING && _flashBegun) {
         Update.abort();
     }
 #endif
+    cleanupUpdate();
     _state = State::IDLE;
     _progress = 0;
     _written = 0;
     _totalSize = 0;
+    _flashWritten = 0;
     _errorMessage = "";
     Serial.println("[OTA] Aborted");
 }
@@ -2,16 +2,30 @@
  * SeaSense Logger - OTA Firmware Update Manager
  *
  * Handles firmware updates via:
- * 1. Server check — polls GitHub Releases API, compares version, downloads .bin
+ * 1. Server check — polls GitHub Releases API, compares version, downloads the
+ *    smallest usable asset (delta from the running version, .bin.gz, .bin)
  * 2. Manual upload — browser uploads .bin via chunked HTTP POST
  *
- * Safety: size check, MD5 (built into ESP32 Update.h), rollback protection
+ * Server downloads run in a background task so sensor logging continues.
+ * A dropped link resumes with an HTTP Range request from the last byte
+ * received instead of starting over.
+ *
+ * Accepted images (detected from the first bytes, for both paths):
+ * - plain .bin
+ * - gzip-compressed .bin.gz (inflated on the fly, see GzipInflater)
+ * - delta patch against the running firmware (see DeltaPatch), optionally gzipped
+ *
+ * Safety: size check, image verification in Update.end(), rollback protection,
+ * one update at a time across all OTAManager instances.
  */
 
 #ifndef SEASENSE_OTA_MANAGER_H
 #define SEASENSE_OTA_MANAGER_H
 
 #include <Arduino.h>
+#include <atomic>
+#include "DeltaPatch.h"
+#include "GzipInflater.h"
 
 #ifndef NATIVE_TEST
 #include <Update.h>
@@ -26,21 +40,34 @@ public:
         bool available;
         String version;
         String url;
+        String fallbackUrl;  // full image if url is a delta, else empty
     };
 
     OTAManager();
+    ~OTAManager();
 
     // Check GitHub Releases for updates (blocking HTTP call)
     UpdateInfo checkForUpdate(const String& currentVersion);
 
-    // Manual upload (browser form — chunked)
+    // Pick the assets to download from a GitHub release JSON; sets error
+    // (and leaves url empty) if the release has nothing installable
+    static UpdateInfo parseRelease(const String& payload, const String& currentVersion,
+                                   String& error);
+
+    // Manual upload (browser form — chunked). Also the image pipeline
+    // that server downloads feed into.
     bool begin(size_t fileSize);
     bool writeChunk(const uint8_t* data, size_t length);
     bool end();
 
-    // Server update (download from URL)
+    // Server update (download from URL) — blocks until done
     bool updateFromUrl(const String& url);
 
+    // Server update in a background task; returns immediately.
+    // If url fails and fallbackUrl is set, that image is downloaded instead.
+    // On success, isRestartPending() becomes true — reboot from a safe point.
+    bool startUpdateFromUrl(const String& url, const String& fallbackUrl = "");
+
     void abort();
 
     State getState() const { return _state; }
@@ -48,18 +75,77 @@ public:
     uint8_t getProgress() const { return _progress; }
     size_t getMaxFirmwareSize() const;
 
+    // Transfer statistics (valid during and after an update)
+    size_t getBytesReceived() const { return _written; }
+    size_t getTransferSize() const { return _totalSize; }
+    size_t getBytesFlashed() const { return _flashWritten; }
+    uint32_t getThroughputBps() const { return _throughputBps; }
+    uint8_t getResumeCount() const { return _resumeCount; }
+    String getImageFormat() const;
+    bool isBackgroundRunning() const { return _taskRunning; }
+
+    // True once any instance has finished a background update
+    static bool isRestartPending() { return _restartPending; }
+
+    // True while any instance holds the one-update-at-a-time claim
+    static bool isUpdateInProgress() { return _updateActive.load(); }
+
     // Parse version from GitHub release tag (strip "fw-" prefix)
     static String parseVersionFromTag(const String& tag);
 
 private:
+    enum class DownloadResult { COMPLETE, RETRY, FATAL };
+
     State _state;
     String _errorMessage;
     uint8_t _progress;
-    size_t _totalSize;
-    size_t _written;
+    size_t _totalSize;       // bytes expected over the wire
+    size_t _written;         // bytes received over the wire
+    size_t _flashWritten;    // image bytes written to the OTA partition
+    uint32_t _throughputBps;
+    uint8_t _resumeCount;
+    unsigned long _transferStartMs;
+
+    // Image pipeline: [gzip] -> [delta] -> flash
+    bool _ownsUpdate;        // holds the global one-update-at-a-time claim
+    bool _flashBegun;
+    bool _transportKnown;
+    bool _compressed;
+    bool _imageKnown;
+    bool _delta;
+    uint8_t _sniffIn[4];
+    uint8_t _sniffInLen;
+    uint8_t _sniffOut[4];
+    uint8_t _sniffOutLen;
+    GzipInflater _gzip;
+    DeltaPatch _patch;
+
+    // Background task
+    String _pendingUrl;
+    String _pendingFallbackUrl;
+    volatile bool _taskRunning;
+
+    static std::atomic<bool> _updateActive;
+    static volatile bool _restartPending;
 
     void setError(const String& message);
+    void failUpdate(const String& message);
+    void cleanupUpdate();
     void updateProgress();
+    bool claimUpdate();
+    void releaseUpdate();
+
+    bool routeTransport(const uint8_t* data, size_t length);
+    bool routeImage(const uint8_t* data, size_t length);
+    bool writeImage(const uint8_t* data, size_t length);
+    bool flushSniffBuffers();
+    static bool sniff(uint8_t* buf, uint8_t& have, const uint8_t*& data, size_t& length);
+    static bool readRunningImage(uint32_t offset, uint8_t* buf, size_t length);
+
+#ifndef NATIVE_TEST
+    DownloadResult downloadOnce(const String& url, uint8_t* buf);
+    static void backgroundTask(void* param);
+#endif
 };
 
 #endif // SEASENSE_OTA_MANAGER_H
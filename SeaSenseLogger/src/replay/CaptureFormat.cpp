@@ -0,0 +1,186 @@
+/**
+ * SeaSense Logger - Capture File Format Implementation
+ */
+
+#include "CaptureFormat.h"
+#include <string.h>
+
+static void putU32(uint8_t* p, uint32_t v) {
+    p[0] = v & 0xFF;
+    p[1] = (v >> 8) & 0xFF;
+    p[2] = (v >> 16) & 0xFF;
+    p[3] = (v >> 24) & 0xFF;
+}
+
+static uint32_t getU32(const uint8_t* p) {
+    return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+// ============================================================================
+// Writer
+// ============================================================================
+
+CaptureWriter::CaptureWriter(uint8_t* buffer, size_t capacity)
+    : _buffer(buffer),
+      _capacity(capacity),
+      _size(0),
+      _lastMs(0)
+{
+}
+
+bool CaptureWriter::begin(unsigned long startMs) {
+    _size = 0;
+    if (_capacity < CAPTURE_HEADER_SIZE) {
+        return false;
+    }
+    memcpy(_buffer, CAPTURE_MAGIC, 5);
+    _buffer[5] = CAPTURE_VERSION;
+    _buffer[6] = 0;
+    _buffer[7] = 0;
+    putU32(_buffer + 8, (uint32_t)startMs);
+    _size = CAPTURE_HEADER_SIZE;
+    _lastMs = startMs;
+    return true;
+}
+
+bool CaptureWriter::append(CaptureType type, unsigned long now, const uint8_t* payload, uint16_t length) {
+    if (length > CAPTURE_MAX_PAYLOAD) {
+        return false;
+    }
+    uint32_t dt = (uint32_t)(now - _lastMs);
+    size_t needed = 1 + varintSize(dt) + varintSize(length) + length;
+    if (_size + needed > _capacity) {
+        return false;
+    }
+    _buffer[_size++] = (uint8_t)type;
+    putVarint(dt);
+    putVarint(length);
+    memcpy(_buffer + _size, payload, length);
+    _size += length;
+    _lastMs = now;
+    return true;
+}
+
+bool CaptureWriter::appendCanFrame(unsigned long now, uint32_t canId, const uint8_t* data, uint8_t len) {
+    uint8_t payload[12];
+    if (len > 8) len = 8;
+    putU32(payload, canId);
+    memcpy(payload + 4, data, len);
+    return append(CaptureType::CAN_FRAME, now, payload, 4 + len);
+}
+
+bool CaptureWriter::appendImuReport(unsigned long now, ImuReportKind kind, float a, float b, float c, float d) {
+    uint8_t payload[17];
+    payload[0] = (uint8_t)kind;
+    float v[4] = {a, b, c, d};
+    for (int i = 0; i < 4; i++) {
+        uint32_t bits;
+        memcpy(&bits, &v[i], 4);
+        putU32(payload + 1 + i * 4, bits);
+    }
+    return append(CaptureType::IMU_REPORT, now, payload, sizeof(payload));
+}
+
+uint8_t CaptureWriter::varintSize(uint32_t v) {
+    uint8_t n = 1;
+    while (v >= 0x80) {
+        v >>= 7;
+        n++;
+    }
+    return n;
+}
+
+void CaptureWriter::putVarint(uint32_t v) {
+    while (v >= 0x80) {
+        _buffer[_size++] = (uint8_t)(v | 0x80);
+        v >>= 7;
+    }
+    _buffer[_size++] = (uint8_t)v;
+}
+
+// ============================================================================
+// Reader
+// ============================================================================
+
+CaptureReader::CaptureReader(const uint8_t* data, size_t length)
+    : _data(data),
+      _length(length),
+      _pos(0),
+      _startMs(0),
+      _lastMs(0),
+      _truncated(false)
+{
+}
+
+bool CaptureReader::begin() {
+    _pos = 0;
+    _truncated = false;
+    if (_length < CAPTURE_HEADER_SIZE || memcmp(_data, CAPTURE_MAGIC, 5) != 0 ||
+        _data[5] != CAPTURE_VERSION) {
+        return false;
+    }
+    _startMs = getU32(_data + 8);
+    _lastMs = _startMs;
+    _pos = CAPTURE_HEADER_SIZE;
+    return true;
+}
+
+bool CaptureReader::next(CaptureRecord& record) {
+    if (_pos >= _length || _pos < CAPTURE_HEADER_SIZE) {
+        return false;
+    }
+    size_t start = _pos;
+    uint8_t type = _data[_pos++];
+    uint32_t dt = 0;
+    uint32_t len = 0;
+    if (!getVarint(dt) || !getVarint(len) || len > CAPTURE_MAX_PAYLOAD || _pos + len > _length) {
+        _truncated = true;
+        _pos = start;
+        return false;
+    }
+
+    _lastMs += dt;
+    record.type = (CaptureType)type;
+    record.timeMs = _lastMs;
+    record.payload = _data + _pos;
+    record.length = (uint16_t)len;
+    _pos += len;
+    return true;
+}
+
+bool CaptureReader::decodeCanFrame(const CaptureRecord& r, uint32_t& canId, uint8_t* data, uint8_t& len) {
+    if (r.type != CaptureType::CAN_FRAME || r.length < 4 || r.length > 12) {
+        return false;
+    }
+    canId = getU32(r.payload);
+    len = (uint8_t)(r.length - 4);
+    memcpy(data, r.payload + 4, len);
+    return true;
+}
+
+bool CaptureReader::decodeImuReport(const CaptureRecord& r, ImuReportKind& kind, float v[4]) {
+    if (r.type != CaptureType::IMU_REPORT || r.length != 17) {
+        return false;
+    }
+    kind = (ImuReportKind)r.payload[0];
+    for (int i = 0; i < 4; i++) {
+        uint32_t bits = getU32(r.payload + 1 + i * 4);
+        memcpy(&v[i], &bits, 4);
+    }
+    return true;
+}
+
+bool CaptureReader::getVarint(uint32_t& v) {
+    v = 0;
+    for (int shift = 0; shift < 35; shift += 7) {
+        if (_pos >= _length) {
+            return false;
+        }
+        uint8_t b = _data[_pos++];
+        v |= (uint32_t)(b & 0x7F) << shift;
+        if (!(b & 0x80)) {
+            return true;
+        }
+    }
+    return false;
+}
@@ -0,0 +1,125 @@
+/**
+ * SeaSense Logger - Capture File Format
+ *
+ * Compact, append-only record of raw sensor input streams, so a trip at sea
+ * can be replayed through the real parsers on a desk:
+ *
+ *   header:  "SSCAP" version(1) reserved(2) startMs(u32)
+ *   record:  type(1) dtMs(varint) length(varint) payload
+ *
+ * dtMs is relative to the previous record, so a 10 Hz stream costs one
+ * byte of timing per record. Payloads:
+ * - GPS_BYTES: raw NMEA0183 bytes as read from the UART
+ * - CAN_FRAME: id(u32) + data (0..8 bytes)
+ * - IMU_REPORT: kind(1) + 4 x float (rotation vector i,j,k,real or linear
+ *   acceleration x,y,z,-)
+ *
+ * All multi-byte fields little-endian. The writer fills a caller-provided
+ * buffer; the reader walks one in memory.
+ */
+
+#ifndef SEASENSE_CAPTURE_FORMAT_H
+#define SEASENSE_CAPTURE_FORMAT_H
+
+#include <Arduino.h>
+
+#define CAPTURE_MAGIC "SSCAP"
+#define CAPTURE_VERSION 1
+#define CAPTURE_HEADER_SIZE 12
+#define CAPTURE_MAX_PAYLOAD 255
+
+enum class CaptureType : uint8_t {
+    GPS_BYTES = 1,
+    CAN_FRAME = 2,
+    IMU_REPORT = 3
+};
+
+enum class ImuReportKind : uint8_t {
+    ROTATION_VECTOR = 1,
+    LINEAR_ACCELERATION = 2
+};
+
+struct CaptureRecord {
+    CaptureType type;
+    unsigned long timeMs;           // absolute, from the header's startMs
+    const uint8_t* payload;         // points into the reader's buffer
+    uint16_t length;
+};
+
+class CaptureWriter {
+public:
+    CaptureWriter(uint8_t* buffer, size_t capacity);
+
+    /**
+     * Start a new file: writes the header into the (empty) buffer
+     */
+    bool begin(unsigned long startMs);
+
+    /**
+     * Append one record
+     * @return false if it doesn't fit; flush and retry, or drop it
+     */
+    bool append(CaptureType type, unsigned long now, const uint8_t* payload, uint16_t length);
+
+    // Payload helpers
+    bool appendCanFrame(unsigned long now, uint32_t canId, const uint8_t* data, uint8_t len);
+    bool appendImuReport(unsigned long now, ImuReportKind kind, float a, float b, float c, float d);
+
+    const uint8_t* data() const { return _buffer; }
+    size_t size() const { return _size; }
+    size_t capacity() const { return _capacity; }
+
+    /**
+     * Buffer contents were written out; keep the timing chain going
+     */
+    void clearBuffer() { _size = 0; }
+
+private:
+    uint8_t* _buffer;
+    size_t _capacity;
+    size_t _size;
+    unsigned long _lastMs;
+
+    static uint8_t varintSize(uint32_t v);
+    void putVarint(uint32_t v);
+};
+
+class CaptureReader {
+public:
+    CaptureReader(const uint8_t* data, size_t length);
+
+    /**
+     * Validate the header
+     * @return false if this isn't a capture file (or an unknown version)
+     */
+    bool begin();
+
+    /**
+     * Next record
+     * @return false at the end of the data, or on a truncated record
+     */
+    bool next(CaptureRecord& record);
+
+    /**
+     * The data ended mid-record (power cut while writing)
+     */
+    bool isTruncated() const { return _truncated; }
+
+    unsigned long getStartMs() const { return _startMs; }
+
+    // Payload decoders
+    static bool decodeCanFrame(const CaptureRecord& r, uint32_t& canId, uint8_t* data, uint8_t& len);
+    static bool decodeImuReport(const CaptureRecord& r, ImuReportKind& kind, float v[4]);
+
+private:
+    const uint8_t* _data;
+    size_t _length;
+    size_t _pos;
+    unsigned long _startMs;
+    unsigned long _lastMs;
+    bool _truncated;
+
+    bool getVarint(uint32_t& v);
+};
+
+#endif // SEASENSE_CAPTURE_FORMAT_H
@@ -0,0 +1,161 @@
+/**
+ * SeaSense Logger - Capture Recorder Implementation
+ */
+
+#include "CaptureRecorder.h"
+#include "../../config/hardware_config.h"
+
+CaptureRecorder* CaptureRecorder::_active = nullptr;
+
+CaptureRecorder::CaptureRecorder()
+    : _buffer(nullptr),
+      _writer(nullptr),
+      _fileName(""),
+      _lastError(""),
+      _lastFlush(0),
+      _bytesWritten(0),
+      _records(0),
+      _dropped(0)
+{
+}
+
+CaptureRecorder::~CaptureRecorder() {
+    stop();
+}
+
+bool CaptureRecorder::start(unsigned long now) {
+    if (_active) {
+        _lastError = "Capture already running";
+        return false;
+    }
+
+    // Next free file name; the buffer is only held while capturing
+    SD.mkdir(CAPTURE_DIR);
+    char name[32];
+    bool found = false;
+    for (int i = 1; i <= 9999 && !found; i++) {
+        snprintf(name, sizeof(name), "%s/%04d.ssc", CAPTURE_DIR, i);
+        found = !SD.exists(name);
+    }
+    if (!found) {
+        _lastError = "No free capture file name";
+        return false;
+    }
+
+    _file = SD.open(name, FILE_WRITE);
+    if (!_file) {
+        _lastError = "Cannot create capture file (SD mounted?)";
+        return false;
+    }
+
+    _buffer = (uint8_t*)malloc(CAPTURE_BUFFER_SIZE);
+    if (!_buffer) {
+        _file.close();
+        _lastError = "Out of memory for capture buffer";
+        return false;
+    }
+    _writer = new CaptureWriter(_buffer, CAPTURE_BUFFER_SIZE);
+    _writer->begin(now);
+
+    _fileName = name;
+    _lastError = "";
+    _lastFlush = now;
+    _bytesWritten = 0;
+    _records = 0;
+    _dropped = 0;
+    _active = this;
+
+    Serial.print("[CAPTURE] Recording to ");
+    Serial.println(_fileName);
+    return true;
+}
+
+void CaptureRecorder::stop() {
+    if (!isActive()) {
+        return;
+    }
+    _active = nullptr;
+    flush();
+    release();
+
+    Serial.print("[CAPTURE] Stopped: ");
+    Serial.print(_records);
+    Serial.print(" records, ");
+    Serial.print(_bytesWritten);
+    Serial.print(" bytes, ");
+    Serial.print(_dropped);
+    Serial.println(" dropped");
+}
+
+void CaptureRecorder::process(unsigned long now) {
+    if (!isActive()) {
+        return;
+    }
+    bool halfFull = _writer->size() >= CAPTURE_BUFFER_SIZE / 2;
+    if (!halfFull && now - _lastFlush < CAPTURE_FLUSH_INTERVAL_MS) {
+        return;
+    }
+    _lastFlush = now;
+
+    if (!flush()) {
+        _lastError = "SD write failed";
+        Serial.println("[CAPTURE] SD write failed, stopping");
+        _active = nullptr;
+        release();
+        return;
+    }
+    if (_bytesWritten >= CAPTURE_MAX_FILE_BYTES) {
+        Serial.println("[CAPTURE] Size limit reached");
+        stop();
+    }
+}
+
+// ============================================================================
+// Private
+// ============================================================================
+
+void CaptureRecorder::recordGps(const uint8_t* data, size_t len) {
+    unsigned long now = millis();
+    while (len > 0) {
+        uint16_t chunk = len > CAPTURE_MAX_PAYLOAD ? CAPTURE_MAX_PAYLOAD : (uint16_t)len;
+        counted(_writer->append(CaptureType::GPS_BYTES, now, data, chunk));
+        data += chunk;
+        len -= chunk;
+    }
+}
+
+void CaptureRecorder::recordCan(uint32_t canId, const uint8_t* data, uint8_t len) {
+    counted(_writer->appendCanFrame(millis(), canId, data, len));
+}
+
+void CaptureRecorder::recordImu(ImuReportKind kind, float a, float b, float c, float d) {
+    counted(_writer->appendImuReport(millis(), kind, a, b, c, d));
+}
+
+void CaptureRecorder::counted(bool appended) {
+    if (appended) {
+        _records++;
+    } else {
+        _dropped++;
+    }
+}
+
+bool CaptureRecorder::flush() {
+    if (!_writer || _writer->size() == 0) {
+        return true;
+    }
+    size_t n = _writer->size();
+    size_t written = _file.write(_writer->data(), n);
+    _file.flush();
+    _writer->clearBuffer();
+    _bytesWritten += written;
+    return written == n;
+}
+
+void CaptureRecorder::release() {
+    _file.close();
+    delete _writer;
+    _writer = nullptr;
+    free(_buffer);
+    _buffer = nullptr;
+}
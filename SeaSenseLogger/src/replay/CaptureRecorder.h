@@ -0,0 +1,90 @@
+/**
+ * SeaSense Logger - Capture Recorder
+ *
+ * On-device capture mode: the GPS UART bytes, CAN frames and IMU reports the
+ * parsers see are appended to a CaptureFormat file on the SD card, for
+ * replay on the host (test/replay_capture.cpp).
+ * - Input drivers call the static hooks; they cost a pointer check when no
+ *   capture is running
+ * - Records go to a RAM buffer; process() writes it to SD from loop() when
+ *   half full or every CAPTURE_FLUSH_INTERVAL_MS
+ * - A record that doesn't fit in the buffer is dropped and counted, never
+ *   waited for, so capture can't change the timing it records
+ * - Stops by itself at CAPTURE_MAX_FILE_BYTES or on an SD error
+ *
+ * Hooks, process() and start/stop all run on the loop() core.
+ */
+
+#ifndef SEASENSE_CAPTURE_RECORDER_H
+#define SEASENSE_CAPTURE_RECORDER_H
+
+#include <Arduino.h>
+#include <SD.h>
+#include "CaptureFormat.h"
+
+class CaptureRecorder {
+public:
+    CaptureRecorder();
+    ~CaptureRecorder();
+
+    /**
+     * Open the next /capture/NNNN.ssc file and start recording
+     * @return false if SD is unavailable or a capture is already running
+     */
+    bool start(unsigned long now);
+
+    /**
+     * Flush and close the file
+     */
+    void stop();
+
+    /**
+     * Write buffered records when due. Call every loop() pass.
+     */
+    void process(unsigned long now);
+
+    bool isActive() const { return _active == this; }
+    String getFileName() const { return _fileName; }
+    uint32_t getBytesWritten() const { return _bytesWritten; }
+    uint32_t getRecordCount() const { return _records; }
+    uint32_t getDroppedCount() const { return _dropped; }
+    String getLastError() const { return _lastError; }
+
+    // ========================================================================
+    // Hooks for the input drivers (no-ops unless a capture is running)
+    // ========================================================================
+
+    static void gpsBytes(const uint8_t* data, size_t len) {
+        if (_active) _active->recordGps(data, len);
+    }
+
+    static void canFrame(uint32_t canId, const uint8_t* data, uint8_t len) {
+        if (_active) _active->recordCan(canId, data, len);
+    }
+
+    static void imuReport(ImuReportKind kind, float a, float b, float c, float d) {
+        if (_active) _active->recordImu(kind, a, b, c, d);
+    }
+
+private:
+    static CaptureRecorder* _active;
+
+    uint8_t* _buffer;
+    CaptureWriter* _writer;
+    File _file;
+    String _fileName;
+    String _lastError;
+    unsigned long _lastFlush;
+    uint32_t _bytesWritten;
+    uint32_t _records;
+    uint32_t _dropped;
+
+    void recordGps(const uint8_t* data, size_t len);
+    void recordCan(uint32_t canId, const uint8_t* data, uint8_t len);
+    void recordImu(ImuReportKind kind, float a, float b, float c, float d);
+    void counted(bool appended);
+    bool flush();
+    void release();
+};
+
+#endif // SEASENSE_CAPTURE_RECORDER_H
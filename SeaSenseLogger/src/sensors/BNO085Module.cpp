@@ -3,6 +3,7 @@
  */
 
 #include "BNO085Module.h"
+#include "../replay/CaptureRecorder.h"
 
 #ifndef NATIVE_TEST
 
@@ -53,22 +54,28 @@ void BNO085Module::update() {
 
     // Drain all pending events (non-blocking)
     while (_bno.getSensorEvent(&event)) {
+        float v[4];
+        ImuReportKind kind;
         switch (event.sensorId) {
-            case SH2_ROTATION_VECTOR: {
-                float qr = event.un.rotationVector.real;
-                float qi = event.un.rotationVector.i;
-                float qj = event.un.rotationVector.j;
-                float qk = event.un.rotationVector.k;
-                quaternionToEuler(qr, qi, qj, qk);
+            case SH2_ROTATION_VECTOR:
+                kind = ImuReportKind::ROTATION_VECTOR;
+                v[0] = event.un.rotationVector.i;
+                v[1] = event.un.rotationVector.j;
+                v[2] = event.un.rotationVector.k;
+                v[3] = event.un.rotationVector.real;
                 break;
-            }
-            case SH2_LINEAR_ACCELERATION: {
-                _linAccelX.set(event.un.linearAcceleration.x);
-                _linAccelY.set(event.un.linearAcceleration.y);
-                _linAccelZ.set(event.un.linearAcceleration.z);
+            case SH2_LINEAR_ACCELERATION:
+                kind = ImuReportKind::LINEAR_ACCELERATION;
+                v[0] = event.un.linearAcceleration.x;
+                v[1] = event.un.linearAcceleration.y;
+                v[2] = event.un.linearAcceleration.z;
+                v[3] = 0.0f;
                 break;
-            }
+            default:
+                continue;
         }
+        CaptureRecorder::imuReport(kind, v[0], v[1], v[2], v[3]);
+        ingestReport(kind, v);
     }
 
     // Periodically save Dynamic Calibration Data to BNO085 flash
@@ -87,6 +94,30 @@ void BNO085Module::saveDcdIfDue() {
     }
 }
 
+#else
+// Native build: no SH2 driver; reports arrive through ingestReport() (replay)
+BNO085Module::BNO085Module() : _initialized(false) {}
+bool BNO085Module::begin() { return false; }
+void BNO085Module::update() {}
+#endif
+
+// ============================================================================
+// Report handling and snapshots (shared with the native build)
+// ============================================================================
+
+void BNO085Module::ingestReport(ImuReportKind kind, const float v[4]) {
+    switch (kind) {
+        case ImuReportKind::ROTATION_VECTOR:
+            quaternionToEuler(v[3], v[0], v[1], v[2]);
+            break;
+        case ImuReportKind::LINEAR_ACCELERATION:
+            _linAccelX.set(v[0]);
+            _linAccelY.set(v[1]);
+            _linAccelZ.set(v[2]);
+            break;
+    }
+}
+
 void BNO085Module::quaternionToEuler(float qr, float qi, float qj, float qk) {
     // Convert quaternion to Euler angles (Tait-Bryan: yaw/pitch/roll)
     // Using aerospace convention: Z-Y-X rotation order
@@ -159,20 +190,3 @@ unsigned long BNO085Module::getAccelAgeMs() const {
     if (!_initialized) return ULONG_MAX;
     return _linAccelX.ageMs();  // X/Y/Z update together
 }
-
-#else
-// Native test stub — BNO085 cannot compile on Mac
-BNO085Module::BNO085Module() : _initialized(false) {}
-bool BNO085Module::begin() { return false; }
-void BNO085Module::update() {}
-IMUData BNO085Module::getSnapshot() const {
-    IMUData d;
-    d.pitch = NAN; d.roll = NAN; d.heading = NAN;
-    d.linAccelX = NAN; d.linAccelY = NAN; d.linAccelZ = NAN;
-    d.hasOrientation = false; d.hasLinAccel = false;
-    return d;
-}
-String BNO085Module::getStatusString() const { return "Native test stub"; }
-unsigned long BNO085Module::getOrientationAgeMs() const { return ULONG_MAX; }
-unsigned long BNO085Module::getAccelAgeMs() const { return ULONG_MAX; }
-#endif
@@ -15,6 +15,7 @@
 
 #include <Arduino.h>
 #include "../../config/hardware_config.h"
+#include "../replay/CaptureFormat.h"
 
 // Forward declarations — avoid pulling in full Adafruit headers in every
 // translation unit.  The .cpp includes the real headers.
@@ -28,18 +29,18 @@
  */
 struct IMUData {
     // Orientation (degrees)
-    float pitch;            // degrees (positive = bow up)
-    float roll;             // degrees (positive = starboard down)
-    float heading;          // degrees true (0-360)
+    float pitch = NAN;      // degrees (positive = bow up)
+    float roll = NAN;       // degrees (positive = starboard down)
+    float heading = NAN;    // degrees true (0-360)
 
     // Linear acceleration (m/s², gravity removed)
-    float linAccelX;
-    float linAccelY;
-    float linAccelZ;
+    float linAccelX = NAN;
+    float linAccelY = NAN;
+    float linAccelZ = NAN;
 
     // Validity
-    bool hasOrientation;
-    bool hasLinAccel;
+    bool hasOrientation = false;
+    bool hasLinAccel = false;
 };
 
 class BNO085Module {
@@ -80,10 +81,24 @@ public:
     unsigned long getOrientationAgeMs() const;
     unsigned long getAccelAgeMs() const;
 
+    /**
+     * Apply one sensor report (what update() does with each SH2 event).
+     * Also the entry point for replaying captured streams.
+     * @param v Rotation vector i, j, k, real — or linear acceleration x, y, z
+     */
+    void ingestReport(ImuReportKind kind, const float v[4]);
+
 private:
 #ifndef NATIVE_TEST
     Adafruit_BNO08x _bno;
 
+    static constexpr unsigned long DCD_SAVE_INTERVAL_MS = 300000;  // 5 minutes
+    unsigned long _lastDcdSaveMs;
+
+    bool enableReports();
+    void saveDcdIfDue();
+#endif
+
     struct CachedField {
         float value;
         unsigned long lastUpdateMs;
@@ -117,15 +132,9 @@ private:
     CachedField _linAccelY;
     CachedField _linAccelZ;
 
-    static constexpr unsigned long DCD_SAVE_INTERVAL_MS = 300000;  // 5 minutes
-    unsigned long _lastDcdSaveMs;
+    bool _initialized;
 
-    bool enableReports();
     void quaternionToEuler(float qr, float qi, float qj, float qk);
-    void saveDcdIfDue();
-#endif
-
-    bool _initialized;
 };
 
 #endif // BNO085_MODULE_H
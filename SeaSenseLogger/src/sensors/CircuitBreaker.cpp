@@ -0,0 +1,87 @@
+/**
+ * SeaSense Logger - Circuit Breaker Implementation
+ */
+
+#include "CircuitBreaker.h"
+
+CircuitBreaker::CircuitBreaker(uint8_t failureThreshold, unsigned long baseOpenMs, unsigned long maxOpenMs)
+    : _threshold(failureThreshold > 0 ? failureThreshold : 1),
+      _baseOpenMs(baseOpenMs),
+      _maxOpenMs(maxOpenMs),
+      _state(BreakerState::CLOSED),
+      _failures(0),
+      _openMs(baseOpenMs),
+      _openedAt(0),
+      _skipped(0),
+      _trips(0)
+{
+}
+
+bool CircuitBreaker::allowRequest(unsigned long now) {
+    switch (_state) {
+        case BreakerState::CLOSED:
+            return true;
+        case BreakerState::OPEN:
+            if (now - _openedAt >= _openMs) {
+                _state = BreakerState::HALF_OPEN;
+                return true;
+            }
+            _skipped++;
+            return false;
+        case BreakerState::HALF_OPEN:
+        default:
+            // One probe per open period; the result decides the next state
+            return true;
+    }
+}
+
+void CircuitBreaker::recordSuccess() {
+    _state = BreakerState::CLOSED;
+    _failures = 0;
+    _openMs = _baseOpenMs;
+}
+
+void CircuitBreaker::recordFailure(unsigned long now) {
+    if (_failures < 0xFF) _failures++;
+
+    if (_state == BreakerState::HALF_OPEN) {
+        // Probe failed: stay away twice as long
+        _openMs = (_openMs > _maxOpenMs / 2) ? _maxOpenMs : _openMs * 2;
+        open(now);
+    } else if (_state == BreakerState::CLOSED && _failures >= _threshold) {
+        open(now);
+    }
+}
+
+void CircuitBreaker::reset() {
+    _state = BreakerState::CLOSED;
+    _failures = 0;
+    _openMs = _baseOpenMs;
+}
+
+unsigned long CircuitBreaker::getRetryInMs(unsigned long now) const {
+    if (_state != BreakerState::OPEN) {
+        return 0;
+    }
+    unsigned long elapsed = now - _openedAt;
+    return (elapsed >= _openMs) ? 0 : _openMs - elapsed;
+}
+
+const char* CircuitBreaker::stateName(BreakerState state) {
+    switch (state) {
+        case BreakerState::CLOSED:    return "closed";
+        case BreakerState::OPEN:      return "open";
+        case BreakerState::HALF_OPEN: return "half_open";
+        default:                      return "unknown";
+    }
+}
+
+// ============================================================================
+// Private
+// ============================================================================
+
+void CircuitBreaker::open(unsigned long now) {
+    _state = BreakerState::OPEN;
+    _openedAt = now;
+    _trips++;
+}
@@ -0,0 +1,85 @@
+/**
+ * SeaSense Logger - Circuit Breaker
+ *
+ * Per-sensor failure isolation. An EZO module that ACKs its address but
+ * never answers costs a full hard timeout on every read; after a few of
+ * those in a row the breaker opens and reads are skipped outright:
+ * - CLOSED: reads go through, consecutive failures are counted
+ * - OPEN: reads are skipped until the open period expires
+ * - HALF_OPEN: one probe read; success closes the breaker, failure reopens
+ *   it for twice as long (capped)
+ *
+ * Skipped reads are counted separately from failed ones so a sick sensor
+ * shows up as "skipped" in the status page rather than as a stream of errors.
+ */
+
+#ifndef SEASENSE_CIRCUIT_BREAKER_H
+#define SEASENSE_CIRCUIT_BREAKER_H
+
+#include <Arduino.h>
+
+enum class BreakerState : uint8_t {
+    CLOSED = 0,
+    OPEN = 1,
+    HALF_OPEN = 2
+};
+
+class CircuitBreaker {
+public:
+    /**
+     * @param failureThreshold Consecutive failures that open the breaker
+     * @param baseOpenMs First open period
+     * @param maxOpenMs Cap for the doubling open period
+     */
+    CircuitBreaker(uint8_t failureThreshold, unsigned long baseOpenMs, unsigned long maxOpenMs);
+
+    /**
+     * Whether a read may be attempted now. An expired OPEN breaker moves to
+     * HALF_OPEN and lets one probe through; otherwise the skip is counted.
+     */
+    bool allowRequest(unsigned long now);
+
+    /**
+     * The attempted read succeeded
+     */
+    void recordSuccess();
+
+    /**
+     * The attempted read failed
+     */
+    void recordFailure(unsigned long now);
+
+    /**
+     * Close the breaker and forget the backoff (sensor re-initialised)
+     */
+    void reset();
+
+    BreakerState getState() const { return _state; }
+    uint8_t getConsecutiveFailures() const { return _failures; }
+    uint32_t getSkippedCount() const { return _skipped; }
+    uint32_t getTripCount() const { return _trips; }
+    unsigned long getOpenPeriodMs() const { return _openMs; }
+
+    /**
+     * Time until the next probe, 0 unless OPEN
+     */
+    unsigned long getRetryInMs(unsigned long now) const;
+
+    static const char* stateName(BreakerState state);
+
+private:
+    uint8_t _threshold;
+    unsigned long _baseOpenMs;
+    unsigned long _maxOpenMs;
+
+    BreakerState _state;
+    uint8_t _failures;              // consecutive
+    unsigned long _openMs;          // current open period
+    unsigned long _openedAt;
+    uint32_t _skipped;
+    uint32_t _trips;
+
+    void open(unsigned long now);
+};
+
+#endif // SEASENSE_CIRCUIT_BREAKER_H
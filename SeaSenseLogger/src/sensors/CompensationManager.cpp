@@ -0,0 +1,161 @@
+/**
+ * SeaSense Logger - Compensation Manager Implementation
+ */
+
+#include "CompensationManager.h"
+#include "../../config/hardware_config.h"
+#include <math.h>
+
+#ifndef NATIVE_TEST
+#include "EZO_EC.h"
+#include "EZO_pH.h"
+#include "EZO_DO.h"
+#endif
+
+CompensationManager::CompensationManager(EZO_EC* ecSensor, EZO_pH* phSensor, EZO_DO* doSensor)
+    : _ecSensor(ecSensor),
+      _phSensor(phSensor),
+      _doSensor(doSensor),
+      _resyncs(0),
+      _lastResync(0)
+{
+    for (int p = 0; p < (int)CompParam::COUNT; p++) {
+        _sent[p] = 0;
+        _skipped[p] = 0;
+        _failed[p] = 0;
+    }
+    invalidateAll();
+}
+
+void CompensationManager::applyTemperature(float tempC) {
+    resyncIfDue();
+    apply(CompTarget::EC, CompParam::TEMPERATURE, tempC);
+    apply(CompTarget::PH, CompParam::TEMPERATURE, tempC);
+    apply(CompTarget::DO, CompParam::TEMPERATURE, tempC);
+}
+
+void CompensationManager::applySalinity(float psu) {
+    apply(CompTarget::DO, CompParam::SALINITY, psu);
+}
+
+void CompensationManager::applyPressure(float kPa) {
+    apply(CompTarget::DO, CompParam::PRESSURE, kPa);
+}
+
+void CompensationManager::invalidate(CompTarget target) {
+    for (int p = 0; p < (int)CompParam::COUNT; p++) {
+        _slots[(int)target][p].valid = false;
+    }
+}
+
+void CompensationManager::invalidateAll() {
+    for (int t = 0; t < (int)CompTarget::COUNT; t++) {
+        invalidate((CompTarget)t);
+    }
+}
+
+float CompensationManager::getAcknowledged(CompTarget target, CompParam param) const {
+    const Slot& slot = _slots[(int)target][(int)param];
+    return slot.valid ? slot.value : NAN;
+}
+
+const char* CompensationManager::paramName(CompParam param) {
+    switch (param) {
+        case CompParam::TEMPERATURE: return "temperature";
+        case CompParam::SALINITY:    return "salinity";
+        case CompParam::PRESSURE:    return "pressure";
+        default:                     return "unknown";
+    }
+}
+
+// ============================================================================
+// Private
+// ============================================================================
+
+bool CompensationManager::apply(CompTarget target, CompParam param, float value) {
+    if (isnan(value) || !isTargetEnabled(target)) {
+        return false;
+    }
+
+    // Compare what the command would carry, not the raw reading, against
+    // what the device holds: slow drift accumulates until it matters
+    float q = quantize(param, value);
+    Slot& slot = _slots[(int)target][(int)param];
+    if (slot.valid && fabsf(q - slot.value) < hysteresis(param)) {
+        _skipped[(int)param]++;
+        return true;
+    }
+
+    if (!send(target, param, q)) {
+        slot.valid = false;
+        _failed[(int)param]++;
+        return false;
+    }
+    slot.value = q;
+    slot.valid = true;
+    _sent[(int)param]++;
+    return true;
+}
+
+void CompensationManager::resyncIfDue() {
+    unsigned long now = millis();
+    if (now - _lastResync >= COMP_RESYNC_INTERVAL_MS) {
+        _lastResync = now;
+        _resyncs++;
+        invalidateAll();
+    }
+}
+
+bool CompensationManager::isTargetEnabled(CompTarget target) const {
+#ifndef NATIVE_TEST
+    switch (target) {
+        // Nothing to gain from timing out on a module its breaker is skipping
+        case CompTarget::EC: return _ecSensor && _ecSensor->isEnabled() && !_ecSensor->isBreakerOpen();
+        case CompTarget::PH: return _phSensor && _phSensor->isEnabled() && !_phSensor->isBreakerOpen();
+        case CompTarget::DO: return _doSensor && _doSensor->isEnabled() && !_doSensor->isBreakerOpen();
+        default:             return false;
+    }
+#else
+    (void)target;
+    return true;
+#endif
+}
+
+bool CompensationManager::send(CompTarget target, CompParam param, float value) {
+#ifndef NATIVE_TEST
+    if (param == CompParam::TEMPERATURE) {
+        switch (target) {
+            case CompTarget::EC: return _ecSensor->setTemperatureCompensation(value);
+            case CompTarget::PH: return _phSensor->setTemperatureCompensation(value);
+            case CompTarget::DO: return _doSensor->setTemperatureCompensation(value);
+            default:             return false;
+        }
+    }
+    if (target != CompTarget::DO) {
+        return false;
+    }
+    return (param == CompParam::SALINITY)
+        ? _doSensor->setSalinityCompensation(value)
+        : _doSensor->setPressureCompensation(value);
+#else
+    (void)target;
+    (void)param;
+    (void)value;
+    return true;
+#endif
+}
+
+float CompensationManager::quantize(CompParam param, float value) {
+    // Resolution of the command strings: T,%.2f  S,%.2f  P,%.1f
+    float step = (param == CompParam::PRESSURE) ? 0.1f : 0.01f;
+    return roundf(value / step) * step;
+}
+
+float CompensationManager::hysteresis(CompParam param) {
+    switch (param) {
+        case CompParam::TEMPERATURE: return COMP_TEMP_HYSTERESIS_C;
+        case CompParam::SALINITY:    return COMP_SALINITY_HYSTERESIS_PSU;
+        case CompParam::PRESSURE:    return COMP_PRESSURE_HYSTERESIS_KPA;
+        default:                     return 0.0f;
+    }
+}
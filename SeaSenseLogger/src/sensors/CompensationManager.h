@@ -0,0 +1,108 @@
+/**
+ * SeaSense Logger - Compensation Manager
+ *
+ * Keeps EZO temperature/salinity/pressure compensation in sync without
+ * re-sending it every cycle:
+ * - Tracks the value each device last acknowledged
+ * - Sends a new T/S/P command only when the value moved past a
+ *   per-parameter hysteresis (each command is ~300 ms of blocking I2C)
+ * - Forgets what a device knows after a failed read, a bus reset or
+ *   re-init, and on a periodic resync, so a silently reset EZO (back to its
+ *   25 °C default) is corrected within one cycle
+ *
+ * Not thread-safe on its own: callers already hold g_i2cMutex for the
+ * sensor reads these commands belong to.
+ */
+
+#ifndef SEASENSE_COMPENSATION_MANAGER_H
+#define SEASENSE_COMPENSATION_MANAGER_H
+
+#include <Arduino.h>
+
+class EZO_EC;
+class EZO_pH;
+class EZO_DO;
+
+// Devices that take compensation values
+enum class CompTarget : uint8_t {
+    EC = 0,
+    PH = 1,
+    DO = 2,
+    COUNT = 3
+};
+
+enum class CompParam : uint8_t {
+    TEMPERATURE = 0,    // °C  — EC, pH, DO
+    SALINITY = 1,       // PSU — DO
+    PRESSURE = 2,       // kPa — DO
+    COUNT = 3
+};
+
+class CompensationManager {
+public:
+    CompensationManager(EZO_EC* ecSensor, EZO_pH* phSensor, EZO_DO* doSensor);
+
+    /**
+     * Temperature compensation for EC, pH and DO
+     */
+    void applyTemperature(float tempC);
+
+    /**
+     * Salinity compensation for DO (from the EC sensor)
+     */
+    void applySalinity(float psu);
+
+    /**
+     * Barometric pressure compensation for DO
+     */
+    void applyPressure(float kPa);
+
+    /**
+     * Forget what a device has acknowledged (failed read, possible reset)
+     */
+    void invalidate(CompTarget target);
+
+    /**
+     * Forget everything (bus reset, sensor re-init)
+     */
+    void invalidateAll();
+
+    /**
+     * Value the device last acknowledged, NAN if unknown
+     */
+    float getAcknowledged(CompTarget target, CompParam param) const;
+
+    // Statistics
+    uint32_t getSentCount(CompParam param) const { return _sent[(int)param]; }
+    uint32_t getSkippedCount(CompParam param) const { return _skipped[(int)param]; }
+    uint32_t getFailedCount(CompParam param) const { return _failed[(int)param]; }
+    uint32_t getResyncCount() const { return _resyncs; }
+
+    static const char* paramName(CompParam param);
+
+private:
+    struct Slot {
+        float value;
+        bool valid;
+    };
+
+    EZO_EC* _ecSensor;
+    EZO_pH* _phSensor;
+    EZO_DO* _doSensor;
+
+    Slot _slots[(int)CompTarget::COUNT][(int)CompParam::COUNT];
+    uint32_t _sent[(int)CompParam::COUNT];
+    uint32_t _skipped[(int)CompParam::COUNT];
+    uint32_t _failed[(int)CompParam::COUNT];
+    uint32_t _resyncs;
+    unsigned long _lastResync;
+
+    bool apply(CompTarget target, CompParam param, float value);
+    void resyncIfDue();
+    bool isTargetEnabled(CompTarget target) const;
+    bool send(CompTarget target, CompParam param, float value);
+    static float quantize(CompParam param, float value);
+    static float hysteresis(CompParam param);
+};
+
+#endif // SEASENSE_COMPENSATION_MANAGER_H
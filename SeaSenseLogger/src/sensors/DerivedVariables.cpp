@@ -0,0 +1,243 @@
+/**
+ * SeaSense Logger - Derived Variables Implementation
+ */
+
+#include "DerivedVariables.h"
+#include "../storage/StorageInterface.h"
+#include "../../config/hardware_config.h"
+#include <math.h>
+
+#ifndef M_PI
+#define M_PI 3.14159265358979323846
+#endif
+
+#define VAR_BIT(v) (1u << (int)(v))
+
+static const float STD_ATMOSPHERE_PA = 101325.0f;
+
+// Dependency graph in topological order: a node's deps are inputs or
+// outputs of nodes above it, so one pass settles everything
+const DerivedVariables::Node DerivedVariables::NODES[] = {
+    { DerivedVar::O2_SOLUBILITY,   VAR_BIT(DerivedVar::TEMPERATURE) | VAR_BIT(DerivedVar::SALINITY)
+                                | VAR_BIT(DerivedVar::BARO_PRESSURE) },
+    { DerivedVar::DO_SATURATION,   VAR_BIT(DerivedVar::DISSOLVED_OXYGEN) | VAR_BIT(DerivedVar::O2_SOLUBILITY) },
+    { DerivedVar::SOUND_SPEED,     VAR_BIT(DerivedVar::TEMPERATURE) | VAR_BIT(DerivedVar::SALINITY) },
+    { DerivedVar::TRUE_WIND_SPEED, VAR_BIT(DerivedVar::WIND_SPEED_APPARENT) | VAR_BIT(DerivedVar::WIND_ANGLE_APPARENT)
+                                | VAR_BIT(DerivedVar::SOG) | VAR_BIT(DerivedVar::COG) | VAR_BIT(DerivedVar::HEADING) },
+};
+const uint8_t DerivedVariables::NODE_COUNT = sizeof(NODES) / sizeof(NODES[0]);
+
+DerivedVariables::DerivedVariables()
+    : _dirty(0),
+      _current(0),
+      _computed(0),
+      _skipped(0)
+{
+    for (int v = 0; v < (int)DerivedVar::COUNT; v++) {
+        _value[v] = NAN;
+        _setMs[v] = 0;
+    }
+}
+
+void DerivedVariables::setInput(DerivedVar var, float value, unsigned long now) {
+    if (var >= DerivedVar::O2_SOLUBILITY) {
+        return;  // derived values are not inputs
+    }
+    _setMs[(int)var] = now;
+    _current |= VAR_BIT(var);
+    store(var, value);
+}
+
+void DerivedVariables::update(unsigned long now) {
+    // A reading from an earlier cycle (sensor read failed since) must not
+    // be combined with this cycle's values
+    for (int v = 0; v < (int)DerivedVar::O2_SOLUBILITY; v++) {
+        if (!isnan(_value[v]) && now - _setMs[v] > DERIVED_INPUT_MAX_AGE_MS) {
+            store((DerivedVar)v, NAN);
+        }
+    }
+
+    for (uint8_t n = 0; n < NODE_COUNT; n++) {
+        if (NODES[n].deps & _dirty) {
+            compute(NODES[n]);
+            _computed++;
+        } else {
+            _skipped++;
+        }
+    }
+    _dirty = 0;
+}
+
+void DerivedVariables::apply(DataRecord& record, unsigned long now) {
+    // Prefer the tilt-corrected apparent wind: it's the horizontal component
+    bool corrected = !isnan(record.windSpeedCorrected) && !isnan(record.windAngleCorrected);
+    setInput(DerivedVar::WIND_SPEED_APPARENT,
+             corrected ? record.windSpeedCorrected : record.windSpeedApparent, now);
+    setInput(DerivedVar::WIND_ANGLE_APPARENT,
+             corrected ? record.windAngleCorrected : record.windAngleApparent, now);
+    setInput(DerivedVar::BARO_PRESSURE, record.baroPressure, now);
+    setInput(DerivedVar::SOG, record.sog, now);
+    setInput(DerivedVar::COG, record.cogTrue, now);
+    setInput(DerivedVar::HEADING, record.heading, now);
+
+    update(now);
+
+    record.doSaturation = isCurrent(DerivedVar::DO_SATURATION) ? get(DerivedVar::DO_SATURATION) : NAN;
+    record.soundSpeed = isCurrent(DerivedVar::SOUND_SPEED) ? get(DerivedVar::SOUND_SPEED) : NAN;
+
+    // PGN 130306 true wind from the instruments wins over our estimate
+    if (isnan(record.windSpeedTrue) && !isnan(get(DerivedVar::TRUE_WIND_SPEED))) {
+        record.windSpeedTrue = get(DerivedVar::TRUE_WIND_SPEED);
+        record.windAngleTrue = get(DerivedVar::TRUE_WIND_ANGLE);
+    }
+}
+
+const char* DerivedVariables::varName(DerivedVar var) {
+    switch (var) {
+        case DerivedVar::TEMPERATURE:         return "temperature";
+        case DerivedVar::SALINITY:            return "salinity";
+        case DerivedVar::DISSOLVED_OXYGEN:    return "dissolved_oxygen";
+        case DerivedVar::BARO_PRESSURE:       return "baro_pressure";
+        case DerivedVar::WIND_SPEED_APPARENT: return "wind_speed_apparent";
+        case DerivedVar::WIND_ANGLE_APPARENT: return "wind_angle_apparent";
+        case DerivedVar::SOG:                 return "sog";
+        case DerivedVar::COG:                 return "cog";
+        case DerivedVar::HEADING:             return "heading";
+        case DerivedVar::O2_SOLUBILITY:       return "o2_solubility";
+        case DerivedVar::DO_SATURATION:       return "do_saturation";
+        case DerivedVar::SOUND_SPEED:         return "sound_speed";
+        case DerivedVar::TRUE_WIND_SPEED:     return "true_wind_speed";
+        case DerivedVar::TRUE_WIND_ANGLE:     return "true_wind_angle";
+        default:                              return "unknown";
+    }
+}
+
+// ============================================================================
+// Pure functions
+// ============================================================================
+
+float DerivedVariables::oxygenSolubility(float tempC, float salinityPsu, float pressurePa) {
+    if (isnan(tempC) || isnan(salinityPsu)) {
+        return NAN;
+    }
+    // Weiss (1970), air-saturated water at 1 atm, in ml/L
+    float tk = (tempC + 273.15f) / 100.0f;
+    float lnC = -173.4292f + 249.6339f / tk + 143.3483f * logf(tk) - 21.8492f * tk
+              + salinityPsu * (-0.033096f + 0.014259f * tk - 0.0017f * tk * tk);
+    float mgL = expf(lnC) * 1.42905f;
+
+    // No barometer: the DO probe assumes a standard atmosphere too
+    if (isnan(pressurePa)) {
+        pressurePa = STD_ATMOSPHERE_PA;
+    }
+    return mgL * pressurePa / STD_ATMOSPHERE_PA;
+}
+
+float DerivedVariables::soundSpeed(float tempC, float salinityPsu, float depthM) {
+    if (isnan(tempC) || isnan(salinityPsu) || isnan(depthM)) {
+        return NAN;
+    }
+    // Mackenzie (1981): 0-30 °C, 30-40 PSU, 0-8000 m
+    float t = tempC, s = salinityPsu - 35.0f, d = depthM;
+    return 1448.96f + 4.591f * t - 5.304e-2f * t * t + 2.374e-4f * t * t * t
+         + 1.340f * s + 1.630e-2f * d + 1.675e-7f * d * d
+         - 1.025e-2f * t * s - 7.139e-13f * t * d * d * d;
+}
+
+bool DerivedVariables::trueWind(float aws, float awa, float sog, float cog, float heading,
+                                float& tws, float& twa) {
+    if (isnan(aws) || isnan(awa) || isnan(sog) || isnan(cog) || isnan(heading)) {
+        tws = NAN;
+        twa = NAN;
+        return false;
+    }
+    const float degToRad = (float)(M_PI / 180.0);
+    const float radToDeg = (float)(180.0 / M_PI);
+
+    // Apparent wind (direction it comes from, earth frame) as a velocity
+    // vector, plus the boat's velocity over ground = wind over ground
+    float awd = (heading + awa) * degToRad;
+    float east  = -aws * sinf(awd) + sog * sinf(cog * degToRad);
+    float north = -aws * cosf(awd) + sog * cosf(cog * degToRad);
+
+    tws = sqrtf(east * east + north * north);
+    float twd = atan2f(-east, -north) * radToDeg;
+    twa = fmodf(twd - heading, 360.0f);
+    if (twa < 0.0f) twa += 360.0f;
+    return true;
+}
+
+// ============================================================================
+// Private
+// ============================================================================
+
+// Inputs a variable depends on, through any derived values in between
+uint32_t DerivedVariables::inputsOf(DerivedVar var) {
+    if (var < DerivedVar::O2_SOLUBILITY) {
+        return VAR_BIT(var);
+    }
+    if (var == DerivedVar::TRUE_WIND_ANGLE) {
+        var = DerivedVar::TRUE_WIND_SPEED;  // second output of the same node
+    }
+    for (uint8_t n = 0; n < NODE_COUNT; n++) {
+        if (NODES[n].first != var) {
+            continue;
+        }
+        uint32_t inputs = 0;
+        for (int v = 0; v < (int)DerivedVar::COUNT; v++) {
+            if (NODES[n].deps & VAR_BIT(v)) {
+                inputs |= inputsOf((DerivedVar)v);
+            }
+        }
+        return inputs;
+    }
+    return 0;
+}
+
+void DerivedVariables::compute(const Node& node) {
+    const float* v = _value;
+    switch (node.first) {
+        case DerivedVar::O2_SOLUBILITY:
+            store(DerivedVar::O2_SOLUBILITY,
+                  oxygenSolubility(v[(int)DerivedVar::TEMPERATURE], v[(int)DerivedVar::SALINITY],
+                                   v[(int)DerivedVar::BARO_PRESSURE]));
+            break;
+
+        case DerivedVar::DO_SATURATION: {
+            float sol = v[(int)DerivedVar::O2_SOLUBILITY];
+            float dox = v[(int)DerivedVar::DISSOLVED_OXYGEN];
+            store(DerivedVar::DO_SATURATION,
+                  (isnan(sol) || isnan(dox) || sol <= 0.0f) ? NAN : 100.0f * dox / sol);
+            break;
+        }
+
+        case DerivedVar::SOUND_SPEED:
+            store(DerivedVar::SOUND_SPEED,
+                  soundSpeed(v[(int)DerivedVar::TEMPERATURE], v[(int)DerivedVar::SALINITY],
+                             DERIVED_INTAKE_DEPTH_M));
+            break;
+
+        case DerivedVar::TRUE_WIND_SPEED: {
+            float tws, twa;
+            trueWind(v[(int)DerivedVar::WIND_SPEED_APPARENT], v[(int)DerivedVar::WIND_ANGLE_APPARENT],
+                     v[(int)DerivedVar::SOG], v[(int)DerivedVar::COG], v[(int)DerivedVar::HEADING],
+                     tws, twa);
+            store(DerivedVar::TRUE_WIND_SPEED, tws);
+            store(DerivedVar::TRUE_WIND_ANGLE, twa);
+            break;
+        }
+
+        default:
+            break;
+    }
+}
+
+void DerivedVariables::store(DerivedVar var, float value) {
+    float& slot = _value[(int)var];
+    bool same = (isnan(slot) && isnan(value)) || slot == value;
+    if (same) {
+        return;
+    }
+    slot = value;
+    _dirty |= VAR_BIT(var);
+}
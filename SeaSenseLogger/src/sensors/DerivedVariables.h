@@ -0,0 +1,126 @@
+/**
+ * SeaSense Logger - Derived Variables
+ *
+ * Quantities the logger has every input for, computed once on the write
+ * path instead of by every consumer:
+ * - Oxygen solubility (Weiss 1970, scaled to barometric pressure) and DO %
+ *   saturation from DO, temperature, salinity and baroPressure
+ * - Sound speed in seawater (Mackenzie 1981) at the intake depth
+ * - True wind from apparent wind, SOG, COG and heading, used when no
+ *   PGN 130306 true wind is on the bus
+ *
+ * Variables form a small dependency graph (static table, listed in
+ * topological order). setInput() marks an input dirty only when its value
+ * changed; update() recomputes just the nodes downstream of dirty inputs.
+ * All math is float on fixed slots: no allocation on the write path.
+ *
+ * Values are kept across measurement cycles (so unchanged inputs cost no
+ * recompute), but apply() only stamps a derived value whose inputs were
+ * all set since beginCycle(): a DO reading from an earlier cycle never
+ * lands on this cycle's records.
+ *
+ * Not thread-safe: used from loop() only.
+ */
+
+#ifndef SEASENSE_DERIVED_VARIABLES_H
+#define SEASENSE_DERIVED_VARIABLES_H
+
+#include <Arduino.h>
+
+struct DataRecord;
+
+// Inputs first, then derived values; a node only depends on earlier entries
+enum class DerivedVar : uint8_t {
+    // Inputs
+    TEMPERATURE = 0,        // °C (EZO-RTD)
+    SALINITY,               // PSU (as sent to the DO probe)
+    DISSOLVED_OXYGEN,       // mg/L
+    BARO_PRESSURE,          // Pa
+    WIND_SPEED_APPARENT,    // m/s (tilt-corrected when available)
+    WIND_ANGLE_APPARENT,    // degrees, 0 = bow
+    SOG,                    // m/s
+    COG,                    // degrees true
+    HEADING,                // degrees true
+    // Derived
+    O2_SOLUBILITY,          // mg/L at the current pressure
+    DO_SATURATION,          // %
+    SOUND_SPEED,            // m/s
+    TRUE_WIND_SPEED,        // m/s
+    TRUE_WIND_ANGLE,        // degrees, 0 = bow, 0-360
+    COUNT
+};
+
+class DerivedVariables {
+public:
+    DerivedVariables();
+
+    /**
+     * Start a measurement cycle: inputs read before now no longer count
+     * as current for apply()
+     */
+    void beginCycle() { _current = 0; }
+
+    /**
+     * Set an input. Only a changed value marks it dirty.
+     * @param now millis() of the reading; inputs older than
+     *        DERIVED_INPUT_MAX_AGE_MS are dropped by update()
+     */
+    void setInput(DerivedVar var, float value, unsigned long now);
+
+    /**
+     * Expire stale inputs and recompute the nodes downstream of any
+     * dirty input, in dependency order
+     */
+    void update(unsigned long now);
+
+    /**
+     * Current value of any variable (NAN if unavailable)
+     */
+    float get(DerivedVar var) const { return _value[(int)var]; }
+
+    /**
+     * True if every input var depends on was set in this cycle
+     */
+    bool isCurrent(DerivedVar var) const { return (inputsOf(var) & ~_current) == 0; }
+
+    /**
+     * Take the record's environmental inputs, update, and stamp the
+     * derived values onto it (NAN where an input is not current). True
+     * wind is only filled in when the record has none from the bus.
+     */
+    void apply(DataRecord& record, unsigned long now);
+
+    // Statistics
+    uint32_t getComputeCount() const { return _computed; }
+    uint32_t getSkipCount() const { return _skipped; }
+
+    static const char* varName(DerivedVar var);
+
+    // Pure functions (NAN in, NAN out)
+    static float oxygenSolubility(float tempC, float salinityPsu, float pressurePa);
+    static float soundSpeed(float tempC, float salinityPsu, float depthM);
+    static bool trueWind(float aws, float awa, float sog, float cog, float heading,
+                         float& tws, float& twa);
+
+private:
+    struct Node {
+        DerivedVar first;       // first output (true wind fills speed and angle)
+        uint32_t deps;          // bit per DerivedVar
+    };
+
+    static const Node NODES[];
+    static const uint8_t NODE_COUNT;
+
+    float _value[(int)DerivedVar::COUNT];
+    unsigned long _setMs[(int)DerivedVar::COUNT];
+    uint32_t _dirty;
+    uint32_t _current;          // inputs set since beginCycle()
+    uint32_t _computed;
+    uint32_t _skipped;
+
+    static uint32_t inputsOf(DerivedVar var);
+    void compute(const Node& node);
+    void store(DerivedVar var, float value);
+};
+
+#endif // SEASENSE_DERIVED_VARIABLES_H
@@ -54,7 +54,11 @@ EZOSensor::EZOSensor(
       _valid(false),
       _quality(SensorQuality::NOT_CALIBRATED),
       _firmwareVersion(""),
-      _deviceInfo("")
+      _deviceInfo(""),
+      _breaker(EZO_BREAKER_FAILURE_THRESHOLD, EZO_BREAKER_BASE_OPEN_MS, EZO_BREAKER_MAX_OPEN_MS),
+      _skipped(false),
+      _readPending(false),
+      _pendingBreakerState(BreakerState::CLOSED)
 {
 }
 
@@ -95,6 +99,9 @@ bool EZOSensor::begin() {
         }
     }
 
+    // A sensor that answers a re-init gets a fresh breaker
+    _breaker.reset();
+
     DEBUG_SENSOR_PRINTLN("Sensor initialized successfully");
     return true;
 }
@@ -105,6 +112,91 @@ bool EZOSensor::read() {
         return false;
     }
 
+    if (!admitRead()) {
+        return false;
+    }
+
+    BreakerState before = _breaker.getState();
+    bool ok = readFromDevice();
+    recordReadResult(ok, before);
+    return ok;
+}
+
+bool EZOSensor::requestRead() {
+    _readPending = false;
+    if (!_enabled) {
+        DEBUG_SENSOR_PRINTLN("Sensor is disabled");
+        return false;
+    }
+
+    if (!admitRead()) {
+        return false;
+    }
+
+    BreakerState before = _breaker.getState();
+    if (!writeI2C("R")) {
+        DEBUG_SENSOR_PRINTLN("Failed to write read command");
+        _valid = false;
+        _quality = SensorQuality::ERROR;
+        recordReadResult(false, before);
+        return false;
+    }
+
+    _readPending = true;
+    _pendingBreakerState = before;
+    return true;
+}
+
+bool EZOSensor::collectRead() {
+    if (!_readPending) {
+        return false;
+    }
+    _readPending = false;
+
+    String response;
+    EZOResponseCode code = readResponse(response);
+    bool ok = storeReading(code, response);
+    recordReadResult(ok, _pendingBreakerState);
+    return ok;
+}
+
+// Circuit breaker: a module that keeps timing out is skipped for a while
+// instead of costing EZO_HARD_TIMEOUT_MS every cycle
+bool EZOSensor::admitRead() {
+    _skipped = false;
+    if (!_breaker.allowRequest(millis())) {
+        DEBUG_SENSOR_PRINTLN("Read skipped (breaker open)");
+        _skipped = true;
+        _valid = false;
+        _quality = SensorQuality::ERROR;
+        return false;
+    }
+    return true;
+}
+
+void EZOSensor::recordReadResult(bool ok, BreakerState before) {
+    if (ok) {
+        _breaker.recordSuccess();
+    } else {
+        _breaker.recordFailure(millis());
+    }
+
+    if (_breaker.getState() != before) {
+        Serial.print("[BREAKER] ");
+        Serial.print(_sensorModel);
+        if (_breaker.getState() == BreakerState::OPEN) {
+            Serial.print(" open for ");
+            Serial.print(_breaker.getOpenPeriodMs() / 1000);
+            Serial.print(" s after ");
+            Serial.print(_breaker.getConsecutiveFailures());
+            Serial.println(" consecutive failures");
+        } else {
+            Serial.println(" closed, sensor responding again");
+        }
+    }
+}
+
+bool EZOSensor::readFromDevice() {
     if (!isPresent()) {
         DEBUG_SENSOR_PRINTLN("Sensor not present");
         _valid = false;
@@ -115,7 +207,10 @@ bool EZOSensor::read() {
     // Send read command
     String response;
     EZOResponseCode code = sendCommand("R", response, _responseTimeMs);
+    return storeReading(code, response);
+}
 
+bool EZOSensor::storeReading(EZOResponseCode code, const String& response) {
     if (code != EZOResponseCode::SUCCESS) {
         DEBUG_SENSOR_PRINT("Read failed with code: ");
         DEBUG_SENSOR_PRINTLN((int)code);
@@ -239,6 +334,8 @@ String EZOSensor::getStatusString() const {
 
     if (!_enabled) {
         status += "DISABLED";
+    } else if (isBreakerOpen()) {
+        status += "SKIPPED (breaker open)";
     } else if (!_valid) {
         status += "ERROR";
     } else {
@@ -292,7 +389,10 @@ EZOResponseCode EZOSensor::sendCommand(
         }
     }
 
-    // Read response
+    return readResponse(response);
+}
+
+EZOResponseCode EZOSensor::readResponse(String& response) {
     char buffer[64];
     int bytesRead = readI2C(buffer, sizeof(buffer));
 
@@ -23,6 +23,7 @@
 #include <Wire.h>
 #include <time.h>
 #include "SensorInterface.h"
+#include "CircuitBreaker.h"
 
 /**
  * EZO sensor response codes
@@ -97,6 +98,21 @@ public:
         uint16_t waitTime = 0
     );
 
+    /**
+     * Split-phase read, first half: send "R" and return without waiting,
+     * so several modules can convert at the same time. Collect the result
+     * with collectRead() once getResponseTime() has passed. Breaker and
+     * validity are handled as in read().
+     * @return false if disabled, skipped by the breaker or the write failed
+     */
+    bool requestRead();
+
+    /**
+     * Split-phase read, second half: fetch and parse the response
+     * @return true if a valid reading was stored
+     */
+    bool collectRead();
+
     /**
      * Get device information (firmware version, etc.)
      * Sends "I" command
@@ -170,6 +186,27 @@ public:
      */
     uint16_t getResponseTime() const { return _responseTimeMs; }
 
+    /**
+     * Whether the last read() was skipped by the circuit breaker rather
+     * than attempted (and failed)
+     */
+    bool wasSkipped() const { return _skipped; }
+
+    /**
+     * Per-sensor circuit breaker state and counters
+     */
+    const CircuitBreaker& getBreaker() const { return _breaker; }
+
+    /**
+     * Breaker open and its probe not yet due: the next read() will be skipped
+     */
+    bool isBreakerOpen() const { return _breaker.getRetryInMs(millis()) > 0; }
+
+    /**
+     * Close the breaker (operator-driven reads, e.g. calibration)
+     */
+    void resetBreaker() { _breaker.reset(); }
+
 protected:
     // ========================================================================
     // Protected members for derived classes
@@ -227,6 +264,35 @@ protected:
     static time_t _systemEpoch;
 
 private:
+    CircuitBreaker _breaker;       // Skips reads of a repeatedly failing module
+    bool _skipped;                 // Last read() skipped by the breaker
+    bool _readPending;             // requestRead() sent, collectRead() not yet called
+    BreakerState _pendingBreakerState;
+
+    /**
+     * Breaker gate shared by read() and requestRead(); marks a skip
+     * @return true if a read may be attempted
+     */
+    bool admitRead();
+
+    /**
+     * Record a read attempt with the breaker, logging state changes
+     * @param before Breaker state when the attempt was admitted
+     */
+    void recordReadResult(bool ok, BreakerState before);
+
+    /**
+     * Parse and store the response to "R"
+     * @return true if a valid reading was stored
+     */
+    bool storeReading(EZOResponseCode code, const String& response);
+
+    /**
+     * One attempted read: presence check, "R" command, parse, quality
+     * @return true if a valid reading was stored
+     */
+    bool readFromDevice();
+
     // ========================================================================
     // Private I2C communication methods
     // ========================================================================
@@ -246,6 +312,13 @@ private:
      */
     int readI2C(char* buffer, size_t maxLength);
 
+    /**
+     * Read and split a pending response (code byte + text)
+     * @param response String to store the text
+     * @return Response code
+     */
+    EZOResponseCode readResponse(String& response);
+
     /**
      * Parse response code from first byte
      * @param responseByte First byte of response
@@ -33,7 +33,7 @@ enum class DOCalibrationType {
     ZERO          // Zero calibration (probe in 0 DO solution)
 };
 
-class EZO_DO : public EZOSensor {
+class EZO_DO final : public EZOSensor {
 public:
     /**
      * Constructor
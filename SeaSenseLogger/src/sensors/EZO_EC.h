@@ -35,7 +35,7 @@ enum class ECCalibrationType {
     TWO_POINT    // Two point calibration (low + high)
 };
 
-class EZO_EC : public EZOSensor {
+class EZO_EC final : public EZOSensor {
 public:
     /**
      * Constructor
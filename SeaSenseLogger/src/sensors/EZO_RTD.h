@@ -18,7 +18,7 @@
 #include "EZOSensor.h"
 #include "../../config/hardware_config.h"
 
-class EZO_RTD : public EZOSensor {
+class EZO_RTD final : public EZOSensor {
 public:
     /**
      * Constructor
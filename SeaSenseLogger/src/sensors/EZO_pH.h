@@ -34,7 +34,7 @@ enum class pHCalibrationType {
     THREE_POINT        // Full three point calibration
 };
 
-class EZO_pH : public EZOSensor {
+class EZO_pH final : public EZOSensor {
 public:
     /**
      * Constructor
@@ -3,6 +3,7 @@
  */
 
 #include "GPSModule.h"
+#include "../replay/CaptureRecorder.h"
 
 // ============================================================================
 // Constructor
@@ -56,13 +57,15 @@ void GPSModule::update() {
         return;
     }
 
-    // Process all available GPS data
+    // Process all available GPS data, in chunks so capture sees what we see
+    uint8_t buf[64];
     while (_serial->available() > 0) {
-        char c = _serial->read();
-        if (_gps.encode(c)) {
-            // New data available
-            updateData();
+        size_t n = 0;
+        while (n < sizeof(buf) && _serial->available() > 0) {
+            buf[n++] = (uint8_t)_serial->read();
         }
+        CaptureRecorder::gpsBytes(buf, n);
+        feed(buf, n);
     }
 
     // Check if GPS data is stale (no updates for 2 seconds)
@@ -71,6 +74,15 @@ void GPSModule::update() {
     }
 }
 
+void GPSModule::feed(const uint8_t* data, size_t len) {
+    for (size_t i = 0; i < len; i++) {
+        if (_gps.encode((char)data[i])) {
+            // New data available
+            updateData();
+        }
+    }
+}
+
 bool GPSModule::hasValidFix() const {
     return _data.valid &&
            _gps.location.isValid() &&
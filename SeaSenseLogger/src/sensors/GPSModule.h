@@ -55,6 +55,12 @@ public:
      */
     void update();
 
+    /**
+     * Parse raw NMEA bytes (what update() does with the UART input).
+     * Also the entry point for replaying captured streams.
+     */
+    void feed(const uint8_t* data, size_t len);
+
     /**
      * Check if GPS has valid fix
      * @return true if position and time are valid
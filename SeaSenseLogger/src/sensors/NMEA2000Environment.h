@@ -40,45 +40,45 @@
  */
 struct N2kEnvironmentData {
     // Wind
-    float windSpeedTrue;        // m/s (NaN if unavailable)
-    float windAngleTrue;        // degrees (NaN if unavailable)
-    float windSpeedApparent;    // m/s (NaN if unavailable)
-    float windAngleApparent;    // degrees (NaN if unavailable)
+    float windSpeedTrue = NAN;  // m/s (NaN if unavailable)
+    float windAngleTrue = NAN;  // degrees (NaN if unavailable)
+    float windSpeedApparent = NAN; // m/s (NaN if unavailable)
+    float windAngleApparent = NAN; // degrees (NaN if unavailable)
 
     // Water
-    float waterDepth;           // meters below transducer (NaN if unavailable)
-    float depthOffset;          // transducer offset in meters (NaN if unavailable)
-    float speedThroughWater;    // m/s (NaN if unavailable)
+    float waterDepth = NAN;     // meters below transducer (NaN if unavailable)
+    float depthOffset = NAN;    // transducer offset in meters (NaN if unavailable)
+    float speedThroughWater = NAN; // m/s (NaN if unavailable)
 
     // Temperature (from boat instruments, not EZO)
-    float waterTempExternal;    // °C from transducer (NaN if unavailable)
-    float airTemp;              // °C (NaN if unavailable)
+    float waterTempExternal = NAN; // °C from transducer (NaN if unavailable)
+    float airTemp = NAN;        // °C (NaN if unavailable)
 
     // Atmosphere
-    float baroPressure;         // Pascals (NaN if unavailable)
-    float humidity;             // % relative (NaN if unavailable)
+    float baroPressure = NAN;   // Pascals (NaN if unavailable)
+    float humidity = NAN;       // % relative (NaN if unavailable)
 
     // Navigation
-    float cogTrue;              // degrees (NaN if unavailable)
-    float sog;                  // m/s (NaN if unavailable)
-    float heading;              // degrees true (NaN if unavailable)
+    float cogTrue = NAN;        // degrees (NaN if unavailable)
+    float sog = NAN;            // m/s (NaN if unavailable)
+    float heading = NAN;        // degrees true (NaN if unavailable)
 
     // Attitude
-    float pitch;                // degrees (NaN if unavailable)
-    float roll;                 // degrees (NaN if unavailable)
-    float yaw;                  // degrees (NaN if unavailable)
+    float pitch = NAN;          // degrees (NaN if unavailable)
+    float roll = NAN;           // degrees (NaN if unavailable)
+    float yaw = NAN;            // degrees (NaN if unavailable)
 
     // Validity flags
-    bool hasWind;
-    bool hasDepth;
-    bool hasSpeedThroughWater;
-    bool hasWaterTempExternal;
-    bool hasAirTemp;
-    bool hasBaroPressure;
-    bool hasHumidity;
-    bool hasCOGSOG;
-    bool hasHeading;
-    bool hasAttitude;
+    bool hasWind = false;
+    bool hasDepth = false;
+    bool hasSpeedThroughWater = false;
+    bool hasWaterTempExternal = false;
+    bool hasAirTemp = false;
+    bool hasBaroPressure = false;
+    bool hasHumidity = false;
+    bool hasCOGSOG = false;
+    bool hasHeading = false;
+    bool hasAttitude = false;
 };
 
 class NMEA2000Environment {
@@ -7,6 +7,7 @@
 
 #include "NMEA2000GPS.h"
 #include "../../config/hardware_config.h"
+#include "../replay/CaptureRecorder.h"
 #include "driver/twai.h"
 
 // ============================================================================
@@ -16,8 +17,15 @@
 
 class tNMEA2000_ESP32TWAI : public tNMEA2000 {
 public:
-    tNMEA2000_ESP32TWAI(int txPin, int rxPin)
-        : _txPin(txPin), _rxPin(rxPin), _open(false) {}
+    tNMEA2000_ESP32TWAI(int txPin, int rxPin, bool transmit)
+        : _txPin(txPin), _rxPin(rxPin), _transmit(transmit), _open(false) {}
+
+    /**
+     * Queue a raw frame for our own transmit scheduler; never waits
+     */
+    bool sendRawFrame(unsigned long id, unsigned char len, const unsigned char *buf) {
+        return CANSendFrame(id, len, buf, false);
+    }
 
     ~tNMEA2000_ESP32TWAI() {
         if (_open) {
@@ -29,9 +37,10 @@ public:
 protected:
     bool CANOpen() override {
         twai_general_config_t g_config = TWAI_GENERAL_CONFIG_DEFAULT(
-            (gpio_num_t)_txPin, (gpio_num_t)_rxPin, TWAI_MODE_LISTEN_ONLY);
+            (gpio_num_t)_txPin, (gpio_num_t)_rxPin,
+            _transmit ? TWAI_MODE_NORMAL : TWAI_MODE_LISTEN_ONLY);
         g_config.rx_queue_len = 32;
-        g_config.tx_queue_len = 0;
+        g_config.tx_queue_len = _transmit ? N2K_TX_HW_QUEUE_LEN : 0;
 
         twai_timing_config_t t_config = TWAI_TIMING_CONFIG_250KBITS();
         twai_filter_config_t f_config = TWAI_FILTER_CONFIG_ACCEPT_ALL();
@@ -49,8 +58,15 @@ protected:
 
     bool CANSendFrame(unsigned long id, unsigned char len,
                       const unsigned char *buf, bool wait_sent) override {
-        (void)id; (void)len; (void)buf; (void)wait_sent;
-        return false;  // listen-only: no transmit
+        (void)wait_sent;
+        if (!_open || !_transmit) return false;  // listen-only: no transmit
+        twai_message_t msg = {};
+        msg.extd = 1;
+        msg.identifier = id;
+        msg.data_length_code = len > 8 ? 8 : len;
+        memcpy(msg.data, buf, msg.data_length_code);
+        // Zero ticks: a full queue is the caller's problem, never the loop's
+        return twai_transmit(&msg, 0) == ESP_OK;
     }
 
     bool CANGetFrame(unsigned long &id, unsigned char &len,
@@ -61,12 +77,14 @@ protected:
         id = msg.identifier;
         len = msg.data_length_code;
         memcpy(buf, msg.data, len);
+        CaptureRecorder::canFrame(id, buf, len);
         return true;
     }
 
 private:
     int _txPin;
     int _rxPin;
+    bool _transmit;
     bool _open;
 };
 
@@ -82,7 +100,9 @@ NMEA2000GPS* NMEA2000GPS::_instance = nullptr;
 
 NMEA2000GPS::NMEA2000GPS()
     : _n2k(nullptr),
+      _twai(nullptr),
       _initialized(false),
+      _transmit(false),
       _lastUpdateMs(0),
       _hasPosition(false),
       _hasTime(false),
@@ -101,17 +121,19 @@ NMEA2000GPS::~NMEA2000GPS() {
 // Initialization
 // ============================================================================
 
-bool NMEA2000GPS::begin() {
+bool NMEA2000GPS::begin(bool transmit) {
     _instance = this;
+    _transmit = transmit;
 
-    _n2k = new tNMEA2000_ESP32TWAI(CAN_TX_PIN, CAN_RX_PIN);
+    _twai = new tNMEA2000_ESP32TWAI(CAN_TX_PIN, CAN_RX_PIN, transmit);
+    _n2k = _twai;
 
     _n2k->SetProductInformation(
-        "SEASENSE-001",    // Model serial code
-        1,                  // Product code
-        "SeaSense Logger", // Model ID
-        "2.0.0",           // Software version
-        "1.0"              // Hardware version
+        N2K_MODEL_SERIAL,       // Model serial code
+        N2K_PRODUCT_CODE,       // Product code
+        N2K_MODEL_ID,           // Model ID
+        N2K_SOFTWARE_VERSION,   // Software version
+        N2K_HARDWARE_VERSION    // Hardware version
     );
 
     _n2k->SetDeviceInformation(
@@ -121,7 +143,15 @@ bool NMEA2000GPS::begin() {
         2040   // Manufacturer code
     );
 
-    _n2k->SetMode(tNMEA2000::N2km_ListenOnly);
+    if (transmit) {
+        // Node mode: the library claims an address and answers ISO requests;
+        // our PGNs go out through N2kTxScheduler using that address
+        _n2k->SetMode(tNMEA2000::N2km_ListenAndNode, N2K_PREFERRED_ADDRESS);
+        const unsigned long txPGNs[] = {130312L, 130316L, 130321L, 0};
+        _n2k->ExtendTransmitMessages(txPGNs);
+    } else {
+        _n2k->SetMode(tNMEA2000::N2km_ListenOnly);
+    }
     _n2k->EnableForward(false);
 
     const unsigned long rxPGNs[] = {129029L, 126992L, 129025L, 0};
@@ -133,11 +163,13 @@ bool NMEA2000GPS::begin() {
         Serial.println("[N2K] Failed to open CAN bus (check wiring on CAN_TX/RX pins)");
         delete _n2k;
         _n2k = nullptr;
+        _twai = nullptr;
         return false;
     }
 
     _initialized = true;
-    Serial.println("[N2K] CAN bus opened in listen-only mode (250kbps)");
+    Serial.println(transmit ? "[N2K] CAN bus opened in node mode (250kbps)"
+                            : "[N2K] CAN bus opened in listen-only mode (250kbps)");
     return true;
 }
 
@@ -158,6 +190,20 @@ void NMEA2000GPS::update() {
 // Public Accessors
 // ============================================================================
 
+bool NMEA2000GPS::sendFrame(uint32_t canId, const uint8_t* data, uint8_t len) {
+    if (!isTransmitReady()) return false;
+    return _twai->sendRawFrame(canId, len, data);
+}
+
+uint8_t NMEA2000GPS::getSourceAddress() const {
+    return _n2k ? _n2k->GetN2kSource() : N2K_BROADCAST;
+}
+
+bool NMEA2000GPS::isTransmitReady() const {
+    // 254 = "cannot claim": every address we tried was taken
+    return _initialized && _transmit && _twai && _n2k->GetN2kSource() < 252;
+}
+
 bool NMEA2000GPS::hasValidFix() const {
     return _data.valid;
 }
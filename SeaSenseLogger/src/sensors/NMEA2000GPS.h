@@ -8,6 +8,10 @@
  * Uses ESP32 built-in TWAI controller (driver/twai.h) directly, compatible
  * with ESP32 Arduino SDK 3.x / ESP-IDF 5.x. No NMEA2000_esp32 library needed.
  *
+ * Owns the CAN bus. Opened listen-only unless NMEA2000 output is enabled at
+ * boot; then it joins the bus as a node and serves as the N2kCanBus for the
+ * outbound transmit scheduler.
+ *
  * PGNs handled:
  * - PGN 129029: GNSS Position Data (primary - lat/lon/alt/time/sats/HDOP)
  * - PGN 126992: System Time (time backup when 129029 not available)
@@ -23,13 +27,16 @@
 #include <Arduino.h>
 #include <time.h>
 #include "GPSModule.h"  // reuse GPSData struct
+#include "../n2k/N2kTxScheduler.h"
 #include <NMEA2000.h>
 #include <N2kMessages.h>
 
 // Staleness threshold - mark data invalid if no update for this long
 #define N2K_GPS_STALE_MS 5000
 
-class NMEA2000GPS {
+class tNMEA2000_ESP32TWAI;
+
+class NMEA2000GPS : public N2kCanBus {
 public:
     /**
      * Constructor
@@ -40,10 +47,12 @@ public:
     ~NMEA2000GPS();
 
     /**
-     * Initialize CAN bus in listen-only mode
+     * Initialize CAN bus
+     * @param transmit Join the bus as a node (address claim, outbound PGNs);
+     *                 false keeps it listen-only
      * @return true if CAN bus opened successfully
      */
-    bool begin();
+    bool begin(bool transmit = false);
 
     /**
      * Process pending CAN messages
@@ -95,10 +104,20 @@ public:
     typedef void (*MsgForwardCallback)(const tN2kMsg& msg);
     void setMsgForwardCallback(MsgForwardCallback cb) { _forwardCallback = cb; }
 
+    // ========================================================================
+    // N2kCanBus (outbound frames from N2kTxScheduler)
+    // ========================================================================
+
+    bool sendFrame(uint32_t canId, const uint8_t* data, uint8_t len) override;
+    uint8_t getSourceAddress() const override;
+    bool isTransmitReady() const override;
+
 private:
     tNMEA2000* _n2k;  // owned NMEA2000 instance using custom TWAI driver
+    tNMEA2000_ESP32TWAI* _twai;  // same object, for raw frame transmit
     GPSData _data;
     bool _initialized;
+    bool _transmit;
     unsigned long _lastUpdateMs;
 
     bool _hasPosition;
@@ -0,0 +1,270 @@
+/**
+ * SeaSense Logger - Quality Control Implementation
+ */
+
+#include "QualityControl.h"
+#include "../../config/hardware_config.h"
+#include <math.h>
+
+// Per-channel limits. Fail ranges are what seawater can physically read;
+// suspect ranges match the "typical seawater" checks in the EZO classes.
+const QualityControl::Limits QualityControl::LIMITS[(int)QcChannel::COUNT] = {
+    //  spanMin  spanMax    userMin   userMax   spikeS   spikeF   roc/min  flatTol  sigmaFloor
+    {   -2.5f,   40.0f,     -2.0f,    35.0f,    1.0f,    3.0f,    0.5f,    0.0005f, 0.5f   },  // °C
+    {   0.07f,   100000.0f, 30000.0f, 60000.0f, 1500.0f, 5000.0f, 1000.0f, 0.5f,    500.0f },  // µS/cm
+    {   0.001f,  14.0f,     7.5f,     8.5f,     0.15f,   0.5f,    0.1f,    0.0005f, 0.05f  },  // pH
+    {   0.0f,    25.0f,     4.0f,     10.0f,    1.0f,    3.0f,    0.5f,    0.005f,  0.3f   },  // mg/L
+};
+
+// ============================================================================
+// QcFlags
+// ============================================================================
+
+QcFlag QcFlags::get(QcTest test) const {
+    return (QcFlag)((packed >> (4 * (int)test)) & 0x0F);
+}
+
+void QcFlags::set(QcTest test, QcFlag flag) {
+    int shift = 4 * (int)test;
+    packed = (packed & ~(0x0Fu << shift)) | ((uint32_t)flag << shift);
+}
+
+QcFlag QcFlags::aggregate() const {
+    QcFlag worst = QcFlag::NOT_EVALUATED;
+    for (int t = 0; t < (int)QcTest::COUNT; t++) {
+        QcFlag f = get((QcTest)t);
+        if (f == QcFlag::MISSING) {
+            return QcFlag::MISSING;
+        }
+        if (f == QcFlag::NOT_EVALUATED) {
+            continue;
+        }
+        if (worst == QcFlag::NOT_EVALUATED || (uint8_t)f > (uint8_t)worst) {
+            worst = f;
+        }
+    }
+    return worst;
+}
+
+String QcFlags::toString() const {
+    if (!isSet()) {
+        return "";
+    }
+    char buf[(int)QcTest::COUNT + 1];
+    for (int t = 0; t < (int)QcTest::COUNT; t++) {
+        buf[t] = '0' + (char)get((QcTest)t);
+    }
+    buf[(int)QcTest::COUNT] = '\0';
+    return String(buf);
+}
+
+QcFlags QcFlags::fromString(const String& s) {
+    QcFlags flags;
+    if ((int)s.length() != (int)QcTest::COUNT) {
+        return flags;
+    }
+    for (int t = 0; t < (int)QcTest::COUNT; t++) {
+        char c = s[t];
+        if (c != '1' && c != '2' && c != '3' && c != '4' && c != '9') {
+            return QcFlags();
+        }
+        flags.set((QcTest)t, (QcFlag)(c - '0'));
+    }
+    return flags;
+}
+
+// ============================================================================
+// QualityControl
+// ============================================================================
+
+QualityControl::QualityControl() {
+    for (int c = 0; c < (int)QcChannel::COUNT; c++) {
+        reset((QcChannel)c);
+        _ch[c].evaluated = 0;
+        _ch[c].suspect = 0;
+        _ch[c].failed = 0;
+    }
+}
+
+void QualityControl::reset(QcChannel channel) {
+    ChannelState& st = _ch[(int)channel];
+    st.prev1 = NAN;
+    st.prev2 = NAN;
+    st.prevMs = 0;
+    st.history = 0;
+    st.flatRef = NAN;
+    st.flatCount = 0;
+    st.climMean = 0.0f;
+    st.climVar = 0.0f;
+    st.climSamples = 0;
+    st.last = QcFlags();
+    st.lastMs = 0;
+}
+
+QcFlags QualityControl::evaluate(QcChannel channel, float value, unsigned long now, float reference) {
+    ChannelState& st = _ch[(int)channel];
+    const Limits& lim = LIMITS[(int)channel];
+    QcFlags flags;
+
+    if (isnan(value)) {
+        for (int t = 0; t < (int)QcTest::COUNT; t++) {
+            flags.set((QcTest)t, QcFlag::MISSING);
+        }
+        st.last = flags;
+        st.lastMs = now;
+        return flags;
+    }
+
+    // Neighbours hours apart (pump stopped, sensor off) aren't neighbours
+    if (st.history > 0 && now - st.prevMs > QC_HISTORY_MAX_GAP_MS) {
+        st.history = 0;
+    }
+
+    QcFlag gross = testGrossRange(lim, value);
+    flags.set(QcTest::GROSS_RANGE, gross);
+    flags.set(QcTest::CLIMATOLOGY, testClimatology(st, lim, value));
+    flags.set(QcTest::SPIKE, testSpike(st, lim, value));
+    flags.set(QcTest::RATE_OF_CHANGE, testRateOfChange(st, lim, value, now));
+    flags.set(QcTest::FLAT_LINE, testFlatLine(st, lim, value));
+    flags.set(QcTest::MULTIVARIATE, testMultivariate(channel, value, reference, now));
+
+    // An impossible value must not become the reference for the next one
+    if (gross != QcFlag::FAIL) {
+        accept(st, lim, value, now);
+    }
+
+    QcFlag agg = flags.aggregate();
+    st.evaluated++;
+    if (agg == QcFlag::SUSPECT) st.suspect++;
+    if (agg == QcFlag::FAIL) st.failed++;
+    st.last = flags;
+    st.lastMs = now;
+    return flags;
+}
+
+const char* QualityControl::channelName(QcChannel ch) {
+    switch (ch) {
+        case QcChannel::TEMPERATURE:      return "temperature";
+        case QcChannel::CONDUCTIVITY:     return "conductivity";
+        case QcChannel::PH:               return "ph";
+        case QcChannel::DISSOLVED_OXYGEN: return "dissolved_oxygen";
+        default:                          return "unknown";
+    }
+}
+
+// ============================================================================
+// Private
+// ============================================================================
+
+QcFlag QualityControl::testGrossRange(const Limits& lim, float value) const {
+    if (value < lim.spanMin || value > lim.spanMax) return QcFlag::FAIL;
+    if (value < lim.userMin || value > lim.userMax) return QcFlag::SUSPECT;
+    return QcFlag::PASS;
+}
+
+QcFlag QualityControl::testClimatology(const ChannelState& st, const Limits& lim, float value) const {
+    if (st.climSamples < QC_CLIMATOLOGY_MIN_SAMPLES) {
+        return QcFlag::NOT_EVALUATED;
+    }
+    float sigma = sqrtf(st.climVar);
+    if (sigma < lim.climSigmaFloor) sigma = lim.climSigmaFloor;
+    return fabsf(value - st.climMean) > QC_CLIMATOLOGY_SIGMA * sigma
+        ? QcFlag::SUSPECT : QcFlag::PASS;
+}
+
+QcFlag QualityControl::testSpike(const ChannelState& st, const Limits& lim, float value) const {
+    if (st.history < 2) {
+        return QcFlag::NOT_EVALUATED;
+    }
+    // Real-time variant: the newest value against its two predecessors, so
+    // the flag is final when the record is written
+    float d = fabsf(value - 0.5f * (st.prev1 + st.prev2));
+    if (d > lim.spikeFail) return QcFlag::FAIL;
+    if (d > lim.spikeSuspect) return QcFlag::SUSPECT;
+    return QcFlag::PASS;
+}
+
+QcFlag QualityControl::testRateOfChange(const ChannelState& st, const Limits& lim,
+                                        float value, unsigned long now) const {
+    if (st.history < 1 || now == st.prevMs) {
+        return QcFlag::NOT_EVALUATED;
+    }
+    float minutes = (float)(now - st.prevMs) / 60000.0f;
+    return fabsf(value - st.prev1) / minutes > lim.rocPerMin ? QcFlag::SUSPECT : QcFlag::PASS;
+}
+
+QcFlag QualityControl::testFlatLine(const ChannelState& st, const Limits& lim, float value) const {
+    if (isnan(st.flatRef)) {
+        return QcFlag::NOT_EVALUATED;
+    }
+    if (fabsf(value - st.flatRef) > lim.flatTolerance) {
+        return QcFlag::PASS;
+    }
+    uint16_t repeats = st.flatCount + 1;
+    if (repeats >= QC_FLAT_FAIL_COUNT) return QcFlag::FAIL;
+    if (repeats >= QC_FLAT_SUSPECT_COUNT) return QcFlag::SUSPECT;
+    return QcFlag::PASS;
+}
+
+QcFlag QualityControl::testMultivariate(QcChannel channel, float value, float reference,
+                                        unsigned long now) const {
+    switch (channel) {
+        case QcChannel::TEMPERATURE:
+            // Our probe against the boat's own water temperature transducer
+            if (isnan(reference)) return QcFlag::NOT_EVALUATED;
+            return fabsf(value - reference) > QC_MV_TEMP_DIFF_C ? QcFlag::SUSPECT : QcFlag::PASS;
+
+        case QcChannel::CONDUCTIVITY:
+        case QcChannel::PH:
+            // Temperature-compensated: only as good as this cycle's temperature
+            return companionFlag(QcChannel::TEMPERATURE, now);
+
+        case QcChannel::DISSOLVED_OXYGEN: {
+            // Temperature and salinity (from EC) compensated
+            QcFlag t = companionFlag(QcChannel::TEMPERATURE, now);
+            QcFlag s = companionFlag(QcChannel::CONDUCTIVITY, now);
+            if (t == QcFlag::NOT_EVALUATED) return s;
+            if (s == QcFlag::NOT_EVALUATED) return t;
+            return (uint8_t)t > (uint8_t)s ? t : s;
+        }
+
+        default:
+            return QcFlag::NOT_EVALUATED;
+    }
+}
+
+QcFlag QualityControl::companionFlag(QcChannel companion, unsigned long now) const {
+    const ChannelState& st = _ch[(int)companion];
+    if (!st.last.isSet() || now - st.lastMs > QC_MV_COMPANION_MAX_AGE_MS) {
+        return QcFlag::NOT_EVALUATED;
+    }
+    switch (st.last.aggregate()) {
+        case QcFlag::PASS:    return QcFlag::PASS;
+        case QcFlag::SUSPECT:
+        case QcFlag::FAIL:    return QcFlag::SUSPECT;
+        default:              return QcFlag::NOT_EVALUATED;
+    }
+}
+
+void QualityControl::accept(ChannelState& st, const Limits& lim, float value, unsigned long now) {
+    st.prev2 = st.prev1;
+    st.prev1 = value;
+    st.prevMs = now;
+    if (st.history < 2) st.history++;
+
+    if (!isnan(st.flatRef) && fabsf(value - st.flatRef) <= lim.flatTolerance) {
+        if (st.flatCount < 0xFFFF) st.flatCount++;
+    } else {
+        st.flatRef = value;
+        st.flatCount = 0;
+    }
+
+    // Exponentially weighted mean/variance; a plain average while warming up
+    float alpha = QC_CLIMATOLOGY_ALPHA;
+    if (st.climSamples < 0xFFFF) st.climSamples++;
+    if (1.0f / st.climSamples > alpha) alpha = 1.0f / st.climSamples;
+    float diff = value - st.climMean;
+    float incr = alpha * diff;
+    st.climMean += incr;
+    st.climVar = (1.0f - alpha) * (st.climVar + diff * incr);
+}
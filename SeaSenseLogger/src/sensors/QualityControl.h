@@ -0,0 +1,144 @@
+/**
+ * SeaSense Logger - Quality Control
+ *
+ * QARTOD-style real-time QC on the write path, so every record leaves the
+ * logger already flagged and shore-side processing doesn't have to re-run
+ * it over the whole dataset:
+ * - Six tests per measurement: gross range, climatology, spike, rate of
+ *   change, flat line and multi-variate
+ * - Each test yields a QARTOD flag (1 pass, 2 not evaluated, 3 suspect,
+ *   4 fail, 9 missing); the six flags pack into one 32-bit word stored with
+ *   the record ("qc_flags" CSV column, e.g. "112111")
+ * - Per-channel state is a handful of floats: the last two accepted values,
+ *   a flat-line run, and a running mean/variance as the climatology
+ *   learned over the deployment. O(1) time and memory per sample.
+ *
+ * Not thread-safe: evaluate() runs on the loop() core with the sensor reads.
+ */
+
+#ifndef SEASENSE_QUALITY_CONTROL_H
+#define SEASENSE_QUALITY_CONTROL_H
+
+#include <Arduino.h>
+
+enum class QcFlag : uint8_t {
+    PASS = 1,
+    NOT_EVALUATED = 2,
+    SUSPECT = 3,
+    FAIL = 4,
+    MISSING = 9
+};
+
+// Test order is the digit order of the qc_flags string
+enum class QcTest : uint8_t {
+    GROSS_RANGE = 0,
+    CLIMATOLOGY = 1,
+    SPIKE = 2,
+    RATE_OF_CHANGE = 3,
+    FLAT_LINE = 4,
+    MULTIVARIATE = 5,
+    COUNT = 6
+};
+
+enum class QcChannel : uint8_t {
+    TEMPERATURE = 0,
+    CONDUCTIVITY = 1,
+    PH = 2,
+    DISSOLVED_OXYGEN = 3,
+    COUNT = 4
+};
+
+/**
+ * Per-test flags of one measurement, one nibble per test.
+ * A zero word means QC did not run (records from before QC existed).
+ */
+struct QcFlags {
+    uint32_t packed;
+
+    QcFlags() : packed(0) {}
+    explicit QcFlags(uint32_t p) : packed(p) {}
+
+    bool isSet() const { return packed != 0; }
+    QcFlag get(QcTest test) const;
+    void set(QcTest test, QcFlag flag);
+
+    /**
+     * Worst flag across tests (QARTOD aggregate): 9 if the value is
+     * missing, else the highest of 1/3/4, else 2 if nothing was evaluated
+     */
+    QcFlag aggregate() const;
+
+    /**
+     * "112111" (empty if not set)
+     */
+    String toString() const;
+
+    /**
+     * Inverse of toString(); anything malformed gives an unset QcFlags
+     */
+    static QcFlags fromString(const String& s);
+};
+
+class QualityControl {
+public:
+    QualityControl();
+
+    /**
+     * Run all tests on a new measurement and update the channel's state
+     * @param reference Multi-variate input where the channel has one
+     *        (temperature: the boat's water temperature transducer);
+     *        NAN if unavailable. Dependent channels (EC, pH, DO) use the
+     *        latest temperature (and EC) result instead.
+     */
+    QcFlags evaluate(QcChannel channel, float value, unsigned long now, float reference = NAN);
+
+    /**
+     * Forget all history (sensor re-init, recalibration)
+     */
+    void reset(QcChannel channel);
+
+    // Statistics
+    uint32_t getEvaluatedCount(QcChannel ch) const { return _ch[(int)ch].evaluated; }
+    uint32_t getSuspectCount(QcChannel ch) const { return _ch[(int)ch].suspect; }
+    uint32_t getFailCount(QcChannel ch) const { return _ch[(int)ch].failed; }
+    QcFlags getLastFlags(QcChannel ch) const { return _ch[(int)ch].last; }
+
+    static const char* channelName(QcChannel ch);
+
+private:
+    struct Limits {
+        float spanMin, spanMax;         // sensor range: fail outside
+        float userMin, userMax;         // plausible seawater: suspect outside
+        float spikeSuspect, spikeFail;  // |x - mean(prev two)|
+        float rocPerMin;                // |dx/dt| suspect above
+        float flatTolerance;            // |x - run start| counted as "same"
+        float climSigmaFloor;           // smallest sigma the climatology trusts
+    };
+
+    struct ChannelState {
+        float prev1, prev2;             // last two accepted values (newest first)
+        unsigned long prevMs;
+        uint8_t history;                // 0..2 accepted values since reset
+        float flatRef;
+        uint16_t flatCount;             // repeats of flatRef
+        float climMean, climVar;
+        uint16_t climSamples;
+        QcFlags last;
+        unsigned long lastMs;
+        uint32_t evaluated, suspect, failed;
+    };
+
+    static const Limits LIMITS[(int)QcChannel::COUNT];
+    ChannelState _ch[(int)QcChannel::COUNT];
+
+    QcFlag testGrossRange(const Limits& lim, float value) const;
+    QcFlag testClimatology(const ChannelState& st, const Limits& lim, float value) const;
+    QcFlag testSpike(const ChannelState& st, const Limits& lim, float value) const;
+    QcFlag testRateOfChange(const ChannelState& st, const Limits& lim, float value, unsigned long now) const;
+    QcFlag testFlatLine(const ChannelState& st, const Limits& lim, float value) const;
+    QcFlag testMultivariate(QcChannel channel, float value, float reference, unsigned long now) const;
+    QcFlag companionFlag(QcChannel companion, unsigned long now) const;
+    void accept(ChannelState& st, const Limits& lim, float value, unsigned long now);
+};
+
+#endif // SEASENSE_QUALITY_CONTROL_H
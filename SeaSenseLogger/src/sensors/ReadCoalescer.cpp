@@ -0,0 +1,99 @@
+/**
+ * SeaSense Logger - Sensor Read Coalescer Implementation
+ */
+
+#include "ReadCoalescer.h"
+#include <limits.h>
+
+ReadCoalescer::ReadCoalescer(unsigned long freshMs)
+    : _freshMs(freshMs),
+      _hasReading(false),
+      _completedAt(0),
+      _okMask(0),
+      _requests(0),
+      _acquisitions(0),
+      _coalesced(0)
+{
+#ifndef NATIVE_TEST
+    portMUX_INITIALIZE(&_mux);
+#endif
+}
+
+bool ReadCoalescer::tryShare(unsigned long now) {
+    lock();
+    _requests++;
+    bool fresh = isFreshLocked(now);
+    if (fresh) {
+        _coalesced++;
+    }
+    unlock();
+    return fresh;
+}
+
+bool ReadCoalescer::acquire(unsigned long requestedAt, Acquisition fn) {
+    unsigned long now = millis();
+
+    // Whoever held the bus before us may have just read everything: an
+    // acquisition that completed after this request arrived was in flight
+    // while it waited
+    lock();
+    bool joined = isFreshLocked(now) ||
+                  (_hasReading && (long)(_completedAt - requestedAt) >= 0);
+    if (joined) {
+        _coalesced++;
+    }
+    unlock();
+    if (joined) {
+        return false;
+    }
+
+    uint8_t okMask = fn();
+
+    lock();
+    _acquisitions++;
+    storeLocked(millis(), okMask);
+    unlock();
+    return true;
+}
+
+void ReadCoalescer::record(unsigned long completedMs, uint8_t okMask) {
+    lock();
+    storeLocked(completedMs, okMask);
+    unlock();
+}
+
+uint8_t ReadCoalescer::getOkMask() const {
+    lock();
+    uint8_t mask = _okMask;
+    unlock();
+    return mask;
+}
+
+unsigned long ReadCoalescer::getAgeMs(unsigned long now) const {
+    lock();
+    unsigned long age = _hasReading ? now - _completedAt : ULONG_MAX;
+    unlock();
+    return age;
+}
+
+bool ReadCoalescer::isFreshLocked(unsigned long now) const {
+    return _hasReading && now - _completedAt < _freshMs;
+}
+
+void ReadCoalescer::storeLocked(unsigned long completedMs, uint8_t okMask) {
+    _hasReading = true;
+    _completedAt = completedMs;
+    _okMask = okMask;
+}
+
+void ReadCoalescer::lock() const {
+#ifndef NATIVE_TEST
+    portENTER_CRITICAL(&_mux);
+#endif
+}
+
+void ReadCoalescer::unlock() const {
+#ifndef NATIVE_TEST
+    portEXIT_CRITICAL(&_mux);
+#endif
+}
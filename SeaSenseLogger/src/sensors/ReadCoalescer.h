@@ -0,0 +1,83 @@
+/**
+ * SeaSense Logger - Sensor Read Coalescer
+ *
+ * Keeps web-triggered I2C traffic independent of the number of clients.
+ * Every acquisition of the water probes (web or measurement cycle) is
+ * recorded; a web request arriving within the freshness window gets the
+ * cached readings instead of a new bus transaction. A request that has to
+ * wait for the bus re-checks after taking it: if an acquisition completed
+ * after the request arrived, the request joins it rather than repeating
+ * it, so everything queued behind an in-flight read shares that read.
+ *
+ * The bus lock itself stays with the caller (g_i2cMutex); acquire() must
+ * be called while holding it. Written from both cores: state is guarded
+ * by a spinlock.
+ */
+
+#ifndef SEASENSE_READ_COALESCER_H
+#define SEASENSE_READ_COALESCER_H
+
+#include <Arduino.h>
+#include <functional>
+
+class ReadCoalescer {
+public:
+    // Reads the probes; returns a bit per probe read successfully (SensorTraits INDEX)
+    typedef std::function<uint8_t()> Acquisition;
+
+    /**
+     * @param freshMs Readings younger than this are served from cache
+     */
+    explicit ReadCoalescer(unsigned long freshMs);
+
+    /**
+     * A web request for current readings. Counts the request.
+     * @return true if the last acquisition is fresh enough to share
+     */
+    bool tryShare(unsigned long now);
+
+    /**
+     * Read the probes unless an acquisition completed while the caller was
+     * waiting for the bus. Call with the bus lock held.
+     * @param requestedAt millis() when the request arrived (before waiting)
+     * @return true if fn ran, false if the request joined another acquisition
+     */
+    bool acquire(unsigned long requestedAt, Acquisition fn);
+
+    /**
+     * The measurement cycle read the probes, finishing at completedMs
+     */
+    void record(unsigned long completedMs, uint8_t okMask);
+
+    /** Bit per probe read successfully in the last acquisition */
+    uint8_t getOkMask() const;
+
+    /** ms since the last acquisition completed (ULONG_MAX if none yet) */
+    unsigned long getAgeMs(unsigned long now) const;
+
+    // Status
+    uint32_t getRequestCount() const { return _requests; }
+    uint32_t getAcquisitionCount() const { return _acquisitions; }
+    uint32_t getCoalescedCount() const { return _coalesced; }
+
+private:
+    unsigned long _freshMs;
+    bool _hasReading;
+    unsigned long _completedAt; // end of the last acquisition
+    uint8_t _okMask;
+
+    uint32_t _requests;         // web requests
+    uint32_t _acquisitions;     // bus acquisitions by web requests
+    uint32_t _coalesced;        // web requests served without one
+
+#ifndef NATIVE_TEST
+    mutable portMUX_TYPE _mux;
+#endif
+
+    bool isFreshLocked(unsigned long now) const;
+    void storeLocked(unsigned long completedMs, uint8_t okMask);
+    void lock() const;
+    void unlock() const;
+};
+
+#endif // SEASENSE_READ_COALESCER_H
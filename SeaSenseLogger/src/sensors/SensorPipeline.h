@@ -0,0 +1,100 @@
+/**
+ * SeaSense Logger - Compile-time Sensor Pipeline
+ *
+ * Owns a fixed list of sensors, chosen at compile time, and walks it with
+ * a generic callback. Each callback is instantiated per concrete sensor
+ * type, so with `final` sensor classes every read()/getData() in the
+ * measurement cycle is a direct (inlinable) call rather than a dispatch
+ * through ISensor, and a sensor left out of the list is not linked at all.
+ *
+ *   using Sensors = SensorPipelineOf<SensorIf<true, EZO_RTD>,
+ *                                    SensorIf<FEATURE_PH, EZO_pH>>;
+ *   Sensors sensors;
+ *   sensors.forEach([](auto& s) { s.read(); });
+ *   EZO_pH* ph = sensors.find<EZO_pH>();   // nullptr when compiled out
+ */
+
+#ifndef SEASENSE_SENSOR_PIPELINE_H
+#define SEASENSE_SENSOR_PIPELINE_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <tuple>
+#include <type_traits>
+
+template <typename... Sensors>
+class SensorPipeline {
+public:
+    static constexpr size_t SIZE = sizeof...(Sensors);
+
+    /** Is S in the list */
+    template <typename S>
+    static constexpr bool has() {
+        return (std::is_same<S, Sensors>::value || ...);
+    }
+
+    /** The S in the list (compile error if it was left out) */
+    template <typename S>
+    S& get() {
+        static_assert(has<S>(), "Sensor not in this pipeline");
+        return std::get<S>(_sensors);
+    }
+
+    /** The S in the list, or nullptr if it was left out */
+    template <typename S>
+    S* find() {
+        if constexpr (has<S>()) {
+            return &std::get<S>(_sensors);
+        } else {
+            return nullptr;
+        }
+    }
+
+    /** fn(sensor) for each sensor, in list order */
+    template <typename Fn>
+    void forEach(Fn&& fn) {
+        std::apply([&fn](Sensors&... s) { (fn(s), ...); }, _sensors);
+    }
+
+    template <typename Fn>
+    void forEach(Fn&& fn) const {
+        std::apply([&fn](const Sensors&... s) { (fn(s), ...); }, _sensors);
+    }
+
+    /** Sensors currently enabled (config or detection) */
+    uint8_t enabledCount() const {
+        uint8_t n = 0;
+        forEach([&n](const auto& s) { n += s.isEnabled() ? 1 : 0; });
+        return n;
+    }
+
+private:
+    std::tuple<Sensors...> _sensors;
+};
+
+/** One list entry, kept only if Enabled (a FEATURE_* flag) */
+template <bool Enabled, typename S>
+struct SensorIf {};
+
+namespace sensor_pipeline_detail {
+
+template <typename Pipeline, typename... Slots>
+struct Build {
+    using type = Pipeline;
+};
+
+template <typename... Kept, typename S, typename... Rest>
+struct Build<SensorPipeline<Kept...>, SensorIf<true, S>, Rest...>
+    : Build<SensorPipeline<Kept..., S>, Rest...> {};
+
+template <typename... Kept, typename S, typename... Rest>
+struct Build<SensorPipeline<Kept...>, SensorIf<false, S>, Rest...>
+    : Build<SensorPipeline<Kept...>, Rest...> {};
+
+}  // namespace sensor_pipeline_detail
+
+/** SensorPipeline of the enabled SensorIf entries, in order */
+template <typename... Slots>
+using SensorPipelineOf = typename sensor_pipeline_detail::Build<SensorPipeline<>, Slots...>::type;
+
+#endif // SEASENSE_SENSOR_PIPELINE_H
@@ -0,0 +1,90 @@
+/**
+ * SeaSense Logger - Water Sensor List
+ *
+ * The EZO probes this build measures, in measurement order: temperature
+ * first (it compensates the others), conductivity before dissolved oxygen
+ * (salinity compensation). pH and DO are dropped with FEATURE_PH/FEATURE_DO.
+ *
+ * SensorTraits<S> holds the per-probe constants the measurement cycle
+ * needs, so one generic loop body serves every probe.
+ */
+
+#ifndef SEASENSE_WATER_SENSORS_H
+#define SEASENSE_WATER_SENSORS_H
+
+#include "SensorPipeline.h"
+#include "EZO_RTD.h"
+#include "EZO_EC.h"
+#include "EZO_pH.h"
+#include "EZO_DO.h"
+#include "QualityControl.h"
+#include "CompensationManager.h"
+#include "../broadcast/LiveMessage.h"
+#include "../../config/hardware_config.h"
+
+template <typename S>
+struct SensorTraits;
+
+template <>
+struct SensorTraits<EZO_RTD> {
+    static constexpr const char* TYPE = "Temperature";      // device config / calibration key
+    static constexpr const char* MODEL = "EZO-RTD";
+    static constexpr uint8_t INDEX = 0;                     // bit in ReadCoalescer masks
+    static constexpr const char* KEY = "temperature";       // web API key
+    static constexpr const char* STAGE = "sensor:temp";
+    static constexpr const char* LOG_FORMAT = "Temperature: %.2f %s [%s]";
+    static constexpr QcChannel QC = QcChannel::TEMPERATURE;
+    static constexpr bool COMPENSATED = false;
+    static constexpr CompTarget COMP = CompTarget::COUNT;
+    static constexpr LiveField LIVE = LiveField::WATER_TEMP;   // live broadcast field
+};
+
+template <>
+struct SensorTraits<EZO_EC> {
+    static constexpr const char* TYPE = "Conductivity";
+    static constexpr const char* MODEL = "EZO-EC";
+    static constexpr uint8_t INDEX = 1;
+    static constexpr const char* KEY = "conductivity";
+    static constexpr const char* STAGE = "sensor:ec";
+    static constexpr const char* LOG_FORMAT = "Conductivity: %.0f %s [%s]";
+    static constexpr QcChannel QC = QcChannel::CONDUCTIVITY;
+    static constexpr bool COMPENSATED = true;
+    static constexpr CompTarget COMP = CompTarget::EC;
+    static constexpr LiveField LIVE = LiveField::CONDUCTIVITY;
+};
+
+template <>
+struct SensorTraits<EZO_pH> {
+    static constexpr const char* TYPE = "pH";
+    static constexpr const char* MODEL = "EZO-pH";
+    static constexpr uint8_t INDEX = 2;
+    static constexpr const char* KEY = "ph";
+    static constexpr const char* STAGE = "sensor:ph";
+    static constexpr const char* LOG_FORMAT = "pH: %.2f %s [%s]";
+    static constexpr QcChannel QC = QcChannel::PH;
+    static constexpr bool COMPENSATED = true;
+    static constexpr CompTarget COMP = CompTarget::PH;
+    static constexpr LiveField LIVE = LiveField::PH;
+};
+
+template <>
+struct SensorTraits<EZO_DO> {
+    static constexpr const char* TYPE = "Dissolved Oxygen";
+    static constexpr const char* MODEL = "EZO-DO";
+    static constexpr uint8_t INDEX = 3;
+    static constexpr const char* KEY = "dissolved_oxygen";
+    static constexpr const char* STAGE = "sensor:do";
+    static constexpr const char* LOG_FORMAT = "Dissolved Oxygen: %.2f %s [%s]";
+    static constexpr QcChannel QC = QcChannel::DISSOLVED_OXYGEN;
+    static constexpr bool COMPENSATED = true;
+    static constexpr CompTarget COMP = CompTarget::DO;
+    static constexpr LiveField LIVE = LiveField::DISSOLVED_OXYGEN;
+};
+
+using WaterSensors = SensorPipelineOf<
+    SensorIf<true, EZO_RTD>,
+    SensorIf<true, EZO_EC>,
+    SensorIf<FEATURE_PH, EZO_pH>,
+    SensorIf<FEATURE_DO, EZO_DO>>;
+
+#endif // SEASENSE_WATER_SENSORS_H
@@ -0,0 +1,509 @@
+/**
+ * SeaSense Logger - Columnar Archive Codec Implementation
+ */
+
+#include "ArchiveCodec.h"
+#include "../system/TimeService.h"
+#include <string.h>
+
+using namespace ArchiveCodec;
+
+static_assert((1 << DICT_BITS) == DICT_SIZE, "Dictionary index width");
+
+// Column holding each field (RecordField bit order)
+template <size_t... I>
+static constexpr std::array<uint8_t, RecordSchema::COUNT> fieldColumns(std::index_sequence<I...>) {
+    return {{columnOf(I)...}};
+}
+static constexpr std::array<uint8_t, RecordSchema::COUNT> FIELD_COLUMNS =
+    fieldColumns(std::make_index_sequence<RecordSchema::COUNT>());
+
+// Delta-of-delta buckets: n one bits (then a zero, except after the last)
+// select a zigzag value of DOD_BITS[n] bits
+static const uint8_t DOD_BITS[] = {0, 7, 9, 12, 20, 32, 64};
+static const uint8_t DOD_BUCKETS = sizeof(DOD_BITS);
+
+// ============================================================================
+// Helpers
+// ============================================================================
+
+uint32_t ArchiveCodec::crc32(const uint8_t* data, size_t len) {
+    uint32_t crc = 0xFFFFFFFF;
+    for (size_t i = 0; i < len; i++) {
+        crc ^= data[i];
+        for (uint8_t b = 0; b < 8; b++) {
+            crc = (crc >> 1) ^ (0xEDB88320 & (0 - (crc & 1)));
+        }
+    }
+    return ~crc;
+}
+
+static bool digits(const char* s, uint8_t n, int& out) {
+    out = 0;
+    for (uint8_t i = 0; i < n; i++) {
+        if (s[i] < '0' || s[i] > '9') return false;
+        out = out * 10 + (s[i] - '0');
+    }
+    return true;
+}
+
+bool ArchiveCodec::parseUTC(const String& utc, int64_t& seconds) {
+    const char* s = utc.c_str();
+    if (utc.length() != TimeService::UTC_LENGTH
+        || s[4] != '-' || s[7] != '-' || s[10] != 'T'
+        || s[13] != ':' || s[16] != ':' || s[19] != 'Z') {
+        return false;
+    }
+    int y, m, d, hh, mm, ss;
+    if (!digits(s, 4, y) || !digits(s + 5, 2, m) || !digits(s + 8, 2, d)
+        || !digits(s + 11, 2, hh) || !digits(s + 14, 2, mm) || !digits(s + 17, 2, ss)) {
+        return false;
+    }
+    static const uint8_t MONTH_DAYS[] = {31, 29, 31, 30, 31, 30, 31, 31, 30, 31, 30, 31};
+    bool leap = (y % 4 == 0 && y % 100 != 0) || y % 400 == 0;
+    if (y < 1970 || m < 1 || m > 12 || d < 1 || d > MONTH_DAYS[m - 1]
+        || (m == 2 && d == 29 && !leap) || hh > 23 || mm > 59 || ss > 59) {
+        return false;
+    }
+
+    // Days since 1970-01-01 (proleptic Gregorian, March-based year)
+    int64_t yy = y - (m <= 2);
+    int64_t era = yy / 400;
+    int64_t yoe = yy - era * 400;
+    int64_t doy = (153 * (m + (m > 2 ? -3 : 9)) + 2) / 5 + d - 1;
+    int64_t doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;
+    int64_t days = era * 146097 + doe - 719468;
+
+    seconds = days * 86400 + hh * 3600 + mm * 60 + ss;
+    return true;
+}
+
+void BitWriter::write(uint64_t value, uint8_t bits) {
+    while (bits > 0) {
+        if ((_bits & 7) == 0) {
+            _bytes.push_back(0);
+        }
+        uint8_t room = 8 - (_bits & 7);
+        uint8_t take = bits < room ? bits : room;
+        uint8_t chunk = (uint8_t)((value >> (bits - take)) & ((1u << take) - 1));
+        _bytes.back() |= chunk << (room - take);
+        _bits += take;
+        bits -= take;
+    }
+}
+
+uint64_t BitReader::read(uint8_t bits) {
+    if (_failed || _pos + bits > _len) {
+        _failed = true;
+        return 0;
+    }
+    uint64_t value = 0;
+    while (bits > 0) {
+        uint8_t avail = 8 - (_pos & 7);
+        uint8_t take = bits < avail ? bits : avail;
+        uint8_t chunk = (_data[_pos >> 3] >> (avail - take)) & ((1u << take) - 1);
+        value = (value << take) | chunk;
+        _pos += take;
+        bits -= take;
+    }
+    return value;
+}
+
+static inline uint64_t zigzag(int64_t v) { return ((uint64_t)v << 1) ^ (uint64_t)(v >> 63); }
+static inline int64_t unzigzag(uint64_t v) { return (int64_t)(v >> 1) ^ -(int64_t)(v & 1); }
+
+static inline uint8_t leadingZeros(uint32_t x) { return __builtin_clz(x); }
+static inline uint8_t leadingZeros(uint64_t x) { return __builtin_clzll(x); }
+static inline uint8_t trailingZeros(uint32_t x) { return __builtin_ctz(x); }
+static inline uint8_t trailingZeros(uint64_t x) { return __builtin_ctzll(x); }
+
+static inline uint32_t floatBits(float f) { uint32_t u; memcpy(&u, &f, sizeof(u)); return u; }
+static inline float bitsFloat(uint32_t u) { float f; memcpy(&f, &u, sizeof(f)); return f; }
+static inline uint64_t doubleBits(double d) { uint64_t u; memcpy(&u, &d, sizeof(u)); return u; }
+static inline double bitsDouble(uint64_t u) { double d; memcpy(&d, &u, sizeof(d)); return d; }
+
+// ============================================================================
+// Column encodings
+// ============================================================================
+
+static void putDelta(BitWriter& w, DeltaState& s, int64_t value) {
+    int64_t delta = value - s.prev;
+    uint64_t zz = zigzag(delta - s.delta);
+    s.prev = value;
+    s.delta = delta;
+
+    uint8_t b = 0;
+    while (b < DOD_BUCKETS - 1 && zz >= (1ULL << DOD_BITS[b])) {
+        b++;
+    }
+    w.write((1ULL << b) - 1, b);
+    if (b < DOD_BUCKETS - 1) {
+        w.write(0, 1);
+    }
+    w.write(zz, DOD_BITS[b]);
+}
+
+static int64_t getDelta(BitReader& r, DeltaState& s) {
+    uint8_t b = 0;
+    while (b < DOD_BUCKETS - 1 && r.read(1)) {
+        b++;
+    }
+    s.delta += unzigzag(r.read(DOD_BITS[b]));
+    s.prev += s.delta;
+    return s.prev;
+}
+
+template <typename T>
+static void putXor(BitWriter& w, XorState<T>& s, T value) {
+    const uint8_t BITS = sizeof(T) * 8;
+    const uint8_t FIELD = BITS == 64 ? 6 : 5;
+
+    T x = value ^ s.prev;
+    s.prev = value;
+    if (x == 0) {
+        w.write(0, 1);
+        return;
+    }
+    uint8_t lead = leadingZeros(x);
+    uint8_t trail = trailingZeros(x);
+    if (s.leading != 0xFF && lead >= s.leading && trail >= s.trailing) {
+        // Fits the previous window: no need to repeat its position
+        w.write(0b10, 2);
+        w.write(x >> s.trailing, BITS - s.leading - s.trailing);
+    } else {
+        uint8_t significant = BITS - lead - trail;
+        w.write(0b11, 2);
+        w.write(lead, FIELD);
+        w.write(significant - 1, FIELD);
+        w.write(x >> trail, significant);
+        s.leading = lead;
+        s.trailing = trail;
+    }
+}
+
+template <typename T>
+static T getXor(BitReader& r, XorState<T>& s) {
+    const uint8_t BITS = sizeof(T) * 8;
+    const uint8_t FIELD = BITS == 64 ? 6 : 5;
+
+    if (!r.read(1)) {
+        return s.prev;
+    }
+    if (!r.read(1)) {
+        if (s.leading == 0xFF) {
+            r.fail();
+            return s.prev;
+        }
+        s.prev ^= (T)r.read(BITS - s.leading - s.trailing) << s.trailing;
+        return s.prev;
+    }
+    uint8_t lead = r.read(FIELD);
+    uint8_t significant = r.read(FIELD) + 1;
+    if (lead + significant > BITS) {
+        r.fail();
+        return s.prev;
+    }
+    s.leading = lead;
+    s.trailing = BITS - lead - significant;
+    s.prev ^= (T)r.read(significant) << s.trailing;
+    return s.prev;
+}
+
+static void putByte(BitWriter& w, uint8_t& last, uint8_t value) {
+    if (value == last) {
+        w.write(0, 1);
+    } else {
+        w.write(1, 1);
+        w.write(value, 8);
+        last = value;
+    }
+}
+
+static uint8_t getByte(BitReader& r, uint8_t& last) {
+    if (r.read(1)) {
+        last = r.read(8);
+    }
+    return last;
+}
+
+static void putLiteral(BitWriter& w, const String& value) {
+    uint8_t len = value.length() > 255 ? 255 : value.length();
+    w.write(len, 8);
+    const char* s = value.c_str();
+    for (uint8_t i = 0; i < len; i++) {
+        w.write((uint8_t)s[i], 8);
+    }
+}
+
+static String getLiteral(BitReader& r) {
+    uint8_t len = r.read(8);
+    String value;
+    for (uint8_t i = 0; i < len && !r.failed(); i++) {
+        value += (char)r.read(8);
+    }
+    return value;
+}
+
+static void putString(BitWriter& w, DictState& s, const String& value) {
+    if (value == s.last) {
+        w.write(0, 1);
+        return;
+    }
+    for (uint8_t i = 0; i < s.count; i++) {
+        if (s.entries[i] == value) {
+            w.write(0b10, 2);
+            w.write(i, DICT_BITS);
+            s.last = value;
+            s.slot = i;
+            return;
+        }
+    }
+    w.write(0b11, 2);
+    putLiteral(w, value);
+    // Keep what the decoder will see (literals are capped at 255 bytes)
+    s.last = value.length() > 255 ? value.substring(0, 255) : value;
+    if (s.count < DICT_SIZE) {
+        s.entries[s.count] = s.last;
+        s.slot = s.count++;
+    } else {
+        s.slot = DICT_SIZE;
+    }
+}
+
+static const String& getString(BitReader& r, DictState& s) {
+    if (!r.read(1)) {
+        return s.last;
+    }
+    if (!r.read(1)) {
+        uint8_t i = r.read(DICT_BITS);
+        if (i >= s.count) {
+            r.fail();
+            return s.last;
+        }
+        s.last = s.entries[i];
+        s.slot = i;
+        return s.last;
+    }
+    s.last = getLiteral(r);
+    if (s.count < DICT_SIZE) {
+        s.entries[s.count] = s.last;
+        s.slot = s.count++;
+    } else {
+        s.slot = DICT_SIZE;
+    }
+    return s.last;
+}
+
+// timestamp_utc: '0' not synced, '10' epoch seconds (delta-of-delta),
+// '11' anything else, verbatim
+static void putUTC(BitWriter& w, DeltaState& s, const String& value) {
+    int64_t seconds;
+    if (value.length() == 0) {
+        w.write(0, 1);
+    } else if (parseUTC(value, seconds)) {
+        w.write(0b10, 2);
+        putDelta(w, s, seconds);
+    } else {
+        w.write(0b11, 2);
+        putLiteral(w, value);
+    }
+}
+
+static String getUTC(BitReader& r, DeltaState& s) {
+    if (!r.read(1)) {
+        return String("");
+    }
+    if (!r.read(1)) {
+        return TimeService::formatUTC(getDelta(r, s) * 1000);
+    }
+    return getLiteral(r);
+}
+
+// ============================================================================
+// ArchiveEncoder
+// ============================================================================
+
+ArchiveEncoder::ArchiveEncoder() {
+    reset();
+}
+
+void ArchiveEncoder::reset() {
+    for (uint8_t c = 0; c < COLUMN_COUNT; c++) {
+        _streams[c].clear();
+    }
+    _state = ColumnState();
+    _count = 0;
+    _minMillis = 0;
+    _maxMillis = 0;
+}
+
+void ArchiveEncoder::add(const DataRecord& r) {
+    uint32_t millis = (uint32_t)r.millis;
+    RecordSchema::forEach([&](const auto& f, auto index) {
+        constexpr size_t I = decltype(index)::value;
+        constexpr Group group = FIELD_GROUPS[I];
+        constexpr uint8_t slot = slotOf(I);
+        BitWriter& w = _streams[columnOf(I)];
+        const auto& v = r.*f.member;
+
+        if constexpr (group == Group::MILLIS) {
+            putDelta(w, _state.millis, (uint32_t)v);
+        } else if constexpr (group == Group::UTC) {
+            putUTC(w, _state.utc, v);
+        } else if constexpr (group == Group::DOUBLE) {
+            putXor(w, _state.doubles[slot], doubleBits(v));
+        } else if constexpr (group == Group::BYTE) {
+            putByte(w, _state.bytes[slot], v);
+        } else if constexpr (group == Group::STRING) {
+            putString(w, _state.strings[slot], v);
+        } else if constexpr (group == Group::VALUE) {
+            // After the type column: the type's dictionary slot picks the series
+            static_assert(I > TYPE_FIELD, "Sensor type is encoded before the value");
+            putXor(w, _state.values[_state.strings[0].slot], floatBits(v));
+        } else if constexpr (group == Group::QC) {
+            putXor(w, _state.qc, v);
+        } else {
+            putXor(w, _state.floats[slot], floatBits(v));
+        }
+    });
+
+    if (_count == 0 || millis < _minMillis) _minMillis = millis;
+    if (_count == 0 || millis > _maxMillis) _maxMillis = millis;
+    _count++;
+}
+
+bool ArchiveEncoder::full() const {
+    if (_count == 0xFFFF) {
+        return true;
+    }
+    for (uint8_t c = 0; c < COLUMN_COUNT; c++) {
+        if (_streams[c].bytes().size() >= STREAM_LIMIT) {
+            return true;
+        }
+    }
+    return false;
+}
+
+ArchiveBlockHeader ArchiveEncoder::finish(std::vector<uint8_t>& out) {
+    ArchiveBlockHeader header;
+    header.magic = MAGIC;
+    header.count = _count;
+    header.version = VERSION;
+    header.columns = COLUMN_COUNT;
+    header.minMillis = _minMillis;
+    header.maxMillis = _maxMillis;
+
+    size_t payload = COLUMN_COUNT * sizeof(uint16_t);
+    for (uint8_t c = 0; c < COLUMN_COUNT; c++) {
+        payload += _streams[c].bytes().size();
+    }
+    header.payloadBytes = payload;
+
+    out.resize(sizeof(header) + payload);
+    uint8_t* p = out.data() + sizeof(header);
+    for (uint8_t c = 0; c < COLUMN_COUNT; c++) {
+        uint16_t len = _streams[c].bytes().size();
+        memcpy(p, &len, sizeof(len));
+        p += sizeof(len);
+    }
+    for (uint8_t c = 0; c < COLUMN_COUNT; c++) {
+        const std::vector<uint8_t>& bytes = _streams[c].bytes();
+        if (!bytes.empty()) {
+            memcpy(p, bytes.data(), bytes.size());
+            p += bytes.size();
+        }
+    }
+    header.crc = crc32(out.data() + sizeof(header), payload);
+    memcpy(out.data(), &header, sizeof(header));
+
+    reset();
+    return header;
+}
+
+// ============================================================================
+// ArchiveDecoder
+// ============================================================================
+
+bool ArchiveDecoder::begin(const uint8_t* block, size_t len, uint64_t fields) {
+    _read = 0;
+    _state = ColumnState();
+    _columns = 0;
+    for (uint8_t f = 0; f < RecordField::COUNT; f++) {
+        if (fields & (1ULL << f)) {
+            _columns |= 1ULL << FIELD_COLUMNS[f];
+        }
+    }
+    if (_columns & (1ULL << COL_VALUE)) {
+        _columns |= 1ULL << COL_TYPE;   // values are XORed per sensor type
+    }
+    if (len < sizeof(_header)) {
+        return false;
+    }
+    memcpy(&_header, block, sizeof(_header));
+    if (_header.magic != MAGIC || _header.version != VERSION || _header.columns != COLUMN_COUNT
+        || _header.payloadBytes != len - sizeof(_header)
+        || _header.payloadBytes < COLUMN_COUNT * sizeof(uint16_t)) {
+        return false;
+    }
+    const uint8_t* payload = block + sizeof(_header);
+    if (crc32(payload, _header.payloadBytes) != _header.crc) {
+        return false;
+    }
+
+    size_t offset = COLUMN_COUNT * sizeof(uint16_t);
+    for (uint8_t c = 0; c < COLUMN_COUNT; c++) {
+        uint16_t n;
+        memcpy(&n, payload + c * sizeof(uint16_t), sizeof(n));
+        if (offset + n > _header.payloadBytes) {
+            return false;
+        }
+        _streams[c].begin(payload + offset, n);
+        offset += n;
+    }
+    return true;
+}
+
+bool ArchiveDecoder::next(DataRecord& r) {
+    if (_read >= _header.count) {
+        return false;
+    }
+    // Projected-out columns are never read; their fields are "not available"
+    RecordSchema::forEach([&](const auto& f, auto index) {
+        constexpr size_t I = decltype(index)::value;
+        constexpr Group group = FIELD_GROUPS[I];
+        constexpr uint8_t slot = slotOf(I);
+        using F = std::decay_t<decltype(f)>;
+        auto& v = r.*f.member;
+        if (!(_columns & (1ULL << columnOf(I)))) {
+            v = RecordSchema::missing<F>();
+            return;
+        }
+        BitReader& rd = _streams[columnOf(I)];
+
+        if constexpr (group == Group::MILLIS) {
+            v = (uint32_t)getDelta(rd, _state.millis);
+        } else if constexpr (group == Group::UTC) {
+            v = getUTC(rd, _state.utc);
+        } else if constexpr (group == Group::DOUBLE) {
+            v = bitsDouble(getXor(rd, _state.doubles[slot]));
+        } else if constexpr (group == Group::BYTE) {
+            v = getByte(rd, _state.bytes[slot]);
+        } else if constexpr (group == Group::STRING) {
+            v = getString(rd, _state.strings[slot]);
+        } else if constexpr (group == Group::VALUE) {
+            v = bitsFloat(getXor(rd, _state.values[_state.strings[0].slot]));
+        } else if constexpr (group == Group::QC) {
+            v = getXor(rd, _state.qc);
+        } else {
+            v = bitsFloat(getXor(rd, _state.floats[slot]));
+        }
+    });
+
+    for (uint8_t c = 0; c < COLUMN_COUNT; c++) {
+        if (_streams[c].failed()) {
+            return false;
+        }
+    }
+    _read++;
+    return true;
+}
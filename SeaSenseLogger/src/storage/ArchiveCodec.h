@@ -0,0 +1,296 @@
+/**
+ * SeaSense Logger - Columnar Archive Codec
+ *
+ * Compresses a block of DataRecords into one bit stream per column, in the
+ * style of Gorilla (Pelkonen et al., VLDB 2015):
+ * - millis and timestamp_utc (as epoch seconds): delta-of-delta, one bit
+ *   for a steady cadence
+ * - float and double fields: XOR with the previous value, storing only
+ *   the meaningful bits, one bit for a repeat. The reading value is XORed
+ *   against the previous reading of the same sensor type, since the four
+ *   probes interleave
+ * - strings: a small per-block dictionary, one bit for a repeat
+ *
+ * Every field round-trips bit-exactly: a record read back from a block is
+ * the record parseCSVLine() produced from the CSV line it replaced.
+ *
+ * On disk a block is an ArchiveBlockHeader, a table of column stream
+ * lengths, then the streams. Streams are independent, so a reader can
+ * decode just the columns it needs.
+ */
+
+#ifndef SEASENSE_ARCHIVE_CODEC_H
+#define SEASENSE_ARCHIVE_CODEC_H
+
+#include <Arduino.h>
+#include <array>
+#include <vector>
+#include "StorageInterface.h"
+#include "RecordQuery.h"
+#include "RecordSchema.h"
+
+/**
+ * Block header (little-endian, as written by the ESP32)
+ */
+struct ArchiveBlockHeader {
+    uint32_t magic;         // ArchiveCodec::MAGIC
+    uint16_t count;         // records in the block
+    uint8_t version;        // ArchiveCodec::VERSION
+    uint8_t columns;        // ArchiveCodec::COLUMN_COUNT
+    uint32_t minMillis;
+    uint32_t maxMillis;
+    uint32_t payloadBytes;  // column table + streams
+    uint32_t crc;           // CRC-32 of the payload
+};
+
+/**
+ * One block in the archive index file
+ */
+struct ArchiveIndexEntry {
+    uint32_t offset;        // block start in the archive file
+    uint32_t bytes;         // header + payload
+    uint32_t minMillis;
+    uint32_t maxMillis;
+    uint32_t srcEnd;        // segment byte offset past the last line encoded
+    uint16_t count;         // records in the block
+    uint16_t segment;       // segment the lines came from
+};
+
+static_assert(sizeof(ArchiveBlockHeader) == 24, "Archive block header layout");
+static_assert(sizeof(ArchiveIndexEntry) == 24, "Archive index entry layout");
+
+namespace ArchiveCodec {
+
+static const uint32_t MAGIC = 0x31415353;   // "SSA1"
+static const uint8_t VERSION = 1;
+static const uint8_t DICT_SIZE = 16;        // strings kept per column per block
+static const uint8_t DICT_BITS = 4;
+static const size_t STREAM_LIMIT = 60000;   // column stream bytes (table holds uint16)
+
+// ============================================================================
+// Column layout, generated from RecordSchema: one column per field, grouped
+// by codec in Group order, schema order within a group
+// ============================================================================
+
+enum class Group : uint8_t { MILLIS, UTC, DOUBLE, BYTE, STRING, VALUE, QC, FLOAT };
+
+template <typename F>
+constexpr Group groupOf() {
+    using T = typename F::Type;
+    using RecordSchema::Format;
+    if constexpr (F::format == Format::UTC) {
+        return Group::UTC;
+    } else if constexpr (F::format == Format::READING) {
+        return Group::VALUE;
+    } else if constexpr (F::format == Format::QC) {
+        return Group::QC;
+    } else if constexpr (std::is_same<T, unsigned long>::value) {
+        return Group::MILLIS;
+    } else if constexpr (std::is_same<T, double>::value) {
+        return Group::DOUBLE;
+    } else if constexpr (std::is_same<T, uint8_t>::value) {
+        return Group::BYTE;
+    } else if constexpr (std::is_same<T, String>::value) {
+        return Group::STRING;
+    } else {
+        static_assert(std::is_same<T, float>::value, "No archive codec for this field type");
+        return Group::FLOAT;
+    }
+}
+
+template <size_t... I>
+constexpr std::array<Group, RecordSchema::COUNT> fieldGroups(std::index_sequence<I...>) {
+    return {{groupOf<RecordSchema::FieldAt<I>>()...}};
+}
+
+constexpr std::array<Group, RecordSchema::COUNT> FIELD_GROUPS =
+    fieldGroups(std::make_index_sequence<RecordSchema::COUNT>());
+
+constexpr uint8_t groupSize(Group g) {
+    uint8_t n = 0;
+    for (Group x : FIELD_GROUPS) n += (x == g);
+    return n;
+}
+
+constexpr uint8_t groupStart(Group g) {
+    uint8_t n = 0;
+    for (Group x : FIELD_GROUPS) n += (x < g);
+    return n;
+}
+
+/** Position of a field among the fields of its group */
+constexpr uint8_t slotOf(size_t field) {
+    uint8_t n = 0;
+    for (size_t i = 0; i < field; i++) n += (FIELD_GROUPS[i] == FIELD_GROUPS[field]);
+    return n;
+}
+
+constexpr uint8_t columnOf(size_t field) {
+    return groupStart(FIELD_GROUPS[field]) + slotOf(field);
+}
+
+// Column streams, in file order
+enum Column : uint8_t {
+    COL_MILLIS,
+    COL_UTC,
+    COL_LATITUDE,
+    COL_LONGITUDE,
+    COL_ALTITUDE,
+    COL_HDOP,
+    COL_SATELLITES,
+    COL_INSTANCE,
+    COL_TYPE,
+    COL_MODEL,
+    COL_SERIAL,
+    COL_CALIBRATION,
+    COL_UNIT,
+    COL_QUALITY,
+    COL_VALUE,
+    COL_QC,
+    COL_FLOATS,             // environment and derived floats, DataRecord order
+    COLUMN_COUNT = COL_FLOATS + 22
+};
+
+// The schema decides the layout; these pin it to format VERSION 1. If one
+// fails, the schema changed the block format: bump VERSION (old blocks
+// then need their own decoder)
+static_assert(COLUMN_COUNT == RecordSchema::COUNT, "Archive column set changed");
+static_assert(groupStart(Group::UTC) == COL_UTC && groupStart(Group::DOUBLE) == COL_LATITUDE
+              && groupStart(Group::BYTE) == COL_SATELLITES && groupStart(Group::STRING) == COL_TYPE
+              && groupStart(Group::VALUE) == COL_VALUE && groupStart(Group::QC) == COL_QC
+              && groupStart(Group::FLOAT) == COL_FLOATS, "Archive column order changed");
+static_assert(groupSize(Group::MILLIS) == 1 && groupSize(Group::UTC) == 1
+              && groupSize(Group::VALUE) == 1 && groupSize(Group::QC) == 1,
+              "One column each for millis, UTC, value and QC");
+
+// Values are XORed per sensor type: the type column precedes the value
+static constexpr size_t TYPE_FIELD = 7;
+static_assert((1ULL << TYPE_FIELD) == RecordField::SENSOR_TYPE, "Sensor type field");
+static_assert(columnOf(TYPE_FIELD) == COL_TYPE, "Sensor type is the first string column");
+
+uint32_t crc32(const uint8_t* data, size_t len);
+
+/**
+ * "YYYY-MM-DDTHH:MM:SSZ" to epoch seconds
+ * @return false unless utc is a valid date and time in exactly that form
+ *         (so TimeService::formatUTC() gives the same string back)
+ */
+bool parseUTC(const String& utc, int64_t& seconds);
+
+// ============================================================================
+// Bit streams and per-column state (shared by encoder and decoder)
+// ============================================================================
+
+class BitWriter {
+public:
+    void write(uint64_t value, uint8_t bits);
+    void clear() { _bytes.clear(); _bits = 0; }
+    const std::vector<uint8_t>& bytes() const { return _bytes; }
+private:
+    std::vector<uint8_t> _bytes;
+    uint32_t _bits = 0;
+};
+
+class BitReader {
+public:
+    void begin(const uint8_t* data, size_t len) { _data = data; _len = len * 8; _pos = 0; _failed = false; }
+    uint64_t read(uint8_t bits);
+    void fail() { _failed = true; }
+    bool failed() const { return _failed; }
+private:
+    const uint8_t* _data = nullptr;
+    size_t _len = 0;
+    size_t _pos = 0;
+    bool _failed = false;
+};
+
+struct DeltaState {
+    int64_t prev = 0;
+    int64_t delta = 0;
+};
+
+template <typename T>
+struct XorState {
+    T prev = 0;
+    uint8_t leading = 0xFF;     // 0xFF = no window yet
+    uint8_t trailing = 0;
+};
+
+struct DictState {
+    String entries[DICT_SIZE];
+    uint8_t count = 0;
+    String last;
+    uint8_t slot = DICT_SIZE;   // dictionary index of last (DICT_SIZE if not kept)
+};
+
+struct ColumnState {
+    DeltaState millis;
+    DeltaState utc;
+    XorState<uint64_t> doubles[groupSize(Group::DOUBLE)];
+    uint8_t bytes[groupSize(Group::BYTE)] = {};
+    DictState strings[groupSize(Group::STRING)];
+    XorState<uint32_t> values[DICT_SIZE + 1];   // per sensor type slot
+    XorState<uint32_t> qc;
+    XorState<uint32_t> floats[groupSize(Group::FLOAT)];
+};
+
+} // namespace ArchiveCodec
+
+/**
+ * Builds one block, a record at a time
+ */
+class ArchiveEncoder {
+public:
+    ArchiveEncoder();
+
+    void add(const DataRecord& record);
+
+    uint16_t count() const { return _count; }
+
+    /** A column stream is near its size limit: finish() before adding more */
+    bool full() const;
+
+    /**
+     * Serialize the block (header + payload) and start a new one
+     * @param out Receives the block bytes
+     * @return Header of the block written
+     */
+    ArchiveBlockHeader finish(std::vector<uint8_t>& out);
+
+    void reset();
+
+private:
+    ArchiveCodec::BitWriter _streams[ArchiveCodec::COLUMN_COUNT];
+    ArchiveCodec::ColumnState _state;
+    uint16_t _count;
+    uint32_t _minMillis;
+    uint32_t _maxMillis;
+};
+
+/**
+ * Reads the records of one block back in order
+ */
+class ArchiveDecoder {
+public:
+    /**
+     * @param block Header + payload; must outlive the decoder
+     * @param fields RecordField mask; other columns are not decoded and
+     *               their fields come back as "not available"
+     * @return false if the block is truncated, damaged or of another version
+     */
+    bool begin(const uint8_t* block, size_t len, uint64_t fields = RecordField::ALL);
+
+    /** Next record; false at the end of the block or on a damaged stream */
+    bool next(DataRecord& record);
+
+    const ArchiveBlockHeader& header() const { return _header; }
+
+private:
+    ArchiveBlockHeader _header;
+    ArchiveCodec::BitReader _streams[ArchiveCodec::COLUMN_COUNT];
+    ArchiveCodec::ColumnState _state;
+    uint64_t _columns = 0;      // bit per ArchiveCodec::Column to decode
+    uint16_t _read = 0;
+};
+
+#endif // SEASENSE_ARCHIVE_CODEC_H
@@ -0,0 +1,160 @@
+/**
+ * SeaSense Logger - Record Query Implementation
+ */
+
+#include "RecordQuery.h"
+#include "RecordSchema.h"
+#include "../sensors/QualityControl.h"
+#include "../system/TimeService.h"
+#include <ctype.h>
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Bit index of the predicate fields
+static const uint8_t F_MILLIS = 0;
+static const uint8_t F_LATITUDE = 2;
+static const uint8_t F_LONGITUDE = 3;
+static const uint8_t F_SENSOR_TYPE = 7;
+static const uint8_t F_QUALITY = 14;
+
+// Older files have only the first 10 (or 15) columns
+static const uint8_t MIN_FIELDS = 10;
+
+bool RecordQuery::hasBoundingBox() const {
+    return !isnan(minLatitude) || !isnan(maxLatitude)
+        || !isnan(minLongitude) || !isnan(maxLongitude);
+}
+
+uint64_t RecordQuery::neededFields() const {
+    uint64_t needed = fields;
+    if (sensorType.length() > 0) needed |= RecordField::SENSOR_TYPE;
+    if (quality.length() > 0) needed |= RecordField::QUALITY;
+    if (minMillis != 0 || maxMillis != ULONG_MAX) needed |= RecordField::MILLIS;
+    if (hasBoundingBox()) needed |= RecordField::LATITUDE | RecordField::LONGITUDE;
+    return needed;
+}
+
+// NaN comparisons are false, so a record without a fix fails any bound
+static bool withinBounds(double v, double lo, double hi) {
+    if (!isnan(lo) && !(v >= lo)) return false;
+    if (!isnan(hi) && !(v <= hi)) return false;
+    return true;
+}
+
+bool RecordQuery::accepts(uint8_t field, const DataRecord& record) const {
+    switch (field) {
+        case F_MILLIS:
+            return record.millis >= minMillis && record.millis <= maxMillis;
+        case F_LATITUDE:
+            return withinBounds(record.latitude, minLatitude, maxLatitude);
+        case F_LONGITUDE:
+            return withinBounds(record.longitude, minLongitude, maxLongitude);
+        case F_SENSOR_TYPE:
+            return sensorType.length() == 0 || record.sensorType == sensorType;
+        case F_QUALITY:
+            return quality.length() == 0 || record.quality == quality;
+        default:
+            return true;
+    }
+}
+
+bool RecordQuery::matches(const DataRecord& record) const {
+    return accepts(F_MILLIS, record) && accepts(F_LATITUDE, record)
+        && accepts(F_LONGITUDE, record) && accepts(F_SENSOR_TYPE, record)
+        && accepts(F_QUALITY, record);
+}
+
+// ============================================================================
+// CSV parsing
+// ============================================================================
+
+// Copy a trimmed field into buf for strtod()/strtoul(); false if empty
+static bool numberField(const char* begin, const char* end, char* buf, size_t size) {
+    size_t len = end - begin;
+    if (len == 0) return false;
+    if (len >= size) len = size - 1;
+    memcpy(buf, begin, len);
+    buf[len] = '\0';
+    return true;
+}
+
+// Convert one trimmed column [b, e) of line into its field
+template <typename F>
+static void parseField(const F& f, DataRecord& record, const String& line,
+                       const char* b, const char* e) {
+    using T = typename F::Type;
+    using RecordSchema::Format;
+    T& v = record.*f.member;
+    const char* text = line.c_str();
+    char buf[32];
+
+    if constexpr (F::format == Format::UTC) {
+        v = line.substring(b - text, e - text);
+        if (v == TimeService::UNSYNCED_UTC) v = "";
+    } else if constexpr (F::format == Format::QC) {
+        v = QcFlags::fromString(line.substring(b - text, e - text)).packed;
+    } else if constexpr (F::format == Format::READING) {
+        v = numberField(b, e, buf, sizeof(buf)) ? (T)strtod(buf, nullptr) : 0;
+    } else if constexpr (std::is_same<T, String>::value) {
+        v = line.substring(b - text, e - text);
+    } else if constexpr (std::is_floating_point<T>::value) {
+        v = numberField(b, e, buf, sizeof(buf)) ? (T)strtod(buf, nullptr) : NAN;
+    } else if constexpr (std::is_unsigned<T>::value && sizeof(T) >= sizeof(uint32_t)) {
+        v = numberField(b, e, buf, sizeof(buf)) ? (T)strtoul(buf, nullptr, 10) : 0;
+    } else {
+        v = numberField(b, e, buf, sizeof(buf)) ? (T)strtol(buf, nullptr, 10) : 0;
+    }
+}
+
+bool parseCSVRecord(const String& line, DataRecord& record, const RecordQuery& query) {
+    RecordSchema::clear(record);
+
+    const uint64_t needed = query.neededFields();
+    const char* p = line.c_str();
+    const char* end = p + line.length();
+    uint8_t fields = 0;         // columns seen
+    bool rejected = false;
+    bool done = false;          // nothing left to convert
+
+    RecordSchema::whileEach([&](const auto& f, auto index) {
+        constexpr size_t I = decltype(index)::value;
+        const char* comma = (const char*)memchr(p, ',', end - p);
+        const char* fieldEnd = comma ? comma : end;
+
+        if (needed & (1ULL << I)) {
+            // Trim, as String::trim() would
+            const char* b = p;
+            const char* e = fieldEnd;
+            while (b < e && isspace((unsigned char)*b)) b++;
+            while (e > b && isspace((unsigned char)e[-1])) e--;
+            parseField(f, record, line, b, e);
+
+            // Reject as soon as the predicate fails, before converting the rest
+            if (!query.accepts(I, record)) {
+                rejected = true;
+                return false;
+            }
+        }
+
+        fields = I + 1;
+        if (!comma) {
+            return false;
+        }
+        p = comma + 1;
+        fields = I + 2;         // the column after the comma exists
+
+        if (fields >= MIN_FIELDS && (needed >> (I + 1)) == 0) {
+            done = true;
+            return false;
+        }
+        return true;
+    });
+
+    if (rejected) {
+        return false;
+    }
+    // Support old format (15 fields) and new format (30-38 fields); a
+    // predicate on a column the line does not have fails
+    return fields >= MIN_FIELDS && (done || query.matches(record));
+}
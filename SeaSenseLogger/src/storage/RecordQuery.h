@@ -0,0 +1,89 @@
+/**
+ * SeaSense Logger - Record Query
+ *
+ * What a storage reader wants back: a field mask (projection) and a
+ * predicate (sensor type, quality, millis range, bounding box). Readers
+ * push both down:
+ * - the CSV parser converts only the masked fields, and stops at the
+ *   first field that rules the row out or once nothing it needs is left
+ * - the archive decoder skips unneeded columns, and the index skips
+ *   blocks outside the millis range
+ * Fields left out of the mask keep their "not available" value (NaN,
+ * empty string, 0).
+ */
+
+#ifndef SEASENSE_RECORD_QUERY_H
+#define SEASENSE_RECORD_QUERY_H
+
+#include <Arduino.h>
+#include <limits.h>
+
+struct DataRecord;
+
+/**
+ * One bit per CSV column, in file order (see DataRecord)
+ */
+namespace RecordField {
+    static const uint8_t COUNT = 38;
+
+    static const uint64_t MILLIS           = 1ULL << 0;
+    static const uint64_t TIMESTAMP_UTC    = 1ULL << 1;
+    static const uint64_t LATITUDE         = 1ULL << 2;
+    static const uint64_t LONGITUDE        = 1ULL << 3;
+    static const uint64_t ALTITUDE         = 1ULL << 4;
+    static const uint64_t GPS_SATELLITES   = 1ULL << 5;
+    static const uint64_t GPS_HDOP         = 1ULL << 6;
+    static const uint64_t SENSOR_TYPE      = 1ULL << 7;
+    static const uint64_t SENSOR_MODEL     = 1ULL << 8;
+    static const uint64_t SENSOR_SERIAL    = 1ULL << 9;
+    static const uint64_t SENSOR_INSTANCE  = 1ULL << 10;
+    static const uint64_t CALIBRATION_DATE = 1ULL << 11;
+    static const uint64_t VALUE            = 1ULL << 12;
+    static const uint64_t UNIT             = 1ULL << 13;
+    static const uint64_t QUALITY          = 1ULL << 14;
+    static const uint64_t ENVIRONMENT      = 0xFFFFFULL << 15;  // wind .. lin_accel_z
+    static const uint64_t QC_FLAGS         = 1ULL << 35;
+    static const uint64_t DO_SATURATION    = 1ULL << 36;
+    static const uint64_t SOUND_SPEED      = 1ULL << 37;
+
+    static const uint64_t BASE = (1ULL << 15) - 1;   // millis .. quality
+    static const uint64_t ALL = (1ULL << COUNT) - 1;
+}
+
+struct RecordQuery {
+    uint64_t fields = RecordField::ALL;
+
+    // Predicate (defaults match everything)
+    String sensorType;                  // exact match, "" = any
+    String quality;                     // exact match, "" = any
+    unsigned long minMillis = 0;
+    unsigned long maxMillis = ULONG_MAX;
+    double minLatitude = NAN;           // bounding box, NaN = none;
+    double maxLatitude = NAN;           // records without a fix never match one
+    double minLongitude = NAN;
+    double maxLongitude = NAN;
+
+    bool hasBoundingBox() const;
+
+    /** Fields the reader must convert: the mask plus what the predicate reads */
+    uint64_t neededFields() const;
+
+    /**
+     * Check the predicate on one just-converted field
+     * @param field Bit index in RecordField
+     * @return false if the record can no longer match
+     */
+    bool accepts(uint8_t field, const DataRecord& record) const;
+
+    /** Check the whole predicate on a converted record */
+    bool matches(const DataRecord& record) const;
+};
+
+/**
+ * Parse one CSV line, converting only query.neededFields()
+ * @return false if the line is malformed (fewer than 10 fields) or the
+ *         record does not match the query
+ */
+bool parseCSVRecord(const String& line, DataRecord& record, const RecordQuery& query);
+
+#endif // SEASENSE_RECORD_QUERY_H
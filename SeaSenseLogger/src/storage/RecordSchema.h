@@ -0,0 +1,214 @@
+/**
+ * SeaSense Logger - Record Schema
+ *
+ * The one description of a DataRecord row: CSV column name, precision,
+ * upload key and format of every field, in file order. The CSV header,
+ * CSV writer and parser, the upload JSON and the archive column layout
+ * are all generated from FIELDS by templates, unrolled at compile time.
+ *
+ * Adding a field: add the DataRecord member and one line here, at the
+ * end (CSV files grow to the right; older rows parse with it missing).
+ * The archive layout then changes too, which the static_assert in
+ * ArchiveCodec.h points out.
+ */
+
+#ifndef SEASENSE_RECORD_SCHEMA_H
+#define SEASENSE_RECORD_SCHEMA_H
+
+#include <Arduino.h>
+#include <math.h>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include "StorageInterface.h"
+#include "../sensors/QualityControl.h"
+#include "../system/TimeService.h"
+
+namespace RecordSchema {
+
+enum class Format : uint8_t {
+    PLAIN,      // number or text as is; floating point NaN = empty column
+    UTC,        // timestamp_utc: TimeService::UNSYNCED_UTC on disk while ""
+    READING,    // the sensor value: written even if NaN, empty reads as 0,
+                // archived per sensor type
+    QC          // packed QcFlags, one digit per test
+};
+
+template <typename T, Format F = Format::PLAIN>
+struct Field {
+    using Type = T;
+    static constexpr Format format = F;
+
+    T DataRecord::* member;
+    const char* csv;        // CSV header name
+    uint8_t decimals;       // CSV precision (floating point only)
+    const char* json;       // upload key; nullptr = mapped by hand in buildPayload()
+};
+
+inline constexpr auto FIELDS = std::make_tuple(
+    Field<unsigned long>{&DataRecord::millis, "millis", 0, nullptr},
+    Field<String, Format::UTC>{&DataRecord::timestampUTC, "timestamp_utc", 0, nullptr},
+    Field<double>{&DataRecord::latitude, "latitude", 6, nullptr},
+    Field<double>{&DataRecord::longitude, "longitude", 6, nullptr},
+    Field<double>{&DataRecord::altitude, "altitude", 1, nullptr},
+    Field<uint8_t>{&DataRecord::gps_satellites, "gps_sats", 0, nullptr},
+    Field<double>{&DataRecord::gps_hdop, "gps_hdop", 1, nullptr},
+    Field<String>{&DataRecord::sensorType, "sensor_type", 0, nullptr},
+    Field<String>{&DataRecord::sensorModel, "sensor_model", 0, "sensor_model"},
+    Field<String>{&DataRecord::sensorSerial, "sensor_serial", 0, "sensor_serial"},
+    Field<uint8_t>{&DataRecord::sensorInstance, "sensor_instance", 0, "sensor_instance"},
+    Field<String>{&DataRecord::calibrationDate, "calibration_date", 0, "calibration_date"},
+    Field<float, Format::READING>{&DataRecord::value, "value", 2, nullptr},
+    Field<String>{&DataRecord::unit, "unit", 0, nullptr},
+    Field<String>{&DataRecord::quality, "quality", 0, nullptr},
+    // NMEA2000 environmental context
+    Field<float>{&DataRecord::windSpeedTrue, "wind_speed_true_ms", 2, "wind_speed_true_ms"},
+    Field<float>{&DataRecord::windAngleTrue, "wind_angle_true_deg", 1, "wind_angle_true_deg"},
+    Field<float>{&DataRecord::windSpeedApparent, "wind_speed_app_ms", 2, "wind_speed_app_ms"},
+    Field<float>{&DataRecord::windAngleApparent, "wind_angle_app_deg", 1, "wind_angle_app_deg"},
+    Field<float>{&DataRecord::waterDepth, "water_depth_m", 2, "water_depth_m"},
+    Field<float>{&DataRecord::speedThroughWater, "stw_ms", 2, "speed_through_water_ms"},
+    Field<float>{&DataRecord::waterTempExternal, "water_temp_ext_c", 2, "water_temp_external_c"},
+    Field<float>{&DataRecord::airTemp, "air_temp_c", 2, "air_temp_c"},
+    Field<float>{&DataRecord::baroPressure, "baro_pressure_pa", 0, "baro_pressure_pa"},
+    Field<float>{&DataRecord::humidity, "humidity_pct", 1, "humidity_pct"},
+    Field<float>{&DataRecord::cogTrue, "cog_deg", 1, "cog_true_deg"},
+    Field<float>{&DataRecord::sog, "sog_ms", 2, "sog_ms"},
+    Field<float>{&DataRecord::heading, "heading_deg", 1, "heading_true_deg"},
+    Field<float>{&DataRecord::pitch, "pitch_deg", 1, "pitch_deg"},
+    Field<float>{&DataRecord::roll, "roll_deg", 1, "roll_deg"},
+    Field<float>{&DataRecord::windSpeedCorrected, "wind_speed_corr_ms", 2, "wind_speed_corr_ms"},
+    Field<float>{&DataRecord::windAngleCorrected, "wind_angle_corr_deg", 1, "wind_angle_corr_deg"},
+    Field<float>{&DataRecord::linAccelX, "lin_accel_x", 3, "lin_accel_x"},
+    Field<float>{&DataRecord::linAccelY, "lin_accel_y", 3, "lin_accel_y"},
+    Field<float>{&DataRecord::linAccelZ, "lin_accel_z", 3, "lin_accel_z"},
+    Field<uint32_t, Format::QC>{&DataRecord::qcFlags, "qc_flags", 0, nullptr},
+    // Derived at write time
+    Field<float>{&DataRecord::doSaturation, "do_sat_pct", 1, "do_saturation_pct"},
+    Field<float>{&DataRecord::soundSpeed, "sound_speed_ms", 2, "sound_speed_ms"}
+);
+
+constexpr size_t COUNT = std::tuple_size<decltype(FIELDS)>::value;
+
+static_assert(COUNT == RecordField::COUNT, "RecordField has one bit per schema field");
+static_assert(COUNT <= 64, "Field masks are 64 bits");
+
+template <size_t I>
+using FieldAt = typename std::decay<decltype(std::get<I>(FIELDS))>::type;
+
+template <size_t I>
+using Index = std::integral_constant<size_t, I>;
+
+template <typename Fn, size_t... I>
+inline void forEachImpl(Fn& fn, std::index_sequence<I...>) {
+    (fn(std::get<I>(FIELDS), Index<I>()), ...);
+}
+
+/** Call fn(field, Index<I>) for every field, in file order (unrolled) */
+template <typename Fn>
+inline void forEach(Fn&& fn) {
+    forEachImpl(fn, std::make_index_sequence<COUNT>());
+}
+
+template <typename Fn, size_t... I>
+inline bool whileEachImpl(Fn& fn, std::index_sequence<I...>) {
+    return (fn(std::get<I>(FIELDS), Index<I>()) && ...);
+}
+
+/** As forEach(), stopping at the first call that returns false */
+template <typename Fn>
+inline bool whileEach(Fn&& fn) {
+    return whileEachImpl(fn, std::make_index_sequence<COUNT>());
+}
+
+/** A field's "not available" value: NaN, "" or 0 */
+template <typename F>
+inline typename F::Type missing() {
+    using T = typename F::Type;
+    if constexpr (std::is_floating_point<T>::value) {
+        return NAN;
+    } else if constexpr (std::is_same<T, String>::value) {
+        return String();
+    } else {
+        return 0;
+    }
+}
+
+/** Set every field of record to missing() */
+inline void clear(DataRecord& record) {
+    forEach([&](const auto& f, auto) {
+        record.*f.member = missing<std::decay_t<decltype(f)>>();
+    });
+}
+
+// ============================================================================
+// CSV
+// ============================================================================
+
+inline String csvHeader() {
+    String header;
+    forEach([&](const auto& f, auto i) {
+        if (i > 0) header += ",";
+        header += f.csv;
+    });
+    return header;
+}
+
+template <typename F>
+inline void appendCSVField(String& out, const F& f, const DataRecord& record) {
+    using T = typename F::Type;
+    const T& v = record.*f.member;
+    if constexpr (F::format == Format::UTC) {
+        out += v.length() > 0 ? v : String(TimeService::UNSYNCED_UTC);
+    } else if constexpr (F::format == Format::QC) {
+        out += QcFlags(v).toString();
+    } else if constexpr (F::format == Format::READING) {
+        out += String(v, f.decimals);
+    } else if constexpr (std::is_same<T, String>::value) {
+        out += v;
+    } else if constexpr (std::is_floating_point<T>::value) {
+        if (!isnan(v)) out += String(v, f.decimals);
+    } else {
+        out += String(v);
+    }
+}
+
+/** Append one CSV row, without line ending */
+inline void appendCSV(String& out, const DataRecord& record) {
+    forEach([&](const auto& f, auto i) {
+        if (i > 0) out += ",";
+        appendCSVField(out, f, record);
+    });
+}
+
+inline String toCSV(const DataRecord& record) {
+    String csv;
+    csv.reserve(256);
+    appendCSV(csv, record);
+    return csv;
+}
+
+// ============================================================================
+// JSON
+// ============================================================================
+
+/**
+ * Write the fields that have an upload key; NaN floats are left out
+ * @param obj ArduinoJson JsonObject (or anything indexable the same way)
+ */
+template <typename Object>
+inline void toJSON(const DataRecord& record, Object& obj) {
+    forEach([&](const auto& f, auto) {
+        using T = typename std::decay_t<decltype(f)>::Type;
+        if (f.json == nullptr) return;
+        const T& v = record.*f.member;
+        if constexpr (std::is_floating_point<T>::value) {
+            if (isnan(v)) return;
+        }
+        obj[f.json] = v;
+    });
+}
+
+} // namespace RecordSchema
+
+#endif // SEASENSE_RECORD_SCHEMA_H
@@ -3,6 +3,8 @@
  */
 
 #include "SDStorage.h"
+#include "RecordSchema.h"
+#include "../system/TimeService.h"
 #include "../../config/hardware_config.h"
 #include "../system/SystemHealth.h"
 #include <ArduinoJson.h>
@@ -10,6 +12,9 @@
 // File paths
 const char* SDStorage::DATA_FILE = "/data.csv";
 const char* SDStorage::METADATA_FILE = "/metadata.json";
+const char* SDStorage::SEGMENT_FILE = "/data.seg.csv";
+const char* SDStorage::ARCHIVE_FILE = "/archive.bin";
+const char* SDStorage::ARCHIVE_INDEX = "/archive.idx";
 
 // ============================================================================
 // Constructor / Destructor
@@ -18,10 +23,22 @@ const char* SDStorage::METADATA_FILE = "/metadata.json";
 SDStorage::SDStorage(uint8_t csPin)
     : _csPin(csPin),
       _mounted(false),
-      _spi(HSPI)
+      _spi(HSPI),
+      _liveRecords(0),
+      _removedRecords(0),
+      _archive{0, 0, 0, false},
+      _segmentLines(0),
+      _segmentStart(0),
+      _segmentCursor(0),
+      _layoutGen(0),
+      _layoutDepth(0)
 {
+#ifndef NATIVE_TEST
+    portMUX_INITIALIZE(&_layoutMux);
+#endif
     _metadata.lastUploadedMillis = 0;
     _metadata.recordsAtLastUpload = 0;
+    _metadata.archiveSegment = 0;
 }
 
 SDStorage::~SDStorage() {
@@ -30,6 +47,14 @@ SDStorage::~SDStorage() {
     }
 }
 
+void SDStorage::end() {
+    if (_mounted) {
+        SD.end();
+        _mounted = false;
+    }
+    _spi.end();
+}
+
 // ============================================================================
 // IStorage Interface Implementation
 // ============================================================================
@@ -163,6 +188,10 @@ bool SDStorage::begin() {
         return false;
     }
 
+    uint32_t lines = countLines(DATA_FILE);
+    _liveRecords = lines > 0 ? lines - 1 : 0;
+    loadArchive();
+
     DEBUG_STORAGE_PRINT("SD card initialized, ");
     DEBUG_STORAGE_PRINT(countRecords());
     DEBUG_STORAGE_PRINTLN(" records");
@@ -189,61 +218,56 @@ bool SDStorage::writeRecord(const DataRecord& record) {
     String csvLine = recordToCSV(record);
 
     // Safe write with power-loss protection
-    return safeWrite(csvLine);
+    size_t lineStart = 0;
+    if (!safeWrite(csvLine, &lineStart)) {
+        return false;
+    }
+    _backfill.noteWrite(lineStart, record.timestampUTC.length() == 0);
+    _liveRecords++;
+    return true;
 }
 
-std::vector<DataRecord> SDStorage::readRecords(
-    unsigned long startMillis,
+std::vector<DataRecord> SDStorage::queryRecords(
+    const RecordQuery& query,
     uint16_t maxRecords,
-    uint32_t skipRecords
+    uint32_t skipRecords,
+    uint32_t* scanned
 ) {
     std::vector<DataRecord> records;
+    uint32_t examined = 0;
 
     if (!_mounted) {
+        if (scanned) *scanned = 0;
         return records;
     }
 
-    File file = SD.open(DATA_FILE, FILE_READ);
-    if (!file) {
-        DEBUG_STORAGE_PRINTLN("Failed to open data file for reading");
-        return records;
-    }
-
-    // Skip CSV header
-    if (file.available()) {
-        file.readStringUntil('\n');
-    }
-
-    // Skip already-processed records (e.g. already-uploaded prefix)
-    extern SystemHealth systemHealth;
-    for (uint32_t i = 0; i < skipRecords && file.available(); i++) {
-        file.readStringUntil('\n');
-        if ((i & 99) == 99) {  // every 100 lines
-            systemHealth.feedWatchdog();
+    // Oldest first: the archive, the rest of the closed segment, the live file.
+    // Blocks committed meanwhile are not read (their lines still are, from
+    // the segment); a segment closed or removed meanwhile means starting over
+    for (uint8_t attempt = 0; attempt < 5; attempt++) {
+        Layout layout = snapshotLayout();
+        if (layout.gen & 1) {
+            delay(20);
+            continue;
         }
-    }
-
-    // Read records
-    uint32_t parsed = 0;
-    while (file.available() && records.size() < maxRecords) {
-        String line = file.readStringUntil('\n');
-        line.trim();
-
-        if (line.length() == 0) continue;
-
-        DataRecord record;
-        if (parseCSVLine(line, record)) {
-            // Filter by start time if specified
-            if (startMillis == 0 || record.millis >= startMillis) {
-                records.push_back(record);
-            }
+        uint32_t skip = skipRecords;
+        readArchiveRecords(query, layout, maxRecords, skip, examined, records);
+        if (layout.segmentPending && records.size() < maxRecords) {
+            readCSVRecords(SEGMENT_FILE, layout.segmentStart, query, maxRecords, skip, examined, records);
         }
-        if ((++parsed & 49) == 49) {  // every 50 records
-            systemHealth.feedWatchdog();
+        if (records.size() < maxRecords) {
+            readCSVRecords(DATA_FILE, 0, query, maxRecords, skip, examined, records);
         }
+        if (snapshotLayout().gen == layout.gen) {
+            break;
+        }
+        DEBUG_STORAGE_PRINTLN("Storage layout changed during read, reading again");
+        records.clear();
+        examined = 0;
+    }
+    if (scanned) {
+        *scanned = examined;
     }
-
-    file.close();
 
     DEBUG_STORAGE_PRINT("Read ");
     DEBUG_STORAGE_PRINT(records.size());
@@ -260,10 +284,7 @@ StorageStats SDStorage::getStats() const {
         stats.totalBytes = SD.totalBytes();
         stats.usedBytes = SD.usedBytes();
         stats.freeBytes = stats.totalBytes - stats.usedBytes;
-        stats.totalRecords = countRecords();
-        stats.recordsSinceUpload = (stats.totalRecords > _metadata.recordsAtLastUpload)
-            ? (stats.totalRecords - _metadata.recordsAtLastUpload)
-            : stats.totalRecords;
+        getUploadProgress(stats.totalRecords, stats.recordsSinceUpload);
         stats.status = getStatus();
     } else {
         stats.totalBytes = 0;
@@ -303,19 +324,29 @@ bool SDStorage::clear() {
     }
 
     DEBUG_STORAGE_PRINTLN("Clearing all SD card data");
-
-    // Remove data file
-    if (SD.exists(DATA_FILE)) {
-        SD.remove(DATA_FILE);
+    beginLayoutChange();
+    _removedRecords += countRecords();
+
+    // Remove data file, segment and archive
+    const char* files[] = {DATA_FILE, SEGMENT_FILE, ARCHIVE_FILE, ARCHIVE_INDEX};
+    for (const char* path : files) {
+        if (SD.exists(path)) {
+            SD.remove(path);
+        }
     }
 
     // Reset metadata
     _metadata.lastUploadedMillis = 0;
     _metadata.recordsAtLastUpload = 0;
+    _backfill.reset();
     saveMetadata();
+    _liveRecords = 0;
+    loadArchive();
 
     // Recreate data file with header
-    return ensureDataFileWithHeader();
+    bool ok = ensureDataFileWithHeader();
+    endLayoutChange();
+    return ok;
 }
 
 bool SDStorage::format() {
@@ -331,75 +362,11 @@ bool SDStorage::flush() {
 }
 
 String SDStorage::getCSVHeader() const {
-    return "millis,timestamp_utc,latitude,longitude,altitude,gps_sats,gps_hdop,"
-           "sensor_type,sensor_model,sensor_serial,sensor_instance,calibration_date,"
-           "value,unit,quality,"
-           "wind_speed_true_ms,wind_angle_true_deg,wind_speed_app_ms,wind_angle_app_deg,"
-           "water_depth_m,stw_ms,water_temp_ext_c,air_temp_c,baro_pressure_pa,"
-           "humidity_pct,cog_deg,sog_ms,heading_deg,pitch_deg,roll_deg,"
-           "wind_speed_corr_ms,wind_angle_corr_deg,"
-           "lin_accel_x,lin_accel_y,lin_accel_z";
-}
-
-// Helper: format float for CSV, empty string if NaN
-static String csvFloat(float v, int decimals) {
-    if (isnan(v)) return "";
-    return String(v, decimals);
+    return RecordSchema::csvHeader();
 }
 
 String SDStorage::recordToCSV(const DataRecord& record) const {
-    String csv = "";
-    csv += String(record.millis);
-    csv += ",";
-    csv += record.timestampUTC.length() > 0 ? record.timestampUTC : "";
-    csv += ",";
-    csv += isnan(record.latitude)  ? "" : String(record.latitude,  6);
-    csv += ",";
-    csv += isnan(record.longitude) ? "" : String(record.longitude, 6);
-    csv += ",";
-    csv += isnan(record.altitude)  ? "" : String(record.altitude,  1);
-    csv += ",";
-    csv += String(record.gps_satellites);
-    csv += ",";
-    csv += isnan(record.gps_hdop)  ? "" : String(record.gps_hdop,  1);
-    csv += ",";
-    csv += record.sensorType;
-    csv += ",";
-    csv += record.sensorModel;
-    csv += ",";
-    csv += record.sensorSerial;
-    csv += ",";
-    csv += String(record.sensorInstance);
-    csv += ",";
-    csv += record.calibrationDate;
-    csv += ",";
-    csv += String(record.value, 2);
-    csv += ",";
-    csv += record.unit;
-    csv += ",";
-    csv += record.quality;
-    // NMEA2000 environmental fields (empty if NaN/unavailable)
-    csv += "," + csvFloat(record.windSpeedTrue, 2);
-    csv += "," + csvFloat(record.windAngleTrue, 1);
-    csv += "," + csvFloat(record.windSpeedApparent, 2);
-    csv += "," + csvFloat(record.windAngleApparent, 1);
-    csv += "," + csvFloat(record.waterDepth, 2);
-    csv += "," + csvFloat(record.speedThroughWater, 2);
-    csv += "," + csvFloat(record.waterTempExternal, 2);
-    csv += "," + csvFloat(record.airTemp, 2);
-    csv += "," + csvFloat(record.baroPressure, 0);
-    csv += "," + csvFloat(record.humidity, 1);
-    csv += "," + csvFloat(record.cogTrue, 1);
-    csv += "," + csvFloat(record.sog, 2);
-    csv += "," + csvFloat(record.heading, 1);
-    csv += "," + csvFloat(record.pitch, 1);
-    csv += "," + csvFloat(record.roll, 1);
-    csv += "," + csvFloat(record.windSpeedCorrected, 2);
-    csv += "," + csvFloat(record.windAngleCorrected, 1);
-    csv += "," + csvFloat(record.linAccelX, 3);
-    csv += "," + csvFloat(record.linAccelY, 3);
-    csv += "," + csvFloat(record.linAccelZ, 3);
-    return csv;
+    return RecordSchema::toCSV(record);
 }
 
 unsigned long SDStorage::getLastUploadedMillis() const {
@@ -412,6 +379,105 @@ bool SDStorage::setLastUploadedMillis(unsigned long millis) {
     return saveMetadata();
 }
 
+bool SDStorage::advanceUploadCursor(uint32_t records, unsigned long lastMillis, bool persist) {
+    _metadata.recordsAtLastUpload = min(_metadata.recordsAtLastUpload + records, countRecords());
+    _metadata.lastUploadedMillis = lastMillis;
+    return persist ? saveMetadata() : true;
+}
+
+void SDStorage::getUploadProgress(uint32_t& totalRecords, uint32_t& pending) const {
+    totalRecords = countRecords();
+    pending = (totalRecords > _metadata.recordsAtLastUpload)
+        ? (totalRecords - _metadata.recordsAtLastUpload)
+        : 0;
+}
+
+uint16_t SDStorage::backfillTimestamps(const TimeService& time, unsigned long now, uint16_t maxRecords) {
+    if (!_mounted || !_backfill.isPending()) {
+        return 0;
+    }
+
+    File file = SD.open(DATA_FILE, "r+");
+    if (!file) {
+        DEBUG_STORAGE_PRINTLN("Failed to open data file for back-fill");
+        _backfill.openFailed(now);
+        return 0;
+    }
+    uint16_t repaired = _backfill.run(file, time, now, maxRecords);
+    file.flush();
+    file.close();
+    return repaired;
+}
+
+uint16_t SDStorage::compactArchive(uint16_t maxRecords) {
+    if (!_mounted) {
+        return 0;
+    }
+    if (!_archive.segmentPending) {
+        // Close the live file once it is full, but never while back-fill
+        // still holds offsets into it
+        if (_liveRecords < ARCHIVE_SEGMENT_RECORDS || _backfill.isPending() || !closeSegment()) {
+            return 0;
+        }
+    }
+
+    File file = SD.open(SEGMENT_FILE, FILE_READ);
+    if (!file || !file.seek(_segmentCursor)) {
+        DEBUG_STORAGE_PRINTLN("Failed to open segment for compaction");
+        return 0;
+    }
+
+    uint16_t lines = 0;
+    while (lines < maxRecords && _encoder.count() < ARCHIVE_BLOCK_RECORDS
+           && !_encoder.full() && file.available()) {
+        String line = file.readStringUntil('\n');
+        _segmentCursor += line.length() + 1;
+        line.trim();
+
+        DataRecord record;
+        if (line.length() > 0 && parseCSVLine(line, record)) {
+            _encoder.add(record);
+        } else {
+            _dropped.push_back(_encoder.count() + _dropped.size());
+        }
+        lines++;
+    }
+    bool atEnd = !file.available();
+    file.close();
+
+    bool blockDone = _encoder.count() >= ARCHIVE_BLOCK_RECORDS || _encoder.full();
+    if ((blockDone || atEnd) && (_encoder.count() > 0 || !_dropped.empty())) {
+        if (!commitBlock()) {
+            // Build the block again from the last committed line
+            _segmentCursor = _segmentStart;
+            _encoder.reset();
+            _dropped.clear();
+            return 0;
+        }
+    }
+
+    if (atEnd && _segmentCursor == _segmentStart) {
+        beginLayoutChange();
+        SD.remove(SEGMENT_FILE);
+        _archive.segmentPending = false;
+        _segmentLines = 0;
+        endLayoutChange();
+        DEBUG_STORAGE_PRINT("Segment archived, archive now ");
+        DEBUG_STORAGE_PRINT(_archive.records);
+        DEBUG_STORAGE_PRINT(" records in ");
+        DEBUG_STORAGE_PRINT((uint32_t)_archive.bytes);
+        DEBUG_STORAGE_PRINTLN(" bytes");
+    }
+    return lines;
+}
+
+SDStorage::ArchiveStats SDStorage::getArchiveStats() const {
+    lockLayout();
+    ArchiveStats stats = _archive;
+    unlockLayout();
+    return stats;
+}
+
 // ============================================================================
 // SD-Specific Methods
 // ============================================================================
@@ -483,6 +549,7 @@ bool SDStorage::loadMetadata() {
 
     _metadata.lastUploadedMillis = doc["lastUploadedMillis"] | 0UL;
     _metadata.recordsAtLastUpload = doc["recordsAtLastUpload"] | 0U;
+    _metadata.archiveSegment = doc["archiveSegment"] | 0U;
 
     DEBUG_STORAGE_PRINTLN("Metadata loaded from SD card");
     return true;
@@ -502,6 +569,7 @@ bool SDStorage::saveMetadata() {
     JsonDocument doc;
     doc["lastUploadedMillis"] = _metadata.lastUploadedMillis;
     doc["recordsAtLastUpload"] = _metadata.recordsAtLastUpload;
+    doc["archiveSegment"] = _metadata.archiveSegment;
 
     serializeJson(doc, file);
     file.flush();
@@ -512,14 +580,25 @@ bool SDStorage::saveMetadata() {
 }
 
 uint32_t SDStorage::countRecords() const {
-    if (!_mounted || !SD.exists(DATA_FILE)) {
+    if (!_mounted) {
+        return 0;
+    }
+    return _archive.records + _segmentLines + _liveRecords;
+}
+
+uint32_t SDStorage::countLines(const char* path, size_t start) const {
+    if (!_mounted || !SD.exists(path)) {
         return 0;
     }
 
-    File file = SD.open(DATA_FILE, FILE_READ);
+    File file = SD.open(path, FILE_READ);
     if (!file) {
         return 0;
     }
+    if (start > 0 && !file.seek(start)) {
+        file.close();
+        return 0;
+    }
 
     uint32_t count = 0;
     while (file.available()) {
@@ -527,101 +606,356 @@ uint32_t SDStorage::countRecords() const {
         count++;
     }
     file.close();
+    return count;
+}
+
+void SDStorage::readCSVRecords(const char* path, size_t start, const RecordQuery& query,
+                               uint16_t maxRecords, uint32_t& skip, uint32_t& scanned,
+                               std::vector<DataRecord>& records) {
+    File file = SD.open(path, FILE_READ);
+    if (!file) {
+        DEBUG_STORAGE_PRINTLN("Failed to open data file for reading");
+        return;
+    }
 
-    // Subtract 1 for header line
-    return count > 0 ? count - 1 : 0;
+    if (start == 0) {
+        // Skip CSV header
+        if (file.available()) {
+            file.readStringUntil('\n');
+        }
+    } else if (!file.seek(start)) {
+        file.close();
+        return;
+    }
+
+    // Skip already-processed records (e.g. already-uploaded prefix)
+    extern SystemHealth systemHealth;
+    uint32_t skipped = 0;
+    for (; skipped < skip && file.available(); skipped++) {
+        file.readStringUntil('\n');
+        if ((skipped & 99) == 99) {  // every 100 lines
+            systemHealth.feedWatchdog();
+        }
+    }
+    skip -= skipped;
+
+    // Read records
+    uint32_t parsed = 0;
+    while (file.available() && records.size() < maxRecords) {
+        String line = file.readStringUntil('\n');
+        line.trim();
+        scanned++;
+
+        if (line.length() == 0) continue;
+
+        DataRecord record;
+        if (parseCSVRecord(line, record, query)) {
+            records.push_back(record);
+        }
+        if ((++parsed & 49) == 49) {  // every 50 records
+            systemHealth.feedWatchdog();
+        }
+    }
+
+    file.close();
 }
 
-// Helper: parse a CSV field as float, returning NaN for empty fields
-static float parseOptionalFloat(const String& field) {
-    if (field.length() == 0) return NAN;
-    return field.toFloat();
+void SDStorage::readArchiveRecords(const RecordQuery& query, const Layout& layout,
+                                   uint16_t maxRecords, uint32_t& skip, uint32_t& scanned,
+                                   std::vector<DataRecord>& records) {
+    if (layout.records == 0) {
+        return;
+    }
+    if (skip >= layout.records) {
+        skip -= layout.records;     // e.g. all uploaded: no need to touch the card
+        return;
+    }
+
+    File index = SD.open(ARCHIVE_INDEX, FILE_READ);
+    File data = SD.open(ARCHIVE_FILE, FILE_READ);
+    if (!index || !data) {
+        DEBUG_STORAGE_PRINTLN("Failed to open archive for reading");
+        if (index) index.close();
+        if (data) data.close();
+        return;
+    }
+
+    extern SystemHealth systemHealth;
+    ArchiveIndexEntry entry;
+    ArchiveDecoder decoder;
+    std::vector<uint8_t> block;
+    DataRecord record;
+    for (uint32_t b = 0; b < layout.blocks && records.size() < maxRecords
+                         && index.read((uint8_t*)&entry, sizeof(entry)) == sizeof(entry); b++) {
+        // Skipped blocks and blocks outside the millis range are never read,
+        // only their index entry
+        if (skip >= entry.count) {
+            skip -= entry.count;
+            continue;
+        }
+        uint32_t first = skip;     // records of this block already skipped
+        skip = 0;
+        if (entry.maxMillis < query.minMillis || entry.minMillis > query.maxMillis) {
+            scanned += entry.count - first;
+            continue;
+        }
+
+        block.resize(entry.bytes);
+        if (!data.seek(entry.offset) || data.read(block.data(), entry.bytes) != entry.bytes
+            || !decoder.begin(block.data(), block.size(), query.neededFields())) {
+            DEBUG_STORAGE_PRINTLN("Damaged archive block skipped");
+            scanned += entry.count - first;
+            continue;
+        }
+        uint32_t position = 0;
+        while (records.size() < maxRecords && decoder.next(record)) {
+            if (position++ < first) {
+                continue;
+            }
+            scanned++;
+            if (query.matches(record)) {
+                records.push_back(record);
+            }
+        }
+        if (records.size() < maxRecords && position < entry.count) {
+            // Damaged stream: the rest of the block is passed over
+            scanned += entry.count - (position > first ? position : first);
+        }
+        systemHealth.feedWatchdog();
+    }
+
+    index.close();
+    data.close();
 }
 
-bool SDStorage::parseCSVLine(const String& line, DataRecord& record) const {
-    // Parse CSV: millis,timestamp_utc,latitude,longitude,altitude,gps_sats,gps_hdop,
-    //            sensor_type,sensor_model,sensor_serial,sensor_instance,
-    //            calibration_date,value,unit,quality,
-    //            [env fields 15-29...]
-
-    // Initialize environmental fields to NaN (backwards compat with old CSV)
-    record.windSpeedTrue = NAN;
-    record.windAngleTrue = NAN;
-    record.windSpeedApparent = NAN;
-    record.windAngleApparent = NAN;
-    record.waterDepth = NAN;
-    record.speedThroughWater = NAN;
-    record.waterTempExternal = NAN;
-    record.airTemp = NAN;
-    record.baroPressure = NAN;
-    record.humidity = NAN;
-    record.cogTrue = NAN;
-    record.sog = NAN;
-    record.heading = NAN;
-    record.pitch = NAN;
-    record.roll = NAN;
-    record.windSpeedCorrected = NAN;
-    record.windAngleCorrected = NAN;
-    record.linAccelX = NAN;
-    record.linAccelY = NAN;
-    record.linAccelZ = NAN;
-
-    int fieldIndex = 0;
-    int lastComma = -1;
-    int nextComma = 0;
-
-    for (int i = 0; i <= (int)line.length(); i++) {
-        if (i == (int)line.length() || line[i] == ',') {
-            nextComma = i;
-            String field = line.substring(lastComma + 1, nextComma);
-            field.trim();
-
-            switch (fieldIndex) {
-                case 0: record.millis = field.toInt(); break;
-                case 1: record.timestampUTC = field; break;
-                case 2: record.latitude  = field.length() == 0 ? NAN : field.toDouble(); break;
-                case 3: record.longitude = field.length() == 0 ? NAN : field.toDouble(); break;
-                case 4: record.altitude  = field.length() == 0 ? NAN : field.toDouble(); break;
-                case 5: record.gps_satellites = field.toInt(); break;
-                case 6: record.gps_hdop  = field.length() == 0 ? NAN : field.toDouble(); break;
-                case 7: record.sensorType = field; break;
-                case 8: record.sensorModel = field; break;
-                case 9: record.sensorSerial = field; break;
-                case 10: record.sensorInstance = field.toInt(); break;
-                case 11: record.calibrationDate = field; break;
-                case 12: record.value = field.toFloat(); break;
-                case 13: record.unit = field; break;
-                case 14: record.quality = field; break;
-                // NMEA2000 environmental fields (optional)
-                case 15: record.windSpeedTrue = parseOptionalFloat(field); break;
-                case 16: record.windAngleTrue = parseOptionalFloat(field); break;
-                case 17: record.windSpeedApparent = parseOptionalFloat(field); break;
-                case 18: record.windAngleApparent = parseOptionalFloat(field); break;
-                case 19: record.waterDepth = parseOptionalFloat(field); break;
-                case 20: record.speedThroughWater = parseOptionalFloat(field); break;
-                case 21: record.waterTempExternal = parseOptionalFloat(field); break;
-                case 22: record.airTemp = parseOptionalFloat(field); break;
-                case 23: record.baroPressure = parseOptionalFloat(field); break;
-                case 24: record.humidity = parseOptionalFloat(field); break;
-                case 25: record.cogTrue = parseOptionalFloat(field); break;
-                case 26: record.sog = parseOptionalFloat(field); break;
-                case 27: record.heading = parseOptionalFloat(field); break;
-                case 28: record.pitch = parseOptionalFloat(field); break;
-                case 29: record.roll = parseOptionalFloat(field); break;
-                case 30: record.windSpeedCorrected = parseOptionalFloat(field); break;
-                case 31: record.windAngleCorrected = parseOptionalFloat(field); break;
-                case 32: record.linAccelX = parseOptionalFloat(field); break;
-                case 33: record.linAccelY = parseOptionalFloat(field); break;
-                case 34: record.linAccelZ = parseOptionalFloat(field); break;
+void SDStorage::loadArchive() {
+    beginLayoutChange();
+    _archive = ArchiveStats{0, 0, 0, false};
+    _segmentLines = 0;
+    _segmentStart = 0;
+    _segmentCursor = 0;
+    _encoder.reset();
+    _dropped.clear();
+
+    ArchiveIndexEntry last;
+    memset(&last, 0, sizeof(last));
+    if (SD.exists(ARCHIVE_INDEX)) {
+        File index = SD.open(ARCHIVE_INDEX, FILE_READ);
+        if (index) {
+            size_t size = index.size();
+            ArchiveIndexEntry entry;
+            while (index.read((uint8_t*)&entry, sizeof(entry)) == sizeof(entry)) {
+                _archive.records += entry.count;
+                _archive.blocks++;
+                _archive.bytes += entry.bytes;
+                last = entry;
+            }
+            index.close();
+
+            // A torn entry (power cut mid-append) would misalign every
+            // entry appended after it
+            if (size % sizeof(ArchiveIndexEntry) != 0) {
+                truncateIndex(_archive.blocks);
             }
+        }
+    }
 
-            fieldIndex++;
-            lastComma = nextComma;
+    if (SD.exists(SEGMENT_FILE)) {
+        if (_archive.blocks > 0 && last.segment == _metadata.archiveSegment) {
+            _segmentStart = last.srcEnd;
+        } else {
+            File segment = SD.open(SEGMENT_FILE, FILE_READ);
+            _segmentStart = segment ? segment.readStringUntil('\n').length() + 1 : 0;
+            if (segment) segment.close();
+        }
+        _segmentCursor = _segmentStart;
+        _segmentLines = countLines(SEGMENT_FILE, _segmentStart);
+        _archive.segmentPending = true;
+        if (_segmentLines == 0) {
+            // Fully archived before the last reset, not yet deleted
+            SD.remove(SEGMENT_FILE);
+            _archive.segmentPending = false;
         }
     }
 
-    // Support old format (15 fields) and new format (30-35 fields)
-    return (fieldIndex >= 10);
+    if (_archive.blocks > 0 || _archive.segmentPending) {
+        DEBUG_STORAGE_PRINT("Archive: ");
+        DEBUG_STORAGE_PRINT(_archive.records);
+        DEBUG_STORAGE_PRINT(" records in ");
+        DEBUG_STORAGE_PRINT(_archive.blocks);
+        DEBUG_STORAGE_PRINT(" blocks, segment lines pending: ");
+        DEBUG_STORAGE_PRINTLN(_segmentLines);
+    }
+    endLayoutChange();
+}
+
+SDStorage::Layout SDStorage::snapshotLayout() const {
+    lockLayout();
+    Layout layout{_archive.records, _archive.blocks, _archive.segmentPending,
+                  _segmentStart, _layoutGen};
+    unlockLayout();
+    return layout;
+}
+
+void SDStorage::beginLayoutChange() {
+    if (_layoutDepth++ == 0) {
+        lockLayout();
+        _layoutGen++;
+        unlockLayout();
+    }
+}
+
+void SDStorage::endLayoutChange() {
+    if (--_layoutDepth == 0) {
+        lockLayout();
+        _layoutGen++;
+        unlockLayout();
+    }
+}
+
+void SDStorage::lockLayout() const {
+#ifndef NATIVE_TEST
+    portENTER_CRITICAL(&_layoutMux);
+#endif
+}
+
+void SDStorage::unlockLayout() const {
+#ifndef NATIVE_TEST
+    portEXIT_CRITICAL(&_layoutMux);
+#endif
+}
+
+bool SDStorage::truncateIndex(uint32_t entries) {
+    static const char* TMP_FILE = "/archive.idx.tmp";
+    File in = SD.open(ARCHIVE_INDEX, FILE_READ);
+    File out = SD.open(TMP_FILE, FILE_WRITE);
+    if (!in || !out) {
+        if (in) in.close();
+        if (out) out.close();
+        return false;
+    }
+    ArchiveIndexEntry entry;
+    for (uint32_t i = 0; i < entries && in.read((uint8_t*)&entry, sizeof(entry)) == sizeof(entry); i++) {
+        out.write((const uint8_t*)&entry, sizeof(entry));
+    }
+    in.close();
+    out.flush();
+    out.close();
+
+    SD.remove(ARCHIVE_INDEX);
+    bool ok = SD.rename(TMP_FILE, ARCHIVE_INDEX);
+    DEBUG_STORAGE_PRINTLN(ok ? "Archive index repaired" : "Archive index repair failed");
+    return ok;
+}
+
+bool SDStorage::closeSegment() {
+    // New number first: the segment must not pick up an older one's progress
+    _metadata.archiveSegment++;
+    if (!saveMetadata()) {
+        return false;
+    }
+    beginLayoutChange();
+    if (!SD.rename(DATA_FILE, SEGMENT_FILE)) {
+        endLayoutChange();
+        DEBUG_STORAGE_PRINTLN("Failed to close data segment");
+        return false;
+    }
+    _backfill.reset();     // nothing pending (checked by the caller)
+    _segmentLines = _liveRecords;
+    _liveRecords = 0;
+    ensureDataFileWithHeader();
+
+    File segment = SD.open(SEGMENT_FILE, FILE_READ);
+    _segmentStart = segment ? segment.readStringUntil('\n').length() + 1 : 0;
+    if (segment) segment.close();
+    _segmentCursor = _segmentStart;
+    _encoder.reset();
+    _dropped.clear();
+    _archive.segmentPending = true;
+    endLayoutChange();
+
+    DEBUG_STORAGE_PRINT("Closed data segment ");
+    DEBUG_STORAGE_PRINT(_metadata.archiveSegment);
+    DEBUG_STORAGE_PRINT(", ");
+    DEBUG_STORAGE_PRINT(_segmentLines);
+    DEBUG_STORAGE_PRINTLN(" records to archive");
+    return true;
+}
+
+bool SDStorage::commitBlock() {
+    uint32_t lines = _encoder.count() + _dropped.size();
+    std::vector<uint8_t> block;
+    ArchiveBlockHeader header = _encoder.finish(block);
+
+    File data = SD.open(ARCHIVE_FILE, FILE_APPEND);
+    if (!data) {
+        DEBUG_STORAGE_PRINTLN("Failed to open archive for writing");
+        return false;
+    }
+    ArchiveIndexEntry entry;
+    entry.offset = data.size();
+    entry.bytes = block.size();
+    entry.minMillis = header.minMillis;
+    entry.maxMillis = header.maxMillis;
+    entry.srcEnd = _segmentCursor;
+    entry.count = header.count;
+    entry.segment = _metadata.archiveSegment;
+    size_t written = data.write(block.data(), block.size());
+    data.flush();
+    data.close();
+    if (written != block.size()) {
+        return false;
+    }
+
+    // The block exists once its index entry does: a block without one is
+    // dead space and gets written again
+    File index = SD.open(ARCHIVE_INDEX, FILE_APPEND);
+    if (!index) {
+        return false;
+    }
+    written = index.write((const uint8_t*)&entry, sizeof(entry));
+    index.flush();
+    index.close();
+    if (written != sizeof(entry)) {
+        loadArchive();  // drops the torn entry, resumes from the last good one
+        return false;
+    }
+
+    // Unparseable lines leave the record count: keep the upload position
+    // on the same record
+    uint32_t droppedBeforeUpload = 0;
+    for (uint16_t pos : _dropped) {
+        if (_archive.records + pos < _metadata.recordsAtLastUpload) {
+            droppedBeforeUpload++;
+        }
+    }
+
+    // Appending is not a layout change: readers stop at the blocks they saw
+    lockLayout();
+    _archive.records += header.count;
+    _archive.blocks++;
+    _archive.bytes += entry.bytes;
+    _segmentStart = _segmentCursor;
+    unlockLayout();
+    _segmentLines -= (lines < _segmentLines) ? lines : _segmentLines;
+    _dropped.clear();
+
+    if (droppedBeforeUpload > 0) {
+        _removedRecords += droppedBeforeUpload;
+        _metadata.recordsAtLastUpload -= droppedBeforeUpload;
+        saveMetadata();
+    }
+
+    DEBUG_STORAGE_PRINT("Archived ");
+    DEBUG_STORAGE_PRINT(header.count);
+    DEBUG_STORAGE_PRINT(" records in ");
+    DEBUG_STORAGE_PRINT(entry.bytes);
+    DEBUG_STORAGE_PRINTLN(" bytes");
+    return true;
+}
+
+bool SDStorage::parseCSVLine(const String& line, DataRecord& record) const {
+    return parseCSVRecord(line, record, RecordQuery());
 }
 
 bool SDStorage::ensureDataFileWithHeader() {
@@ -642,7 +976,7 @@ bool SDStorage::ensureDataFileWithHeader() {
     return true;
 }
 
-bool SDStorage::safeWrite(const String& data) {
+bool SDStorage::safeWrite(const String& data, size_t* lineStart) {
     // CRITICAL: Power-loss safe write pattern
     // Open → Write → Flush → Close in single operation
     // NEVER keep file open between cycles
@@ -654,6 +988,9 @@ bool SDStorage::safeWrite(const String& data) {
     }
 
     // Write data
+    if (lineStart) {
+        *lineStart = file.size();
+    }
     file.println(data);
 
     // Flush buffers to ensure data is written to SD card
@@ -6,12 +6,25 @@
  * - Removable for manual data retrieval
  * - Power-loss safe write operations
  * - CSV format with full sensor metadata
+ * - Older records compacted into a columnar, Gorilla-compressed archive
+ *
+ * Records live in up to three places, oldest first, and readRecords()
+ * walks them in that order so record positions never change:
+ *   /archive.bin   compressed blocks (ArchiveCodec), located via /archive.idx
+ *   /data.seg.csv  the closed segment being compacted, from where the
+ *                  archive ends
+ *   /data.csv      the live file, appended by writeRecord()
+ * When the live file reaches ARCHIVE_SEGMENT_RECORDS it is renamed to the
+ * segment, and compactArchive() moves the segment into the archive a batch
+ * of lines at a time. The segment is deleted once fully archived.
  */
 
 #ifndef SD_STORAGE_H
 #define SD_STORAGE_H
 
 #include "StorageInterface.h"
+#include "TimestampBackfill.h"
+#include "ArchiveCodec.h"
 #include <SD.h>
 #include <SPI.h>
 
@@ -33,10 +46,11 @@ public:
     virtual bool isMounted() const override;
     virtual bool write(const SensorData& data) override;
     virtual bool writeRecord(const DataRecord& record) override;
-    virtual std::vector<DataRecord> readRecords(
-        unsigned long startMillis = 0,
+    virtual std::vector<DataRecord> queryRecords(
+        const RecordQuery& query,
         uint16_t maxRecords = 100,
-        uint32_t skipRecords = 0
+        uint32_t skipRecords = 0,
+        uint32_t* scanned = nullptr
     ) override;
     virtual StorageStats getStats() const override;
     virtual StorageStatus getStatus() const override;
@@ -48,6 +62,12 @@ public:
     virtual String recordToCSV(const DataRecord& record) const override;
     virtual unsigned long getLastUploadedMillis() const override;
     virtual bool setLastUploadedMillis(unsigned long millis) override;
+    virtual bool advanceUploadCursor(uint32_t records, unsigned long lastMillis, bool persist = true) override;
+    virtual void getUploadProgress(uint32_t& totalRecords, uint32_t& pending) const override;
+    virtual uint32_t getRemovedRecords() const override { return _removedRecords; }
+    virtual uint16_t backfillTimestamps(const TimeService& time, unsigned long now, uint16_t maxRecords) override;
+    virtual bool isBackfillPending() const override { return _backfill.isPending(); }
+    virtual uint16_t compactArchive(uint16_t maxRecords) override;
 
     // ========================================================================
     // SD-Specific Methods
@@ -71,6 +91,20 @@ public:
      */
     String getCardType() const;
 
+    /**
+     * Unmount and release the SPI bus (begin() mounts again)
+     */
+    void end();
+
+    struct ArchiveStats {
+        uint32_t records;           // records in compressed blocks
+        uint32_t blocks;
+        uint64_t bytes;             // archive file bytes in use
+        bool segmentPending;        // a closed segment is still being compacted
+    };
+
+    ArchiveStats getArchiveStats() const;
+
 private:
     // ========================================================================
     // Configuration
@@ -83,13 +117,50 @@ private:
     // File paths
     static const char* DATA_FILE;        // "/data.csv"
     static const char* METADATA_FILE;    // "/metadata.json"
+    static const char* SEGMENT_FILE;     // "/data.seg.csv"
+    static const char* ARCHIVE_FILE;     // "/archive.bin"
+    static const char* ARCHIVE_INDEX;    // "/archive.idx"
 
     // Metadata
     struct Metadata {
         unsigned long lastUploadedMillis;
         uint32_t recordsAtLastUpload;
+        uint16_t archiveSegment;         // number of the newest closed segment
     } _metadata;
 
+    // Placeholder timestamps from this boot awaiting clock sync
+    TimestampBackfill _backfill;
+
+    // Records in DATA_FILE (counted in begin(), then kept current)
+    uint32_t _liveRecords;
+
+    // Records cleared or dropped from before the upload cursor since boot
+    uint32_t _removedRecords;
+
+    // Archive state, rebuilt from the index in begin()
+    ArchiveStats _archive;
+    uint32_t _segmentLines;             // segment lines not yet archived
+    size_t _segmentStart;               // segment bytes before this are archived
+    size_t _segmentCursor;              // segment bytes read into _encoder
+    ArchiveEncoder _encoder;            // block being built
+    std::vector<uint16_t> _dropped;     // unparseable lines in it (line positions)
+
+    // The layout (archive blocks, segment, live file) changes on loop() while
+    // the web task may be reading it: readers snapshot it under _layoutMux and
+    // start over if _layoutGen moved by the time they are done
+    struct Layout {
+        uint32_t records;               // archive records
+        uint32_t blocks;                // archive blocks (index entries)
+        bool segmentPending;
+        size_t segmentStart;
+        uint32_t gen;
+    };
+#ifndef NATIVE_TEST
+    mutable portMUX_TYPE _layoutMux;
+#endif
+    uint32_t _layoutGen;                // odd while files are renamed/removed
+    uint8_t _layoutDepth;               // nested begin/endLayoutChange()
+
     // ========================================================================
     // Helper Methods
     // ========================================================================
@@ -113,7 +184,67 @@ private:
     uint32_t countRecords() const;
 
     /**
-     * Parse CSV line into DataRecord
+     * Count lines in a file
+     * @param start Byte offset to count from
+     */
+    uint32_t countLines(const char* path, size_t start = 0) const;
+
+    /**
+     * Read CSV records from a file, after skipping `skip` of them
+     * @param start Byte offset of the first line (0 = skip the header)
+     * @param scanned Incremented for every line examined after the skip
+     */
+    void readCSVRecords(const char* path, size_t start, const RecordQuery& query,
+                        uint16_t maxRecords, uint32_t& skip, uint32_t& scanned,
+                        std::vector<DataRecord>& records);
+
+    /**
+     * Read records from the archive; skipped blocks and blocks outside the
+     * query's millis range are passed over through the index without
+     * reading them, and only the query's columns are decoded. Stops after
+     * the layout's blocks: later ones hold records still read from the segment
+     */
+    void readArchiveRecords(const RecordQuery& query, const Layout& layout,
+                            uint16_t maxRecords, uint32_t& skip, uint32_t& scanned,
+                            std::vector<DataRecord>& records);
+
+    Layout snapshotLayout() const;
+
+    /**
+     * Bracket a change readers must not see half done (files renamed,
+     * removed or the archive reloaded); nests
+     */
+    void beginLayoutChange();
+    void endLayoutChange();
+
+    void lockLayout() const;
+    void unlockLayout() const;
+
+    /**
+     * Rebuild archive state from the index and resume a pending segment
+     */
+    void loadArchive();
+
+    /**
+     * Rewrite the index with only its first entries (drops a torn entry)
+     * @return true if rewritten
+     */
+    bool truncateIndex(uint32_t entries);
+
+    /**
+     * Rename the live file to the segment and start a new one
+     * @return true if a segment is now pending
+     */
+    bool closeSegment();
+
+    /**
+     * Append the encoder's block to the archive and its entry to the index
+     * @return true if both were written
+     */
+    bool commitBlock();
+
+    /**
+     * Parse CSV line into DataRecord (all fields; see parseCSVRecord())
      * @param line CSV line string
      * @param record Output DataRecord
      * @return true if parsing successful
@@ -131,9 +262,10 @@ private:
      * Safe write operation with power-loss protection
      * Opens file, writes, flushes, and closes immediately
      * @param data String data to write
+     * @param lineStart If set, receives the byte offset the line starts at
      * @return true if successful
      */
-    bool safeWrite(const String& data);
+    bool safeWrite(const String& data, size_t* lineStart = nullptr);
 };
 
 #endif // SD_STORAGE_H
@@ -3,6 +3,8 @@
  */
 
 #include "SPIFFSStorage.h"
+#include "RecordSchema.h"
+#include "../system/TimeService.h"
 #include "../../config/hardware_config.h"
 #include "../system/SystemHealth.h"
 #include <ArduinoJson.h>
@@ -22,6 +24,7 @@ SPIFFSStorage::SPIFFSStorage(uint16_t maxRecords)
     : _maxRecords(maxRecords),
       _mounted(false),
       _cachedRecordCount(0),
+      _removedRecords(0),
       _metadataDirtyCount(0),
       _uploadHistoryCount(0),
       _uploadHistoryHead(0)
@@ -40,6 +43,13 @@ SPIFFSStorage::~SPIFFSStorage() {
     }
 }
 
+void SPIFFSStorage::end() {
+    if (_mounted) {
+        SPIFFS.end();
+        _mounted = false;
+    }
+}
+
 // ============================================================================
 // IStorage Interface Implementation
 // ============================================================================
@@ -129,7 +139,9 @@ bool SPIFFSStorage::writeRecord(const DataRecord& record) {
 
     // Write CSV line
     String csvLine = recordToCSV(record);
+    size_t lineStart = file.size();
     file.println(csvLine);
+    _backfill.noteWrite(lineStart, record.timestampUTC.length() == 0);
 
     // Flush and close
     file.flush();
@@ -156,12 +168,16 @@ bool SPIFFSStorage::writeRecord(const DataRecord& record) {
     return true;
 }
 
-std::vector<DataRecord> SPIFFSStorage::readRecords(
-    unsigned long startMillis,
+std::vector<DataRecord> SPIFFSStorage::queryRecords(
+    const RecordQuery& query,
     uint16_t maxRecords,
-    uint32_t skipRecords
+    uint32_t skipRecords,
+    uint32_t* scanned
 ) {
     std::vector<DataRecord> records;
+    if (scanned) {
+        *scanned = 0;
+    }
 
     if (!_mounted) {
         return records;
@@ -192,15 +208,15 @@ std::vector<DataRecord> SPIFFSStorage::readRecords(
     while (file.available() && records.size() < maxRecords) {
         String line = file.readStringUntil('\n');
         line.trim();
+        if (scanned) {
+            (*scanned)++;
+        }
 
         if (line.length() == 0) continue;
 
         DataRecord record;
-        if (parseCSVLine(line, record)) {
-            // Filter by start time if specified
-            if (startMillis == 0 || record.millis >= startMillis) {
-                records.push_back(record);
-            }
+        if (parseCSVRecord(line, record, query)) {
+            records.push_back(record);
         }
         if ((++parsed & 49) == 49) {  // every 50 records
             systemHealth.feedWatchdog();
@@ -224,10 +240,7 @@ StorageStats SPIFFSStorage::getStats() const {
         stats.totalBytes = SPIFFS.totalBytes();
         stats.usedBytes = SPIFFS.usedBytes();
         stats.freeBytes = stats.totalBytes - stats.usedBytes;
-        stats.totalRecords = _cachedRecordCount;
-        stats.recordsSinceUpload = (stats.totalRecords > _metadata.recordsAtLastUpload)
-            ? (stats.totalRecords - _metadata.recordsAtLastUpload)
-            : 0;
+        getUploadProgress(stats.totalRecords, stats.recordsSinceUpload);
         stats.status = StorageStatus::OK;
     } else {
         stats.totalBytes = 0;
@@ -267,10 +280,12 @@ bool SPIFFSStorage::clear() {
     }
 
     // Reset metadata and in-memory count
+    _removedRecords += _cachedRecordCount;
     _metadata.lastUploadedMillis = 0;
     _metadata.totalRecordsWritten = 0;
     _metadata.recordsAtLastUpload = 0;
     _cachedRecordCount = 0;
+    _backfill.reset();
     saveMetadata();
 
     // Recreate data file with header
@@ -299,75 +314,11 @@ bool SPIFFSStorage::flush() {
 }
 
 String SPIFFSStorage::getCSVHeader() const {
-    return "millis,timestamp_utc,latitude,longitude,altitude,gps_sats,gps_hdop,"
-           "sensor_type,sensor_model,sensor_serial,sensor_instance,calibration_date,"
-           "value,unit,quality,"
-           "wind_speed_true_ms,wind_angle_true_deg,wind_speed_app_ms,wind_angle_app_deg,"
-           "water_depth_m,stw_ms,water_temp_ext_c,air_temp_c,baro_pressure_pa,"
-           "humidity_pct,cog_deg,sog_ms,heading_deg,pitch_deg,roll_deg,"
-           "wind_speed_corr_ms,wind_angle_corr_deg,"
-           "lin_accel_x,lin_accel_y,lin_accel_z";
-}
-
-// Helper: format float for CSV, empty string if NaN
-static String csvFloat(float v, int decimals) {
-    if (isnan(v)) return "";
-    return String(v, decimals);
+    return RecordSchema::csvHeader();
 }
 
 String SPIFFSStorage::recordToCSV(const DataRecord& record) const {
-    String csv = "";
-    csv += String(record.millis);
-    csv += ",";
-    csv += record.timestampUTC.length() > 0 ? record.timestampUTC : "";
-    csv += ",";
-    csv += isnan(record.latitude)  ? "" : String(record.latitude,  6);
-    csv += ",";
-    csv += isnan(record.longitude) ? "" : String(record.longitude, 6);
-    csv += ",";
-    csv += isnan(record.altitude)  ? "" : String(record.altitude,  1);
-    csv += ",";
-    csv += String(record.gps_satellites);
-    csv += ",";
-    csv += isnan(record.gps_hdop)  ? "" : String(record.gps_hdop,  1);
-    csv += ",";
-    csv += record.sensorType;
-    csv += ",";
-    csv += record.sensorModel;
-    csv += ",";
-    csv += record.sensorSerial;
-    csv += ",";
-    csv += String(record.sensorInstance);
-    csv += ",";
-    csv += record.calibrationDate;
-    csv += ",";
-    csv += String(record.value, 2);
-    csv += ",";
-    csv += record.unit;
-    csv += ",";
-    csv += record.quality;
-    // NMEA2000 environmental fields (empty if NaN/unavailable)
-    csv += "," + csvFloat(record.windSpeedTrue, 2);
-    csv += "," + csvFloat(record.windAngleTrue, 1);
-    csv += "," + csvFloat(record.windSpeedApparent, 2);
-    csv += "," + csvFloat(record.windAngleApparent, 1);
-    csv += "," + csvFloat(record.waterDepth, 2);
-    csv += "," + csvFloat(record.speedThroughWater, 2);
-    csv += "," + csvFloat(record.waterTempExternal, 2);
-    csv += "," + csvFloat(record.airTemp, 2);
-    csv += "," + csvFloat(record.baroPressure, 0);
-    csv += "," + csvFloat(record.humidity, 1);
-    csv += "," + csvFloat(record.cogTrue, 1);
-    csv += "," + csvFloat(record.sog, 2);
-    csv += "," + csvFloat(record.heading, 1);
-    csv += "," + csvFloat(record.pitch, 1);
-    csv += "," + csvFloat(record.roll, 1);
-    csv += "," + csvFloat(record.windSpeedCorrected, 2);
-    csv += "," + csvFloat(record.windAngleCorrected, 1);
-    csv += "," + csvFloat(record.linAccelX, 3);
-    csv += "," + csvFloat(record.linAccelY, 3);
-    csv += "," + csvFloat(record.linAccelZ, 3);
-    return csv;
+    return RecordSchema::toCSV(record);
 }
 
 unsigned long SPIFFSStorage::getLastUploadedMillis() const {
@@ -381,6 +332,40 @@ bool SPIFFSStorage::setLastUploadedMillis(unsigned long millis) {
     return saveMetadata();
 }
 
+bool SPIFFSStorage::advanceUploadCursor(uint32_t records, unsigned long lastMillis, bool persist) {
+    _metadata.recordsAtLastUpload = min(_metadata.recordsAtLastUpload + records, _cachedRecordCount);
+    _metadata.lastUploadedMillis = lastMillis;
+    if (!persist) {
+        return true;
+    }
+    _metadataDirtyCount = 0;
+    return saveMetadata();
+}
+
+void SPIFFSStorage::getUploadProgress(uint32_t& totalRecords, uint32_t& pending) const {
+    totalRecords = _mounted ? _cachedRecordCount : 0;
+    pending = (totalRecords > _metadata.recordsAtLastUpload)
+        ? (totalRecords - _metadata.recordsAtLastUpload)
+        : 0;
+}
+
+uint16_t SPIFFSStorage::backfillTimestamps(const TimeService& time, unsigned long now, uint16_t maxRecords) {
+    if (!_mounted || !_backfill.isPending()) {
+        return 0;
+    }
+
+    File file = SPIFFS.open(DATA_FILE, "r+");
+    if (!file) {
+        DEBUG_STORAGE_PRINTLN("Failed to open data file for back-fill");
+        _backfill.openFailed(now);
+        return 0;
+    }
+    uint16_t repaired = _backfill.run(file, time, now, maxRecords);
+    file.flush();
+    file.close();
+    return repaired;
+}
+
 void SPIFFSStorage::addBytesUploaded(size_t bytes) {
     _metadata.totalBytesUploaded += bytes;
     saveMetadata();
@@ -523,15 +508,23 @@ bool SPIFFSStorage::trimOldRecords() {
         return false;
     }
 
-    // Copy header line
+    // Copy header line. Byte offsets where the kept lines start in the old
+    // and new file let a pending timestamp back-fill follow the move
+    // (kept lines are copied byte-for-byte: trimmed, then println's CRLF).
+    size_t oldStart = 0;
+    size_t newStart = 0;
     if (src.available()) {
-        dst.println(src.readStringUntil('\n'));
+        String header = src.readStringUntil('\n');
+        oldStart = header.length() + 1;
+        header.trim();
+        dst.println(header);
+        newStart = header.length() + 2;
     }
 
     // Skip old records
     extern SystemHealth systemHealth;
     for (uint32_t i = 0; i < toSkip && src.available(); i++) {
-        src.readStringUntil('\n');
+        oldStart += src.readStringUntil('\n').length() + 1;
         if ((i & 49) == 49) {  // every 50 lines
             systemHealth.feedWatchdog();
         }
@@ -560,6 +553,8 @@ bool SPIFFSStorage::trimOldRecords() {
     SPIFFS.remove(BACKUP_FILE);
 
     _cachedRecordCount = _maxRecords;
+    _removedRecords += toSkip;
+    _backfill.rebase(oldStart, newStart);
 
     // Adjust upload marker: trimmed records were the oldest (already uploaded)
     if (_metadata.recordsAtLastUpload > toSkip) {
@@ -576,96 +571,8 @@ bool SPIFFSStorage::trimOldRecords() {
     return true;
 }
 
-// Helper: parse a CSV field as float, returning NaN for empty fields
-static float parseOptionalFloat(const String& field) {
-    if (field.length() == 0) return NAN;
-    return field.toFloat();
-}
-
 bool SPIFFSStorage::parseCSVLine(const String& line, DataRecord& record) const {
-    // Parse CSV: millis,timestamp_utc,latitude,longitude,altitude,gps_sats,gps_hdop,
-    //            sensor_type,sensor_model,sensor_serial,sensor_instance,
-    //            calibration_date,value,unit,quality,
-    //            [env fields 15-29...]
-
-    // Initialize environmental fields to NaN (backwards compat with old CSV)
-    record.windSpeedTrue = NAN;
-    record.windAngleTrue = NAN;
-    record.windSpeedApparent = NAN;
-    record.windAngleApparent = NAN;
-    record.waterDepth = NAN;
-    record.speedThroughWater = NAN;
-    record.waterTempExternal = NAN;
-    record.airTemp = NAN;
-    record.baroPressure = NAN;
-    record.humidity = NAN;
-    record.cogTrue = NAN;
-    record.sog = NAN;
-    record.heading = NAN;
-    record.pitch = NAN;
-    record.roll = NAN;
-    record.windSpeedCorrected = NAN;
-    record.windAngleCorrected = NAN;
-    record.linAccelX = NAN;
-    record.linAccelY = NAN;
-    record.linAccelZ = NAN;
-
-    int fieldIndex = 0;
-    int lastComma = -1;
-    int nextComma = 0;
-
-    for (int i = 0; i <= (int)line.length(); i++) {
-        if (i == (int)line.length() || line[i] == ',') {
-            nextComma = i;
-            String field = line.substring(lastComma + 1, nextComma);
-            field.trim();
-
-            switch (fieldIndex) {
-                case 0: record.millis = field.toInt(); break;
-                case 1: record.timestampUTC = field; break;
-                case 2: record.latitude  = field.length() == 0 ? NAN : field.toDouble(); break;
-                case 3: record.longitude = field.length() == 0 ? NAN : field.toDouble(); break;
-                case 4: record.altitude  = field.length() == 0 ? NAN : field.toDouble(); break;
-                case 5: record.gps_satellites = field.toInt(); break;
-                case 6: record.gps_hdop  = field.length() == 0 ? NAN : field.toDouble(); break;
-                case 7: record.sensorType = field; break;
-                case 8: record.sensorModel = field; break;
-                case 9: record.sensorSerial = field; break;
-                case 10: record.sensorInstance = field.toInt(); break;
-                case 11: record.calibrationDate = field; break;
-                case 12: record.value = field.toFloat(); break;
-                case 13: record.unit = field; break;
-                case 14: record.quality = field; break;
-                // NMEA2000 environmental fields (optional)
-                case 15: record.windSpeedTrue = parseOptionalFloat(field); break;
-                case 16: record.windAngleTrue = parseOptionalFloat(field); break;
-                case 17: record.windSpeedApparent = parseOptionalFloat(field); break;
-                case 18: record.windAngleApparent = parseOptionalFloat(field); break;
-                case 19: record.waterDepth = parseOptionalFloat(field); break;
-                case 20: record.speedThroughWater = parseOptionalFloat(field); break;
-                case 21: record.waterTempExternal = parseOptionalFloat(field); break;
-                case 22: record.airTemp = parseOptionalFloat(field); break;
-                case 23: record.baroPressure = parseOptionalFloat(field); break;
-                case 24: record.humidity = parseOptionalFloat(field); break;
-                case 25: record.cogTrue = parseOptionalFloat(field); break;
-                case 26: record.sog = parseOptionalFloat(field); break;
-                case 27: record.heading = parseOptionalFloat(field); break;
-                case 28: record.pitch = parseOptionalFloat(field); break;
-                case 29: record.roll = parseOptionalFloat(field); break;
-                case 30: record.windSpeedCorrected = parseOptionalFloat(field); break;
-                case 31: record.windAngleCorrected = parseOptionalFloat(field); break;
-                case 32: record.linAccelX = parseOptionalFloat(field); break;
-                case 33: record.linAccelY = parseOptionalFloat(field); break;
-                case 34: record.linAccelZ = parseOptionalFloat(field); break;
-            }
-
-            fieldIndex++;
-            lastComma = nextComma;
-        }
-    }
-
-    // Support old format (15 fields) and new format (30-35 fields)
-    return (fieldIndex >= 10);
+    return parseCSVRecord(line, record, RecordQuery());
 }
 
 void SPIFFSStorage::setLastSuccessEpoch(int64_t epoch) {
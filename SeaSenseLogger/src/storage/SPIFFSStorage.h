@@ -12,6 +12,7 @@
 #define SPIFFS_STORAGE_H
 
 #include "StorageInterface.h"
+#include "TimestampBackfill.h"
 #include <SPIFFS.h>
 #include <FS.h>
 
@@ -33,10 +34,11 @@ public:
     virtual bool isMounted() const override;
     virtual bool write(const SensorData& data) override;
     virtual bool writeRecord(const DataRecord& record) override;
-    virtual std::vector<DataRecord> readRecords(
-        unsigned long startMillis = 0,
+    virtual std::vector<DataRecord> queryRecords(
+        const RecordQuery& query,
         uint16_t maxRecords = 100,
-        uint32_t skipRecords = 0
+        uint32_t skipRecords = 0,
+        uint32_t* scanned = nullptr
     ) override;
     virtual StorageStats getStats() const override;
     virtual StorageStatus getStatus() const override;
@@ -48,6 +50,14 @@ public:
     virtual String recordToCSV(const DataRecord& record) const override;
     virtual unsigned long getLastUploadedMillis() const override;
     virtual bool setLastUploadedMillis(unsigned long millis) override;
+    virtual bool advanceUploadCursor(uint32_t records, unsigned long lastMillis, bool persist = true) override;
+    virtual void getUploadProgress(uint32_t& totalRecords, uint32_t& pending) const override;
+    virtual uint32_t getRemovedRecords() const override { return _removedRecords; }
+    virtual uint16_t backfillTimestamps(const TimeService& time, unsigned long now, uint16_t maxRecords) override;
+    virtual bool isBackfillPending() const override { return _backfill.isPending(); }
+
+    /** Unmount (begin() mounts again) */
+    void end();
 
     /** Add bytes to the persistent lifetime upload counter */
     void addBytesUploaded(size_t bytes);
@@ -122,7 +132,7 @@ private:
     bool trimOldRecords();
 
     /**
-     * Parse CSV line into DataRecord
+     * Parse CSV line into DataRecord (all fields; see parseCSVRecord())
      * @param line CSV line string
      * @param record Output DataRecord
      * @return true if parsing successful
@@ -149,6 +159,9 @@ private:
     // Initialized from countRecords() once in begin(), then kept current.
     uint32_t _cachedRecordCount;
 
+    // Records trimmed or cleared since boot (getRemovedRecords())
+    uint32_t _removedRecords;
+
     // Metadata batching: save to flash every N writes to reduce wear
     static const uint16_t METADATA_SAVE_INTERVAL = 50;
     uint16_t _metadataDirtyCount;
@@ -161,6 +174,9 @@ private:
     // Crash-safe trim: backup file for atomic rename
     static const char* BACKUP_FILE;  // "/data.bak"
 
+    // Placeholder timestamps from this boot awaiting clock sync
+    TimestampBackfill _backfill;
+
     // Trim hysteresis: only trim when this many records over the limit,
     // so trim runs every ~TRIM_HYSTERESIS writes instead of every write.
     static const uint16_t TRIM_HYSTERESIS = 50;
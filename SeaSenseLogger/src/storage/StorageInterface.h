@@ -11,6 +11,9 @@
 #include <Arduino.h>
 #include <vector>
 #include "../sensors/SensorInterface.h"
+#include "RecordQuery.h"
+
+class TimeService;
 
 /**
  * Storage status enumeration
@@ -48,11 +51,12 @@ struct StorageStats {
  * water_depth_m,stw_ms,water_temp_ext_c,air_temp_c,baro_pressure_pa,
  * humidity_pct,cog_deg,sog_ms,heading_deg,pitch_deg,roll_deg,
  * wind_speed_corr_ms,wind_angle_corr_deg,
- * lin_accel_x,lin_accel_y,lin_accel_z
+ * lin_accel_x,lin_accel_y,lin_accel_z,qc_flags,
+ * do_sat_pct,sound_speed_ms
  */
 struct DataRecord {
     unsigned long millis;      // millis() when reading was taken
-    String timestampUTC;       // Absolute UTC timestamp (from GPS or NTP)
+    String timestampUTC;       // Absolute UTC timestamp (TimeService; "" before sync)
     double latitude;           // GPS latitude in degrees (NaN if no fix)
     double longitude;          // GPS longitude in degrees (NaN if no fix)
     double altitude;           // GPS altitude in meters (NaN if no fix)
@@ -92,6 +96,13 @@ struct DataRecord {
     float linAccelX;           // m/s²
     float linAccelY;           // m/s²
     float linAccelZ;           // m/s²
+
+    // QARTOD QC flags, one per test (packed QcFlags; 0 = QC not run)
+    uint32_t qcFlags;
+
+    // Derived at write time (NaN = inputs not available)
+    float doSaturation;        // % air saturation
+    float soundSpeed;          // m/s
 };
 
 /**
@@ -135,10 +146,31 @@ public:
      * @param skipRecords Number of records to skip from the start (for pagination)
      * @return Vector of DataRecord structures
      */
-    virtual std::vector<DataRecord> readRecords(
+    std::vector<DataRecord> readRecords(
         unsigned long startMillis = 0,
         uint16_t maxRecords = 100,
         uint32_t skipRecords = 0
+    ) {
+        RecordQuery query;
+        query.minMillis = startMillis;
+        return queryRecords(query, maxRecords, skipRecords);
+    }
+
+    /**
+     * Read the records matching a query, converting only its fields
+     * @param query Field mask and predicate
+     * @param maxRecords Maximum number of records to return
+     * @param skipRecords Records to skip from the start, matching or not
+     *                    (positions stay stable for the upload counter)
+     * @param scanned If set, receives how many records past skipRecords were
+     *                examined; skipRecords + *scanned continues the scan
+     * @return Matching records, oldest first
+     */
+    virtual std::vector<DataRecord> queryRecords(
+        const RecordQuery& query,
+        uint16_t maxRecords = 100,
+        uint32_t skipRecords = 0,
+        uint32_t* scanned = nullptr
     ) = 0;
 
     /**
@@ -205,6 +237,55 @@ public:
      * @return true if successful, false otherwise
      */
     virtual bool setLastUploadedMillis(unsigned long millis) = 0;
+
+    /**
+     * Move the upload cursor past the next `records` pending records, e.g.
+     * the ones a broker acknowledged (clamped to the records stored)
+     * @param lastMillis millis() of the last of them
+     * @param persist Save metadata now; otherwise it goes with the next save
+     * @return true if successful, false otherwise
+     */
+    virtual bool advanceUploadCursor(uint32_t records, unsigned long lastMillis, bool persist = true) = 0;
+
+    /**
+     * Records stored and records not yet uploaded, without the filesystem
+     * queries getStats() makes (cheap enough to call every loop)
+     */
+    virtual void getUploadProgress(uint32_t& totalRecords, uint32_t& pending) const = 0;
+
+    /**
+     * Records removed from the front since boot (trimmed, cleared). Added to
+     * a record's position it numbers the record for as long as it is stored
+     */
+    virtual uint32_t getRemovedRecords() const { return 0; }
+
+    /**
+     * Write UTC timestamps into records stored before the clock was synced
+     * (placeholder timestamp_utc), in place
+     * @param maxRecords Lines to repair in this call
+     * @return Number of records repaired
+     */
+    virtual uint16_t backfillTimestamps(const TimeService& time, unsigned long now, uint16_t maxRecords) {
+        (void)time; (void)now; (void)maxRecords;
+        return 0;
+    }
+
+    /**
+     * Check for records from this boot still waiting for a timestamp
+     * @return true if backfillTimestamps() has work left
+     */
+    virtual bool isBackfillPending() const { return false; }
+
+    /**
+     * Move a batch of older records into compressed archive blocks
+     * (background work; readRecords() is unaffected)
+     * @param maxRecords Lines to read in this call
+     * @return Lines processed (0 = nothing to do)
+     */
+    virtual uint16_t compactArchive(uint16_t maxRecords) {
+        (void)maxRecords;
+        return 0;
+    }
 };
 
 /**
@@ -248,6 +329,9 @@ inline DataRecord sensorDataToRecord(const SensorData& data, const String& times
     record.linAccelX = NAN;
     record.linAccelY = NAN;
     record.linAccelZ = NAN;
+    record.qcFlags = 0;
+    record.doSaturation = NAN;
+    record.soundSpeed = NAN;
     return record;
 }
 
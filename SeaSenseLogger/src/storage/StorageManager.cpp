@@ -5,6 +5,7 @@
 #include "StorageManager.h"
 #include "../../config/hardware_config.h"
 #include "../system/SystemHealth.h"
+#include "../system/RecoveryManager.h"
 
 // ============================================================================
 // Constructor / Destructor
@@ -80,55 +81,34 @@ bool StorageManager::write(const SensorData& data) {
 }
 
 bool StorageManager::writeRecord(const DataRecord& record) {
+    extern RecoveryManager recoveryManager;
     bool success = false;
 
-    // Write to SD card (primary)
-    if (_sdAvailable) {
-        if (_sd->writeRecord(record)) {
-            success = true;
-            DEBUG_STORAGE_PRINTLN("Written to SD card");
-        } else {
-            Serial.println("[STORAGE] SD write failed, attempting remount...");
-            _sdAvailable = _sd->begin();
-            if (_sdAvailable) {
-                Serial.println("[STORAGE] SD remounted, retrying write...");
-                if (_sd->writeRecord(record)) {
-                    success = true;
-                    DEBUG_STORAGE_PRINTLN("Written to SD card after remount");
-                } else {
-                    Serial.println("[STORAGE] SD write failed after remount");
-                    extern SystemHealth systemHealth;
-                    systemHealth.recordError(ErrorType::SD);
-                }
-            } else {
-                Serial.println("[STORAGE] SD remount failed");
-                extern SystemHealth systemHealth;
-                systemHealth.recordError(ErrorType::SD);
-            }
-        }
+    // Write to SD card (primary). A missing card counts as a failed write so
+    // the recovery manager remounts it (card reinserted) on its own schedule.
+    if (_sdAvailable && _sd->writeRecord(record)) {
+        success = true;
+        DEBUG_STORAGE_PRINTLN("Written to SD card");
+        recoveryManager.reportSuccess(Subsystem::SD, millis());
     } else {
-        // Periodically try to remount SD (may have been reinserted)
-        static unsigned long lastSDRemountAttempt = 0;
-        if (millis() - lastSDRemountAttempt > 30000) {  // Every 30 seconds
-            lastSDRemountAttempt = millis();
-            _sdAvailable = _sd->begin();
-            if (_sdAvailable) {
-                Serial.println("[STORAGE] SD card detected and remounted!");
-                if (_sd->writeRecord(record)) {
-                    success = true;
-                }
-            }
+        if (_sdAvailable) {
+            Serial.println("[STORAGE] SD write failed");
+            extern SystemHealth systemHealth;
+            systemHealth.recordError(ErrorType::SD);
         }
+        recoveryManager.reportFailure(Subsystem::SD, millis());
     }
 
     // Write to SPIFFS (secondary/backup)
-    if (_spiffsAvailable) {
-        if (_spiffs->writeRecord(record)) {
-            success = true;
-            DEBUG_STORAGE_PRINTLN("Written to SPIFFS");
-        } else {
+    if (_spiffsAvailable && _spiffs->writeRecord(record)) {
+        success = true;
+        DEBUG_STORAGE_PRINTLN("Written to SPIFFS");
+        recoveryManager.reportSuccess(Subsystem::SPIFFS, millis());
+    } else {
+        if (_spiffsAvailable) {
             Serial.println("[STORAGE] Warning: SPIFFS write failed");
         }
+        recoveryManager.reportFailure(Subsystem::SPIFFS, millis());
     }
 
     if (!success) {
@@ -153,6 +133,23 @@ std::vector<DataRecord> StorageManager::readRecords(
     return std::vector<DataRecord>();
 }
 
+std::vector<DataRecord> StorageManager::queryRecords(
+    const RecordQuery& query,
+    uint16_t maxRecords,
+    uint32_t skipRecords,
+    uint32_t* scanned
+) {
+    if (scanned) {
+        *scanned = 0;
+    }
+    IStorage* primary = getPrimaryStorage();
+    if (primary) {
+        return primary->queryRecords(query, maxRecords, skipRecords, scanned);
+    }
+
+    return std::vector<DataRecord>();
+}
+
 StorageStats StorageManager::getStats() const {
     StorageStats stats;
 
@@ -240,6 +237,66 @@ bool StorageManager::setLastUploadedMillis(unsigned long millis) {
     return success;
 }
 
+bool StorageManager::advanceUploadCursor(uint32_t records, unsigned long lastMillis, bool persist) {
+    bool success = false;
+    if (_spiffsAvailable) {
+        success = _spiffs->advanceUploadCursor(records, lastMillis, persist);
+    }
+    if (_sdAvailable) {
+        _sd->advanceUploadCursor(records, lastMillis, persist);
+    }
+    return success;
+}
+
+void StorageManager::getUploadProgress(uint32_t& totalRecords, uint32_t& pending) const {
+    IStorage* primary = getPrimaryStorage();
+    if (primary) {
+        primary->getUploadProgress(totalRecords, pending);
+    } else {
+        totalRecords = 0;
+        pending = 0;
+    }
+}
+
+void StorageManager::getUploadPosition(const IStorage*& store, uint32_t& sequence) const {
+    store = getPrimaryStorage();
+    sequence = 0;
+    if (store) {
+        uint32_t total, pending;
+        store->getUploadProgress(total, pending);
+        sequence = store->getRemovedRecords() + (total - pending);
+    }
+}
+
+uint16_t StorageManager::backfillTimestamps(const TimeService& time, unsigned long now, uint16_t maxRecords) {
+    uint16_t repaired = 0;
+    if (_sdAvailable) {
+        repaired = _sd->backfillTimestamps(time, now, maxRecords);
+    }
+    if (_spiffsAvailable) {
+        uint16_t spiffsRepaired = _spiffs->backfillTimestamps(time, now, maxRecords);
+        if (spiffsRepaired > repaired) repaired = spiffsRepaired;
+    }
+    return repaired;
+}
+
+bool StorageManager::isBackfillPending() const {
+    return (_sdAvailable && _sd->isBackfillPending())
+        || (_spiffsAvailable && _spiffs->isBackfillPending());
+}
+
+uint16_t StorageManager::compactArchive(uint16_t maxRecords) {
+    // SPIFFS is a small circular buffer: nothing there worth archiving
+    return _sdAvailable ? _sd->compactArchive(maxRecords) : 0;
+}
+
+SDStorage::ArchiveStats StorageManager::getArchiveStats() const {
+    if (_sdAvailable) {
+        return _sd->getArchiveStats();
+    }
+    return SDStorage::ArchiveStats{0, 0, 0, false};
+}
+
 bool StorageManager::isSPIFFSMounted() const {
     return _spiffsAvailable && _spiffs->isMounted();
 }
@@ -331,6 +388,32 @@ String StorageManager::getStatusString() const {
     return status;
 }
 
+bool StorageManager::remountSD() {
+    _sdAvailable = _sd->begin();
+    return _sdAvailable;
+}
+
+bool StorageManager::reinitSD() {
+    _sd->end();
+    _sdAvailable = _sd->begin();
+    return _sdAvailable;
+}
+
+void StorageManager::disableSD() {
+    _sd->end();
+    _sdAvailable = false;
+}
+
+bool StorageManager::remountSPIFFS() {
+    _spiffs->end();
+    _spiffsAvailable = _spiffs->begin();
+    return _spiffsAvailable;
+}
+
+void StorageManager::disableSPIFFS() {
+    _spiffsAvailable = false;
+}
+
 // ============================================================================
 // Private Helper Methods
 // ============================================================================
@@ -58,6 +58,20 @@ public:
         uint32_t skipRecords = 0
     );
 
+    /**
+     * Read the records matching a query from primary storage
+     * @param query Field mask and predicate (see RecordQuery)
+     * @param maxRecords Maximum number of records to return
+     * @param skipRecords Records to skip from the start, matching or not
+     * @param scanned If set, receives the records examined past skipRecords
+     */
+    std::vector<DataRecord> queryRecords(
+        const RecordQuery& query,
+        uint16_t maxRecords = 100,
+        uint32_t skipRecords = 0,
+        uint32_t* scanned = nullptr
+    );
+
     /**
      * Get combined storage statistics
      * @return Combined StorageStats structure
@@ -91,6 +105,53 @@ public:
      */
     bool setLastUploadedMillis(unsigned long millis);
 
+    /**
+     * Move the upload cursor past the next `records` pending records
+     * (both storage systems)
+     * @param lastMillis millis() of the last of them
+     * @param persist Save metadata now rather than with the next save
+     * @return true if SPIFFS (primary upload tracker) succeeded
+     */
+    bool advanceUploadCursor(uint32_t records, unsigned long lastMillis, bool persist = true);
+
+    /**
+     * Records stored and records not yet uploaded on the primary storage,
+     * without getStats()' filesystem queries
+     */
+    void getUploadProgress(uint32_t& totalRecords, uint32_t& pending) const;
+
+    /**
+     * Which records the upload cursor points at: the primary storage (it
+     * changes when the SD card comes or goes) and the number of the first
+     * pending record, which records trimmed or cleared before it keep
+     * (see IStorage::getRemovedRecords())
+     */
+    void getUploadPosition(const IStorage*& store, uint32_t& sequence) const;
+
+    /**
+     * Back-fill timestamps of records stored before the clock was synced
+     * (both storage systems, one batch each)
+     * @param maxRecords Records per storage system in this call
+     * @return Records repaired (the larger of the two)
+     */
+    uint16_t backfillTimestamps(const TimeService& time, unsigned long now, uint16_t maxRecords);
+
+    /**
+     * Check if either storage system still has records to back-fill
+     * @return true while timestamps are pending
+     */
+    bool isBackfillPending() const;
+
+    /**
+     * Compact a batch of closed SD records into the compressed archive
+     * @param maxRecords Lines to process in this call
+     * @return Lines processed
+     */
+    uint16_t compactArchive(uint16_t maxRecords);
+
+    /** SD archive size (zeros without an SD card) */
+    SDStorage::ArchiveStats getArchiveStats() const;
+
     /**
      * Check if SPIFFS is mounted
      * @return true if mounted
@@ -145,6 +206,25 @@ public:
      */
     String getStatusString() const;
 
+    // ========================================================================
+    // Recovery actions (driven by RecoveryManager)
+    // ========================================================================
+
+    /** Mount the SD card again; true if mounted */
+    bool remountSD();
+
+    /** Unmount, release the SPI bus and mount again; true if mounted */
+    bool reinitSD();
+
+    /** Stop using the SD card; SPIFFS becomes primary */
+    void disableSD();
+
+    /** Unmount and mount SPIFFS again; true if mounted */
+    bool remountSPIFFS();
+
+    /** Stop using SPIFFS */
+    void disableSPIFFS();
+
 private:
     SPIFFSStorage* _spiffs;
     SDStorage* _sd;
@@ -0,0 +1,123 @@
+/**
+ * SeaSense Logger - Timestamp Back-fill Implementation
+ */
+
+#include "TimestampBackfill.h"
+#include "../system/TimeService.h"
+#include "../../config/hardware_config.h"
+#include <stdlib.h>
+
+TimestampBackfill::TimestampBackfill()
+    : _pending(false),
+      _cursor(0),
+      _openFailing(false),
+      _openFailingSince(0),
+      _repaired(0),
+      _abandoned(0)
+{
+}
+
+void TimestampBackfill::noteWrite(size_t lineStart, bool unsynced) {
+    if (unsynced && !_pending) {
+        _pending = true;
+        _cursor = lineStart;
+        _openFailing = false;
+    }
+}
+
+uint16_t TimestampBackfill::run(File& file, const TimeService& time, unsigned long now, uint16_t maxRecords) {
+    if (!_pending || !time.isSynced()) {
+        return 0;
+    }
+    _openFailing = false;
+    if (!file.seek(_cursor)) {
+        _pending = false;   // file shorter than the cursor: cleared or replaced
+        return 0;
+    }
+
+    uint16_t repaired = 0;
+    for (uint16_t i = 0; i < maxRecords; i++) {
+        if (!file.available()) {
+            _pending = false;
+            break;
+        }
+        size_t lineStart = _cursor;
+        String line = file.readStringUntil('\n');
+        _cursor += line.length() + 1;
+
+        String stamp;
+        int offset = stampFor(line, time, now, stamp);
+        if (offset < 0) {
+            // Lines are in write order: the first stamped one means the
+            // clock was synced from there on
+            _pending = false;
+            break;
+        }
+
+        file.seek(lineStart + offset);
+        file.write((const uint8_t*)stamp.c_str(), TimeService::UTC_LENGTH);
+        file.seek(_cursor);
+        repaired++;
+    }
+
+    _repaired += repaired;
+    if (!_pending) {
+        DEBUG_STORAGE_PRINT("Timestamp back-fill complete, ");
+        DEBUG_STORAGE_PRINT(_repaired);
+        DEBUG_STORAGE_PRINTLN(" records");
+    }
+    return repaired;
+}
+
+bool TimestampBackfill::openFailed(unsigned long now) {
+    if (!_pending) {
+        return false;
+    }
+    if (!_openFailing) {
+        _openFailing = true;
+        _openFailingSince = now;
+        return false;
+    }
+    if (now - _openFailingSince < TIME_BACKFILL_GIVE_UP_MS) {
+        return false;
+    }
+    _pending = false;
+    _openFailing = false;
+    _abandoned++;
+    Serial.println("[STORAGE] Timestamp back-fill abandoned: data file cannot be opened");
+    return true;
+}
+
+void TimestampBackfill::rebase(size_t oldStart, size_t newStart) {
+    if (!_pending) {
+        return;
+    }
+    _cursor = (_cursor >= oldStart) ? _cursor - oldStart + newStart : newStart;
+}
+
+void TimestampBackfill::reset() {
+    _pending = false;
+    _cursor = 0;
+    _openFailing = false;
+}
+
+int TimestampBackfill::stampFor(const String& line, const TimeService& time, unsigned long now, String& stamp) {
+    int comma = line.indexOf(',');
+    if (comma <= 0) {
+        return -1;
+    }
+    int offset = comma + 1;
+    if ((int)line.length() < offset + TimeService::UTC_LENGTH
+        || strncmp(line.c_str() + offset, TimeService::UNSYNCED_UTC, TimeService::UTC_LENGTH) != 0) {
+        return -1;
+    }
+
+    // strtoul, not toInt(): millis() past 2^31 would overflow a long
+    unsigned long stampMs = strtoul(line.c_str(), nullptr, 10);
+    int64_t epoch = time.epochMsForMillis(stampMs, now);
+    if (epoch <= 0) {
+        return -1;
+    }
+    stamp = TimeService::formatUTC(epoch);
+    return stamp.length() == TimeService::UTC_LENGTH ? offset : -1;
+}
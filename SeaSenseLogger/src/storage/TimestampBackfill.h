@@ -0,0 +1,79 @@
+/**
+ * SeaSense Logger - Timestamp Back-fill
+ *
+ * Records written before the clock is synced carry a fixed-width
+ * placeholder (TimeService::UNSYNCED_UTC) in timestamp_utc. This tracks
+ * where the first of them starts in a CSV file and, once the time service
+ * is synced, overwrites the placeholders in place with the UTC of each
+ * record's millis(), a batch of lines per call.
+ *
+ * Only records from this boot are repairable (millis() restarts at boot),
+ * so nothing is persisted: placeholders left by an earlier boot that never
+ * synced stay, and read back as an empty timestamp.
+ */
+
+#ifndef SEASENSE_TIMESTAMP_BACKFILL_H
+#define SEASENSE_TIMESTAMP_BACKFILL_H
+
+#include <Arduino.h>
+#include <FS.h>
+
+class TimeService;
+
+class TimestampBackfill {
+public:
+    TimestampBackfill();
+
+    /**
+     * A line was appended at byte offset lineStart
+     * @param unsynced true if it was written with the placeholder
+     */
+    void noteWrite(size_t lineStart, bool unsynced);
+
+    /** Placeholders from this boot still waiting for a timestamp */
+    bool isPending() const { return _pending; }
+
+    /**
+     * Repair up to maxRecords lines from the cursor
+     * @param file The CSV file, opened "r+"
+     * @return Lines repaired
+     */
+    uint16_t run(File& file, const TimeService& time, unsigned long now, uint16_t maxRecords);
+
+    /**
+     * The CSV file could not be opened for a run. Once opening has failed
+     * for TIME_BACKFILL_GIVE_UP_MS with no run in between, the repair is
+     * abandoned: the remaining lines keep the placeholder
+     * @return true if this failure abandoned it
+     */
+    bool openFailed(unsigned long now);
+
+    /**
+     * The file was rewritten without its oldest lines (SPIFFS trim): the
+     * byte at oldStart is now at newStart, anything before it is gone
+     */
+    void rebase(size_t oldStart, size_t newStart);
+
+    /** File cleared: nothing left to repair */
+    void reset();
+
+    uint32_t getRepairedCount() const { return _repaired; }
+    uint32_t getAbandonedCount() const { return _abandoned; }
+
+    /**
+     * Timestamp for one CSV line, if it holds the placeholder
+     * @param stamp Output UTC of the line's millis field
+     * @return Offset of the timestamp field in the line, -1 if nothing to do
+     */
+    static int stampFor(const String& line, const TimeService& time, unsigned long now, String& stamp);
+
+private:
+    bool _pending;
+    size_t _cursor;         // start of the next line to look at
+    bool _openFailing;
+    unsigned long _openFailingSince;
+    uint32_t _repaired;
+    uint32_t _abandoned;    // back-fills given up
+};
+
+#endif // SEASENSE_TIMESTAMP_BACKFILL_H
@@ -0,0 +1,444 @@
+/**
+ * SeaSense Logger - Event Log Implementation
+ */
+
+#include "EventLog.h"
+#include <SD.h>
+#include <strings.h>
+
+static_assert((LOG_RING_SIZE & (LOG_RING_SIZE - 1)) == 0, "LOG_RING_SIZE must be a power of two");
+
+static const uint32_t RING_MASK = LOG_RING_SIZE - 1;
+
+EventLog::EventLog()
+    : _head(0),
+      _drainSeq(0),
+      _lost(0),
+      _lostReported(0),
+      _level(LOG_DEFAULT_LEVEL),
+      _sdLevel(LOG_SD_DEFAULT_LEVEL),
+      _draining(false),
+      _warningHook(nullptr),
+      _sdLen(0),
+      _sdLastFlush(0),
+      _sdBootMarked(false)
+{
+#ifndef NATIVE_TEST
+    portMUX_INITIALIZE(&_mux);
+#endif
+}
+
+// ============================================================================
+// Producers
+// ============================================================================
+
+void EventLog::push(const LogEntry& e) {
+    lock();
+    LogEntry& slot = _ring[_head & RING_MASK];
+    slot = e;
+    slot.seq = _head;
+    _head++;
+    unlock();
+}
+
+void EventLog::addInt(LogEntry& e, int32_t v) {
+    if (e.argc >= LogEntry::MAX_ARGS) {
+        return;
+    }
+    e.types[e.argc] = LogArgType::I32;
+    e.args[e.argc++] = (uint32_t)v;
+}
+
+void EventLog::addUint(LogEntry& e, uint32_t v) {
+    if (e.argc >= LogEntry::MAX_ARGS) {
+        return;
+    }
+    e.types[e.argc] = LogArgType::U32;
+    e.args[e.argc++] = v;
+}
+
+void EventLog::addFloat(LogEntry& e, float v) {
+    if (e.argc >= LogEntry::MAX_ARGS) {
+        return;
+    }
+    e.types[e.argc] = LogArgType::F32;
+    memcpy(&e.args[e.argc++], &v, sizeof(float));
+}
+
+void EventLog::addDouble(LogEntry& e, double v) {
+    if (e.argc + 2 > LogEntry::MAX_ARGS) {
+        addFloat(e, (float)v);  // out of words: keep what fits
+        return;
+    }
+    e.types[e.argc] = LogArgType::F64;
+    e.types[e.argc + 1] = LogArgType::F64;
+    memcpy(&e.args[e.argc], &v, sizeof(double));
+    e.argc += 2;
+}
+
+void EventLog::addText(LogEntry& e, const char* s) {
+    if (e.argc >= LogEntry::MAX_ARGS) {
+        return;
+    }
+    if (!s) {
+        s = "(null)";
+    }
+    // The last byte is always a terminator, so a full buffer still gives ""
+    size_t room = LogEntry::TEXT_BYTES - 1 - e.textLen;
+    size_t len = strnlen(s, room);
+    memcpy(e.text + e.textLen, s, len);
+    e.text[e.textLen + len] = '\0';
+
+    e.types[e.argc] = LogArgType::STR;
+    e.args[e.argc++] = e.textLen;
+    e.textLen = (uint8_t)min((size_t)(LogEntry::TEXT_BYTES - 1), e.textLen + len + 1);
+}
+
+// ============================================================================
+// Sinks
+// ============================================================================
+
+uint16_t EventLog::drain(uint16_t maxEvents, bool sdAvailable, bool flushSdNow) {
+    if (!claimDrain()) {
+        return 0;
+    }
+
+    uint16_t written = 0;
+    char line[LOG_LINE_BYTES];
+    char sdLine[LOG_LINE_BYTES + 16];
+    LogEntry e;
+
+    while (written < maxEvents) {
+        lock();
+        if (_drainSeq == _head) {
+            unlock();
+            break;
+        }
+        if (_head - _drainSeq > LOG_RING_SIZE) {
+            _lost += (_head - LOG_RING_SIZE) - _drainSeq;
+            _drainSeq = _head - LOG_RING_SIZE;
+        }
+        e = _ring[_drainSeq & RING_MASK];
+        _drainSeq++;
+        uint32_t lost = _lost;
+        unlock();
+
+        if (lost != _lostReported) {
+            snprintf(line, sizeof(line), "[LOG] %lu events lost (ring full)",
+                     (unsigned long)(lost - _lostReported));
+            _lostReported = lost;
+            Serial.println(line);
+        }
+
+        int prefix = snprintf(line, sizeof(line), "[%s] ", e.tag ? e.tag : "?");
+        size_t len = min((size_t)max(prefix, 0), sizeof(line) - 1);
+        format(e, line + len, sizeof(line) - len);
+        Serial.println(line);
+
+        if (sdAvailable && (uint8_t)e.level <= _sdLevel) {
+            int n = snprintf(sdLine, sizeof(sdLine), "%lu %c %s\n",
+                             (unsigned long)e.ms, toupper(levelName(e.level)[0]), line);
+            appendSd(sdLine, min((size_t)max(n, 0), sizeof(sdLine) - 1));
+        }
+        written++;
+    }
+
+    if (sdAvailable && _sdLen > 0
+        && (flushSdNow || millis() - _sdLastFlush >= LOG_SD_FLUSH_INTERVAL_MS)) {
+        flushSd();
+    }
+
+    releaseDrain();
+    return written;
+}
+
+void EventLog::flush(bool sdAvailable) {
+    // The drain task may be mid-batch: retry until it lets go
+    for (int i = 0; i < 100; i++) {
+        drain(LOG_RING_SIZE, sdAvailable, true);
+        if (getPendingCount() == 0 && (!sdAvailable || _sdLen == 0)) {
+            return;
+        }
+        delay(10);
+    }
+}
+
+void EventLog::appendSd(const char* line, size_t len) {
+    if (!_sdBootMarked) {
+        // First SD line of this boot: millis() restarted
+        static const char marker[] = "--- boot ---\n";
+        memcpy(_sdBuffer + _sdLen, marker, sizeof(marker) - 1);
+        _sdLen += sizeof(marker) - 1;
+        _sdBootMarked = true;
+    }
+    if (_sdLen + len > sizeof(_sdBuffer)) {
+        flushSd();
+    }
+    len = min(len, sizeof(_sdBuffer) - _sdLen);
+    memcpy(_sdBuffer + _sdLen, line, len);
+    _sdLen += len;
+}
+
+void EventLog::flushSd() {
+    _sdLastFlush = millis();
+    if (_sdLen == 0) {
+        return;
+    }
+
+    File file = SD.open(LOG_SD_FILE, FILE_APPEND);
+    if (!file) {
+        _sdLen = 0;     // card gone; don't hold stale lines for the next one
+        return;
+    }
+    file.write((const uint8_t*)_sdBuffer, _sdLen);
+    size_t size = file.size();
+    file.close();
+    _sdLen = 0;
+
+    if (size >= LOG_SD_MAX_BYTES) {
+        SD.remove(LOG_SD_OLD_FILE);
+        SD.rename(LOG_SD_FILE, LOG_SD_OLD_FILE);
+    }
+}
+
+// ============================================================================
+// Queries
+// ============================================================================
+
+size_t EventLog::query(uint32_t since, LogLevel maxLevel, const char* tag,
+                       LogEntry* out, size_t maxEvents, uint32_t& next) const {
+    lock();
+    uint32_t head = _head;
+    unlock();
+
+    uint32_t oldest = head > LOG_RING_SIZE ? head - LOG_RING_SIZE : 0;
+    // since beyond head: a client that saw a previous boot
+    uint32_t seq = (since < oldest || since > head) ? oldest : since;
+
+    size_t n = 0;
+    while (seq < head && n < maxEvents) {
+        lock();
+        const LogEntry& slot = _ring[seq & RING_MASK];
+        bool valid = (slot.seq == seq);     // not overwritten meanwhile
+        if (valid) {
+            out[n] = slot;
+        }
+        unlock();
+        seq++;
+
+        if (!valid || (uint8_t)out[n].level > (uint8_t)maxLevel) {
+            continue;
+        }
+        if (tag && *tag && (!out[n].tag || strcasecmp(out[n].tag, tag) != 0)) {
+            continue;
+        }
+        n++;
+    }
+    next = seq;
+    return n;
+}
+
+uint32_t EventLog::getCapturedCount() const {
+    lock();
+    uint32_t head = _head;
+    unlock();
+    return head;
+}
+
+uint32_t EventLog::getLostCount() const {
+    lock();
+    uint32_t lost = _lost;
+    unlock();
+    return lost;
+}
+
+uint32_t EventLog::getPendingCount() const {
+    lock();
+    uint32_t pending = min(_head - _drainSeq, (uint32_t)LOG_RING_SIZE);
+    unlock();
+    return pending;
+}
+
+// ============================================================================
+// Formatting
+// ============================================================================
+
+// One conversion, spec holding "%" plus flags/width/precision. The stored
+// type wins over the conversion character where they disagree.
+static int formatArg(const LogEntry& e, uint8_t i, char* spec, size_t s, char conv,
+                     char* out, size_t room) {
+    uint32_t raw = e.args[i];
+    LogArgType type = e.types[i];
+
+    if (type == LogArgType::STR) {
+        if (conv != 's') {
+            s = 1;
+        }
+        spec[s++] = 's';
+        spec[s] = '\0';
+        return snprintf(out, room, spec, e.text + raw);
+    }
+
+    double asDouble;
+    if (type == LogArgType::F64) {
+        memcpy(&asDouble, &e.args[i], sizeof(double));
+    } else if (type == LogArgType::F32) {
+        float f;
+        memcpy(&f, &raw, sizeof(float));
+        asDouble = f;
+    } else {
+        asDouble = (type == LogArgType::I32) ? (double)(int32_t)raw : (double)raw;
+    }
+    bool isFloat = (type == LogArgType::F32 || type == LogArgType::F64);
+    long long asInt = isFloat ? (long long)asDouble
+                    : (type == LogArgType::I32) ? (long long)(int32_t)raw : (long long)raw;
+
+    switch (conv) {
+        case 'f': case 'F': case 'e': case 'E':
+        case 'g': case 'G': case 'a': case 'A':
+            spec[s++] = conv;
+            spec[s] = '\0';
+            return snprintf(out, room, spec, asDouble);
+        case 'c':
+            spec[s++] = 'c';
+            spec[s] = '\0';
+            return snprintf(out, room, spec, (int)asInt);
+        case 'd': case 'i':
+            spec[s++] = 'l';
+            spec[s++] = 'l';
+            spec[s++] = 'd';
+            spec[s] = '\0';
+            return snprintf(out, room, spec, asInt);
+        case 's':
+            // Number where a string was expected: its natural form
+            if (isFloat) {
+                spec[s++] = 'g';
+                spec[s] = '\0';
+                return snprintf(out, room, spec, asDouble);
+            }
+            spec[s++] = 'l';
+            spec[s++] = 'l';
+            spec[s++] = 'd';
+            spec[s] = '\0';
+            return snprintf(out, room, spec, asInt);
+        default:    // u, x, X, o, p
+            spec[s++] = 'l';
+            spec[s++] = 'l';
+            spec[s++] = (conv == 'x' || conv == 'X' || conv == 'o') ? conv : 'u';
+            spec[s] = '\0';
+            return snprintf(out, room, spec, (unsigned long long)asInt);
+    }
+}
+
+size_t EventLog::format(const LogEntry& e, char* out, size_t size) {
+    if (size == 0) {
+        return 0;
+    }
+
+    size_t n = 0;
+    uint8_t arg = 0;
+    const char* p = e.fmt ? e.fmt : "";
+
+    while (*p && n + 1 < size) {
+        if (*p != '%') {
+            out[n++] = *p++;
+            continue;
+        }
+        p++;
+        if (*p == '%') {
+            out[n++] = '%';
+            p++;
+            continue;
+        }
+
+        // Flags, width and precision are kept; length modifiers are dropped
+        char spec[16];
+        size_t s = 0;
+        spec[s++] = '%';
+        while (*p && strchr("-+ #0123456789.", *p)) {
+            if (s < sizeof(spec) - 4) {
+                spec[s++] = *p;
+            }
+            p++;
+        }
+        while (*p && strchr("hlLjzt", *p)) {
+            p++;
+        }
+        if (!*p) {
+            break;
+        }
+        char conv = *p++;
+
+        size_t room = size - n;
+        int w;
+        if (arg < e.argc) {
+            w = formatArg(e, arg, spec, s, conv, out + n, room);
+            arg += (e.types[arg] == LogArgType::F64) ? 2 : 1;
+        } else {
+            w = snprintf(out + n, room, "?");
+        }
+        if (w > 0) {
+            n += ((size_t)w < room) ? (size_t)w : room - 1;
+        }
+    }
+
+    out[n] = '\0';
+    return n;
+}
+
+const char* EventLog::levelName(LogLevel level) {
+    switch (level) {
+        case LogLevel::ERROR: return "error";
+        case LogLevel::WARN:  return "warn";
+        case LogLevel::INFO:  return "info";
+        default:              return "debug";
+    }
+}
+
+bool EventLog::parseLevel(const String& name, LogLevel& level) {
+    String s = name;
+    s.trim();
+    s.toLowerCase();
+    if (s == "error" || s == "0") {
+        level = LogLevel::ERROR;
+    } else if (s == "warn" || s == "warning" || s == "1") {
+        level = LogLevel::WARN;
+    } else if (s == "info" || s == "2") {
+        level = LogLevel::INFO;
+    } else if (s == "debug" || s == "3") {
+        level = LogLevel::DEBUG;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+// ============================================================================
+// Private
+// ============================================================================
+
+bool EventLog::claimDrain() {
+    lock();
+    bool claimed = !_draining;
+    _draining = true;
+    unlock();
+    return claimed;
+}
+
+void EventLog::releaseDrain() {
+    lock();
+    _draining = false;
+    unlock();
+}
+
+void EventLog::lock() const {
+#ifndef NATIVE_TEST
+    portENTER_CRITICAL(&_mux);
+#endif
+}
+
+void EventLog::unlock() const {
+#ifndef NATIVE_TEST
+    portEXIT_CRITICAL(&_mux);
+#endif
+}
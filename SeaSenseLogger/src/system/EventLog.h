@@ -0,0 +1,212 @@
+/**
+ * SeaSense Logger - Event Log
+ *
+ * Deferred, levelled logging for the measurement loop. A LOG_* call keeps
+ * the format string's address (its ID), a tag and the raw arguments in a
+ * fixed-size ring slot; formatting and output happen later, on the
+ * low-priority drain task:
+ * - Serial: every captured event, in order, as "[TAG] message"
+ * - SD: events at or above the SD level, appended to LOG_SD_FILE in batches
+ * - Web: /api/logs reads recent events straight from the ring (query())
+ *
+ * Producers never wait. A call below the runtime level costs one compare;
+ * a captured one copies its arguments and one slot under a spinlock. When
+ * the ring is full the oldest event is overwritten and counted as lost to
+ * the serial/SD sinks.
+ *
+ * Format strings must be literals (the pointer is kept, not the text).
+ * String arguments (const char*, String) are copied into the slot, up to
+ * TEXT_BYTES for all of them together. A double takes two of the MAX_ARGS
+ * argument words; 64-bit integers are truncated.
+ */
+
+#ifndef SEASENSE_EVENT_LOG_H
+#define SEASENSE_EVENT_LOG_H
+
+#include <Arduino.h>
+#include <type_traits>
+#include "../../config/hardware_config.h"
+
+enum class LogLevel : uint8_t {
+    ERROR = 0,
+    WARN = 1,
+    INFO = 2,
+    DEBUG = 3
+};
+
+enum class LogArgType : uint8_t {
+    I32 = 0,
+    U32 = 1,
+    F32 = 2,
+    F64 = 3,        // this word and the next
+    STR = 4
+};
+
+struct LogEntry {
+    static const uint8_t MAX_ARGS = 8;
+    static const uint8_t TEXT_BYTES = 48;
+
+    uint32_t seq;
+    uint32_t ms;
+    const char* fmt;
+    const char* tag;
+    LogLevel level;
+    uint8_t argc;
+    uint8_t textLen;
+    LogArgType types[MAX_ARGS];
+    uint32_t args[MAX_ARGS];        // I32/U32 value, F32/F64 bits, STR offset into text
+    char text[TEXT_BYTES];
+};
+
+class EventLog {
+public:
+    EventLog();
+
+    /**
+     * Capture an event if level is enabled
+     * @param fmt printf-style literal; length modifiers are ignored (the
+     *            stored argument type decides)
+     */
+    template <typename... Args>
+    void log(LogLevel level, const char* tag, const char* fmt, const Args&... args) {
+        static_assert(sizeof...(Args) <= LogEntry::MAX_ARGS, "Too many log arguments");
+        if ((uint8_t)level > _level) {
+            return;
+        }
+        LogEntry e;
+        e.ms = millis();
+        e.fmt = fmt;
+        e.tag = tag;
+        e.level = level;
+        e.argc = 0;
+        e.textLen = 0;
+        (encode(e, args), ...);
+        push(e);
+        if ((uint8_t)level <= (uint8_t)LogLevel::WARN && _warningHook) {
+            _warningHook(e);
+        }
+    }
+
+    bool isEnabled(LogLevel level) const { return (uint8_t)level <= _level; }
+
+    /** Events above this level are not captured at all */
+    void setLevel(LogLevel level) { _level = (uint8_t)level; }
+    LogLevel getLevel() const { return (LogLevel)_level; }
+
+    /** Captured events at or below this level also go to SD */
+    void setSdLevel(LogLevel level) { _sdLevel = (uint8_t)level; }
+    LogLevel getSdLevel() const { return (LogLevel)_sdLevel; }
+
+    /**
+     * Also hand every captured warning and error to hook, on the logging
+     * task (the flight recorder keeps the last few across a crash)
+     */
+    void setWarningHook(void (*hook)(const LogEntry& e)) { _warningHook = hook; }
+
+    /**
+     * Format and write up to maxEvents pending events to the sinks. Runs on
+     * the drain task; returns 0 without waiting if another drain is running.
+     * @param sdAvailable SD card mounted (SD sink skipped otherwise)
+     * @param flushSd Write buffered SD lines now rather than when due
+     * @return Events written
+     */
+    uint16_t drain(uint16_t maxEvents, bool sdAvailable, bool flushSd = false);
+
+    /**
+     * Write everything pending before a restart (from any task)
+     */
+    void flush(bool sdAvailable);
+
+    /**
+     * Copy events from the ring, oldest first
+     * @param since First sequence number wanted (0: oldest kept)
+     * @param maxLevel Least severe level to include
+     * @param tag Only this tag (nullptr or "": all)
+     * @param next Output: sequence number to pass as since next time
+     * @return Events copied to out
+     */
+    size_t query(uint32_t since, LogLevel maxLevel, const char* tag,
+                 LogEntry* out, size_t maxEvents, uint32_t& next) const;
+
+    /** Events captured since boot (also the next sequence number) */
+    uint32_t getCapturedCount() const;
+
+    /** Events overwritten before the serial/SD sinks got to them */
+    uint32_t getLostCount() const;
+
+    /** Captured but not yet drained */
+    uint32_t getPendingCount() const;
+
+    /**
+     * Render an event's message (without tag) into out
+     * @return Length written (truncated to size - 1)
+     */
+    static size_t format(const LogEntry& e, char* out, size_t size);
+
+    static const char* levelName(LogLevel level);
+    static bool parseLevel(const String& name, LogLevel& level);
+
+private:
+    LogEntry _ring[LOG_RING_SIZE];
+    uint32_t _head;                 // sequence number of the next event
+    uint32_t _drainSeq;             // next event for the serial/SD sinks
+    uint32_t _lost;
+    uint32_t _lostReported;
+    volatile uint8_t _level;
+    volatile uint8_t _sdLevel;
+    bool _draining;
+    void (*_warningHook)(const LogEntry& e);
+
+    char _sdBuffer[LOG_SD_BUFFER_BYTES];
+    size_t _sdLen;
+    unsigned long _sdLastFlush;
+    bool _sdBootMarked;
+
+#ifndef NATIVE_TEST
+    mutable portMUX_TYPE _mux;
+#endif
+
+    void push(const LogEntry& e);
+    bool claimDrain();
+    void releaseDrain();
+    void appendSd(const char* line, size_t len);
+    void flushSd();
+    void lock() const;
+    void unlock() const;
+
+    static void addInt(LogEntry& e, int32_t v);
+    static void addUint(LogEntry& e, uint32_t v);
+    static void addFloat(LogEntry& e, float v);
+    static void addDouble(LogEntry& e, double v);
+    static void addText(LogEntry& e, const char* s);
+
+    static const char* cstr(const char* s) { return s; }
+    static const char* cstr(const String& s) { return s.c_str(); }
+
+    template <typename T>
+    static void encode(LogEntry& e, const T& v) {
+        if constexpr (std::is_same<T, float>::value) {
+            addFloat(e, v);
+        } else if constexpr (std::is_floating_point<T>::value) {
+            addDouble(e, (double)v);
+        } else if constexpr (std::is_enum<T>::value) {
+            addInt(e, (int32_t)v);
+        } else if constexpr (std::is_integral<T>::value && std::is_signed<T>::value) {
+            addInt(e, (int32_t)v);
+        } else if constexpr (std::is_integral<T>::value) {
+            addUint(e, (uint32_t)v);
+        } else {
+            addText(e, cstr(v));
+        }
+    }
+};
+
+extern EventLog eventLog;
+
+// LOG_INFO("GPS", "%d sats, HDOP %.1f", sats, hdop)
+#define LOG_ERROR(tag, ...) eventLog.log(LogLevel::ERROR, tag, __VA_ARGS__)
+#define LOG_WARN(tag, ...)  eventLog.log(LogLevel::WARN, tag, __VA_ARGS__)
+#define LOG_INFO(tag, ...)  eventLog.log(LogLevel::INFO, tag, __VA_ARGS__)
+#define LOG_DEBUG(tag, ...) eventLog.log(LogLevel::DEBUG, tag, __VA_ARGS__)
+
+#endif // SEASENSE_EVENT_LOG_H
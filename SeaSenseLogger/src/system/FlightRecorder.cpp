@@ -0,0 +1,252 @@
+/**
+ * SeaSense Logger - Flight Recorder Implementation
+ */
+
+#include "FlightRecorder.h"
+#include "EventLog.h"
+#ifndef NATIVE_TEST
+#include <esp_core_dump.h>
+#endif
+
+static_assert(FLIGHT_STAGE_NAMES < FlightRecorder::OTHER_STAGE, "Stage index must fit in a byte");
+static_assert(FLIGHT_STAGE_HISTORY <= 255 && FLIGHT_EVENT_HISTORY <= 255, "Ring index must fit in a byte");
+
+FlightRecorder::FlightRecorder(FlightRecord& rtc)
+    : _rtc(rtc),
+      _hasPostMortem(false),
+      _hasRecord(false)
+{
+    memset(&_postMortem, 0, sizeof(_postMortem));
+    memset(&_coredump, 0, sizeof(_coredump));
+    memset(_namePtrs, 0, sizeof(_namePtrs));
+#ifndef NATIVE_TEST
+    portMUX_INITIALIZE(&_mux);
+#endif
+}
+
+void FlightRecorder::begin(uint32_t bootCount, const char* firmware) {
+    if (isValid(_rtc)) {
+        _postMortem = _rtc;
+        terminate(_postMortem);
+        _postMortem.resetReason = (uint8_t)esp_reset_reason();
+        _hasRecord = true;
+        // ESP.restart() is only called on purpose; nothing to report
+        _hasPostMortem = _postMortem.resetReason != ESP_RST_SW;
+        Serial.printf("[FLIGHT] Previous boot ended in stage %s after %lu ms (reset reason %u%s)\n",
+                      stageName(_postMortem, _postMortem.stage), (unsigned long)_postMortem.lastMs,
+                      _postMortem.resetReason, _hasPostMortem ? "" : ", deliberate restart");
+    }
+    loadCoredump();
+    if (_coredump.present) {
+        Serial.printf("[FLIGHT] Coredump present: task %s, PC 0x%08lx\n",
+                      _coredump.task, (unsigned long)_coredump.pc);
+        _hasPostMortem = true;
+    }
+    reset(bootCount, firmware);
+}
+
+void FlightRecorder::stage(const char* name, unsigned long now) {
+    uint8_t index = intern(name);
+    _rtc.lastMs = now;
+    if (index == _rtc.stage) {
+        return;
+    }
+
+    if (_rtc.stage != NO_STAGE) {
+        uint32_t elapsed = (uint32_t)(now - _rtc.stageStartMs);
+        uint16_t duration = elapsed > 0xFFFF ? 0xFFFF : (uint16_t)elapsed;
+
+        FlightStage& s = _rtc.stages[_rtc.stageHead];
+        s.startMs = _rtc.stageStartMs;
+        s.durationMs = duration;
+        s.name = _rtc.stage;
+        s.reserved = 0;
+        _rtc.stageHead = (_rtc.stageHead + 1) % FLIGHT_STAGE_HISTORY;
+        if (_rtc.stageCount < FLIGHT_STAGE_HISTORY) {
+            _rtc.stageCount++;
+        }
+        if (_rtc.stage < FLIGHT_STAGE_NAMES && duration > _rtc.stageMaxMs[_rtc.stage]) {
+            _rtc.stageMaxMs[_rtc.stage] = duration;
+        }
+    }
+    _rtc.stage = index;
+    _rtc.stageStartMs = now;
+}
+
+void FlightRecorder::loopStart(unsigned long now, unsigned long gapMs) {
+    _rtc.lastMs = now;
+    _rtc.loopCount++;
+    _rtc.lastGapMs = gapMs;
+    if (gapMs > _rtc.maxGapMs) {
+        _rtc.maxGapMs = gapMs;
+    }
+}
+
+void FlightRecorder::sample(unsigned long now, uint32_t freeHeap, uint32_t minFreeHeap,
+                            uint32_t largestBlock, uint32_t epoch) {
+    _rtc.lastMs = now;
+    _rtc.freeHeap = freeHeap;
+    _rtc.minFreeHeap = minFreeHeap;
+    _rtc.largestBlock = largestBlock;
+    _rtc.epoch = epoch;
+}
+
+void FlightRecorder::recordLog(const LogEntry& e) {
+    // Format before taking the lock; warnings are rare, this is off the
+    // per-event fast path
+    FlightEvent ev;
+    ev.ms = e.ms;
+    ev.level = (uint8_t)e.level;
+    strncpy(ev.tag, e.tag ? e.tag : "", sizeof(ev.tag) - 1);
+    ev.tag[sizeof(ev.tag) - 1] = '\0';
+    EventLog::format(e, ev.msg, sizeof(ev.msg));
+
+#ifndef NATIVE_TEST
+    portENTER_CRITICAL(&_mux);
+#endif
+    _rtc.events[_rtc.eventHead] = ev;
+    _rtc.eventHead = (_rtc.eventHead + 1) % FLIGHT_EVENT_HISTORY;
+    if (_rtc.eventCount < FLIGHT_EVENT_HISTORY) {
+        _rtc.eventCount++;
+    }
+#ifndef NATIVE_TEST
+    portEXIT_CRITICAL(&_mux);
+#endif
+}
+
+void FlightRecorder::clearPostMortem() {
+    if (!_hasPostMortem) {
+        return;
+    }
+    _hasPostMortem = false;
+    _hasRecord = false;
+#ifndef NATIVE_TEST
+    if (_coredump.present) {
+        esp_core_dump_image_erase();
+    }
+#endif
+    _coredump.present = false;
+    Serial.println("[FLIGHT] Post-mortem uploaded");
+}
+
+// ============================================================================
+// Record access
+// ============================================================================
+
+const FlightStage& FlightRecorder::stageAt(const FlightRecord& r, uint8_t i) {
+    uint8_t first = (r.stageHead + FLIGHT_STAGE_HISTORY - r.stageCount) % FLIGHT_STAGE_HISTORY;
+    return r.stages[(first + i) % FLIGHT_STAGE_HISTORY];
+}
+
+const FlightEvent& FlightRecorder::eventAt(const FlightRecord& r, uint8_t i) {
+    uint8_t first = (r.eventHead + FLIGHT_EVENT_HISTORY - r.eventCount) % FLIGHT_EVENT_HISTORY;
+    return r.events[(first + i) % FLIGHT_EVENT_HISTORY];
+}
+
+const char* FlightRecorder::stageName(const FlightRecord& r, uint8_t index) {
+    if (index == NO_STAGE) {
+        return "none";
+    }
+    if (index >= r.nameCount) {
+        return "other";
+    }
+    return r.names[index];
+}
+
+bool FlightRecorder::isValid(const FlightRecord& r) {
+    if (r.magic != MAGIC || r.version != VERSION || r.size != sizeof(FlightRecord)) {
+        return false;
+    }
+    if (r.nameCount > FLIGHT_STAGE_NAMES
+        || r.stageHead >= FLIGHT_STAGE_HISTORY || r.stageCount > FLIGHT_STAGE_HISTORY
+        || r.eventHead >= FLIGHT_EVENT_HISTORY || r.eventCount > FLIGHT_EVENT_HISTORY) {
+        return false;
+    }
+    auto stageOk = [&r](uint8_t index) {
+        return index < r.nameCount || index == OTHER_STAGE || index == NO_STAGE;
+    };
+    if (!stageOk(r.stage)) {
+        return false;
+    }
+    for (uint8_t i = 0; i < r.stageCount; i++) {
+        if (!stageOk(stageAt(r, i).name)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// ============================================================================
+// Private
+// ============================================================================
+
+void FlightRecorder::reset(uint32_t bootCount, const char* firmware) {
+    memset(&_rtc, 0, sizeof(_rtc));
+    _rtc.magic = MAGIC;
+    _rtc.version = VERSION;
+    _rtc.size = sizeof(FlightRecord);
+    _rtc.bootCount = bootCount;
+    strncpy(_rtc.firmware, firmware ? firmware : "", sizeof(_rtc.firmware) - 1);
+    _rtc.stage = NO_STAGE;
+    memset(_namePtrs, 0, sizeof(_namePtrs));
+}
+
+uint8_t FlightRecorder::intern(const char* name) {
+    for (uint8_t i = 0; i < _rtc.nameCount; i++) {
+        if (_namePtrs[i] == name) {
+            return i;
+        }
+    }
+    if (_rtc.nameCount >= FLIGHT_STAGE_NAMES) {
+        return OTHER_STAGE;
+    }
+    // The record keeps a copy: after a crash (or an OTA) the pointer means nothing
+    uint8_t i = _rtc.nameCount;
+    strncpy(_rtc.names[i], name ? name : "", sizeof(_rtc.names[i]) - 1);
+    _rtc.names[i][sizeof(_rtc.names[i]) - 1] = '\0';
+    _namePtrs[i] = name;
+    _rtc.nameCount++;
+    return i;
+}
+
+void FlightRecorder::terminate(FlightRecord& r) {
+    // Noise that passed validation must still not run off the end of a string
+    r.firmware[sizeof(r.firmware) - 1] = '\0';
+    for (uint8_t i = 0; i < FLIGHT_STAGE_NAMES; i++) {
+        r.names[i][sizeof(r.names[i]) - 1] = '\0';
+    }
+    for (uint8_t i = 0; i < FLIGHT_EVENT_HISTORY; i++) {
+        r.events[i].tag[sizeof(r.events[i].tag) - 1] = '\0';
+        r.events[i].msg[sizeof(r.events[i].msg) - 1] = '\0';
+    }
+}
+
+void FlightRecorder::loadCoredump() {
+    memset(&_coredump, 0, sizeof(_coredump));
+#if !defined(NATIVE_TEST) && CONFIG_ESP_COREDUMP_ENABLE_TO_FLASH
+    size_t addr = 0;
+    size_t size = 0;
+    if (esp_core_dump_image_get(&addr, &size) != ESP_OK || size == 0) {
+        return;
+    }
+    _coredump.present = true;
+    _coredump.size = size;
+
+#if CONFIG_ESP_COREDUMP_DATA_FORMAT_ELF
+    esp_core_dump_summary_t* summary = (esp_core_dump_summary_t*)malloc(sizeof(esp_core_dump_summary_t));
+    if (summary && esp_core_dump_get_summary(summary) == ESP_OK) {
+        strncpy(_coredump.task, summary->exc_task, sizeof(_coredump.task) - 1);
+        _coredump.pc = summary->exc_pc;
+        snprintf(_coredump.elfSha, sizeof(_coredump.elfSha), "%.16s", (const char*)summary->app_elf_sha256);
+#if CONFIG_IDF_TARGET_ARCH_XTENSA
+        _coredump.depth = min((uint32_t)8, (uint32_t)summary->exc_bt_info.depth);
+        for (uint8_t i = 0; i < _coredump.depth; i++) {
+            _coredump.backtrace[i] = summary->exc_bt_info.bt[i];
+        }
+        _coredump.corrupted = summary->exc_bt_info.corrupted;
+#endif
+    }
+    free(summary);
+#endif
+#endif
+}
@@ -0,0 +1,164 @@
+/**
+ * SeaSense Logger - Flight Recorder
+ *
+ * What loop() was doing when the device last went down, kept in RTC slow
+ * memory (RTC_NOINIT_ATTR), which survives watchdog, panic, brownout and
+ * software resets but not a power cycle:
+ * - The last FLIGHT_STAGE_HISTORY loop stage transitions, each with its
+ *   start and duration, the current stage and when it was entered
+ * - The slowest pass through each stage this boot
+ * - The last FLIGHT_EVENT_HISTORY warnings/errors from the event log
+ * - Heap and loop latency at the last sample
+ *
+ * On the next boot begin() validates the record, stamps it with the reset
+ * reason and keeps a copy as the post-mortem, together with a summary of
+ * the coredump partition, until an upload carrying it succeeds
+ * (clearPostMortem()). A software reset (ESP.restart(): OTA, recovery,
+ * web restart) was deliberate and is not reported as a post-mortem; the
+ * record stays readable for /api/status.
+ *
+ * Stages and samples are written from loop(); log events from either
+ * core, under a spinlock.
+ */
+
+#ifndef SEASENSE_FLIGHT_RECORDER_H
+#define SEASENSE_FLIGHT_RECORDER_H
+
+#include <Arduino.h>
+#include <esp_system.h>
+#include "../../config/hardware_config.h"
+
+struct LogEntry;
+
+struct FlightStage {
+    uint32_t startMs;
+    uint16_t durationMs;        // saturates at 65535
+    uint8_t name;               // index into FlightRecord::names
+    uint8_t reserved;
+};
+
+struct FlightEvent {
+    uint32_t ms;
+    uint8_t level;              // LogLevel
+    char tag[11];
+    char msg[48];
+};
+
+struct FlightRecord {
+    uint32_t magic;
+    uint16_t version;
+    uint16_t size;
+    uint32_t bootCount;
+    char firmware[24];
+
+    // Last sample
+    uint32_t lastMs;
+    uint32_t epoch;             // UTC seconds, 0 if not synced
+    uint32_t freeHeap;
+    uint32_t minFreeHeap;
+    uint32_t largestBlock;
+    uint32_t loopCount;
+    uint32_t lastGapMs;
+    uint32_t maxGapMs;
+
+    // Current stage
+    uint8_t stage;
+    uint8_t nameCount;
+    uint8_t stageHead;          // next slot to write
+    uint8_t stageCount;
+    uint8_t eventHead;
+    uint8_t eventCount;
+    uint8_t resetReason;        // esp_reset_reason_t that ended the boot (set by the next begin())
+    uint8_t reserved;
+    uint32_t stageStartMs;
+
+    char names[FLIGHT_STAGE_NAMES][16];
+    uint16_t stageMaxMs[FLIGHT_STAGE_NAMES];
+    FlightStage stages[FLIGHT_STAGE_HISTORY];
+    FlightEvent events[FLIGHT_EVENT_HISTORY];
+};
+
+struct CoredumpSummary {
+    bool present;
+    bool corrupted;             // backtrace couldn't be fully unwound
+    uint32_t size;
+    char task[16];
+    uint32_t pc;
+    uint8_t depth;
+    uint32_t backtrace[8];
+    char elfSha[17];            // first 16 hex digits of the crashed image
+};
+
+class FlightRecorder {
+public:
+    static const uint32_t MAGIC = 0x464C5452;   // "FLTR"
+    static const uint16_t VERSION = 1;
+    static const uint8_t NO_STAGE = 0xFF;
+    static const uint8_t OTHER_STAGE = 0xFE;    // name table full
+
+    /**
+     * @param rtc The record in RTC memory (its contents are whatever the
+     *            last boot left there, or noise after power-on)
+     */
+    explicit FlightRecorder(FlightRecord& rtc);
+
+    /**
+     * Keep a valid record from the last boot as the post-mortem, then start
+     * a fresh one. Call early in setup(), before the first stage().
+     */
+    void begin(uint32_t bootCount, const char* firmware);
+
+    /** Entering a loop stage (name must be a literal: interned by address) */
+    void stage(const char* name, unsigned long now);
+
+    /** Top of each loop() pass */
+    void loopStart(unsigned long now, unsigned long gapMs);
+
+    /** Heap and clock, every FLIGHT_SAMPLE_INTERVAL_MS */
+    void sample(unsigned long now, uint32_t freeHeap, uint32_t minFreeHeap,
+                uint32_t largestBlock, uint32_t epoch);
+
+    /** A captured warning or error (EventLog warning hook) */
+    void recordLog(const LogEntry& e);
+
+    // ========================================================================
+    // Post-mortem (the previous boot)
+    // ========================================================================
+
+    /** A record or a coredump from an earlier boot is waiting for upload */
+    bool hasPostMortem() const { return _hasPostMortem; }
+    /** The RTC record survived (not after a power cycle), crash or not */
+    bool hasPostMortemRecord() const { return _hasRecord; }
+    const FlightRecord& getPostMortem() const { return _postMortem; }
+    const CoredumpSummary& getCoredump() const { return _coredump; }
+
+    /** The post-mortem reached the backend: drop it and erase the coredump */
+    void clearPostMortem();
+
+    /** i-th stage transition of a record, oldest first */
+    static const FlightStage& stageAt(const FlightRecord& r, uint8_t i);
+    static const FlightEvent& eventAt(const FlightRecord& r, uint8_t i);
+    static const char* stageName(const FlightRecord& r, uint8_t index);
+
+    /** Magic, layout and every index in range */
+    static bool isValid(const FlightRecord& r);
+
+private:
+    FlightRecord& _rtc;
+    FlightRecord _postMortem;
+    CoredumpSummary _coredump;
+    bool _hasPostMortem;
+    bool _hasRecord;
+    const char* _namePtrs[FLIGHT_STAGE_NAMES];
+
+#ifndef NATIVE_TEST
+    portMUX_TYPE _mux;
+#endif
+
+    void reset(uint32_t bootCount, const char* firmware);
+    uint8_t intern(const char* name);
+    void loadCoredump();
+    static void terminate(FlightRecord& r);
+};
+
+#endif // SEASENSE_FLIGHT_RECORDER_H
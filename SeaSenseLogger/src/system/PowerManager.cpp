@@ -0,0 +1,244 @@
+/**
+ * SeaSense Logger - Power Manager Implementation
+ */
+
+#include "PowerManager.h"
+#include "../../config/hardware_config.h"
+
+#ifndef NATIVE_TEST
+#include <esp_pm.h>
+#include <esp_sleep.h>
+#include <driver/gpio.h>
+#include <driver/uart.h>
+#endif
+
+// No deadline registered: sleep as long as we are allowed to
+static const unsigned long NO_DEADLINE = 0xFFFFFFFFUL;
+
+PowerManager::PowerManager()
+    : _cycleStart(0),
+      _deadlineMs(NO_DEADLINE),
+      _deadlineSource("none"),
+      _veto(nullptr),
+      _apClients(0),
+      _stationLinked(false),
+      _dfsActive(false),
+      _lastMark(0),
+      _sleepCount(0),
+      _earlyWakes(0),
+      _sleepBlocked(false),
+      _sleepBlockedAt(0)
+{
+    for (int i = 0; i < (int)PowerState::COUNT; i++) _residencyMs[i] = 0;
+    for (int i = 0; i < (int)WakeCause::COUNT; i++) _wakeCounts[i] = 0;
+}
+
+bool PowerManager::begin() {
+    _lastMark = millis();
+
+#ifndef NATIVE_TEST
+    // Frequency scaling only: automatic light sleep never engages while the
+    // AP is up, so sleep is entered explicitly from idle() instead
+    esp_pm_config_t pm = {};
+    pm.max_freq_mhz = POWER_CPU_MAX_MHZ;
+    pm.min_freq_mhz = POWER_CPU_MIN_MHZ;
+    pm.light_sleep_enable = false;
+    esp_err_t err = esp_pm_configure(&pm);
+    _dfsActive = (err == ESP_OK);
+    if (!_dfsActive) {
+        Serial.print("[POWER] Frequency scaling unavailable: ");
+        Serial.println(esp_err_to_name(err));
+    }
+
+#if POWER_LIGHT_SLEEP_ENABLED
+    // Serial console: a few edges on RX wake us for serial commands
+    uart_set_wakeup_threshold(UART_NUM_0, 3);
+    esp_sleep_enable_uart_wakeup(UART_NUM_0);
+
+    // CAN RX idles recessive (high); a dominant bit means N2K traffic
+    gpio_wakeup_enable((gpio_num_t)CAN_RX_PIN, GPIO_INTR_LOW_LEVEL);
+    esp_sleep_enable_gpio_wakeup();
+
+#if SOC_PM_SUPPORT_WIFI_WAKEUP
+    esp_sleep_enable_wifi_wakeup();
+#endif
+#endif
+#endif
+
+    Serial.print("[POWER] Frequency scaling ");
+    Serial.print(_dfsActive ? "on" : "off");
+    Serial.print(", light sleep ");
+    Serial.println(POWER_LIGHT_SLEEP_ENABLED ? "enabled" : "disabled");
+    return _dfsActive;
+}
+
+void PowerManager::beginCycle(unsigned long now) {
+    _cycleStart = now;
+    _deadlineMs = NO_DEADLINE;
+    _deadlineSource = "none";
+    _veto = nullptr;
+}
+
+void PowerManager::wakeWithin(unsigned long ms, const char* source) {
+    if (ms < _deadlineMs) {
+        _deadlineMs = ms;
+        _deadlineSource = source;
+    }
+}
+
+void PowerManager::wakeForMeasurement(unsigned long ms, const char* source) {
+    wakeWithin(ms > POWER_MEASURE_PREWAKE_MS ? ms - POWER_MEASURE_PREWAKE_MS : 0, source);
+}
+
+void PowerManager::stayAwake(const char* reason) {
+    if (!_veto) {
+        _veto = reason;
+    }
+}
+
+void PowerManager::setRadioState(uint8_t apClients, bool stationLinked) {
+    _apClients = apClients;
+    _stationLinked = stationLinked;
+}
+
+PowerManager::Decision PowerManager::decide(unsigned long now) const {
+    if (_veto) {
+        return {PowerState::ACTIVE, 0};
+    }
+
+    unsigned long elapsed = now - _cycleStart;
+    unsigned long remaining = (_deadlineMs > elapsed) ? _deadlineMs - elapsed : 0;
+    if (remaining == 0) {
+        return {PowerState::ACTIVE, 0};
+    }
+
+#if POWER_LIGHT_SLEEP_ENABLED
+    bool radioInUse = (_apClients > 0) || _stationLinked;
+    bool backedOff = _sleepBlocked && (now - _sleepBlockedAt < POWER_EARLY_WAKE_BACKOFF_MS);
+    if (!radioInUse && !backedOff && remaining >= POWER_MIN_LIGHT_SLEEP_MS) {
+        return {PowerState::LIGHT_SLEEP,
+                remaining < POWER_MAX_LIGHT_SLEEP_MS ? remaining : POWER_MAX_LIGHT_SLEEP_MS};
+    }
+#endif
+
+    return {PowerState::IDLE, remaining < POWER_IDLE_SLICE_MS ? remaining : POWER_IDLE_SLICE_MS};
+}
+
+void PowerManager::idle() {
+    unsigned long now = millis();
+    account(PowerState::ACTIVE, now - _lastMark);
+
+    Decision d = decide(now);
+    switch (d.state) {
+        case PowerState::LIGHT_SLEEP: {
+            WakeCause cause = sleepFor(d.durationMs);
+            unsigned long after = millis();
+            account(PowerState::LIGHT_SLEEP, after - now);
+            noteWake(cause, d.durationMs, after - now, after);
+            _lastMark = after;
+            return;
+        }
+        case PowerState::IDLE:
+            delay(d.durationMs);
+            break;
+        default:
+            delay(1);  // yield a tick even when busy
+            break;
+    }
+
+    unsigned long after = millis();
+    account(PowerState::IDLE, after - now);
+    _lastMark = after;
+}
+
+uint32_t PowerManager::getWebPollMs() const {
+    return (_apClients > 0) ? POWER_WEB_POLL_ACTIVE_MS : POWER_WEB_POLL_IDLE_MS;
+}
+
+float PowerManager::getChargeMAh(PowerState state) const {
+    float mA = POWER_CURRENT_ACTIVE_MA;
+    if (state == PowerState::IDLE) mA = POWER_CURRENT_IDLE_MA;
+    else if (state == PowerState::LIGHT_SLEEP) mA = POWER_CURRENT_SLEEP_MA;
+    return (float)_residencyMs[(int)state] / 3600000.0f * mA;
+}
+
+float PowerManager::getAverageCurrentMA() const {
+    uint64_t totalMs = 0;
+    float totalMAh = 0.0f;
+    for (int i = 0; i < (int)PowerState::COUNT; i++) {
+        totalMs += _residencyMs[i];
+        totalMAh += getChargeMAh((PowerState)i);
+    }
+    if (totalMs == 0) {
+        return 0.0f;
+    }
+    return totalMAh / ((float)totalMs / 3600000.0f);
+}
+
+const char* PowerManager::stateName(PowerState state) {
+    switch (state) {
+        case PowerState::ACTIVE:      return "active";
+        case PowerState::IDLE:        return "idle";
+        case PowerState::LIGHT_SLEEP: return "light_sleep";
+        default:                      return "unknown";
+    }
+}
+
+const char* PowerManager::wakeCauseName(WakeCause cause) {
+    switch (cause) {
+        case WakeCause::TIMER: return "timer";
+        case WakeCause::UART:  return "uart";
+        case WakeCause::CAN:   return "can";
+        case WakeCause::WIFI:  return "wifi";
+        default:               return "other";
+    }
+}
+
+// ============================================================================
+// Private
+// ============================================================================
+
+void PowerManager::account(PowerState state, unsigned long ms) {
+    _residencyMs[(int)state] += ms;
+}
+
+void PowerManager::noteWake(WakeCause cause, unsigned long requestedMs, unsigned long sleptMs, unsigned long now) {
+    _sleepCount++;
+    _wakeCounts[(int)cause]++;
+
+    // Repeatedly woken long before the deadline (busy CAN bus, chatty
+    // console): sleeping costs more than it saves, so back off for a while
+    bool early = (cause != WakeCause::TIMER) && (sleptMs < requestedMs / 2);
+    _earlyWakes = early ? _earlyWakes + 1 : 0;
+    if (_earlyWakes >= POWER_EARLY_WAKE_LIMIT) {
+        _earlyWakes = 0;
+        _sleepBlocked = true;
+        _sleepBlockedAt = now;
+        Serial.print("[POWER] Light sleep paused — repeated ");
+        Serial.print(wakeCauseName(cause));
+        Serial.println(" wakes");
+    }
+}
+
+WakeCause PowerManager::sleepFor(unsigned long ms) {
+#ifndef NATIVE_TEST
+    esp_sleep_enable_timer_wakeup((uint64_t)ms * 1000ULL);
+
+    // Keep the pump relay where it is while digital peripherals are gated
+    gpio_hold_en((gpio_num_t)PUMP_RELAY_PIN);
+    Serial.flush();
+    esp_light_sleep_start();
+    gpio_hold_dis((gpio_num_t)PUMP_RELAY_PIN);
+
+    switch (esp_sleep_get_wakeup_cause()) {
+        case ESP_SLEEP_WAKEUP_TIMER: return WakeCause::TIMER;
+        case ESP_SLEEP_WAKEUP_UART:  return WakeCause::UART;
+        case ESP_SLEEP_WAKEUP_GPIO:  return WakeCause::CAN;
+        case ESP_SLEEP_WAKEUP_WIFI:  return WakeCause::WIFI;
+        default:                     return WakeCause::OTHER;
+    }
+#else
+    (void)ms;
+    return WakeCause::TIMER;
+#endif
+}
@@ -0,0 +1,134 @@
+/**
+ * SeaSense Logger - Power Manager
+ *
+ * Lets the device sleep between pump cycles instead of spinning loop():
+ * - Each loop() pass collects the next deadline from pump, sampling, upload
+ *   and GPS/N2K pre-wake needs, plus vetoes (measuring, calibrating, OTA)
+ * - idle() then either enters light sleep until that deadline (timer, UART0,
+ *   CAN RX and WiFi wake sources) or yields in short slices so dynamic
+ *   frequency scaling can drop the clock while nothing runs
+ * - Residency and estimated charge per power state for /api/status
+ *
+ * Explicit light sleep pauses the radio, so it is only used while no one
+ * is on the AP and the station link is down; otherwise the device stays in
+ * the frequency-scaled idle state.
+ */
+
+#ifndef SEASENSE_POWER_MANAGER_H
+#define SEASENSE_POWER_MANAGER_H
+
+#include <Arduino.h>
+
+enum class PowerState : uint8_t {
+    ACTIVE = 0,     // loop() doing work
+    IDLE = 1,       // yielding, clock scaled down
+    LIGHT_SLEEP = 2,
+    COUNT = 3
+};
+
+enum class WakeCause : uint8_t {
+    TIMER = 0,
+    UART = 1,
+    CAN = 2,
+    WIFI = 3,
+    OTHER = 4,
+    COUNT = 5
+};
+
+class PowerManager {
+public:
+    struct Decision {
+        PowerState state;       // IDLE or LIGHT_SLEEP (ACTIVE = just yield a tick)
+        unsigned long durationMs;
+    };
+
+    PowerManager();
+
+    /**
+     * Configure frequency scaling and wake sources. Call once in setup().
+     * @return true if frequency scaling is active
+     */
+    bool begin();
+
+    /**
+     * Start collecting deadlines for this loop() pass
+     */
+    void beginCycle(unsigned long now);
+
+    /**
+     * Something needs the CPU within ms from now
+     * @param source Short tag reported in status ("pump", "upload", ...)
+     */
+    void wakeWithin(unsigned long ms, const char* source);
+
+    /**
+     * A measurement starts in ms; wake early enough for fresh GPS/N2K data
+     */
+    void wakeForMeasurement(unsigned long ms, const char* source);
+
+    /**
+     * Keep the CPU awake this pass (sensors being read, calibration, OTA)
+     */
+    void stayAwake(const char* reason);
+
+    /**
+     * Radio users this pass: light sleep would drop them
+     * @param apClients Stations connected to our AP
+     * @param stationLinked Connected to the boat's WiFi
+     */
+    void setRadioState(uint8_t apClients, bool stationLinked);
+
+    /**
+     * What idle() would do right now
+     */
+    Decision decide(unsigned long now) const;
+
+    /**
+     * Sleep or yield until the next deadline. Call at the end of loop().
+     */
+    void idle();
+
+    /**
+     * Web task poll interval: short while an AP client is connected
+     */
+    uint32_t getWebPollMs() const;
+
+    // Statistics
+    uint64_t getResidencyMs(PowerState state) const { return _residencyMs[(int)state]; }
+    float getChargeMAh(PowerState state) const;
+    float getAverageCurrentMA() const;
+    uint32_t getSleepCount() const { return _sleepCount; }
+    uint32_t getWakeCount(WakeCause cause) const { return _wakeCounts[(int)cause]; }
+    const char* getNextDeadlineSource() const { return _deadlineSource; }
+    unsigned long getNextDeadlineMs() const { return _deadlineMs; }
+    const char* getLastVeto() const { return _veto; }
+    bool isFrequencyScaling() const { return _dfsActive; }
+
+    static const char* stateName(PowerState state);
+    static const char* wakeCauseName(WakeCause cause);
+
+private:
+    unsigned long _cycleStart;
+    unsigned long _deadlineMs;      // relative to _cycleStart
+    const char* _deadlineSource;
+    const char* _veto;
+    volatile uint8_t _apClients;    // read by the web task on core 0
+    bool _stationLinked;
+    bool _dfsActive;
+
+    unsigned long _lastMark;        // end of the previous idle()
+    uint64_t _residencyMs[(int)PowerState::COUNT];
+    uint32_t _sleepCount;
+    uint32_t _wakeCounts[(int)WakeCause::COUNT];
+
+    // Early-wake backoff: a busy CAN bus would wake us every few ms
+    uint8_t _earlyWakes;
+    bool _sleepBlocked;
+    unsigned long _sleepBlockedAt;
+
+    void account(PowerState state, unsigned long ms);
+    void noteWake(WakeCause cause, unsigned long requestedMs, unsigned long sleptMs, unsigned long now);
+    WakeCause sleepFor(unsigned long ms);
+};
+
+#endif // SEASENSE_POWER_MANAGER_H
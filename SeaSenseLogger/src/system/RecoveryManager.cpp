@@ -0,0 +1,248 @@
+/**
+ * SeaSense Logger - Recovery Manager Implementation
+ */
+
+#include "RecoveryManager.h"
+#include "../../config/hardware_config.h"
+
+RecoveryManager::RecoveryManager()
+    : _rebootRequested(false),
+      _rebootReason("")
+{
+    for (int i = 0; i < (int)Subsystem::COUNT; i++) {
+        SubsystemState& sub = _subs[i];
+        sub.state = HealthState::HEALTHY;
+        sub.monitored = false;
+        sub.critical = false;
+        sub.threshold = 1;
+        sub.level = 0;
+        sub.failures = 0;
+        sub.lastAction = RecoveryAction::RETRY;
+        sub.hasLastAction = false;
+        sub.nextActionAt = 0;
+        sub.stateSince = 0;
+        for (int k = 0; k < (int)HealthState::COUNT; k++) sub.stateMs[k] = 0;
+        for (int k = 0; k < (int)RecoveryAction::COUNT; k++) sub.actions[k] = 0;
+    }
+
+    // Without the sensor bus there are no measurements; without SPIFFS
+    // there is no upload queue. Everything else degrades gracefully.
+    setPolicy(Subsystem::I2C, RECOVERY_I2C_FAILURE_THRESHOLD, true);
+    setPolicy(Subsystem::SD, RECOVERY_SD_FAILURE_THRESHOLD, false);
+    setPolicy(Subsystem::SPIFFS, RECOVERY_SPIFFS_FAILURE_THRESHOLD, true);
+    setPolicy(Subsystem::WIFI, RECOVERY_WIFI_FAILURE_THRESHOLD, false);
+    setPolicy(Subsystem::N2K, RECOVERY_STALE_FAILURE_THRESHOLD, false);
+    setPolicy(Subsystem::GPS, RECOVERY_STALE_FAILURE_THRESHOLD, false);
+    setPolicy(Subsystem::IMU, RECOVERY_STALE_FAILURE_THRESHOLD, false);
+}
+
+void RecoveryManager::setHandler(Subsystem subsystem, RecoveryAction action, ActionHandler handler) {
+    _subs[(int)subsystem].handlers[(int)action] = handler;
+}
+
+void RecoveryManager::setPolicy(Subsystem subsystem, uint8_t failureThreshold, bool critical) {
+    SubsystemState& sub = _subs[(int)subsystem];
+    sub.threshold = (failureThreshold > 0) ? failureThreshold : 1;
+    sub.critical = critical;
+}
+
+void RecoveryManager::reportSuccess(Subsystem subsystem, unsigned long now) {
+    SubsystemState& sub = _subs[(int)subsystem];
+    if (!sub.monitored) {
+        sub.monitored = true;
+        sub.stateSince = now;
+    }
+    sub.failures = 0;
+    if (sub.state == HealthState::HEALTHY) {
+        return;
+    }
+
+    Serial.print("[RECOVERY] ");
+    Serial.print(subsystemName(subsystem));
+    Serial.print(" recovered after ");
+    Serial.print((now - sub.stateSince) / 1000);
+    Serial.println(" s");
+    sub.level = 0;
+    enter(subsystem, HealthState::HEALTHY, now);
+}
+
+void RecoveryManager::reportFailure(Subsystem subsystem, unsigned long now) {
+    SubsystemState& sub = _subs[(int)subsystem];
+    if (!sub.monitored) {
+        sub.monitored = true;
+        sub.stateSince = now;
+    }
+    if (sub.failures < 0xFFFF) sub.failures++;
+
+    switch (sub.state) {
+        case HealthState::HEALTHY:
+            if (sub.failures >= sub.threshold) {
+                Serial.print("[RECOVERY] ");
+                Serial.print(subsystemName(subsystem));
+                Serial.print(" degraded after ");
+                Serial.print(sub.failures);
+                Serial.println(" failures");
+                sub.level = 0;
+                sub.nextActionAt = now;
+                enter(subsystem, HealthState::DEGRADED, now);
+            }
+            break;
+        case HealthState::RECOVERING:
+            // The last action didn't help; next rung once its backoff is up
+            enter(subsystem, HealthState::DEGRADED, now);
+            break;
+        default:
+            break;  // already queued, or disabled and waiting for a probe
+    }
+}
+
+void RecoveryManager::process(unsigned long now) {
+    for (int i = 0; i < (int)Subsystem::COUNT; i++) {
+        SubsystemState& sub = _subs[i];
+        if (!sub.monitored || (long)(now - sub.nextActionAt) < 0) {
+            continue;
+        }
+        if (sub.state == HealthState::DEGRADED) {
+            escalate((Subsystem)i, now);
+        } else if (sub.state == HealthState::DISABLED) {
+            probe((Subsystem)i, now);
+        }
+    }
+}
+
+uint64_t RecoveryManager::getTimeInState(Subsystem s, HealthState state, unsigned long now) const {
+    const SubsystemState& sub = _subs[(int)s];
+    uint64_t ms = sub.stateMs[(int)state];
+    if (sub.monitored && sub.state == state) {
+        ms += now - sub.stateSince;
+    }
+    return ms;
+}
+
+float RecoveryManager::getAvailability(Subsystem s, unsigned long now) const {
+    uint64_t total = 0;
+    for (int k = 0; k < (int)HealthState::COUNT; k++) {
+        total += getTimeInState(s, (HealthState)k, now);
+    }
+    if (total == 0) {
+        return 1.0f;
+    }
+    return (float)getTimeInState(s, HealthState::HEALTHY, now) / (float)total;
+}
+
+const char* RecoveryManager::subsystemName(Subsystem s) {
+    switch (s) {
+        case Subsystem::I2C:    return "i2c";
+        case Subsystem::SD:     return "sd";
+        case Subsystem::SPIFFS: return "spiffs";
+        case Subsystem::WIFI:   return "wifi";
+        case Subsystem::N2K:    return "n2k";
+        case Subsystem::GPS:    return "gps";
+        case Subsystem::IMU:    return "imu";
+        default:                return "unknown";
+    }
+}
+
+const char* RecoveryManager::stateName(HealthState state) {
+    switch (state) {
+        case HealthState::HEALTHY:    return "healthy";
+        case HealthState::DEGRADED:   return "degraded";
+        case HealthState::RECOVERING: return "recovering";
+        case HealthState::DISABLED:   return "disabled";
+        default:                      return "unknown";
+    }
+}
+
+const char* RecoveryManager::actionName(RecoveryAction action) {
+    switch (action) {
+        case RecoveryAction::RETRY:   return "retry";
+        case RecoveryAction::RESET:   return "reset";
+        case RecoveryAction::REINIT:  return "reinit";
+        case RecoveryAction::DISABLE: return "disable";
+        case RecoveryAction::REBOOT:  return "reboot";
+        default:                      return "none";
+    }
+}
+
+// ============================================================================
+// Private
+// ============================================================================
+
+void RecoveryManager::enter(Subsystem s, HealthState state, unsigned long now) {
+    SubsystemState& sub = _subs[(int)s];
+    sub.stateMs[(int)sub.state] += now - sub.stateSince;
+    sub.stateSince = now;
+    sub.state = state;
+}
+
+void RecoveryManager::escalate(Subsystem s, unsigned long now) {
+    SubsystemState& sub = _subs[(int)s];
+
+    // Take the next rung that has something to do; retry always does
+    while (sub.level < (uint8_t)RecoveryAction::DISABLE) {
+        RecoveryAction action = (RecoveryAction)sub.level;
+        sub.level++;
+        if (action != RecoveryAction::RETRY && !sub.handlers[(int)action]) {
+            continue;
+        }
+        bool done = runHandler(s, action);
+        sub.nextActionAt = now + backoffFor(sub.level);
+        if (done) {
+            enter(s, HealthState::RECOVERING, now);
+        }
+        return;
+    }
+
+    runHandler(s, RecoveryAction::DISABLE);
+    sub.nextActionAt = now + RECOVERY_PROBE_INTERVAL_MS;
+    enter(s, HealthState::DISABLED, now);
+}
+
+void RecoveryManager::probe(Subsystem s, unsigned long now) {
+    SubsystemState& sub = _subs[(int)s];
+    sub.nextActionAt = now + RECOVERY_PROBE_INTERVAL_MS;
+
+    // A critical subsystem that stays down gets a reboot, at most once per
+    // RECOVERY_REBOOT_MIN_UPTIME_MS of uptime
+    if (sub.critical && !_rebootRequested && now >= RECOVERY_REBOOT_MIN_UPTIME_MS) {
+        runHandler(s, RecoveryAction::REBOOT);
+        _rebootRequested = true;
+        _rebootReason = subsystemName(s);
+        return;
+    }
+
+    RecoveryAction action = sub.handlers[(int)RecoveryAction::REINIT]
+        ? RecoveryAction::REINIT : RecoveryAction::RESET;
+    if (sub.handlers[(int)action] && runHandler(s, action)) {
+        sub.nextActionAt = now + backoffFor(sub.level);
+        enter(s, HealthState::RECOVERING, now);
+    }
+}
+
+bool RecoveryManager::runHandler(Subsystem s, RecoveryAction action) {
+    SubsystemState& sub = _subs[(int)s];
+    sub.actions[(int)action]++;
+    sub.lastAction = action;
+    sub.hasLastAction = true;
+
+    Serial.print("[RECOVERY] ");
+    Serial.print(subsystemName(s));
+    Serial.print(": ");
+    Serial.print(actionName(action));
+    Serial.print(" (");
+    Serial.print(sub.failures);
+    Serial.println(" consecutive failures)");
+
+    if (!sub.handlers[(int)action]) {
+        return true;  // retry, or a rung that only changes our own state
+    }
+    return sub.handlers[(int)action]();
+}
+
+unsigned long RecoveryManager::backoffFor(uint8_t level) {
+    unsigned long ms = RECOVERY_BACKOFF_BASE_MS;
+    for (uint8_t i = 1; i < level && ms < RECOVERY_BACKOFF_MAX_MS; i++) {
+        ms *= 2;
+    }
+    return (ms < RECOVERY_BACKOFF_MAX_MS) ? ms : RECOVERY_BACKOFF_MAX_MS;
+}
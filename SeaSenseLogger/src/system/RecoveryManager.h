@@ -0,0 +1,141 @@
+/**
+ * SeaSense Logger - Recovery Manager
+ *
+ * Graduated recovery for every subsystem that can fail in the field:
+ * - Each subsystem (I2C, SD, SPIFFS, WiFi, N2K, GPS, IMU) has a health state
+ *   machine fed by success/failure reports from the code that uses it
+ * - Escalating actions per subsystem: retry -> reset -> reinit -> disable,
+ *   with exponential backoff between steps; steps without a handler are skipped
+ * - Disabled subsystems are re-probed periodically; only critical ones
+ *   (sensor bus, SPIFFS) escalate to a reboot, and never in the first hour
+ *   after boot, so a hard fault can't turn into a reboot storm
+ * - Time spent per health state for /api/status
+ *
+ * Reports, process() and handlers all run on the loop() core. Actions that
+ * touch another core's resources (WiFi) should only post a request there.
+ */
+
+#ifndef SEASENSE_RECOVERY_MANAGER_H
+#define SEASENSE_RECOVERY_MANAGER_H
+
+#include <Arduino.h>
+#include <functional>
+
+enum class Subsystem : uint8_t {
+    I2C = 0,
+    SD = 1,
+    SPIFFS = 2,
+    WIFI = 3,
+    N2K = 4,
+    GPS = 5,
+    IMU = 6,
+    COUNT = 7
+};
+
+enum class HealthState : uint8_t {
+    HEALTHY = 0,
+    DEGRADED = 1,       // failing, next action waiting for its backoff
+    RECOVERING = 2,     // action taken, waiting for the next report
+    DISABLED = 3,       // given up for now, probed periodically
+    COUNT = 4
+};
+
+// Escalation ladder, in order
+enum class RecoveryAction : uint8_t {
+    RETRY = 0,          // do nothing, let the next attempt try again
+    RESET = 1,          // cheap reset (bus reset, remount, reconnect)
+    REINIT = 2,         // full re-initialisation of the driver
+    DISABLE = 3,        // stop using it, keep the rest of the system running
+    REBOOT = 4,         // critical subsystems only
+    COUNT = 5
+};
+
+class RecoveryManager {
+public:
+    // Returns true if the action was carried out (not that it fixed anything)
+    typedef std::function<bool()> ActionHandler;
+
+    RecoveryManager();
+
+    /**
+     * Register the handler for one step of a subsystem's ladder
+     */
+    void setHandler(Subsystem subsystem, RecoveryAction action, ActionHandler handler);
+
+    /**
+     * Override the default policy
+     * @param failureThreshold Consecutive failures before recovery starts
+     * @param critical Escalate to a reboot once disabled
+     */
+    void setPolicy(Subsystem subsystem, uint8_t failureThreshold, bool critical);
+
+    /**
+     * The subsystem worked (write succeeded, fresh data, link up)
+     */
+    void reportSuccess(Subsystem subsystem, unsigned long now);
+
+    /**
+     * The subsystem failed
+     */
+    void reportFailure(Subsystem subsystem, unsigned long now);
+
+    /**
+     * Run due recovery actions. Call every loop() pass.
+     */
+    void process(unsigned long now);
+
+    /**
+     * A critical subsystem ran out of options: loop() should restart at a
+     * safe point
+     */
+    bool isRebootRequested() const { return _rebootRequested; }
+    const char* getRebootReason() const { return _rebootReason; }
+
+    // Per-subsystem status
+    bool isMonitored(Subsystem s) const { return _subs[(int)s].monitored; }
+    bool isAvailable(Subsystem s) const { return _subs[(int)s].state != HealthState::DISABLED; }
+    HealthState getState(Subsystem s) const { return _subs[(int)s].state; }
+    uint16_t getConsecutiveFailures(Subsystem s) const { return _subs[(int)s].failures; }
+    RecoveryAction getNextAction(Subsystem s) const { return (RecoveryAction)_subs[(int)s].level; }
+    RecoveryAction getLastAction(Subsystem s) const { return _subs[(int)s].lastAction; }
+    uint32_t getActionCount(Subsystem s, RecoveryAction a) const { return _subs[(int)s].actions[(int)a]; }
+    uint64_t getTimeInState(Subsystem s, HealthState state, unsigned long now) const;
+
+    /**
+     * Fraction of monitored time spent HEALTHY (1.0 if never monitored)
+     */
+    float getAvailability(Subsystem s, unsigned long now) const;
+
+    static const char* subsystemName(Subsystem s);
+    static const char* stateName(HealthState state);
+    static const char* actionName(RecoveryAction action);
+
+private:
+    struct SubsystemState {
+        HealthState state;
+        bool monitored;                 // at least one report seen
+        bool critical;
+        uint8_t threshold;
+        uint8_t level;                  // next rung of the ladder
+        uint16_t failures;              // consecutive
+        RecoveryAction lastAction;
+        bool hasLastAction;
+        unsigned long nextActionAt;
+        unsigned long stateSince;
+        uint64_t stateMs[(int)HealthState::COUNT];
+        uint32_t actions[(int)RecoveryAction::COUNT];
+        ActionHandler handlers[(int)RecoveryAction::COUNT];
+    };
+
+    SubsystemState _subs[(int)Subsystem::COUNT];
+    bool _rebootRequested;
+    const char* _rebootReason;
+
+    void enter(Subsystem s, HealthState state, unsigned long now);
+    void escalate(Subsystem s, unsigned long now);
+    void probe(Subsystem s, unsigned long now);
+    bool runHandler(Subsystem s, RecoveryAction action);
+    static unsigned long backoffFor(uint8_t level);
+};
+
+#endif // SEASENSE_RECOVERY_MANAGER_H
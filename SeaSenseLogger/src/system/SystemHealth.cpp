@@ -164,7 +164,11 @@ uint32_t SystemHealth::getErrorCount(ErrorType type) const {
 }
 
 String SystemHealth::getResetReasonString() const {
-    switch (_resetReason) {
+    return resetReasonName(_resetReason);
+}
+
+const char* SystemHealth::resetReasonName(esp_reset_reason_t reason) {
+    switch (reason) {
         case ESP_RST_POWERON:  return "Power-on";
         case ESP_RST_EXT:      return "External reset";
         case ESP_RST_SW:       return "Software reset";
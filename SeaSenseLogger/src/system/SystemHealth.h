@@ -78,6 +78,7 @@ public:
      * Get reset reason as a human-readable string.
      */
     String getResetReasonString() const;
+    static const char* resetReasonName(esp_reset_reason_t reason);
 
     /**
      * Clear safe mode: zeroes consecutive reboot counter in NVS.
@@ -0,0 +1,207 @@
+/**
+ * SeaSense Logger - Time Service Implementation
+ */
+
+#include "TimeService.h"
+#include "../../config/hardware_config.h"
+#include <time.h>
+#ifndef NATIVE_TEST
+#include <sys/time.h>
+#endif
+
+const char* const TimeService::UNSYNCED_UTC = "0000-00-00T00:00:00Z";
+
+TimeService::TimeService()
+    : _lastMillis(0),
+      _wraps(0),
+      _source(TimeSource::NONE),
+      _anchorMono(0),
+      _anchorEpochMs(0),
+      _lastGnssMono(0),
+      _gnssSeen(false),
+      _driftPpm(0.0f),
+      _lastStepMs(0),
+      _syncCount(0)
+{
+#ifndef NATIVE_TEST
+    portMUX_INITIALIZE(&_mux);
+#endif
+}
+
+void TimeService::update(unsigned long now) {
+    lock();
+    uint32_t ms = (uint32_t)now;
+    // Only move forward: a stale now from the other core is not a wrap
+    if ((uint32_t)(ms - _lastMillis) < 0x80000000UL) {
+        if (ms < _lastMillis) {
+            _wraps++;
+        }
+        _lastMillis = ms;
+    }
+    unlock();
+}
+
+bool TimeService::sync(TimeSource source, int64_t epochMs, unsigned long atMs) {
+    if (source == TimeSource::NONE || epochMs <= 0) {
+        return false;
+    }
+
+    lock();
+    uint64_t mono = monoLocked((uint32_t)atMs);
+    bool gnss = (source == TimeSource::GPS || source == TimeSource::N2K);
+    bool synced = (_source != TimeSource::NONE);
+    int64_t sinceAnchor = (int64_t)mono - (int64_t)_anchorMono;
+
+    bool accept;
+    if (!synced) {
+        accept = true;
+    } else if (gnss) {
+        // First GNSS after NTP always takes over; after that, rate-limited
+        accept = (_source == TimeSource::NTP) || sinceAnchor >= (int64_t)TIME_RESYNC_INTERVAL_MS;
+    } else {
+        accept = !_gnssSeen
+              || (int64_t)mono - (int64_t)_lastGnssMono >= (int64_t)TIME_GNSS_HOLDOVER_MS;
+    }
+    if (gnss) {
+        _lastGnssMono = mono;
+        _gnssSeen = true;
+    }
+    if (!accept) {
+        unlock();
+        return false;
+    }
+
+    if (synced) {
+        int64_t error = epochMs - epochAtMonoLocked(mono);
+
+        // Error accumulated over a long enough span from the same source
+        // is crystal drift, not reference jitter
+        if (source == _source && sinceAnchor >= (int64_t)TIME_DRIFT_MIN_SPAN_MS) {
+            float measured = (float)((double)error * 1e6 / (double)sinceAnchor);
+            _driftPpm = constrain(_driftPpm + TIME_DRIFT_GAIN * measured,
+                                  -TIME_MAX_DRIFT_PPM, TIME_MAX_DRIFT_PPM);
+        }
+        _lastStepMs = (int32_t)constrain(error, (int64_t)INT32_MIN, (int64_t)INT32_MAX);
+    }
+
+    _source = source;
+    _anchorMono = mono;
+    _anchorEpochMs = epochMs;
+    _syncCount++;
+    float drift = _driftPpm;
+    int32_t step = _lastStepMs;
+    unlock();
+
+#ifndef NATIVE_TEST
+    // SNTP sets the system clock itself; GNSS time has to be pushed so
+    // time() and file timestamps agree with us
+    if (source != TimeSource::NTP) {
+        int64_t nowMs = epochMs + (int64_t)(uint32_t)(millis() - atMs);
+        struct timeval tv;
+        tv.tv_sec = (time_t)(nowMs / 1000);
+        tv.tv_usec = (suseconds_t)((nowMs % 1000) * 1000);
+        settimeofday(&tv, nullptr);
+    }
+#endif
+
+    if (!synced) {
+        Serial.print("[TIME] Synced from ");
+        Serial.print(sourceName(source));
+        Serial.print(": ");
+        Serial.println(formatUTC(epochMs));
+    } else {
+        Serial.printf("[TIME] Re-sync from %s: step %ld ms, drift %.1f ppm\n",
+                      sourceName(source), (long)step, drift);
+    }
+    return true;
+}
+
+bool TimeService::isSynced() const {
+    lock();
+    bool synced = (_source != TimeSource::NONE);
+    unlock();
+    return synced;
+}
+
+uint64_t TimeService::monoMs(unsigned long now) const {
+    lock();
+    uint64_t mono = monoLocked((uint32_t)now);
+    unlock();
+    return mono;
+}
+
+int64_t TimeService::epochMs(unsigned long now) const {
+    lock();
+    int64_t epoch = (_source == TimeSource::NONE) ? 0 : epochAtMonoLocked(monoLocked((uint32_t)now));
+    unlock();
+    return epoch;
+}
+
+int64_t TimeService::epochMsForMillis(unsigned long stampMs, unsigned long now) const {
+    lock();
+    int64_t epoch = 0;
+    if (_source != TimeSource::NONE) {
+        uint64_t mono = monoLocked((uint32_t)now) - (uint32_t)((uint32_t)now - (uint32_t)stampMs);
+        epoch = epochAtMonoLocked(mono);
+    }
+    unlock();
+    return epoch;
+}
+
+String TimeService::nowUTC(unsigned long now) const {
+    int64_t epoch = epochMs(now);
+    return epoch > 0 ? formatUTC(epoch) : String("");
+}
+
+String TimeService::formatUTC(int64_t epochMs) {
+    time_t seconds = (time_t)(epochMs / 1000);
+    struct tm t;
+    gmtime_r(&seconds, &t);
+    char buf[32];
+    strftime(buf, sizeof(buf), "%Y-%m-%dT%H:%M:%SZ", &t);
+    return String(buf);
+}
+
+unsigned long TimeService::getLastSyncAgeMs(unsigned long now) const {
+    lock();
+    uint64_t age = (_source == TimeSource::NONE) ? 0 : monoLocked((uint32_t)now) - _anchorMono;
+    unlock();
+    return age > 0xFFFFFFFFULL ? 0xFFFFFFFFUL : (unsigned long)age;
+}
+
+const char* TimeService::sourceName(TimeSource source) {
+    switch (source) {
+        case TimeSource::NTP:  return "ntp";
+        case TimeSource::GPS:  return "gps";
+        case TimeSource::N2K:  return "n2k";
+        default:               return "none";
+    }
+}
+
+// ============================================================================
+// Private
+// ============================================================================
+
+uint64_t TimeService::monoLocked(uint32_t now) const {
+    // Signed distance from the last update(): stamps up to ~24 days either
+    // side of it land in the right wrap
+    int32_t offset = (int32_t)(now - _lastMillis);
+    return (((uint64_t)_wraps << 32) | _lastMillis) + (int64_t)offset;
+}
+
+int64_t TimeService::epochAtMonoLocked(uint64_t mono) const {
+    int64_t elapsed = (int64_t)mono - (int64_t)_anchorMono;
+    return _anchorEpochMs + elapsed + (int64_t)((double)elapsed * _driftPpm * 1e-6);
+}
+
+void TimeService::lock() const {
+#ifndef NATIVE_TEST
+    portENTER_CRITICAL(&_mux);
+#endif
+}
+
+void TimeService::unlock() const {
+#ifndef NATIVE_TEST
+    portEXIT_CRITICAL(&_mux);
+#endif
+}
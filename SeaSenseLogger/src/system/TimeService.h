@@ -0,0 +1,106 @@
+/**
+ * SeaSense Logger - Time Service
+ *
+ * One clock for the whole firmware instead of GPS epochs, NTP and
+ * millis() arithmetic scattered across modules:
+ * - 64-bit monotonic milliseconds that keep counting through the 49.7-day
+ *   millis() wrap (update() must run at least once per wrap; loop() does)
+ * - UTC disciplined from GPS, NMEA2000 or NTP. GNSS wins; NTP is only
+ *   accepted once no GNSS time has been seen for TIME_GNSS_HOLDOVER_MS
+ * - Crystal drift estimated from the error at each re-sync and applied
+ *   between syncs, so holdover without GPS stays close
+ * - Conversion of any millis() stamp from this boot to UTC, which is what
+ *   the storage back-fill uses for records written before the first sync
+ *
+ * Written from loop(), read from both cores (web status): state is
+ * guarded by a spinlock.
+ */
+
+#ifndef SEASENSE_TIME_SERVICE_H
+#define SEASENSE_TIME_SERVICE_H
+
+#include <Arduino.h>
+
+enum class TimeSource : uint8_t {
+    NONE = 0,
+    NTP = 1,
+    GPS = 2,
+    N2K = 3
+};
+
+class TimeService {
+public:
+    TimeService();
+
+    /** Fixed-width timestamp stored for records written before sync */
+    static const char* const UNSYNCED_UTC;      // "0000-00-00T00:00:00Z"
+    static const uint8_t UTC_LENGTH = 20;
+
+    /**
+     * Track millis() wraps. Call every loop() pass.
+     */
+    void update(unsigned long now);
+
+    /**
+     * Offer a reference time.
+     * @param source Where it came from
+     * @param epochMs UTC in ms since 1970
+     * @param atMs millis() at which epochMs was true (GPS: minus fix age)
+     * @return true if the clock was (re-)anchored to it
+     */
+    bool sync(TimeSource source, int64_t epochMs, unsigned long atMs);
+
+    /** True once any source has set the clock (stays true, holdover) */
+    bool isSynced() const;
+
+    /** 64-bit monotonic ms since boot */
+    uint64_t monoMs(unsigned long now) const;
+
+    /** UTC ms since 1970 at millis() = now (0 if not synced) */
+    int64_t epochMs(unsigned long now) const;
+
+    /**
+     * UTC of a millis() stamp taken earlier in this boot, less than one
+     * wrap before now (0 if not synced)
+     */
+    int64_t epochMsForMillis(unsigned long stampMs, unsigned long now) const;
+
+    /** ISO 8601 UTC at now ("" if not synced) */
+    String nowUTC(unsigned long now) const;
+
+    /** ISO 8601 UTC, second resolution: "YYYY-MM-DDTHH:MM:SSZ" */
+    static String formatUTC(int64_t epochMs);
+
+    // Status
+    TimeSource getSource() const { return _source; }
+    uint32_t getSyncCount() const { return _syncCount; }
+    float getDriftPpm() const { return _driftPpm; }
+    int32_t getLastStepMs() const { return _lastStepMs; }
+    unsigned long getLastSyncAgeMs(unsigned long now) const;
+
+    static const char* sourceName(TimeSource source);
+
+private:
+    uint32_t _lastMillis;
+    uint32_t _wraps;
+
+    TimeSource _source;
+    uint64_t _anchorMono;       // monotonic ms of the last anchor
+    int64_t _anchorEpochMs;     // UTC at the anchor
+    uint64_t _lastGnssMono;     // last GNSS sync offered (accepted or not)
+    bool _gnssSeen;
+    float _driftPpm;            // + = our crystal runs slow
+    int32_t _lastStepMs;        // correction applied by the last anchor
+    uint32_t _syncCount;
+
+#ifndef NATIVE_TEST
+    mutable portMUX_TYPE _mux;
+#endif
+
+    uint64_t monoLocked(uint32_t now) const;
+    int64_t epochAtMonoLocked(uint64_t mono) const;
+    void lock() const;
+    void unlock() const;
+};
+
+#endif // SEASENSE_TIME_SERVICE_H
@@ -0,0 +1,58 @@
+/**
+ * SeaSense Logger - Record Change Feed Implementation
+ */
+
+#include "ChangeFeed.h"
+#include <string.h>
+
+uint32_t ChangeFeed::streamId(bool sd, bool empty, unsigned long firstMillis,
+                              const char* firstType, float firstValue) {
+    uint32_t hash = 2166136261u;
+    const char* store = sd ? "sd" : "spiffs";
+    hash = fnv1a(hash, store, strlen(store));
+    if (!empty) {
+        // The timestamp is left out: back-fill rewrites it in place
+        uint32_t ms = (uint32_t)firstMillis;
+        hash = fnv1a(hash, &ms, sizeof(ms));
+        if (firstType) {
+            hash = fnv1a(hash, firstType, strlen(firstType));
+        }
+        hash = fnv1a(hash, &firstValue, sizeof(firstValue));
+    }
+    return hash ? hash : 1;
+}
+
+ChangeFeed::Window ChangeFeed::plan(uint32_t stream, uint32_t clientStream, uint32_t since,
+                                    uint32_t total, uint16_t limit, uint32_t tail) {
+    Window w;
+    // A cursor past the end also means the store was replaced
+    w.reset = clientStream != stream || since > total;
+    w.gap = false;
+    if (!w.reset) {
+        w.from = since;
+        if (tail > 0 && total - since > tail) {
+            // Records the client would drop right away are not sent
+            w.from = total - tail;
+            w.gap = true;
+        }
+    } else if (tail > 0 && total > tail) {
+        w.from = total - tail;  // the client keeps only the newest records
+    } else {
+        w.from = 0;
+    }
+
+    uint32_t left = total - w.from;
+    w.count = left > limit ? limit : (uint16_t)left;
+    w.next = w.from + w.count;
+    w.more = w.next < total;
+    return w;
+}
+
+uint32_t ChangeFeed::fnv1a(uint32_t hash, const void* data, uint32_t len) {
+    const uint8_t* p = (const uint8_t*)data;
+    for (uint32_t i = 0; i < len; i++) {
+        hash ^= p[i];
+        hash *= 16777619u;
+    }
+    return hash;
+}
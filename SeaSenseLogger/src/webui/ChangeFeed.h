@@ -0,0 +1,60 @@
+/**
+ * SeaSense Logger - Record Change Feed
+ *
+ * Cursor logic behind /api/data/changes. A record's sequence number is its
+ * position in the primary store, so a client that has synced up to
+ * sequence N only needs what was appended after it. Positions are stable
+ * while the store only grows; clearing it, the SPIFFS circular buffer
+ * dropping its oldest records, or a switch between SD and SPIFFS shifts
+ * them. Those events change the store's first record, so the stream ID
+ * (the store plus a hash of its first record) changes with them and tells
+ * the client to drop its copy and start again from 0.
+ *
+ * Pure logic, no hardware dependencies — fully testable on native.
+ */
+
+#ifndef SEASENSE_CHANGE_FEED_H
+#define SEASENSE_CHANGE_FEED_H
+
+#include <stdint.h>
+
+class ChangeFeed {
+public:
+    // One response's slice of the store
+    struct Window {
+        bool reset;         // the client's cursor is invalid; it starts over at from
+        bool gap;           // valid cursor, but more than tail behind: from skips ahead
+        uint32_t from;      // sequence of the first record to send
+        uint16_t count;     // records to send
+        uint32_t next;      // cursor for the next request
+        bool more;          // records left after this slice
+    };
+
+    /**
+     * Identify the store's current contents
+     * @param sd true if the SD card is the primary store
+     * @param empty true if the store holds no records (first* ignored)
+     * @param firstMillis, firstType, firstValue The store's first record
+     * @return Non-zero stream ID (the store alone while it is empty)
+     */
+    static uint32_t streamId(bool sd, bool empty, unsigned long firstMillis,
+                             const char* firstType, float firstValue);
+
+    /**
+     * Decide what to send
+     * @param stream Current stream ID
+     * @param clientStream Stream ID the client synced against (0 = none)
+     * @param since The client's cursor (next from its last response)
+     * @param total Records in the store
+     * @param limit Most records per response
+     * @param tail Send at most the newest this many records: where a reset
+     *             starts, and how far behind a valid cursor may be (0 = all)
+     */
+    static Window plan(uint32_t stream, uint32_t clientStream, uint32_t since,
+                       uint32_t total, uint16_t limit, uint32_t tail = 0);
+
+private:
+    static uint32_t fnv1a(uint32_t hash, const void* data, uint32_t len);
+};
+
+#endif // SEASENSE_CHANGE_FEED_H
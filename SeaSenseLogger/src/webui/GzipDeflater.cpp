@@ -0,0 +1,281 @@
+/**
+ * SeaSense Logger - Streaming gzip Compressor Implementation
+ */
+
+#include "GzipDeflater.h"
+#include <stdlib.h>
+#include <string.h>
+
+// Deflate length codes 257..285 and distance codes 0..29 (RFC 1951 3.2.5)
+static const uint16_t LEN_BASE[] = {
+    3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17, 19, 23, 27, 31,
+    35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258
+};
+static const uint8_t LEN_EXTRA[] = {
+    0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2,
+    3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0
+};
+static const uint16_t DIST_BASE[] = {
+    1, 2, 3, 4, 5, 7, 9, 13, 17, 25, 33, 49, 65, 97, 129, 193,
+    257, 385, 513, 769, 1025, 1537, 2049, 3073, 4097, 6145, 8193, 12289, 16385, 24577
+};
+static const uint8_t DIST_EXTRA[] = {
+    0, 0, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 6,
+    7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13
+};
+static const uint8_t LEN_CODES = sizeof(LEN_EXTRA);
+static const uint8_t DIST_CODES = sizeof(DIST_EXTRA);
+
+static const uint16_t END_OF_BLOCK = 256;
+
+// CRC-32 (gzip polynomial), four bits at a time
+static uint32_t crc32Update(uint32_t crc, const uint8_t* data, size_t len) {
+    static const uint32_t NIBBLE[16] = {
+        0x00000000, 0x1DB71064, 0x3B6E20C8, 0x26D930AC, 0x76DC4190, 0x6B6B51F4, 0x4DB26158, 0x5005713C,
+        0xEDB88320, 0xF00F9344, 0xD6D6A3E8, 0xCB61B38C, 0x9B64C2B0, 0x86D3D2D4, 0xA00AE278, 0xBDBDF21C
+    };
+    crc = ~crc;
+    for (size_t i = 0; i < len; i++) {
+        crc ^= data[i];
+        crc = (crc >> 4) ^ NIBBLE[crc & 0x0F];
+        crc = (crc >> 4) ^ NIBBLE[crc & 0x0F];
+    }
+    return ~crc;
+}
+
+GzipDeflater::GzipDeflater()
+    : _failed(false),
+      _window(nullptr),
+      _head(nullptr),
+      _fill(0),
+      _pos(0),
+      _bitBuf(0),
+      _bitCount(0),
+      _outLen(0),
+      _crc(0),
+      _inputBytes(0),
+      _outputBytes(0)
+{
+}
+
+GzipDeflater::~GzipDeflater() {
+    end();
+}
+
+bool GzipDeflater::begin(Sink sink) {
+    end();
+    _sink = sink;
+    _errorMessage = "";
+    _failed = false;
+    _fill = 0;
+    _pos = 0;
+    _bitBuf = 0;
+    _bitCount = 0;
+    _outLen = 0;
+    _crc = 0;
+    _inputBytes = 0;
+    _outputBytes = 0;
+
+    _window = (uint8_t*)malloc(BUFFER_SIZE);
+    _head = (uint16_t*)calloc(HASH_SIZE, sizeof(uint16_t));
+    if (!_window || !_head) {
+        end();
+        return fail("Out of memory for gzip deflater");
+    }
+
+    // gzip header: magic, deflate, no flags, no mtime, no extra flags, OS unknown
+    static const uint8_t HEADER[10] = {0x1F, 0x8B, 0x08, 0, 0, 0, 0, 0, 0, 0xFF};
+    for (uint8_t b : HEADER) {
+        putByte(b);
+    }
+
+    // One fixed-Huffman block for the whole stream (no size limit on those)
+    putBits(1, 1);      // BFINAL
+    putBits(1, 2);      // BTYPE = 01
+    return !_failed;
+}
+
+bool GzipDeflater::feed(const uint8_t* data, size_t len) {
+    if (!_window || _failed) {
+        return false;
+    }
+    _crc = crc32Update(_crc, data, len);
+    _inputBytes += len;
+
+    while (len > 0) {
+        if (_fill == BUFFER_SIZE) {
+            slide();
+        }
+        size_t n = BUFFER_SIZE - _fill;
+        if (n > len) n = len;
+        memcpy(_window + _fill, data, n);
+        _fill += n;
+        data += n;
+        len -= n;
+        compress(false);
+    }
+    return !_failed;
+}
+
+bool GzipDeflater::finish() {
+    if (!_window || _failed) {
+        return false;
+    }
+    compress(true);
+    putSymbol(END_OF_BLOCK);
+    alignBits();
+
+    // Trailer: CRC-32 and input size, little-endian
+    for (uint8_t i = 0; i < 4; i++) putByte((_crc >> (8 * i)) & 0xFF);
+    for (uint8_t i = 0; i < 4; i++) putByte((_inputBytes >> (8 * i)) & 0xFF);
+    flushOutput();
+    return !_failed;
+}
+
+void GzipDeflater::end() {
+    free(_window);
+    free(_head);
+    _window = nullptr;
+    _head = nullptr;
+}
+
+// ============================================================================
+// LZ77
+// ============================================================================
+
+uint16_t GzipDeflater::hashAt(size_t i) const {
+    uint32_t v = ((uint32_t)_window[i] << 16) | ((uint32_t)_window[i + 1] << 8) | _window[i + 2];
+    return (uint16_t)((uint32_t)(v * 2654435761U) >> (32 - HASH_BITS));
+}
+
+void GzipDeflater::insert(size_t i) {
+    _head[hashAt(i)] = (uint16_t)(i + 1);
+}
+
+// Encode window positions; until the final call keep MAX_MATCH bytes of
+// lookahead so a match is never cut short by the end of a chunk
+void GzipDeflater::compress(bool final) {
+    while (_pos < _fill && (final || _fill - _pos >= MAX_MATCH)) {
+        size_t avail = _fill - _pos;
+        if (avail >= MIN_MATCH) {
+            uint16_t h = hashAt(_pos);
+            uint16_t cand = _head[h];
+            _head[h] = (uint16_t)(_pos + 1);
+
+            if (cand > 0) {
+                const uint8_t* a = _window + cand - 1;
+                const uint8_t* b = _window + _pos;
+                size_t maxLen = avail < MAX_MATCH ? avail : MAX_MATCH;
+                size_t len = 0;
+                while (len < maxLen && a[len] == b[len]) {
+                    len++;
+                }
+                if (len >= MIN_MATCH) {
+                    putMatch((uint16_t)len, (uint16_t)(_pos - (cand - 1)));
+                    // Index the positions inside the match for later matches
+                    for (size_t i = _pos + 1; i < _pos + len && i + MIN_MATCH <= _fill; i++) {
+                        insert(i);
+                    }
+                    _pos += len;
+                    continue;
+                }
+            }
+        }
+        putLiteral(_window[_pos]);
+        _pos++;
+    }
+}
+
+// Drop the oldest WINDOW_SIZE bytes; everything at or after _pos stays
+void GzipDeflater::slide() {
+    memmove(_window, _window + WINDOW_SIZE, BUFFER_SIZE - WINDOW_SIZE);
+    _fill -= WINDOW_SIZE;
+    _pos -= WINDOW_SIZE;
+    for (size_t i = 0; i < HASH_SIZE; i++) {
+        _head[i] = _head[i] > WINDOW_SIZE ? _head[i] - WINDOW_SIZE : 0;
+    }
+}
+
+// ============================================================================
+// Fixed Huffman output (RFC 1951 3.2.6)
+// ============================================================================
+
+void GzipDeflater::putLiteral(uint8_t c) {
+    putSymbol(c);
+}
+
+void GzipDeflater::putMatch(uint16_t length, uint16_t distance) {
+    uint8_t lc = LEN_CODES - 1;
+    while (LEN_BASE[lc] > length) lc--;
+    putSymbol(257 + lc);
+    putBits(length - LEN_BASE[lc], LEN_EXTRA[lc]);
+
+    uint8_t dc = DIST_CODES - 1;
+    while (DIST_BASE[dc] > distance) dc--;
+    putCode(dc, 5);
+    putBits(distance - DIST_BASE[dc], DIST_EXTRA[dc]);
+}
+
+void GzipDeflater::putSymbol(uint16_t sym) {
+    if (sym < 144) {
+        putCode(0x30 + sym, 8);
+    } else if (sym < 256) {
+        putCode(0x190 + sym - 144, 9);
+    } else if (sym < 280) {
+        putCode(sym - 256, 7);
+    } else {
+        putCode(0xC0 + sym - 280, 8);
+    }
+}
+
+// Huffman codes are packed most significant bit first
+void GzipDeflater::putCode(uint16_t code, uint8_t bits) {
+    uint16_t reversed = 0;
+    for (uint8_t i = 0; i < bits; i++) {
+        reversed = (reversed << 1) | ((code >> i) & 1);
+    }
+    putBits(reversed, bits);
+}
+
+void GzipDeflater::putBits(uint32_t value, uint8_t bits) {
+    _bitBuf |= value << _bitCount;
+    _bitCount += bits;
+    while (_bitCount >= 8) {
+        putByte(_bitBuf & 0xFF);
+        _bitBuf >>= 8;
+        _bitCount -= 8;
+    }
+}
+
+void GzipDeflater::alignBits() {
+    if (_bitCount > 0) {
+        putByte(_bitBuf & 0xFF);
+    }
+    _bitBuf = 0;
+    _bitCount = 0;
+}
+
+void GzipDeflater::putByte(uint8_t b) {
+    _out[_outLen++] = b;
+    if (_outLen == OUTPUT_SIZE) {
+        flushOutput();
+    }
+}
+
+void GzipDeflater::flushOutput() {
+    if (_outLen == 0 || _failed) {
+        _outLen = 0;
+        return;
+    }
+    if (!_sink(_out, _outLen)) {
+        fail("Sink rejected compressed output");
+    }
+    _outputBytes += _outLen;
+    _outLen = 0;
+}
+
+bool GzipDeflater::fail(const String& message) {
+    _errorMessage = message;
+    _failed = true;
+    return false;
+}
@@ -0,0 +1,105 @@
+/**
+ * SeaSense Logger - Streaming gzip Compressor for HTTP Responses
+ *
+ * Compresses a response chunk by chunk as the handler writes it, for
+ * clients that send "Accept-Encoding: gzip". The encoder is deliberately
+ * small: LZ77 over a 2 KB sliding buffer with a single-probe hash table,
+ * and one fixed-Huffman deflate block (RFC 1951 BTYPE=01), so there are
+ * no code tables to build or store. API JSON repeats the same keys every
+ * record, which this catches well.
+ *
+ * Memory: 2 KB window + 1 KB hash heads, heap-allocated in begin() and
+ * released in end(), plus a 256-byte output buffer in the object.
+ * (The ROM tdefl compressor needs ~300 KB of state, so it is not used.)
+ */
+
+#ifndef SEASENSE_GZIP_DEFLATER_H
+#define SEASENSE_GZIP_DEFLATER_H
+
+#include <Arduino.h>
+#include <functional>
+
+class GzipDeflater {
+public:
+    // Receives compressed bytes in order
+    typedef std::function<bool(const uint8_t* data, size_t len)> Sink;
+
+    static const size_t WINDOW_SIZE = 1024;     // history kept after each slide
+    static const size_t OUTPUT_SIZE = 256;
+
+    GzipDeflater();
+    ~GzipDeflater();
+
+    /**
+     * Allocate buffers and write the gzip header
+     * @return false if out of memory or the sink fails
+     */
+    bool begin(Sink sink);
+
+    /**
+     * Compress the next chunk of input
+     * @return false on sink failure
+     */
+    bool feed(const uint8_t* data, size_t len);
+
+    /**
+     * Compress what is left, write the gzip trailer and flush
+     * @return false on sink failure
+     */
+    bool finish();
+
+    /**
+     * Release buffers
+     */
+    void end();
+
+    bool isActive() const { return _window != nullptr; }
+    String getErrorMessage() const { return _errorMessage; }
+    uint32_t getInputBytes() const { return _inputBytes; }
+    uint32_t getOutputBytes() const { return _outputBytes + _outLen; }
+
+private:
+    static const size_t BUFFER_SIZE = 2 * WINDOW_SIZE;
+    static const uint8_t HASH_BITS = 9;
+    static const size_t HASH_SIZE = 1 << HASH_BITS;
+    static const uint16_t MIN_MATCH = 3;
+    static const uint16_t MAX_MATCH = 258;
+
+    Sink _sink;
+    String _errorMessage;
+    bool _failed;
+
+    // LZ77 state
+    uint8_t* _window;       // [BUFFER_SIZE], slides down by WINDOW_SIZE when full
+    uint16_t* _head;        // [HASH_SIZE], window index + 1 of the last position, 0 = none
+    size_t _fill;           // bytes in the window
+    size_t _pos;            // next window index to encode
+
+    // Bit and byte output
+    uint32_t _bitBuf;
+    uint8_t _bitCount;
+    uint8_t _out[OUTPUT_SIZE];
+    size_t _outLen;
+
+    // Totals (gzip trailer and metrics)
+    uint32_t _crc;
+    uint32_t _inputBytes;
+    uint32_t _outputBytes;
+
+    void compress(bool final);
+    void slide();
+    uint16_t hashAt(size_t i) const;
+    void insert(size_t i);
+
+    void putLiteral(uint8_t c);
+    void putMatch(uint16_t length, uint16_t distance);
+    void putSymbol(uint16_t sym);
+    void putCode(uint16_t code, uint8_t bits);
+    void putBits(uint32_t value, uint8_t bits);
+    void alignBits();
+    void putByte(uint8_t b);
+    void flushOutput();
+    bool fail(const String& message);
+};
+
+#endif // SEASENSE_GZIP_DEFLATER_H
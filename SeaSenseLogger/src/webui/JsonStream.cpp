@@ -0,0 +1,267 @@
+/**
+ * SeaSense Logger - Streaming JSON Writer Implementation
+ */
+
+#include "JsonStream.h"
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+
+// Significant digits, enough to round-trip what the sensors resolve
+static const int FLOAT_DIGITS = 7;
+static const int DOUBLE_DIGITS = 10;
+
+JsonStream::JsonStream(Sink sink)
+    : _sink(sink),
+      _len(0),
+      _written(0),
+      _depth(0),
+      _hasItems(0),
+      _overflow(false)
+{
+}
+
+// ============================================================================
+// Containers
+// ============================================================================
+
+void JsonStream::beginObject(const char* key) {
+    open(key, '{');
+}
+
+void JsonStream::endObject() {
+    close('}');
+}
+
+void JsonStream::beginArray(const char* key) {
+    open(key, '[');
+}
+
+void JsonStream::endArray() {
+    close(']');
+}
+
+void JsonStream::open(const char* k, char bracket) {
+    item(k);
+    writeChar(bracket);
+    if (_depth + 1 >= MAX_DEPTH) {
+        _overflow = true;
+        return;
+    }
+    _depth++;
+    _hasItems &= ~(1U << _depth);
+}
+
+void JsonStream::close(char bracket) {
+    writeChar(bracket);
+    if (_depth == 0) {
+        _overflow = true;
+        return;
+    }
+    _depth--;
+}
+
+// Comma before every item but the first at this depth, then the key
+void JsonStream::item(const char* k) {
+    uint16_t bit = 1U << _depth;
+    if (_hasItems & bit) {
+        writeChar(',');
+    }
+    _hasItems |= bit;
+    if (k) {
+        writeString(k, strlen(k));
+        writeChar(':');
+    }
+}
+
+// ============================================================================
+// Object members
+// ============================================================================
+
+void JsonStream::field(const char* key, const char* value) {
+    item(key);
+    if (value) {
+        writeString(value, strlen(value));
+    } else {
+        write("null", 4);
+    }
+}
+
+void JsonStream::field(const char* key, const String& value) {
+    item(key);
+    writeString(value.c_str(), value.length());
+}
+
+void JsonStream::field(const char* key, bool value) {
+    item(key);
+    if (value) {
+        write("true", 4);
+    } else {
+        write("false", 5);
+    }
+}
+
+void JsonStream::field(const char* key, int value) {
+    item(key);
+    writeSigned(value);
+}
+
+void JsonStream::field(const char* key, unsigned int value) {
+    item(key);
+    writeUnsigned(value);
+}
+
+void JsonStream::field(const char* key, long value) {
+    item(key);
+    writeSigned(value);
+}
+
+void JsonStream::field(const char* key, unsigned long value) {
+    item(key);
+    writeUnsigned(value);
+}
+
+void JsonStream::field(const char* key, long long value) {
+    item(key);
+    writeSigned(value);
+}
+
+void JsonStream::field(const char* key, unsigned long long value) {
+    item(key);
+    writeUnsigned(value);
+}
+
+void JsonStream::field(const char* key, float value) {
+    item(key);
+    writeFloat(value, FLOAT_DIGITS, false);
+}
+
+void JsonStream::field(const char* key, double value) {
+    item(key);
+    writeFloat(value, DOUBLE_DIGITS, false);
+}
+
+void JsonStream::field(const char* key, double value, uint8_t decimals) {
+    item(key);
+    writeFloat(value, decimals, true);
+}
+
+void JsonStream::fieldNull(const char* key) {
+    item(key);
+    write("null", 4);
+}
+
+// ============================================================================
+// Array elements
+// ============================================================================
+
+void JsonStream::value(const char* v)          { field(nullptr, v); }
+void JsonStream::value(const String& v)        { field(nullptr, v); }
+void JsonStream::value(bool v)                 { field(nullptr, v); }
+void JsonStream::value(int v)                  { field(nullptr, v); }
+void JsonStream::value(unsigned int v)         { field(nullptr, v); }
+void JsonStream::value(long v)                 { field(nullptr, v); }
+void JsonStream::value(unsigned long v)        { field(nullptr, v); }
+void JsonStream::value(long long v)            { field(nullptr, v); }
+void JsonStream::value(unsigned long long v)   { field(nullptr, v); }
+void JsonStream::value(float v)                { field(nullptr, v); }
+void JsonStream::value(double v)               { field(nullptr, v); }
+void JsonStream::value(double v, uint8_t decimals) { field(nullptr, v, decimals); }
+void JsonStream::valueNull()                   { fieldNull(nullptr); }
+
+bool JsonStream::end() {
+    flush(true);
+    return !_overflow && _depth == 0;
+}
+
+// ============================================================================
+// Output
+// ============================================================================
+
+void JsonStream::writeChar(char c) {
+    if (_len == BUFFER_SIZE) {
+        flush(false);
+    }
+    _buf[_len++] = c;
+}
+
+void JsonStream::write(const char* data, size_t len) {
+    while (len > 0) {
+        if (_len == BUFFER_SIZE) {
+            flush(false);
+        }
+        size_t n = BUFFER_SIZE - _len;
+        if (n > len) n = len;
+        memcpy(_buf + _len, data, n);
+        _len += n;
+        data += n;
+        len -= n;
+    }
+}
+
+void JsonStream::writeString(const char* s, size_t len) {
+    static const char HEX_DIGITS[] = "0123456789abcdef";
+    writeChar('"');
+    for (size_t i = 0; i < len; i++) {
+        char c = s[i];
+        switch (c) {
+            case '"':  write("\\\"", 2); break;
+            case '\\': write("\\\\", 2); break;
+            case '\n': write("\\n", 2); break;
+            case '\r': write("\\r", 2); break;
+            case '\t': write("\\t", 2); break;
+            default:
+                if ((unsigned char)c < 0x20) {
+                    char esc[6] = {'\\', 'u', '0', '0',
+                                   HEX_DIGITS[(c >> 4) & 0x0F], HEX_DIGITS[c & 0x0F]};
+                    write(esc, sizeof(esc));
+                } else {
+                    writeChar(c);   // UTF-8 passes through
+                }
+                break;
+        }
+    }
+    writeChar('"');
+}
+
+void JsonStream::writeSigned(long long v) {
+    if (v < 0) {
+        writeChar('-');
+        writeUnsigned(0ULL - (unsigned long long)v);
+    } else {
+        writeUnsigned((unsigned long long)v);
+    }
+}
+
+void JsonStream::writeUnsigned(unsigned long long v) {
+    char digits[20];
+    size_t n = 0;
+    do {
+        digits[sizeof(digits) - 1 - n++] = '0' + (v % 10);
+        v /= 10;
+    } while (v > 0);
+    write(digits + sizeof(digits) - n, n);
+}
+
+void JsonStream::writeFloat(double v, int precision, bool fixed) {
+    if (isnan(v) || isinf(v)) {
+        write("null", 4);
+        return;
+    }
+    char tmp[48];
+    int n = snprintf(tmp, sizeof(tmp), fixed ? "%.*f" : "%.*g", precision, v);
+    if (n < 0) {
+        write("null", 4);
+        return;
+    }
+    write(tmp, (size_t)n < sizeof(tmp) ? (size_t)n : sizeof(tmp) - 1);
+}
+
+void JsonStream::flush(bool last) {
+    if (_len == 0 && !last) {
+        return;
+    }
+    _sink(_buf, _len, last);
+    _written += _len;
+    _len = 0;
+}
@@ -0,0 +1,104 @@
+/**
+ * SeaSense Logger - Streaming JSON Writer
+ *
+ * Writes a JSON response straight into a fixed buffer and hands it to a
+ * sink (the chunked HTTP response) each time it fills, so a response of
+ * any size costs BUFFER_SIZE bytes instead of a JsonDocument plus the
+ * serialised String plus the WebServer's copy of it.
+ *
+ * Commas are inserted automatically; keys and string values are escaped.
+ * Floating point NaN/Inf is written as null.
+ *
+ *   JsonStream json(sink);
+ *   json.beginObject();
+ *   json.field("uptime_ms", millis());
+ *   json.beginObject("wifi");
+ *   json.field("ap_ssid", ssid);
+ *   json.endObject();
+ *   json.endObject();
+ *   json.end();
+ */
+
+#ifndef SEASENSE_JSON_STREAM_H
+#define SEASENSE_JSON_STREAM_H
+
+#include <Arduino.h>
+#include <functional>
+
+class JsonStream {
+public:
+    // Receives output in order; last is set on the final call (from end()),
+    // so output that fits in one buffer arrives as one last call
+    typedef std::function<void(const char* data, size_t len, bool last)> Sink;
+
+    static const size_t BUFFER_SIZE = 256;
+    static const uint8_t MAX_DEPTH = 16;
+
+    explicit JsonStream(Sink sink);
+
+    // Containers; pass a key inside an object, none inside an array or at the top
+    void beginObject(const char* key = nullptr);
+    void endObject();
+    void beginArray(const char* key = nullptr);
+    void endArray();
+
+    // Object members
+    void field(const char* key, const char* value);
+    void field(const char* key, const String& value);
+    void field(const char* key, bool value);
+    void field(const char* key, int value);
+    void field(const char* key, unsigned int value);
+    void field(const char* key, long value);
+    void field(const char* key, unsigned long value);
+    void field(const char* key, long long value);
+    void field(const char* key, unsigned long long value);
+    void field(const char* key, float value);
+    void field(const char* key, double value);
+    void field(const char* key, double value, uint8_t decimals);
+    void fieldNull(const char* key);
+
+    // Array elements
+    void value(const char* v);
+    void value(const String& v);
+    void value(bool v);
+    void value(int v);
+    void value(unsigned int v);
+    void value(long v);
+    void value(unsigned long v);
+    void value(long long v);
+    void value(unsigned long long v);
+    void value(float v);
+    void value(double v);
+    void value(double v, uint8_t decimals);
+    void valueNull();
+
+    /**
+     * Flush what is buffered and end the stream
+     * @return false if containers were left open or nested too deep
+     */
+    bool end();
+
+    size_t getBytesWritten() const { return _written + _len; }
+
+private:
+    Sink _sink;
+    char _buf[BUFFER_SIZE];
+    size_t _len;
+    size_t _written;            // bytes already passed to the sink
+    uint8_t _depth;
+    uint16_t _hasItems;         // bit per depth: a comma goes before the next item
+    bool _overflow;
+
+    void item(const char* k);
+    void open(const char* k, char bracket);
+    void close(char bracket);
+    void writeChar(char c);
+    void write(const char* data, size_t len);
+    void writeString(const char* s, size_t len);
+    void writeSigned(long long v);
+    void writeUnsigned(unsigned long long v);
+    void writeFloat(double v, int precision, bool fixed);
+    void flush(bool last);
+};
+
+#endif // SEASENSE_JSON_STREAM_H
@@ -7,13 +7,28 @@
 #include "../sensors/EZO_EC.h"
 #include "../sensors/EZO_pH.h"
 #include "../sensors/EZO_DO.h"
+#include "../sensors/CompensationManager.h"
+#include "../sensors/WaterSensors.h"
+#include "../sensors/ReadCoalescer.h"
+#include "../sensors/QualityControl.h"
+#include "../sensors/DerivedVariables.h"
 #include "../config/ConfigManager.h"
 #include "../../config/hardware_config.h"
 #include "../../config/secrets.h"
 #include "../system/SystemHealth.h"
+#include "../system/PowerManager.h"
+#include "../system/RecoveryManager.h"
+#include "../system/TimeService.h"
+#include "../system/EventLog.h"
+#include "../system/FlightRecorder.h"
 #include "../sensors/GPSModule.h"
 #include "../sensors/NMEA2000GPS.h"
+#include "../n2k/N2kWaterQualityEmitter.h"
+#include "../broadcast/UdpBroadcaster.h"
+#include "../replay/CaptureRecorder.h"
 #include "../api/APIUploader.h"
+#include "../storage/RecordSchema.h"
+#include "ChangeFeed.h"
 #include "../sensors/NMEA2000Environment.h"
 #include "../sensors/BNO085Module.h"
 #include <ArduinoJson.h>
@@ -35,8 +50,16 @@ SeaSenseWebServer::SeaSenseWebServer(EZO_RTD* tempSensor, EZO_EC* ecSensor, Stor
       _apIP(192, 168, 4, 1),
       _stationConnected(false),
       _lastReconnectAttempt(0),
+      _wifiRecoveryRequest(WIFI_RECOVERY_NONE),
+      _stationEnabled(true),
+      _stationConfigured(false),
       _server(nullptr),
-      _dnsServer(nullptr)
+      _dnsServer(nullptr),
+      _responseStatus(200),
+      _responseStarted(false),
+      _responseSendUs(0),
+      _responseCpuUs(0),
+      _httpStats()
 {
 }
 
@@ -73,11 +96,15 @@ bool SeaSenseWebServer::begin() {
     _server->on("/calibrate", std::bind(&SeaSenseWebServer::handleCalibrate, this));
     _server->on("/data", std::bind(&SeaSenseWebServer::handleData, this));
     _server->on("/settings", std::bind(&SeaSenseWebServer::handleSettings, this));
+    _server->on("/sync.js", std::bind(&SeaSenseWebServer::handleSyncScript, this));
+    _server->on("/sw.js", std::bind(&SeaSenseWebServer::handleServiceWorker, this));
+    _server->on("/manifest.webmanifest", std::bind(&SeaSenseWebServer::handleManifest, this));
 
     // Register API handlers
     _server->on("/api/sensors", std::bind(&SeaSenseWebServer::handleApiSensors, this));
     _server->on("/api/sensor/reading", std::bind(&SeaSenseWebServer::handleApiSensorReading, this));
     _server->on("/api/sensor/read", std::bind(&SeaSenseWebServer::handleApiSensorRead, this));
+    _server->on("/api/sensors/live", std::bind(&SeaSenseWebServer::handleApiSensorsLive, this));
     _server->on("/api/calibrate", std::bind(&SeaSenseWebServer::handleApiCalibrate, this));
     _server->on("/api/calibrate/status", std::bind(&SeaSenseWebServer::handleApiCalibrateStatus, this));
     _server->on("/api/calibration/info", std::bind(&SeaSenseWebServer::handleApiCalibrationInfo, this));
@@ -86,12 +113,15 @@ bool SeaSenseWebServer::begin() {
     _server->on("/api/data/download", std::bind(&SeaSenseWebServer::handleApiDataDownload, this));
     _server->on("/api/data/clear", std::bind(&SeaSenseWebServer::handleApiDataClear, this));
     _server->on("/api/data/records", std::bind(&SeaSenseWebServer::handleApiDataRecords, this));
+    _server->on("/api/data/changes", std::bind(&SeaSenseWebServer::handleApiDataChanges, this));
     _server->on("/api/upload/force", std::bind(&SeaSenseWebServer::handleApiUploadForce, this));
     _server->on("/api/upload/history", std::bind(&SeaSenseWebServer::handleApiUploadHistory, this));
     _server->on("/api/device/regenerate-guid", std::bind(&SeaSenseWebServer::handleApiDeviceRegenerateGuid, this));
     _server->on("/api/config", std::bind(&SeaSenseWebServer::handleApiConfig, this));
     _server->on("/api/config/update", std::bind(&SeaSenseWebServer::handleApiConfigUpdate, this));
     _server->on("/api/status", std::bind(&SeaSenseWebServer::handleApiStatus, this));
+    _server->on("/api/logs", std::bind(&SeaSenseWebServer::handleApiLogs, this));
+    _server->on("/api/logs/level", std::bind(&SeaSenseWebServer::handleApiLogsLevel, this));
     _server->on("/api/pump/status", std::bind(&SeaSenseWebServer::handleApiPumpStatus, this));
     _server->on("/api/pump/control", std::bind(&SeaSenseWebServer::handleApiPumpControl, this));
     _server->on("/api/pump/config", std::bind(&SeaSenseWebServer::handleApiPumpConfig, this));
@@ -103,6 +133,7 @@ bool SeaSenseWebServer::begin() {
     _server->on("/api/system/clear-safe-mode", std::bind(&SeaSenseWebServer::handleApiClearSafeMode, this));
     _server->on("/api/system/factory-reset", std::bind(&SeaSenseWebServer::handleApiFactoryReset, this));
 
+#if FEATURE_OTA
     // OTA endpoints
     _server->on("/api/ota/status", std::bind(&SeaSenseWebServer::handleApiOtaStatus, this));
     _server->on("/api/ota/check", std::bind(&SeaSenseWebServer::handleApiOtaCheck, this));
@@ -110,7 +141,12 @@ bool SeaSenseWebServer::begin() {
     _server->on("/api/ota/upload", HTTP_POST,
         // Response handler (called after upload completes)
         [this]() {
-            if (_otaManager.getState() == OTAManager::State::SUCCESS) {
+            bool wasActive = _otaUploadActive;
+            _otaUploadActive = false;
+            if (!_otaUploadError.isEmpty()) {
+                sendError(_otaUploadError, 409);
+                _otaUploadError = "";
+            } else if (wasActive && _otaManager.getState() == OTAManager::State::SUCCESS) {
                 sendJSON("{\"success\":true,\"message\":\"Update complete, restarting...\"}");
                 delay(1000);
                 ESP.restart();
@@ -118,19 +154,33 @@ bool SeaSenseWebServer::begin() {
                 sendError(_otaManager.getErrorMessage(), 500);
             }
         },
-        // Upload handler (called for each chunk)
+        // Upload handler (called for each chunk). The manager is shared with
+        // the background installer, so nothing here touches it unless this
+        // upload is the one holding the update claim.
         [this]() {
             HTTPUpload& upload = _server->upload();
             if (upload.status == UPLOAD_FILE_START) {
+                _otaUploadError = "";
+                if (_otaUploadActive) {
+                    // Previous upload never reached END or ABORTED
+                    _otaManager.abort();
+                    _otaUploadActive = false;
+                }
                 // Check pump state — block OTA if pump is active
                 if (_pumpController) {
                     PumpState ps = _pumpController->getState();
                     if (ps == PumpState::FLUSHING || ps == PumpState::MEASURING) {
-                        _otaManager.abort();
+                        _otaUploadError = "Cannot update while pump is active";
                         return;
                     }
                 }
-                _otaManager.begin(upload.totalSize);
+                if (_otaManager.isBackgroundRunning() || OTAManager::isUpdateInProgress()) {
+                    _otaUploadError = "Another update is already in progress";
+                    return;
+                }
+                _otaUploadActive = _otaManager.begin(upload.totalSize);
+            } else if (!_otaUploadActive) {
+                return;
             } else if (upload.status == UPLOAD_FILE_WRITE) {
                 if (_otaManager.getState() == OTAManager::State::RECEIVING) {
                     _otaManager.writeChunk(upload.buf, upload.currentSize);
@@ -139,12 +189,18 @@ bool SeaSenseWebServer::begin() {
                 _otaManager.end();
             } else if (upload.status == UPLOAD_FILE_ABORTED) {
                 _otaManager.abort();
+                _otaUploadActive = false;
             }
         }
     );
+#endif
 
     _server->onNotFound(std::bind(&SeaSenseWebServer::handleNotFound, this));
 
+    // Request headers are dropped unless asked for; gzip is negotiated on this one
+    const char* headerKeys[] = {"Accept-Encoding"};
+    _server->collectHeaders(headerKeys, 1);
+
     _server->begin();
 
     Serial.println("[WIFI] Web server started");
@@ -162,6 +218,11 @@ bool SeaSenseWebServer::begin() {
 }
 
 void SeaSenseWebServer::handleClient() {
+    // A handler that returned after beginJSON() without end() left the
+    // compressor running; no request may inherit it
+    if (_gzip.isActive()) {
+        _gzip.end();
+    }
     if (_server) {
         _server->handleClient();
     }
@@ -220,8 +281,12 @@ bool SeaSenseWebServer::startAP() {
     DEBUG_WIFI_PRINT("AP IP: ");
     DEBUG_WIFI_PRINTLN(_apIP);
 
-    // Start DNS server for captive portal
-    _dnsServer = new DNSServer();
+    // Start DNS server for captive portal (reused when the radio is restarted)
+    if (_dnsServer) {
+        _dnsServer->stop();
+    } else {
+        _dnsServer = new DNSServer();
+    }
     _dnsServer->start(53, "*", _apIP);
 
     return true;
@@ -274,18 +339,39 @@ bool SeaSenseWebServer::startStation() {
 }
 
 void SeaSenseWebServer::checkWiFiReconnect() {
-    // Read credentials from ConfigManager, fall back to compile-time defaults
-    String ssid, password;
+    // Called every iteration of the web task: borrow the config snapshot
+    // instead of copying credentials. Fall back to compile-time defaults.
+    const char* ssid = WIFI_STATION_SSID;
+    const char* password = WIFI_STATION_PASSWORD;
+    ConfigManager::SnapshotPtr cfg;
     if (_configManager) {
-        ConfigManager::WiFiConfig wc = _configManager->getWiFiConfig();
-        ssid = wc.stationSSID;
-        password = wc.stationPassword;
+        cfg = _configManager->snapshot();
+        if (cfg->wifi.stationSSID.length() > 0) {
+            ssid = cfg->wifi.stationSSID.c_str();
+            password = cfg->wifi.stationPassword.c_str();
+        }
     }
-    if (ssid.length() == 0) {
-        ssid = WIFI_STATION_SSID;
-        password = WIFI_STATION_PASSWORD;
+    _stationConfigured = (ssid[0] != '\0');
+    if (!_stationConfigured) return;
+
+    uint8_t request = _wifiRecoveryRequest;
+    _wifiRecoveryRequest = WIFI_RECOVERY_NONE;
+    if (request == WIFI_RECOVERY_RESTART) {
+        Serial.println("[WIFI] Restarting radio (recovery)");
+        _stationConnected = false;
+        WiFi.mode(WIFI_OFF);
+        delay(100);
+        startAP();
+        WiFi.begin(ssid, password);
+        _lastReconnectAttempt = millis();
+        return;
+    }
+
+    // Paused by the recovery manager: leave the station alone, AP stays up
+    if (!_stationEnabled) {
+        _stationConnected = false;
+        return;
     }
-    if (ssid.length() == 0) return;
 
     // Already connected — update state if needed
     if (WiFi.status() == WL_CONNECTED) {
@@ -299,13 +385,14 @@ void SeaSenseWebServer::checkWiFiReconnect() {
 
     // Not connected — rate-limit reconnection attempts
     unsigned long now = millis();
-    if (now - _lastReconnectAttempt < WIFI_STATION_RECONNECT_INTERVAL_MS) return;
+    if (request != WIFI_RECOVERY_RESET &&
+        now - _lastReconnectAttempt < WIFI_STATION_RECONNECT_INTERVAL_MS) return;
     _lastReconnectAttempt = now;
 
     _stationConnected = false;
     Serial.println("[WIFI] Station disconnected, attempting reconnection...");
     WiFi.disconnect();
-    WiFi.begin(ssid.c_str(), password.c_str());
+    WiFi.begin(ssid, password);
     // Non-blocking on ESP32 AP+STA mode — status checked next iteration
 }
 
@@ -339,6 +426,7 @@ void SeaSenseWebServer::handleDashboard() {
     <meta charset="UTF-8">
     <title>Dashboard - Project SeaSense</title>
     <meta name="viewport" content="width=device-width, initial-scale=1">
+    <link rel="manifest" href="/manifest.webmanifest">
     <style>
         :root { --bg:#060a13; --sf:#0c1221; --cd:#111a2e; --bd:#1a2744; --b2:#243352; --ac:#22d3ee; --a2:#2dd4bf; --ag:rgba(34,211,238,0.12); --tx:#e2e8f0; --t2:#94a3b8; --t3:#475569; --ok:#34d399; --wn:#fbbf24; --er:#f87171 }
         * { margin:0; padding:0; box-sizing:border-box }
@@ -461,6 +549,7 @@ void SeaSenseWebServer::handleDashboard() {
         </div>
     </div>
 
+    <script src="/sync.js"></script>
     <script>
         (function(){fetch('/api/status').then(function(r){return r.json()}).then(function(d){if(d.system&&d.system.safe_mode){var b=document.createElement('div');b.style.cssText='position:fixed;top:0;left:0;right:0;z-index:9999;background:#7c2d12;color:#fed7aa;padding:12px 16px;font-size:13px;text-align:center;box-shadow:0 2px 8px rgba(0,0,0,0.3)';b.innerHTML='\u26a0\ufe0f SAFE MODE \u2014 Boot loop detected ('+d.system.consecutive_reboots+' consecutive reboots). Only WiFi and web interface are active. <button id="smClr" style="margin-left:8px;background:#ea580c;color:white;border:none;padding:4px 12px;border-radius:4px;cursor:pointer;font-size:12px">Clear Safe Mode &amp; Restart</button>';document.body.prepend(b);document.body.style.paddingTop=b.offsetHeight+'px';document.getElementById('smClr').onclick=function(){this.textContent='Restarting...';this.disabled=true;fetch('/api/system/clear-safe-mode',{method:'POST'})}}}).catch(function(){})})();
         let autoUpdate = true;
@@ -696,7 +785,10 @@ void SeaSenseWebServer::handleDashboard() {
                     document.getElementById('sensors').innerHTML = html;
                 })
                 .catch(err => {
-                    document.getElementById('sensors').innerHTML = '<div class="status-msg">Error loading sensors</div>';
+                    // Out of reach: keep the last cards and their sparklines
+                    if (Object.keys(lastGood).length === 0) {
+                        document.getElementById('sensors').innerHTML = '<div class="status-msg">Error loading sensors</div>';
+                    }
                 });
         }
 
@@ -771,23 +863,28 @@ void SeaSenseWebServer::handleDashboard() {
                 });
                 update();
             }).catch(() => { update(); });
-            fetch('/api/data/records?limit=200').then(r => r.json()).then(data => {
-                if (data.records) {
-                    for (let i = data.records.length - 1; i >= 0; i--) {
-                        const r = data.records[i];
-                        if (r.value === 0) continue;
-                        if (!sparkData[r.type]) sparkData[r.type] = [];
-                        let t = Date.now();
-                        if (r.time) { const d = new Date(r.time.endsWith('Z') ? r.time : r.time + 'Z').getTime(); if (isFinite(d)) t = d; }
-                        sparkData[r.type].push({v:r.value, t:t});
-                    }
-                    Object.keys(sparkData).forEach(k => {
-                        if (sparkData[k].length > SPARK_MAX) sparkData[k] = sparkData[k].slice(-SPARK_MAX);
-                    });
-                }
+            // Sparklines from the local copy first, again once new records are synced
+            loadSpark();
+            syncSpark();
+        }
+        function loadSpark() {
+            return SeaSync.recent(200).then(records => {
+                const fresh = {};
+                records.forEach(r => {
+                    if (r.value === 0) return;
+                    if (!fresh[r.type]) fresh[r.type] = [];
+                    let t = Date.now();
+                    if (r.time) { const d = new Date(r.time.endsWith('Z') ? r.time : r.time + 'Z').getTime(); if (isFinite(d)) t = d; }
+                    fresh[r.type].push({v:r.value, t:t});
+                });
+                Object.keys(fresh).forEach(k => { sparkData[k] = fresh[k].slice(-SPARK_MAX); });
             }).catch(() => {});
         }
+        function syncSpark() {
+            SeaSync.sync().then(res => { if (res.added > 0) loadSpark(); }).catch(() => {});
+        }
         loadLatest();
+        setInterval(syncSpark, 60000);
         updateEnv();
         updateMeasurement();
         updateUploadStatus();
@@ -810,6 +907,7 @@ void SeaSenseWebServer::handleCalibrate() {
     <meta charset="UTF-8">
     <title>Calibration - Project SeaSense</title>
     <meta name="viewport" content="width=device-width, initial-scale=1">
+    <link rel="manifest" href="/manifest.webmanifest">
     <style>
         :root { --bg:#060a13; --sf:#0c1221; --cd:#111a2e; --bd:#1a2744; --b2:#243352; --ac:#22d3ee; --a2:#2dd4bf; --ag:rgba(34,211,238,0.12); --tx:#e2e8f0; --t2:#94a3b8; --t3:#475569; --ok:#34d399; --wn:#fbbf24; --er:#f87171 }
         * { margin:0; padding:0; box-sizing:border-box }
@@ -1120,126 +1218,97 @@ void SeaSenseWebServer::handleCalibrate() {
             setTimeout(() => el.classList.remove('reading-pulse'), 800);
         }
 
-        function triggerRead(then) {
-            fetch('/api/sensor/read', { method: 'POST' })
-                .then(r => r.json())
-                .then(then)
-                .catch(() => {});
-        }
-
-        function readTemp() {
-            const el = document.getElementById('tempReading');
-            el.classList.add('reading-pulse');
-            triggerRead(() => {
-                fetch('/api/sensor/reading?type=temperature').then(r => r.json())
-                    .then(data => { el.textContent = data.value.toFixed(3); el.classList.remove('reading-pulse'); })
-                    .catch(() => { el.classList.remove('reading-pulse'); showToast('Error reading temperature sensor', 'error'); });
-            });
-        }
-
-        function readEC() {
-            const el = document.getElementById('ecReading');
-            el.classList.add('reading-pulse');
-            triggerRead(() => {
-                fetch('/api/sensor/reading?type=conductivity').then(r => r.json())
-                    .then(data => { el.textContent = data.value.toFixed(0).replace(/\B(?=(\d{3})+(?!\d))/g, ','); el.classList.remove('reading-pulse'); })
-                    .catch(() => { el.classList.remove('reading-pulse'); showToast('Error reading conductivity sensor', 'error'); });
-            });
-        }
-
-        function readPH() {
-            const el = document.getElementById('phReading');
-            el.classList.add('reading-pulse');
-            triggerRead(() => {
-                fetch('/api/sensor/reading?type=ph').then(r => r.json())
-                    .then(data => { el.textContent = data.value.toFixed(2); el.classList.remove('reading-pulse'); })
-                    .catch(() => { el.classList.remove('reading-pulse'); showToast('Error reading pH sensor', 'error'); });
-            });
+        const LIVE_CARDS = {
+            temperature: { el: 'tempReading', name: 'temperature', fmt: v => v.toFixed(3) },
+            conductivity: { el: 'ecReading', name: 'conductivity', fmt: v => v.toFixed(0).replace(/\B(?=(\d{3})+(?!\d))/g, ',') },
+            ph: { el: 'phReading', name: 'pH', fmt: v => v.toFixed(2) },
+            dissolved_oxygen: { el: 'doReading', name: 'DO', fmt: v => v.toFixed(2) }
+        };
+
+        // One request for all cards: the device shares a recent acquisition
+        // between cards and between clients instead of re-reading the bus
+        function readSensors(keys) {
+            const els = keys.map(k => document.getElementById(LIVE_CARDS[k].el));
+            els.forEach(el => el.classList.add('reading-pulse'));
+            fetch('/api/sensors/live').then(r => r.json())
+                .then(data => {
+                    keys.forEach((k, i) => {
+                        const s = data.sensors && data.sensors[k];
+                        els[i].classList.remove('reading-pulse');
+                        if (s && s.ok) {
+                            els[i].textContent = LIVE_CARDS[k].fmt(s.value);
+                        } else {
+                            showToast('Error reading ' + LIVE_CARDS[k].name + ' sensor', 'error');
+                        }
+                    });
+                })
+                .catch(() => {
+                    els.forEach(el => el.classList.remove('reading-pulse'));
+                    showToast('Error reading sensors', 'error');
+                });
         }
 
-        function readDO() {
-            const el = document.getElementById('doReading');
-            el.classList.add('reading-pulse');
-            triggerRead(() => {
-                fetch('/api/sensor/reading?type=dissolved_oxygen').then(r => r.json())
-                    .then(data => { el.textContent = data.value.toFixed(2); el.classList.remove('reading-pulse'); })
-                    .catch(() => { el.classList.remove('reading-pulse'); showToast('Error reading DO sensor', 'error'); });
-            });
-        }
+        function readTemp() { readSensors(['temperature']); }
+        function readEC() { readSensors(['conductivity']); }
+        function readPH() { readSensors(['ph']); }
+        function readDO() { readSensors(['dissolved_oxygen']); }
 
         updateReadings();
         setInterval(updateReadings, 3000);
 
-        // Poll calibration status — show progress on the button, toast only at start/end
-        let calPolling = false;
-        let calBtn = null;
-        let calBtnOrigText = '';
-
-        function pollCalibration(sensorLabel, readFn) {
-            if (calPolling) return;
-            calPolling = true;
-            setCalBtnsDisabled(true);
-            showToast('Calibration started', 'info');
-            const poll = setInterval(() => {
-                fetch('/api/calibrate/status')
+        // Each sensor calibrates independently (the device runs the sessions
+        // in parallel); a job polls its own session and owns its button
+        const calJobs = {};
+
+        function pollCalibration(sensor, sensorLabel, readFn) {
+            const job = calJobs[sensor];
+            showToast(sensorLabel + ' calibration started', 'info');
+            job.poll = setInterval(() => {
+                fetch('/api/calibrate/status?sensor=' + sensor)
                     .then(r => r.json())
                     .then(s => {
                         if (s.status === 'preparing') {
-                            setCalBtnText('Preparing...');
+                            job.btn.textContent = 'Preparing...';
                             return;
                         }
                         if (s.status === 'waiting_stable') {
                             const rd = s.currentReading ? ' (' + s.currentReading.toFixed(0) + ')' : '';
-                            setCalBtnText('Stabilizing...' + rd);
+                            job.btn.textContent = 'Stabilizing...' + rd;
                             return;
                         }
                         if (s.status === 'calibrating') {
-                            setCalBtnText('Calibrating...');
+                            job.btn.textContent = 'Calibrating...';
                             return;
                         }
-                        clearInterval(poll);
-                        calPolling = false;
-                        setCalBtnsDisabled(false);
-                        restoreCalBtn();
+                        finishCalJob(sensor);
                         if (s.status === 'complete') {
                             showToast(sensorLabel + ' calibration successful!', 'success');
                             if (readFn) setTimeout(readFn, 500);
                         } else {
-                            showToast('Calibration failed: ' + (s.message || 'Unknown error'), 'error');
+                            showToast(sensorLabel + ' calibration failed: ' + (s.message || 'Unknown error'), 'error');
                         }
                         setTimeout(loadCalInfo, 1000);
                     })
                     .catch(() => {
-                        clearInterval(poll);
-                        calPolling = false;
-                        setCalBtnsDisabled(false);
-                        restoreCalBtn();
-                        showToast('Lost connection during calibration', 'error');
+                        finishCalJob(sensor);
+                        showToast('Lost connection during ' + sensorLabel + ' calibration', 'error');
                     });
             }, 1000);
         }
 
-        function setCalBtnsDisabled(d) {
-            document.querySelectorAll('.btn-primary').forEach(b => {
-                b.disabled = d;
-                b.style.opacity = d ? '0.5' : '';
-            });
-            // Keep the active button visible
-            if (d && calBtn) calBtn.style.opacity = '1';
-        }
-
-        function setCalBtnText(txt) {
-            if (calBtn) calBtn.textContent = txt;
-        }
-
-        function restoreCalBtn() {
-            if (calBtn) { calBtn.textContent = calBtnOrigText; calBtn = null; }
+        function finishCalJob(sensor) {
+            const job = calJobs[sensor];
+            if (!job) return;
+            if (job.poll) clearInterval(job.poll);
+            job.btn.textContent = job.text;
+            job.btn.disabled = false;
+            delete calJobs[sensor];
         }
 
         function startCalibration(data, sensorLabel, readFn, btnEl) {
-            if (calPolling) { showToast('Calibration already in progress', 'error'); return; }
-            calBtn = btnEl;
-            calBtnOrigText = btnEl.textContent;
+            if (calJobs[data.sensor]) { showToast(sensorLabel + ' calibration already in progress', 'error'); return; }
+            calJobs[data.sensor] = { btn: btnEl, text: btnEl.textContent, poll: null };
+            btnEl.disabled = true;
             fetch('/api/calibrate', {
                 method: 'POST',
                 headers: {'Content-Type': 'application/json'},
@@ -1248,13 +1317,13 @@ void SeaSenseWebServer::handleCalibrate() {
             .then(r => r.json())
             .then(result => {
                 if (result.success) {
-                    pollCalibration(sensorLabel, readFn);
+                    pollCalibration(data.sensor, sensorLabel, readFn);
                 } else {
-                    restoreCalBtn();
+                    finishCalJob(data.sensor);
                     showToast('Calibration failed: ' + (result.error || 'Unknown error'), 'error');
                 }
             })
-            .catch(err => { restoreCalBtn(); showToast('Error starting calibration', 'error'); });
+            .catch(err => { finishCalJob(data.sensor); showToast('Error starting calibration', 'error'); });
         }
 
         function calibrateTemp(btn) {
@@ -1350,8 +1419,7 @@ void SeaSenseWebServer::handleCalibrate() {
         }
 
         // Initial read
-        readTemp();
-        readEC();
+        readSensors(['temperature', 'conductivity']);
         loadCalInfo();
     </script>
 </body>
@@ -1369,6 +1437,7 @@ void SeaSenseWebServer::handleData() {
     <meta charset="UTF-8">
     <title>Data - Project SeaSense</title>
     <meta name="viewport" content="width=device-width, initial-scale=1">
+    <link rel="manifest" href="/manifest.webmanifest">
     <style>
         :root { --bg:#060a13; --sf:#0c1221; --cd:#111a2e; --bd:#1a2744; --b2:#243352; --ac:#22d3ee; --a2:#2dd4bf; --ag:rgba(34,211,238,0.12); --tx:#e2e8f0; --t2:#94a3b8; --t3:#475569; --ok:#34d399; --wn:#fbbf24; --er:#f87171 }
         * { margin:0; padding:0; box-sizing:border-box }
@@ -1461,6 +1530,7 @@ void SeaSenseWebServer::handleData() {
                 <div class="stat"><div class="stat-label">Records</div><div class="stat-value" id="statRecords">--</div><div class="stat-sub" id="statPending">-- pending upload</div></div>
                 <div class="stat"><div class="stat-label">SPIFFS Used</div><div class="stat-value" style="font-size:14px;padding-top:4px;" id="statSpiffs">--</div><div class="progress-bar"><div class="progress-fill" id="spiffsBar" style="width:0%"></div></div></div>
                 <div class="stat"><div class="stat-label">SD Card</div><div class="stat-value" style="font-size:14px;padding-top:4px;" id="statSD">--</div><div class="progress-bar"><div class="progress-fill" id="sdBar" style="width:0%"></div></div></div>
+                <div class="stat"><div class="stat-label">Offline Copy</div><div class="stat-value" id="statLocal">--</div><div class="stat-sub" id="statSynced">not synced</div></div>
             </div>
         </div>
 
@@ -1516,6 +1586,7 @@ void SeaSenseWebServer::handleData() {
         </div>
     </div>
 
+    <script src="/sync.js"></script>
     <script>
         (function(){fetch('/api/status').then(function(r){return r.json()}).then(function(d){if(d.system&&d.system.safe_mode){var b=document.createElement('div');b.style.cssText='position:fixed;top:0;left:0;right:0;z-index:9999;background:#7c2d12;color:#fed7aa;padding:12px 16px;font-size:13px;text-align:center;box-shadow:0 2px 8px rgba(0,0,0,0.3)';b.innerHTML='\u26a0\ufe0f SAFE MODE \u2014 Boot loop detected ('+d.system.consecutive_reboots+' consecutive reboots). Only WiFi and web interface are active. <button id="smClr" style="margin-left:8px;background:#ea580c;color:white;border:none;padding:4px 12px;border-radius:4px;cursor:pointer;font-size:12px">Clear Safe Mode &amp; Restart</button>';document.body.prepend(b);document.body.style.paddingTop=b.offsetHeight+'px';document.getElementById('smClr').onclick=function(){this.textContent='Restarting...';this.disabled=true;fetch('/api/system/clear-safe-mode',{method:'POST'})}}}).catch(function(){})})();
         let currentPage = 0;
@@ -1662,6 +1733,24 @@ void SeaSenseWebServer::handleData() {
                 .catch(() => { document.getElementById('historyBody').innerHTML = '<tr><td colspan="5" class="empty-row">Error loading history</td></tr>'; });
         }
 
+        function recordRow(r) {
+            const tc = typeClass(r.type);
+            let timeStr;
+            if (r.time) {
+                timeStr = fmtUTC(r.time);
+            } else if (uptimeMs > 0 && r.millis > 0 && r.millis <= uptimeMs) {
+                timeStr = fmtAgo(uptimeMs - r.millis);
+            } else {
+                timeStr = '--';
+            }
+            return '<tr><td style="font-size:11px;color:#94a3b8;">' + timeStr + '</td>'
+                + '<td class="' + tc + '">' + r.type + '</td>'
+                + '<td>' + fmtValue(r.value, r.type) + ' <span style="color:#475569;font-size:11px;">' + r.unit + '</span></td>'
+                + '<td style="font-size:11px;color:#94a3b8;">' + (r.quality||'--')
+                + (r.qc_flag >= 3 ? ' <span style="color:' + (r.qc_flag == 4 ? '#ef4444' : '#f59e0b') + ';" title="QC per test: gross range, climatology, spike, rate of change, flat line, multi-variate">QC ' + r.qc_flags + '</span>' : '')
+                + '</td></tr>';
+        }
+
         function loadRecords() {
             const tbody = document.getElementById('recordsBody');
             tbody.innerHTML = '<tr><td colspan="4" class="empty-row">Loading...</td></tr>';
@@ -1673,21 +1762,7 @@ void SeaSenseWebServer::handleData() {
                     if (!d.records || d.records.length === 0) {
                         tbody.innerHTML = '<tr><td colspan="4" class="empty-row">No records stored yet</td></tr>';
                     } else {
-                        tbody.innerHTML = d.records.map(r => {
-                            const tc = typeClass(r.type);
-                            let timeStr;
-                            if (r.time) {
-                                timeStr = fmtUTC(r.time);
-                            } else if (uptimeMs > 0 && r.millis > 0 && r.millis <= uptimeMs) {
-                                timeStr = fmtAgo(uptimeMs - r.millis);
-                            } else {
-                                timeStr = '--';
-                            }
-                            return '<tr><td style="font-size:11px;color:#94a3b8;">' + timeStr + '</td>'
-                                + '<td class="' + tc + '">' + r.type + '</td>'
-                                + '<td>' + fmtValue(r.value, r.type) + ' <span style="color:#475569;font-size:11px;">' + r.unit + '</span></td>'
-                                + '<td style="font-size:11px;color:#94a3b8;">' + (r.quality||'--') + '</td></tr>';
-                        }).join('');
+                        tbody.innerHTML = d.records.map(recordRow).join('');
                     }
                     const maxPage = Math.floor((d.total - 1) / PAGE_SIZE);
                     document.getElementById('pageInfo').textContent = 'Page ' + (currentPage + 1) + ' of ' + (maxPage + 1);
@@ -1697,10 +1772,30 @@ void SeaSenseWebServer::handleData() {
                 .catch(e => {
                     clearTimeout(timer);
                     const msg = e.name === 'AbortError' ? 'Request timed out — SPIFFS may be busy' : 'Error loading records';
-                    tbody.innerHTML = '<tr><td colspan="4" class="empty-row">' + msg + '</td></tr>';
+                    if (currentPage !== 0) {
+                        tbody.innerHTML = '<tr><td colspan="4" class="empty-row">' + msg + '</td></tr>';
+                        return;
+                    }
+                    // Newest page from the offline copy
+                    SeaSync.recent(PAGE_SIZE).then(recs => {
+                        if (recs.length === 0) {
+                            tbody.innerHTML = '<tr><td colspan="4" class="empty-row">' + msg + '</td></tr>';
+                            return;
+                        }
+                        tbody.innerHTML = recs.reverse().map(recordRow).join('');
+                        document.getElementById('pageInfo').textContent = 'Offline copy';
+                    }).catch(() => { tbody.innerHTML = '<tr><td colspan="4" class="empty-row">' + msg + '</td></tr>'; });
                 });
         }
 
+        function syncLocal() {
+            const show = () => SeaSync.status().then(st => {
+                document.getElementById('statLocal').textContent = st.count;
+                document.getElementById('statSynced').textContent = st.synced ? 'synced ' + fmtAgo(Date.now() - st.synced) : 'not synced';
+            }).catch(() => {});
+            SeaSync.sync().then(show, show);
+        }
+
         function changePage(dir) {
             currentPage = Math.max(0, currentPage - dir);  // page 0 = most recent
             loadRecords();
@@ -1749,7 +1844,7 @@ void SeaSenseWebServer::handleData() {
                     hideFlushConfirm();
                     showToast('All data flushed successfully', 'success');
                     currentPage = 0;
-                    setTimeout(() => { loadStats(); loadRecords(); }, 500);
+                    setTimeout(() => { loadStats(); loadRecords(); syncLocal(); }, 500);
                 })
                 .catch(() => { showToast('Flush failed', 'error'); });
         }
@@ -1757,8 +1852,10 @@ void SeaSenseWebServer::handleData() {
         loadStats();
         loadHistory();
         loadRecords();
+        syncLocal();
         setInterval(loadStats, 15000);
         setInterval(loadHistory, 15000);
+        setInterval(syncLocal, 30000);
         setInterval(tickUpNext, 1000);
         setInterval(function() { if (currentPage === 0) loadRecords(); }, 30000);
     </script>
@@ -1776,6 +1873,7 @@ void SeaSenseWebServer::handleSettings() {
     <meta charset="UTF-8">
     <title>Settings - Project SeaSense</title>
     <meta name="viewport" content="width=device-width, initial-scale=1">
+    <link rel="manifest" href="/manifest.webmanifest">
     <style>
         :root { --bg:#060a13; --sf:#0c1221; --cd:#111a2e; --bd:#1a2744; --b2:#243352; --ac:#22d3ee; --a2:#2dd4bf; --ag:rgba(34,211,238,0.12); --tx:#e2e8f0; --t2:#94a3b8; --t3:#475569; --ok:#34d399; --wn:#fbbf24; --er:#f87171 }
         * { margin:0; padding:0; box-sizing:border-box }
@@ -2006,7 +2104,7 @@ void SeaSenseWebServer::handleSettings() {
 
             <h3>Manual Upload</h3>
             <div style="margin:10px 0;">
-                <input type="file" id="ota-file" accept=".bin" style="font-size:13px;color:var(--t2);">
+                <input type="file" id="ota-file" accept=".bin,.gz,.patch" style="font-size:13px;color:var(--t2);">
                 <button type="button" class="btn btn-sm" id="ota-upload-btn" onclick="otaConfirmUpload()" style="margin-left:8px;">Upload &amp; Flash</button>
             </div>
         </div>
@@ -2311,6 +2409,7 @@ void SeaSenseWebServer::handleSettings() {
 
         // === OTA Functions ===
         let _otaUpdateUrl = '';
+        let _otaFallbackUrl = '';
         let _otaPendingAction = null; // 'install' or 'upload'
         let _otaPollTimer = null;
 
@@ -2342,6 +2441,7 @@ void SeaSenseWebServer::handleSettings() {
                     if (curEl) curEl.textContent = d.currentVersion || '—';
                     document.getElementById('ota-update-available').style.display = 'block';
                     _otaUpdateUrl = d.url;
+                    _otaFallbackUrl = d.fallbackUrl || '';
                     result.style.color = 'var(--ac)';
                     result.textContent = 'New version found!';
                 } else {
@@ -2390,7 +2490,7 @@ void SeaSenseWebServer::handleSettings() {
             const fileInput = document.getElementById('ota-file');
             if (!fileInput.files.length) { showToast('Select a .bin file first', 'error'); return; }
             const file = fileInput.files[0];
-            if (!file.name.endsWith('.bin')) { showToast('File must be a .bin firmware file', 'error'); return; }
+            if (!/\.(bin|bin\.gz|patch|patch\.gz)$/.test(file.name)) { showToast('File must be a .bin, .bin.gz or .patch firmware file', 'error'); return; }
             _otaPendingAction = 'upload';
             document.getElementById('ota-confirm-title').textContent = 'Upload and flash firmware?';
             document.getElementById('ota-confirm-detail').textContent = file.name + ' (' + (file.size/1024).toFixed(0) + ' KB) — the device will restart after flashing.';
@@ -2409,7 +2509,7 @@ void SeaSenseWebServer::handleSettings() {
                 try {
                     const d = await fetch('/api/ota/status').then(r => r.json());
                     if (d.state === 'receiving') {
-                        otaSetStep('Flashing firmware...', 'Do not power off the device');
+                        otaSetStep('Flashing firmware...', otaTransferDetail(d));
                         otaSetProgress(d.progress);
                     } else if (d.state === 'success') {
                         clearInterval(_otaPollTimer);
@@ -2426,6 +2526,15 @@ void SeaSenseWebServer::handleSettings() {
             }, 500);
         }
 
+        function otaTransferDetail(d) {
+            if (!d.transferSize) return 'Do not power off the device';
+            let t = (d.bytesReceived/1024).toFixed(0) + ' / ' + (d.transferSize/1024).toFixed(0) + ' KB';
+            if (d.format && d.format !== 'unknown' && d.format !== 'bin') t += ' (' + d.format + ')';
+            t += ' \u00b7 ' + (d.throughputBps/1024).toFixed(1) + ' KB/s';
+            if (d.resumes) t += ' \u00b7 resumed ' + d.resumes + '\u00d7';
+            return t;
+        }
+
         function otaShowDone() {
             otaShowModal('done');
             let sec = 15;
@@ -2451,7 +2560,7 @@ void SeaSenseWebServer::handleSettings() {
                 const resp = await fetch('/api/ota/install', {
                     method:'POST',
                     headers:{'Content-Type':'application/json'},
-                    body: JSON.stringify({url: _otaUpdateUrl})
+                    body: JSON.stringify({url: _otaUpdateUrl, fallbackUrl: _otaFallbackUrl})
                 });
                 // If we get a response, the device hasn't restarted yet — poll for status
                 if (resp.ok) {
@@ -2523,6 +2632,152 @@ void SeaSenseWebServer::handleSettings() {
     _server->send_P(200, "text/html", PAGE);
 }
 
+// ============================================================================
+// Offline Web App
+// ============================================================================
+
+void SeaSenseWebServer::handleSyncScript() {
+    // Local copy of the stored records for the dashboard and data pages:
+    // each sync asks /api/data/changes only for what was logged since the
+    // last one, and pages draw from IndexedDB when the device is out of reach
+    static const char SCRIPT[] PROGMEM = R"JS(
+const SeaSync = (() => {
+    const KEEP = 2000;      // newest records kept in the browser
+    const PAGES = 25;       // most change-feed requests per sync
+    let dbP = null, running = null;
+    const mem = { meta: { stream: 0, next: 0, synced: 0 }, recs: [] };  // no IndexedDB (private mode)
+
+    function req(r) { return new Promise((res, rej) => { r.onsuccess = () => res(r.result); r.onerror = () => rej(r.error); }); }
+    function open() {
+        if (!dbP) dbP = new Promise(res => {
+            if (!window.indexedDB) { res(null); return; }
+            const r = indexedDB.open('seasense', 1);
+            r.onupgradeneeded = () => { r.result.createObjectStore('records', { keyPath: 'seq' }); r.result.createObjectStore('meta'); };
+            r.onsuccess = () => res(r.result);
+            r.onerror = () => res(null);
+        });
+        return dbP;
+    }
+    function getMeta(db) {
+        if (!db) return Promise.resolve(mem.meta);
+        return req(db.transaction('meta').objectStore('meta').get('cursor')).then(m => m || { stream: 0, next: 0, synced: 0 });
+    }
+    function save(db, page, meta) {
+        const recs = page.records.map((r, i) => Object.assign({ seq: page.from + i }, r));
+        const floor = meta.next - KEEP;
+        if (!db) {
+            if (page.reset) mem.recs = [];
+            mem.recs = mem.recs.concat(recs).filter(r => r.seq >= floor);
+            mem.meta = meta;
+            return Promise.resolve();
+        }
+        return new Promise((res, rej) => {
+            const tx = db.transaction(['records', 'meta'], 'readwrite');
+            const st = tx.objectStore('records');
+            if (page.reset) st.clear();
+            recs.forEach(r => st.put(r));
+            if (floor > 0) st.delete(IDBKeyRange.upperBound(floor, true));
+            tx.objectStore('meta').put(meta, 'cursor');
+            tx.oncomplete = () => res();
+            tx.onerror = tx.onabort = () => rej(tx.error);
+        });
+    }
+    function pull(db, meta, result, pages) {
+        return fetch('/api/data/changes?since=' + meta.next + '&stream=' + meta.stream + '&tail=' + KEEP)
+            .then(r => { if (!r.ok) throw new Error('HTTP ' + r.status); return r.json(); })
+            .then(page => {
+                const next = { stream: page.stream, next: page.next, synced: Date.now() };
+                return save(db, page, next).then(() => {
+                    result.added += page.records.length;
+                    result.reset = result.reset || page.reset;
+                    result.total = page.total;
+                    if (page.more && pages + 1 < PAGES) return pull(db, next, result, pages + 1);
+                    return result;
+                });
+            });
+    }
+
+    // Fetch new records; rejects while the device is unreachable
+    function sync() {
+        if (!running) {
+            running = open()
+                .then(db => getMeta(db).then(m => pull(db, m, { added: 0, reset: false, total: 0 }, 0)))
+                .finally(() => { running = null; });
+        }
+        return running;
+    }
+    // The newest n local records, oldest first
+    function recent(n) {
+        return open().then(db => {
+            if (!db) return mem.recs.slice(-n);
+            return new Promise(res => {
+                const out = [];
+                const r = db.transaction('records').objectStore('records').openCursor(null, 'prev');
+                r.onsuccess = () => { const c = r.result; if (c && out.length < n) { out.push(c.value); c.continue(); } else res(out.reverse()); };
+                r.onerror = () => res(out.reverse());
+            });
+        });
+    }
+    // { count, synced }: local records and when they were last synced
+    function status() {
+        return open().then(db => getMeta(db).then(m => {
+            if (!db) return { count: mem.recs.length, synced: m.synced };
+            return req(db.transaction('records').objectStore('records').count()).then(c => ({ count: c, synced: m.synced }));
+        }));
+    }
+
+    // Browsers only run service workers over HTTPS or on localhost; on the
+    // plain-HTTP AP address the page shell is not cached, the records still are
+    if ('serviceWorker' in navigator && window.isSecureContext) navigator.serviceWorker.register('/sw.js').catch(() => {});
+
+    return { sync: sync, recent: recent, status: status };
+})();
+)JS";
+    _server->sendHeader("Cache-Control", "no-cache");
+    _server->send_P(200, "application/javascript", SCRIPT);
+}
+
+void SeaSenseWebServer::handleServiceWorker() {
+    // Page shell cache: network first so pages from new firmware win, the
+    // cached copy when the device is out of reach. API calls pass through
+    static const char SCRIPT[] PROGMEM = R"JS(
+const CACHE = 'seasense-shell-v1';
+const SHELL = ['/dashboard', '/data', '/calibrate', '/settings', '/sync.js', '/manifest.webmanifest'];
+self.addEventListener('install', e => {
+    e.waitUntil(caches.open(CACHE).then(c => c.addAll(SHELL)).then(() => self.skipWaiting()));
+});
+self.addEventListener('activate', e => {
+    e.waitUntil(caches.keys()
+        .then(keys => Promise.all(keys.filter(k => k !== CACHE).map(k => caches.delete(k))))
+        .then(() => self.clients.claim()));
+});
+self.addEventListener('fetch', e => {
+    const url = new URL(e.request.url);
+    if (e.request.method !== 'GET' || url.origin !== location.origin || url.pathname.startsWith('/api/')) return;
+    e.respondWith(fetch(e.request)
+        .then(r => {
+            if (r.ok) { const copy = r.clone(); caches.open(CACHE).then(c => c.put(e.request, copy)); }
+            return r;
+        })
+        .catch(() => caches.match(e.request, { ignoreSearch: true })));
+});
+)JS";
+    _server->sendHeader("Cache-Control", "no-cache");
+    _server->send_P(200, "application/javascript", SCRIPT);
+}
+
+void SeaSenseWebServer::handleManifest() {
+    static const char MANIFEST[] PROGMEM = R"JSON({
+    "name": "Project SeaSense Data Logger",
+    "short_name": "SeaSense",
+    "start_url": "/dashboard",
+    "display": "standalone",
+    "background_color": "#0c1221",
+    "theme_color": "#060a13"
+})JSON";
+    _server->send_P(200, "application/manifest+json", MANIFEST);
+}
+
 void SeaSenseWebServer::handleNotFound() {
     sendError("Not Found", 404);
 }
@@ -2558,53 +2813,113 @@ void SeaSenseWebServer::handleApiSensorRead() {
         return;
     }
 
-    // Acquire I2C mutex to prevent collision with loop() sensor reads
-    extern SemaphoreHandle_t g_i2cMutex;
-    bool locked = (g_i2cMutex != NULL) && xSemaphoreTake(g_i2cMutex, pdMS_TO_TICKS(500));
-    if (!locked) {
+    bool coalesced = false;
+    if (!acquireSensorReadings(coalesced)) {
         sendError("I2C bus busy, try again", 503);
         return;
     }
 
-    // Force read all sensors
-    bool tempSuccess = false;
-    bool ecSuccess = false;
-    bool phSuccess = false;
-    bool doSuccess = false;
+    extern ReadCoalescer sensorReads;
+    uint8_t okMask = sensorReads.getOkMask();
+    JsonStream json = beginJSON();
+    json.beginObject();
+    json.field("success", true);
+    json.field("coalesced", coalesced);
+    json.field("temperature", (okMask & (1 << SensorTraits<EZO_RTD>::INDEX)) != 0);
+    json.field("conductivity", (okMask & (1 << SensorTraits<EZO_EC>::INDEX)) != 0);
+    json.field("ph", (okMask & (1 << SensorTraits<EZO_pH>::INDEX)) != 0);
+    json.field("dissolved_oxygen", (okMask & (1 << SensorTraits<EZO_DO>::INDEX)) != 0);
+    json.endObject();
+    json.end();
+}
 
-    if (_tempSensor && _tempSensor->isEnabled()) {
-        tempSuccess = _tempSensor->read();
+void SeaSenseWebServer::handleApiSensorsLive() {
+    bool coalesced = false;
+    if (!acquireSensorReadings(coalesced)) {
+        sendError("I2C bus busy, try again", 503);
+        return;
+    }
 
-        // Set temperature compensation for other sensors
-        if (tempSuccess) {
-            SensorData tempData = _tempSensor->getData();
-            if (_ecSensor) _ecSensor->setTemperatureCompensation(tempData.value);
-            if (_phSensor && _phSensor->isEnabled()) _phSensor->setTemperatureCompensation(tempData.value);
-            if (_doSensor && _doSensor->isEnabled()) _doSensor->setTemperatureCompensation(tempData.value);
-        }
+    extern ReadCoalescer sensorReads;
+    uint8_t okMask = sensorReads.getOkMask();
+    JsonStream json = beginJSON();
+    json.beginObject();
+    json.field("age_ms", sensorReads.getAgeMs(millis()));
+    json.field("coalesced", coalesced);
+    json.beginObject("sensors");
+    writeLiveReading(json, _tempSensor, okMask);
+    writeLiveReading(json, _ecSensor, okMask);
+    if (_phSensor && _phSensor->isEnabled()) {
+        writeLiveReading(json, _phSensor, okMask);
+    }
+    if (_doSensor && _doSensor->isEnabled()) {
+        writeLiveReading(json, _doSensor, okMask);
     }
+    json.endObject();
+    json.endObject();
+    json.end();
+}
 
-    if (_ecSensor && _ecSensor->isEnabled()) {
-        ecSuccess = _ecSensor->read();
-        if (ecSuccess && _doSensor && _doSensor->isEnabled()) {
-            _doSensor->setSalinityCompensation(_ecSensor->getSalinity());
-        }
+template <typename Probe>
+void SeaSenseWebServer::writeLiveReading(JsonStream& json, Probe* probe, uint8_t okMask) {
+    if (!probe) {
+        return;
     }
+    using Traits = SensorTraits<Probe>;
+    SensorData data = probe->getData();
+    json.beginObject(Traits::KEY);
+    json.field("ok", (okMask & (1 << Traits::INDEX)) != 0);
+    json.field("value", data.value);
+    json.field("unit", data.unit);
+    json.field("quality", sensorQualityToString(data.quality));
+    json.field("serial", data.sensorSerial);
+    json.field("timestamp", data.timestamp);
+    json.endObject();
+}
 
-    if (_phSensor && _phSensor->isEnabled()) {
-        phSuccess = _phSensor->read();
+bool SeaSenseWebServer::acquireSensorReadings(bool& coalesced) {
+    extern ReadCoalescer sensorReads;
+    unsigned long requestedAt = millis();
+    coalesced = true;
+    if (sensorReads.tryShare(requestedAt)) {
+        return true;
     }
 
-    if (_doSensor && _doSensor->isEnabled()) {
-        doSuccess = _doSensor->read();
+    // Wait out an in-flight measurement cycle rather than failing: its
+    // readings are what this request would have read
+    extern SemaphoreHandle_t g_i2cMutex;
+    bool locked = (g_i2cMutex != NULL) && xSemaphoreTake(g_i2cMutex, pdMS_TO_TICKS(SENSOR_READ_BUS_WAIT_MS));
+    if (!locked) {
+        return false;
     }
 
-    xSemaphoreGive(g_i2cMutex);
+    coalesced = !sensorReads.acquire(requestedAt, [this]() {
+        extern CompensationManager compensation;
+        uint8_t okMask = 0;
+
+        if (_tempSensor && _tempSensor->isEnabled() && _tempSensor->read()) {
+            okMask |= 1 << SensorTraits<EZO_RTD>::INDEX;
+            // Set temperature compensation for other sensors (shared cache with loop())
+            compensation.applyTemperature(_tempSensor->getData().value);
+        }
+
+        if (_ecSensor && _ecSensor->isEnabled() && _ecSensor->read()) {
+            okMask |= 1 << SensorTraits<EZO_EC>::INDEX;
+            compensation.applySalinity(_ecSensor->getSalinity());
+        }
 
-    sendJSON("{\"success\":true,\"temperature\":" + String(tempSuccess ? "true" : "false") +
-             ",\"conductivity\":" + String(ecSuccess ? "true" : "false") +
-             ",\"ph\":" + String(phSuccess ? "true" : "false") +
-             ",\"dissolved_oxygen\":" + String(doSuccess ? "true" : "false") + "}");
+        if (_phSensor && _phSensor->isEnabled() && _phSensor->read()) {
+            okMask |= 1 << SensorTraits<EZO_pH>::INDEX;
+        }
+
+        if (_doSensor && _doSensor->isEnabled() && _doSensor->read()) {
+            okMask |= 1 << SensorTraits<EZO_DO>::INDEX;
+        }
+        return okMask;
+    });
+
+    xSemaphoreGive(g_i2cMutex);
+    return true;
 }
 
 void SeaSenseWebServer::handleApiCalibrate() {
@@ -2669,8 +2984,21 @@ void SeaSenseWebServer::handleApiCalibrate() {
         return;
     }
 
-    // Start calibration
-    if (_calibration->startCalibration(sensorType, calibrationType, referenceValue)) {
+    // Start calibration (other sensors' sessions keep running). loop() runs
+    // the sessions under the bus mutex; starting one resets state they use
+    extern SemaphoreHandle_t g_i2cMutex;
+    bool locked = (g_i2cMutex != NULL) && xSemaphoreTake(g_i2cMutex, pdMS_TO_TICKS(2000));
+    if (!locked) {
+        sendError("I2C bus busy, try again", 503);
+        return;
+    }
+    bool busy = _calibration->isCalibrating(sensorType);
+    bool started = !busy && _calibration->startCalibration(sensorType, calibrationType, referenceValue);
+    xSemaphoreGive(g_i2cMutex);
+
+    if (busy) {
+        sendError("Calibration already in progress for this sensor");
+    } else if (started) {
         sendJSON("{\"success\":true,\"message\":\"Calibration started\"}");
     } else {
         sendError("Failed to start calibration");
@@ -2683,40 +3011,70 @@ void SeaSenseWebServer::handleApiCalibrateStatus() {
         return;
     }
 
-    CalibrationState state = _calibration->getState();
+    // ?sensor= : that session alone, flat
+    String sensor = _server->arg("sensor");
+    if (sensor.length() > 0) {
+        JsonStream json = beginJSON();
+        json.beginObject();
+        writeCalibrationState(json, _calibration->getState(sensor));
+        json.endObject();
+        json.end();
+        return;
+    }
 
-    JsonDocument doc;
+    // Every session that has run since boot, plus the shared read scheduler
+    const AcquisitionScheduler& scheduler = _calibration->getScheduler();
+    JsonStream json = beginJSON();
+    json.beginObject();
+    json.field("calibrating", _calibration->isCalibrating());
+    json.field("read_batches", scheduler.getBatchCount());
+    json.field("read_samples", scheduler.getSampleCount());
+    json.beginObject("sessions");
+    for (int i = 0; i < CalibrationManager::SENSOR_COUNT; i++) {
+        const char* key = CalibrationManager::sensorKey(i);
+        CalibrationState state = _calibration->getState(key);
+        if (state.status == CalibrationStatus::IDLE) {
+            continue;
+        }
+        json.beginObject(key);
+        writeCalibrationState(json, state);
+        json.endObject();
+    }
+    json.endObject();
+    json.endObject();
+    json.end();
+}
 
+void SeaSenseWebServer::writeCalibrationState(JsonStream& json, const CalibrationState& state) {
     // Map status enum to string
     switch (state.status) {
         case CalibrationStatus::IDLE:
-            doc["status"] = "idle";
+            json.field("status", "idle");
             break;
         case CalibrationStatus::PREPARING:
-            doc["status"] = "preparing";
+            json.field("status", "preparing");
             break;
         case CalibrationStatus::WAITING_STABLE:
-            doc["status"] = "waiting_stable";
+            json.field("status", "waiting_stable");
             break;
         case CalibrationStatus::CALIBRATING:
-            doc["status"] = "calibrating";
+            json.field("status", "calibrating");
             break;
         case CalibrationStatus::COMPLETE:
-            doc["status"] = "complete";
+            json.field("status", "complete");
             break;
         case CalibrationStatus::ERROR:
-            doc["status"] = "error";
+            json.field("status", "error");
             break;
     }
 
-    doc["message"] = state.message;
-    doc["currentReading"] = state.currentReading;
-    doc["referenceValue"] = state.referenceValue;
-    doc["success"] = state.success;
-
-    String json;
-    serializeJson(doc, json);
-    sendJSON(json);
+    json.field("message", state.message);
+    json.field("currentReading", state.currentReading);
+    json.field("referenceValue", state.referenceValue);
+    if (!isnan(state.predictedValue)) {
+        json.field("predictedValue", state.predictedValue);
+    }
+    json.field("success", state.success);
 }
 
 void SeaSenseWebServer::handleApiCalibrationInfo() {
@@ -2799,7 +3157,9 @@ void SeaSenseWebServer::handleApiDataLatest() {
     }
 
     uint32_t skip = total > 20 ? total - 20 : 0;
-    std::vector<DataRecord> recs = _storage->readRecords(0, 20, skip);
+    RecordQuery query;
+    query.fields = RecordField::SENSOR_TYPE | RecordField::VALUE | RecordField::UNIT | RecordField::QUALITY;
+    std::vector<DataRecord> recs = _storage->queryRecords(query, 20, skip);
 
     // Collect most recent value per sensor type (iterate in reverse)
     JsonDocument doc;
@@ -2832,66 +3192,43 @@ void SeaSenseWebServer::handleApiDataDownload() {
         return;
     }
 
+    // Optional filters: ?type=&quality=&lat_min=&lat_max=&lon_min=&lon_max=
+    RecordQuery query;
+    if (_server->hasArg("type"))    query.sensorType = _server->arg("type");
+    if (_server->hasArg("quality")) query.quality = _server->arg("quality");
+    if (_server->hasArg("lat_min")) query.minLatitude = _server->arg("lat_min").toDouble();
+    if (_server->hasArg("lat_max")) query.maxLatitude = _server->arg("lat_max").toDouble();
+    if (_server->hasArg("lon_min")) query.minLongitude = _server->arg("lon_min").toDouble();
+    if (_server->hasArg("lon_max")) query.maxLongitude = _server->arg("lon_max").toDouble();
+
     _server->sendHeader("Content-Disposition", "attachment; filename=\"seasense-data.csv\"");
     _server->setContentLength(CONTENT_LENGTH_UNKNOWN);
     _server->send(200, "text/csv", "");
 
-    // Send CSV header
-    _server->sendContent("millis,timestamp_utc,latitude,longitude,altitude,gps_sats,gps_hdop,"
-        "sensor_type,sensor_model,sensor_serial,sensor_instance,calibration_date,"
-        "value,unit,quality,"
-        "wind_speed_true_ms,wind_angle_true_deg,wind_speed_app_ms,wind_angle_app_deg,"
-        "water_depth_m,stw_ms,water_temp_ext_c,air_temp_c,baro_pressure_pa,"
-        "humidity_pct,cog_deg,sog_ms,heading_deg,pitch_deg,roll_deg,"
-        "wind_speed_corr_ms,wind_angle_corr_deg,"
-        "lin_accel_x,lin_accel_y,lin_accel_z\r\n");
-
-    // Stream records in batches to avoid OOM
+    // Same columns and formatting as the files on the card
+    _server->sendContent(RecordSchema::csvHeader() + "\r\n");
+
+    // Stream records in batches to avoid OOM; a filtered batch may scan
+    // further than batchSize records, so resume where the last one stopped
     const uint16_t batchSize = 50;
-    for (uint32_t offset = 0; offset < total; offset += batchSize) {
+    uint32_t offset = 0;
+    while (offset < total) {
         uint16_t count = (total - offset < batchSize) ? (total - offset) : batchSize;
-        std::vector<DataRecord> recs = _storage->readRecords(0, count, offset);
+        uint32_t scanned = 0;
+        std::vector<DataRecord> recs = _storage->queryRecords(query, count, offset, &scanned);
         String chunk;
         chunk.reserve(recs.size() * 200);
         for (const auto& r : recs) {
-            chunk += String(r.millis) + ",";
-            chunk += r.timestampUTC + ",";
-            chunk += isnan(r.latitude)  ? "," : String(r.latitude, 6) + ",";
-            chunk += isnan(r.longitude) ? "," : String(r.longitude, 6) + ",";
-            chunk += isnan(r.altitude)  ? "," : String(r.altitude, 1) + ",";
-            chunk += String(r.gps_satellites) + ",";
-            chunk += (isnan(r.gps_hdop) ? "" : String(r.gps_hdop, 1)) + ",";
-            chunk += r.sensorType + ",";
-            chunk += r.sensorModel + ",";
-            chunk += r.sensorSerial + ",";
-            chunk += String(r.sensorInstance) + ",";
-            chunk += r.calibrationDate + ",";
-            chunk += String(r.value, 2) + ",";
-            chunk += r.unit + ",";
-            chunk += r.quality;
-            chunk += "," + (isnan(r.windSpeedTrue) ? String("") : String(r.windSpeedTrue, 2));
-            chunk += "," + (isnan(r.windAngleTrue) ? String("") : String(r.windAngleTrue, 1));
-            chunk += "," + (isnan(r.windSpeedApparent) ? String("") : String(r.windSpeedApparent, 2));
-            chunk += "," + (isnan(r.windAngleApparent) ? String("") : String(r.windAngleApparent, 1));
-            chunk += "," + (isnan(r.waterDepth) ? String("") : String(r.waterDepth, 2));
-            chunk += "," + (isnan(r.speedThroughWater) ? String("") : String(r.speedThroughWater, 2));
-            chunk += "," + (isnan(r.waterTempExternal) ? String("") : String(r.waterTempExternal, 2));
-            chunk += "," + (isnan(r.airTemp) ? String("") : String(r.airTemp, 2));
-            chunk += "," + (isnan(r.baroPressure) ? String("") : String(r.baroPressure, 0));
-            chunk += "," + (isnan(r.humidity) ? String("") : String(r.humidity, 1));
-            chunk += "," + (isnan(r.cogTrue) ? String("") : String(r.cogTrue, 1));
-            chunk += "," + (isnan(r.sog) ? String("") : String(r.sog, 2));
-            chunk += "," + (isnan(r.heading) ? String("") : String(r.heading, 1));
-            chunk += "," + (isnan(r.pitch) ? String("") : String(r.pitch, 1));
-            chunk += "," + (isnan(r.roll) ? String("") : String(r.roll, 1));
-            chunk += "," + (isnan(r.windSpeedCorrected) ? String("") : String(r.windSpeedCorrected, 2));
-            chunk += "," + (isnan(r.windAngleCorrected) ? String("") : String(r.windAngleCorrected, 1));
-            chunk += "," + (isnan(r.linAccelX) ? String("") : String(r.linAccelX, 3));
-            chunk += "," + (isnan(r.linAccelY) ? String("") : String(r.linAccelY, 3));
-            chunk += "," + (isnan(r.linAccelZ) ? String("") : String(r.linAccelZ, 3));
+            RecordSchema::appendCSV(chunk, r);
             chunk += "\r\n";
         }
-        _server->sendContent(chunk);
+        if (chunk.length() > 0) {
+            _server->sendContent(chunk);
+        }
+        if (scanned == 0) {
+            break;
+        }
+        offset += scanned;
     }
     _server->sendContent("");  // End chunked transfer
 }
@@ -2921,28 +3258,105 @@ void SeaSenseWebServer::handleApiDataRecords() {
     // Page 0 = most recent, so we skip to the tail of the file.
     uint32_t tailStart = (uint32_t)((page + 1) * limit);
     uint32_t skip = total > tailStart ? total - tailStart : 0;
-    std::vector<DataRecord> recs = _storage->readRecords(0, limit, skip);
+    RecordQuery query;
+    query.fields = RecordField::MILLIS | RecordField::TIMESTAMP_UTC | RecordField::SENSOR_TYPE
+                 | RecordField::VALUE | RecordField::UNIT | RecordField::QUALITY | RecordField::QC_FLAGS;
+
+    JsonStream json = beginJSON();
+    json.beginObject();
+    json.field("total", total);
+    json.field("page", page);
+    json.field("limit", limit);
+    json.beginArray("records");
+
+    // Return in most-recent-first order, reading the page backwards a batch
+    // at a time so only DATA_RECORDS_BATCH records are in memory
+    uint32_t end = skip + limit < total ? skip + limit : total;
+    while (end > skip) {
+        uint16_t count = (uint16_t)min(end - skip, (uint32_t)DATA_RECORDS_BATCH);
+        std::vector<DataRecord> batch = _storage->queryRecords(query, count, end - count);
+        for (int i = (int)batch.size() - 1; i >= 0; i--) {
+            writeDataRecord(json, batch[i]);
+        }
+        end -= count;
+    }
 
-    JsonDocument doc;
-    doc["total"]  = total;
-    doc["page"]   = page;
-    doc["limit"]  = limit;
-    JsonArray arr = doc["records"].to<JsonArray>();
+    json.endArray();
+    json.endObject();
+    json.end();
+}
 
-    // Return in most-recent-first order
-    for (int i = (int)recs.size() - 1; i >= 0; i--) {
-        JsonObject r = arr.add<JsonObject>();
-        r["millis"]  = recs[i].millis;
-        r["time"]    = recs[i].timestampUTC;
-        r["type"]    = recs[i].sensorType;
-        r["value"]   = recs[i].value;
-        r["unit"]    = recs[i].unit;
-        r["quality"] = recs[i].quality;
+void SeaSenseWebServer::handleApiDataChanges() {
+    // ?since=<next>&stream=<stream>, both from the last response (omit to start over)
+    // &tail=<n>: only the newest n records (when starting over or far behind)
+    uint32_t since = _server->hasArg("since") ? strtoul(_server->arg("since").c_str(), nullptr, 10) : 0;
+    uint32_t clientStream = _server->hasArg("stream") ? strtoul(_server->arg("stream").c_str(), nullptr, 10) : 0;
+    uint32_t tail = _server->hasArg("tail") ? strtoul(_server->arg("tail").c_str(), nullptr, 10) : 0;
+    uint16_t limit = DATA_CHANGES_MAX_RECORDS;
+    if (_server->hasArg("limit")) {
+        long requested = _server->arg("limit").toInt();
+        if (requested > 0 && requested < limit) limit = (uint16_t)requested;
     }
 
-    String json;
-    serializeJson(doc, json);
-    sendJSON(json);
+    uint32_t total = _storage->getStats().totalRecords;
+
+    // The first record identifies the store's contents
+    RecordQuery head;
+    head.fields = RecordField::MILLIS | RecordField::SENSOR_TYPE | RecordField::VALUE;
+    std::vector<DataRecord> first;
+    if (total > 0) {
+        first = _storage->queryRecords(head, 1, 0);
+    }
+    uint32_t stream = first.empty()
+        ? ChangeFeed::streamId(_storage->isSDMounted(), true, 0, nullptr, 0.0f)
+        : ChangeFeed::streamId(_storage->isSDMounted(), false, first[0].millis,
+                               first[0].sensorType.c_str(), first[0].value);
+
+    ChangeFeed::Window window = ChangeFeed::plan(stream, clientStream, since, total, limit, tail);
+    std::vector<DataRecord> recs;
+    if (window.count > 0) {
+        RecordQuery query;
+        query.fields = RecordField::MILLIS | RecordField::TIMESTAMP_UTC | RecordField::SENSOR_TYPE
+                     | RecordField::VALUE | RecordField::UNIT | RecordField::QUALITY | RecordField::QC_FLAGS;
+        recs = _storage->queryRecords(query, window.count, window.from);
+    }
+    uint32_t next = window.from + recs.size();
+
+    JsonStream json = beginJSON();
+    json.beginObject();
+    json.field("stream", stream);
+    json.field("reset", window.reset);
+    json.field("gap", window.gap);
+    json.field("from", window.from);
+    json.field("next", next);
+    json.field("total", total);
+    json.field("more", next < total);
+    json.beginArray("records");
+
+    // Oldest first: record i has sequence from + i
+    for (size_t i = 0; i < recs.size(); i++) {
+        writeDataRecord(json, recs[i]);
+    }
+
+    json.endArray();
+    json.endObject();
+    json.end();
+}
+
+void SeaSenseWebServer::writeDataRecord(JsonStream& json, const DataRecord& rec) {
+    json.beginObject();
+    json.field("millis", rec.millis);
+    json.field("time", rec.timestampUTC);
+    json.field("type", rec.sensorType);
+    json.field("value", rec.value);
+    json.field("unit", rec.unit);
+    json.field("quality", rec.quality);
+    QcFlags qc(rec.qcFlags);
+    if (qc.isSet()) {
+        json.field("qc_flag", (int)qc.aggregate());
+        json.field("qc_flags", qc.toString());
+    }
+    json.endObject();
 }
 
 void SeaSenseWebServer::handleApiUploadForce() {
@@ -2955,10 +3369,11 @@ void SeaSenseWebServer::handleApiUploadForce() {
 void SeaSenseWebServer::handleApiUploadHistory() {
     extern APIUploader apiUploader;
 
-    JsonDocument doc;
-    doc["total_bytes_sent"] = apiUploader.getTotalBytesSent();
-    doc["total_bytes_uploaded"] = _storage->getTotalBytesUploaded();
-    JsonArray arr = doc["history"].to<JsonArray>();
+    JsonStream json = beginJSON();
+    json.beginObject();
+    json.field("total_bytes_sent", apiUploader.getTotalBytesSent());
+    json.field("total_bytes_uploaded", _storage->getTotalBytesUploaded());
+    json.beginArray("history");
 
     // Always serve persisted history (survives reboots, includes current session)
     uint8_t pCount = 0, pHead = 0;
@@ -2966,20 +3381,91 @@ void SeaSenseWebServer::handleApiUploadHistory() {
     if (phist && pCount > 0) {
         for (uint8_t i = 0; i < pCount; i++) {
             uint8_t idx = (pHead + SPIFFSStorage::MAX_UPLOAD_HISTORY - 1 - i) % SPIFFSStorage::MAX_UPLOAD_HISTORY;
-            JsonObject e = arr.add<JsonObject>();
-            e["epoch"]       = phist[idx].epochTime;
-            e["duration_ms"] = phist[idx].durationMs;
-            e["success"]     = phist[idx].success;
-            e["record_count"]  = phist[idx].recordCount;
-            e["payload_bytes"] = phist[idx].payloadBytes;
+            json.beginObject();
+            json.field("epoch", phist[idx].epochTime);
+            json.field("duration_ms", phist[idx].durationMs);
+            json.field("success", phist[idx].success);
+            json.field("record_count", phist[idx].recordCount);
+            json.field("payload_bytes", phist[idx].payloadBytes);
+            json.endObject();
         }
     }
 
+    json.endArray();
+    json.endObject();
+    json.end();
+}
+
+void SeaSenseWebServer::handleApiLogs() {
+    // ?since=<seq from the last response>&level=warn&tag=API&limit=50
+    uint32_t since = _server->hasArg("since") ? strtoul(_server->arg("since").c_str(), nullptr, 10) : 0;
+    LogLevel maxLevel = LogLevel::DEBUG;
+    if (_server->hasArg("level") && !EventLog::parseLevel(_server->arg("level"), maxLevel)) {
+        sendError("Unknown level (error, warn, info, debug)", 400);
+        return;
+    }
+    String tag = _server->arg("tag");
+    size_t limit = 50;
+    if (_server->hasArg("limit")) {
+        limit = constrain(_server->arg("limit").toInt(), 1L, (long)LOG_RING_SIZE);
+    }
+
+    std::vector<LogEntry> entries(limit);
+    uint32_t next = since;
+    size_t count = eventLog.query(since, maxLevel, tag.c_str(), entries.data(), limit, next);
+
+    JsonDocument doc;
+    doc["next"] = next;
+    doc["captured"] = eventLog.getCapturedCount();
+    doc["lost"] = eventLog.getLostCount();
+    doc["level"] = EventLog::levelName(eventLog.getLevel());
+    doc["sd_level"] = EventLog::levelName(eventLog.getSdLevel());
+    JsonArray arr = doc["entries"].to<JsonArray>();
+
+    char msg[LOG_LINE_BYTES];
+    for (size_t i = 0; i < count; i++) {
+        const LogEntry& e = entries[i];
+        EventLog::format(e, msg, sizeof(msg));
+        JsonObject o = arr.add<JsonObject>();
+        o["seq"] = e.seq;
+        o["ms"] = e.ms;
+        o["level"] = EventLog::levelName(e.level);
+        o["tag"] = e.tag;
+        o["msg"] = msg;
+    }
+
     String json;
     serializeJson(doc, json);
     sendJSON(json);
 }
 
+void SeaSenseWebServer::handleApiLogsLevel() {
+    if (_server->method() != HTTP_POST) {
+        sendError("Method not allowed", 405);
+        return;
+    }
+
+    JsonDocument doc;
+    if (deserializeJson(doc, _server->arg("plain"))) {
+        sendError("Invalid JSON", 400);
+        return;
+    }
+
+    // Runtime only: back to LOG_DEFAULT_LEVEL / LOG_SD_DEFAULT_LEVEL on reboot
+    LogLevel level = eventLog.getLevel();
+    LogLevel sdLevel = eventLog.getSdLevel();
+    if ((doc["level"].is<const char*>() && !EventLog::parseLevel(doc["level"].as<String>(), level)) ||
+        (doc["sd_level"].is<const char*>() && !EventLog::parseLevel(doc["sd_level"].as<String>(), sdLevel))) {
+        sendError("Unknown level (error, warn, info, debug)", 400);
+        return;
+    }
+    eventLog.setLevel(level);
+    eventLog.setSdLevel(sdLevel);
+
+    sendJSON(String("{\"success\":true,\"level\":\"") + EventLog::levelName(level)
+             + "\",\"sd_level\":\"" + EventLog::levelName(sdLevel) + "\"}");
+}
+
 void SeaSenseWebServer::handleApiDeviceRegenerateGuid() {
     if (_server->method() != HTTP_POST) { sendError("POST required", 405); return; }
     if (!_configManager) { sendError("Configuration manager not available", 503); return; }
@@ -2996,65 +3482,72 @@ void SeaSenseWebServer::handleApiConfig() {
         return;
     }
 
-    JsonDocument doc;
+    // Snapshot everything before the headers go out
+    ConfigManager::WiFiConfig wifi = _configManager->getWiFiConfig();
+    ConfigManager::APIConfig api = _configManager->getAPIConfig();
+    ConfigManager::SamplingConfig sampling = _configManager->getSamplingConfig();
+    ConfigManager::GPSConfig gps = _configManager->getGPSConfig();
+    ConfigManager::NMEAConfig nmea = _configManager->getNMEAConfig();
+    ConfigManager::DeploymentConfig dep = _configManager->getDeploymentConfig();
+    ConfigManager::DeviceConfig device = _configManager->getDeviceConfig();
+
+    // Minimum sampling interval = full pump cycle duration (calculated from current pump config)
+    PumpConfig pc = _configManager->getPumpConfig();
+    unsigned long minSamplingMs = max((unsigned long)pc.flushDurationMs + pc.measureDurationMs, 5000UL);
+
+    JsonStream json = beginJSON();
+    json.beginObject();
 
     // WiFi config
-    ConfigManager::WiFiConfig wifi = _configManager->getWiFiConfig();
-    JsonObject wifiObj = doc["wifi"].to<JsonObject>();
-    wifiObj["station_ssid"] = wifi.stationSSID;
-    wifiObj["station_password"] = wifi.stationPassword;
-    wifiObj["ap_password"] = wifi.apPassword;
+    json.beginObject("wifi");
+    json.field("station_ssid", wifi.stationSSID);
+    json.field("station_password", wifi.stationPassword);
+    json.field("ap_password", wifi.apPassword);
+    json.endObject();
 
     // API config
-    ConfigManager::APIConfig api = _configManager->getAPIConfig();
-    JsonObject apiObj = doc["api"].to<JsonObject>();
-    apiObj["url"] = api.url;
-    apiObj["upload_interval_ms"] = api.uploadInterval;
-    apiObj["batch_size"] = api.batchSize;
-    apiObj["max_retries"] = api.maxRetries;
+    json.beginObject("api");
+    json.field("url", api.url);
+    json.field("upload_interval_ms", api.uploadInterval);
+    json.field("batch_size", api.batchSize);
+    json.field("max_retries", api.maxRetries);
+    json.endObject();
 
     // Sampling config
-    ConfigManager::SamplingConfig sampling = _configManager->getSamplingConfig();
-    JsonObject samplingObj = doc["sampling"].to<JsonObject>();
-    samplingObj["sensor_interval_ms"] = sampling.sensorIntervalMs;
-    samplingObj["skip_if_stationary"] = sampling.skipIfStationary;
-    samplingObj["stationary_delta_meters"] = sampling.stationaryDeltaMeters;
+    json.beginObject("sampling");
+    json.field("sensor_interval_ms", sampling.sensorIntervalMs);
+    json.field("skip_if_stationary", sampling.skipIfStationary);
+    json.field("stationary_delta_meters", sampling.stationaryDeltaMeters);
+    json.field("min_sampling_ms", minSamplingMs);
+    json.endObject();
 
     // GPS config
-    ConfigManager::GPSConfig gps = _configManager->getGPSConfig();
-    JsonObject gpsObj = doc["gps"].to<JsonObject>();
-    gpsObj["use_nmea2000"] = gps.useNMEA2000;
-    gpsObj["fallback_to_onboard"] = gps.fallbackToOnboard;
+    json.beginObject("gps");
+    json.field("use_nmea2000", gps.useNMEA2000);
+    json.field("fallback_to_onboard", gps.fallbackToOnboard);
+    json.endObject();
 
     // NMEA output config
-    ConfigManager::NMEAConfig nmea = _configManager->getNMEAConfig();
-    JsonObject nmeaObj = doc["nmea"].to<JsonObject>();
-    nmeaObj["output_enabled"] = nmea.outputEnabled;
-
-    // Minimum sampling interval = full pump cycle duration (calculated from current pump config)
-    {
-        PumpConfig pc = _configManager->getPumpConfig();
-        unsigned long minMs = (unsigned long)pc.flushDurationMs + pc.measureDurationMs;
-        samplingObj["min_sampling_ms"] = max(minMs, 5000UL);
-    }
+    json.beginObject("nmea");
+    json.field("output_enabled", nmea.outputEnabled);
+    json.endObject();
 
     // Deployment metadata
-    ConfigManager::DeploymentConfig dep = _configManager->getDeploymentConfig();
-    JsonObject depObj = doc["deployment"].to<JsonObject>();
-    depObj["depth_cm"] = dep.depthCm;
-    depObj["purchase_date"] = dep.purchaseDate;
-    depObj["deploy_date"] = dep.deployDate;
+    json.beginObject("deployment");
+    json.field("depth_cm", dep.depthCm);
+    json.field("purchase_date", dep.purchaseDate);
+    json.field("deploy_date", dep.deployDate);
+    json.endObject();
 
     // Device config
-    ConfigManager::DeviceConfig device = _configManager->getDeviceConfig();
-    JsonObject deviceObj = doc["device"].to<JsonObject>();
-    deviceObj["device_guid"] = device.deviceGUID;
-    deviceObj["partner_id"] = device.partnerID;
-    deviceObj["firmware_version"] = device.firmwareVersion;
-
-    String json;
-    serializeJson(doc, json);
-    sendJSON(json);
+    json.beginObject("device");
+    json.field("device_guid", device.deviceGUID);
+    json.field("partner_id", device.partnerID);
+    json.field("firmware_version", device.firmwareVersion);
+    json.endObject();
+
+    json.endObject();
+    json.end();
 }
 
 void SeaSenseWebServer::handleApiConfigUpdate() {
@@ -3077,6 +3570,9 @@ void SeaSenseWebServer::handleApiConfigUpdate() {
         return;
     }
 
+    // Publish all sections below as one snapshot version
+    _configManager->beginUpdate();
+
     // Update WiFi config
     if (doc["wifi"].is<JsonObject>()) {
         ConfigManager::WiFiConfig wifi;
@@ -3110,19 +3606,7 @@ void SeaSenseWebServer::handleApiConfigUpdate() {
         // keep/allow threshold updates for forward compatibility
         sampling.stationaryDeltaMeters = doc["sampling"]["stationary_delta_meters"] | sampling.stationaryDeltaMeters;
         _configManager->setSamplingConfig(sampling);
-
-        // Apply immediately: update globals so dashboard countdown reflects new interval
-        extern unsigned long sensorSamplingIntervalMs;
-        extern bool skipMeasurementIfStationary;
-        extern float stationaryDeltaMeters;
-        extern unsigned long lastSensorReadAt;
-        extern portMUX_TYPE g_timerMux;
-        sensorSamplingIntervalMs = sampling.sensorIntervalMs;
-        skipMeasurementIfStationary = sampling.skipIfStationary;
-        stationaryDeltaMeters = sampling.stationaryDeltaMeters;
-        portENTER_CRITICAL(&g_timerMux);
-        lastSensorReadAt = millis();  // reschedule from now
-        portEXIT_CRITICAL(&g_timerMux);
+        // Runtime globals are updated by the config subscriber in setup()
     }
 
     // Update GPS config
@@ -3148,9 +3632,6 @@ void SeaSenseWebServer::handleApiConfigUpdate() {
 
         if (hasValue) {
             _configManager->setNMEAConfig(nmea);
-            // Apply immediately for runtime NMEA output gate
-            extern bool nmeaOutputEnabled;
-            nmeaOutputEnabled = nmea.outputEnabled;
         }
     }
 
@@ -3176,6 +3657,8 @@ void SeaSenseWebServer::handleApiConfigUpdate() {
         _configManager->setDeploymentConfig(dep);
     }
 
+    _configManager->commitUpdate();
+
     // Save to SPIFFS
     if (_configManager->save()) {
         sendJSON("{\"success\":true,\"message\":\"Configuration saved. Restart device to apply WiFi and API changes.\"}");
@@ -3187,188 +3670,457 @@ void SeaSenseWebServer::handleApiConfigUpdate() {
 void SeaSenseWebServer::handleApiStatus() {
     extern SystemHealth systemHealth;
 
-    JsonDocument doc;
+    JsonStream json = beginJSON();
+    json.beginObject();
 
-    doc["uptime_ms"] = millis();
+    json.field("uptime_ms", millis());
 
     // WiFi
-    doc["wifi"]["ap_ssid"] = _apSSID;
-    doc["wifi"]["ap_ip"] = getAPIP();
-    doc["wifi"]["station_connected"] = isWiFiConnected();
+    json.beginObject("wifi");
+    json.field("ap_ssid", _apSSID);
+    json.field("ap_ip", getAPIP());
+    json.field("station_connected", isWiFiConnected());
     if (isWiFiConnected()) {
-        doc["wifi"]["station_ip"] = getStationIP();
-        doc["wifi"]["rssi"] = WiFi.RSSI();
+        json.field("station_ip", getStationIP());
+        json.field("rssi", WiFi.RSSI());
     }
+    json.endObject();
 
     // Storage
-    doc["storage"]["status"] = _storage->getStatusString();
-    doc["storage"]["spiffs_mounted"] = _storage->isSPIFFSMounted();
-    doc["storage"]["sd_mounted"] = _storage->isSDMounted();
+    json.beginObject("storage");
+    json.field("status", _storage->getStatusString());
+    json.field("spiffs_mounted", _storage->isSPIFFSMounted());
+    json.field("sd_mounted", _storage->isSDMounted());
+    SDStorage::ArchiveStats archive = _storage->getArchiveStats();
+    json.field("archive_records", archive.records);
+    json.field("archive_bytes", archive.bytes);
+    json.field("archive_pending", archive.segmentPending);
+    json.endObject();
 
     // System health
-    doc["system"]["free_heap"] = ESP.getFreeHeap();
-    doc["system"]["min_free_heap"] = ESP.getMinFreeHeap();
-    doc["system"]["reset_reason"] = systemHealth.getResetReasonString();
-    doc["system"]["reboot_count"] = systemHealth.getRebootCount();
-    doc["system"]["consecutive_reboots"] = systemHealth.getConsecutiveReboots();
-    doc["system"]["safe_mode"] = systemHealth.isInSafeMode();
+    json.beginObject("system");
+    json.field("free_heap", ESP.getFreeHeap());
+    json.field("min_free_heap", ESP.getMinFreeHeap());
+    json.field("reset_reason", systemHealth.getResetReasonString());
+    json.field("reboot_count", systemHealth.getRebootCount());
+    json.field("consecutive_reboots", systemHealth.getConsecutiveReboots());
+    json.field("safe_mode", systemHealth.isInSafeMode());
+
+    // Previous boot's flight record, until an upload carries it off
+    extern FlightRecorder flightRecorder;
+    json.field("post_mortem_pending", flightRecorder.hasPostMortem());
+    if (flightRecorder.hasPostMortemRecord()) {
+        const FlightRecord& pm = flightRecorder.getPostMortem();
+        json.field("last_boot_stage", FlightRecorder::stageName(pm, pm.stage));
+        json.field("last_boot_uptime_ms", pm.lastMs);
+        json.field("last_boot_reset_reason", SystemHealth::resetReasonName((esp_reset_reason_t)pm.resetReason));
+    }
+    json.endObject();
 
     // Error counters
-    doc["errors"]["sensor"] = systemHealth.getErrorCount(ErrorType::SENSOR);
-    doc["errors"]["sd"] = systemHealth.getErrorCount(ErrorType::SD);
-    doc["errors"]["api"] = systemHealth.getErrorCount(ErrorType::API);
-    doc["errors"]["wifi"] = systemHealth.getErrorCount(ErrorType::WIFI);
+    json.beginObject("errors");
+    json.field("sensor", systemHealth.getErrorCount(ErrorType::SENSOR));
+    json.field("sd", systemHealth.getErrorCount(ErrorType::SD));
+    json.field("api", systemHealth.getErrorCount(ErrorType::API));
+    json.field("wifi", systemHealth.getErrorCount(ErrorType::WIFI));
+    json.endObject();
 
     // Loop breadcrumbs (from main loop)
     extern volatile unsigned long g_lastLoopStartMs;
     extern volatile unsigned long g_maxLoopGapMs;
     extern const char* g_loopStage;
-    doc["runtime"]["loop_stage"] = g_loopStage ? g_loopStage : "unknown";
-    doc["runtime"]["last_loop_start_ms"] = (unsigned long)g_lastLoopStartMs;
-    doc["runtime"]["max_loop_gap_ms"] = (unsigned long)g_maxLoopGapMs;
+    json.beginObject("runtime");
+    json.field("loop_stage", g_loopStage ? g_loopStage : "unknown");
+    json.field("last_loop_start_ms", (unsigned long)g_lastLoopStartMs);
+    json.field("max_loop_gap_ms", (unsigned long)g_maxLoopGapMs);
+    json.endObject();
+
+    // Streamed JSON responses and what gzip saved on them (this one not yet counted)
+    json.beginObject("http");
+    json.field("streamed", _httpStats.streamed);
+    json.field("gzipped", _httpStats.gzipped);
+    json.field("gzip_in_bytes", _httpStats.gzipInBytes);
+    json.field("gzip_out_bytes", _httpStats.gzipOutBytes);
+    json.field("gzip_ratio", _httpStats.gzipOutBytes > 0
+               ? (double)_httpStats.gzipInBytes / _httpStats.gzipOutBytes : 0.0, 2);
+    json.field("gzip_cpu_us", _httpStats.gzipCpuUs);
+    json.field("last_in_bytes", _httpStats.lastInBytes);
+    json.field("last_out_bytes", _httpStats.lastOutBytes);
+    json.field("last_ratio", _httpStats.lastOutBytes > 0
+               ? (double)_httpStats.lastInBytes / _httpStats.lastOutBytes : 0.0, 2);
+    json.field("last_cpu_us", _httpStats.lastCpuUs);
+    json.endObject();
+
+    // Web sensor reads: how many were served without touching the bus
+    extern ReadCoalescer sensorReads;
+    json.beginObject("sensor_reads");
+    json.field("requests", sensorReads.getRequestCount());
+    json.field("acquisitions", sensorReads.getAcquisitionCount());
+    json.field("coalesced", sensorReads.getCoalescedCount());
+    json.endObject();
+
+    // Power residency and estimated charge per state
+    extern PowerManager powerManager;
+    json.beginObject("power");
+    json.field("frequency_scaling", powerManager.isFrequencyScaling());
+    json.field("avg_current_ma", powerManager.getAverageCurrentMA());
+    json.field("next_deadline", powerManager.getNextDeadlineSource());
+    json.field("sleeps", powerManager.getSleepCount());
+    json.beginObject("states");
+    for (int i = 0; i < (int)PowerState::COUNT; i++) {
+        PowerState ps = (PowerState)i;
+        json.beginObject(PowerManager::stateName(ps));
+        json.field("ms", powerManager.getResidencyMs(ps));
+        json.field("mah", powerManager.getChargeMAh(ps));
+        json.endObject();
+    }
+    json.endObject();
+    json.beginObject("wakes");
+    for (int i = 0; i < (int)WakeCause::COUNT; i++) {
+        WakeCause wc = (WakeCause)i;
+        json.field(PowerManager::wakeCauseName(wc), powerManager.getWakeCount(wc));
+    }
+    json.endObject();
+    json.endObject();
+
+    // Per-subsystem health and time spent degraded
+    extern RecoveryManager recoveryManager;
+    unsigned long nowMs = millis();
+    json.beginObject("recovery");
+    json.field("reboot_pending", recoveryManager.isRebootRequested());
+    for (int i = 0; i < (int)Subsystem::COUNT; i++) {
+        Subsystem s = (Subsystem)i;
+        if (!recoveryManager.isMonitored(s)) continue;
+        json.beginObject(RecoveryManager::subsystemName(s));
+        json.field("state", RecoveryManager::stateName(recoveryManager.getState(s)));
+        json.field("failures", recoveryManager.getConsecutiveFailures(s));
+        json.field("next_action", RecoveryManager::actionName(recoveryManager.getNextAction(s)));
+        json.field("availability", recoveryManager.getAvailability(s, nowMs));
+        json.field("degraded_ms", recoveryManager.getTimeInState(s, HealthState::DEGRADED, nowMs)
+                                + recoveryManager.getTimeInState(s, HealthState::RECOVERING, nowMs));
+        json.field("disabled_ms", recoveryManager.getTimeInState(s, HealthState::DISABLED, nowMs));
+        json.beginObject("actions");
+        for (int k = 0; k < (int)RecoveryAction::COUNT; k++) {
+            RecoveryAction a = (RecoveryAction)k;
+            if (recoveryManager.getActionCount(s, a) > 0) {
+                json.field(RecoveryManager::actionName(a), recoveryManager.getActionCount(s, a));
+            }
+        }
+        json.endObject();
+        json.endObject();
+    }
+    json.endObject();
+
+    // EZO compensation commands sent vs skipped by the cache
+    extern CompensationManager compensation;
+    json.beginObject("compensation");
+    json.field("resyncs", compensation.getResyncCount());
+    for (int i = 0; i < (int)CompParam::COUNT; i++) {
+        CompParam p = (CompParam)i;
+        json.beginObject(CompensationManager::paramName(p));
+        json.field("sent", compensation.getSentCount(p));
+        json.field("skipped", compensation.getSkippedCount(p));
+        json.field("failed", compensation.getFailedCount(p));
+        json.endObject();
+    }
+    json.endObject();
+
+    // Time service: source, discipline and pending timestamp back-fill
+    extern TimeService timeService;
+    json.beginObject("time");
+    json.field("synced", timeService.isSynced());
+    json.field("source", TimeService::sourceName(timeService.getSource()));
+    json.field("utc", timeService.nowUTC(nowMs));
+    json.field("mono_ms", timeService.monoMs(nowMs));
+    json.field("sync_count", timeService.getSyncCount());
+    json.field("last_sync_age_ms", timeService.getLastSyncAgeMs(nowMs));
+    json.field("last_step_ms", timeService.getLastStepMs());
+    json.field("drift_ppm", timeService.getDriftPpm());
+    json.field("backfill_pending", _storage ? _storage->isBackfillPending() : false);
+    json.endObject();
+
+    // QC flag counts per channel (aggregate flag of each measurement)
+    extern QualityControl qualityControl;
+    json.beginObject("qc");
+    for (int i = 0; i < (int)QcChannel::COUNT; i++) {
+        QcChannel ch = (QcChannel)i;
+        json.beginObject(QualityControl::channelName(ch));
+        json.field("evaluated", qualityControl.getEvaluatedCount(ch));
+        json.field("suspect", qualityControl.getSuspectCount(ch));
+        json.field("failed", qualityControl.getFailCount(ch));
+        json.field("last", qualityControl.getLastFlags(ch).toString());
+        json.endObject();
+    }
+    json.endObject();
+
+    // Per-sensor circuit breakers: skipped reads are not failed reads
+    json.beginObject("breakers");
+    EZOSensor* ezoSensors[] = {_tempSensor, _ecSensor, _phSensor, _doSensor};
+    const char* ezoNames[] = {"temperature", "conductivity", "ph", "dissolved_oxygen"};
+    for (int i = 0; i < 4; i++) {
+        if (!ezoSensors[i]) continue;
+        const CircuitBreaker& br = ezoSensors[i]->getBreaker();
+        json.beginObject(ezoNames[i]);
+        json.field("state", CircuitBreaker::stateName(br.getState()));
+        json.field("consecutive_failures", br.getConsecutiveFailures());
+        json.field("skipped", br.getSkippedCount());
+        json.field("trips", br.getTripCount());
+        json.field("retry_in_ms", br.getRetryInMs(nowMs));
+        json.endObject();
+    }
+    json.endObject();
+
+    // NMEA2000 output (via extern globals from main sketch)
+    extern bool nmeaOutputEnabled;
+    extern N2kTxScheduler n2kTx;
+    extern N2kWaterQualityEmitter n2kEmitter;
+    extern NMEA2000GPS n2kGPS;
+    if constexpr (FEATURE_N2K) {
+        const N2kTxScheduler::Stats& txStats = n2kTx.getStats();
+        json.beginObject("n2k_output");
+        json.field("enabled", nmeaOutputEnabled);
+        json.field("transmit_ready", n2kGPS.isTransmitReady());
+        json.field("source_address", n2kGPS.getSourceAddress());
+        json.field("queue_depth", n2kTx.getQueueDepth());
+        json.field("published", n2kEmitter.getPublishedCount());
+        json.field("sent_messages", txStats.sentMessages);
+        json.field("sent_frames", txStats.sentFrames);
+        json.field("replaced", txStats.replaced);
+        json.field("retries", txStats.retries);
+        json.field("dropped_queue_full", txStats.droppedQueueFull);
+        json.field("dropped_bus_error", txStats.droppedBusError);
+        json.field("dropped_not_ready", txStats.droppedNotReady);
+        json.endObject();
+    }
+
+    // UDP live broadcast (via extern global from main sketch)
+    extern UdpBroadcaster udpLive;
+    if constexpr (FEATURE_UDP_LIVE) {
+        json.beginObject("udp_live");
+        json.field("nmea_port", udpLive.getNmeaPort());
+        json.field("binary_port", udpLive.getBinaryPort());
+        json.field("published", udpLive.getPublishedCount());
+        json.field("datagrams", udpLive.getDatagramCount());
+        json.field("errors", udpLive.getErrorCount());
+        json.endObject();
+    }
+
+    // Input capture (via extern global from main sketch)
+    extern CaptureRecorder captureRecorder;
+    json.beginObject("capture");
+    json.field("active", captureRecorder.isActive());
+    json.field("file", captureRecorder.getFileName());
+    json.field("records", captureRecorder.getRecordCount());
+    json.field("bytes_written", captureRecorder.getBytesWritten());
+    json.field("dropped", captureRecorder.getDroppedCount());
+    json.field("last_error", captureRecorder.getLastError());
+    json.endObject();
 
     // GPS status (via extern globals from main sketch)
     extern bool activeGPSHasValidFix();
+    extern bool activeGPSIsN2K();
     extern GPSData activeGPSGetData();
-    extern NMEA2000GPS n2kGPS;
-    doc["gps"]["has_fix"] = activeGPSHasValidFix();
-    doc["gps"]["source"] = n2kGPS.hasValidFix() ? "nmea2000" : "onboard";
+    json.beginObject("gps");
+    json.field("has_fix", activeGPSHasValidFix());
+    json.field("source", activeGPSIsN2K() ? "nmea2000" : "onboard");
     if (activeGPSHasValidFix()) {
         GPSData gd = activeGPSGetData();
-        doc["gps"]["satellites"] = gd.satellites;
-        doc["gps"]["hdop"] = gd.hdop;
+        json.field("satellites", gd.satellites);
+        json.field("hdop", gd.hdop);
     }
+    json.endObject();
 
     // Upload status (via extern to apiUploader)
     extern APIUploader apiUploader;
-    doc["upload"]["status"] = apiUploader.getStatusString();
-    doc["upload"]["pending_records"] = apiUploader.getPendingRecords();
-    doc["upload"]["last_success_ms"] = apiUploader.getLastUploadTime();
-    doc["upload"]["last_success_epoch"] = _storage->getLastSuccessEpoch();
-    doc["upload"]["last_attempt_ms"] = apiUploader.getLastAttemptTime();
-    doc["upload"]["last_error"] = apiUploader.getLastError();
-    doc["upload"]["force_pending"] = apiUploader.isForcePending();
-    doc["upload"]["retry_count"] = apiUploader.getRetryCount();
-    doc["upload"]["next_upload_ms"] = apiUploader.getTimeUntilNext();
-    doc["upload"]["total_bytes_uploaded"] = _storage->getTotalBytesUploaded();
-    if (apiUploader.getLastError().length() > 0) {
-        doc["upload"]["last_error"] = apiUploader.getLastError();
+    json.beginObject("upload");
+    json.field("status", apiUploader.getStatusString());
+    json.field("pending_records", apiUploader.getPendingRecords());
+    json.field("last_success_ms", apiUploader.getLastUploadTime());
+    json.field("last_success_epoch", _storage->getLastSuccessEpoch());
+    json.field("last_attempt_ms", apiUploader.getLastAttemptTime());
+    json.field("last_error", apiUploader.getLastError());
+    json.field("force_pending", apiUploader.isForcePending());
+    json.field("retry_count", apiUploader.getRetryCount());
+    json.field("next_upload_ms", apiUploader.getTimeUntilNext());
+    json.field("total_bytes_uploaded", _storage->getTotalBytesUploaded());
+    if constexpr (FEATURE_MQTT_UPLOAD) {
+        const MqttSession& mqtt = apiUploader.getMqttSession();
+        json.field("transport", "mqtt");
+        json.beginObject("mqtt");
+        json.field("broker", apiUploader.getMqttLink().getHost());
+        json.field("port", apiUploader.getMqttLink().getPort());
+        json.field("state", mqtt.getStateString());
+        json.field("session_present", mqtt.wasSessionPresent());
+        json.field("in_flight", mqtt.getInFlight());
+        json.field("in_flight_records", mqtt.getInFlightRecords());
+        json.field("published", mqtt.getPublishedCount());
+        json.field("acked", mqtt.getAckedCount());
+        json.field("redelivered", mqtt.getRedeliveredCount());
+        json.field("connects", mqtt.getConnectCount());
+        json.field("bytes_sent", mqtt.getBytesSent());
+        json.field("last_error", mqtt.getLastError());
+        json.endObject();
+    } else {
+        json.field("transport", "https");
     }
+    json.endObject();
 
     // Deployment metadata
     if (_configManager) {
         ConfigManager::DeploymentConfig dep = _configManager->getDeploymentConfig();
-        doc["deployment"]["deploy_date"] = dep.deployDate;
-        doc["deployment"]["purchase_date"] = dep.purchaseDate;
-        doc["deployment"]["depth_cm"] = dep.depthCm;
+        json.beginObject("deployment");
+        json.field("deploy_date", dep.deployDate);
+        json.field("purchase_date", dep.purchaseDate);
+        json.field("depth_cm", dep.depthCm);
+        json.endObject();
     }
 
-    String json;
-    serializeJson(doc, json);
-    sendJSON(json);
+    json.endObject();
+    json.end();
 }
 
 void SeaSenseWebServer::handleApiEnvironment() {
     extern NMEA2000Environment n2kEnv;
     extern BNO085Module imu;
-    extern NMEA2000GPS n2kGPS;
     extern bool activeGPSHasValidFix();
+    extern bool activeGPSIsN2K();
     extern GPSData activeGPSGetData();
     extern unsigned long activeGPSGetAgeMs();
 
-    N2kEnvironmentData env = n2kEnv.getSnapshot();
-    IMUData imuData = imu.getSnapshot();
-    JsonDocument doc;
-    doc["has_any"] = n2kEnv.hasAnyData() || imu.isInitialized();
+    // Compiled-out sources read as never seen (NaN values, ULONG_MAX ages)
+    N2kEnvironmentData env;
+    IMUData imuData;
+    bool n2kAny = false;
+    bool imuDetected = false;
+    unsigned long windAge = ULONG_MAX, waterAge = ULONG_MAX, atmoAge = ULONG_MAX;
+    unsigned long navAge = ULONG_MAX, n2kAttAge = ULONG_MAX;
+    unsigned long oriAge = ULONG_MAX, accelAge = ULONG_MAX;
+    if constexpr (FEATURE_N2K) {
+        env = n2kEnv.getSnapshot();
+        n2kAny = n2kEnv.hasAnyData();
+        windAge = n2kEnv.getWindAgeMs();
+        waterAge = n2kEnv.getWaterAgeMs();
+        atmoAge = n2kEnv.getAtmoAgeMs();
+        navAge = n2kEnv.getNavAgeMs();
+        n2kAttAge = n2kEnv.getAttitudeAgeMs();
+    }
+    if constexpr (FEATURE_IMU) {
+        imuData = imu.getSnapshot();
+        imuDetected = imu.isInitialized();
+        oriAge = imu.getOrientationAgeMs();
+        accelAge = imu.getAccelAgeMs();
+    }
+
+    // Derived at write time (latest inputs from loop())
+    extern DerivedVariables derivedVars;
+    float doSat = derivedVars.get(DerivedVar::DO_SATURATION);
+    float o2Sol = derivedVars.get(DerivedVar::O2_SOLUBILITY);
+    float sos = derivedVars.get(DerivedVar::SOUND_SPEED);
+    float tws = derivedVars.get(DerivedVar::TRUE_WIND_SPEED);
+    float twa = derivedVars.get(DerivedVar::TRUE_WIND_ANGLE);
+
+    JsonStream json = beginJSON();
+    json.beginObject();
+    json.field("has_any", n2kAny || imuDetected);
 
     // GPS source
-    JsonObject gps = doc["gps"].to<JsonObject>();
-    gps["has_fix"] = activeGPSHasValidFix();
-    gps["source"] = n2kGPS.hasValidFix() ? "N2K" : "NEO";
+    json.beginObject("gps");
+    json.field("has_fix", activeGPSHasValidFix());
+    json.field("source", activeGPSIsN2K() ? "N2K" : "NEO");
     unsigned long gpsAge = activeGPSGetAgeMs();
-    if (gpsAge != ULONG_MAX) gps["age_ms"] = gpsAge;
+    if (gpsAge != ULONG_MAX) json.field("age_ms", gpsAge);
     if (activeGPSHasValidFix()) {
         GPSData gd = activeGPSGetData();
-        gps["satellites"] = gd.satellites;
-        gps["hdop"] = serialized(String(gd.hdop, 1));
+        json.field("satellites", gd.satellites);
+        json.field("hdop", gd.hdop, 1);
     }
+    json.endObject();
 
     // Wind (always N2K)
-    JsonObject wind = doc["wind"].to<JsonObject>();
-    wind["source"] = "N2K";
-    unsigned long windAge = n2kEnv.getWindAgeMs();
-    if (windAge != ULONG_MAX) wind["age_ms"] = windAge;
-    if (!isnan(env.windSpeedTrue))     wind["speed_true"] = serialized(String(env.windSpeedTrue, 1));
-    if (!isnan(env.windAngleTrue))     wind["angle_true"] = serialized(String(env.windAngleTrue, 0));
-    if (!isnan(env.windSpeedApparent)) wind["speed_app"] = serialized(String(env.windSpeedApparent, 1));
-    if (!isnan(env.windAngleApparent)) wind["angle_app"] = serialized(String(env.windAngleApparent, 0));
+    json.beginObject("wind");
+    json.field("source", "N2K");
+    if (windAge != ULONG_MAX) json.field("age_ms", windAge);
+    if (!isnan(env.windSpeedTrue))     json.field("speed_true", env.windSpeedTrue, 1);
+    if (!isnan(env.windAngleTrue))     json.field("angle_true", env.windAngleTrue, 0);
+    if (!isnan(env.windSpeedApparent)) json.field("speed_app", env.windSpeedApparent, 1);
+    if (!isnan(env.windAngleApparent)) json.field("angle_app", env.windAngleApparent, 0);
+    json.endObject();
 
     // Water (always N2K)
-    JsonObject water = doc["water"].to<JsonObject>();
-    water["source"] = "N2K";
-    unsigned long waterAge = n2kEnv.getWaterAgeMs();
-    if (waterAge != ULONG_MAX) water["age_ms"] = waterAge;
-    if (!isnan(env.waterDepth))        water["depth"] = serialized(String(env.waterDepth, 1));
-    if (!isnan(env.speedThroughWater)) water["stw"] = serialized(String(env.speedThroughWater, 1));
-    if (!isnan(env.waterTempExternal)) water["temp_ext"] = serialized(String(env.waterTempExternal, 1));
+    json.beginObject("water");
+    json.field("source", "N2K");
+    if (waterAge != ULONG_MAX) json.field("age_ms", waterAge);
+    if (!isnan(env.waterDepth))        json.field("depth", env.waterDepth, 1);
+    if (!isnan(env.speedThroughWater)) json.field("stw", env.speedThroughWater, 1);
+    if (!isnan(env.waterTempExternal)) json.field("temp_ext", env.waterTempExternal, 1);
+    json.endObject();
 
     // Atmosphere (always N2K)
-    JsonObject atmo = doc["atmosphere"].to<JsonObject>();
-    atmo["source"] = "N2K";
-    unsigned long atmoAge = n2kEnv.getAtmoAgeMs();
-    if (atmoAge != ULONG_MAX) atmo["age_ms"] = atmoAge;
-    if (!isnan(env.airTemp))      atmo["air_temp"] = serialized(String(env.airTemp, 1));
-    if (!isnan(env.baroPressure)) atmo["pressure_hpa"] = serialized(String(env.baroPressure / 100.0f, 1));
-    if (!isnan(env.humidity))     atmo["humidity"] = serialized(String(env.humidity, 0));
+    json.beginObject("atmosphere");
+    json.field("source", "N2K");
+    if (atmoAge != ULONG_MAX) json.field("age_ms", atmoAge);
+    if (!isnan(env.airTemp))      json.field("air_temp", env.airTemp, 1);
+    if (!isnan(env.baroPressure)) json.field("pressure_hpa", env.baroPressure / 100.0f, 1);
+    if (!isnan(env.humidity))     json.field("humidity", env.humidity, 0);
+    json.endObject();
 
     // Navigation (always N2K)
-    JsonObject nav = doc["navigation"].to<JsonObject>();
-    nav["source"] = "N2K";
-    unsigned long navAge = n2kEnv.getNavAgeMs();
-    if (navAge != ULONG_MAX) nav["age_ms"] = navAge;
-    if (!isnan(env.cogTrue)) nav["cog"] = serialized(String(env.cogTrue, 0));
-    if (!isnan(env.sog))    nav["sog"] = serialized(String(env.sog, 1));
-    if (!isnan(env.heading)) nav["heading"] = serialized(String(env.heading, 0));
+    json.beginObject("navigation");
+    json.field("source", "N2K");
+    if (navAge != ULONG_MAX) json.field("age_ms", navAge);
+    if (!isnan(env.cogTrue)) json.field("cog", env.cogTrue, 0);
+    if (!isnan(env.sog))     json.field("sog", env.sog, 1);
+    if (!isnan(env.heading)) json.field("heading", env.heading, 0);
+    json.endObject();
 
     // Attitude — IMU overrides N2K for pitch/roll; heading: N2K preferred, IMU fallback
-    JsonObject att = doc["attitude"].to<JsonObject>();
+    json.beginObject("attitude");
     bool imuHasPR = imuData.hasOrientation && (!isnan(imuData.pitch) || !isnan(imuData.roll));
     bool n2kHasHeading = !isnan(env.heading);
     bool imuHasHeading = imuData.hasOrientation && !isnan(imuData.heading);
-    att["pitch_source"] = imuHasPR ? "IMU" : "N2K";
-    att["roll_source"] = imuHasPR ? "IMU" : "N2K";
-    att["heading_source"] = n2kHasHeading ? "N2K" : (imuHasHeading ? "IMU" : "N2K");
+    json.field("pitch_source", imuHasPR ? "IMU" : "N2K");
+    json.field("roll_source", imuHasPR ? "IMU" : "N2K");
+    json.field("heading_source", n2kHasHeading ? "N2K" : (imuHasHeading ? "IMU" : "N2K"));
     // Age: use IMU age for pitch/roll if IMU active, N2K attitude age otherwise
-    unsigned long attAge = imuHasPR ? imu.getOrientationAgeMs() : n2kEnv.getAttitudeAgeMs();
-    if (attAge != ULONG_MAX) att["age_ms"] = attAge;
-    // Use IMU pitch/roll if available, else N2K
-    att["pitch"] = serialized(String(imuHasPR && !isnan(imuData.pitch) ? imuData.pitch : env.pitch, 1));
-    att["roll"] = serialized(String(imuHasPR && !isnan(imuData.roll) ? imuData.roll : env.roll, 1));
+    unsigned long attAge = imuHasPR ? oriAge : n2kAttAge;
+    if (attAge != ULONG_MAX) json.field("age_ms", attAge);
+    // Use IMU pitch/roll if available, else N2K (null if neither has one)
+    json.field("pitch", imuHasPR && !isnan(imuData.pitch) ? imuData.pitch : env.pitch, 1);
+    json.field("roll", imuHasPR && !isnan(imuData.roll) ? imuData.roll : env.roll, 1);
     // Heading: N2K preferred, IMU fallback
     float headingVal = n2kHasHeading ? env.heading : (imuHasHeading ? imuData.heading : NAN);
-    if (!isnan(headingVal)) att["heading"] = serialized(String(headingVal, 0));
+    if (!isnan(headingVal)) json.field("heading", headingVal, 0);
+    json.endObject();
 
     // IMU details (BNO085)
-    JsonObject imuObj = doc["imu"].to<JsonObject>();
-    imuObj["detected"] = imu.isInitialized();
-    if (imu.isInitialized()) {
-        unsigned long oriAge = imu.getOrientationAgeMs();
-        if (oriAge != ULONG_MAX) imuObj["orient_age_ms"] = oriAge;
-        if (!isnan(imuData.pitch))   imuObj["pitch"] = serialized(String(imuData.pitch, 1));
-        if (!isnan(imuData.roll))    imuObj["roll"] = serialized(String(imuData.roll, 1));
-        if (!isnan(imuData.heading)) imuObj["heading"] = serialized(String(imuData.heading, 0));
+    json.beginObject("imu");
+    json.field("detected", imuDetected);
+    if (imuDetected) {
+        if (oriAge != ULONG_MAX) json.field("orient_age_ms", oriAge);
+        if (!isnan(imuData.pitch))   json.field("pitch", imuData.pitch, 1);
+        if (!isnan(imuData.roll))    json.field("roll", imuData.roll, 1);
+        if (!isnan(imuData.heading)) json.field("heading", imuData.heading, 0);
         if (imuData.hasLinAccel) {
-            unsigned long accelAge = imu.getAccelAgeMs();
-            if (accelAge != ULONG_MAX) imuObj["accel_age_ms"] = accelAge;
-            imuObj["accel_x"] = serialized(String(imuData.linAccelX, 2));
-            imuObj["accel_y"] = serialized(String(imuData.linAccelY, 2));
-            imuObj["accel_z"] = serialized(String(imuData.linAccelZ, 2));
+            if (accelAge != ULONG_MAX) json.field("accel_age_ms", accelAge);
+            json.field("accel_x", imuData.linAccelX, 2);
+            json.field("accel_y", imuData.linAccelY, 2);
+            json.field("accel_z", imuData.linAccelZ, 2);
         }
     }
-
-    String json;
-    serializeJson(doc, json);
-    sendJSON(json);
+    json.endObject();
+
+    json.beginObject("derived");
+    if (!isnan(doSat)) json.field("do_saturation", doSat, 1);
+    if (!isnan(o2Sol)) json.field("o2_solubility", o2Sol, 2);
+    if (!isnan(sos))   json.field("sound_speed", sos, 1);
+    if (!isnan(tws))   json.field("true_wind_speed", tws, 1);
+    if (!isnan(twa))   json.field("true_wind_angle", twa, 0);
+    json.field("computed", derivedVars.getComputeCount());
+    json.field("skipped", derivedVars.getSkipCount());
+    json.endObject();
+
+    json.endObject();
+    json.end();
 }
 
 void SeaSenseWebServer::handleApiPumpStatus() {
@@ -3587,6 +4339,102 @@ void SeaSenseWebServer::sendJSON(const String& json, int statusCode) {
     _server->send(statusCode, "application/json; charset=utf-8", json);
 }
 
+JsonStream SeaSenseWebServer::beginJSON(int statusCode) {
+    _responseStatus = statusCode;
+    _responseStarted = false;
+    return JsonStream([this](const char* data, size_t len, bool last) {
+        writeJSON(data, len, last);
+    });
+}
+
+void SeaSenseWebServer::writeJSON(const char* data, size_t len, bool last) {
+    static const char* CONTENT_TYPE = "application/json; charset=utf-8";
+
+    if (!_responseStarted) {
+        _responseStarted = true;
+        _httpStats.streamed++;
+
+        // Whole document in one buffer: not worth a gzip header and trailer
+        if (last) {
+            _server->send_P(_responseStatus, CONTENT_TYPE, data, len);
+            return;
+        }
+
+        _server->setContentLength(CONTENT_LENGTH_UNKNOWN);
+        _responseSendUs = 0;
+        _responseCpuUs = 0;
+        bool gzip = WEB_GZIP_ENABLED && acceptsGzip() &&
+            _gzip.begin([this](const uint8_t* out, size_t n) {
+                unsigned long t0 = micros();
+                _server->sendContent((const char*)out, n);
+                _responseSendUs += micros() - t0;
+                return true;
+            });
+        if (gzip) {
+            _server->sendHeader("Content-Encoding", "gzip");
+            _server->sendHeader("Vary", "Accept-Encoding");
+        }
+        _server->send(_responseStatus, CONTENT_TYPE, "");
+    }
+
+    if (!_gzip.isActive()) {
+        if (len > 0) {
+            _server->sendContent(data, len);
+        }
+        if (last) {
+            _server->sendContent("", 0);    // End chunked transfer
+        }
+        return;
+    }
+
+    unsigned long t0 = micros();
+    unsigned long sendBefore = _responseSendUs;
+    _gzip.feed((const uint8_t*)data, len);
+    if (last) {
+        _gzip.finish();
+    }
+    _responseCpuUs += (micros() - t0) - (_responseSendUs - sendBefore);
+
+    if (last) {
+        _server->sendContent("", 0);
+        _httpStats.gzipped++;
+        _httpStats.lastInBytes = _gzip.getInputBytes();
+        _httpStats.lastOutBytes = _gzip.getOutputBytes();
+        _httpStats.gzipInBytes += _httpStats.lastInBytes;
+        _httpStats.gzipOutBytes += _httpStats.lastOutBytes;
+        _httpStats.lastCpuUs = _responseCpuUs;
+        _httpStats.gzipCpuUs += _responseCpuUs;
+        LOG_DEBUG("WEB", "%s gzip %u -> %u bytes, %u us", _server->uri(),
+                  (unsigned)_httpStats.lastInBytes, (unsigned)_httpStats.lastOutBytes,
+                  (unsigned)_httpStats.lastCpuUs);
+        _gzip.end();
+    }
+}
+
+bool SeaSenseWebServer::acceptsGzip() const {
+    String encodings = _server->header("Accept-Encoding");
+    encodings.toLowerCase();
+    encodings.replace(" ", "");
+
+    // Comma-separated codings with an optional ";q=<weight>"; a weight of
+    // zero ("0", "0.0", "0.000") is an explicit refusal
+    int start = 0;
+    while (start < (int)encodings.length()) {
+        int end = encodings.indexOf(',', start);
+        if (end < 0) {
+            end = encodings.length();
+        }
+        String coding = encodings.substring(start, end);
+        int semi = coding.indexOf(';');
+        if ((semi < 0 ? coding : coding.substring(0, semi)) == "gzip") {
+            int q = semi < 0 ? -1 : coding.indexOf("q=", semi);
+            return q < 0 || atof(coding.c_str() + q + 2) > 0.0;
+        }
+        start = end + 1;
+    }
+    return false;
+}
+
 void SeaSenseWebServer::sendError(const String& message, int statusCode) {
     JsonDocument doc;
     doc["error"] = message;
@@ -3777,6 +4625,7 @@ void SeaSenseWebServer::handleApiFactoryReset() {
     ESP.restart();
 }
 
+#if FEATURE_OTA
 // ============================================================================
 // OTA API Handlers
 // ============================================================================
@@ -3792,6 +4641,18 @@ void SeaSenseWebServer::handleApiOtaStatus() {
     }
     json += "\",\"progress\":";
     json += String(_otaManager.getProgress());
+    json += ",\"format\":\"";
+    json += _otaManager.getImageFormat();
+    json += "\",\"bytesReceived\":";
+    json += String((unsigned long)_otaManager.getBytesReceived());
+    json += ",\"transferSize\":";
+    json += String((unsigned long)_otaManager.getTransferSize());
+    json += ",\"bytesFlashed\":";
+    json += String((unsigned long)_otaManager.getBytesFlashed());
+    json += ",\"throughputBps\":";
+    json += String((unsigned long)_otaManager.getThroughputBps());
+    json += ",\"resumes\":";
+    json += String(_otaManager.getResumeCount());
     json += ",\"maxSize\":";
     json += String((unsigned long)_otaManager.getMaxFirmwareSize());
     json += ",\"error\":\"";
@@ -3814,6 +4675,8 @@ void SeaSenseWebServer::handleApiOtaCheck() {
     json += info.version;
     json += "\",\"url\":\"";
     json += info.url;
+    json += "\",\"fallbackUrl\":\"";
+    json += info.fallbackUrl;
     json += "\",\"currentVersion\":\"";
     json += FIRMWARE_VERSION;
     json += "\"}";
@@ -3849,11 +4712,18 @@ void SeaSenseWebServer::handleApiOtaInstall() {
         return;
     }
 
-    // Start OTA in a non-blocking way — respond first, then download
-    sendJSON("{\"success\":true,\"message\":\"Starting update...\"}");
+    if (_otaManager.isBackgroundRunning() || OTAManager::isUpdateInProgress()) {
+        sendError("Another update is already in progress", 409);
+        return;
+    }
 
-    if (_otaManager.updateFromUrl(url)) {
-        delay(1000);
-        ESP.restart();
+    // Download runs in its own task; poll /api/ota/status for progress.
+    // loop() restarts the device once the image is flashed.
+    String fallbackUrl = doc["fallbackUrl"] | "";
+    if (!_otaManager.startUpdateFromUrl(url, fallbackUrl)) {
+        sendError(_otaManager.getErrorMessage(), 409);
+        return;
     }
+    sendJSON("{\"success\":true,\"message\":\"Update started in background\"}");
 }
+#endif // FEATURE_OTA
@@ -19,6 +19,9 @@
 #include "../calibration/CalibrationManager.h"
 #include "../pump/PumpController.h"
 #include "../ota/OTAManager.h"
+#include "JsonStream.h"
+#include "GzipDeflater.h"
+#include "../../config/hardware_config.h"
 
 // Forward declarations
 class EZO_RTD;
@@ -83,7 +86,30 @@ public:
      */
     void checkWiFiReconnect();
 
+    /**
+     * Recovery requests from loop() (Core 1). Carried out by the web task on
+     * its next checkWiFiReconnect() so all WiFi calls stay on Core 0.
+     */
+    void requestStationReset() { _wifiRecoveryRequest = WIFI_RECOVERY_RESET; }
+    void requestWiFiRestart() { _wifiRecoveryRequest = WIFI_RECOVERY_RESTART; }
+
+    /**
+     * Pause or resume station reconnect attempts (AP stays up)
+     */
+    void setStationEnabled(bool enabled) { _stationEnabled = enabled; }
+
+    /**
+     * True once the web task has seen station credentials
+     */
+    bool isStationConfigured() const { return _stationConfigured; }
+
 private:
+    enum : uint8_t {
+        WIFI_RECOVERY_NONE = 0,
+        WIFI_RECOVERY_RESET = 1,    // disconnect + begin, skipping the rate limit
+        WIFI_RECOVERY_RESTART = 2   // radio off, then AP and station from scratch
+    };
+
     // Sensors
     EZO_RTD* _tempSensor;
     EZO_EC* _ecSensor;
@@ -102,19 +128,46 @@ private:
     // Configuration
     ConfigManager* _configManager;
 
+#if FEATURE_OTA
     // OTA
     OTAManager _otaManager;
+    bool _otaUploadActive = false;      // a manual upload holds the update claim
+    String _otaUploadError;             // manual upload refused at start (409)
+#endif
 
     // WiFi
     String _apSSID;
     IPAddress _apIP;
     bool _stationConnected;
     unsigned long _lastReconnectAttempt;
+    volatile uint8_t _wifiRecoveryRequest;  // set on Core 1, consumed on Core 0
+    volatile bool _stationEnabled;
+    volatile bool _stationConfigured;
 
     // Web server
     WebServer* _server;
     DNSServer* _dnsServer;
 
+    // Streamed JSON response in progress (one request at a time)
+    GzipDeflater _gzip;
+    int _responseStatus;
+    bool _responseStarted;
+    unsigned long _responseSendUs;      // time spent in sendContent() while compressing
+    unsigned long _responseCpuUs;       // time spent compressing
+
+    // Response compression totals, reported in /api/status
+    struct HttpStats {
+        uint32_t streamed;              // beginJSON() responses
+        uint32_t gzipped;
+        uint64_t gzipInBytes;
+        uint64_t gzipOutBytes;
+        uint64_t gzipCpuUs;             // compressor time, excluding the network
+        uint32_t lastInBytes;
+        uint32_t lastOutBytes;
+        uint32_t lastCpuUs;
+    };
+    HttpStats _httpStats;
+
     // ========================================================================
     // WiFi Setup
     // ========================================================================
@@ -149,10 +202,16 @@ private:
     void handleSettings();
     void handleNotFound();
 
+    // Offline web app (shared sync script, service worker, manifest)
+    void handleSyncScript();
+    void handleServiceWorker();
+    void handleManifest();
+
     // API - Sensors
     void handleApiSensors();
     void handleApiSensorReading();
     void handleApiSensorRead();
+    void handleApiSensorsLive();
 
     // API - Calibration
     void handleApiCalibrate();
@@ -165,6 +224,7 @@ private:
     void handleApiDataDownload();
     void handleApiDataClear();
     void handleApiDataRecords();
+    void handleApiDataChanges();
 
     // API - Upload control
     void handleApiUploadForce();
@@ -178,6 +238,10 @@ private:
     // API - System
     void handleApiStatus();
 
+    // API - Event log
+    void handleApiLogs();
+    void handleApiLogsLevel();
+
     // API - Environment (NMEA2000)
     void handleApiEnvironment();
 
@@ -190,11 +254,13 @@ private:
     // API - Measurement mode
     void handleApiMeasurement();
 
+#if FEATURE_OTA
     // API - OTA
     void handleApiOtaUpload();
     void handleApiOtaStatus();
     void handleApiOtaCheck();
     void handleApiOtaInstall();
+#endif
 
     // API - System
     void handleApiSystemRestart();
@@ -213,6 +279,49 @@ private:
      */
     void sendJSON(const String& json, int statusCode = 200);
 
+    /**
+     * Start a chunked JSON response and return a writer into it
+     * Call end() on the writer when the document is complete.
+     * @param statusCode HTTP status code
+     */
+    JsonStream beginJSON(int statusCode = 200);
+
+    /**
+     * JsonStream sink: sends the headers on the first call, then the body
+     * Output that fits in one buffer goes out plain with a Content-Length;
+     * anything longer is chunked, and gzipped if the client accepts it.
+     */
+    void writeJSON(const char* data, size_t len, bool last);
+
+    /**
+     * True if the request's Accept-Encoding allows gzip
+     */
+    bool acceptsGzip() const;
+
+    /**
+     * Make sure the probe readings are fresh: share a recent acquisition,
+     * or take the I2C bus and read (joining one that finished meanwhile)
+     * @param coalesced Set true if no bus read was done for this request
+     * @return false if the bus stayed busy
+     */
+    bool acquireSensorReadings(bool& coalesced);
+
+    /**
+     * Write a calibration session's fields into the current object
+     */
+    void writeCalibrationState(JsonStream& json, const CalibrationState& state);
+
+    /**
+     * Write one probe's reading into the live-readings object
+     */
+    template <typename Probe>
+    void writeLiveReading(JsonStream& json, Probe* probe, uint8_t okMask);
+
+    /**
+     * Write a stored record as an object (the /api/data/records fields)
+     */
+    void writeDataRecord(JsonStream& json, const DataRecord& rec);
+
     /**
      * Send error JSON response
      * @param message Error message
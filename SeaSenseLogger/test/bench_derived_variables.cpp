@@ -0,0 +1,94 @@
+/**
+ * Host benchmark for DerivedVariables
+ *
+ * Times the write-path cost per record: a full measurement cycle as loop()
+ * runs it (four records, sensor inputs changing), records whose inputs
+ * didn't change, and each formula on its own.
+ *
+ * Build: make bench
+ * Run:   build/bench_derived_variables [iterations]
+ */
+
+#include <Arduino.h>
+#include <chrono>
+
+#include "../src/sensors/DerivedVariables.h"
+#include "../src/storage/StorageInterface.h"
+
+typedef std::chrono::steady_clock Clock;
+
+static volatile float g_sink;
+
+template <typename Fn>
+static double nsPerCall(uint32_t iterations, Fn fn) {
+    Clock::time_point t0 = Clock::now();
+    for (uint32_t i = 0; i < iterations; i++) {
+        fn(i);
+    }
+    return std::chrono::duration<double, std::nano>(Clock::now() - t0).count() / iterations;
+}
+
+static DataRecord makeRecord() {
+    SensorData data;
+    data.sensorInstance = 0;
+    data.value = 0.0f;
+    data.quality = SensorQuality::GOOD;
+    data.timestamp = 0;
+    DataRecord r = sensorDataToRecord(data);
+    r.windSpeedApparent = 12.0f;
+    r.windAngleApparent = 40.0f;
+    r.baroPressure = 101200.0f;
+    r.sog = 3.0f;
+    r.cogTrue = 85.0f;
+    r.heading = 80.0f;
+    return r;
+}
+
+int main(int argc, char** argv) {
+    uint32_t iterations = argc > 1 ? strtoul(argv[1], nullptr, 10) : 1000000;
+    DerivedVariables dv;
+    DataRecord rec = makeRecord();
+
+    printf("=== DerivedVariables (%u iterations) ===\n", iterations);
+
+    // One loop() cycle: T, then EC (salinity), pH, DO, one record after each
+    double cycle = nsPerCall(iterations, [&](uint32_t i) {
+        unsigned long now = i * 60000UL;
+        float jitter = (float)(i % 100) * 0.001f;
+        dv.setInput(DerivedVar::TEMPERATURE, 18.0f + jitter, now);
+        dv.apply(rec, now);
+        dv.setInput(DerivedVar::SALINITY, 35.0f - jitter, now);
+        dv.apply(rec, now);
+        dv.apply(rec, now);
+        dv.setInput(DerivedVar::DISSOLVED_OXYGEN, 7.5f + jitter, now);
+        dv.apply(rec, now);
+        g_sink = rec.doSaturation;
+    });
+    printf("cycle (4 records, inputs changing):   %8.1f ns/cycle  %6.1f ns/record\n", cycle, cycle / 4);
+
+    dv.setInput(DerivedVar::TEMPERATURE, 18.0f, 0);
+    dv.setInput(DerivedVar::SALINITY, 35.0f, 0);
+    dv.setInput(DerivedVar::DISSOLVED_OXYGEN, 7.5f, 0);
+    double unchanged = nsPerCall(iterations, [&](uint32_t) {
+        dv.apply(rec, 0);
+        g_sink = rec.soundSpeed;
+    });
+    printf("record, no input changed:             %8.1f ns/record\n", unchanged);
+
+    double sol = nsPerCall(iterations, [](uint32_t i) {
+        g_sink = DerivedVariables::oxygenSolubility(10.0f + (i % 100) * 0.1f, 35.0f, 101325.0f);
+    });
+    double sos = nsPerCall(iterations, [](uint32_t i) {
+        g_sink = DerivedVariables::soundSpeed(10.0f + (i % 100) * 0.1f, 35.0f, 0.5f);
+    });
+    double tw = nsPerCall(iterations, [](uint32_t i) {
+        float tws, twa;
+        DerivedVariables::trueWind(12.0f, (float)(i % 360), 3.0f, 85.0f, 80.0f, tws, twa);
+        g_sink = tws;
+    });
+    printf("oxygenSolubility:                     %8.1f ns\n", sol);
+    printf("soundSpeed:                           %8.1f ns\n", sos);
+    printf("trueWind:                             %8.1f ns\n", tw);
+    printf("computed %u nodes, skipped %u\n", dv.getComputeCount(), dv.getSkipCount());
+    return 0;
+}
@@ -0,0 +1,62 @@
+/**
+ * Host benchmark for EventLog
+ *
+ * Times the producer side as loop() sees it: a filtered-out call, a
+ * numeric event, an event with a copied String, and the deferred format
+ * the drain task pays instead. Host numbers exclude the spinlock, which
+ * costs tens of ns more on the ESP32.
+ *
+ * Build: make bench
+ * Run:   build/bench_event_log [iterations]
+ */
+
+#include <Arduino.h>
+#include <chrono>
+
+#include "../src/system/EventLog.h"
+
+EventLog eventLog;
+
+typedef std::chrono::steady_clock Clock;
+
+static volatile size_t g_sink;
+
+template <typename Fn>
+static double nsPerCall(uint32_t iterations, Fn fn) {
+    Clock::time_point t0 = Clock::now();
+    for (uint32_t i = 0; i < iterations; i++) {
+        fn(i);
+    }
+    return std::chrono::duration<double, std::nano>(Clock::now() - t0).count() / iterations;
+}
+
+int main(int argc, char** argv) {
+    uint32_t iterations = argc > 1 ? strtoul(argv[1], nullptr, 10) : 1000000;
+    String status = "NOT_CAL";
+
+    printf("=== EventLog (%u iterations) ===\n", iterations);
+
+    double filtered = nsPerCall(iterations, [](uint32_t i) {
+        LOG_DEBUG("SENSOR", "Temperature: %.2f C", (float)i * 0.01f);
+    });
+    double numeric = nsPerCall(iterations, [](uint32_t i) {
+        LOG_INFO("GPS", "%.6f, %.6f (%d sats, HDOP: %.1f)", 52.1f, 4.3f, (int)(i % 12), 1.1f);
+    });
+    double withText = nsPerCall(iterations, [&](uint32_t i) {
+        LOG_INFO("SENSOR", "Temperature: %.2f %s [%s]", (float)i * 0.01f, "C", status);
+    });
+
+    LogEntry entry;
+    uint32_t next;
+    eventLog.query(0, LogLevel::DEBUG, nullptr, &entry, 1, next);
+    char line[LOG_LINE_BYTES];
+    double format = nsPerCall(iterations, [&](uint32_t) {
+        g_sink = EventLog::format(entry, line, sizeof(line));
+    });
+
+    printf("LOG_DEBUG, filtered out:              %8.1f ns\n", filtered);
+    printf("LOG_INFO, 4 numbers:                  %8.1f ns\n", numeric);
+    printf("LOG_INFO, number + 2 strings:         %8.1f ns\n", withText);
+    printf("format (drain task):                  %8.1f ns\n", format);
+    return 0;
+}
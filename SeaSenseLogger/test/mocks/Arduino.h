@@ -1,9 +1,11 @@
 #ifndef MOCK_ARDUINO_H
 #define MOCK_ARDUINO_H
 
+#include <climits>
 #include <cstdint>
 #include <cstddef>
 #include <cmath>
+#include <math.h>         // the core's Arduino.h has it: isnan() etc. unqualified
 #include <cstring>
 #include <string>
 #include <cstdio>
@@ -108,6 +110,7 @@ public:
     char operator[](unsigned int idx) const { return _str[idx]; }
 
     unsigned int length() const { return (unsigned int)_str.length(); }
+    bool reserve(unsigned int size) { _str.reserve(size); return true; }
     bool isEmpty() const { return _str.empty(); }
     const char* c_str() const { return _str.c_str(); }
 
@@ -196,6 +199,7 @@ struct MockSerial {
     void print(unsigned long) {}
     void print(float) {}
     void print(double) {}
+    void print(double, int) {}
     void println(const char*) {}
     void println(const String&) {}
     void println(int) {}
@@ -204,12 +208,29 @@ struct MockSerial {
     void println(unsigned long) {}
     void println(float) {}
     void println(double) {}
+    void println(double, int) {}
     void println() {}
+    int printf(const char*, ...) { return 0; }
     void begin(unsigned long) {}
 };
 
 inline MockSerial Serial;
 
+// ============================================================================
+// HardwareSerial stub (GPS UART) — no data; replay feeds parsers directly
+// ============================================================================
+
+#define SERIAL_8N1 0x800001c
+
+class HardwareSerial {
+public:
+    explicit HardwareSerial(int uartNum) { (void)uartNum; }
+    void begin(unsigned long, uint32_t = SERIAL_8N1, int8_t = -1, int8_t = -1) {}
+    void end() {}
+    int available() { return 0; }
+    int read() { return -1; }
+};
+
 // ============================================================================
 // ESP mock (for ESP.getFreeHeap etc. — used by APIUploader)
 // ============================================================================
@@ -22,6 +22,9 @@ public:
     size_t write(const uint8_t* buf, size_t len) { (void)buf; return len; }
     size_t readBytes(char*, size_t) { return 0; }
     int peek() { return -1; }
+    size_t size() { return 0; }
+    size_t position() { return 0; }
+    bool seek(uint32_t) { return true; }
     void flush() {}
     void close() {}
 };
@@ -0,0 +1,38 @@
+#ifndef MOCK_N2KMESSAGES_H
+#define MOCK_N2KMESSAGES_H
+
+// NMEA2000 library PGN parsers stub — the types and signatures the sensor
+// sources use; nothing is decoded, so every parse reports failure
+
+#include "N2kMsg.h"
+
+enum tN2kGNSStype {
+    N2kGNSSt_GPS = 0,
+    N2kGNSSt_GLONASS = 1,
+    N2kGNSSt_GPSGLONASS = 2
+};
+
+enum tN2kGNSSmethod {
+    N2kGNSSm_noGNSS = 0,
+    N2kGNSSm_GNSSfix = 1,
+    N2kGNSSm_DGNSS = 2
+};
+
+enum tN2kTimeSource {
+    N2ktimes_GPS = 0,
+    N2ktimes_GLONASS = 1,
+    N2ktimes_LocalCesiumClock = 4
+};
+
+inline bool ParseN2kGNSS(const tN2kMsg&, unsigned char&, uint16_t&, double&,
+                         double&, double&, double&,
+                         tN2kGNSStype&, tN2kGNSSmethod&, unsigned char&,
+                         double&, double&, double&,
+                         unsigned char&, tN2kGNSStype&, uint16_t&, double&) { return false; }
+
+inline bool ParseN2kSystemTime(const tN2kMsg&, unsigned char&, uint16_t&, double&,
+                               tN2kTimeSource&) { return false; }
+
+inline bool ParseN2kPositionRapid(const tN2kMsg&, double&, double&) { return false; }
+
+#endif
@@ -0,0 +1,31 @@
+#ifndef MOCK_N2KMSG_H
+#define MOCK_N2KMSG_H
+
+// NMEA2000 library message stub — a received message and the "not
+// available" markers; payload decoding lives in the real library
+
+#include <cstdint>
+
+#define N2kDoubleNA (-1e9)
+#define N2kUInt8NA 0xff
+#define N2kUInt16NA 0xffff
+#define N2kUInt32NA 0xffffffffUL
+
+class tN2kMsg {
+public:
+    static const int MaxDataLen = 223;
+    unsigned char Priority = 6;
+    unsigned long PGN = 0;
+    unsigned char Source = 0;
+    unsigned char Destination = 0xff;
+    int DataLen = 0;
+    unsigned char Data[MaxDataLen] = {};
+    unsigned long MsgTime = 0;
+};
+
+inline bool N2kIsNA(double v) { return v == N2kDoubleNA; }
+inline bool N2kIsNA(uint8_t v) { return v == N2kUInt8NA; }
+inline bool N2kIsNA(uint16_t v) { return v == N2kUInt16NA; }
+inline bool N2kIsNA(uint32_t v) { return v == N2kUInt32NA; }
+
+#endif
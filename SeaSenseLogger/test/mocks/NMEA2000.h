@@ -0,0 +1,56 @@
+#ifndef MOCK_NMEA2000_H
+#define MOCK_NMEA2000_H
+
+// NMEA2000 library stub — the tNMEA2000 surface NMEA2000GPS drives.
+// Open() goes through CANOpen() like the library; no address claim runs,
+// so the source address stays at the one configured with SetMode().
+
+#include "N2kMsg.h"
+
+class tNMEA2000 {
+public:
+    enum tN2kMode {
+        N2km_ListenOnly,
+        N2km_NodeOnly,
+        N2km_ListenAndNode,
+        N2km_SendOnly,
+        N2km_ListenAndSend
+    };
+
+    virtual ~tNMEA2000() {}
+
+    void SetProductInformation(const char*, unsigned short = 0xffff, const char* = 0,
+                               const char* = 0, const char* = 0) {}
+    void SetDeviceInformation(unsigned long, unsigned char = 0xff, unsigned char = 0xff,
+                              uint16_t = 0xffff) {}
+    void SetMode(tN2kMode mode, unsigned long source = 15) {
+        _mode = mode;
+        _source = (uint8_t)source;
+    }
+    void ExtendTransmitMessages(const unsigned long*) {}
+    void ExtendReceiveMessages(const unsigned long*) {}
+    void EnableForward(bool) {}
+    void SetMsgHandler(void (*handler)(const tN2kMsg&)) { _handler = handler; }
+
+    bool Open() { return _open || (_open = CANOpen()); }
+    void ParseMessages() {
+        unsigned long id;
+        unsigned char len;
+        unsigned char buf[8];
+        while (_open && CANGetFrame(id, len, buf)) {}
+    }
+    uint8_t GetN2kSource() const { return _source; }
+
+protected:
+    virtual bool CANOpen() = 0;
+    virtual bool CANSendFrame(unsigned long id, unsigned char len,
+                              const unsigned char* buf, bool wait_sent = true) = 0;
+    virtual bool CANGetFrame(unsigned long& id, unsigned char& len, unsigned char* buf) = 0;
+
+    tN2kMode _mode = N2km_ListenOnly;
+    uint8_t _source = 254;
+    bool _open = false;
+    void (*_handler)(const tN2kMsg&) = nullptr;
+};
+
+#endif
@@ -9,6 +9,7 @@ public:
     void end() {}
     MockFile open(const char*, const char* = "r") { return MockFile(); }
     bool exists(const char*) { return false; }
+    bool mkdir(const char*) { return true; }
     bool remove(const char*) { return true; }
     bool rename(const char*, const char*) { return true; }
     uint64_t totalBytes() { return 0; }
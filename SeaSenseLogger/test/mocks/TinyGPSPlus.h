@@ -0,0 +1,174 @@
+#ifndef MOCK_TINYGPSPLUS_H
+#define MOCK_TINYGPSPLUS_H
+
+#include "Arduino.h"
+#include <cstdlib>
+#include <cstring>
+
+// Stand-in for TinyGPS++ in native tests: the same API GPSModule uses,
+// parsing $--GGA and $--RMC with checksum. Like the library, fields are
+// committed only when a sentence with a valid checksum completes, and
+// encode() returns true for those sentences.
+
+class TinyGPSLocation {
+public:
+    bool isValid() const { return _valid; }
+    unsigned long age() const { return _valid ? millis() - _updated : (unsigned long)-1; }
+    double lat() const { return _lat; }
+    double lng() const { return _lng; }
+    bool _valid = false;
+    unsigned long _updated = 0;
+    double _lat = 0, _lng = 0;
+};
+
+class TinyGPSDate {
+public:
+    bool isValid() const { return _valid; }
+    uint16_t year() const { return _year; }
+    uint8_t month() const { return _month; }
+    uint8_t day() const { return _day; }
+    bool _valid = false;
+    uint16_t _year = 0;
+    uint8_t _month = 0, _day = 0;
+};
+
+class TinyGPSTime {
+public:
+    bool isValid() const { return _valid; }
+    uint8_t hour() const { return _hour; }
+    uint8_t minute() const { return _minute; }
+    uint8_t second() const { return _second; }
+    bool _valid = false;
+    uint8_t _hour = 0, _minute = 0, _second = 0;
+};
+
+class TinyGPSAltitude {
+public:
+    double meters() const { return _meters; }
+    double _meters = 0;
+};
+
+class TinyGPSInteger {
+public:
+    uint32_t value() const { return _value; }
+    uint32_t _value = 0;
+};
+
+class TinyGPSHDOP {
+public:
+    double hdop() const { return _hdop; }
+    double _hdop = 0;
+};
+
+class TinyGPSPlus {
+public:
+    TinyGPSLocation location;
+    TinyGPSDate date;
+    TinyGPSTime time;
+    TinyGPSAltitude altitude;
+    TinyGPSInteger satellites;
+    TinyGPSHDOP hdop;
+
+    bool encode(char c) {
+        if (c == '$') {
+            _len = 0;
+            _inSentence = true;
+            return false;
+        }
+        if (!_inSentence) {
+            return false;
+        }
+        if (c == '\r' || c == '\n') {
+            _inSentence = false;
+            _buf[_len] = '\0';
+            return commit();
+        }
+        if (_len + 1 < sizeof(_buf)) {
+            _buf[_len++] = c;
+        } else {
+            _inSentence = false;
+        }
+        return false;
+    }
+
+    uint32_t failedChecksum() const { return _failed; }
+
+private:
+    char _buf[100] = {};
+    size_t _len = 0;
+    bool _inSentence = false;
+    uint32_t _failed = 0;
+
+    static double coordinate(const char* value, const char* hemi) {
+        double raw = atof(value);
+        int degrees = (int)(raw / 100);
+        double result = degrees + (raw - degrees * 100) / 60.0;
+        return (hemi[0] == 'S' || hemi[0] == 'W') ? -result : result;
+    }
+
+    void setTime(const char* t) {
+        if (strlen(t) < 6) return;
+        time._hour = (uint8_t)((t[0] - '0') * 10 + (t[1] - '0'));
+        time._minute = (uint8_t)((t[2] - '0') * 10 + (t[3] - '0'));
+        time._second = (uint8_t)((t[4] - '0') * 10 + (t[5] - '0'));
+        time._valid = true;
+    }
+
+    bool commit() {
+        char* star = strchr(_buf, '*');
+        if (!star) return false;
+        uint8_t sum = 0;
+        for (char* p = _buf; p < star; p++) sum ^= (uint8_t)*p;
+        if (strtoul(star + 1, nullptr, 16) != sum) {
+            _failed++;
+            return false;
+        }
+        *star = '\0';
+
+        // Split on commas, keeping empty fields
+        const char* f[20] = {};
+        int n = 0;
+        f[n++] = _buf;
+        for (char* p = _buf; *p && n < 20; p++) {
+            if (*p == ',') {
+                *p = '\0';
+                f[n++] = p + 1;
+            }
+        }
+        if (strlen(f[0]) != 5) return false;
+        const char* type = f[0] + 2;
+
+        if (strcmp(type, "GGA") == 0 && n >= 10) {
+            setTime(f[1]);
+            if (atoi(f[6]) > 0) {
+                location._lat = coordinate(f[2], f[3]);
+                location._lng = coordinate(f[4], f[5]);
+                location._valid = true;
+                location._updated = millis();
+            }
+            satellites._value = (uint32_t)atoi(f[7]);
+            hdop._hdop = atof(f[8]);
+            altitude._meters = atof(f[9]);
+            return true;
+        }
+        if (strcmp(type, "RMC") == 0 && n >= 10) {
+            setTime(f[1]);
+            if (f[2][0] == 'A') {
+                location._lat = coordinate(f[3], f[4]);
+                location._lng = coordinate(f[5], f[6]);
+                location._valid = true;
+                location._updated = millis();
+            }
+            if (strlen(f[9]) == 6) {
+                date._day = (uint8_t)((f[9][0] - '0') * 10 + (f[9][1] - '0'));
+                date._month = (uint8_t)((f[9][2] - '0') * 10 + (f[9][3] - '0'));
+                date._year = (uint16_t)(2000 + (f[9][4] - '0') * 10 + (f[9][5] - '0'));
+                date._valid = true;
+            }
+            return true;
+        }
+        return false;
+    }
+};
+
+#endif // MOCK_TINYGPSPLUS_H
@@ -0,0 +1,49 @@
+#ifndef MOCK_DRIVER_TWAI_H
+#define MOCK_DRIVER_TWAI_H
+
+// ESP-IDF TWAI (CAN) driver stub — the native build never opens the bus
+
+#include <cstdint>
+#include "esp_err.h"
+
+typedef int gpio_num_t;
+
+typedef enum {
+    TWAI_MODE_NORMAL,
+    TWAI_MODE_NO_ACK,
+    TWAI_MODE_LISTEN_ONLY
+} twai_mode_t;
+
+typedef struct {
+    twai_mode_t mode;
+    gpio_num_t tx_io;
+    gpio_num_t rx_io;
+    uint32_t tx_queue_len;
+    uint32_t rx_queue_len;
+} twai_general_config_t;
+
+typedef struct { uint32_t brp; } twai_timing_config_t;
+typedef struct { uint32_t acceptance_code; uint32_t acceptance_mask; } twai_filter_config_t;
+
+typedef struct {
+    uint32_t extd : 1;
+    uint32_t rtr : 1;
+    uint32_t identifier;
+    uint8_t data_length_code;
+    uint8_t data[8];
+} twai_message_t;
+
+#define TWAI_GENERAL_CONFIG_DEFAULT(tx, rx, op_mode) \
+    { (op_mode), (tx), (rx), 5, 5 }
+#define TWAI_TIMING_CONFIG_250KBITS() { 16 }
+#define TWAI_FILTER_CONFIG_ACCEPT_ALL() { 0, 0xFFFFFFFF }
+
+inline esp_err_t twai_driver_install(const twai_general_config_t*, const twai_timing_config_t*,
+                                     const twai_filter_config_t*) { return ESP_FAIL; }
+inline esp_err_t twai_driver_uninstall() { return ESP_OK; }
+inline esp_err_t twai_start() { return ESP_FAIL; }
+inline esp_err_t twai_stop() { return ESP_OK; }
+inline esp_err_t twai_transmit(const twai_message_t*, uint32_t) { return ESP_FAIL; }
+inline esp_err_t twai_receive(twai_message_t*, uint32_t) { return ESP_FAIL; }
+
+#endif
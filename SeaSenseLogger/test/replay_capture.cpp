@@ -0,0 +1,242 @@
+/**
+ * Host replay of an input capture (CAPTURE START on the device)
+ *
+ * Feeds a /capture/NNNN.ssc file through the firmware's own parsers —
+ * TinyGPS++ via GPSModule::feed(), the NMEA2000 library's fast-packet
+ * assembly and NMEA2000GPS/NMEA2000Environment handlers, and
+ * BNO085Module::ingestReport() — with millis() following the recorded
+ * timestamps. Reports parse throughput, per-PGN handler cost and
+ * periodic snapshots of what the logger would have seen.
+ *
+ * Build: make replay TINYGPS=<TinyGPSPlus/src> N2KLIB=<NMEA2000/src>
+ * Run:   build/replay_capture <file.ssc> [speed] [snapshot_s]
+ *        speed: 1..1000 x real time, 0 = as fast as possible (default)
+ */
+
+#include <Arduino.h>
+#include <NMEA2000.h>
+#include <N2kMessages.h>
+#include <TinyGPSPlus.h>
+
+#include <chrono>
+#include <deque>
+#include <fstream>
+#include <map>
+#include <thread>
+#include <vector>
+
+#define private public
+#include "../src/sensors/GPSModule.h"
+#include "../src/sensors/NMEA2000GPS.h"
+#include "../src/sensors/NMEA2000Environment.h"
+#include "../src/sensors/BNO085Module.h"
+#undef private
+
+#include "../src/replay/CaptureFormat.h"
+
+typedef std::chrono::steady_clock Clock;
+
+static double microsSince(Clock::time_point t0) {
+    return std::chrono::duration<double, std::micro>(Clock::now() - t0).count();
+}
+
+// ============================================================================
+// CAN bus fed from the capture instead of the TWAI driver
+// ============================================================================
+
+struct ReplayFrame {
+    unsigned long id;
+    unsigned char len;
+    unsigned char data[8];
+};
+
+class ReplayBus : public tNMEA2000 {
+public:
+    std::deque<ReplayFrame> frames;
+
+protected:
+    bool CANOpen() override { return true; }
+
+    bool CANSendFrame(unsigned long, unsigned char, const unsigned char*, bool) override {
+        return false;  // listen-only, as on a logger with output disabled
+    }
+
+    bool CANGetFrame(unsigned long& id, unsigned char& len, unsigned char* buf) override {
+        if (frames.empty()) return false;
+        const ReplayFrame& f = frames.front();
+        id = f.id;
+        len = f.len;
+        memcpy(buf, f.data, f.len);
+        frames.pop_front();
+        return true;
+    }
+};
+
+// ============================================================================
+// Replay state
+// ============================================================================
+
+struct PgnCost {
+    uint32_t count = 0;
+    double totalUs = 0;
+    double maxUs = 0;
+};
+
+static GPSModule gps(0, 0);
+static NMEA2000GPS n2kGPS;
+static NMEA2000Environment n2kEnv;
+static BNO085Module imu;
+static ReplayBus bus;
+static std::map<unsigned long, PgnCost> pgnCost;
+
+static void forwardToEnvironment(const tN2kMsg& msg) {
+    n2kEnv.handleMsg(msg);
+}
+
+// Same chain as the firmware: NMEA2000GPS first, which forwards to Environment
+static void timedHandler(const tN2kMsg& msg) {
+    Clock::time_point t0 = Clock::now();
+    n2kGPS.handleMsg(msg);
+    double us = microsSince(t0);
+    PgnCost& c = pgnCost[msg.PGN];
+    c.count++;
+    c.totalUs += us;
+    if (us > c.maxUs) c.maxUs = us;
+}
+
+static void printSnapshot(unsigned long captureMs) {
+    GPSData g = gps.getData();
+    GPSData n = n2kGPS.getData();
+    N2kEnvironmentData env = n2kEnv.getSnapshot();
+    IMUData m = imu.getSnapshot();
+
+    printf("t=%7.1fs  gps:%s", captureMs / 1000.0, g.valid ? "fix" : "---");
+    if (g.valid) printf(" %.5f,%.5f sats=%u", g.latitude, g.longitude, g.satellites);
+    printf("  n2k:%s", n.valid ? "fix" : "---");
+    if (n.valid) printf(" %.5f,%.5f", n.latitude, n.longitude);
+    if (env.hasWaterTempExternal) printf(" water=%.2fC", env.waterTempExternal);
+    if (env.hasDepth) printf(" depth=%.1fm", env.waterDepth);
+    if (env.hasWind) printf(" tws=%.1fm/s", env.windSpeedTrue);
+    if (m.hasOrientation) printf("  imu: p=%.1f r=%.1f", m.pitch, m.roll);
+    printf("\n");
+}
+
+int main(int argc, char** argv) {
+    if (argc < 2) {
+        fprintf(stderr, "usage: %s <file.ssc> [speed 0..1000] [snapshot_s]\n", argv[0]);
+        return 2;
+    }
+    double speed = argc > 2 ? atof(argv[2]) : 0.0;
+    if (speed < 0) speed = 0;
+    if (speed > 1000) speed = 1000;
+    unsigned long snapshotMs = (argc > 3 ? strtoul(argv[3], nullptr, 10) : 60) * 1000UL;
+
+    std::ifstream in(argv[1], std::ios::binary);
+    if (!in) {
+        fprintf(stderr, "cannot open %s\n", argv[1]);
+        return 1;
+    }
+    std::vector<uint8_t> file((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+
+    CaptureReader reader(file.data(), file.size());
+    if (!reader.begin()) {
+        fprintf(stderr, "%s: not a capture file (or unsupported version)\n", argv[1]);
+        return 1;
+    }
+
+    // Wire up the parsers the way setup() does, minus the hardware
+    bus.SetMode(tNMEA2000::N2km_ListenOnly);
+    bus.EnableForward(false);
+    const unsigned long rxPGNs[] = {129029L, 126992L, 129025L, 0};
+    bus.ExtendReceiveMessages(rxPGNs);
+    n2kEnv.begin(&bus);
+    n2kGPS.setMsgForwardCallback(forwardToEnvironment);
+    n2kGPS._n2k = &bus;
+    n2kGPS._initialized = true;
+    bus.SetMsgHandler(timedHandler);
+    bus.Open();
+    imu._initialized = true;
+
+    uint64_t gpsBytes = 0, canFrames = 0, imuReports = 0, records = 0;
+    double gpsUs = 0, canUs = 0, imuUs = 0;
+    unsigned long nextSnapshot = reader.getStartMs() + snapshotMs;
+    unsigned long lastMs = reader.getStartMs();
+    Clock::time_point wallStart = Clock::now();
+
+    CaptureRecord rec;
+    while (reader.next(rec)) {
+        records++;
+        lastMs = rec.timeMs;
+        _mock_millis = rec.timeMs;
+
+        if (speed > 0) {
+            std::chrono::duration<double, std::milli> due((rec.timeMs - reader.getStartMs()) / speed);
+            std::this_thread::sleep_until(wallStart + std::chrono::duration_cast<Clock::duration>(due));
+        }
+
+        Clock::time_point t0 = Clock::now();
+        switch (rec.type) {
+            case CaptureType::GPS_BYTES:
+                gps.feed(rec.payload, rec.length);
+                gpsUs += microsSince(t0);
+                gpsBytes += rec.length;
+                break;
+
+            case CaptureType::CAN_FRAME: {
+                ReplayFrame f;
+                uint32_t id;
+                if (!CaptureReader::decodeCanFrame(rec, id, f.data, f.len)) break;
+                f.id = id;
+                bus.frames.push_back(f);
+                n2kGPS.update();        // ParseMessages() -> timedHandler
+                canUs += microsSince(t0);
+                canFrames++;
+                break;
+            }
+
+            case CaptureType::IMU_REPORT: {
+                ImuReportKind kind;
+                float v[4];
+                if (!CaptureReader::decodeImuReport(rec, kind, v)) break;
+                imu.ingestReport(kind, v);
+                imuUs += microsSince(t0);
+                imuReports++;
+                break;
+            }
+
+            default:
+                break;  // newer record type: skip
+        }
+
+        if (snapshotMs > 0 && rec.timeMs >= nextSnapshot) {
+            printSnapshot(rec.timeMs - reader.getStartMs());
+            nextSnapshot += snapshotMs;
+        }
+    }
+
+    double wallS = microsSince(wallStart) / 1e6;
+    double captureS = (lastMs - reader.getStartMs()) / 1000.0;
+
+    printf("\n=== Replay summary ===\n");
+    printSnapshot(lastMs - reader.getStartMs());
+    printf("records: %llu  capture: %.1f s  wall: %.3f s  (%.0fx)\n",
+           (unsigned long long)records, captureS, wallS, wallS > 0 ? captureS / wallS : 0.0);
+    if (reader.isTruncated()) printf("capture ends mid-record (truncated)\n");
+    if (gpsBytes) printf("GPS:  %llu bytes, %.2f MB/s parse\n",
+                         (unsigned long long)gpsBytes, gpsBytes / gpsUs);
+    if (canFrames) printf("CAN:  %llu frames, %.0f frames/s parse\n",
+                          (unsigned long long)canFrames, canFrames / (canUs / 1e6));
+    if (imuReports) printf("IMU:  %llu reports, %.0f reports/s\n",
+                           (unsigned long long)imuReports, imuReports / (imuUs / 1e6));
+
+    if (!pgnCost.empty()) {
+        printf("\n%8s %10s %10s %10s\n", "PGN", "count", "mean us", "max us");
+        for (const auto& kv : pgnCost) {
+            printf("%8lu %10u %10.2f %10.2f\n", kv.first, kv.second.count,
+                   kv.second.totalUs / kv.second.count, kv.second.maxUs);
+        }
+    }
+
+    n2kGPS._n2k = nullptr;      // bus is not heap-allocated
+    return 0;
+}
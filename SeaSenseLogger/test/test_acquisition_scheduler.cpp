@@ -0,0 +1,174 @@
+/**
+ * Tests for AcquisitionScheduler — split-phase reads for parallel
+ * calibration sessions: all due channels are requested together, collected
+ * once the slowest module is ready, and a four-probe service is paced by
+ * the slowest probe rather than the sum of their read times
+ */
+
+#include <Arduino.h>
+#include "test_framework.h"
+
+#include "../src/calibration/AcquisitionScheduler.h"
+#include <vector>
+
+static const unsigned long INTERVAL = 500;
+
+// Records what the scheduler asked for
+struct Bus {
+    std::vector<int> requested;
+    std::vector<int> collected;
+    uint8_t failMask = 0;           // channels whose request fails
+
+    AcquisitionScheduler::RequestFn request() {
+        return [this](uint8_t ch) {
+            requested.push_back(ch);
+            return !(failMask & (1 << ch));
+        };
+    }
+    AcquisitionScheduler::CollectFn collect() {
+        return [this](uint8_t ch) { collected.push_back(ch); };
+    }
+};
+
+static void setup(AcquisitionScheduler& sched) {
+    sched.setResponseTime(0, 600);     // RTD
+    sched.setResponseTime(1, 600);     // EC
+    sched.setResponseTime(2, 900);     // pH
+    sched.setResponseTime(3, 600);     // DO
+}
+
+// Test: one batch requests every active channel and waits for the slowest
+void test_batch_waits_for_slowest() {
+    AcquisitionScheduler sched(INTERVAL);
+    setup(sched);
+    Bus bus;
+
+    sched.poll(1000, 0x0F, bus.request(), bus.collect());
+    ASSERT_EQ(4u, bus.requested.size());
+    ASSERT_TRUE(sched.isPending());
+    ASSERT_EQ(0x0F, sched.getPendingMask());
+
+    // The 600 ms modules are done, the pH module is not: nothing collected
+    sched.poll(1600, 0x0F, bus.request(), bus.collect());
+    ASSERT_EQ(0u, bus.collected.size());
+    ASSERT_EQ(4u, bus.requested.size());
+
+    sched.poll(1900, 0x0F, bus.request(), bus.collect());
+    ASSERT_EQ(4u, bus.collected.size());
+    ASSERT_FALSE(sched.isPending());
+    ASSERT_EQ(1u, sched.getBatchCount());
+    ASSERT_EQ(4u, sched.getSampleCount());
+
+    TEST_PASS();
+}
+
+// Test: four sessions sampled together cost the time of one
+void test_parallel_beats_sequential() {
+    AcquisitionScheduler sched(INTERVAL);
+    setup(sched);
+    Bus bus;
+
+    // Poll every 10 ms for 30 s, as loop() does while calibrating
+    for (unsigned long t = 0; t < 30000; t += 10) {
+        sched.poll(t, 0x0F, bus.request(), bus.collect());
+    }
+    uint32_t perChannel = sched.getSampleCount() / 4;
+
+    // Blocking reads one after another: 600 + 600 + 900 + 600 ms per round
+    uint32_t sequential = 30000 / 2700;
+    printf("    %u samples per probe in 30 s (sequential: %u)\n", perChannel, sequential);
+    // Paced by the slowest module (900 ms) plus poll granularity
+    ASSERT_TRUE(perChannel >= 30000 / (900 + 50));
+    ASSERT_TRUE(perChannel > 2 * sequential);
+    // Every batch carried all four probes
+    ASSERT_EQ(4 * sched.getBatchCount(), sched.getSampleCount() + (sched.isPending() ? 4 : 0));
+
+    TEST_PASS();
+}
+
+// Test: channels are spaced by the sample interval; fast modules are not
+// re-read more often than that
+void test_sample_interval() {
+    AcquisitionScheduler sched(2000);
+    sched.setResponseTime(0, 600);
+    Bus bus;
+
+    for (unsigned long t = 0; t <= 10000; t += 10) {
+        sched.poll(t, 0x01, bus.request(), bus.collect());
+    }
+    // t = 0, 2000, 4000, 6000, 8000, 10000
+    ASSERT_EQ(6u, bus.requested.size());
+
+    TEST_PASS();
+}
+
+// Test: a session started mid-batch joins the next one; a failed request
+// is not collected; a channel that goes inactive is still collected
+void test_join_fail_and_drain() {
+    AcquisitionScheduler sched(INTERVAL);
+    setup(sched);
+    Bus bus;
+
+    sched.poll(0, 0x01, bus.request(), bus.collect());
+    sched.poll(100, 0x03, bus.request(), bus.collect());    // EC starts mid-batch
+    ASSERT_EQ(1u, bus.requested.size());
+    sched.poll(600, 0x03, bus.request(), bus.collect());
+    ASSERT_EQ(1u, bus.collected.size());
+
+    // Next batch: both, EC's request fails
+    bus.failMask = 0x02;
+    sched.poll(700, 0x03, bus.request(), bus.collect());
+    ASSERT_EQ(3u, bus.requested.size());
+    ASSERT_EQ(0x01, sched.getPendingMask());
+
+    // Temperature cancelled meanwhile: its read is still collected
+    sched.poll(1300, 0x00, bus.request(), bus.collect());
+    ASSERT_EQ(2u, bus.collected.size());
+    ASSERT_EQ(0, bus.collected[1]);
+    ASSERT_FALSE(sched.isPending());
+
+    // A restarted channel is due at once
+    sched.resetChannel(0);
+    sched.poll(1310, 0x01, bus.request(), bus.collect());
+    ASSERT_EQ(4u, bus.requested.size());
+
+    TEST_PASS();
+}
+
+// Test: a collect can tell when its request went out, so a session that
+// restarted meanwhile can drop a reading taken for the old one
+void test_collect_sees_request_time() {
+    AcquisitionScheduler sched(INTERVAL);
+    setup(sched);
+    Bus bus;
+
+    sched.poll(1000, 0x01, bus.request(), bus.collect());
+    ASSERT_EQ(1000ul, sched.getRequestedAt());
+
+    // Restarted at 1200 while the read is out
+    unsigned long startTime = 1200;
+    sched.resetChannel(0);
+    std::vector<unsigned long> seen;
+    sched.poll(1600, 0x01, bus.request(), [&](uint8_t) { seen.push_back(sched.getRequestedAt()); });
+    ASSERT_EQ(1u, seen.size());
+    ASSERT_TRUE((long)(seen[0] - startTime) < 0);
+
+    // The restarted session's own sample is requested afterwards
+    sched.poll(1610, 0x01, bus.request(), bus.collect());
+    ASSERT_EQ(1610ul, sched.getRequestedAt());
+    ASSERT_FALSE((long)(sched.getRequestedAt() - startTime) < 0);
+
+    TEST_PASS();
+}
+
+int main() {
+    TEST_SUITE("Acquisition Scheduler");
+
+    RUN_TEST(batch_waits_for_slowest);
+    RUN_TEST(parallel_beats_sequential);
+    RUN_TEST(sample_interval);
+    RUN_TEST(join_fail_and_drain);
+    RUN_TEST(collect_sees_request_time);
+
+    TEST_SUMMARY();
+}
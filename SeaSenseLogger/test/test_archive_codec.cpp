@@ -0,0 +1,234 @@
+/**
+ * Tests for the columnar archive codec — bit-exact round-trip of every
+ * field, compression of a realistic deployment, and rejection of damaged
+ * blocks
+ */
+
+#include <Arduino.h>
+#include "test_framework.h"
+#include "../src/storage/ArchiveCodec.h"
+#include "../src/system/TimeService.h"
+#include <string.h>
+
+static const char* TYPES[] = {"Temperature", "Conductivity", "pH", "Dissolved Oxygen"};
+static const char* MODELS[] = {"EZO-RTD", "EZO-EC", "EZO-pH", "EZO-DO"};
+static const char* UNITS[] = {"C", "uS/cm", "pH", "mg/L"};
+
+// Values as they come back from the CSV: rounded to the written decimals
+static float quantize(float v, int decimals) {
+    char buf[32];
+    snprintf(buf, sizeof(buf), "%.*f", decimals, v);
+    return strtof(buf, nullptr);
+}
+
+// One sensor reading of a 5-minute cycle, slowly varying like a mooring
+static DataRecord makeRecord(uint32_t i) {
+    uint32_t cycle = i / 4;
+    uint8_t sensor = i % 4;
+    static const float BASE[] = {18.0f, 45000.0f, 8.1f, 7.4f};
+    static const float SWING[] = {2.0f, 1500.0f, 0.1f, 0.8f};
+
+    DataRecord r;
+    r.millis = 60000 + cycle * 300000 + sensor * 850;
+    r.timestampUTC = TimeService::formatUTC((1760000000LL + cycle * 300 + sensor) * 1000);
+    r.latitude = quantize(52.370216f + cycle * 0.00001f, 6);
+    r.longitude = 4.895168;
+    r.altitude = quantize(1.5f, 1);
+    r.gps_satellites = 9 + (cycle / 50) % 3;
+    r.gps_hdop = quantize(0.9f, 1);
+    r.sensorType = TYPES[sensor];
+    r.sensorModel = MODELS[sensor];
+    r.sensorSerial = String("SN-") + String((int)sensor);
+    r.sensorInstance = 0;
+    r.calibrationDate = "2025-06-01";
+    r.value = quantize(BASE[sensor] + SWING[sensor] * sinf(cycle / 40.0f), 2);
+    r.unit = UNITS[sensor];
+    r.quality = "good";
+    r.windSpeedTrue = quantize(5.0f + sinf(cycle / 7.0f), 2);
+    r.windAngleTrue = quantize(180.0f + 20.0f * sinf(cycle / 11.0f), 1);
+    r.windSpeedApparent = NAN;
+    r.windAngleApparent = NAN;
+    r.waterDepth = quantize(12.0f + 0.5f * sinf(cycle / 30.0f), 2);
+    r.speedThroughWater = 0.0f;
+    r.waterTempExternal = quantize(17.9f + 0.1f * sinf(cycle / 40.0f), 2);
+    r.airTemp = quantize(21.0f + 3.0f * sinf(cycle / 144.0f), 2);
+    r.baroPressure = quantize(101325.0f + 200.0f * sinf(cycle / 200.0f), 0);
+    r.humidity = quantize(70.0f, 1);
+    r.cogTrue = NAN;
+    r.sog = NAN;
+    r.heading = quantize(268.0f, 1);
+    r.pitch = quantize(0.4f, 1);
+    r.roll = quantize(-0.3f, 1);
+    r.windSpeedCorrected = NAN;
+    r.windAngleCorrected = NAN;
+    r.linAccelX = NAN;
+    r.linAccelY = NAN;
+    r.linAccelZ = NAN;
+    r.qcFlags = 0x15555;
+    r.doSaturation = sensor == 3 ? quantize(98.0f + sinf(cycle / 40.0f), 1) : NAN;
+    r.soundSpeed = quantize(1510.0f + sinf(cycle / 40.0f), 2);
+    return r;
+}
+
+static bool sameBits(float a, float b) { return memcmp(&a, &b, sizeof(a)) == 0; }
+static bool sameBits(double a, double b) { return memcmp(&a, &b, sizeof(a)) == 0; }
+
+static bool sameRecord(const DataRecord& a, const DataRecord& b) {
+    return a.millis == b.millis && a.timestampUTC == b.timestampUTC
+        && sameBits(a.latitude, b.latitude) && sameBits(a.longitude, b.longitude)
+        && sameBits(a.altitude, b.altitude) && sameBits(a.gps_hdop, b.gps_hdop)
+        && a.gps_satellites == b.gps_satellites && a.sensorInstance == b.sensorInstance
+        && a.sensorType == b.sensorType && a.sensorModel == b.sensorModel
+        && a.sensorSerial == b.sensorSerial && a.calibrationDate == b.calibrationDate
+        && a.unit == b.unit && a.quality == b.quality
+        && sameBits(a.value, b.value) && a.qcFlags == b.qcFlags
+        && sameBits(a.windSpeedTrue, b.windSpeedTrue) && sameBits(a.windAngleTrue, b.windAngleTrue)
+        && sameBits(a.windSpeedApparent, b.windSpeedApparent) && sameBits(a.windAngleApparent, b.windAngleApparent)
+        && sameBits(a.waterDepth, b.waterDepth) && sameBits(a.speedThroughWater, b.speedThroughWater)
+        && sameBits(a.waterTempExternal, b.waterTempExternal) && sameBits(a.airTemp, b.airTemp)
+        && sameBits(a.baroPressure, b.baroPressure) && sameBits(a.humidity, b.humidity)
+        && sameBits(a.cogTrue, b.cogTrue) && sameBits(a.sog, b.sog) && sameBits(a.heading, b.heading)
+        && sameBits(a.pitch, b.pitch) && sameBits(a.roll, b.roll)
+        && sameBits(a.windSpeedCorrected, b.windSpeedCorrected) && sameBits(a.windAngleCorrected, b.windAngleCorrected)
+        && sameBits(a.linAccelX, b.linAccelX) && sameBits(a.linAccelY, b.linAccelY) && sameBits(a.linAccelZ, b.linAccelZ)
+        && sameBits(a.doSaturation, b.doSaturation) && sameBits(a.soundSpeed, b.soundSpeed);
+}
+
+// Test: every field comes back bit-exact, including the odd cases
+void test_roundtrip_exact() {
+    std::vector<DataRecord> in;
+    for (uint32_t i = 0; i < 40; i++) {
+        in.push_back(makeRecord(i));
+    }
+    in[5].timestampUTC = "";                        // before clock sync
+    in[6].timestampUTC = "not a timestamp";         // kept verbatim
+    in[7].timestampUTC = "2025-02-29T00:00:00Z";    // no such day: verbatim
+    in[8].millis = 1200;                            // reboot: millis restarts
+    in[9].millis = 0xFFFFFFF0;                      // near rollover
+    in[10].value = -0.0f;
+    in[11].latitude = NAN;
+    in[12].qcFlags = 0;
+    for (uint32_t i = 13; i < 33; i++) {            // overflow the dictionary
+        in[i].sensorSerial = String("RTD-") + String((int)i);
+    }
+    in[34].quality = String("");
+
+    ArchiveEncoder enc;
+    for (const DataRecord& r : in) {
+        enc.add(r);
+    }
+    std::vector<uint8_t> block;
+    ArchiveBlockHeader h = enc.finish(block);
+    ASSERT_EQ(40, (int)h.count);
+    ASSERT_EQ(1200u, h.minMillis);
+    ASSERT_EQ(0xFFFFFFF0u, h.maxMillis);
+    ASSERT_EQ(0, (int)enc.count());
+
+    ArchiveDecoder dec;
+    ASSERT_TRUE(dec.begin(block.data(), block.size()));
+    DataRecord out;
+    for (size_t i = 0; i < in.size(); i++) {
+        ASSERT_TRUE(dec.next(out));
+        if (!sameRecord(in[i], out)) {
+            printf("    record %u differs\n", (unsigned)i);
+            ASSERT_TRUE(false);
+        }
+    }
+    ASSERT_FALSE(dec.next(out));
+
+    TEST_PASS();
+}
+
+// Test: a day of four-probe readings shrinks by an order of magnitude
+void test_compression_ratio() {
+    const uint32_t N = 1152;    // 4 probes every 5 minutes for a day
+    ArchiveEncoder enc;
+    for (uint32_t i = 0; i < N; i++) {
+        enc.add(makeRecord(i));
+    }
+    std::vector<uint8_t> block;
+    enc.finish(block);
+
+    // A CSV row of this record is ~260 bytes
+    float perRecord = (float)block.size() / N;
+    printf("    %u records in %u bytes (%.1f bytes/record)\n",
+           (unsigned)N, (unsigned)block.size(), perRecord);
+    ASSERT_TRUE(perRecord < 26.0f);
+
+    ArchiveDecoder dec;
+    ASSERT_TRUE(dec.begin(block.data(), block.size()));
+    DataRecord out;
+    uint32_t n = 0;
+    while (dec.next(out)) {
+        if (!sameRecord(makeRecord(n), out)) {
+            ASSERT_TRUE(false);
+        }
+        n++;
+    }
+    ASSERT_EQ(N, n);
+
+    TEST_PASS();
+}
+
+// Test: truncated, corrupted or foreign blocks are refused
+void test_rejects_damage() {
+    ArchiveEncoder enc;
+    for (uint32_t i = 0; i < 16; i++) {
+        enc.add(makeRecord(i));
+    }
+    std::vector<uint8_t> block;
+    enc.finish(block);
+    ArchiveDecoder dec;
+
+    ASSERT_FALSE(dec.begin(block.data(), block.size() - 1));
+    ASSERT_FALSE(dec.begin(block.data(), 10));
+
+    std::vector<uint8_t> flipped = block;
+    flipped[flipped.size() / 2] ^= 0x10;
+    ASSERT_FALSE(dec.begin(flipped.data(), flipped.size()));
+
+    std::vector<uint8_t> foreign = block;
+    foreign[0] ^= 0xFF;
+    ASSERT_FALSE(dec.begin(foreign.data(), foreign.size()));
+
+    // An empty block (only dropped lines) is valid and yields nothing
+    ArchiveBlockHeader h = enc.finish(block);
+    ASSERT_EQ(0, (int)h.count);
+    ASSERT_TRUE(dec.begin(block.data(), block.size()));
+    DataRecord out;
+    ASSERT_FALSE(dec.next(out));
+
+    TEST_PASS();
+}
+
+// Test: UTC parsing accepts exactly what formatUTC() writes
+void test_parse_utc() {
+    int64_t s = 0;
+    ASSERT_TRUE(ArchiveCodec::parseUTC("1970-01-01T00:00:00Z", s));
+    ASSERT_EQ(0, (int)s);
+    ASSERT_TRUE(ArchiveCodec::parseUTC("2024-02-29T23:59:59Z", s));
+    ASSERT_STR_EQ("2024-02-29T23:59:59Z", TimeService::formatUTC(s * 1000));
+    ASSERT_TRUE(ArchiveCodec::parseUTC("2025-10-09T08:46:40Z", s));
+    ASSERT_TRUE(s == 1759999600LL);
+
+    ASSERT_FALSE(ArchiveCodec::parseUTC("2023-02-29T00:00:00Z", s));
+    ASSERT_FALSE(ArchiveCodec::parseUTC("2025-13-01T00:00:00Z", s));
+    ASSERT_FALSE(ArchiveCodec::parseUTC("2025-06-31T00:00:00Z", s));
+    ASSERT_FALSE(ArchiveCodec::parseUTC("2025-06-01T24:00:00Z", s));
+    ASSERT_FALSE(ArchiveCodec::parseUTC("2025-06-01 12:00:00Z", s));
+    ASSERT_FALSE(ArchiveCodec::parseUTC("2025-06-01T12:00:00", s));
+    ASSERT_FALSE(ArchiveCodec::parseUTC(TimeService::UNSYNCED_UTC, s));
+
+    TEST_PASS();
+}
+
+int main() {
+    TEST_SUITE("Archive Codec");
+
+    RUN_TEST(roundtrip_exact);
+    RUN_TEST(compression_ratio);
+    RUN_TEST(rejects_damage);
+    RUN_TEST(parse_utc);
+
+    TEST_SUMMARY();
+}
@@ -0,0 +1,248 @@
+/**
+ * Tests for CaptureFormat / CaptureRecorder — record encoding, truncation,
+ * payload decoding and drop accounting
+ */
+
+#include <Arduino.h>
+
+#define private public
+#include "../src/replay/CaptureRecorder.h"
+#undef private
+
+#include "test_framework.h"
+
+#include "../config/hardware_config.h"
+
+// Test: mixed records come back with their type, payload and absolute time
+void test_roundtrip() {
+    uint8_t buf[256];
+    CaptureWriter w(buf, sizeof(buf));
+    ASSERT_TRUE(w.begin(1000));
+
+    const uint8_t nmea[] = "$GPRMC,1*00\r\n";
+    const uint8_t frame[] = {1, 2, 3, 4, 5, 6, 7, 8};
+    ASSERT_TRUE(w.append(CaptureType::GPS_BYTES, 1005, nmea, sizeof(nmea) - 1));
+    ASSERT_TRUE(w.appendCanFrame(1020, 0x09F80123, frame, 8));
+    ASSERT_TRUE(w.appendImuReport(1020, ImuReportKind::LINEAR_ACCELERATION, 0.5f, -1.0f, 9.5f, 0.0f));
+
+    CaptureReader r(w.data(), w.size());
+    ASSERT_TRUE(r.begin());
+    ASSERT_EQ(1000UL, r.getStartMs());
+
+    CaptureRecord rec;
+    ASSERT_TRUE(r.next(rec));
+    ASSERT_TRUE(rec.type == CaptureType::GPS_BYTES);
+    ASSERT_EQ(1005UL, rec.timeMs);
+    ASSERT_EQ((uint16_t)(sizeof(nmea) - 1), rec.length);
+    ASSERT_TRUE(memcmp(rec.payload, nmea, rec.length) == 0);
+
+    ASSERT_TRUE(r.next(rec));
+    ASSERT_TRUE(rec.type == CaptureType::CAN_FRAME);
+    ASSERT_EQ(1020UL, rec.timeMs);
+
+    ASSERT_TRUE(r.next(rec));
+    ASSERT_TRUE(rec.type == CaptureType::IMU_REPORT);
+    ASSERT_EQ(1020UL, rec.timeMs);
+
+    ASSERT_FALSE(r.next(rec));
+    ASSERT_FALSE(r.isTruncated());
+
+    TEST_PASS();
+}
+
+// Test: time deltas are varints — one byte at 10 Hz, more for long gaps
+void test_varint_delta() {
+    uint8_t buf[64];
+    const uint8_t b = 'x';
+    CaptureWriter w(buf, sizeof(buf));
+    w.begin(0);
+
+    w.append(CaptureType::GPS_BYTES, 100, &b, 1);
+    ASSERT_EQ((size_t)(CAPTURE_HEADER_SIZE + 4), w.size());     // type, dt, len, byte
+
+    w.append(CaptureType::GPS_BYTES, 100 + 70000, &b, 1);
+    ASSERT_EQ((size_t)(CAPTURE_HEADER_SIZE + 4 + 6), w.size()); // dt needs 3 bytes
+
+    CaptureReader r(w.data(), w.size());
+    r.begin();
+    CaptureRecord rec;
+    r.next(rec);
+    r.next(rec);
+    ASSERT_EQ(70100UL, rec.timeMs);
+
+    TEST_PASS();
+}
+
+// Test: timing continues across a flush (clearBuffer)
+void test_delta_across_flush() {
+    uint8_t buf[64];
+    uint8_t file[128];
+    size_t fileLen = 0;
+    const uint8_t b = 'x';
+    CaptureWriter w(buf, sizeof(buf));
+    w.begin(500);
+    w.append(CaptureType::GPS_BYTES, 600, &b, 1);
+    memcpy(file, w.data(), w.size());
+    fileLen = w.size();
+    w.clearBuffer();
+    w.append(CaptureType::GPS_BYTES, 750, &b, 1);
+    memcpy(file + fileLen, w.data(), w.size());
+    fileLen += w.size();
+
+    CaptureReader r(file, fileLen);
+    ASSERT_TRUE(r.begin());
+    CaptureRecord rec;
+    ASSERT_TRUE(r.next(rec));
+    ASSERT_TRUE(r.next(rec));
+    ASSERT_EQ(750UL, rec.timeMs);
+
+    TEST_PASS();
+}
+
+// Test: a file cut mid-record keeps every complete record before it
+void test_truncated() {
+    uint8_t buf[128];
+    const uint8_t data[20] = {0};
+    CaptureWriter w(buf, sizeof(buf));
+    w.begin(0);
+    w.append(CaptureType::GPS_BYTES, 10, data, 20);
+    w.append(CaptureType::GPS_BYTES, 20, data, 20);
+
+    CaptureReader r(w.data(), w.size() - 5);
+    ASSERT_TRUE(r.begin());
+    CaptureRecord rec;
+    ASSERT_TRUE(r.next(rec));
+    ASSERT_FALSE(r.next(rec));
+    ASSERT_TRUE(r.isTruncated());
+
+    TEST_PASS();
+}
+
+// Test: wrong magic or version is rejected
+void test_bad_header() {
+    uint8_t buf[32];
+    CaptureWriter w(buf, sizeof(buf));
+    w.begin(0);
+
+    buf[5] = CAPTURE_VERSION + 1;
+    CaptureReader badVersion(buf, w.size());
+    ASSERT_FALSE(badVersion.begin());
+
+    buf[5] = CAPTURE_VERSION;
+    buf[0] = 'X';
+    CaptureReader badMagic(buf, w.size());
+    ASSERT_FALSE(badMagic.begin());
+
+    CaptureReader tooShort(buf, 4);
+    ASSERT_FALSE(tooShort.begin());
+
+    TEST_PASS();
+}
+
+// Test: CAN and IMU payloads decode to what was recorded
+void test_decode_payloads() {
+    uint8_t buf[128];
+    const uint8_t frame[] = {0xA0, 0x11, 0x22};
+    CaptureWriter w(buf, sizeof(buf));
+    w.begin(0);
+    w.appendCanFrame(1, 0x19F80523, frame, 3);
+    w.appendImuReport(2, ImuReportKind::ROTATION_VECTOR, 0.1f, 0.2f, 0.3f, 0.9f);
+
+    CaptureReader r(w.data(), w.size());
+    r.begin();
+    CaptureRecord rec;
+
+    r.next(rec);
+    uint32_t id = 0;
+    uint8_t data[8];
+    uint8_t len = 0;
+    ASSERT_TRUE(CaptureReader::decodeCanFrame(rec, id, data, len));
+    ASSERT_EQ(0x19F80523u, id);
+    ASSERT_EQ(3, len);
+    ASSERT_EQ(0x22, data[2]);
+    ImuReportKind kind;
+    float v[4];
+    ASSERT_FALSE(CaptureReader::decodeImuReport(rec, kind, v));
+
+    r.next(rec);
+    ASSERT_TRUE(CaptureReader::decodeImuReport(rec, kind, v));
+    ASSERT_TRUE(kind == ImuReportKind::ROTATION_VECTOR);
+    ASSERT_FLOAT_EQ(0.3f, v[2], 0.0001);
+    ASSERT_FLOAT_EQ(0.9f, v[3], 0.0001);
+    ASSERT_FALSE(CaptureReader::decodeCanFrame(rec, id, data, len));
+
+    TEST_PASS();
+}
+
+// Test: a record that doesn't fit is refused and leaves the buffer intact
+void test_buffer_full() {
+    uint8_t buf[CAPTURE_HEADER_SIZE + 10];
+    const uint8_t data[8] = {0};
+    CaptureWriter w(buf, sizeof(buf));
+    w.begin(0);
+    ASSERT_TRUE(w.append(CaptureType::GPS_BYTES, 0, data, 7));
+    size_t before = w.size();
+    ASSERT_FALSE(w.append(CaptureType::GPS_BYTES, 0, data, 1));
+    ASSERT_EQ(before, w.size());
+
+    uint8_t big[CAPTURE_MAX_PAYLOAD + 1];
+    uint8_t roomy[1024];
+    CaptureWriter w2(roomy, sizeof(roomy));
+    w2.begin(0);
+    ASSERT_FALSE(w2.append(CaptureType::GPS_BYTES, 0, big, sizeof(big)));
+
+    TEST_PASS();
+}
+
+// Test: hooks do nothing until a capture runs; overflow is dropped, not waited for
+void test_recorder_hooks() {
+    const uint8_t frame[8] = {0};
+    CaptureRecorder rec;
+    CaptureRecorder::canFrame(0x100, frame, 8);
+    ASSERT_EQ(0u, rec.getRecordCount());
+
+    _mock_millis = 0;
+    ASSERT_TRUE(rec.start(0));
+    ASSERT_TRUE(rec.isActive());
+    ASSERT_FALSE(CaptureRecorder().start(0));      // one capture at a time
+
+    // GPS bursts are split into CAPTURE_MAX_PAYLOAD chunks
+    static uint8_t burst[600];
+    CaptureRecorder::gpsBytes(burst, sizeof(burst));
+    ASSERT_EQ(3u, rec.getRecordCount());
+
+    // Fill the buffer without letting process() run
+    while (rec.getDroppedCount() == 0) {
+        CaptureRecorder::canFrame(0x100, frame, 8);
+    }
+    uint32_t recorded = rec.getRecordCount();
+
+    _mock_millis = CAPTURE_FLUSH_INTERVAL_MS;
+    rec.process(millis());
+    ASSERT_EQ(0u, (uint32_t)rec._writer->size());
+    ASSERT_TRUE(rec.getBytesWritten() > (uint32_t)(CAPTURE_BUFFER_SIZE - 32));
+    CaptureRecorder::canFrame(0x100, frame, 8);
+    ASSERT_EQ(recorded + 1, rec.getRecordCount());
+
+    rec.stop();
+    ASSERT_FALSE(rec.isActive());
+    CaptureRecorder::canFrame(0x100, frame, 8);
+    ASSERT_EQ(recorded + 1, rec.getRecordCount());
+
+    TEST_PASS();
+}
+
+int main() {
+    TEST_SUITE("CaptureFormat");
+
+    RUN_TEST(roundtrip);
+    RUN_TEST(varint_delta);
+    RUN_TEST(delta_across_flush);
+    RUN_TEST(truncated);
+    RUN_TEST(bad_header);
+    RUN_TEST(decode_payloads);
+    RUN_TEST(buffer_full);
+    RUN_TEST(recorder_hooks);
+
+    TEST_SUMMARY();
+}
@@ -0,0 +1,143 @@
+/**
+ * Tests for ChangeFeed — incremental sync cursors for /api/data/changes:
+ * only records appended since the client's cursor are sent, and a changed
+ * store (cleared, trimmed, SD/SPIFFS switch) resets the client
+ */
+
+#include <Arduino.h>
+#include "test_framework.h"
+
+#include "../src/webui/ChangeFeed.h"
+
+// Test: a first sync pages through the store, later syncs get only new records
+void test_incremental_sync() {
+    uint32_t stream = ChangeFeed::streamId(true, false, 1000, "Temperature", 18.5f);
+    ASSERT_TRUE(stream != 0);
+
+    // No cursor yet: reset, first page
+    ChangeFeed::Window w = ChangeFeed::plan(stream, 0, 0, 450, 200);
+    ASSERT_TRUE(w.reset);
+    ASSERT_EQ(0u, w.from);
+    ASSERT_EQ(200, w.count);
+    ASSERT_EQ(200u, w.next);
+    ASSERT_TRUE(w.more);
+
+    w = ChangeFeed::plan(stream, stream, w.next, 450, 200);
+    ASSERT_FALSE(w.reset);
+    ASSERT_EQ(200u, w.from);
+    ASSERT_EQ(200, w.count);
+
+    w = ChangeFeed::plan(stream, stream, w.next, 450, 200);
+    ASSERT_EQ(400u, w.from);
+    ASSERT_EQ(50, w.count);
+    ASSERT_EQ(450u, w.next);
+    ASSERT_FALSE(w.more);
+
+    // Up to date: nothing to send, cursor unchanged
+    w = ChangeFeed::plan(stream, stream, 450, 450, 200);
+    ASSERT_FALSE(w.reset);
+    ASSERT_EQ(0, w.count);
+    ASSERT_EQ(450u, w.next);
+
+    // Four new records appended
+    w = ChangeFeed::plan(stream, stream, 450, 454, 200);
+    ASSERT_FALSE(w.reset);
+    ASSERT_EQ(450u, w.from);
+    ASSERT_EQ(4, w.count);
+    ASSERT_EQ(454u, w.next);
+
+    TEST_PASS();
+}
+
+// Test: a different store or first record changes the stream ID
+void test_stream_id() {
+    uint32_t sd = ChangeFeed::streamId(true, false, 1000, "Temperature", 18.5f);
+    ASSERT_EQ(sd, ChangeFeed::streamId(true, false, 1000, "Temperature", 18.5f));
+    ASSERT_TRUE(sd != ChangeFeed::streamId(false, false, 1000, "Temperature", 18.5f));
+    ASSERT_TRUE(sd != ChangeFeed::streamId(true, false, 61000, "Temperature", 18.5f));
+    ASSERT_TRUE(sd != ChangeFeed::streamId(true, false, 1000, "Conductivity", 18.5f));
+    ASSERT_TRUE(sd != ChangeFeed::streamId(true, false, 1000, "Temperature", 18.6f));
+
+    // Empty stores differ from populated ones and from each other
+    uint32_t emptySd = ChangeFeed::streamId(true, true, 0, nullptr, 0.0f);
+    ASSERT_TRUE(emptySd != 0);
+    ASSERT_TRUE(emptySd != sd);
+    ASSERT_TRUE(emptySd != ChangeFeed::streamId(false, true, 0, nullptr, 0.0f));
+
+    TEST_PASS();
+}
+
+// Test: a cleared, trimmed or replaced store restarts the client from 0
+void test_reset() {
+    uint32_t before = ChangeFeed::streamId(false, false, 1000, "pH", 8.1f);
+    uint32_t after = ChangeFeed::streamId(false, false, 121000, "pH", 8.05f);  // oldest trimmed
+
+    ChangeFeed::Window w = ChangeFeed::plan(after, before, 100, 100, 200);
+    ASSERT_TRUE(w.reset);
+    ASSERT_EQ(0u, w.from);
+    ASSERT_EQ(100, w.count);
+    ASSERT_EQ(100u, w.next);
+
+    // Same stream but a cursor past the end: store was swapped under it
+    w = ChangeFeed::plan(after, after, 500, 100, 200);
+    ASSERT_TRUE(w.reset);
+    ASSERT_EQ(0u, w.from);
+    ASSERT_EQ(100, w.count);
+
+    // Cleared store
+    uint32_t empty = ChangeFeed::streamId(false, true, 0, nullptr, 0.0f);
+    w = ChangeFeed::plan(empty, after, 100, 0, 200);
+    ASSERT_TRUE(w.reset);
+    ASSERT_EQ(0, w.count);
+    ASSERT_EQ(0u, w.next);
+    ASSERT_FALSE(w.more);
+
+    TEST_PASS();
+}
+
+// Test: a client that keeps only the newest records starts at the tail
+void test_tail() {
+    uint32_t stream = ChangeFeed::streamId(true, false, 1000, "Temperature", 18.5f);
+
+    ChangeFeed::Window w = ChangeFeed::plan(stream, 0, 0, 100000, 200, 5000);
+    ASSERT_TRUE(w.reset);
+    ASSERT_EQ(95000u, w.from);
+    ASSERT_EQ(200, w.count);
+    ASSERT_EQ(95200u, w.next);
+    ASSERT_TRUE(w.more);
+
+    // A valid cursor more than the tail behind skips ahead, flagging the gap
+    w = ChangeFeed::plan(stream, stream, 10, 100000, 200, 5000);
+    ASSERT_FALSE(w.reset);
+    ASSERT_TRUE(w.gap);
+    ASSERT_EQ(95000u, w.from);
+    ASSERT_EQ(95200u, w.next);
+
+    // ...and is followed as is within the tail
+    w = ChangeFeed::plan(stream, stream, 95000, 100000, 200, 5000);
+    ASSERT_FALSE(w.reset);
+    ASSERT_FALSE(w.gap);
+    ASSERT_EQ(95000u, w.from);
+
+    // No tail: every record after the cursor
+    w = ChangeFeed::plan(stream, stream, 10, 100000, 200);
+    ASSERT_FALSE(w.gap);
+    ASSERT_EQ(10u, w.from);
+
+    // Store smaller than the tail: everything
+    w = ChangeFeed::plan(stream, 0, 0, 300, 200, 5000);
+    ASSERT_EQ(0u, w.from);
+
+    TEST_PASS();
+}
+
+int main() {
+    TEST_SUITE("Change Feed");
+
+    RUN_TEST(incremental_sync);
+    RUN_TEST(stream_id);
+    RUN_TEST(reset);
+    RUN_TEST(tail);
+
+    TEST_SUMMARY();
+}
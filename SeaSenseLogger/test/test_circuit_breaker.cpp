@@ -0,0 +1,138 @@
+/**
+ * Tests for CircuitBreaker — trip threshold, skips, half-open probes, backoff
+ */
+
+#include <Arduino.h>
+#include "test_framework.h"
+
+#include "../src/sensors/CircuitBreaker.h"
+
+static const unsigned long BASE = 60000;
+static const unsigned long MAX = 240000;
+
+// Trip a closed breaker at time t
+static void trip(CircuitBreaker& br, unsigned long t) {
+    for (int i = 0; i < 3; i++) {
+        br.allowRequest(t);
+        br.recordFailure(t);
+    }
+}
+
+// Test: stays closed below the threshold, opens on reaching it
+void test_trips_at_threshold() {
+    CircuitBreaker br(3, BASE, MAX);
+    br.recordFailure(0);
+    br.recordFailure(0);
+    ASSERT_TRUE(br.getState() == BreakerState::CLOSED);
+    ASSERT_TRUE(br.allowRequest(0));
+    br.recordFailure(0);
+    ASSERT_TRUE(br.getState() == BreakerState::OPEN);
+    ASSERT_EQ(1u, br.getTripCount());
+
+    TEST_PASS();
+}
+
+// Test: a success in between resets the consecutive count
+void test_success_resets_count() {
+    CircuitBreaker br(3, BASE, MAX);
+    br.recordFailure(0);
+    br.recordFailure(0);
+    br.recordSuccess();
+    br.recordFailure(0);
+    br.recordFailure(0);
+    ASSERT_TRUE(br.getState() == BreakerState::CLOSED);
+    ASSERT_EQ(2, br.getConsecutiveFailures());
+
+    TEST_PASS();
+}
+
+// Test: an open breaker skips and counts every request until it expires
+void test_open_skips() {
+    CircuitBreaker br(3, BASE, MAX);
+    trip(br, 1000);
+    ASSERT_FALSE(br.allowRequest(2000));
+    ASSERT_FALSE(br.allowRequest(1000 + BASE - 1));
+    ASSERT_EQ(2u, br.getSkippedCount());
+    ASSERT_EQ(BASE - 1000, br.getRetryInMs(2000));
+
+    ASSERT_TRUE(br.allowRequest(1000 + BASE));
+    ASSERT_TRUE(br.getState() == BreakerState::HALF_OPEN);
+    ASSERT_EQ(0ul, br.getRetryInMs(1000 + BASE));
+    ASSERT_EQ(2u, br.getSkippedCount());
+
+    TEST_PASS();
+}
+
+// Test: a successful probe closes the breaker and restores the base period
+void test_probe_success_closes() {
+    CircuitBreaker br(3, BASE, MAX);
+    trip(br, 0);
+    br.allowRequest(BASE);
+    br.recordFailure(BASE);                     // failed probe: 2x
+    ASSERT_EQ(2 * BASE, br.getOpenPeriodMs());
+
+    ASSERT_TRUE(br.allowRequest(3 * BASE));
+    br.recordSuccess();
+    ASSERT_TRUE(br.getState() == BreakerState::CLOSED);
+    ASSERT_EQ(BASE, br.getOpenPeriodMs());
+    ASSERT_EQ(0, br.getConsecutiveFailures());
+
+    TEST_PASS();
+}
+
+// Test: each failed probe doubles the open period, up to the cap
+void test_probe_backoff_capped() {
+    CircuitBreaker br(3, BASE, MAX);
+    unsigned long t = 0;
+    trip(br, t);
+    unsigned long expected[] = {2 * BASE, 4 * BASE, MAX, MAX};
+    for (int i = 0; i < 4; i++) {
+        t += br.getOpenPeriodMs();
+        ASSERT_TRUE(br.allowRequest(t));
+        br.recordFailure(t);
+        ASSERT_TRUE(br.getState() == BreakerState::OPEN);
+        ASSERT_EQ(expected[i], br.getOpenPeriodMs());
+    }
+    ASSERT_EQ(5u, br.getTripCount());
+
+    TEST_PASS();
+}
+
+// Test: reset closes the breaker but keeps the counters
+void test_reset() {
+    CircuitBreaker br(3, BASE, MAX);
+    trip(br, 0);
+    br.allowRequest(10);
+    br.reset();
+    ASSERT_TRUE(br.getState() == BreakerState::CLOSED);
+    ASSERT_TRUE(br.allowRequest(20));
+    ASSERT_EQ(1u, br.getSkippedCount());
+    ASSERT_EQ(1u, br.getTripCount());
+
+    TEST_PASS();
+}
+
+// Test: open period survives millis() rollover
+void test_rollover() {
+    CircuitBreaker br(3, BASE, MAX);
+    unsigned long t = 0xFFFFFFFFUL - 1000;
+    trip(br, t);
+    ASSERT_FALSE(br.allowRequest(t + 5000));    // wrapped, still open
+    ASSERT_TRUE(br.allowRequest(t + BASE));
+
+    TEST_PASS();
+}
+
+int main() {
+    TEST_SUITE("CircuitBreaker");
+
+    RUN_TEST(trips_at_threshold);
+    RUN_TEST(success_resets_count);
+    RUN_TEST(open_skips);
+    RUN_TEST(probe_success_closes);
+    RUN_TEST(probe_backoff_capped);
+    RUN_TEST(reset);
+    RUN_TEST(rollover);
+
+    TEST_SUMMARY();
+}
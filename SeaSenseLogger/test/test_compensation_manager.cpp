@@ -0,0 +1,143 @@
+/**
+ * Tests for CompensationManager — hysteresis, invalidation, periodic resync
+ */
+
+#include <Arduino.h>
+#include "test_framework.h"
+
+#define private public
+#include "../src/sensors/CompensationManager.h"
+#undef private
+
+#include "../config/hardware_config.h"
+
+// Test: first value is always sent to every target
+void test_first_value_sent() {
+    _mock_millis = 1000;
+    CompensationManager cm(nullptr, nullptr, nullptr);
+    cm.applyTemperature(18.234f);
+    ASSERT_EQ(3u, cm.getSentCount(CompParam::TEMPERATURE));
+    ASSERT_EQ(0u, cm.getSkippedCount(CompParam::TEMPERATURE));
+    // Cached as sent: two decimals
+    ASSERT_FLOAT_EQ(18.23f, cm.getAcknowledged(CompTarget::PH, CompParam::TEMPERATURE), 0.0001);
+
+    TEST_PASS();
+}
+
+// Test: changes inside the hysteresis are skipped
+void test_small_change_skipped() {
+    _mock_millis = 1000;
+    CompensationManager cm(nullptr, nullptr, nullptr);
+    cm.applyTemperature(18.00f);
+    cm.applyTemperature(18.01f);
+    cm.applyTemperature(17.98f);
+    ASSERT_EQ(3u, cm.getSentCount(CompParam::TEMPERATURE));
+    ASSERT_EQ(6u, cm.getSkippedCount(CompParam::TEMPERATURE));
+
+    cm.applyTemperature(18.00f + COMP_TEMP_HYSTERESIS_C + 0.01f);
+    ASSERT_EQ(6u, cm.getSentCount(CompParam::TEMPERATURE));
+
+    TEST_PASS();
+}
+
+// Test: slow drift is compared against the acknowledged value, so it is
+// eventually sent instead of being skipped forever
+void test_slow_drift_accumulates() {
+    _mock_millis = 1000;
+    CompensationManager cm(nullptr, nullptr, nullptr);
+    cm.applySalinity(30.0f);
+    for (int i = 1; i <= 10; i++) {
+        cm.applySalinity(30.0f + 0.1f * i);
+    }
+    // 30.0 sent, then 30.5 crosses the 0.5 PSU hysteresis, then 31.0
+    ASSERT_EQ(3u, cm.getSentCount(CompParam::SALINITY));
+    ASSERT_FLOAT_EQ(31.0f, cm.getAcknowledged(CompTarget::DO, CompParam::SALINITY), 0.001);
+
+    TEST_PASS();
+}
+
+// Test: pressure goes to DO only, quantised to 0.1 kPa
+void test_pressure_do_only() {
+    _mock_millis = 1000;
+    CompensationManager cm(nullptr, nullptr, nullptr);
+    cm.applyPressure(101.325f);
+    ASSERT_EQ(1u, cm.getSentCount(CompParam::PRESSURE));
+    ASSERT_FLOAT_EQ(101.3f, cm.getAcknowledged(CompTarget::DO, CompParam::PRESSURE), 0.001);
+    ASSERT_NAN(cm.getAcknowledged(CompTarget::EC, CompParam::PRESSURE));
+
+    TEST_PASS();
+}
+
+// Test: invalidating one device re-sends to that device only
+void test_invalidate_target() {
+    _mock_millis = 1000;
+    CompensationManager cm(nullptr, nullptr, nullptr);
+    cm.applyTemperature(20.0f);
+    cm.invalidate(CompTarget::EC);
+    ASSERT_NAN(cm.getAcknowledged(CompTarget::EC, CompParam::TEMPERATURE));
+
+    cm.applyTemperature(20.0f);
+    ASSERT_EQ(4u, cm.getSentCount(CompParam::TEMPERATURE));
+    ASSERT_EQ(2u, cm.getSkippedCount(CompParam::TEMPERATURE));
+
+    TEST_PASS();
+}
+
+// Test: bus reset forgets everything
+void test_invalidate_all() {
+    _mock_millis = 1000;
+    CompensationManager cm(nullptr, nullptr, nullptr);
+    cm.applyTemperature(20.0f);
+    cm.applySalinity(35.0f);
+    cm.invalidateAll();
+    cm.applyTemperature(20.0f);
+    cm.applySalinity(35.0f);
+    ASSERT_EQ(6u, cm.getSentCount(CompParam::TEMPERATURE));
+    ASSERT_EQ(2u, cm.getSentCount(CompParam::SALINITY));
+
+    TEST_PASS();
+}
+
+// Test: periodic resync re-sends unchanged values
+void test_periodic_resync() {
+    _mock_millis = 1000;
+    CompensationManager cm(nullptr, nullptr, nullptr);
+    cm.applyTemperature(20.0f);
+    _mock_millis = 1000 + COMP_RESYNC_INTERVAL_MS / 2;
+    cm.applyTemperature(20.0f);
+    ASSERT_EQ(3u, cm.getSentCount(CompParam::TEMPERATURE));
+
+    _mock_millis = COMP_RESYNC_INTERVAL_MS + 1;
+    cm.applyTemperature(20.0f);
+    ASSERT_EQ(6u, cm.getSentCount(CompParam::TEMPERATURE));
+    ASSERT_EQ(1u, cm.getResyncCount());
+
+    TEST_PASS();
+}
+
+// Test: NaN inputs are ignored
+void test_nan_ignored() {
+    _mock_millis = 1000;
+    CompensationManager cm(nullptr, nullptr, nullptr);
+    cm.applyTemperature(NAN);
+    cm.applyPressure(NAN);
+    ASSERT_EQ(0u, cm.getSentCount(CompParam::TEMPERATURE));
+    ASSERT_EQ(0u, cm.getSkippedCount(CompParam::PRESSURE));
+
+    TEST_PASS();
+}
+
+int main() {
+    TEST_SUITE("CompensationManager");
+
+    RUN_TEST(first_value_sent);
+    RUN_TEST(small_change_skipped);
+    RUN_TEST(slow_drift_accumulates);
+    RUN_TEST(pressure_do_only);
+    RUN_TEST(invalidate_target);
+    RUN_TEST(invalidate_all);
+    RUN_TEST(periodic_resync);
+    RUN_TEST(nan_ignored);
+
+    TEST_SUMMARY();
+}
@@ -161,6 +161,46 @@ void test_setter_triggers_clamp() {
     TEST_PASS();
 }
 
+// Test: published snapshot carries the clamped value, not the raw input
+void test_snapshot_publishes_clamped_values() {
+    ConfigManager cm;
+    uint32_t before = cm.getVersion();
+
+    ConfigManager::SamplingConfig sampling = {};
+    cm.setSamplingConfig(sampling);
+
+    ConfigManager::SnapshotPtr snap = cm.snapshot();
+    ASSERT_EQ(before + 1, snap->version);
+    ASSERT_EQ((uint32_t)22000, snap->sampling.sensorIntervalMs);
+
+    TEST_PASS();
+}
+
+// Test: setters inside beginUpdate()/commitUpdate() publish one version
+void test_batched_update_publishes_once() {
+    ConfigManager cm;
+    int notifications = 0;
+    cm.subscribe([&](const ConfigManager::Snapshot&, const ConfigManager::Snapshot&) {
+        notifications++;
+    });
+    uint32_t before = cm.getVersion();
+
+    cm.beginUpdate();
+    ConfigManager::GPSConfig gps = {true, false};
+    cm.setGPSConfig(gps);
+    ConfigManager::NMEAConfig nmea = {true};
+    cm.setNMEAConfig(nmea);
+    ASSERT_EQ(before, cm.getVersion());  // nothing visible yet
+    cm.commitUpdate();
+
+    ASSERT_EQ(before + 1, cm.getVersion());
+    ASSERT_EQ(1, notifications);
+    ASSERT_TRUE(cm.snapshot()->gps.useNMEA2000);
+    ASSERT_TRUE(cm.snapshot()->nmea.outputEnabled);
+
+    TEST_PASS();
+}
+
 int main() {
     TEST_SUITE("ConfigManager::clampConfig");
 
@@ -169,6 +209,8 @@ int main() {
     RUN_TEST(valid_values_unchanged);
     RUN_TEST(boundary_values_accepted);
     RUN_TEST(setter_triggers_clamp);
+    RUN_TEST(snapshot_publishes_clamped_values);
+    RUN_TEST(batched_update_publishes_once);
 
     TEST_SUMMARY();
 }
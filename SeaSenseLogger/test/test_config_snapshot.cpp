@@ -0,0 +1,140 @@
+/**
+ * Tests for ConfigSnapshotStore — versioned, immutable config snapshots
+ *
+ * Standalone header-only template, no hardware dependencies.
+ */
+
+#include <Arduino.h>
+#include "test_framework.h"
+#include "../src/config/ConfigSnapshot.h"
+
+struct TestConfig {
+    uint32_t version;
+    String ssid;
+    uint32_t intervalMs;
+
+    TestConfig() : version(0), intervalMs(0) {}
+};
+
+// Test: a fresh store hands out a default snapshot, never null
+void test_initial_snapshot_not_null() {
+    ConfigSnapshotStore<TestConfig> store;
+    ConfigSnapshotStore<TestConfig>::Ptr snap = store.load();
+
+    ASSERT_TRUE(snap != nullptr);
+    ASSERT_EQ(0u, snap->version);
+    ASSERT_EQ(0u, snap->intervalMs);
+
+    TEST_PASS();
+}
+
+// Test: publish replaces the current snapshot
+void test_publish_replaces_current() {
+    ConfigSnapshotStore<TestConfig> store;
+    TestConfig cfg;
+    cfg.version = 1;
+    cfg.ssid = "boat";
+    cfg.intervalMs = 60000;
+    store.publish(cfg);
+
+    ASSERT_EQ(1u, store.load()->version);
+    ASSERT_STR_EQ("boat", store.load()->ssid.c_str());
+    ASSERT_EQ(60000u, store.load()->intervalMs);
+
+    TEST_PASS();
+}
+
+// Test: a reader holding an old snapshot keeps a consistent view after publish
+void test_reader_keeps_old_snapshot() {
+    ConfigSnapshotStore<TestConfig> store;
+    TestConfig cfg;
+    cfg.version = 1;
+    cfg.ssid = "old";
+    store.publish(cfg);
+
+    ConfigSnapshotStore<TestConfig>::Ptr held = store.load();
+
+    cfg.version = 2;
+    cfg.ssid = "new";
+    store.publish(cfg);
+
+    ASSERT_EQ(1u, held->version);
+    ASSERT_STR_EQ("old", held->ssid.c_str());
+    ASSERT_EQ(2u, store.load()->version);
+    ASSERT_STR_EQ("new", store.load()->ssid.c_str());
+
+    TEST_PASS();
+}
+
+// Test: dropping the last reference frees the old snapshot
+void test_old_snapshot_released() {
+    ConfigSnapshotStore<TestConfig> store;
+    TestConfig cfg;
+    cfg.version = 1;
+    store.publish(cfg);
+
+    std::weak_ptr<const TestConfig> weak = store.load();
+    ASSERT_FALSE(weak.expired());
+
+    cfg.version = 2;
+    store.publish(cfg);
+    ASSERT_TRUE(weak.expired());
+
+    TEST_PASS();
+}
+
+// Test: subscribers see the new and previous snapshots
+void test_subscriber_notified() {
+    ConfigSnapshotStore<TestConfig> store;
+    uint32_t seenCurrent = 0;
+    uint32_t seenPrevious = 99;
+    int calls = 0;
+
+    ASSERT_TRUE(store.subscribe([&](const TestConfig& cur, const TestConfig& prev) {
+        seenCurrent = cur.intervalMs;
+        seenPrevious = prev.intervalMs;
+        calls++;
+    }));
+
+    TestConfig cfg;
+    cfg.intervalMs = 22000;
+    store.publish(cfg);
+
+    ASSERT_EQ(1, calls);
+    ASSERT_EQ(22000u, seenCurrent);
+    ASSERT_EQ(0u, seenPrevious);
+
+    cfg.intervalMs = 45000;
+    store.publish(cfg);
+
+    ASSERT_EQ(2, calls);
+    ASSERT_EQ(45000u, seenCurrent);
+    ASSERT_EQ(22000u, seenPrevious);
+
+    TEST_PASS();
+}
+
+// Test: subscription table is bounded
+void test_subscriber_table_full() {
+    ConfigSnapshotStore<TestConfig> store;
+    for (uint8_t i = 0; i < ConfigSnapshotStore<TestConfig>::MAX_LISTENERS; i++) {
+        ASSERT_TRUE(store.subscribe([](const TestConfig&, const TestConfig&) {}));
+    }
+    ASSERT_FALSE(store.subscribe([](const TestConfig&, const TestConfig&) {}));
+    ASSERT_EQ(ConfigSnapshotStore<TestConfig>::MAX_LISTENERS, store.getListenerCount());
+
+    TEST_PASS();
+}
+
+int main() {
+    TEST_SUITE("ConfigSnapshotStore");
+
+    RUN_TEST(initial_snapshot_not_null);
+    RUN_TEST(publish_replaces_current);
+    RUN_TEST(reader_keeps_old_snapshot);
+    RUN_TEST(old_snapshot_released);
+    RUN_TEST(subscriber_notified);
+    RUN_TEST(subscriber_table_full);
+
+    TEST_SUMMARY();
+}
@@ -9,6 +9,8 @@
 #include "test_framework.h"
 #include "../src/system/SystemHealth.h"
 #include "../src/storage/SPIFFSStorage.h"
+#include "../src/sensors/QualityControl.h"
+#include "../src/system/TimeService.h"
 
 // Global SystemHealth instance (referenced by SPIFFSStorage via extern)
 SystemHealth systemHealth;
@@ -52,6 +54,9 @@ static DataRecord makeTestRecord() {
     r.linAccelX = 0.12f;
     r.linAccelY = -0.05f;
     r.linAccelZ = 0.03f;
+    r.qcFlags = QcFlags::fromString("113121").packed;
+    r.doSaturation = 98.4f;
+    r.soundSpeed = 1521.37f;
     return r;
 }
 
@@ -89,6 +94,9 @@ void test_full_roundtrip() {
     ASSERT_FLOAT_EQ(original.linAccelX, parsed.linAccelX, 0.001);
     ASSERT_FLOAT_EQ(original.linAccelY, parsed.linAccelY, 0.001);
     ASSERT_FLOAT_EQ(original.linAccelZ, parsed.linAccelZ, 0.001);
+    ASSERT_EQ(original.qcFlags, parsed.qcFlags);
+    ASSERT_FLOAT_EQ(original.doSaturation, parsed.doSaturation, 0.1);
+    ASSERT_FLOAT_EQ(original.soundSpeed, parsed.soundSpeed, 0.01);
 
     TEST_PASS();
 }
@@ -119,6 +127,8 @@ void test_nan_fields_roundtrip() {
     original.linAccelX = NAN;
     original.linAccelY = NAN;
     original.linAccelZ = NAN;
+    original.doSaturation = NAN;
+    original.soundSpeed = NAN;
 
     String csv = storage.recordToCSV(original);
     DataRecord parsed;
@@ -135,6 +145,8 @@ void test_nan_fields_roundtrip() {
     ASSERT_NAN(parsed.linAccelX);
     ASSERT_NAN(parsed.linAccelY);
     ASSERT_NAN(parsed.linAccelZ);
+    ASSERT_NAN(parsed.doSaturation);
+    ASSERT_NAN(parsed.soundSpeed);
 
     TEST_PASS();
 }
@@ -164,6 +176,10 @@ void test_old_format_backward_compat() {
     ASSERT_NAN(parsed.windAngleCorrected);
     ASSERT_NAN(parsed.linAccelX);
 
+    // Records from before QC carry no flags
+    ASSERT_EQ(0u, parsed.qcFlags);
+    ASSERT_NAN(parsed.doSaturation);
+
     TEST_PASS();
 }
 
@@ -189,6 +205,23 @@ void test_zero_gps_no_fix() {
     TEST_PASS();
 }
 
+// Test: unsynced record stores the fixed-width placeholder, reads back empty
+void test_unsynced_timestamp_placeholder() {
+    SPIFFSStorage storage(100);
+    DataRecord original = makeTestRecord();
+    original.timestampUTC = "";
+
+    String csv = storage.recordToCSV(original);
+    ASSERT_TRUE(csv.indexOf(String(",") + TimeService::UNSYNCED_UTC + ",") > 0);
+
+    DataRecord parsed;
+    ASSERT_TRUE(storage.parseCSVLine(csv, parsed));
+    ASSERT_STR_EQ("", parsed.timestampUTC);
+    ASSERT_EQ(original.millis, parsed.millis);
+
+    TEST_PASS();
+}
+
 // Test: minimum field count (10) is accepted, less than 10 rejected
 void test_minimum_field_count() {
     SPIFFSStorage storage(100);
@@ -212,6 +245,7 @@ int main() {
     RUN_TEST(nan_fields_roundtrip);
     RUN_TEST(old_format_backward_compat);
     RUN_TEST(zero_gps_no_fix);
+    RUN_TEST(unsynced_timestamp_placeholder);
     RUN_TEST(minimum_field_count);
 
     TEST_SUMMARY();
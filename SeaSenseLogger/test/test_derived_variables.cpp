@@ -0,0 +1,233 @@
+/**
+ * Tests for DerivedVariables — reference values of the formulas and
+ * change-driven recomputation of the dependency graph
+ */
+
+#include <Arduino.h>
+#include "test_framework.h"
+#include "../src/sensors/DerivedVariables.h"
+#include "../src/storage/StorageInterface.h"
+#include "../config/hardware_config.h"
+
+static DataRecord emptyRecord() {
+    SensorData data;
+    data.sensorInstance = 0;
+    data.value = 20.0f;
+    data.quality = SensorQuality::GOOD;
+    data.timestamp = 0;
+    return sensorDataToRecord(data);
+}
+
+// Test: oxygen solubility matches published tables (Weiss 1970)
+void test_oxygen_solubility() {
+    // Fresh water 20 °C: 9.09 mg/L; seawater 35 PSU: 7.37 mg/L; 0 °C fresh: 14.6 mg/L
+    ASSERT_FLOAT_EQ(9.09, DerivedVariables::oxygenSolubility(20.0f, 0.0f, 101325.0f), 0.02);
+    ASSERT_FLOAT_EQ(7.37, DerivedVariables::oxygenSolubility(20.0f, 35.0f, 101325.0f), 0.02);
+    ASSERT_FLOAT_EQ(14.62, DerivedVariables::oxygenSolubility(0.0f, 0.0f, 101325.0f), 0.03);
+
+    // Scales with pressure; no barometer means a standard atmosphere
+    float atm = DerivedVariables::oxygenSolubility(15.0f, 35.0f, 101325.0f);
+    ASSERT_FLOAT_EQ(atm * 0.98, DerivedVariables::oxygenSolubility(15.0f, 35.0f, 101325.0f * 0.98f), 0.001);
+    ASSERT_FLOAT_EQ(atm, DerivedVariables::oxygenSolubility(15.0f, 35.0f, NAN), 0.0001);
+
+    ASSERT_NAN(DerivedVariables::oxygenSolubility(NAN, 35.0f, 101325.0f));
+    ASSERT_NAN(DerivedVariables::oxygenSolubility(15.0f, NAN, 101325.0f));
+
+    TEST_PASS();
+}
+
+// Test: sound speed matches Mackenzie (1981) check values
+void test_sound_speed() {
+    ASSERT_FLOAT_EQ(1521.5, DerivedVariables::soundSpeed(20.0f, 35.0f, 0.0f), 0.1);
+    ASSERT_FLOAT_EQ(1449.0, DerivedVariables::soundSpeed(0.0f, 35.0f, 0.0f), 0.1);
+    // Fresher water is slower
+    ASSERT_TRUE(DerivedVariables::soundSpeed(20.0f, 30.0f, 0.0f) < DerivedVariables::soundSpeed(20.0f, 35.0f, 0.0f));
+    ASSERT_NAN(DerivedVariables::soundSpeed(NAN, 35.0f, 0.0f));
+
+    TEST_PASS();
+}
+
+// Test: true wind from apparent wind and motion over ground
+void test_true_wind() {
+    float tws, twa;
+
+    // Stationary: true wind is the apparent wind
+    ASSERT_TRUE(DerivedVariables::trueWind(8.0f, 45.0f, 0.0f, 0.0f, 90.0f, tws, twa));
+    ASSERT_FLOAT_EQ(8.0, tws, 0.01);
+    ASSERT_FLOAT_EQ(45.0, twa, 0.1);
+
+    // Motoring north at 5 m/s into a 10 m/s northerly: 15 m/s on the nose
+    ASSERT_TRUE(DerivedVariables::trueWind(15.0f, 0.0f, 5.0f, 0.0f, 0.0f, tws, twa));
+    ASSERT_FLOAT_EQ(10.0, tws, 0.01);
+    ASSERT_TRUE(twa < 0.1f || twa > 359.9f);
+
+    // Motoring north at 5 m/s in calm air: 5 m/s headwind, no true wind
+    ASSERT_TRUE(DerivedVariables::trueWind(5.0f, 0.0f, 5.0f, 0.0f, 0.0f, tws, twa));
+    ASSERT_FLOAT_EQ(0.0, tws, 0.01);
+
+    // Heading east, 5 m/s, 10 m/s true wind from the north (port beam):
+    // apparent is 11.18 m/s at 296.6°
+    ASSERT_TRUE(DerivedVariables::trueWind(11.1803f, 296.565f, 5.0f, 90.0f, 90.0f, tws, twa));
+    ASSERT_FLOAT_EQ(10.0, tws, 0.01);
+    ASSERT_FLOAT_EQ(270.0, twa, 0.1);
+
+    ASSERT_FALSE(DerivedVariables::trueWind(8.0f, 45.0f, 2.0f, 0.0f, NAN, tws, twa));
+    ASSERT_NAN(tws);
+    ASSERT_NAN(twa);
+
+    TEST_PASS();
+}
+
+// Test: DO saturation follows DO through the solubility node
+void test_do_saturation_chain() {
+    DerivedVariables dv;
+    dv.setInput(DerivedVar::TEMPERATURE, 20.0f, 0);
+    dv.setInput(DerivedVar::SALINITY, 35.0f, 0);
+    dv.setInput(DerivedVar::DISSOLVED_OXYGEN, 7.37f, 0);
+    dv.update(0);
+    ASSERT_FLOAT_EQ(100.0, dv.get(DerivedVar::DO_SATURATION), 0.5);
+    ASSERT_FLOAT_EQ(1521.5, dv.get(DerivedVar::SOUND_SPEED), 0.1);
+
+    dv.setInput(DerivedVar::DISSOLVED_OXYGEN, 3.685f, 1000);
+    dv.update(1000);
+    ASSERT_FLOAT_EQ(50.0, dv.get(DerivedVar::DO_SATURATION), 0.3);
+
+    TEST_PASS();
+}
+
+// Test: only nodes downstream of a changed input are recomputed
+void test_change_driven() {
+    DerivedVariables dv;
+    dv.setInput(DerivedVar::TEMPERATURE, 20.0f, 0);
+    dv.setInput(DerivedVar::SALINITY, 35.0f, 0);
+    dv.update(0);
+    uint32_t computed = dv.getComputeCount();
+
+    // Nothing changed: nothing recomputed
+    dv.setInput(DerivedVar::TEMPERATURE, 20.0f, 10);
+    dv.update(10);
+    ASSERT_EQ(computed, dv.getComputeCount());
+
+    // New DO: saturation only (solubility, sound speed and wind untouched)
+    dv.setInput(DerivedVar::DISSOLVED_OXYGEN, 7.0f, 20);
+    dv.update(20);
+    ASSERT_EQ(computed + 1, dv.getComputeCount());
+
+    // New temperature: solubility, saturation (via solubility) and sound speed
+    dv.setInput(DerivedVar::TEMPERATURE, 21.0f, 30);
+    dv.update(30);
+    ASSERT_EQ(computed + 4, dv.getComputeCount());
+
+    // Derived values are not inputs
+    dv.setInput(DerivedVar::SOUND_SPEED, 1.0f, 40);
+    ASSERT_TRUE(dv.get(DerivedVar::SOUND_SPEED) > 1500.0f);
+
+    TEST_PASS();
+}
+
+// Test: an input not refreshed this cycle drops out
+void test_stale_input() {
+    DerivedVariables dv;
+    dv.setInput(DerivedVar::TEMPERATURE, 20.0f, 0);
+    dv.setInput(DerivedVar::SALINITY, 35.0f, 0);
+    dv.update(0);
+    ASSERT_TRUE(dv.get(DerivedVar::SOUND_SPEED) > 1500.0f);
+
+    dv.setInput(DerivedVar::TEMPERATURE, 20.5f, DERIVED_INPUT_MAX_AGE_MS + 1);
+    dv.update(DERIVED_INPUT_MAX_AGE_MS + 1);
+    ASSERT_NAN(dv.get(DerivedVar::SALINITY));
+    ASSERT_NAN(dv.get(DerivedVar::SOUND_SPEED));
+
+    TEST_PASS();
+}
+
+// Test: apply() stamps derived values, bus true wind wins over ours
+void test_apply_record() {
+    DerivedVariables dv;
+    dv.setInput(DerivedVar::TEMPERATURE, 20.0f, 0);
+    dv.setInput(DerivedVar::SALINITY, 35.0f, 0);
+    dv.setInput(DerivedVar::DISSOLVED_OXYGEN, 7.37f, 0);
+
+    DataRecord r = emptyRecord();
+    r.windSpeedApparent = 15.0f;
+    r.windAngleApparent = 0.0f;
+    r.sog = 5.0f;
+    r.cogTrue = 0.0f;
+    r.heading = 0.0f;
+    dv.apply(r, 0);
+    ASSERT_FLOAT_EQ(100.0, r.doSaturation, 0.5);
+    ASSERT_FLOAT_EQ(1521.5, r.soundSpeed, 0.1);
+    ASSERT_FLOAT_EQ(10.0, r.windSpeedTrue, 0.01);
+
+    DataRecord fromBus = emptyRecord();
+    fromBus.windSpeedApparent = 15.0f;
+    fromBus.windAngleApparent = 0.0f;
+    fromBus.sog = 5.0f;
+    fromBus.cogTrue = 0.0f;
+    fromBus.heading = 0.0f;
+    fromBus.windSpeedTrue = 9.5f;
+    fromBus.windAngleTrue = 2.0f;
+    dv.apply(fromBus, 0);
+    ASSERT_FLOAT_EQ(9.5, fromBus.windSpeedTrue, 0.001);
+    ASSERT_FLOAT_EQ(2.0, fromBus.windAngleTrue, 0.001);
+
+    // Tilt-corrected apparent wind is preferred
+    DataRecord tilted = emptyRecord();
+    tilted.windSpeedApparent = 99.0f;
+    tilted.windAngleApparent = 0.0f;
+    tilted.windSpeedCorrected = 15.0f;
+    tilted.windAngleCorrected = 0.0f;
+    tilted.sog = 5.0f;
+    tilted.cogTrue = 0.0f;
+    tilted.heading = 0.0f;
+    dv.apply(tilted, 0);
+    ASSERT_FLOAT_EQ(10.0, tilted.windSpeedTrue, 0.01);
+
+    TEST_PASS();
+}
+
+// Test: only values whose inputs were read this cycle are stamped
+void test_previous_cycle_not_stamped() {
+    DerivedVariables dv;
+    dv.beginCycle();
+    dv.setInput(DerivedVar::TEMPERATURE, 20.0f, 0);
+    dv.setInput(DerivedVar::SALINITY, 35.0f, 0);
+    dv.setInput(DerivedVar::DISSOLVED_OXYGEN, 7.37f, 0);
+    DataRecord doRecord = emptyRecord();
+    dv.apply(doRecord, 0);
+    ASSERT_FLOAT_EQ(100.0, doRecord.doSaturation, 0.5);
+
+    // Next cycle: the temperature record comes before salinity and DO
+    dv.beginCycle();
+    dv.setInput(DerivedVar::TEMPERATURE, 20.0f, 1000);
+    DataRecord tempRecord = emptyRecord();
+    dv.apply(tempRecord, 1000);
+    ASSERT_NAN(tempRecord.doSaturation);
+    ASSERT_NAN(tempRecord.soundSpeed);
+
+    // Salinity read, DO read failed: sound speed yes, saturation no
+    dv.setInput(DerivedVar::SALINITY, 35.0f, 2000);
+    DataRecord ecRecord = emptyRecord();
+    dv.apply(ecRecord, 2000);
+    ASSERT_FLOAT_EQ(1521.5, ecRecord.soundSpeed, 0.1);
+    ASSERT_NAN(ecRecord.doSaturation);
+    ASSERT_FALSE(dv.isCurrent(DerivedVar::DO_SATURATION));
+    ASSERT_TRUE(dv.get(DerivedVar::DO_SATURATION) > 0.0f);  // kept, just not stamped
+
+    TEST_PASS();
+}
+
+int main() {
+    TEST_SUITE("DerivedVariables");
+
+    RUN_TEST(oxygen_solubility);
+    RUN_TEST(sound_speed);
+    RUN_TEST(true_wind);
+    RUN_TEST(do_saturation_chain);
+    RUN_TEST(change_driven);
+    RUN_TEST(stale_input);
+    RUN_TEST(apply_record);
+    RUN_TEST(previous_cycle_not_stamped);
+
+    TEST_SUMMARY();
+}
@@ -0,0 +1,216 @@
+/**
+ * Tests for EventLog — deferred argument capture, formatting from the
+ * stored types, level filtering, ring overrun and /api/logs queries
+ */
+
+#include <Arduino.h>
+#include "test_framework.h"
+#include "../src/system/EventLog.h"
+
+EventLog eventLog;
+
+static String render(const LogEntry& e) {
+    char buf[LOG_LINE_BYTES];
+    EventLog::format(e, buf, sizeof(buf));
+    return String(buf);
+}
+
+// Newest event in the ring, formatted
+static String last(EventLog& log) {
+    static LogEntry out[LOG_RING_SIZE];
+    uint32_t next;
+    size_t n = log.query(0, LogLevel::DEBUG, nullptr, out, LOG_RING_SIZE, next);
+    return n > 0 ? render(out[n - 1]) : String("");
+}
+
+// Test: events above the runtime level cost nothing and are not captured
+void test_level_filter() {
+    EventLog log;
+    ASSERT_TRUE(log.getLevel() == LogLevel::INFO);
+
+    log.log(LogLevel::DEBUG, "T", "hidden");
+    ASSERT_EQ(0u, log.getCapturedCount());
+
+    log.log(LogLevel::WARN, "T", "shown");
+    ASSERT_EQ(1u, log.getCapturedCount());
+
+    log.setLevel(LogLevel::DEBUG);
+    log.log(LogLevel::DEBUG, "T", "now shown");
+    ASSERT_EQ(2u, log.getCapturedCount());
+
+    log.setLevel(LogLevel::ERROR);
+    ASSERT_FALSE(log.isEnabled(LogLevel::WARN));
+    ASSERT_TRUE(log.isEnabled(LogLevel::ERROR));
+
+    TEST_PASS();
+}
+
+// Test: arguments are stored raw and formatted later with the spec's flags
+void test_format_args() {
+    EventLog log;
+    String status = "3D fix";
+    uint8_t sats = 9;
+    unsigned long now = 4000000000UL;
+
+    log.log(LogLevel::INFO, "GPS", "%.6f, %.6f (%d sats, HDOP: %.1f) %s",
+            52.123456, 4.5, sats, 1.25f, status);
+    ASSERT_STR_EQ("52.123456, 4.500000 (9 sats, HDOP: 1.2) 3D fix", last(log));
+
+    log.log(LogLevel::INFO, "T", "%lu ms, %ld, %5d|%-3u|%x, 100%%", now, -42L, 7, 8u, 255);
+    ASSERT_STR_EQ("4000000000 ms, -42,     7|8  |ff, 100%", last(log));
+
+    log.log(LogLevel::INFO, "T", "no args");
+    ASSERT_STR_EQ("no args", last(log));
+
+    // Missing argument
+    log.log(LogLevel::INFO, "T", "%d and %d", 1);
+    ASSERT_STR_EQ("1 and ?", last(log));
+
+    TEST_PASS();
+}
+
+// Test: the stored type wins where it disagrees with the conversion
+void test_format_type_mismatch() {
+    EventLog log;
+    log.log(LogLevel::INFO, "T", "%d|%.1f|%s|%s|%d", 2.9f, 3, 12, 0.5f, "txt");
+    ASSERT_STR_EQ("2|3.0|12|0.5|txt", last(log));
+
+    TEST_PASS();
+}
+
+// Test: strings are copied (caller's buffer may change) and truncated to the slot
+void test_string_capture() {
+    EventLog log;
+    char buf[16] = "before";
+    log.log(LogLevel::INFO, "T", "%s", buf);
+    strcpy(buf, "after");
+    ASSERT_STR_EQ("before", last(log));
+
+    String longText(std::string(100, 'x').c_str());
+    log.log(LogLevel::INFO, "T", "%s|%s", longText, "lost");
+    String out = last(log);
+    ASSERT_EQ((size_t)LogEntry::TEXT_BYTES, out.length());   // 47 x's and '|'
+    ASSERT_TRUE(out.endsWith("|"));
+
+    const char* none = nullptr;
+    log.log(LogLevel::INFO, "T", "%s", none);
+    ASSERT_STR_EQ("(null)", last(log));
+
+    TEST_PASS();
+}
+
+// Test: output is cut at the buffer, always terminated
+void test_format_truncation() {
+    EventLog log;
+    log.log(LogLevel::INFO, "T", "value %d and more text", 123456);
+    static LogEntry out[LOG_RING_SIZE];
+    uint32_t next;
+    log.query(0, LogLevel::DEBUG, nullptr, out, 1, next);
+
+    char small[10];
+    ASSERT_EQ(9u, EventLog::format(out[0], small, sizeof(small)));
+    ASSERT_STR_EQ("value 123", small);
+
+    char tiny[4];
+    ASSERT_EQ(3u, EventLog::format(out[0], tiny, sizeof(tiny)));
+    ASSERT_STR_EQ("val", tiny);
+
+    TEST_PASS();
+}
+
+// Test: a full ring overwrites the oldest; the sinks count what they missed
+void test_overrun() {
+    EventLog log;
+    for (int i = 0; i < LOG_RING_SIZE + 10; i++) {
+        log.log(LogLevel::INFO, "T", "event %d", i);
+    }
+    ASSERT_EQ((uint32_t)LOG_RING_SIZE, log.getPendingCount());
+
+    uint16_t written = log.drain(LOG_RING_SIZE * 2, false);
+    ASSERT_EQ(LOG_RING_SIZE, (int)written);
+    ASSERT_EQ(10u, log.getLostCount());
+    ASSERT_EQ(0u, log.getPendingCount());
+
+    // Batches stop at maxEvents
+    for (int i = 0; i < 5; i++) {
+        log.log(LogLevel::INFO, "T", "event %d", i);
+    }
+    ASSERT_EQ(2, (int)log.drain(2, false));
+    ASSERT_EQ(3u, log.getPendingCount());
+    log.flush(false);
+    ASSERT_EQ(0u, log.getPendingCount());
+
+    TEST_PASS();
+}
+
+// Test: queries page by sequence number and filter by level and tag
+void test_query() {
+    EventLog log;
+    log.setLevel(LogLevel::DEBUG);
+    log.log(LogLevel::INFO, "GPS", "fix");
+    log.log(LogLevel::DEBUG, "API", "payload %d", 10);
+    log.log(LogLevel::WARN, "API", "retry");
+    log.log(LogLevel::ERROR, "STORAGE", "write failed");
+
+    static LogEntry out[LOG_RING_SIZE];
+    uint32_t next;
+    ASSERT_EQ(4u, log.query(0, LogLevel::DEBUG, nullptr, out, LOG_RING_SIZE, next));
+    ASSERT_EQ(4u, next);
+    ASSERT_EQ(0u, out[0].seq);
+    ASSERT_STR_EQ("GPS", out[0].tag);
+
+    ASSERT_EQ(2u, log.query(0, LogLevel::WARN, nullptr, out, LOG_RING_SIZE, next));
+    ASSERT_STR_EQ("retry", render(out[0]));
+
+    ASSERT_EQ(2u, log.query(0, LogLevel::DEBUG, "api", out, LOG_RING_SIZE, next));
+    ASSERT_STR_EQ("payload 10", render(out[0]));
+
+    // Paging
+    ASSERT_EQ(1u, log.query(0, LogLevel::DEBUG, nullptr, out, 1, next));
+    ASSERT_EQ(1u, next);
+    ASSERT_EQ(3u, log.query(next, LogLevel::DEBUG, nullptr, out, LOG_RING_SIZE, next));
+    ASSERT_EQ(0u, log.query(next, LogLevel::DEBUG, nullptr, out, LOG_RING_SIZE, next));
+
+    // A since from before the ring or from a previous boot restarts at the oldest
+    for (int i = 0; i < LOG_RING_SIZE; i++) {
+        log.log(LogLevel::INFO, "T", "%d", i);
+    }
+    ASSERT_EQ(2u, log.query(2, LogLevel::DEBUG, nullptr, out, 2, next));
+    ASSERT_EQ(4u, out[0].seq);
+    ASSERT_EQ(1u, log.query(100000, LogLevel::DEBUG, nullptr, out, 1, next));
+    ASSERT_EQ(4u, out[0].seq);
+
+    TEST_PASS();
+}
+
+// Test: level names for the serial command and the web API
+void test_parse_level() {
+    LogLevel level;
+    ASSERT_TRUE(EventLog::parseLevel(" Debug ", level));
+    ASSERT_TRUE(level == LogLevel::DEBUG);
+    ASSERT_TRUE(EventLog::parseLevel("warning", level));
+    ASSERT_TRUE(level == LogLevel::WARN);
+    ASSERT_TRUE(EventLog::parseLevel("0", level));
+    ASSERT_TRUE(level == LogLevel::ERROR);
+    ASSERT_FALSE(EventLog::parseLevel("verbose", level));
+    ASSERT_TRUE(level == LogLevel::ERROR);
+
+    ASSERT_STR_EQ("info", EventLog::levelName(LogLevel::INFO));
+
+    TEST_PASS();
+}
+
+int main() {
+    TEST_SUITE("EventLog");
+
+    RUN_TEST(level_filter);
+    RUN_TEST(format_args);
+    RUN_TEST(format_type_mismatch);
+    RUN_TEST(string_capture);
+    RUN_TEST(format_truncation);
+    RUN_TEST(overrun);
+    RUN_TEST(query);
+    RUN_TEST(parse_level);
+
+    TEST_SUMMARY();
+}
@@ -0,0 +1,248 @@
+/**
+ * Tests for FlightRecorder — stage transitions and durations, the RTC record
+ * surviving a "reboot", rejection of power-on noise, and warning capture
+ */
+
+#include <Arduino.h>
+#include "test_framework.h"
+#include "../src/system/EventLog.h"
+#include "../src/system/FlightRecorder.h"
+
+EventLog eventLog;
+
+static const char* STAGE_GPS = "gps:update";
+static const char* STAGE_SENSORS = "sensors:cycle";
+static const char* STAGE_UPLOAD = "upload:process";
+
+// The record outlives the recorder, as RTC memory outlives a boot
+static FlightRecord rtc;
+
+// Test: each stage change records the previous stage and how long it ran
+void test_stage_durations() {
+    memset(&rtc, 0, sizeof(rtc));
+    FlightRecorder fr(rtc);
+    fr.begin(1, "abc1234");
+    ASSERT_FALSE(fr.hasPostMortem());
+
+    fr.stage(STAGE_GPS, 1000);
+    fr.stage(STAGE_GPS, 1005);          // same stage: no transition
+    fr.stage(STAGE_SENSORS, 1010);
+    fr.stage(STAGE_UPLOAD, 1510);
+    fr.stage(STAGE_GPS, 1520);
+    fr.stage(STAGE_SENSORS, 1530);
+
+    ASSERT_EQ(4, (int)rtc.stageCount);
+    const FlightStage& first = FlightRecorder::stageAt(rtc, 0);
+    ASSERT_STR_EQ("gps:update", FlightRecorder::stageName(rtc, first.name));
+    ASSERT_EQ(1000u, first.startMs);
+    ASSERT_EQ(10, (int)first.durationMs);
+    ASSERT_EQ(500, (int)FlightRecorder::stageAt(rtc, 1).durationMs);
+
+    ASSERT_STR_EQ("sensors:cycle", FlightRecorder::stageName(rtc, rtc.stage));
+    ASSERT_EQ(1530u, rtc.stageStartMs);
+    ASSERT_EQ(3, (int)rtc.nameCount);
+
+    // Slowest pass per stage
+    ASSERT_EQ(500, (int)rtc.stageMaxMs[1]);
+    ASSERT_EQ(10, (int)rtc.stageMaxMs[0]);
+
+    TEST_PASS();
+}
+
+// Test: the ring keeps the newest transitions; long stages saturate
+void test_stage_ring_wrap() {
+    memset(&rtc, 0, sizeof(rtc));
+    FlightRecorder fr(rtc);
+    fr.begin(1, "");
+
+    unsigned long t = 0;
+    for (int i = 0; i < FLIGHT_STAGE_HISTORY + 5; i++) {
+        fr.stage(i % 2 ? STAGE_GPS : STAGE_SENSORS, t);
+        t += i;
+    }
+    ASSERT_EQ(FLIGHT_STAGE_HISTORY, (int)rtc.stageCount);
+    // Call i closes the stage entered at call i - 1, which lasted i - 1 ms;
+    // the oldest of the last FLIGHT_STAGE_HISTORY is closed by call 5
+    ASSERT_EQ(4, (int)FlightRecorder::stageAt(rtc, 0).durationMs);
+    ASSERT_EQ(FLIGHT_STAGE_HISTORY + 3,
+              (int)FlightRecorder::stageAt(rtc, FLIGHT_STAGE_HISTORY - 1).durationMs);
+
+    fr.stage(STAGE_UPLOAD, t + 100000);
+    ASSERT_EQ(0xFFFF, (int)FlightRecorder::stageAt(rtc, FLIGHT_STAGE_HISTORY - 1).durationMs);
+
+    TEST_PASS();
+}
+
+// Test: a reboot hands the last record over as the post-mortem and starts fresh
+void test_reboot_post_mortem() {
+    memset(&rtc, 0, sizeof(rtc));
+    {
+        FlightRecorder fr(rtc);
+        fr.begin(7, "abc1234");
+        fr.stage(STAGE_GPS, 100);
+        fr.stage(STAGE_UPLOAD, 200);
+        fr.loopStart(250, 40);
+        fr.loopStart(300, 50);
+        fr.sample(300, 120000, 90000, 60000, 1760000000);
+        fr.stage(STAGE_UPLOAD, 31000);  // hung here until the watchdog fired
+    }
+
+    FlightRecorder next(rtc);
+    next.begin(8, "abc1234");
+    ASSERT_TRUE(next.hasPostMortem());
+    ASSERT_TRUE(next.hasPostMortemRecord());
+
+    const FlightRecord& pm = next.getPostMortem();
+    ASSERT_EQ(7u, pm.bootCount);
+    ASSERT_STR_EQ("abc1234", pm.firmware);
+    ASSERT_STR_EQ("upload:process", FlightRecorder::stageName(pm, pm.stage));
+    ASSERT_EQ(200u, pm.stageStartMs);
+    ASSERT_EQ(31000u, pm.lastMs);
+    ASSERT_EQ(2u, pm.loopCount);
+    ASSERT_EQ(50u, pm.maxGapMs);
+    ASSERT_EQ(90000u, pm.minFreeHeap);
+    ASSERT_EQ(1760000000u, pm.epoch);
+
+    // The live record starts over for this boot
+    ASSERT_EQ(8u, rtc.bootCount);
+    ASSERT_EQ(0, (int)rtc.stageCount);
+    ASSERT_EQ((int)FlightRecorder::NO_STAGE, (int)rtc.stage);
+
+    next.clearPostMortem();
+    ASSERT_FALSE(next.hasPostMortem());
+    ASSERT_FALSE(next.hasPostMortemRecord());
+
+    TEST_PASS();
+}
+
+// Test: the reset reason is kept; ESP.restart() is not a crash
+void test_deliberate_restart_not_reported() {
+    memset(&rtc, 0, sizeof(rtc));
+    {
+        FlightRecorder fr(rtc);
+        fr.begin(3, "abc1234");
+        fr.stage(STAGE_UPLOAD, 100);
+    }
+
+    _mock_reset_reason = ESP_RST_SW;    // OTA finished, recovery, web restart
+    FlightRecorder afterRestart(rtc);
+    afterRestart.begin(4, "abc1234");
+    ASSERT_FALSE(afterRestart.hasPostMortem());
+    ASSERT_TRUE(afterRestart.hasPostMortemRecord());
+    ASSERT_EQ((int)ESP_RST_SW, (int)afterRestart.getPostMortem().resetReason);
+
+    afterRestart.stage(STAGE_GPS, 200);
+    _mock_reset_reason = ESP_RST_TASK_WDT;
+    FlightRecorder afterHang(rtc);
+    afterHang.begin(5, "abc1234");
+    ASSERT_TRUE(afterHang.hasPostMortem());
+    ASSERT_EQ((int)ESP_RST_TASK_WDT, (int)afterHang.getPostMortem().resetReason);
+    ASSERT_STR_EQ("gps:update", FlightRecorder::stageName(afterHang.getPostMortem(),
+                                                          afterHang.getPostMortem().stage));
+
+    _mock_reset_reason = ESP_RST_POWERON;
+    TEST_PASS();
+}
+
+// Test: power-on noise and damaged records are not reported
+void test_rejects_noise() {
+    memset(&rtc, 0xA5, sizeof(rtc));
+    FlightRecorder fr(rtc);
+    fr.begin(1, "");
+    ASSERT_FALSE(fr.hasPostMortem());
+    ASSERT_TRUE(FlightRecorder::isValid(rtc));
+
+    FlightRecord bad = rtc;
+    bad.stageHead = FLIGHT_STAGE_HISTORY;
+    ASSERT_FALSE(FlightRecorder::isValid(bad));
+
+    bad = rtc;
+    bad.stage = 3;                      // no such name
+    ASSERT_FALSE(FlightRecorder::isValid(bad));
+
+    bad = rtc;
+    bad.version = FlightRecorder::VERSION + 1;
+    ASSERT_FALSE(FlightRecorder::isValid(bad));
+
+    // Unterminated strings that pass the checks are cut at the copy
+    fr.stage(STAGE_GPS, 10);
+    memset(rtc.firmware, 'x', sizeof(rtc.firmware));
+    memset(rtc.names[0], 'y', sizeof(rtc.names[0]));
+    FlightRecorder next(rtc);
+    next.begin(2, "");
+    ASSERT_TRUE(next.hasPostMortem());
+    ASSERT_EQ(sizeof(rtc.firmware) - 1, strlen(next.getPostMortem().firmware));
+    ASSERT_EQ(sizeof(rtc.names[0]) - 1, strlen(next.getPostMortem().names[0]));
+
+    TEST_PASS();
+}
+
+// Test: a full name table maps further stages to "other"
+void test_name_overflow() {
+    memset(&rtc, 0, sizeof(rtc));
+    FlightRecorder fr(rtc);
+    fr.begin(1, "");
+
+    static char names[FLIGHT_STAGE_NAMES + 2][16];
+    for (int i = 0; i < FLIGHT_STAGE_NAMES + 2; i++) {
+        snprintf(names[i], sizeof(names[i]), "stage:%d", i);
+        fr.stage(names[i], i * 10);
+    }
+    ASSERT_EQ(FLIGHT_STAGE_NAMES, (int)rtc.nameCount);
+    ASSERT_STR_EQ("other", FlightRecorder::stageName(rtc, rtc.stage));
+    ASSERT_TRUE(FlightRecorder::isValid(rtc));
+
+    TEST_PASS();
+}
+
+// Test: warnings from the event log land formatted in the record
+void test_records_warnings() {
+    memset(&rtc, 0, sizeof(rtc));
+    static FlightRecorder* current = nullptr;
+    FlightRecorder fr(rtc);
+    fr.begin(1, "");
+    current = &fr;
+
+    EventLog log;
+    log.setWarningHook([](const LogEntry& e) { current->recordLog(e); });
+
+    _mock_millis = 4242;
+    log.log(LogLevel::INFO, "API", "not kept");
+    log.log(LogLevel::WARN, "API", "Upload failed: %s", "HTTP 503");
+    log.log(LogLevel::ERROR, "STORAGE_LONG_TAG", "Failed to write %d bytes", 512);
+    ASSERT_EQ(2, (int)rtc.eventCount);
+
+    const FlightEvent& w = FlightRecorder::eventAt(rtc, 0);
+    ASSERT_EQ(4242u, w.ms);
+    ASSERT_EQ((int)LogLevel::WARN, (int)w.level);
+    ASSERT_STR_EQ("API", w.tag);
+    ASSERT_STR_EQ("Upload failed: HTTP 503", w.msg);
+
+    const FlightEvent& e = FlightRecorder::eventAt(rtc, 1);
+    ASSERT_STR_EQ("STORAGE_LO", e.tag);
+    ASSERT_STR_EQ("Failed to write 512 bytes", e.msg);
+
+    // Only the newest are kept
+    for (int i = 0; i < FLIGHT_EVENT_HISTORY + 3; i++) {
+        log.log(LogLevel::WARN, "T", "warning %d", i);
+    }
+    ASSERT_EQ(FLIGHT_EVENT_HISTORY, (int)rtc.eventCount);
+    ASSERT_STR_EQ("warning 3", FlightRecorder::eventAt(rtc, 0).msg);
+
+    _mock_millis = 0;
+    TEST_PASS();
+}
+
+int main() {
+    TEST_SUITE("FlightRecorder");
+
+    RUN_TEST(stage_durations);
+    RUN_TEST(stage_ring_wrap);
+    RUN_TEST(reboot_post_mortem);
+    RUN_TEST(deliberate_restart_not_reported);
+    RUN_TEST(rejects_noise);
+    RUN_TEST(name_overflow);
+    RUN_TEST(records_warnings);
+
+    TEST_SUMMARY();
+}
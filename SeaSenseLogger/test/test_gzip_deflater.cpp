@@ -0,0 +1,157 @@
+/**
+ * Tests for GzipDeflater — output must inflate back to the input with
+ * zlib (which also checks the gzip CRC and size), whatever the chunking
+ */
+
+#include <Arduino.h>
+#include "test_framework.h"
+#include "../src/webui/GzipDeflater.h"
+#include <stdlib.h>
+#include <string>
+#include <vector>
+#include <zlib.h>
+
+// Compress input fed in pieces of `step` bytes
+static std::vector<uint8_t> compress(const std::string& input, size_t step, size_t* largest = nullptr) {
+    std::vector<uint8_t> out;
+    GzipDeflater gz;
+    gz.begin([&](const uint8_t* data, size_t len) {
+        out.insert(out.end(), data, data + len);
+        if (largest && len > *largest) *largest = len;
+        return true;
+    });
+    for (size_t i = 0; i < input.size(); i += step) {
+        size_t n = input.size() - i < step ? input.size() - i : step;
+        gz.feed((const uint8_t*)input.data() + i, n);
+    }
+    gz.finish();
+    gz.end();
+    return out;
+}
+
+// Inflate with zlib in gzip mode; false on any stream or trailer error
+static bool inflateGzip(const std::vector<uint8_t>& in, std::string& out) {
+    z_stream zs = {};
+    if (inflateInit2(&zs, 16 + MAX_WBITS) != Z_OK) return false;
+    zs.next_in = (Bytef*)in.data();
+    zs.avail_in = in.size();
+    char buf[4096];
+    int rc;
+    do {
+        zs.next_out = (Bytef*)buf;
+        zs.avail_out = sizeof(buf);
+        rc = inflate(&zs, Z_NO_FLUSH);
+        out.append(buf, sizeof(buf) - zs.avail_out);
+    } while (rc == Z_OK);
+    inflateEnd(&zs);
+    return rc == Z_STREAM_END && zs.avail_in == 0;
+}
+
+static std::string recordsJSON(int count) {
+    std::string s = "{\"total\":12345,\"page\":0,\"limit\":200,\"records\":[";
+    char rec[160];
+    for (int i = 0; i < count; i++) {
+        snprintf(rec, sizeof(rec),
+                 "%s{\"millis\":%d,\"time\":\"2025-06-15T12:%02d:%02dZ\",\"type\":\"%s\",\"value\":%.2f,\"unit\":\"%s\",\"quality\":\"good\"}",
+                 i ? "," : "", 1000000 + i * 15000, (i / 4) % 60, (i * 15) % 60,
+                 i % 2 ? "Conductivity" : "Temperature", 18.0 + i * 0.01, i % 2 ? "uS/cm" : "C");
+        s += rec;
+    }
+    return s + "]}";
+}
+
+// Test: a records page round-trips and shrinks by a large factor
+void test_json_roundtrip() {
+    std::string json = recordsJSON(200);
+    size_t largest = 0;
+    std::vector<uint8_t> gz = compress(json, 256, &largest);
+
+    std::string back;
+    ASSERT_TRUE(inflateGzip(gz, back));
+    ASSERT_TRUE(back == json);
+    ASSERT_TRUE(largest <= GzipDeflater::OUTPUT_SIZE);
+
+    double ratio = (double)json.size() / gz.size();
+    printf("    %zu -> %zu bytes (%.1fx)\n", json.size(), gz.size(), ratio);
+    ASSERT_TRUE(ratio > 4.0);
+
+    TEST_PASS();
+}
+
+// Test: chunking does not change the result, down to single bytes
+void test_chunking() {
+    std::string json = recordsJSON(40);
+    std::vector<uint8_t> whole = compress(json, json.size());
+    size_t steps[] = {1, 7, 255, 258, 1024, 2049};
+    for (size_t step : steps) {
+        std::vector<uint8_t> gz = compress(json, step);
+        std::string back;
+        ASSERT_TRUE(inflateGzip(gz, back));
+        ASSERT_TRUE(back == json);
+        ASSERT_TRUE(gz == whole);
+    }
+    TEST_PASS();
+}
+
+// Test: edge inputs — empty, long runs (max-length overlapping matches),
+// and data that does not compress
+void test_edge_inputs() {
+    std::string back;
+    ASSERT_TRUE(inflateGzip(compress("", 16), back));
+    ASSERT_TRUE(back.empty());
+
+    std::string run(5000, 'a');
+    run += "bcd";
+    std::vector<uint8_t> gz = compress(run, 300);
+    back.clear();
+    ASSERT_TRUE(inflateGzip(gz, back));
+    ASSERT_TRUE(back == run);
+    ASSERT_TRUE(gz.size() < 100);
+
+    srand(42);
+    std::string noise;
+    for (int i = 0; i < 10000; i++) noise += (char)(rand() & 0xFF);
+    gz = compress(noise, 256);
+    back.clear();
+    ASSERT_TRUE(inflateGzip(gz, back));
+    ASSERT_TRUE(back == noise);
+    // Fixed Huffman spends at most 9 bits per literal
+    ASSERT_TRUE(gz.size() < noise.size() * 9 / 8 + 32);
+
+    TEST_PASS();
+}
+
+// Test: counters, and a failing sink stops the stream
+void test_counters_and_failure() {
+    std::string json = recordsJSON(20);
+    size_t sent = 0;
+    GzipDeflater gz;
+    ASSERT_TRUE(gz.begin([&](const uint8_t*, size_t len) { sent += len; return true; }));
+    ASSERT_TRUE(gz.isActive());
+    ASSERT_TRUE(gz.feed((const uint8_t*)json.data(), json.size()));
+    ASSERT_TRUE(gz.finish());
+    ASSERT_EQ(json.size(), (size_t)gz.getInputBytes());
+    ASSERT_EQ(sent, (size_t)gz.getOutputBytes());
+    gz.end();
+    ASSERT_FALSE(gz.isActive());
+
+    ASSERT_TRUE(gz.begin([](const uint8_t*, size_t) { return false; }));
+    std::string big = recordsJSON(200);
+    ASSERT_FALSE(gz.feed((const uint8_t*)big.data(), big.size()));
+    ASSERT_FALSE(gz.finish());
+    ASSERT_TRUE(gz.getErrorMessage().length() > 0);
+    gz.end();
+
+    TEST_PASS();
+}
+
+int main() {
+    TEST_SUITE("gzip Deflater");
+
+    RUN_TEST(json_roundtrip);
+    RUN_TEST(chunking);
+    RUN_TEST(edge_inputs);
+    RUN_TEST(counters_and_failure);
+
+    TEST_SUMMARY();
+}
@@ -0,0 +1,161 @@
+/**
+ * Tests for the replay seams — a short capture built in memory is walked
+ * the way replay_capture does and fed to GPSModule::feed() and
+ * BNO085Module::ingestReport(), with millis() following the record times.
+ * (TinyGPS++ is the stand-in from mocks/; `make replay` links the real one.)
+ */
+
+#include <Arduino.h>
+#include "test_framework.h"
+
+#define private public
+#include "../src/sensors/GPSModule.h"
+#include "../src/sensors/BNO085Module.h"
+#undef private
+
+#include "../src/replay/CaptureFormat.h"
+#include "../config/hardware_config.h"
+#include <cmath>
+#include <string>
+
+// "$<body>*<checksum>\r\n"
+static std::string sentence(const char* body) {
+    uint8_t sum = 0;
+    for (const char* p = body; *p; p++) sum ^= (uint8_t)*p;
+    char tail[8];
+    snprintf(tail, sizeof(tail), "*%02X\r\n", sum);
+    return std::string("$") + body + tail;
+}
+
+// UART reads arrive in arbitrary chunks: split the stream like update() does
+static void appendGps(CaptureWriter& w, unsigned long& now, const std::string& bytes, size_t chunk) {
+    for (size_t i = 0; i < bytes.size(); i += chunk) {
+        size_t n = bytes.size() - i < chunk ? bytes.size() - i : chunk;
+        w.append(CaptureType::GPS_BYTES, now, (const uint8_t*)bytes.data() + i, (uint16_t)n);
+        now += 5;
+    }
+}
+
+// Same dispatch as replay_capture
+static void replay(const CaptureWriter& w, GPSModule& gps, BNO085Module& imu,
+                   unsigned long untilMs = (unsigned long)-1) {
+    CaptureReader reader(w.data(), w.size());
+    if (!reader.begin()) return;
+    CaptureRecord rec;
+    while (reader.next(rec) && rec.timeMs <= untilMs) {
+        _mock_millis = rec.timeMs;
+        if (rec.type == CaptureType::GPS_BYTES) {
+            gps.feed(rec.payload, rec.length);
+        } else if (rec.type == CaptureType::IMU_REPORT) {
+            ImuReportKind kind;
+            float v[4];
+            if (CaptureReader::decodeImuReport(rec, kind, v)) {
+                imu.ingestReport(kind, v);
+            }
+        }
+    }
+}
+
+// Test: NMEA split across records gives the fix the sentences describe
+void test_gps_replay() {
+    static uint8_t buf[1024];
+    CaptureWriter w(buf, sizeof(buf));
+    ASSERT_TRUE(w.begin(1000));
+    unsigned long now = 1000;
+
+    std::string stream =
+        sentence("GPGGA,101502.00,5230.000,N,00445.000,E,1,08,0.9,12.3,M,46.9,M,,") +
+        sentence("GPRMC,101502.00,A,5230.000,N,00445.000,E,5.2,181.0,010626,,,A");
+    appendGps(w, now, stream, 17);
+
+    GPSModule gps(0, 0);
+    BNO085Module imu;
+    replay(w, gps, imu);
+
+    ASSERT_TRUE(gps.hasValidFix());
+    GPSData d = gps.getData();
+    ASSERT_FLOAT_EQ(52.5f, (float)d.latitude, 1e-5f);
+    ASSERT_FLOAT_EQ(4.75f, (float)d.longitude, 1e-5f);
+    ASSERT_FLOAT_EQ(12.3f, (float)d.altitude, 1e-3f);
+    ASSERT_EQ(8, d.satellites);
+    ASSERT_FLOAT_EQ(0.9f, (float)d.hdop, 1e-3f);
+    ASSERT_STR_EQ("2026-06-01T10:15:02Z", gps.getTimeUTC().c_str());
+
+    TEST_PASS();
+}
+
+// Test: a sentence damaged in the capture leaves the last fix in place
+void test_gps_replay_bad_checksum() {
+    static uint8_t buf[1024];
+    CaptureWriter w(buf, sizeof(buf));
+    ASSERT_TRUE(w.begin(0));
+    unsigned long now = 10;
+
+    appendGps(w, now, sentence("GPGGA,101502.00,5230.000,N,00445.000,E,1,08,0.9,12.3,M,46.9,M,,")
+                    + sentence("GPRMC,101502.00,A,5230.000,N,00445.000,E,5.2,181.0,010626,,,A"), 64);
+    std::string bad = sentence("GPRMC,101503.00,A,5300.000,N,00500.000,E,5.2,181.0,010626,,,A");
+    bad[10] = '9';
+    appendGps(w, now, bad, 64);
+
+    GPSModule gps(0, 0);
+    BNO085Module imu;
+    replay(w, gps, imu);
+
+    ASSERT_TRUE(gps.hasValidFix());
+    ASSERT_FLOAT_EQ(52.5f, (float)gps.getData().latitude, 1e-5f);
+    ASSERT_EQ(2, gps.getData().second);
+
+    TEST_PASS();
+}
+
+// Test: IMU reports give pitch, roll and acceleration, and go stale with time
+void test_imu_replay() {
+    static uint8_t buf[256];
+    CaptureWriter w(buf, sizeof(buf));
+    ASSERT_TRUE(w.begin(5000));
+
+    // Bow up 10 degrees (rotation about Y), then starboard down 20 (about X)
+    float p = -10.0f * (float)M_PI / 180.0f / 2.0f;
+    float r = 20.0f * (float)M_PI / 180.0f / 2.0f;
+    ASSERT_TRUE(w.appendImuReport(5010, ImuReportKind::ROTATION_VECTOR, 0.0f, sinf(p), 0.0f, cosf(p)));
+    ASSERT_TRUE(w.appendImuReport(5020, ImuReportKind::LINEAR_ACCELERATION, 0.5f, -1.0f, 0.25f, 0.0f));
+    ASSERT_TRUE(w.appendImuReport(5030, ImuReportKind::ROTATION_VECTOR, sinf(r), 0.0f, 0.0f, cosf(r)));
+
+    GPSModule gps(0, 0);
+    BNO085Module imu;
+    imu._initialized = true;
+
+    replay(w, gps, imu, 5020);
+    IMUData m = imu.getSnapshot();
+    ASSERT_TRUE(m.hasOrientation);
+    ASSERT_FLOAT_EQ(10.0f, m.pitch, 0.01f);
+    ASSERT_FLOAT_EQ(0.0f, m.roll, 0.01f);
+    ASSERT_TRUE(m.hasLinAccel);
+    ASSERT_FLOAT_EQ(0.5f, m.linAccelX, 1e-6f);
+    ASSERT_FLOAT_EQ(-1.0f, m.linAccelY, 1e-6f);
+    ASSERT_FLOAT_EQ(0.25f, m.linAccelZ, 1e-6f);
+
+    replay(w, gps, imu);
+    m = imu.getSnapshot();
+    ASSERT_FLOAT_EQ(0.0f, m.pitch, 0.01f);
+    ASSERT_FLOAT_EQ(20.0f, m.roll, 0.01f);
+
+    // The capture ends: nothing is reported as current once it is old
+    _mock_millis = 5030 + BNO085_STALE_MS;
+    m = imu.getSnapshot();
+    ASSERT_FALSE(m.hasOrientation);
+    ASSERT_NAN(m.pitch);
+    ASSERT_FALSE(m.hasLinAccel);
+
+    TEST_PASS();
+}
+
+int main() {
+    TEST_SUITE("Input Replay (GPS + IMU seams)");
+
+    RUN_TEST(gps_replay);
+    RUN_TEST(gps_replay_bad_checksum);
+    RUN_TEST(imu_replay);
+
+    TEST_SUMMARY();
+}
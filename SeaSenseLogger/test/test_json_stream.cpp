@@ -0,0 +1,174 @@
+/**
+ * Tests for JsonStream — the streaming writer behind the WebServer API
+ * responses: commas and nesting, escaping, number formatting, and output
+ * handed over in chunks no larger than the fixed buffer
+ */
+
+#include <Arduino.h>
+#include "test_framework.h"
+#include "../src/webui/JsonStream.h"
+#include <math.h>
+#include <string>
+
+// Collects what the writer hands to the sink
+struct Capture {
+    std::string out;
+    size_t calls = 0;
+    size_t largest = 0;
+    bool ended = false;
+
+    JsonStream::Sink sink() {
+        return [this](const char* data, size_t len, bool last) {
+            out.append(data, len);
+            calls++;
+            if (len > largest) largest = len;
+            ended = last;
+        };
+    }
+};
+
+// Test: nested objects and arrays get their commas and keys
+void test_structure() {
+    Capture cap;
+    JsonStream json(cap.sink());
+    json.beginObject();
+    json.field("total", 3);
+    json.beginObject("wifi");
+    json.field("ap_ssid", "SeaSense-AB12");
+    json.field("station_connected", false);
+    json.endObject();
+    json.beginArray("records");
+    for (int i = 0; i < 2; i++) {
+        json.beginObject();
+        json.field("millis", (unsigned long)(1000 * (i + 1)));
+        json.endObject();
+    }
+    json.endArray();
+    json.beginArray("empty");
+    json.endArray();
+    json.beginArray("list");
+    json.value(1);
+    json.value("two");
+    json.valueNull();
+    json.endArray();
+    json.endObject();
+    ASSERT_TRUE(json.end());
+    ASSERT_TRUE(cap.ended);
+
+    ASSERT_STR_EQ(
+        "{\"total\":3,\"wifi\":{\"ap_ssid\":\"SeaSense-AB12\",\"station_connected\":false},"
+        "\"records\":[{\"millis\":1000},{\"millis\":2000}],\"empty\":[],"
+        "\"list\":[1,\"two\",null]}",
+        String(cap.out.c_str()));
+
+    // Unbalanced containers are reported
+    Capture open;
+    JsonStream bad(open.sink());
+    bad.beginObject();
+    bad.beginArray("a");
+    bad.endArray();
+    ASSERT_FALSE(bad.end());
+
+    TEST_PASS();
+}
+
+// Test: quotes, backslashes and control characters are escaped, UTF-8 kept
+void test_escaping() {
+    Capture cap;
+    JsonStream json(cap.sink());
+    json.beginObject();
+    json.field("msg", String("say \"hi\"\\\n\t\x01"));
+    json.field("k\"ey", "\xc2\xb0" "C");
+    json.endObject();
+    json.end();
+
+    ASSERT_STR_EQ("{\"msg\":\"say \\\"hi\\\"\\\\\\n\\t\\u0001\",\"k\\\"ey\":\"\xc2\xb0" "C\"}",
+                  String(cap.out.c_str()));
+    TEST_PASS();
+}
+
+// Test: integers at their limits, floats, fixed decimals, NaN as null
+void test_numbers() {
+    Capture cap;
+    JsonStream json(cap.sink());
+    json.beginObject();
+    json.field("neg", -42);
+    json.field("u32", (uint32_t)4294967295UL);
+    json.field("i64", (int64_t)-9223372036854775807LL - 1);
+    json.field("u64", (uint64_t)18446744073709551615ULL);
+    json.field("f", 22.45f);
+    json.field("d", 52.123456);
+    json.field("fixed", 1013.25f / 100.0f, 1);
+    json.field("round", 179.6, 0);
+    json.field("nan", (float)NAN);
+    json.field("nan_fixed", (double)NAN, 2);
+    json.field("inf", (double)INFINITY);
+    json.endObject();
+    json.end();
+
+    ASSERT_STR_EQ(
+        "{\"neg\":-42,\"u32\":4294967295,\"i64\":-9223372036854775808,"
+        "\"u64\":18446744073709551615,\"f\":22.45,\"d\":52.123456,"
+        "\"fixed\":10.1,\"round\":180,\"nan\":null,\"nan_fixed\":null,\"inf\":null}",
+        String(cap.out.c_str()));
+    TEST_PASS();
+}
+
+// Test: a response many times the buffer size goes out in bounded chunks
+void test_bounded_chunks() {
+    Capture cap;
+    JsonStream json(cap.sink());
+    json.beginObject();
+    json.beginArray("records");
+    for (int i = 0; i < 200; i++) {
+        json.beginObject();
+        json.field("millis", (unsigned long)i);
+        json.field("time", "2025-06-15T12:30:00Z");
+        json.field("type", "Temperature");
+        json.field("value", 22.45f);
+        json.endObject();
+    }
+    json.endArray();
+    json.endObject();
+    ASSERT_TRUE(json.end());
+
+    ASSERT_TRUE(cap.out.size() > 50 * JsonStream::BUFFER_SIZE);
+    ASSERT_EQ(cap.out.size(), json.getBytesWritten());
+    ASSERT_TRUE(cap.largest <= JsonStream::BUFFER_SIZE);
+    ASSERT_EQ((cap.out.size() + JsonStream::BUFFER_SIZE - 1) / JsonStream::BUFFER_SIZE, cap.calls);
+    ASSERT_TRUE(cap.out.compare(cap.out.size() - 3, 3, "}]}") == 0);
+
+    // A short document arrives as a single last call
+    Capture small;
+    JsonStream json3(small.sink());
+    json3.beginObject();
+    json3.field("ok", true);
+    json3.endObject();
+    json3.end();
+    ASSERT_EQ(1u, small.calls);
+    ASSERT_TRUE(small.ended);
+
+    // Long strings cross buffer boundaries intact
+    Capture big;
+    JsonStream json2(big.sink());
+    std::string text(3 * JsonStream::BUFFER_SIZE + 7, 'x');
+    json2.beginObject();
+    json2.field("text", text.c_str());
+    json2.endObject();
+    json2.end();
+    ASSERT_EQ(text.size() + 11, big.out.size());
+    ASSERT_TRUE(big.largest <= JsonStream::BUFFER_SIZE);
+
+    TEST_PASS();
+}
+
+int main() {
+    TEST_SUITE("JSON Stream");
+
+    RUN_TEST(structure);
+    RUN_TEST(escaping);
+    RUN_TEST(numbers);
+    RUN_TEST(bounded_chunks);
+
+    TEST_SUMMARY();
+}
@@ -0,0 +1,141 @@
+/**
+ * Tests for LiveMessage — the NMEA0183 sentences and binary datagram the
+ * UDP broadcaster sends for each measurement cycle
+ */
+
+#include <Arduino.h>
+#include "test_framework.h"
+
+#include "../src/broadcast/LiveMessage.h"
+#include <string>
+
+static LiveSnapshot sampleSnapshot() {
+    LiveSnapshot snap;
+    snap.epoch = 1780000000;
+    snap.latitude = 54.3219876;
+    snap.longitude = -10.1234567;
+    snap.set(LiveField::WATER_TEMP, 18.314f);
+    snap.set(LiveField::CONDUCTIVITY, 52310.0f);
+    snap.set(LiveField::SALINITY, 35.12f);
+    snap.set(LiveField::SOG, 3.2f);
+    snap.set(LiveField::BARO_PRESSURE, 101320.0f);
+    return snap;
+}
+
+// Test: sentences for measured values only, each with a valid checksum
+void test_nmea_sentences() {
+    LiveSnapshot snap = sampleSnapshot();
+    char out[LIVE_NMEA_MAX];
+    size_t len = buildLiveNmea(snap, out, sizeof(out));
+    ASSERT_TRUE(len > 0);
+
+    std::string text(out, len);
+    ASSERT_TRUE(text.find("$YXMTW,18.31,C*") == 0);
+    ASSERT_TRUE(text.find("$YXXDR,G,52310,,COND*") != std::string::npos);
+    ASSERT_TRUE(text.find("$YXXDR,G,35.12,,SALN*") != std::string::npos);
+    ASSERT_TRUE(text.find("PH*") == std::string::npos);      // pH not measured
+    ASSERT_TRUE(text.find("DOXY") == std::string::npos);
+
+    // Every line: $body*hh\r\n, hh = XOR of body, under the 82-char limit
+    int lines = 0;
+    size_t pos = 0;
+    while (pos < text.size()) {
+        size_t end = text.find("\r\n", pos);
+        ASSERT_TRUE(end != std::string::npos);
+        std::string line = text.substr(pos, end - pos);
+        ASSERT_TRUE(line.size() + 2 <= 82);
+        ASSERT_EQ('$', line[0]);
+        size_t star = line.find('*');
+        ASSERT_TRUE(star != std::string::npos);
+        std::string body = line.substr(1, star - 1);
+        unsigned int sum = strtoul(line.substr(star + 1).c_str(), nullptr, 16);
+        ASSERT_EQ(sum, (unsigned int)nmeaChecksum(body.c_str(), body.size()));
+        lines++;
+        pos = end + 2;
+    }
+    ASSERT_EQ(3, lines);
+
+    // Known checksum: $YXMTW,18.31,C
+    ASSERT_EQ(0x29, nmeaChecksum("YXMTW,18.31,C", 13));
+
+    // Nothing measured, nothing to send; too small a buffer, nothing written
+    LiveSnapshot empty;
+    ASSERT_EQ(0u, buildLiveNmea(empty, out, sizeof(out)));
+    ASSERT_EQ(0u, buildLiveNmea(snap, out, 40));
+
+    TEST_PASS();
+}
+
+// Test: the binary datagram round-trips, unknown values stay unknown
+void test_datagram_roundtrip() {
+    LiveSnapshot snap = sampleSnapshot();
+    uint8_t buf[LIVE_DATAGRAM_MAX];
+    size_t len = buildLiveDatagram(snap, 0xBEEF, buf, sizeof(buf));
+    ASSERT_EQ((size_t)LIVE_DATAGRAM_MAX, len);
+    ASSERT_EQ(70u, len);
+    ASSERT_EQ('S', buf[0]);
+    ASSERT_EQ(0xEF, buf[4]);                     // little-endian sequence
+    ASSERT_EQ(0xBE, buf[5]);
+
+    LiveSnapshot back;
+    uint16_t seq = 0;
+    ASSERT_TRUE(parseLiveDatagram(buf, len, back, seq));
+    ASSERT_EQ(0xBEEF, seq);
+    ASSERT_EQ(1780000000u, back.epoch);
+    ASSERT_FLOAT_EQ(54.3219876, back.latitude, 1e-7);
+    ASSERT_FLOAT_EQ(-10.1234567, back.longitude, 1e-7);
+    ASSERT_FLOAT_EQ(18.314f, back.get(LiveField::WATER_TEMP), 1e-6);
+    ASSERT_FLOAT_EQ(101320.0f, back.get(LiveField::BARO_PRESSURE), 1e-3);
+    ASSERT_NAN(back.get(LiveField::PH));
+
+    // No position fix
+    snap.latitude = NAN;
+    snap.longitude = NAN;
+    len = buildLiveDatagram(snap, 1, buf, sizeof(buf));
+    ASSERT_TRUE(parseLiveDatagram(buf, len, back, seq));
+    ASSERT_NAN(back.latitude);
+    ASSERT_NAN(back.longitude);
+
+    // Too small a buffer
+    ASSERT_EQ(0u, buildLiveDatagram(snap, 1, buf, LIVE_DATAGRAM_MAX - 1));
+
+    TEST_PASS();
+}
+
+// Test: foreign or truncated datagrams are rejected, newer ones readable
+void test_datagram_compat() {
+    LiveSnapshot snap = sampleSnapshot();
+    uint8_t buf[LIVE_DATAGRAM_MAX + 8];
+    size_t len = buildLiveDatagram(snap, 7, buf, sizeof(buf));
+    LiveSnapshot back;
+    uint16_t seq;
+
+    ASSERT_FALSE(parseLiveDatagram(buf, len - 1, back, seq));      // truncated
+    ASSERT_FALSE(parseLiveDatagram(buf, 10, back, seq));
+    const uint8_t text[] = "$YXMTW,18.31,C*29\r\n";
+    ASSERT_FALSE(parseLiveDatagram(text, sizeof(text) - 1, back, seq));
+
+    // A newer sender with two more fields: the known ones still parse
+    buf[3] += 2;
+    memset(buf + len, 0, 8);
+    ASSERT_TRUE(parseLiveDatagram(buf, len + 8, back, seq));
+    ASSERT_FLOAT_EQ(35.12f, back.get(LiveField::SALINITY), 1e-5);
+
+    // An older sender with fewer fields: the rest are unknown
+    buf[3] = 2;
+    ASSERT_TRUE(parseLiveDatagram(buf, LIVE_DATAGRAM_HEADER + 8, back, seq));
+    ASSERT_FLOAT_EQ(52310.0f, back.get(LiveField::CONDUCTIVITY), 1e-3);
+    ASSERT_NAN(back.get(LiveField::SALINITY));
+
+    TEST_PASS();
+}
+
+int main() {
+    TEST_SUITE("Live Message");
+
+    RUN_TEST(nmea_sentences);
+    RUN_TEST(datagram_roundtrip);
+    RUN_TEST(datagram_compat);
+
+    TEST_SUMMARY();
+}
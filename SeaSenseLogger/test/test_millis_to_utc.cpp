@@ -1,41 +1,25 @@
 /**
- * Tests for APIUploader::millisToUTC()
+ * Tests for millis() → UTC conversion (TimeService::epochMsForMillis)
  *
- * Validates timestamp conversion from millis() to ISO 8601 UTC.
- * A regression here means incorrect timestamps in API uploads.
- *
- * We test the logic directly rather than compiling all of APIUploader.cpp,
- * since that pulls in StorageManager, HTTPClient, etc.
+ * Validates timestamp conversion from millis() to ISO 8601 UTC, which
+ * stamps API uploads and back-fills records stored before time sync.
+ * A regression here means incorrect timestamps in stored data.
  */
 
 #include <Arduino.h>
 #include "test_framework.h"
-#include <ctime>
-
-// ============================================================================
-// Extract of millisToUTC logic (mirrors APIUploader::millisToUTC exactly)
-// ============================================================================
-
-struct UTCConverter {
-    bool timeSynced = false;
-    time_t bootTimeEpoch = 0;
-
-    String millisToUTC(unsigned long millisTimestamp) const {
-        if (!timeSynced) {
-            return "";
-        }
-
-        time_t epoch = bootTimeEpoch + (millisTimestamp / 1000);
-
-        struct tm timeinfo;
-        gmtime_r(&epoch, &timeinfo);
+#include "../src/system/TimeService.h"
 
-        char buffer[32];
-        strftime(buffer, sizeof(buffer), "%Y-%m-%dT%H:%M:%SZ", &timeinfo);
+// Time service synced so that millis() = 0 is bootEpoch (seconds)
+static void syncAtBoot(TimeService& ts, int64_t bootEpoch, unsigned long now) {
+    ts.update(now);
+    ts.sync(TimeSource::NTP, bootEpoch * 1000 + now, now);
+}
 
-        return String(buffer);
-    }
-};
+static String millisToUTC(const TimeService& ts, unsigned long stampMs, unsigned long now) {
+    int64_t epoch = ts.epochMsForMillis(stampMs, now);
+    return epoch > 0 ? TimeService::formatUTC(epoch) : String("");
+}
 
 // ============================================================================
 // Tests
@@ -43,67 +27,70 @@ struct UTCConverter {
 
 // Test: known epoch + known millis → correct ISO 8601
 void test_known_timestamp_conversion() {
-    UTCConverter conv;
-    conv.timeSynced = true;
-    conv.bootTimeEpoch = 1718450000;  // 2024-06-15T11:13:20Z
+    TimeService ts;
+    syncAtBoot(ts, 1718450000, 120000);  // 2024-06-15T11:13:20Z at boot
 
     // millis = 60000 → 60 seconds after boot → 1718450060 → 2024-06-15T11:14:20Z
-    String result = conv.millisToUTC(60000);
-    ASSERT_STR_EQ("2024-06-15T11:14:20Z", result);
+    ASSERT_STR_EQ("2024-06-15T11:14:20Z", millisToUTC(ts, 60000, 120000));
 
     TEST_PASS();
 }
 
 // Test: millis = 0 → boot time exactly
 void test_millis_zero_is_boot_time() {
-    UTCConverter conv;
-    conv.timeSynced = true;
-    conv.bootTimeEpoch = 1735689600;  // 2025-01-01T00:00:00Z
+    TimeService ts;
+    syncAtBoot(ts, 1735689600, 5000);  // 2025-01-01T00:00:00Z
 
-    String result = conv.millisToUTC(0);
-    ASSERT_STR_EQ("2025-01-01T00:00:00Z", result);
+    ASSERT_STR_EQ("2025-01-01T00:00:00Z", millisToUTC(ts, 0, 5000));
 
     TEST_PASS();
 }
 
 // Test: unsynced → empty string
 void test_unsynced_returns_empty() {
-    UTCConverter conv;
-    conv.timeSynced = false;
-    conv.bootTimeEpoch = 0;
+    TimeService ts;
+    ts.update(60000);
 
-    String result = conv.millisToUTC(60000);
-    ASSERT_STR_EQ("", result);
+    ASSERT_STR_EQ("", millisToUTC(ts, 60000, 60000));
+    ASSERT_STR_EQ("", ts.nowUTC(60000));
 
     TEST_PASS();
 }
 
 // Test: large millis (hours of uptime) → still correct
 void test_large_millis_offset() {
-    UTCConverter conv;
-    conv.timeSynced = true;
-    conv.bootTimeEpoch = 1748736000;  // 2025-06-01T00:00:00Z
+    TimeService ts;
+    syncAtBoot(ts, 1748736000, 43200000);  // 2025-06-01T00:00:00Z
 
     // 12 hours = 43200000 millis → 2025-06-01T12:00:00Z
-    String result = conv.millisToUTC(43200000);
-    ASSERT_STR_EQ("2025-06-01T12:00:00Z", result);
+    ASSERT_STR_EQ("2025-06-01T12:00:00Z", millisToUTC(ts, 43200000, 43200000));
 
     TEST_PASS();
 }
 
 // Test: millis precision — sub-second millis are truncated correctly
 void test_subsecond_truncation() {
-    UTCConverter conv;
-    conv.timeSynced = true;
-    conv.bootTimeEpoch = 1735689600;  // 2025-01-01T00:00:00Z
+    TimeService ts;
+    syncAtBoot(ts, 1735689600, 2000);  // 2025-01-01T00:00:00Z
 
-    // 1500ms → 1 second (integer division)
-    String result = conv.millisToUTC(1500);
-    ASSERT_STR_EQ("2025-01-01T00:00:01Z", result);
+    // 1500ms → 1 second
+    ASSERT_STR_EQ("2025-01-01T00:00:01Z", millisToUTC(ts, 1500, 2000));
 
     // 999ms → 0 seconds
-    result = conv.millisToUTC(999);
-    ASSERT_STR_EQ("2025-01-01T00:00:00Z", result);
+    ASSERT_STR_EQ("2025-01-01T00:00:00Z", millisToUTC(ts, 999, 2000));
+
+    TEST_PASS();
+}
+
+// Test: a stamp from before the millis() wrap converts across it
+void test_stamp_before_wrap() {
+    TimeService ts;
+    ts.update(0xFFFFF000UL);
+    ts.update(0x00001000UL);  // wrapped
+    ts.sync(TimeSource::GPS, 1735689600LL * 1000, 0x00001000UL);
+
+    // 0x2000 ms (8.192 s) before the sync, on the other side of the wrap
+    ASSERT_STR_EQ("2024-12-31T23:59:51Z", millisToUTC(ts, 0xFFFFF000UL, 0x00001000UL));
 
     TEST_PASS();
 }
@@ -116,6 +103,7 @@ int main() {
     RUN_TEST(unsynced_returns_empty);
     RUN_TEST(large_millis_offset);
     RUN_TEST(subsecond_truncation);
+    RUN_TEST(stamp_before_wrap);
 
     TEST_SUMMARY();
 }
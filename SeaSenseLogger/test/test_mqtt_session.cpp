@@ -0,0 +1,545 @@
+/**
+ * Tests for the MQTT upload transport — packet codec and session, run
+ * against a stand-in broker that speaks MQTT 3.1.1 over an in-memory link
+ */
+
+#include <Arduino.h>
+#include "test_framework.h"
+
+#include "../src/api/MqttPacket.h"
+#include "../src/api/MqttSession.h"
+#include <deque>
+#include <set>
+#include <string>
+#include <vector>
+
+// ============================================================================
+// Stand-in broker
+// ============================================================================
+
+struct ReceivedPublish {
+    std::string topic;
+    std::string payload;
+    uint16_t packetId;
+    bool dup;
+};
+
+class StandInBroker {
+public:
+    bool reachable = true;
+    bool autoAck = true;                // PUBACK each publish as it arrives
+    uint8_t connackCode = MQTT_CONNACK_ACCEPTED;
+
+    // Last CONNECT
+    std::string clientId, username, password;
+    bool cleanSession = true;
+    uint16_t keepAliveSec = 0;
+
+    uint32_t connects = 0;
+    uint32_t pings = 0;
+    uint32_t disconnects = 0;
+    std::vector<ReceivedPublish> publishes;
+    std::vector<uint16_t> held;         // received, not acked (autoAck off)
+    std::deque<uint8_t> toClient;
+    bool open = false;
+
+    StandInBroker() : _reader(_buf, sizeof(_buf)) {}
+
+    void accept() {
+        open = true;
+        toClient.clear();
+        _reader.reset();
+    }
+
+    void receive(const uint8_t* data, size_t len) {
+        for (size_t i = 0; i < len; i++) {
+            if (_reader.push(data[i])) {
+                handle();
+            }
+        }
+    }
+
+    void ack(uint16_t packetId) {
+        uint8_t p[4];
+        size_t len = mqttEncodeAck(MqttPacketType::PUBACK, packetId, p, sizeof(p));
+        toClient.insert(toClient.end(), p, p + len);
+    }
+
+    void ackHeld() {
+        for (uint16_t id : held) ack(id);
+        held.clear();
+    }
+
+    // Connection drops (broker restart, WiFi fade)
+    void kill() {
+        open = false;
+        held.clear();
+    }
+
+private:
+    uint8_t _buf[4096];
+    MqttReader _reader;
+    std::set<std::string> _sessions;    // client ids with a stored session
+
+    void handle() {
+        const uint8_t* body = _reader.body();
+        size_t len = _reader.length();
+        switch (_reader.type()) {
+            case MqttPacketType::CONNECT: {
+                MqttConnectInfo info;
+                ASSERT_TRUE(mqttParseConnect(body, len, info));
+                clientId.assign(info.clientId, info.clientIdLen);
+                username = info.username ? std::string(info.username, info.usernameLen) : "";
+                password = info.password ? std::string(info.password, info.passwordLen) : "";
+                cleanSession = info.cleanSession;
+                keepAliveSec = info.keepAliveSec;
+                connects++;
+
+                bool present = !cleanSession && _sessions.count(clientId) > 0;
+                if (connackCode == MQTT_CONNACK_ACCEPTED && !cleanSession) {
+                    _sessions.insert(clientId);
+                }
+                const uint8_t connack[] = { 0x20, 0x02, (uint8_t)(present ? 1 : 0), connackCode };
+                toClient.insert(toClient.end(), connack, connack + 4);
+                break;
+            }
+            case MqttPacketType::PUBLISH: {
+                MqttPublishInfo info;
+                ASSERT_TRUE(mqttParsePublish(_reader.flags(), body, len, info));
+                ASSERT_EQ(1, info.qos);
+                publishes.push_back({ std::string(info.topic, info.topicLen),
+                                      std::string((const char*)info.payload, info.payloadLen),
+                                      info.packetId, info.dup });
+                if (autoAck) ack(info.packetId);
+                else held.push_back(info.packetId);
+                break;
+            }
+            case MqttPacketType::PINGREQ: {
+                pings++;
+                uint8_t p[2];
+                size_t plen = mqttEncodeEmpty(MqttPacketType::PINGRESP, p, sizeof(p));
+                toClient.insert(toClient.end(), p, p + plen);
+                break;
+            }
+            case MqttPacketType::DISCONNECT:
+                disconnects++;
+                open = false;
+                break;
+            default:
+                break;
+        }
+    }
+};
+
+// Client end of the in-memory connection
+class LoopbackLink : public MqttLink {
+public:
+    explicit LoopbackLink(StandInBroker& broker) : _broker(broker) {}
+
+    bool open() override {
+        if (!_broker.reachable) return false;
+        _broker.accept();
+        return true;
+    }
+    bool isOpen() override { return _broker.open; }
+    size_t read(uint8_t* buf, size_t len) override {
+        if (!_broker.open) return 0;
+        size_t n = 0;
+        while (n < len && !_broker.toClient.empty()) {
+            buf[n++] = _broker.toClient.front();
+            _broker.toClient.pop_front();
+        }
+        return n;
+    }
+    size_t write(const uint8_t* buf, size_t len) override {
+        if (!_broker.open) return 0;
+        _broker.receive(buf, len);
+        return len;
+    }
+    void close() override { _broker.open = false; }
+
+private:
+    StandInBroker& _broker;
+};
+
+// Acks as the uploader sees them
+struct AckLog {
+    std::vector<uint16_t> ids;
+    uint32_t records = 0;
+    unsigned long lastMillis = 0;
+};
+
+static MqttSessionConfig sessionConfig(uint8_t window) {
+    MqttSessionConfig cfg;
+    cfg.clientId = "0f3c9a2e-guid";
+    cfg.username = "partner-7";
+    cfg.password = "api-key";
+    cfg.keepAliveSec = 30;
+    cfg.window = window;
+    cfg.connectTimeoutMs = 5000;
+    cfg.ackTimeoutMs = 10000;
+    cfg.reconnectMinMs = 1000;
+    cfg.reconnectMaxMs = 8000;
+    return cfg;
+}
+
+static void attach(MqttSession& session, AckLog& log) {
+    session.onAck([&log](uint16_t id, uint32_t records, unsigned long lastMillis, size_t) {
+        log.ids.push_back(id);
+        log.records += records;
+        log.lastMillis = lastMillis;
+    });
+}
+
+static const char* TOPIC = "seasense/partner-7/0f3c9a2e-guid/datapoints";
+
+// ============================================================================
+// Codec
+// ============================================================================
+
+// Test: remaining length varint at each size boundary
+void test_remaining_length() {
+    uint8_t out[4];
+    ASSERT_EQ(1u, mqttEncodeLength(0, out));
+    ASSERT_EQ(0x00, out[0]);
+    ASSERT_EQ(1u, mqttEncodeLength(127, out));
+    ASSERT_EQ(0x7F, out[0]);
+    ASSERT_EQ(2u, mqttEncodeLength(128, out));
+    ASSERT_EQ(0x80, out[0]);
+    ASSERT_EQ(0x01, out[1]);
+    ASSERT_EQ(2u, mqttEncodeLength(16383, out));
+    ASSERT_EQ(3u, mqttEncodeLength(16384, out));
+    ASSERT_EQ(4u, mqttEncodeLength(MQTT_MAX_REMAINING_LENGTH, out));
+    ASSERT_EQ(0xFF, out[0]);
+    ASSERT_EQ(0x7F, out[3]);
+    ASSERT_EQ(0u, mqttEncodeLength(MQTT_MAX_REMAINING_LENGTH + 1, out));
+
+    TEST_PASS();
+}
+
+// Test: CONNECT and PUBLISH round-trip through the broker-side parsers
+void test_packet_roundtrip() {
+    uint8_t buf[512];
+    uint8_t body[512];
+    MqttReader reader(body, sizeof(body));
+
+    MqttConnectOptions opt;
+    opt.clientId = "dev-1";
+    opt.username = "user";
+    opt.password = "secret";
+    opt.keepAliveSec = 45;
+    size_t len = mqttEncodeConnect(opt, buf, sizeof(buf));
+    ASSERT_EQ(0x10, buf[0]);
+    bool done = false;
+    for (size_t i = 0; i < len; i++) done = reader.push(buf[i]);
+    ASSERT_TRUE(done);
+    ASSERT_TRUE(reader.type() == MqttPacketType::CONNECT);
+
+    MqttConnectInfo info;
+    ASSERT_TRUE(mqttParseConnect(reader.body(), reader.length(), info));
+    ASSERT_EQ(4, info.protocolLevel);
+    ASSERT_FALSE(info.cleanSession);
+    ASSERT_EQ(45, info.keepAliveSec);
+    ASSERT_STR_EQ("dev-1", std::string(info.clientId, info.clientIdLen).c_str());
+    ASSERT_STR_EQ("secret", std::string(info.password, info.passwordLen).c_str());
+
+    // PUBLISH: header then payload, split across pushes
+    const char* payload = "{\"datapoints\":[{\"water_temperature_c\":18.3}]}";
+    size_t payloadLen = strlen(payload);
+    len = mqttEncodePublishHeader("a/b", payloadLen, 1, true, false, 0x1234, buf, sizeof(buf));
+    ASSERT_EQ(2u + 2 + 3 + 2, len);             // fixed header, topic, packet id
+    ASSERT_EQ(0x3A, buf[0]);                    // PUBLISH, DUP, QoS1
+    memcpy(buf + len, payload, payloadLen);
+    done = false;
+    for (size_t i = 0; i < len + payloadLen; i++) done = reader.push(buf[i]);
+    ASSERT_TRUE(done);
+
+    MqttPublishInfo pub;
+    ASSERT_TRUE(mqttParsePublish(reader.flags(), reader.body(), reader.length(), pub));
+    ASSERT_EQ(1, pub.qos);
+    ASSERT_TRUE(pub.dup);
+    ASSERT_EQ(0x1234, pub.packetId);
+    ASSERT_EQ(payloadLen, pub.payloadLen);
+    ASSERT_TRUE(memcmp(payload, pub.payload, payloadLen) == 0);
+
+    // Too small a buffer
+    ASSERT_EQ(0u, mqttEncodePublishHeader("a/b", 10, 1, false, false, 1, buf, 8));
+
+    TEST_PASS();
+}
+
+// Test: reader handles empty bodies, oversize bodies and garbage
+void test_reader_edges() {
+    uint8_t body[4];
+    MqttReader reader(body, sizeof(body));
+
+    const uint8_t pingresp[] = { 0xD0, 0x00 };
+    ASSERT_FALSE(reader.push(pingresp[0]));
+    ASSERT_TRUE(reader.push(pingresp[1]));
+    ASSERT_TRUE(reader.type() == MqttPacketType::PINGRESP);
+    ASSERT_EQ(0u, reader.length());
+
+    // 6-byte body into a 4-byte buffer: consumed, flagged truncated
+    const uint8_t big[] = { 0x30, 0x06, 1, 2, 3, 4, 5, 6, 0x40, 0x02, 0x00, 0x07 };
+    bool done = false;
+    for (int i = 0; i < 8; i++) done = reader.push(big[i]);
+    ASSERT_TRUE(done);
+    ASSERT_TRUE(reader.isTruncated());
+    ASSERT_EQ(4u, reader.length());
+
+    // The next packet still parses
+    for (int i = 8; i < 12; i++) done = reader.push(big[i]);
+    ASSERT_TRUE(done);
+    uint16_t id = 0;
+    ASSERT_TRUE(mqttParsePacketId(reader.body(), reader.length(), id));
+    ASSERT_EQ(7, id);
+
+    // Five length bytes is not MQTT
+    const uint8_t bad[] = { 0x30, 0xFF, 0xFF, 0xFF, 0xFF, 0x01 };
+    for (uint8_t b : bad) reader.push(b);
+    ASSERT_TRUE(reader.isMalformed());
+
+    TEST_PASS();
+}
+
+// ============================================================================
+// Session
+// ============================================================================
+
+// Test: persistent session — clean session 0, credentials, session present
+// on the second connection
+void test_persistent_session() {
+    StandInBroker broker;
+    LoopbackLink link(broker);
+    MqttSession session(&link);
+    session.configure(sessionConfig(4));
+
+    _mock_millis = 1000;
+    session.poll(millis());                     // connects straight away
+    ASSERT_TRUE(session.getState() == MqttState::CONNECTING);
+    ASSERT_EQ(1u, broker.connects);
+    ASSERT_FALSE(broker.cleanSession);
+    ASSERT_STR_EQ("0f3c9a2e-guid", broker.clientId.c_str());
+    ASSERT_STR_EQ("partner-7", broker.username.c_str());
+    ASSERT_STR_EQ("api-key", broker.password.c_str());
+    ASSERT_EQ(30, broker.keepAliveSec);
+
+    session.poll(millis());                     // CONNACK
+    ASSERT_TRUE(session.isConnected());
+    ASSERT_FALSE(session.wasSessionPresent());
+
+    session.disconnect(millis(), "test");
+    ASSERT_EQ(1u, broker.disconnects);
+    ASSERT_TRUE(session.getState() == MqttState::DISCONNECTED);
+
+    _mock_millis += 1000;                       // reconnectMinMs
+    session.poll(millis());
+    session.poll(millis());
+    ASSERT_TRUE(session.isConnected());
+    ASSERT_TRUE(session.wasSessionPresent());
+    ASSERT_EQ(2u, session.getConnectCount());
+
+    TEST_PASS();
+}
+
+// Test: window limits publishes in flight; acks reported in publish order
+void test_window_and_ordered_acks() {
+    StandInBroker broker;
+    broker.autoAck = false;
+    LoopbackLink link(broker);
+    MqttSession session(&link);
+    session.configure(sessionConfig(3));
+    AckLog log;
+    attach(session, log);
+
+    _mock_millis = 5000;
+    session.poll(millis());
+    session.poll(millis());
+    ASSERT_TRUE(session.isConnected());
+
+    uint16_t a = session.publish(TOPIC, "{\"datapoints\":[1,2]}", 2, 100);
+    uint16_t b = session.publish(TOPIC, "{\"datapoints\":[3]}", 1, 200);
+    uint16_t c = session.publish(TOPIC, "{\"datapoints\":[4,5,6]}", 3, 300);
+    ASSERT_TRUE(a != 0 && b != 0 && c != 0);
+    ASSERT_FALSE(session.canPublish());
+    ASSERT_EQ(0, session.publish(TOPIC, "x", 1, 400));
+    ASSERT_EQ(3u, broker.publishes.size());
+    ASSERT_EQ(6u, session.getInFlightRecords());
+
+    // Framing per publish: 2-byte fixed header, topic, packet id
+    size_t framing = session.getBytesSent();
+    for (const ReceivedPublish& p : broker.publishes) framing -= p.payload.size();
+    size_t connectBytes = 2 + 10 + 2 + 13 + 2 + 9 + 2 + 7;
+    ASSERT_EQ(3 * (2 + 2 + strlen(TOPIC) + 2), framing - connectBytes);
+
+    // b acked first: nothing reported until a is
+    broker.ack(b);
+    session.poll(millis());
+    ASSERT_EQ(0u, log.ids.size());
+    ASSERT_EQ(3, session.getInFlight());
+
+    broker.ack(a);
+    session.poll(millis());
+    ASSERT_EQ(2u, log.ids.size());
+    ASSERT_EQ(a, log.ids[0]);
+    ASSERT_EQ(b, log.ids[1]);
+    ASSERT_EQ(3u, log.records);
+    ASSERT_EQ(200u, log.lastMillis);
+    ASSERT_TRUE(session.canPublish());
+
+    broker.ack(c);
+    session.poll(millis());
+    ASSERT_EQ(6u, log.records);
+    ASSERT_EQ(0, session.getInFlight());
+    ASSERT_EQ(3u, session.getAckedCount());
+
+    TEST_PASS();
+}
+
+// Test: unacked publishes go out again with DUP and the same id after the
+// connection drops; nothing acked is resent
+void test_redelivery_after_reconnect() {
+    StandInBroker broker;
+    broker.autoAck = false;
+    LoopbackLink link(broker);
+    MqttSession session(&link);
+    session.configure(sessionConfig(4));
+    AckLog log;
+    attach(session, log);
+
+    _mock_millis = 10000;
+    session.poll(millis());
+    session.poll(millis());
+
+    uint16_t a = session.publish(TOPIC, "first", 4, 100);
+    uint16_t b = session.publish(TOPIC, "second", 4, 200);
+    broker.ack(a);
+    session.poll(millis());
+    ASSERT_EQ(4u, log.records);
+
+    broker.kill();                              // b never acked
+    session.poll(millis());
+    ASSERT_TRUE(session.getState() == MqttState::DISCONNECTED);
+    ASSERT_STR_EQ("Connection lost", session.getLastError().c_str());
+
+    // Queued while offline: goes out after the CONNACK, not as a DUP
+    uint16_t c = session.publish(TOPIC, "third", 1, 300);
+    ASSERT_TRUE(c != 0);
+    ASSERT_EQ(2u, broker.publishes.size());
+
+    _mock_millis += 999;                        // still backing off
+    session.poll(millis());
+    ASSERT_EQ(1u, broker.connects);
+    _mock_millis += 1;
+    session.poll(millis());
+    session.poll(millis());
+    ASSERT_TRUE(session.isConnected());
+    ASSERT_TRUE(session.wasSessionPresent());
+
+    ASSERT_EQ(4u, broker.publishes.size());
+    const ReceivedPublish& again = broker.publishes[2];
+    ASSERT_STR_EQ("second", again.payload.c_str());
+    ASSERT_EQ(b, again.packetId);
+    ASSERT_TRUE(again.dup);
+    ASSERT_STR_EQ("third", broker.publishes[3].payload.c_str());
+    ASSERT_FALSE(broker.publishes[3].dup);
+    ASSERT_EQ(1u, session.getRedeliveredCount());
+
+    broker.ackHeld();
+    session.poll(millis());
+    ASSERT_EQ(9u, log.records);
+    ASSERT_EQ(300u, log.lastMillis);
+
+    TEST_PASS();
+}
+
+// Test: keepalive ping when idle; silent broker, missing PUBACK and a
+// refused CONNECT each drop the connection with growing backoff
+void test_keepalive_and_timeouts() {
+    StandInBroker broker;
+    LoopbackLink link(broker);
+    MqttSession session(&link);
+    session.configure(sessionConfig(4));
+
+    _mock_millis = 20000;
+    session.poll(millis());
+    session.poll(millis());
+    ASSERT_TRUE(session.isConnected());
+    ASSERT_EQ(30000u, session.getTimeUntilDue(millis()));
+
+    _mock_millis += 30000;
+    session.poll(millis());
+    ASSERT_EQ(1u, broker.pings);
+    session.poll(millis());                     // PINGRESP
+    _mock_millis += 15000;
+    session.poll(millis());
+    ASSERT_TRUE(session.isConnected());
+
+    // Broker stops answering: PUBACK timeout
+    broker.autoAck = false;
+    session.publish(TOPIC, "lost", 1, 1);
+    _mock_millis += 10000;
+    session.poll(millis());
+    ASSERT_TRUE(session.getState() == MqttState::DISCONNECTED);
+    ASSERT_STR_EQ("PUBACK timeout", session.getLastError().c_str());
+    ASSERT_EQ(1000u, session.getTimeUntilDue(millis()));
+
+    // Unreachable: backoff doubles up to the cap
+    broker.reachable = false;
+    _mock_millis += 1000;
+    session.poll(millis());
+    ASSERT_STR_EQ("Broker unreachable", session.getLastError().c_str());
+    ASSERT_EQ(2000u, session.getTimeUntilDue(millis()));
+    for (int i = 0; i < 5; i++) {
+        _mock_millis += session.getTimeUntilDue(millis());
+        session.poll(millis());
+    }
+    ASSERT_EQ(8000u, session.getTimeUntilDue(millis()));
+
+    // Bad credentials: straight to the longest backoff
+    broker.reachable = true;
+    broker.connackCode = MQTT_CONNACK_BAD_CREDENTIALS;
+    _mock_millis += 8000;
+    session.poll(millis());
+    session.poll(millis());
+    ASSERT_TRUE(session.getState() == MqttState::DISCONNECTED);
+    ASSERT_STR_EQ("Broker refused: bad username or password", session.getLastError().c_str());
+    ASSERT_EQ(8000u, session.getTimeUntilDue(millis()));
+
+    // Accepted again: the lost publish is redelivered
+    broker.connackCode = MQTT_CONNACK_ACCEPTED;
+    broker.autoAck = true;
+    _mock_millis += 8000;
+    session.poll(millis());
+    session.poll(millis());
+    ASSERT_TRUE(session.isConnected());
+    ASSERT_TRUE(broker.publishes.back().dup);
+    session.poll(millis());
+    ASSERT_EQ(0, session.getInFlight());
+
+    // No CONNACK at all
+    session.disconnect(millis(), "test");
+    broker.connackCode = MQTT_CONNACK_ACCEPTED;
+    _mock_millis += 1000;
+    session.poll(millis());
+    broker.toClient.clear();                    // CONNACK lost
+    _mock_millis += 5000;
+    session.poll(millis());
+    ASSERT_STR_EQ("No CONNACK from broker", session.getLastError().c_str());
+
+    TEST_PASS();
+}
+
+int main() {
+    TEST_SUITE("MQTT Session");
+
+    RUN_TEST(remaining_length);
+    RUN_TEST(packet_roundtrip);
+    RUN_TEST(reader_edges);
+    RUN_TEST(persistent_session);
+    RUN_TEST(window_and_ordered_acks);
+    RUN_TEST(redelivery_after_reconnect);
+    RUN_TEST(keepalive_and_timeouts);
+
+    TEST_SUMMARY();
+}
@@ -0,0 +1,67 @@
+/**
+ * Tests for NMEA2000GPS against the TWAI and NMEA2000 stand-ins in mocks/ —
+ * keeps the CAN source building on the host (`make replay` links the real
+ * library) and covers the paths that don't need a decoded PGN
+ */
+
+#include <Arduino.h>
+#include "test_framework.h"
+
+#define private public
+#include "../src/sensors/NMEA2000GPS.h"
+#undef private
+
+static int forwarded = 0;
+static unsigned long forwardedPGN = 0;
+
+static void countForward(const tN2kMsg& msg) {
+    forwarded++;
+    forwardedPGN = msg.PGN;
+}
+
+// Test: a bus that won't open leaves the source idle, not half set up
+void test_begin_without_bus() {
+    NMEA2000GPS gps;
+    ASSERT_FALSE(gps.begin(true));
+    ASSERT_TRUE(gps.getN2kInstance() == nullptr);
+    ASSERT_FALSE(gps.isTransmitReady());
+    ASSERT_EQ(N2K_BROADCAST, gps.getSourceAddress());
+    ASSERT_FALSE(gps.hasValidFix());
+    ASSERT_STR_EQ("Not initialized", gps.getStatusString().c_str());
+    ASSERT_STR_EQ("", gps.getTimeUTC().c_str());
+    ASSERT_TRUE(gps.getAgeMs() == ULONG_MAX);
+
+    uint8_t frame[8] = {};
+    ASSERT_FALSE(gps.sendFrame(0x09FD0223, frame, 8));
+    gps.update();
+
+    TEST_PASS();
+}
+
+// Test: every message reaches the forward callback, handled PGN or not
+void test_forwards_messages() {
+    NMEA2000GPS gps;
+    gps.setMsgForwardCallback(countForward);
+    forwarded = 0;
+
+    tN2kMsg msg;
+    msg.PGN = 129029;
+    gps.handleMsg(msg);
+    msg.PGN = 130311;
+    gps.handleMsg(msg);
+
+    ASSERT_EQ(2, forwarded);
+    ASSERT_EQ(130311UL, forwardedPGN);
+    ASSERT_FALSE(gps.hasValidFix());
+
+    TEST_PASS();
+}
+
+int main() {
+    TEST_SUITE("NMEA2000 GPS (host build)");
+
+    RUN_TEST(begin_without_bus);
+    RUN_TEST(forwards_messages);
+
+    TEST_SUMMARY();
+}
@@ -0,0 +1,360 @@
+/**
+ * Tests for NMEA2000 output — PGN encoding, fast-packet framing, priority
+ * order, rate limiting and drops, against a virtual CAN bus
+ */
+
+#include <Arduino.h>
+#include "test_framework.h"
+
+#define private public
+#include "../src/n2k/N2kMessage.h"
+#include "../src/n2k/N2kTxScheduler.h"
+#include "../src/n2k/N2kWaterQualityEmitter.h"
+#undef private
+
+#include <string.h>
+#include <vector>
+
+// Records frames like a bus analyser; can be told to refuse frames
+class VirtualCanBus : public N2kCanBus {
+public:
+    struct Frame {
+        uint32_t id;
+        uint8_t len;
+        uint8_t data[8];
+    };
+
+    std::vector<Frame> frames;
+    int refuse = 0;             // refuse this many frames, -1 = all
+    bool ready = true;
+    uint8_t address = 35;
+
+    bool sendFrame(uint32_t canId, const uint8_t* data, uint8_t len) override {
+        if (refuse != 0) {
+            if (refuse > 0) refuse--;
+            return false;
+        }
+        Frame f;
+        f.id = canId;
+        f.len = len;
+        memcpy(f.data, data, len);
+        frames.push_back(f);
+        return true;
+    }
+    uint8_t getSourceAddress() const override { return address; }
+    bool isTransmitReady() const override { return ready; }
+
+    static uint32_t pgnOf(uint32_t id) {
+        uint32_t pgn = (id >> 8) & 0x3FFFF;
+        if (((pgn >> 8) & 0xFF) < 240) pgn &= 0x3FF00;
+        return pgn;
+    }
+
+    // Reassemble the fast-packet message starting at frame index i
+    std::vector<uint8_t> reassemble(size_t i) const {
+        std::vector<uint8_t> out;
+        uint8_t total = frames[i].data[1];
+        uint8_t seq = frames[i].data[0] >> 5;
+        out.insert(out.end(), frames[i].data + 2, frames[i].data + 8);
+        for (size_t k = i + 1; out.size() < total && k < frames.size(); k++) {
+            if ((frames[k].data[0] >> 5) != seq) continue;
+            out.insert(out.end(), frames[k].data + 1, frames[k].data + 8);
+        }
+        out.resize(total);
+        return out;
+    }
+};
+
+static uint16_t u16(const uint8_t* p) { return p[0] | (p[1] << 8); }
+static uint32_t u32(const uint8_t* p) { return u16(p) | ((uint32_t)u16(p + 2) << 16); }
+
+// Test: 130312 water temperature in 0.01 K, N/A set temperature
+void test_pgn130312() {
+    N2kMessage msg;
+    buildPGN130312(msg, 7, 0, N2K_TEMP_SOURCE_SEA, 18.5f);
+    ASSERT_EQ(130312u, msg.pgn);
+    ASSERT_EQ(8, msg.length);
+    ASSERT_FALSE(msg.fastPacket);
+    ASSERT_EQ(7, msg.data[0]);
+    ASSERT_EQ(29165, u16(msg.data + 3));        // 291.65 K
+    ASSERT_EQ(0xFFFF, u16(msg.data + 5));
+
+    buildPGN130312(msg, 7, 0, N2K_TEMP_SOURCE_SEA, NAN);
+    ASSERT_EQ(0xFFFF, u16(msg.data + 3));
+
+    TEST_PASS();
+}
+
+// Test: 130316 carries 0.001 K in 24 bits
+void test_pgn130316() {
+    N2kMessage msg;
+    buildPGN130316(msg, 1, 2, N2K_TEMP_SOURCE_SEA, 18.5f);
+    ASSERT_EQ(8, msg.length);
+    ASSERT_EQ(2, msg.data[1]);
+    uint32_t raw = msg.data[3] | (msg.data[4] << 8) | ((uint32_t)msg.data[5] << 16);
+    ASSERT_EQ(291650u, raw);
+
+    TEST_PASS();
+}
+
+// Test: 130321 salinity, position, date/time and strings
+void test_pgn130321() {
+    N2kMessage msg;
+    // 2024-05-15T10:28:23Z
+    buildPGN130321(msg, 1715768903, 52.5, -4.25, 35.1f, 12.0f, "ID", "Name");
+    ASSERT_TRUE(msg.fastPacket);
+    ASSERT_EQ(19858, u16(msg.data + 1));                       // days since 1970
+    ASSERT_EQ((uint32_t)37703 * 10000, u32(msg.data + 3));     // 10:28:23
+    ASSERT_EQ((uint32_t)525000000, u32(msg.data + 7));
+    ASSERT_EQ((uint32_t)(int32_t)-42500000, u32(msg.data + 11));
+    float sal;
+    memcpy(&sal, msg.data + 15, 4);
+    ASSERT_FLOAT_EQ(35.1f, sal, 0.0001);
+    ASSERT_EQ(28515, u16(msg.data + 19));
+    ASSERT_EQ(4, msg.data[21]);                                // "ID" + 2
+    ASSERT_EQ(1, msg.data[22]);
+    ASSERT_EQ('I', msg.data[23]);
+    ASSERT_EQ(21 + 4 + 6, msg.length);
+
+    buildPGN130321(msg, 0, NAN, NAN, NAN, NAN, "", "");
+    ASSERT_EQ(0xFFFF, u16(msg.data + 1));
+    ASSERT_EQ(0x7FFFFFFFu, u32(msg.data + 7));
+
+    TEST_PASS();
+}
+
+// Test: 126996 is the fixed 134-byte layout
+void test_pgn126996() {
+    N2kMessage msg;
+    buildPGN126996(msg, 1, "SeaSense Logger", "2.0.0", "1.0", "SEASENSE-001");
+    ASSERT_EQ(134, msg.length);
+    ASSERT_EQ('S', msg.data[4]);
+    ASSERT_EQ(0xFF, msg.data[4 + 15]);          // padding after the model ID
+    ASSERT_EQ('2', msg.data[36]);
+
+    TEST_PASS();
+}
+
+// Test: PDU2 identifiers carry the group extension, PDU1 the destination
+void test_can_id() {
+    ASSERT_EQ(0x15FD0823u, N2kTxScheduler::canId(5, 130312, 0x23, N2K_BROADCAST));
+    ASSERT_EQ(0x18EA1023u, N2kTxScheduler::canId(6, 59904, 0x23, 0x10));
+
+    TEST_PASS();
+}
+
+// Test: a fast-packet message is framed and reassembles byte for byte
+void test_fast_packet_roundtrip() {
+    VirtualCanBus bus;
+    N2kTxScheduler tx(&bus);
+    N2kMessage msg;
+    buildPGN126996(msg, 1, "SeaSense Logger", "2.0.0", "1.0", "SEASENSE-001");
+    ASSERT_TRUE(tx.enqueue(msg));
+    tx.process(0);
+
+    ASSERT_EQ(20u, bus.frames.size());          // 6 + 19 * 7 >= 134
+    ASSERT_EQ(126996u, VirtualCanBus::pgnOf(bus.frames[0].id));
+    for (size_t i = 0; i < bus.frames.size(); i++) {
+        ASSERT_EQ(8, bus.frames[i].len);
+        ASSERT_EQ((int)i, bus.frames[i].data[0] & 0x1F);
+    }
+    std::vector<uint8_t> payload = bus.reassemble(0);
+    ASSERT_EQ(0, memcmp(payload.data(), msg.data, msg.length));
+    ASSERT_EQ(1u, tx.getStats().sentMessages);
+
+    // Next message of the same PGN uses the next sequence number
+    tx.enqueue(msg);
+    tx.process(1000);
+    ASSERT_EQ(1, bus.frames[20].data[0] >> 5);
+
+    TEST_PASS();
+}
+
+// Test: higher priority first, FIFO within a priority
+void test_priority_order() {
+    VirtualCanBus bus;
+    N2kTxScheduler tx(&bus);
+    N2kMessage a, b, c;
+    buildPGN126996(a, 1, "M", "S", "H", "X");           // priority 6, fast-packet
+    buildPGN130312(b, 1, 0, 0, 10.0f);                  // priority 5
+    buildPGN130316(c, 1, 0, 0, 10.0f);                  // priority 5
+    tx.enqueue(a);
+    tx.enqueue(b);
+    tx.enqueue(c);
+    tx.process(0);
+
+    ASSERT_EQ(130312u, VirtualCanBus::pgnOf(bus.frames[0].id));
+    ASSERT_EQ(130316u, VirtualCanBus::pgnOf(bus.frames[1].id));
+    ASSERT_EQ(126996u, VirtualCanBus::pgnOf(bus.frames[2].id));
+
+    TEST_PASS();
+}
+
+// Test: token bucket limits frames per pass and refills with time
+void test_rate_limit() {
+    VirtualCanBus bus;
+    N2kTxScheduler tx(&bus);
+    N2kMessage msg;
+    for (int i = 0; i < 2; i++) {
+        buildPGN126996(msg, 1, "M", "S", "H", "X");
+        msg.destination = i;        // same PGN would be replaced; keep both queued
+        tx.enqueue(msg);
+    }
+    tx.process(0);
+    ASSERT_EQ((size_t)N2K_TX_BURST_FRAMES, bus.frames.size());
+
+    tx.process(100);                             // 100 ms -> 5 frames at 50/s
+    ASSERT_EQ((size_t)N2K_TX_BURST_FRAMES + 5, bus.frames.size());
+    ASSERT_EQ(1, tx.getQueueDepth());
+
+    tx.process(1000);
+    ASSERT_EQ(40u, bus.frames.size());
+    ASSERT_EQ(0, tx.getQueueDepth());
+
+    TEST_PASS();
+}
+
+// Test: a newer message for a queued PGN replaces it
+void test_replace_same_pgn() {
+    VirtualCanBus bus;
+    bus.refuse = -1;
+    N2kTxScheduler tx(&bus);
+    N2kMessage msg;
+    buildPGN130312(msg, 1, 0, 0, 10.0f);
+    tx.enqueue(msg);
+    buildPGN130312(msg, 2, 0, 0, 11.0f);
+    tx.enqueue(msg);
+    ASSERT_EQ(1, tx.getQueueDepth());
+    ASSERT_EQ(1u, tx.getStats().replaced);
+
+    bus.refuse = 0;
+    tx.process(0);
+    ASSERT_EQ(1u, bus.frames.size());
+    ASSERT_EQ(2, bus.frames[0].data[0]);
+
+    TEST_PASS();
+}
+
+// Test: full queue, refusing bus and a bus that isn't ready all drop + count
+void test_drops() {
+    VirtualCanBus bus;
+    N2kTxScheduler tx(&bus);
+    N2kMessage msg;
+    buildPGN130312(msg, 1, 0, 0, 10.0f);
+    for (int i = 0; i < N2K_TX_QUEUE_LEN + 2; i++) {
+        msg.pgn = 130000 + i;       // distinct PGNs, nothing replaced
+        tx.enqueue(msg);
+    }
+    ASSERT_EQ(2u, tx.getStats().droppedQueueFull);
+
+    // Controller queue stays full: retried each pass, then dropped
+    tx.clear();
+    bus.refuse = -1;
+    tx.enqueue(msg);
+    for (int i = 0; i < N2K_TX_MAX_RETRIES; i++) {
+        tx.process(i * 1000);
+    }
+    ASSERT_EQ(1u, tx.getStats().droppedBusError);
+    ASSERT_EQ(0, tx.getQueueDepth());
+
+    bus.ready = false;
+    ASSERT_FALSE(tx.enqueue(msg));
+    ASSERT_EQ(1u, tx.getStats().droppedNotReady);
+
+    TEST_PASS();
+}
+
+// Test: a refused frame mid fast-packet resumes at the same frame
+void test_resume_after_refusal() {
+    VirtualCanBus bus;
+    N2kTxScheduler tx(&bus);
+    N2kMessage msg;
+    buildPGN130321(msg, 1715768903, 52.5, 4.0, 35.0f, 12.0f, "SEASENSE-001", "SeaSense Logger");
+    size_t frames = 1 + (msg.length - 6 + 6) / 7;
+    tx.enqueue(msg);
+
+    tx._tokens = 2;
+    tx.process(0);                              // bucket starts, two frames
+    ASSERT_EQ(2u, bus.frames.size());
+
+    bus.refuse = 1;
+    tx.process(1000);                           // refused, retried next pass
+    ASSERT_EQ(2u, bus.frames.size());
+    ASSERT_EQ(1u, tx.getStats().retries);
+
+    tx.process(2000);
+    ASSERT_EQ(frames, bus.frames.size());
+    std::vector<uint8_t> payload = bus.reassemble(0);
+    ASSERT_EQ(0, memcmp(payload.data(), msg.data, msg.length));
+
+    TEST_PASS();
+}
+
+// Test: emitter sends on new readings, repeats at its intervals, stops when stale
+void test_emitter_schedule() {
+    VirtualCanBus bus;
+    N2kTxScheduler tx(&bus);
+    N2kWaterQualityEmitter em(&tx);
+
+    em.update(0);                                // product info only
+    tx.process(0);
+    ASSERT_EQ(126996u, VirtualCanBus::pgnOf(bus.frames[0].id));
+    bus.frames.clear();
+
+    em.setReadings(15.0f, 34.0f, 52.0, 4.0, 1715768903, 100);
+    em.update(100);
+    ASSERT_EQ(3, tx.getQueueDepth());            // 130312, 130316, 130321
+    tx.process(5000);
+    bus.frames.clear();
+
+    em.update(100 + N2K_WATER_TX_INTERVAL_MS - 1);
+    ASSERT_EQ(0, tx.getQueueDepth());
+    em.update(100 + N2K_WATER_TX_INTERVAL_MS);
+    ASSERT_EQ(2, tx.getQueueDepth());            // temperature only
+    em.update(100 + N2K_SALINITY_TX_INTERVAL_MS);
+    ASSERT_EQ(3, tx.getQueueDepth());            // temperatures replaced, + salinity
+    tx.clear();
+
+    em.update(100 + N2K_VALUE_MAX_AGE_MS);      // product info is due again, nothing else
+    ASSERT_EQ(1, tx.getQueueDepth());
+    ASSERT_EQ(126996u, tx._queue[0].pgn);
+    ASSERT_FALSE(em._hasReading);
+
+    TEST_PASS();
+}
+
+// Test: salinity without temperature still goes out, temperature PGNs don't
+void test_emitter_partial() {
+    VirtualCanBus bus;
+    N2kTxScheduler tx(&bus);
+    N2kWaterQualityEmitter em(&tx);
+    em.update(0);
+    tx.clear();
+
+    em.setReadings(NAN, 34.0f, NAN, NAN, 0, 10);
+    em.update(10);
+    ASSERT_EQ(1, tx.getQueueDepth());
+    ASSERT_EQ(130321u, tx._queue[0].pgn);
+
+    TEST_PASS();
+}
+
+int main() {
+    TEST_SUITE("NMEA2000 Output");
+
+    RUN_TEST(pgn130312);
+    RUN_TEST(pgn130316);
+    RUN_TEST(pgn130321);
+    RUN_TEST(pgn126996);
+    RUN_TEST(can_id);
+    RUN_TEST(fast_packet_roundtrip);
+    RUN_TEST(priority_order);
+    RUN_TEST(rate_limit);
+    RUN_TEST(replace_same_pgn);
+    RUN_TEST(drops);
+    RUN_TEST(resume_after_refusal);
+    RUN_TEST(emitter_schedule);
+    RUN_TEST(emitter_partial);
+
+    TEST_SUMMARY();
+}
@@ -2,7 +2,7 @@
  * OTAManager state machine and version parsing tests
  *
  * Tests: state transitions, size validation, progress calculation,
- * version tag parsing, and version comparison logic.
+ * version tag parsing, version comparison logic, and release asset choice.
  */
 
 #define private public  // Access private members for state inspection
@@ -13,6 +13,8 @@
 
 #include <cstdio>
 #include <cstdlib>
+#include <vector>
+#include <zlib.h>
 
 // ============================================================================
 // Test harness (same pattern as other tests)
@@ -211,6 +213,187 @@ void test_backend_trigger_empty_version() {
     PASS();
 }
 
+void test_second_update_blocked() {
+    // Web upload and backend OTA own separate instances but share one
+    // OTA partition — only one may be receiving at a time
+    OTAManager a;
+    OTAManager b;
+    ASSERT(a.begin(1000), "first begin() should succeed");
+    ASSERT(!b.begin(1000), "second begin() should be rejected");
+    ASSERT(b.getErrorMessage().indexOf("in progress") >= 0, "error should mention update in progress");
+    a.abort();
+    ASSERT(b.begin(1000), "begin() should succeed once the first update is aborted");
+    PASS();
+}
+
+void test_upload_during_install_is_rejected() {
+    // The web upload handler and the background installer share one
+    // instance; a manual begin() mid-install must leave the install running
+    OTAManager ota;
+    uint8_t data[100];
+    memset(data, 0xE9, sizeof(data));
+    ASSERT(ota.begin(200), "install begin() should succeed");
+    ASSERT(ota.writeChunk(data, sizeof(data)), "first half should be accepted");
+
+    ASSERT(!ota.begin(5000), "upload begin() during install should be rejected");
+    ASSERT(ota.getState() == OTAManager::State::RECEIVING, "install should still be receiving");
+    ASSERT(ota.getTransferSize() == 200, "install size should be unchanged");
+    ASSERT(ota.getBytesReceived() == 100, "install progress should be unchanged");
+    ASSERT(ota.getErrorMessage().isEmpty(), "install should not pick up an error");
+    ASSERT(OTAManager::isUpdateInProgress(), "install should keep the claim");
+
+    ASSERT(ota.writeChunk(data, sizeof(data)), "second half should be accepted");
+    ASSERT(ota.end(), "install should complete");
+    ASSERT(!OTAManager::isUpdateInProgress(), "claim should be released after end()");
+    PASS();
+}
+
+void test_raw_image_format() {
+    OTAManager ota;
+    ota.begin(100);
+    uint8_t data[100];
+    memset(data, 0xE9, sizeof(data));  // ESP image magic byte
+    ota.writeChunk(data, sizeof(data));
+    ASSERT(ota.getImageFormat() == "bin", "plain image should be detected as bin");
+    ASSERT(ota.getBytesFlashed() == 100, "all bytes should be flashed as-is");
+    PASS();
+}
+
+void test_gzip_image_detected() {
+    OTAManager ota;
+    ota.begin(1000);
+    // gzip header split across two chunks
+    const uint8_t hdr1[] = {0x1F, 0x8B};
+    const uint8_t hdr2[] = {0x08, 0x00, 0, 0, 0, 0, 0x00, 0x03};
+    ota.writeChunk(hdr1, sizeof(hdr1));
+    ASSERT(ota.getImageFormat() == "unknown", "format unknown until 4 bytes seen");
+    ota.writeChunk(hdr2, sizeof(hdr2));
+    ASSERT(ota.getImageFormat() == "gzip", "gzip magic should be detected");
+    ASSERT(ota.getBytesFlashed() == 0, "header bytes must not reach flash");
+    PASS();
+}
+
+void test_gzip_image_inflated_to_flash() {
+    // What a background download of a .bin.gz feeds through writeChunk()
+    std::vector<uint8_t> img(80000);
+    for (size_t i = 0; i < img.size(); i++) img[i] = (uint8_t)(i * 7 / 3);
+    img[0] = 0xE9;  // ESP image magic byte
+
+    z_stream zs = {};
+    deflateInit2(&zs, 6, Z_DEFLATED, 16 + MAX_WBITS, 8, Z_DEFAULT_STRATEGY);
+    std::vector<uint8_t> gz(deflateBound(&zs, img.size()));
+    zs.next_in = img.data();
+    zs.avail_in = img.size();
+    zs.next_out = gz.data();
+    zs.avail_out = gz.size();
+    deflate(&zs, Z_FINISH);
+    gz.resize(zs.total_out);
+    deflateEnd(&zs);
+
+    OTAManager ota;
+    ASSERT(ota.begin(gz.size()), "begin() should accept the compressed size");
+    for (size_t i = 0; i < gz.size(); i += 1024) {
+        size_t n = gz.size() - i < 1024 ? gz.size() - i : 1024;
+        ASSERT(ota.writeChunk(&gz[i], n), "compressed chunk should be accepted");
+    }
+    ASSERT(ota.getImageFormat() == "gzip", "gzip transport should be detected");
+    ASSERT(ota.getBytesReceived() == gz.size(), "wire bytes counted compressed");
+    ASSERT(ota.getBytesFlashed() == img.size(), "flash receives the inflated image");
+    ASSERT(ota.end(), "complete gzip stream should finish");
+    ASSERT(ota.getState() == OTAManager::State::SUCCESS, "state should be SUCCESS");
+    PASS();
+}
+
+void test_truncated_delta_fails_on_end() {
+    OTAManager ota;
+    ota.begin(16);
+    const uint8_t hdr[16] = {'S','S','D','P', 1, 0, 0, 0,
+                             0x00, 0x10, 0, 0,    // source 4096
+                             0x00, 0x10, 0, 0};   // target 4096
+    ASSERT(ota.writeChunk(hdr, sizeof(hdr)), "patch header should be accepted");
+    ASSERT(ota.getImageFormat() == "delta", "delta magic should be detected");
+    ASSERT(!ota.end(), "end() should fail with no ops applied");
+    ASSERT(ota.getState() == OTAManager::State::ERROR, "state should be ERROR");
+    ASSERT(ota.getErrorMessage().indexOf("Truncated") >= 0, "error should mention truncation");
+
+    OTAManager next;
+    ASSERT(next.begin(100), "failed update should release the OTA claim");
+    PASS();
+}
+
+void test_throughput_reported() {
+    _mock_millis = 10000;
+    OTAManager ota;
+    ota.begin(8192);
+    uint8_t data[2048];
+    memset(data, 0, sizeof(data));
+    _mock_millis = 11000;  // 1 s later
+    ota.writeChunk(data, sizeof(data));
+    ASSERT(ota.getBytesReceived() == 2048, "received bytes tracked");
+    ASSERT(ota.getThroughputBps() == 2048, "2 KB in 1 s = 2048 B/s");
+    PASS();
+}
+
+// GitHub release with every kind of asset, listed in the wrong order
+static const char* RELEASE_ALL_ASSETS = R"({
+  "tag_name": "fw-b2c3d4e",
+  "assets": [
+    {"name": "SeaSenseLogger.ino.bin",
+     "browser_download_url": "https://example.com/fw.bin"},
+    {"name": "SeaSenseLogger-b2c3d4e-from-0000000.ssdp.gz",
+     "browser_download_url": "https://example.com/other-delta.ssdp.gz"},
+    {"name": "SeaSenseLogger.ino.bin.gz",
+     "browser_download_url": "https://example.com/fw.bin.gz"},
+    {"name": "SeaSenseLogger-b2c3d4e-from-a1b2c3d.ssdp.gz",
+     "browser_download_url": "https://example.com/delta.ssdp.gz"}
+  ]
+})";
+
+void test_release_prefers_delta_for_running_version() {
+    String error;
+    OTAManager::UpdateInfo info = OTAManager::parseRelease(RELEASE_ALL_ASSETS, "a1b2c3d", error);
+    ASSERT(error.isEmpty(), "release should parse");
+    ASSERT(info.available, "newer version available");
+    ASSERT(info.version == "b2c3d4e", "version from tag");
+    ASSERT(info.url == "https://example.com/delta.ssdp.gz", "delta against a1b2c3d first");
+    ASSERT(info.fallbackUrl == "https://example.com/fw.bin.gz", "gzipped image as fallback");
+    PASS();
+}
+
+void test_release_without_matching_delta_uses_gzip() {
+    String error;
+    OTAManager::UpdateInfo info = OTAManager::parseRelease(RELEASE_ALL_ASSETS, "9999999", error);
+    ASSERT(error.isEmpty(), "release should parse");
+    ASSERT(info.url == "https://example.com/fw.bin.gz", "no delta from 9999999: .bin.gz");
+    ASSERT(info.fallbackUrl.isEmpty(), "full image has no fallback");
+    PASS();
+}
+
+void test_release_bin_only() {
+    String error;
+    OTAManager::UpdateInfo info = OTAManager::parseRelease(
+        R"({"tag_name":"fw-b2c3d4e","assets":[
+            {"name":"notes.txt","browser_download_url":"https://example.com/notes.txt"},
+            {"name":"SeaSenseLogger.ino.bin","browser_download_url":"https://example.com/fw.bin"}]})",
+        "a1b2c3d", error);
+    ASSERT(error.isEmpty(), "release should parse");
+    ASSERT(info.url == "https://example.com/fw.bin", "plain .bin last");
+    ASSERT(info.fallbackUrl.isEmpty(), "full image has no fallback");
+    PASS();
+}
+
+void test_release_without_image_is_an_error() {
+    String error;
+    OTAManager::UpdateInfo info = OTAManager::parseRelease(
+        R"({"tag_name":"fw-b2c3d4e","assets":[
+            {"name":"notes.txt","browser_download_url":"https://example.com/notes.txt"}]})",
+        "a1b2c3d", error);
+    ASSERT(!error.isEmpty(), "no installable asset");
+    ASSERT(!info.available, "nothing to offer");
+    ASSERT(info.url.isEmpty(), "no URL");
+    PASS();
+}
+
 // ============================================================================
 // Main
 // ============================================================================
@@ -233,6 +416,17 @@ int main() {
     test_backend_trigger_version_differs();
     test_backend_trigger_version_same();
     test_backend_trigger_empty_version();
+    test_second_update_blocked();
+    test_upload_during_install_is_rejected();
+    test_raw_image_format();
+    test_gzip_image_detected();
+    test_gzip_image_inflated_to_flash();
+    test_truncated_delta_fails_on_end();
+    test_throughput_reported();
+    test_release_prefers_delta_for_running_version();
+    test_release_without_matching_delta_uses_gzip();
+    test_release_bin_only();
+    test_release_without_image_is_an_error();
 
     printf("\n  Results: %d passed, %d failed\n\n", g_passed, g_failed);
     return g_failed > 0 ? 1 : 0;
@@ -0,0 +1,332 @@
+/**
+ * Tests for the OTA image stream stages — DeltaPatch and gzip header parsing
+ *
+ * Patches are applied against an in-memory "running image" and fed in
+ * awkward chunk sizes to exercise the byte-level state machines.
+ */
+
+#include <Arduino.h>
+#include <vector>
+#include "test_framework.h"
+#include "../src/ota/DeltaPatch.h"
+#include "../src/ota/GzipInflater.h"
+#include <zlib.h>
+
+// ----------------------------------------------------------------------------
+// Helpers
+// ----------------------------------------------------------------------------
+
+static std::vector<uint8_t> g_source;
+static std::vector<uint8_t> g_output;
+
+static void putU32(std::vector<uint8_t>& v, uint32_t x) {
+    v.push_back(x & 0xFF);
+    v.push_back((x >> 8) & 0xFF);
+    v.push_back((x >> 16) & 0xFF);
+    v.push_back((x >> 24) & 0xFF);
+}
+
+static std::vector<uint8_t> patchHeader(uint32_t sourceSize, uint32_t targetSize) {
+    std::vector<uint8_t> p = {'S', 'S', 'D', 'P', 1, 0, 0, 0};
+    putU32(p, sourceSize);
+    putU32(p, targetSize);
+    return p;
+}
+
+static void opCopy(std::vector<uint8_t>& p, uint32_t offset, uint32_t len) {
+    p.push_back(0x01);
+    putU32(p, offset);
+    putU32(p, len);
+}
+
+static void opInsert(std::vector<uint8_t>& p, const char* bytes) {
+    size_t n = strlen(bytes);
+    p.push_back(0x02);
+    putU32(p, (uint32_t)n);
+    for (size_t i = 0; i < n; i++) p.push_back((uint8_t)bytes[i]);
+}
+
+static void beginPatch(DeltaPatch& patch) {
+    g_output.clear();
+    patch.begin(
+        [](uint32_t offset, uint8_t* buf, size_t len) {
+            if (offset + len > g_source.size()) return false;
+            memcpy(buf, g_source.data() + offset, len);
+            return true;
+        },
+        [](const uint8_t* data, size_t len) {
+            g_output.insert(g_output.end(), data, data + len);
+            return true;
+        });
+}
+
+static bool feedInChunks(DeltaPatch& patch, const std::vector<uint8_t>& p, size_t chunk) {
+    for (size_t i = 0; i < p.size(); i += chunk) {
+        size_t n = (p.size() - i < chunk) ? p.size() - i : chunk;
+        if (!patch.feed(p.data() + i, n)) return false;
+    }
+    return true;
+}
+
+static std::string outputString() {
+    return std::string(g_output.begin(), g_output.end());
+}
+
+// ----------------------------------------------------------------------------
+// DeltaPatch
+// ----------------------------------------------------------------------------
+
+// Test: copy + insert rebuilds the target, whatever the chunking
+void test_patch_copy_and_insert() {
+    g_source.assign((const uint8_t*)"HELLO OLD WORLD", (const uint8_t*)"HELLO OLD WORLD" + 15);
+
+    std::vector<uint8_t> p = patchHeader(15, 15);
+    opCopy(p, 0, 6);        // "HELLO "
+    opInsert(p, "NEW");     // "NEW"
+    opCopy(p, 9, 6);        // " WORLD"
+    p.push_back(0x00);
+
+    const size_t chunkSizes[] = {1, 3, 7, 1000};
+    for (size_t c : chunkSizes) {
+        DeltaPatch patch;
+        beginPatch(patch);
+        ASSERT_TRUE(feedInChunks(patch, p, c));
+        ASSERT_TRUE(patch.isComplete());
+        ASSERT_TRUE(outputString() == "HELLO NEW WORLD");
+        ASSERT_EQ(12u, patch.getCopiedBytes());
+        ASSERT_EQ(3u, patch.getInsertedBytes());
+    }
+
+    TEST_PASS();
+}
+
+// Test: copies larger than the internal chunk are split correctly
+void test_patch_large_copy() {
+    g_source.resize(1000);
+    for (size_t i = 0; i < g_source.size(); i++) g_source[i] = (uint8_t)(i * 7);
+
+    std::vector<uint8_t> p = patchHeader(1000, 1000);
+    opCopy(p, 0, 1000);
+    p.push_back(0x00);
+
+    DeltaPatch patch;
+    beginPatch(patch);
+    ASSERT_TRUE(feedInChunks(patch, p, 5));
+    ASSERT_TRUE(patch.isComplete());
+    ASSERT_TRUE(g_output == g_source);
+
+    TEST_PASS();
+}
+
+// Test: bad magic is rejected
+void test_patch_bad_magic() {
+    std::vector<uint8_t> p = patchHeader(10, 10);
+    p[0] = 'X';
+
+    DeltaPatch patch;
+    beginPatch(patch);
+    ASSERT_FALSE(patch.feed(p.data(), p.size()));
+    ASSERT_TRUE(patch.hasError());
+    ASSERT_FALSE(DeltaPatch::isPatch(p.data(), p.size()));
+
+    TEST_PASS();
+}
+
+// Test: copy outside the source image is rejected before any read
+void test_patch_copy_out_of_range() {
+    g_source.assign(10, 0xAA);
+    std::vector<uint8_t> p = patchHeader(10, 20);
+    opCopy(p, 5, 10);
+
+    DeltaPatch patch;
+    beginPatch(patch);
+    ASSERT_FALSE(patch.feed(p.data(), p.size()));
+    ASSERT_TRUE(patch.getErrorMessage().indexOf("outside") >= 0);
+    ASSERT_EQ((size_t)0, g_output.size());
+
+    TEST_PASS();
+}
+
+// Test: output beyond the declared target size is rejected
+void test_patch_overflow_target() {
+    std::vector<uint8_t> p = patchHeader(0, 2);
+    opInsert(p, "ABC");
+
+    DeltaPatch patch;
+    beginPatch(patch);
+    ASSERT_FALSE(patch.feed(p.data(), p.size()));
+    ASSERT_TRUE(patch.hasError());
+
+    TEST_PASS();
+}
+
+// Test: END before the target is complete is an error
+void test_patch_short_end() {
+    std::vector<uint8_t> p = patchHeader(0, 5);
+    opInsert(p, "AB");
+    p.push_back(0x00);
+
+    DeltaPatch patch;
+    beginPatch(patch);
+    ASSERT_FALSE(patch.feed(p.data(), p.size()));
+    ASSERT_FALSE(patch.isComplete());
+
+    TEST_PASS();
+}
+
+// ----------------------------------------------------------------------------
+// GzipInflater header parsing
+// ----------------------------------------------------------------------------
+
+// Test: gzip magic detection
+void test_gzip_magic() {
+    const uint8_t gz[] = {0x1F, 0x8B, 0x08, 0x00};
+    const uint8_t bin[] = {0xE9, 0x05, 0x02, 0x20};
+    ASSERT_TRUE(GzipInflater::isGzip(gz, sizeof(gz)));
+    ASSERT_FALSE(GzipInflater::isGzip(bin, sizeof(bin)));
+    ASSERT_FALSE(GzipInflater::isGzip(gz, 2));
+
+    TEST_PASS();
+}
+
+// Test: header with FNAME + FEXTRA + FHCRC is skipped byte by byte
+void test_gzip_header_optional_fields() {
+    std::vector<uint8_t> h = {0x1F, 0x8B, 0x08, 0x04 | 0x08 | 0x02, 0, 0, 0, 0, 0x00, 0x03};
+    h.push_back(3); h.push_back(0);               // XLEN = 3
+    h.push_back('a'); h.push_back('b'); h.push_back('c');
+    for (const char* c = "fw.bin"; *c; c++) h.push_back((uint8_t)*c);
+    h.push_back(0);                               // name terminator
+    h.push_back(0x12); h.push_back(0x34);         // header CRC16
+
+    GzipInflater gz;
+    ASSERT_TRUE(gz.begin([](const uint8_t*, size_t) { return true; }));
+    for (size_t i = 0; i < h.size(); i++) {
+        ASSERT_FALSE(gz.isHeaderParsed());
+        ASSERT_TRUE(gz.feed(&h[i], 1));
+    }
+    ASSERT_TRUE(gz.isHeaderParsed());
+
+    TEST_PASS();
+}
+
+// Test: plain 10-byte header completes in one chunk
+void test_gzip_header_minimal() {
+    const uint8_t h[] = {0x1F, 0x8B, 0x08, 0x00, 0, 0, 0, 0, 0x00, 0x03};
+    GzipInflater gz;
+    ASSERT_TRUE(gz.begin([](const uint8_t*, size_t) { return true; }));
+    ASSERT_TRUE(gz.feed(h, sizeof(h)));
+    ASSERT_TRUE(gz.isHeaderParsed());
+
+    TEST_PASS();
+}
+
+// Test: wrong compression method is rejected
+void test_gzip_header_rejects_non_deflate() {
+    const uint8_t h[] = {0x1F, 0x8B, 0x01, 0x00, 0, 0, 0, 0, 0x00, 0x03};
+    GzipInflater gz;
+    ASSERT_TRUE(gz.begin([](const uint8_t*, size_t) { return true; }));
+    ASSERT_FALSE(gz.feed(h, sizeof(h)));
+    ASSERT_TRUE(gz.getErrorMessage().length() > 0);
+
+    TEST_PASS();
+}
+
+// ----------------------------------------------------------------------------
+// GzipInflater round trip
+// ----------------------------------------------------------------------------
+
+// Firmware-like bytes: runs of repeated words mixed with noise
+static std::vector<uint8_t> fakeImage(size_t size) {
+    std::vector<uint8_t> img(size);
+    uint32_t x = 0x12345678;
+    for (size_t i = 0; i < size; i++) {
+        x = x * 1103515245 + 12345;
+        img[i] = (i % 512) < 384 ? (uint8_t)(i >> 2) : (uint8_t)(x >> 16);
+    }
+    return img;
+}
+
+// gzip with zlib, as `gzip -9` would produce it
+static std::vector<uint8_t> gzipWithZlib(const std::vector<uint8_t>& in) {
+    z_stream zs = {};
+    deflateInit2(&zs, 9, Z_DEFLATED, 16 + MAX_WBITS, 8, Z_DEFAULT_STRATEGY);
+    std::vector<uint8_t> out(deflateBound(&zs, in.size()));
+    zs.next_in = (Bytef*)in.data();
+    zs.avail_in = in.size();
+    zs.next_out = out.data();
+    zs.avail_out = out.size();
+    deflate(&zs, Z_FINISH);
+    out.resize(zs.total_out);
+    deflateEnd(&zs);
+    return out;
+}
+
+static bool inflateInChunks(const std::vector<uint8_t>& gz, size_t step, std::vector<uint8_t>& out) {
+    GzipInflater inf;
+    if (!inf.begin([&](const uint8_t* d, size_t n) {
+            out.insert(out.end(), d, d + n);
+            return true;
+        })) {
+        return false;
+    }
+    for (size_t i = 0; i < gz.size(); i += step) {
+        size_t n = gz.size() - i < step ? gz.size() - i : step;
+        if (!inf.feed(&gz[i], n)) return false;
+    }
+    return inf.isComplete() && inf.getInflatedBytes() == out.size();
+}
+
+// Test: an image larger than the 32 KB window inflates back byte for byte,
+// whatever the network chunking (trailer bytes after the end are ignored)
+void test_gzip_inflate_roundtrip() {
+    std::vector<uint8_t> img = fakeImage(100000);
+    std::vector<uint8_t> gz = gzipWithZlib(img);
+    ASSERT_TRUE(gz.size() < img.size());
+
+    const size_t steps[] = {1, 7, 1460, 4096, gz.size()};
+    for (size_t step : steps) {
+        std::vector<uint8_t> out;
+        ASSERT_TRUE(inflateInChunks(gz, step, out));
+        ASSERT_EQ(img.size(), out.size());
+        ASSERT_TRUE(out == img);
+    }
+
+    TEST_PASS();
+}
+
+// Test: a corrupted deflate body and a failing sink both stop the stream
+void test_gzip_inflate_errors() {
+    std::vector<uint8_t> img = fakeImage(50000);
+    std::vector<uint8_t> gz = gzipWithZlib(img);
+
+    std::vector<uint8_t> bad = gz;
+    for (size_t i = 10; i < 40; i++) bad[i] = 0xFF;
+    std::vector<uint8_t> out;
+    ASSERT_FALSE(inflateInChunks(bad, 512, out));
+
+    GzipInflater inf;
+    ASSERT_TRUE(inf.begin([](const uint8_t*, size_t) { return false; }));
+    ASSERT_FALSE(inf.feed(gz.data(), gz.size()));
+    ASSERT_TRUE(inf.getErrorMessage().indexOf("write failed") >= 0);
+
+    TEST_PASS();
+}
+
+int main() {
+    TEST_SUITE("OTA stream stages");
+
+    RUN_TEST(patch_copy_and_insert);
+    RUN_TEST(patch_large_copy);
+    RUN_TEST(patch_bad_magic);
+    RUN_TEST(patch_copy_out_of_range);
+    RUN_TEST(patch_overflow_target);
+    RUN_TEST(patch_short_end);
+    RUN_TEST(gzip_magic);
+    RUN_TEST(gzip_header_optional_fields);
+    RUN_TEST(gzip_header_minimal);
+    RUN_TEST(gzip_header_rejects_non_deflate);
+    RUN_TEST(gzip_inflate_roundtrip);
+    RUN_TEST(gzip_inflate_errors);
+
+    TEST_SUMMARY();
+}
@@ -0,0 +1,191 @@
+/**
+ * Tests for PowerManager — deadline collection, sleep decisions, residency
+ */
+
+#include <Arduino.h>
+#include "test_framework.h"
+
+#define private public
+#include "../src/system/PowerManager.h"
+#undef private
+
+#include "../config/hardware_config.h"
+
+// Test: nothing scheduled, radio quiet → longest allowed light sleep
+void test_no_deadline_sleeps_max() {
+    PowerManager pm;
+    pm.beginCycle(1000);
+    PowerManager::Decision d = pm.decide(1000);
+    ASSERT_TRUE(d.state == PowerState::LIGHT_SLEEP);
+    ASSERT_EQ((unsigned long)POWER_MAX_LIGHT_SLEEP_MS, d.durationMs);
+
+    TEST_PASS();
+}
+
+// Test: earliest deadline wins and its source is reported
+void test_earliest_deadline_wins() {
+    PowerManager pm;
+    pm.beginCycle(0);
+    pm.wakeWithin(30000, "upload");
+    pm.wakeWithin(1200, "pump");
+    pm.wakeWithin(5000, "other");
+    ASSERT_EQ(1200UL, pm.getNextDeadlineMs());
+    ASSERT_TRUE(strcmp(pm.getNextDeadlineSource(), "pump") == 0);
+
+    PowerManager::Decision d = pm.decide(200);   // 200 ms already spent this pass
+    ASSERT_TRUE(d.state == PowerState::LIGHT_SLEEP);
+    ASSERT_EQ(1000UL, d.durationMs);
+
+    TEST_PASS();
+}
+
+// Test: measurements get a pre-wake so GPS/N2K data is fresh
+void test_measurement_prewake() {
+    PowerManager pm;
+    pm.beginCycle(0);
+    pm.wakeForMeasurement(10000, "flush");
+    ASSERT_EQ(10000UL - POWER_MEASURE_PREWAKE_MS, pm.getNextDeadlineMs());
+
+    pm.beginCycle(0);
+    pm.wakeForMeasurement(500, "flush");         // inside the pre-wake window
+    ASSERT_EQ(0UL, pm.getNextDeadlineMs());
+    ASSERT_TRUE(pm.decide(0).state == PowerState::ACTIVE);
+
+    TEST_PASS();
+}
+
+// Test: a veto keeps the CPU awake regardless of deadlines
+void test_veto_stays_active() {
+    PowerManager pm;
+    pm.beginCycle(0);
+    pm.wakeWithin(60000, "pump");
+    pm.stayAwake("calibration");
+    pm.stayAwake("ota");
+    ASSERT_TRUE(pm.decide(0).state == PowerState::ACTIVE);
+    ASSERT_TRUE(strcmp(pm.getLastVeto(), "calibration") == 0);
+
+    // Cleared on the next pass
+    pm.beginCycle(10);
+    ASSERT_TRUE(pm.getLastVeto() == nullptr);
+
+    TEST_PASS();
+}
+
+// Test: radio users prevent light sleep; fall back to idle slices
+void test_radio_in_use_idles() {
+    PowerManager pm;
+    pm.beginCycle(0);
+    pm.wakeWithin(45000, "pump");
+
+    pm.setRadioState(1, false);
+    PowerManager::Decision d = pm.decide(0);
+    ASSERT_TRUE(d.state == PowerState::IDLE);
+    ASSERT_EQ((unsigned long)POWER_IDLE_SLICE_MS, d.durationMs);
+
+    pm.setRadioState(0, true);
+    ASSERT_TRUE(pm.decide(0).state == PowerState::IDLE);
+
+    pm.setRadioState(0, false);
+    ASSERT_TRUE(pm.decide(0).state == PowerState::LIGHT_SLEEP);
+
+    TEST_PASS();
+}
+
+// Test: gaps shorter than the minimum light sleep are idled through
+void test_short_gap_idles() {
+    PowerManager pm;
+    pm.beginCycle(0);
+    pm.wakeWithin(POWER_MIN_LIGHT_SLEEP_MS - 1, "upload");
+    ASSERT_TRUE(pm.decide(0).state == PowerState::IDLE);
+
+    pm.beginCycle(0);
+    pm.wakeWithin(5, "upload");
+    PowerManager::Decision d = pm.decide(0);
+    ASSERT_TRUE(d.state == PowerState::IDLE);
+    ASSERT_EQ(5UL, d.durationMs);
+
+    TEST_PASS();
+}
+
+// Test: repeated early wakes (busy CAN) pause light sleep, then it resumes
+void test_early_wake_backoff() {
+    PowerManager pm;
+    for (int i = 0; i < POWER_EARLY_WAKE_LIMIT; i++) {
+        pm.noteWake(WakeCause::CAN, 3000, 5, 1000);
+    }
+    ASSERT_EQ((uint32_t)POWER_EARLY_WAKE_LIMIT, pm.getWakeCount(WakeCause::CAN));
+
+    pm.beginCycle(2000);
+    ASSERT_TRUE(pm.decide(2000).state == PowerState::IDLE);
+
+    unsigned long later = 1000 + POWER_EARLY_WAKE_BACKOFF_MS + 1;
+    pm.beginCycle(later);
+    ASSERT_TRUE(pm.decide(later).state == PowerState::LIGHT_SLEEP);
+
+    TEST_PASS();
+}
+
+// Test: timer wakes never count as early
+void test_timer_wake_resets_early_count() {
+    PowerManager pm;
+    pm.noteWake(WakeCause::UART, 3000, 10, 0);
+    pm.noteWake(WakeCause::UART, 3000, 10, 0);
+    pm.noteWake(WakeCause::TIMER, 3000, 3000, 0);
+    pm.noteWake(WakeCause::UART, 3000, 10, 0);
+    ASSERT_FALSE(pm._sleepBlocked);
+    ASSERT_EQ(4u, pm.getSleepCount());
+
+    TEST_PASS();
+}
+
+// Test: time between idle() calls is active, residency adds up
+void test_residency_accounting() {
+    _mock_millis = 1000;
+    PowerManager pm;
+    pm.begin();
+
+    _mock_millis = 1250;            // 250 ms of loop work
+    pm.beginCycle(_mock_millis);
+    pm.stayAwake("measuring");
+    pm.idle();
+    ASSERT_EQ(250ULL, pm.getResidencyMs(PowerState::ACTIVE));
+
+    pm.account(PowerState::LIGHT_SLEEP, 3600000UL);   // one hour asleep
+    ASSERT_FLOAT_EQ(POWER_CURRENT_SLEEP_MA, pm.getChargeMAh(PowerState::LIGHT_SLEEP), 0.01);
+
+    // Average is dominated by the sleep hour
+    float avg = pm.getAverageCurrentMA();
+    ASSERT_TRUE(avg > POWER_CURRENT_SLEEP_MA);
+    ASSERT_TRUE(avg < POWER_CURRENT_SLEEP_MA + 1.0f);
+
+    TEST_PASS();
+}
+
+// Test: web task polls fast only while an AP client is connected
+void test_web_poll_interval() {
+    PowerManager pm;
+    ASSERT_EQ((uint32_t)POWER_WEB_POLL_IDLE_MS, pm.getWebPollMs());
+    pm.setRadioState(2, false);
+    ASSERT_EQ((uint32_t)POWER_WEB_POLL_ACTIVE_MS, pm.getWebPollMs());
+    pm.setRadioState(0, true);
+    ASSERT_EQ((uint32_t)POWER_WEB_POLL_IDLE_MS, pm.getWebPollMs());
+
+    TEST_PASS();
+}
+
+int main() {
+    TEST_SUITE("PowerManager");
+
+    RUN_TEST(no_deadline_sleeps_max);
+    RUN_TEST(earliest_deadline_wins);
+    RUN_TEST(measurement_prewake);
+    RUN_TEST(veto_stays_active);
+    RUN_TEST(radio_in_use_idles);
+    RUN_TEST(short_gap_idles);
+    RUN_TEST(early_wake_backoff);
+    RUN_TEST(timer_wake_resets_early_count);
+    RUN_TEST(residency_accounting);
+    RUN_TEST(web_poll_interval);
+
+    TEST_SUMMARY();
+}
@@ -0,0 +1,217 @@
+/**
+ * Tests for QualityControl — flag packing and the six QARTOD-style tests
+ */
+
+#include <Arduino.h>
+#include "test_framework.h"
+#include "../src/sensors/QualityControl.h"
+#include "../config/hardware_config.h"
+
+static const unsigned long MIN = 60000UL;
+
+// Test: flags pack one digit per test and aggregate to the worst
+void test_flag_packing() {
+    QcFlags f;
+    ASSERT_FALSE(f.isSet());
+    ASSERT_STR_EQ("", f.toString());
+
+    f = QcFlags::fromString("113121");
+    ASSERT_TRUE(f.isSet());
+    ASSERT_TRUE(f.get(QcTest::SPIKE) == QcFlag::SUSPECT);
+    ASSERT_TRUE(f.get(QcTest::FLAT_LINE) == QcFlag::NOT_EVALUATED);
+    ASSERT_TRUE(f.aggregate() == QcFlag::SUSPECT);
+    ASSERT_STR_EQ("113121", f.toString());
+
+    f.set(QcTest::MULTIVARIATE, QcFlag::FAIL);
+    ASSERT_STR_EQ("113124", f.toString());
+    ASSERT_TRUE(f.aggregate() == QcFlag::FAIL);
+
+    ASSERT_TRUE(QcFlags::fromString("222222").aggregate() == QcFlag::NOT_EVALUATED);
+    ASSERT_TRUE(QcFlags::fromString("141129").aggregate() == QcFlag::MISSING);
+
+    // Malformed strings give unset flags
+    ASSERT_FALSE(QcFlags::fromString("11312").isSet());
+    ASSERT_FALSE(QcFlags::fromString("11x121").isSet());
+    ASSERT_FALSE(QcFlags::fromString("115121").isSet());
+
+    TEST_PASS();
+}
+
+// Test: gross range fails outside the sensor span, suspect outside seawater
+void test_gross_range() {
+    QualityControl qc;
+    ASSERT_TRUE(qc.evaluate(QcChannel::TEMPERATURE, 20.0f, 0).get(QcTest::GROSS_RANGE) == QcFlag::PASS);
+    ASSERT_TRUE(qc.evaluate(QcChannel::TEMPERATURE, 37.0f, MIN).get(QcTest::GROSS_RANGE) == QcFlag::SUSPECT);
+    ASSERT_TRUE(qc.evaluate(QcChannel::TEMPERATURE, 50.0f, 2 * MIN).get(QcTest::GROSS_RANGE) == QcFlag::FAIL);
+    ASSERT_TRUE(qc.evaluate(QcChannel::PH, 15.0f, 0).get(QcTest::GROSS_RANGE) == QcFlag::FAIL);
+    ASSERT_TRUE(qc.evaluate(QcChannel::CONDUCTIVITY, 45000.0f, 0).get(QcTest::GROSS_RANGE) == QcFlag::PASS);
+
+    TEST_PASS();
+}
+
+// Test: spike needs two predecessors, then compares against their mean
+void test_spike() {
+    QualityControl qc;
+    ASSERT_TRUE(qc.evaluate(QcChannel::TEMPERATURE, 20.0f, 0).get(QcTest::SPIKE) == QcFlag::NOT_EVALUATED);
+    ASSERT_TRUE(qc.evaluate(QcChannel::TEMPERATURE, 20.1f, MIN).get(QcTest::SPIKE) == QcFlag::NOT_EVALUATED);
+    ASSERT_TRUE(qc.evaluate(QcChannel::TEMPERATURE, 20.2f, 2 * MIN).get(QcTest::SPIKE) == QcFlag::PASS);
+    ASSERT_TRUE(qc.evaluate(QcChannel::TEMPERATURE, 21.8f, 3 * MIN).get(QcTest::SPIKE) == QcFlag::SUSPECT);
+    ASSERT_TRUE(qc.evaluate(QcChannel::TEMPERATURE, 25.5f, 4 * MIN).get(QcTest::SPIKE) == QcFlag::FAIL);
+
+    TEST_PASS();
+}
+
+// Test: rate of change scales with the time between samples
+void test_rate_of_change() {
+    QualityControl qc;
+    ASSERT_TRUE(qc.evaluate(QcChannel::TEMPERATURE, 20.0f, 0).get(QcTest::RATE_OF_CHANGE) == QcFlag::NOT_EVALUATED);
+    // 0.4 °C in one minute: fine
+    ASSERT_TRUE(qc.evaluate(QcChannel::TEMPERATURE, 20.4f, MIN).get(QcTest::RATE_OF_CHANGE) == QcFlag::PASS);
+    // 1 °C in one minute: too fast
+    ASSERT_TRUE(qc.evaluate(QcChannel::TEMPERATURE, 21.4f, 2 * MIN).get(QcTest::RATE_OF_CHANGE) == QcFlag::SUSPECT);
+    // 1 °C over ten minutes: fine
+    ASSERT_TRUE(qc.evaluate(QcChannel::TEMPERATURE, 22.4f, 12 * MIN).get(QcTest::RATE_OF_CHANGE) == QcFlag::PASS);
+
+    TEST_PASS();
+}
+
+// Test: identical readings go suspect, then fail, and recover on change
+void test_flat_line() {
+    QualityControl qc;
+    QcFlag flag = QcFlag::NOT_EVALUATED;
+    int i = 0;
+    ASSERT_TRUE(qc.evaluate(QcChannel::PH, 8.1f, 0).get(QcTest::FLAT_LINE) == QcFlag::NOT_EVALUATED);
+    for (i = 1; i < QC_FLAT_SUSPECT_COUNT; i++) {
+        flag = qc.evaluate(QcChannel::PH, 8.1f, i * MIN).get(QcTest::FLAT_LINE);
+        ASSERT_TRUE(flag == QcFlag::PASS);
+    }
+    for (; i < QC_FLAT_FAIL_COUNT; i++) {
+        flag = qc.evaluate(QcChannel::PH, 8.1f, i * MIN).get(QcTest::FLAT_LINE);
+        ASSERT_TRUE(flag == QcFlag::SUSPECT);
+    }
+    flag = qc.evaluate(QcChannel::PH, 8.1f, i++ * MIN).get(QcTest::FLAT_LINE);
+    ASSERT_TRUE(flag == QcFlag::FAIL);
+
+    flag = qc.evaluate(QcChannel::PH, 8.12f, i++ * MIN).get(QcTest::FLAT_LINE);
+    ASSERT_TRUE(flag == QcFlag::PASS);
+
+    TEST_PASS();
+}
+
+// Test: climatology waits for warm-up, then flags departures from the learned mean
+void test_climatology() {
+    QualityControl qc;
+    unsigned long t = 0;
+    for (int i = 0; i < QC_CLIMATOLOGY_MIN_SAMPLES; i++, t += MIN) {
+        float v = (i % 2) ? 20.2f : 20.0f;
+        ASSERT_TRUE(qc.evaluate(QcChannel::TEMPERATURE, v, t).get(QcTest::CLIMATOLOGY) == QcFlag::NOT_EVALUATED);
+    }
+    ASSERT_TRUE(qc.evaluate(QcChannel::TEMPERATURE, 20.3f, t).get(QcTest::CLIMATOLOGY) == QcFlag::PASS);
+    t += MIN;
+    // Sigma is floored at 0.5 °C: 4 sigma = 2 °C from ~20.1
+    ASSERT_TRUE(qc.evaluate(QcChannel::TEMPERATURE, 23.0f, t).get(QcTest::CLIMATOLOGY) == QcFlag::SUSPECT);
+
+    TEST_PASS();
+}
+
+// Test: temperature against the boat's transducer; EC inherits temperature
+void test_multivariate() {
+    QualityControl qc;
+    ASSERT_TRUE(qc.evaluate(QcChannel::TEMPERATURE, 20.0f, 0).get(QcTest::MULTIVARIATE) == QcFlag::NOT_EVALUATED);
+    ASSERT_TRUE(qc.evaluate(QcChannel::TEMPERATURE, 20.1f, MIN, 19.0f).get(QcTest::MULTIVARIATE) == QcFlag::PASS);
+    ASSERT_TRUE(qc.evaluate(QcChannel::TEMPERATURE, 20.2f, 2 * MIN, 15.0f).get(QcTest::MULTIVARIATE) == QcFlag::SUSPECT);
+
+    // EC compensated with a suspect temperature is suspect itself
+    ASSERT_TRUE(qc.evaluate(QcChannel::CONDUCTIVITY, 45000.0f, 2 * MIN).get(QcTest::MULTIVARIATE) == QcFlag::SUSPECT);
+
+    // Good temperature: EC and pH pass, DO takes the worse of temperature and EC
+    qc.evaluate(QcChannel::TEMPERATURE, 20.3f, 3 * MIN, 20.0f);
+    ASSERT_TRUE(qc.evaluate(QcChannel::PH, 8.1f, 3 * MIN).get(QcTest::MULTIVARIATE) == QcFlag::PASS);
+    qc.evaluate(QcChannel::CONDUCTIVITY, 20000.0f, 3 * MIN);     // gross range suspect
+    ASSERT_TRUE(qc.evaluate(QcChannel::DISSOLVED_OXYGEN, 7.0f, 3 * MIN).get(QcTest::MULTIVARIATE) == QcFlag::SUSPECT);
+
+    // A stale temperature result says nothing about this cycle
+    ASSERT_TRUE(qc.evaluate(QcChannel::PH, 8.1f, 3 * MIN + QC_MV_COMPANION_MAX_AGE_MS + 1)
+                    .get(QcTest::MULTIVARIATE) == QcFlag::NOT_EVALUATED);
+
+    TEST_PASS();
+}
+
+// Test: a missing value flags every test 9 and leaves history alone
+void test_missing_value() {
+    QualityControl qc;
+    qc.evaluate(QcChannel::DISSOLVED_OXYGEN, 7.0f, 0);
+    qc.evaluate(QcChannel::DISSOLVED_OXYGEN, 7.1f, MIN);
+
+    QcFlags f = qc.evaluate(QcChannel::DISSOLVED_OXYGEN, NAN, 2 * MIN);
+    ASSERT_STR_EQ("999999", f.toString());
+    ASSERT_TRUE(f.aggregate() == QcFlag::MISSING);
+
+    ASSERT_TRUE(qc.evaluate(QcChannel::DISSOLVED_OXYGEN, 7.05f, 3 * MIN).get(QcTest::SPIKE) == QcFlag::PASS);
+
+    TEST_PASS();
+}
+
+// Test: a failed value is not the reference for the next one
+void test_fail_not_accepted() {
+    QualityControl qc;
+    qc.evaluate(QcChannel::TEMPERATURE, 20.0f, 0);
+    qc.evaluate(QcChannel::TEMPERATURE, 20.1f, MIN);
+    qc.evaluate(QcChannel::TEMPERATURE, 85.0f, 2 * MIN);         // disconnected probe
+    QcFlags f = qc.evaluate(QcChannel::TEMPERATURE, 20.1f, 3 * MIN);
+    ASSERT_TRUE(f.get(QcTest::SPIKE) == QcFlag::PASS);
+    ASSERT_TRUE(f.get(QcTest::RATE_OF_CHANGE) == QcFlag::PASS);
+
+    TEST_PASS();
+}
+
+// Test: neighbours across a long gap or a reset are not compared
+void test_gap_and_reset() {
+    QualityControl qc;
+    qc.evaluate(QcChannel::TEMPERATURE, 20.0f, 0);
+    qc.evaluate(QcChannel::TEMPERATURE, 20.1f, MIN);
+    QcFlags f = qc.evaluate(QcChannel::TEMPERATURE, 24.0f, MIN + QC_HISTORY_MAX_GAP_MS + 1);
+    ASSERT_TRUE(f.get(QcTest::SPIKE) == QcFlag::NOT_EVALUATED);
+    ASSERT_TRUE(f.get(QcTest::RATE_OF_CHANGE) == QcFlag::NOT_EVALUATED);
+
+    qc.reset(QcChannel::TEMPERATURE);
+    f = qc.evaluate(QcChannel::TEMPERATURE, 20.0f, MIN + QC_HISTORY_MAX_GAP_MS + MIN);
+    ASSERT_TRUE(f.get(QcTest::RATE_OF_CHANGE) == QcFlag::NOT_EVALUATED);
+    ASSERT_TRUE(f.get(QcTest::FLAT_LINE) == QcFlag::NOT_EVALUATED);
+
+    TEST_PASS();
+}
+
+// Test: per-channel counts follow the aggregate flag
+void test_statistics() {
+    QualityControl qc;
+    qc.evaluate(QcChannel::TEMPERATURE, 20.0f, 0);
+    qc.evaluate(QcChannel::TEMPERATURE, 37.0f, MIN);             // suspect
+    qc.evaluate(QcChannel::TEMPERATURE, 50.0f, 2 * MIN);         // fail
+
+    ASSERT_EQ(3u, qc.getEvaluatedCount(QcChannel::TEMPERATURE));
+    ASSERT_EQ(1u, qc.getSuspectCount(QcChannel::TEMPERATURE));
+    ASSERT_EQ(1u, qc.getFailCount(QcChannel::TEMPERATURE));
+    ASSERT_EQ(0u, qc.getEvaluatedCount(QcChannel::PH));
+    ASSERT_TRUE(qc.getLastFlags(QcChannel::TEMPERATURE).get(QcTest::GROSS_RANGE) == QcFlag::FAIL);
+
+    TEST_PASS();
+}
+
+int main() {
+    TEST_SUITE("QualityControl");
+
+    RUN_TEST(flag_packing);
+    RUN_TEST(gross_range);
+    RUN_TEST(spike);
+    RUN_TEST(rate_of_change);
+    RUN_TEST(flat_line);
+    RUN_TEST(climatology);
+    RUN_TEST(multivariate);
+    RUN_TEST(missing_value);
+    RUN_TEST(fail_not_accepted);
+    RUN_TEST(gap_and_reset);
+    RUN_TEST(statistics);
+
+    TEST_SUMMARY();
+}
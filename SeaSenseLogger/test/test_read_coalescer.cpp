@@ -0,0 +1,129 @@
+/**
+ * Tests for ReadCoalescer — web sensor reads within the freshness window
+ * share one I2C acquisition, and requests queued behind an in-flight read
+ * join it, so bus traffic does not grow with the number of clients
+ */
+
+#include <Arduino.h>
+#include "test_framework.h"
+
+#include "../src/sensors/ReadCoalescer.h"
+
+static const unsigned long FRESH = 3000;
+static const unsigned long READ_MS = 4000;     // four EZO probes, ~1 s each
+
+// Simulated bus: each acquisition advances the clock by READ_MS
+struct Bus {
+    int reads = 0;
+    uint8_t mask = 0x0F;
+
+    ReadCoalescer::Acquisition fn() {
+        return [this]() {
+            reads++;
+            _mock_millis += READ_MS;
+            return mask;
+        };
+    }
+};
+
+// One web request, as the handler runs it
+static bool request(ReadCoalescer& rc, Bus& bus, unsigned long requestedAt) {
+    if (rc.tryShare(requestedAt)) {
+        return false;
+    }
+    return rc.acquire(requestedAt, bus.fn());
+}
+
+// Test: the first request reads, requests inside the window share it
+void test_fresh_window_shared() {
+    _mock_millis = 10000;
+    ReadCoalescer rc(FRESH);
+    Bus bus;
+    ASSERT_EQ(ULONG_MAX, rc.getAgeMs(_mock_millis));
+
+    ASSERT_TRUE(request(rc, bus, _mock_millis));
+    ASSERT_EQ(1, bus.reads);
+    ASSERT_EQ(0x0F, rc.getOkMask());
+    ASSERT_EQ(0ul, rc.getAgeMs(_mock_millis));
+
+    // Two more clients a second later share it
+    _mock_millis += 1000;
+    ASSERT_FALSE(request(rc, bus, _mock_millis));
+    ASSERT_FALSE(request(rc, bus, _mock_millis));
+    ASSERT_EQ(1, bus.reads);
+    ASSERT_EQ(1000ul, rc.getAgeMs(_mock_millis));
+
+    // Past the window the next request reads again
+    _mock_millis += FRESH;
+    ASSERT_TRUE(request(rc, bus, _mock_millis));
+    ASSERT_EQ(2, bus.reads);
+
+    ASSERT_EQ(4u, rc.getRequestCount());
+    ASSERT_EQ(2u, rc.getAcquisitionCount());
+    ASSERT_EQ(2u, rc.getCoalescedCount());
+
+    TEST_PASS();
+}
+
+// Test: N clients arriving while one read is in flight cause no extra reads
+void test_waiters_join_in_flight() {
+    _mock_millis = 50000;
+    ReadCoalescer rc(FRESH);
+    Bus bus;
+
+    // Five requests arrive together; all miss the cache, the first takes the bus
+    unsigned long arrived = _mock_millis;
+    int clients = 5;
+    for (int i = 0; i < clients; i++) {
+        ASSERT_FALSE(rc.tryShare(arrived));
+    }
+    // ... and the rest get the bus one after another once it is done
+    for (int i = 0; i < clients; i++) {
+        rc.acquire(arrived, bus.fn());
+    }
+    ASSERT_EQ(1, bus.reads);
+    ASSERT_EQ(1u, rc.getAcquisitionCount());
+    ASSERT_EQ(4u, rc.getCoalescedCount());
+
+    TEST_PASS();
+}
+
+// Test: a measurement cycle in loop() counts as an acquisition for the web
+void test_loop_cycle_recorded() {
+    _mock_millis = 100000;
+    ReadCoalescer rc(FRESH);
+    Bus bus;
+
+    // A web request arrives mid-cycle and waits for the bus
+    unsigned long arrived = _mock_millis + 500;
+    _mock_millis += READ_MS;
+    rc.record(_mock_millis, 0x05);
+    ASSERT_FALSE(rc.tryShare(_mock_millis + FRESH));  // stale for a later client...
+    ASSERT_FALSE(rc.acquire(arrived, bus.fn()));      // ...but joined by the waiter
+    ASSERT_EQ(0, bus.reads);
+    ASSERT_EQ(0x05, rc.getOkMask());
+
+    // Once stale, the next request reads again
+    _mock_millis += FRESH;
+    ASSERT_TRUE(request(rc, bus, _mock_millis));
+    ASSERT_EQ(1, bus.reads);
+    ASSERT_EQ(0x0F, rc.getOkMask());
+
+    // Failed probes are reported through the mask
+    bus.mask = 0x01;
+    _mock_millis += FRESH;
+    ASSERT_TRUE(request(rc, bus, _mock_millis));
+    ASSERT_EQ(0x01, rc.getOkMask());
+
+    TEST_PASS();
+}
+
+int main() {
+    TEST_SUITE("Read Coalescer");
+
+    RUN_TEST(fresh_window_shared);
+    RUN_TEST(waiters_join_in_flight);
+    RUN_TEST(loop_cycle_recorded);
+
+    TEST_SUMMARY();
+}
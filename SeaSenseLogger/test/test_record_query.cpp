@@ -0,0 +1,199 @@
+/**
+ * Tests for RecordQuery — projected CSV parsing, early predicate
+ * rejection, and column projection in the archive decoder
+ */
+
+#include <Arduino.h>
+#include "test_framework.h"
+#include "../src/storage/RecordQuery.h"
+#include "../src/storage/ArchiveCodec.h"
+#include "../src/sensors/QualityControl.h"
+#include "../src/system/TimeService.h"
+#include <time.h>
+
+static const char* LINE =
+    "1234567,2025-06-15T12:30:00Z,52.123456,4.654321,1.5,8,1.2,"
+    "Temperature,EZO-RTD,RTD-001,1,2025-06-01,22.45,C,good,"
+    "5.20,180.0,6.10,170.5,3.50,2.10,18.30,21.00,101325,65.5,"
+    "270.0,3.50,268.0,1.2,-0.5,5.80,168.3,0.120,-0.050,0.030,113121,98.4,1521.37";
+
+// Test: a default query converts every column
+void test_parse_all_fields() {
+    DataRecord r;
+    ASSERT_TRUE(parseCSVRecord(LINE, r, RecordQuery()));
+    ASSERT_EQ(1234567u, (unsigned)r.millis);
+    ASSERT_STR_EQ("2025-06-15T12:30:00Z", r.timestampUTC);
+    ASSERT_FLOAT_EQ(52.123456, r.latitude, 1e-6);
+    ASSERT_EQ(8, (int)r.gps_satellites);
+    ASSERT_STR_EQ("RTD-001", r.sensorSerial);
+    ASSERT_EQ(1, (int)r.sensorInstance);
+    ASSERT_FLOAT_EQ(22.45f, r.value, 0.001f);
+    ASSERT_STR_EQ("good", r.quality);
+    ASSERT_FLOAT_EQ(5.2f, r.windSpeedTrue, 0.001f);
+    ASSERT_FLOAT_EQ(0.03f, r.linAccelZ, 0.001f);
+    ASSERT_STR_EQ("113121", QcFlags(r.qcFlags).toString());
+    ASSERT_FLOAT_EQ(1521.37f, r.soundSpeed, 0.01f);
+
+    // Padded fields are trimmed; the unsynced placeholder reads as ""
+    ASSERT_TRUE(parseCSVRecord(" 42 , " + String(TimeService::UNSYNCED_UTC) + ",,,,0,, pH ,m,s,0", r, RecordQuery()));
+    ASSERT_EQ(42u, (unsigned)r.millis);
+    ASSERT_STR_EQ("", r.timestampUTC);
+    ASSERT_NAN(r.latitude);
+    ASSERT_STR_EQ("pH", r.sensorType);
+    ASSERT_NAN(r.value);        // old 11-column line: no value column
+
+    // Fewer than 10 columns is malformed
+    ASSERT_FALSE(parseCSVRecord("1,2,3,4,5,6,7,8,9", r, RecordQuery()));
+
+    TEST_PASS();
+}
+
+// Test: unrequested columns are left "not available"
+void test_projection() {
+    RecordQuery q;
+    q.fields = RecordField::SENSOR_TYPE | RecordField::VALUE | RecordField::UNIT | RecordField::QUALITY;
+
+    DataRecord r;
+    r.sensorModel = "stale";
+    ASSERT_TRUE(parseCSVRecord(LINE, r, q));
+    ASSERT_STR_EQ("Temperature", r.sensorType);
+    ASSERT_FLOAT_EQ(22.45f, r.value, 0.001f);
+    ASSERT_STR_EQ("C", r.unit);
+    ASSERT_STR_EQ("good", r.quality);
+
+    ASSERT_EQ(0u, (unsigned)r.millis);
+    ASSERT_STR_EQ("", r.timestampUTC);
+    ASSERT_STR_EQ("", r.sensorModel);
+    ASSERT_NAN(r.latitude);
+    ASSERT_NAN(r.windSpeedTrue);
+    ASSERT_NAN(r.soundSpeed);
+    ASSERT_EQ(0u, r.qcFlags);
+
+    // Still rejects short lines, even when the mask ends early
+    q.fields = RecordField::MILLIS;
+    ASSERT_TRUE(parseCSVRecord(LINE, r, q));
+    ASSERT_FALSE(parseCSVRecord("1,2,3,4,5,6,7,8,9", r, q));
+
+    TEST_PASS();
+}
+
+// Test: predicates match and reject, converting the fields they read
+void test_predicates() {
+    DataRecord r;
+    RecordQuery q;
+    q.fields = RecordField::VALUE;
+
+    q.sensorType = "Temperature";
+    ASSERT_TRUE(parseCSVRecord(LINE, r, q));
+    ASSERT_STR_EQ("Temperature", r.sensorType);
+    q.sensorType = "pH";
+    ASSERT_FALSE(parseCSVRecord(LINE, r, q));
+    q.sensorType = "";
+
+    q.quality = "good";
+    ASSERT_TRUE(parseCSVRecord(LINE, r, q));
+    q.quality = "suspect";
+    ASSERT_FALSE(parseCSVRecord(LINE, r, q));
+    q.quality = "";
+
+    q.minMillis = 1234567;
+    q.maxMillis = 1234567;
+    ASSERT_TRUE(parseCSVRecord(LINE, r, q));
+    q.minMillis = 1234568;
+    ASSERT_FALSE(parseCSVRecord(LINE, r, q));
+    q.minMillis = 0;
+    q.maxMillis = 1000;
+    ASSERT_FALSE(parseCSVRecord(LINE, r, q));
+    q.maxMillis = ULONG_MAX;
+
+    q.minLatitude = 52.0;
+    q.maxLatitude = 53.0;
+    q.minLongitude = 4.0;
+    q.maxLongitude = 5.0;
+    ASSERT_TRUE(parseCSVRecord(LINE, r, q));
+    q.maxLongitude = 4.5;
+    ASSERT_FALSE(parseCSVRecord(LINE, r, q));
+
+    // A record without a fix is outside every bounding box
+    q.maxLongitude = 5.0;
+    ASSERT_FALSE(parseCSVRecord("1,,,,,0,,pH,m,s,0,,8.1,pH,good", r, q));
+
+    // A predicate on a column an old line lacks does not match
+    RecordQuery old;
+    old.quality = "good";
+    ASSERT_FALSE(parseCSVRecord("1,,,,,0,,pH,m,s,0", r, old));
+
+    TEST_PASS();
+}
+
+static DataRecord makeRecord(uint32_t i) {
+    DataRecord r;
+    parseCSVRecord(LINE, r, RecordQuery());
+    r.millis = 1000 + i * 1000;
+    r.sensorType = (i % 2) ? "pH" : "Temperature";
+    r.value = (i % 2) ? 8.0f + i * 0.01f : 20.0f + i * 0.1f;
+    return r;
+}
+
+// Test: the archive decoder skips unrequested columns, value still
+// decodes without sensor type requested
+void test_archive_projection() {
+    ArchiveEncoder enc;
+    for (uint32_t i = 0; i < 32; i++) {
+        enc.add(makeRecord(i));
+    }
+    std::vector<uint8_t> block;
+    enc.finish(block);
+
+    ArchiveDecoder dec;
+    ASSERT_TRUE(dec.begin(block.data(), block.size(), RecordField::MILLIS | RecordField::VALUE));
+    DataRecord out;
+    for (uint32_t i = 0; i < 32; i++) {
+        ASSERT_TRUE(dec.next(out));
+        DataRecord in = makeRecord(i);
+        ASSERT_EQ((unsigned)in.millis, (unsigned)out.millis);
+        ASSERT_TRUE(in.value == out.value);
+        ASSERT_STR_EQ("", out.sensorModel);
+        ASSERT_STR_EQ("", out.timestampUTC);
+        ASSERT_NAN(out.latitude);
+        ASSERT_NAN(out.windSpeedTrue);
+        ASSERT_EQ(0u, out.qcFlags);
+    }
+    ASSERT_FALSE(dec.next(out));
+
+    TEST_PASS();
+}
+
+// Test: projected parsing is cheaper than a full parse
+void test_projection_cost() {
+    const int N = 20000;
+    String line(LINE);
+    DataRecord r;
+    RecordQuery all;
+    RecordQuery latest;
+    latest.fields = RecordField::SENSOR_TYPE | RecordField::VALUE | RecordField::UNIT | RecordField::QUALITY;
+
+    clock_t t0 = clock();
+    for (int i = 0; i < N; i++) parseCSVRecord(line, r, all);
+    clock_t t1 = clock();
+    for (int i = 0; i < N; i++) parseCSVRecord(line, r, latest);
+    clock_t t2 = clock();
+
+    printf("    full %.2f us/line, 4-field projection %.2f us/line\n",
+           1e6 * (t1 - t0) / CLOCKS_PER_SEC / N, 1e6 * (t2 - t1) / CLOCKS_PER_SEC / N);
+    ASSERT_TRUE(t2 - t1 < t1 - t0);
+
+    TEST_PASS();
+}
+
+int main() {
+    TEST_SUITE("Record Query");
+
+    RUN_TEST(parse_all_fields);
+    RUN_TEST(projection);
+    RUN_TEST(predicates);
+    RUN_TEST(archive_projection);
+    RUN_TEST(projection_cost);
+
+    TEST_SUMMARY();
+}
@@ -0,0 +1,119 @@
+/**
+ * Tests for RecordSchema — the generated CSV header, rows and upload
+ * JSON must match the formats already on cards and on the server
+ */
+
+#include <Arduino.h>
+#include "test_framework.h"
+#include "../src/storage/RecordSchema.h"
+#include <map>
+#include <string>
+
+// Header as written by every firmware since the derived columns were added
+static const char* HEADER =
+    "millis,timestamp_utc,latitude,longitude,altitude,gps_sats,gps_hdop,"
+    "sensor_type,sensor_model,sensor_serial,sensor_instance,calibration_date,"
+    "value,unit,quality,"
+    "wind_speed_true_ms,wind_angle_true_deg,wind_speed_app_ms,wind_angle_app_deg,"
+    "water_depth_m,stw_ms,water_temp_ext_c,air_temp_c,baro_pressure_pa,"
+    "humidity_pct,cog_deg,sog_ms,heading_deg,pitch_deg,roll_deg,"
+    "wind_speed_corr_ms,wind_angle_corr_deg,"
+    "lin_accel_x,lin_accel_y,lin_accel_z,qc_flags,"
+    "do_sat_pct,sound_speed_ms";
+
+static DataRecord makeRecord() {
+    DataRecord r;
+    RecordSchema::clear(r);
+    r.millis = 1234567;
+    r.timestampUTC = "2025-06-15T12:30:00Z";
+    r.latitude = 52.123456;
+    r.longitude = 4.654321;
+    r.altitude = 1.5;
+    r.gps_satellites = 8;
+    r.gps_hdop = 1.2;
+    r.sensorType = "Temperature";
+    r.sensorModel = "EZO-RTD";
+    r.sensorSerial = "RTD-001";
+    r.sensorInstance = 1;
+    r.calibrationDate = "2025-06-01";
+    r.value = 22.45f;
+    r.unit = "C";
+    r.quality = "good";
+    r.waterDepth = 3.5f;
+    r.baroPressure = 101325.0f;
+    r.linAccelZ = 0.03f;
+    r.qcFlags = QcFlags::fromString("113121").packed;
+    r.soundSpeed = 1521.37f;
+    return r;
+}
+
+// Collects what toJSON() writes
+struct JsonCapture {
+    std::map<std::string, std::string> strings;
+    std::map<std::string, double> numbers;
+
+    struct Slot {
+        JsonCapture& owner;
+        std::string key;
+        void operator=(const String& v) { owner.strings[key] = v.c_str(); }
+        void operator=(double v) { owner.numbers[key] = v; }
+    };
+    Slot operator[](const char* key) { return Slot{*this, key}; }
+};
+
+// Test: the generated header is the one on existing cards
+void test_header() {
+    ASSERT_STR_EQ(HEADER, RecordSchema::csvHeader());
+    ASSERT_EQ(38, (int)RecordSchema::COUNT);
+    TEST_PASS();
+}
+
+// Test: rows keep the per-column precision and empty NaN columns
+void test_row_format() {
+    DataRecord r = makeRecord();
+    ASSERT_STR_EQ(
+        "1234567,2025-06-15T12:30:00Z,52.123456,4.654321,1.5,8,1.2,"
+        "Temperature,EZO-RTD,RTD-001,1,2025-06-01,22.45,C,good,"
+        ",,,,3.50,,,,101325,,,,,,,,,,,0.030,113121,,1521.37",
+        RecordSchema::toCSV(r));
+
+    // Unsynced time keeps its fixed-width placeholder for back-fill
+    r.timestampUTC = "";
+    String csv = RecordSchema::toCSV(r);
+    ASSERT_TRUE(csv.indexOf(TimeService::UNSYNCED_UTC) == 8);
+
+    TEST_PASS();
+}
+
+// Test: upload keys, NaN fields left out, hand-mapped fields not written
+void test_json_keys() {
+    DataRecord r = makeRecord();
+    JsonCapture json;
+    RecordSchema::toJSON(r, json);
+
+    ASSERT_STR_EQ("EZO-RTD", String(json.strings["sensor_model"].c_str()));
+    ASSERT_STR_EQ("2025-06-01", String(json.strings["calibration_date"].c_str()));
+    ASSERT_EQ(1, (int)json.numbers["sensor_instance"]);
+    ASSERT_FLOAT_EQ(3.5, json.numbers["water_depth_m"], 0.001);
+    ASSERT_FLOAT_EQ(1521.37, json.numbers["sound_speed_ms"], 0.01);
+
+    ASSERT_EQ(0, (int)json.numbers.count("wind_speed_true_ms"));   // NaN
+    ASSERT_EQ(0, (int)json.numbers.count("speed_through_water_ms"));
+    ASSERT_EQ(0, (int)json.strings.count("sensor_type"));          // mapped by hand
+    ASSERT_EQ(0, (int)json.numbers.count("value"));
+    ASSERT_EQ(0, (int)json.numbers.count("millis"));
+    ASSERT_EQ(3, (int)json.strings.size());     // model, serial, calibration
+    ASSERT_EQ(5, (int)json.numbers.size());     // instance + the 4 floats set
+
+    TEST_PASS();
+}
+
+int main() {
+    TEST_SUITE("Record Schema");
+
+    RUN_TEST(header);
+    RUN_TEST(row_format);
+    RUN_TEST(json_keys);
+
+    TEST_SUMMARY();
+}
@@ -0,0 +1,266 @@
+/**
+ * Tests for RecoveryManager — escalation ladder, backoff, probing, reboot guard
+ */
+
+#include <Arduino.h>
+
+// Before test_framework.h: its RESET colour macro would clobber ACTION_RESET
+#define private public
+#include "../src/system/RecoveryManager.h"
+#undef private
+
+static const RecoveryAction ACTION_RESET = RecoveryAction::RESET;
+
+#include "test_framework.h"
+
+#include "../config/hardware_config.h"
+
+// Records which handlers ran, in order
+static String g_calls;
+
+static void installRecorders(RecoveryManager& rm, Subsystem s) {
+    rm.setHandler(s, ACTION_RESET,   []() { g_calls += "R"; return true; });
+    rm.setHandler(s, RecoveryAction::REINIT,  []() { g_calls += "I"; return true; });
+    rm.setHandler(s, RecoveryAction::DISABLE, []() { g_calls += "D"; return true; });
+}
+
+// Test: failures below the threshold leave the subsystem healthy
+void test_threshold() {
+    RecoveryManager rm;
+    rm.setPolicy(Subsystem::WIFI, 3, false);
+    rm.reportFailure(Subsystem::WIFI, 0);
+    rm.reportFailure(Subsystem::WIFI, 10);
+    ASSERT_TRUE(rm.getState(Subsystem::WIFI) == HealthState::HEALTHY);
+    rm.reportFailure(Subsystem::WIFI, 20);
+    ASSERT_TRUE(rm.getState(Subsystem::WIFI) == HealthState::DEGRADED);
+    ASSERT_EQ(3, rm.getConsecutiveFailures(Subsystem::WIFI));
+
+    TEST_PASS();
+}
+
+// Test: retry -> reset -> reinit -> disable, one rung per failed attempt
+void test_ladder_order() {
+    g_calls = "";
+    RecoveryManager rm;
+    installRecorders(rm, Subsystem::SD);
+    unsigned long t = 0;
+
+    rm.reportFailure(Subsystem::SD, t);
+    rm.process(t);
+    ASSERT_TRUE(rm.getLastAction(Subsystem::SD) == RecoveryAction::RETRY);
+    ASSERT_TRUE(rm.getState(Subsystem::SD) == HealthState::RECOVERING);
+
+    for (int i = 0; i < 3; i++) {
+        rm.reportFailure(Subsystem::SD, t);
+        t += RECOVERY_BACKOFF_MAX_MS;
+        rm.process(t);
+    }
+    ASSERT_STR_EQ("RID", g_calls.c_str());
+    ASSERT_TRUE(rm.getState(Subsystem::SD) == HealthState::DISABLED);
+    ASSERT_FALSE(rm.isAvailable(Subsystem::SD));
+
+    TEST_PASS();
+}
+
+// Test: the next rung waits for its backoff, which doubles per level
+void test_backoff() {
+    g_calls = "";
+    RecoveryManager rm;
+    installRecorders(rm, Subsystem::SD);
+
+    rm.reportFailure(Subsystem::SD, 0);
+    rm.process(0);                                  // retry, next due at base
+    rm.reportFailure(Subsystem::SD, 100);
+    rm.process(RECOVERY_BACKOFF_BASE_MS - 1);
+    ASSERT_STR_EQ("", g_calls.c_str());
+    rm.process(RECOVERY_BACKOFF_BASE_MS);
+    ASSERT_STR_EQ("R", g_calls.c_str());
+
+    unsigned long t = RECOVERY_BACKOFF_BASE_MS;
+    rm.reportFailure(Subsystem::SD, t);
+    rm.process(t + 2 * RECOVERY_BACKOFF_BASE_MS - 1);
+    ASSERT_STR_EQ("R", g_calls.c_str());
+    rm.process(t + 2 * RECOVERY_BACKOFF_BASE_MS);
+    ASSERT_STR_EQ("RI", g_calls.c_str());
+
+    ASSERT_EQ((unsigned long)RECOVERY_BACKOFF_MAX_MS, RecoveryManager::backoffFor(30));
+
+    TEST_PASS();
+}
+
+// Test: rungs without a handler are skipped
+void test_missing_handler_skipped() {
+    g_calls = "";
+    RecoveryManager rm;
+    rm.setHandler(Subsystem::GPS, RecoveryAction::REINIT, []() { g_calls += "I"; return true; });
+    rm.setPolicy(Subsystem::GPS, 1, false);
+
+    rm.reportFailure(Subsystem::GPS, 0);
+    rm.process(0);                                  // retry
+    rm.reportFailure(Subsystem::GPS, 1);
+    rm.process(RECOVERY_BACKOFF_MAX_MS);            // reset has no handler -> reinit
+    ASSERT_STR_EQ("I", g_calls.c_str());
+    ASSERT_EQ(0u, rm.getActionCount(Subsystem::GPS, ACTION_RESET));
+    ASSERT_EQ(1u, rm.getActionCount(Subsystem::GPS, RecoveryAction::REINIT));
+
+    TEST_PASS();
+}
+
+// Test: a failed action keeps escalating on its own, without new reports
+void test_failed_action_escalates() {
+    g_calls = "";
+    RecoveryManager rm;
+    rm.setHandler(Subsystem::SD, ACTION_RESET,  []() { g_calls += "R"; return false; });
+    rm.setHandler(Subsystem::SD, RecoveryAction::REINIT, []() { g_calls += "I"; return false; });
+
+    rm.reportFailure(Subsystem::SD, 0);
+    rm.process(0);
+    rm.reportFailure(Subsystem::SD, 1);
+    unsigned long t = RECOVERY_BACKOFF_MAX_MS;
+    rm.process(t);
+    ASSERT_TRUE(rm.getState(Subsystem::SD) == HealthState::DEGRADED);
+    rm.process(t + RECOVERY_BACKOFF_MAX_MS);
+    ASSERT_STR_EQ("RI", g_calls.c_str());
+    rm.process(t + 2 * RECOVERY_BACKOFF_MAX_MS);
+    ASSERT_TRUE(rm.getState(Subsystem::SD) == HealthState::DISABLED);
+
+    TEST_PASS();
+}
+
+// Test: success returns to healthy and restarts the ladder
+void test_success_resets_ladder() {
+    g_calls = "";
+    RecoveryManager rm;
+    installRecorders(rm, Subsystem::SD);
+
+    rm.reportFailure(Subsystem::SD, 0);
+    rm.process(0);
+    rm.reportFailure(Subsystem::SD, 1);
+    rm.process(RECOVERY_BACKOFF_MAX_MS);
+    ASSERT_TRUE(rm.getNextAction(Subsystem::SD) == RecoveryAction::REINIT);
+
+    rm.reportSuccess(Subsystem::SD, RECOVERY_BACKOFF_MAX_MS + 10);
+    ASSERT_TRUE(rm.getState(Subsystem::SD) == HealthState::HEALTHY);
+    ASSERT_TRUE(rm.getNextAction(Subsystem::SD) == RecoveryAction::RETRY);
+    ASSERT_EQ(0, rm.getConsecutiveFailures(Subsystem::SD));
+
+    TEST_PASS();
+}
+
+// Test: disabled subsystems ignore failures and are re-probed via reinit
+void test_disabled_probe() {
+    g_calls = "";
+    RecoveryManager rm;
+    installRecorders(rm, Subsystem::SD);
+    unsigned long t = 0;
+    rm.reportFailure(Subsystem::SD, t);
+    rm.process(t);
+    for (int i = 0; i < 3; i++) {
+        rm.reportFailure(Subsystem::SD, t);
+        t += RECOVERY_BACKOFF_MAX_MS;
+        rm.process(t);
+    }
+    ASSERT_TRUE(rm.getState(Subsystem::SD) == HealthState::DISABLED);
+
+    rm.reportFailure(Subsystem::SD, t + 1);
+    rm.process(t + RECOVERY_PROBE_INTERVAL_MS - 1);
+    ASSERT_STR_EQ("RID", g_calls.c_str());
+    ASSERT_TRUE(rm.getState(Subsystem::SD) == HealthState::DISABLED);
+
+    rm.process(t + RECOVERY_PROBE_INTERVAL_MS);
+    ASSERT_STR_EQ("RIDI", g_calls.c_str());
+    ASSERT_TRUE(rm.getState(Subsystem::SD) == HealthState::RECOVERING);
+
+    // Still broken: straight back to disabled, no second trip up the ladder
+    rm.reportFailure(Subsystem::SD, t + RECOVERY_PROBE_INTERVAL_MS + 1);
+    rm.process(t + RECOVERY_PROBE_INTERVAL_MS + RECOVERY_BACKOFF_MAX_MS);
+    ASSERT_TRUE(rm.getState(Subsystem::SD) == HealthState::DISABLED);
+    ASSERT_STR_EQ("RIDID", g_calls.c_str());
+
+    TEST_PASS();
+}
+
+// Drive a subsystem to DISABLED; returns the time it got there
+static unsigned long disable(RecoveryManager& rm, Subsystem s, unsigned long t) {
+    rm.reportFailure(s, t);
+    rm.process(t);
+    for (int i = 0; i < 3; i++) {
+        rm.reportFailure(s, t);
+        t += RECOVERY_BACKOFF_MAX_MS;
+        rm.process(t);
+    }
+    return t;
+}
+
+// Test: critical subsystems reboot, but never in the first hour of uptime
+void test_reboot_guard() {
+    RecoveryManager rm;
+    unsigned long t = disable(rm, Subsystem::I2C, 0);
+    ASSERT_TRUE(rm.getState(Subsystem::I2C) == HealthState::DISABLED);
+
+    // Probes before the uptime guard do not reboot
+    while (t + RECOVERY_PROBE_INTERVAL_MS < RECOVERY_REBOOT_MIN_UPTIME_MS) {
+        t += RECOVERY_PROBE_INTERVAL_MS;
+        rm.process(t);
+        ASSERT_FALSE(rm.isRebootRequested());
+    }
+
+    t += RECOVERY_PROBE_INTERVAL_MS;
+    rm.process(t);
+    ASSERT_TRUE(rm.isRebootRequested());
+    ASSERT_STR_EQ("i2c", rm.getRebootReason());
+    ASSERT_EQ(1u, rm.getActionCount(Subsystem::I2C, RecoveryAction::REBOOT));
+
+    TEST_PASS();
+}
+
+// Test: non-critical subsystems stay disabled forever
+void test_non_critical_never_reboots() {
+    RecoveryManager rm;
+    rm.setPolicy(Subsystem::GPS, 1, false);
+    unsigned long t = disable(rm, Subsystem::GPS, RECOVERY_REBOOT_MIN_UPTIME_MS);
+    for (int i = 0; i < 10; i++) {
+        t += RECOVERY_PROBE_INTERVAL_MS;
+        rm.process(t);
+    }
+    ASSERT_FALSE(rm.isRebootRequested());
+    ASSERT_TRUE(rm.getState(Subsystem::GPS) == HealthState::DISABLED);
+
+    TEST_PASS();
+}
+
+// Test: time per state and availability
+void test_time_in_state() {
+    RecoveryManager rm;
+    ASSERT_FALSE(rm.isMonitored(Subsystem::IMU));
+    ASSERT_FLOAT_EQ(1.0f, rm.getAvailability(Subsystem::IMU, 5000), 0.001);
+
+    rm.setPolicy(Subsystem::IMU, 1, false);
+    rm.reportSuccess(Subsystem::IMU, 1000);
+    rm.reportFailure(Subsystem::IMU, 4000);         // healthy 3 s
+    rm.reportSuccess(Subsystem::IMU, 5000);         // degraded 1 s
+
+    ASSERT_EQ(3000ULL, rm.getTimeInState(Subsystem::IMU, HealthState::HEALTHY, 5000));
+    ASSERT_EQ(1000ULL, rm.getTimeInState(Subsystem::IMU, HealthState::DEGRADED, 5000));
+    ASSERT_EQ(7000ULL, rm.getTimeInState(Subsystem::IMU, HealthState::HEALTHY, 9000));
+    ASSERT_FLOAT_EQ(0.875f, rm.getAvailability(Subsystem::IMU, 9000), 0.001);
+
+    TEST_PASS();
+}
+
+int main() {
+    TEST_SUITE("RecoveryManager");
+
+    RUN_TEST(threshold);
+    RUN_TEST(ladder_order);
+    RUN_TEST(backoff);
+    RUN_TEST(missing_handler_skipped);
+    RUN_TEST(failed_action_escalates);
+    RUN_TEST(success_resets_ladder);
+    RUN_TEST(disabled_probe);
+    RUN_TEST(reboot_guard);
+    RUN_TEST(non_critical_never_reboots);
+    RUN_TEST(time_in_state);
+
+    TEST_SUMMARY();
+}
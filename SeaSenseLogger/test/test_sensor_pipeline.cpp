@@ -0,0 +1,97 @@
+/**
+ * Tests for SensorPipeline — compile-time list filtering, lookup of
+ * compiled-out sensors, and per-type iteration order
+ */
+
+#include <Arduino.h>
+#include "test_framework.h"
+#include "../src/sensors/SensorPipeline.h"
+
+// Minimal stand-ins for the EZO probes: the pipeline only needs isEnabled()
+struct FakeTemp {
+    bool enabled = true;
+    int reads = 0;
+    bool isEnabled() const { return enabled; }
+    const char* name() const { return "temp"; }
+};
+
+struct FakeEC {
+    bool enabled = true;
+    int reads = 0;
+    bool isEnabled() const { return enabled; }
+    const char* name() const { return "ec"; }
+};
+
+struct FakePH {
+    bool enabled = true;
+    int reads = 0;
+    bool isEnabled() const { return enabled; }
+    const char* name() const { return "ph"; }
+};
+
+using AllSensors = SensorPipelineOf<SensorIf<true, FakeTemp>,
+                                    SensorIf<true, FakeEC>,
+                                    SensorIf<true, FakePH>>;
+using NoPH = SensorPipelineOf<SensorIf<true, FakeTemp>,
+                              SensorIf<true, FakeEC>,
+                              SensorIf<false, FakePH>>;
+
+// The list is decided at compile time
+static_assert(AllSensors::SIZE == 3, "three sensors");
+static_assert(NoPH::SIZE == 2, "pH filtered out");
+static_assert(std::is_same<NoPH, SensorPipeline<FakeTemp, FakeEC>>::value, "filter keeps order");
+static_assert(NoPH::has<FakeEC>() && !NoPH::has<FakePH>(), "membership");
+
+// Test: forEach visits every sensor once, in list order, as its own type
+void test_for_each_order() {
+    AllSensors sensors;
+    String order;
+    sensors.forEach([&order](auto& s) {
+        s.reads++;
+        order += s.name();
+        order += ",";
+    });
+    ASSERT_STR_EQ("temp,ec,ph,", order);
+    ASSERT_EQ(1, sensors.get<FakePH>().reads);
+
+    NoPH reduced;
+    order = "";
+    reduced.forEach([&order](auto& s) { order += s.name(); });
+    ASSERT_STR_EQ("tempec", order);
+
+    TEST_PASS();
+}
+
+// Test: find() gives nullptr for a compiled-out sensor, the object otherwise
+void test_find() {
+    AllSensors all;
+    NoPH reduced;
+    ASSERT_TRUE(all.find<FakePH>() == &all.get<FakePH>());
+    ASSERT_TRUE(reduced.find<FakePH>() == nullptr);
+    ASSERT_TRUE(reduced.find<FakeTemp>() == &reduced.get<FakeTemp>());
+
+    TEST_PASS();
+}
+
+// Test: enabledCount() follows the runtime enable flags
+void test_enabled_count() {
+    AllSensors sensors;
+    ASSERT_EQ(3, (int)sensors.enabledCount());
+    sensors.get<FakeEC>().enabled = false;
+    ASSERT_EQ(2, (int)sensors.enabledCount());
+
+    SensorPipelineOf<SensorIf<false, FakeTemp>> none;
+    ASSERT_EQ(0, (int)none.enabledCount());
+
+    TEST_PASS();
+}
+
+int main() {
+    TEST_SUITE("SensorPipeline");
+
+    RUN_TEST(for_each_order);
+    RUN_TEST(find);
+    RUN_TEST(enabled_count);
+
+    TEST_SUMMARY();
+}
@@ -0,0 +1,213 @@
+/**
+ * Tests for StabilityDetector — calibration settling detection
+ *
+ * Synthetic probe traces: flat with noise, linear drift, a step, and an
+ * exponential approach to a buffer value.
+ */
+
+#include <Arduino.h>
+#include "test_framework.h"
+#include "../src/calibration/StabilityDetector.h"
+
+// Deterministic zero-mean noise in [-amp, amp]
+static uint32_t g_lcg = 12345;
+static float noise(float amp) {
+    g_lcg = g_lcg * 1103515245u + 12345u;
+    float u = ((g_lcg >> 8) & 0xFFFF) / 65535.0f;  // 0..1
+    return (u * 2.0f - 1.0f) * amp;
+}
+
+static StabilityDetector makeDetector() {
+    StabilityDetector d;
+    d.setTolerance(0.002f, 0.03f);   // temperature: 0.2%
+    d.setMinSamples(5);
+    d.setDriftHorizon(10.0f);
+    return d;
+}
+
+// Test: a quiet flat reading is stable as soon as the minimum window fills
+void test_flat_reading_stable_at_min_samples() {
+    StabilityDetector d = makeDetector();
+    g_lcg = 1;
+    int stableAt = -1;
+    for (int i = 0; i < 20 && stableAt < 0; i++) {
+        d.addSample(i * 1.0f, 25.0f + noise(0.002f));
+        if (d.isStable()) stableAt = i + 1;
+    }
+    ASSERT_EQ(5, stableAt);
+    ASSERT_FLOAT_EQ(25.0, d.getMean(), 0.002);
+
+    TEST_PASS();
+}
+
+// Test: a steady drift is never stable, however quiet
+void test_linear_drift_not_stable() {
+    StabilityDetector d = makeDetector();
+    for (int i = 0; i < 40; i++) {
+        d.addSample(i * 1.0f, 25.0f + 0.02f * i);   // 0.2 °C per 10 s
+        ASSERT_FALSE(d.isStable());
+    }
+    ASSERT_FLOAT_EQ(0.02, d.getSlope(), 1e-4);
+    ASSERT_FLOAT_EQ(0.0, d.getNoise(), 1e-3);
+
+    TEST_PASS();
+}
+
+// Test: a step restarts the window instead of averaging across it
+void test_step_restarts_window() {
+    StabilityDetector d = makeDetector();
+    for (int i = 0; i < 10; i++) {
+        d.addSample(i * 1.0f, 20.0f);
+    }
+    ASSERT_TRUE(d.isStable());
+
+    d.addSample(10.0f, 25.0f);   // probe moved to another solution
+    ASSERT_EQ(1, d.getResetCount());
+    ASSERT_EQ(1, d.getSampleCount());
+    ASSERT_FALSE(d.isStable());
+
+    for (int i = 11; i < 15; i++) {
+        d.addSample(i * 1.0f, 25.0f);
+    }
+    ASSERT_TRUE(d.isStable());
+    ASSERT_FLOAT_EQ(25.0, d.getMean(), 1e-4);
+
+    TEST_PASS();
+}
+
+// Test: small changes inside the tolerance are not treated as steps
+void test_quantised_change_is_not_step() {
+    StabilityDetector d = makeDetector();
+    for (int i = 0; i < 6; i++) {
+        d.addSample(i * 1.0f, 25.000f);
+    }
+    d.addSample(6.0f, 25.010f);   // one display digit on a zero-noise window
+    ASSERT_EQ(0, d.getResetCount());
+    ASSERT_EQ(7, d.getSampleCount());
+
+    TEST_PASS();
+}
+
+// Test: exponential settling is extrapolated and accepted before it is flat
+void test_exponential_settling_extrapolated() {
+    // pH probe settling onto 7.00 with tau = 4 s, sampled every second
+    StabilityDetector extrap;
+    extrap.setTolerance(0.005f, 0.03f);
+    extrap.setMinSamples(5);
+    extrap.setDriftHorizon(10.0f);
+
+    int stableAt = -1;
+    for (int i = 0; i < 60 && stableAt < 0; i++) {
+        float t = i * 1.0f;
+        extrap.addSample(t, 7.0f + 0.6f * expf(-t / 4.0f));
+        if (extrap.isStable()) stableAt = i;
+    }
+    ASSERT_TRUE(stableAt > 0);
+
+    float predicted = extrap.getPredictedValue();
+    ASSERT_FALSE(std::isnan(predicted));
+    ASSERT_FLOAT_EQ(7.0, predicted, 0.01);
+
+    // Accepted through the extrapolation: the straight-line drift test
+    // alone would still be waiting
+    ASSERT_TRUE(extrap.getDrift() > extrap.getTolerance());
+
+    // ...and the reading at that point is already within half the tolerance
+    float remaining = 0.6f * expf(-stableAt / 4.0f);
+    ASSERT_TRUE(remaining <= extrap.getTolerance() * 0.5f);
+
+    TEST_PASS();
+}
+
+// Test: no extrapolation on a flat trace
+void test_no_prediction_when_flat() {
+    StabilityDetector d = makeDetector();
+    g_lcg = 7;
+    for (int i = 0; i < 15; i++) {
+        d.addSample(i * 1.0f, 25.0f + noise(0.001f));
+    }
+    ASSERT_NAN(d.getPredictedValue());
+
+    TEST_PASS();
+}
+
+// Test: a known noise floor makes a short, lucky-quiet window wait longer
+void test_noise_floor_extends_window() {
+    StabilityDetector quiet = makeDetector();
+    StabilityDetector noisy = makeDetector();
+    noisy.setNoiseFloor(0.01f);
+
+    int quietAt = -1;
+    int noisyAt = -1;
+    for (int i = 0; i < 32; i++) {
+        quiet.addSample(i * 1.0f, 25.0f);
+        noisy.addSample(i * 1.0f, 25.0f);
+        if (quietAt < 0 && quiet.isStable()) quietAt = i + 1;
+        if (noisyAt < 0 && noisy.isStable()) noisyAt = i + 1;
+    }
+    ASSERT_EQ(5, quietAt);
+    ASSERT_TRUE(noisyAt > quietAt);
+
+    TEST_PASS();
+}
+
+// Test: the sliding window keeps Welford stats in step with a direct sum
+void test_window_cap_matches_direct_stats() {
+    StabilityDetector d = makeDetector();
+    float values[100];
+    g_lcg = 99;
+    for (int i = 0; i < 100; i++) {
+        values[i] = 1000.0f + 0.5f * i + noise(1.0f);
+        d.addSample(i * 0.5f, values[i]);
+        // keep the trace free of steps
+        ASSERT_EQ(0, d.getResetCount());
+    }
+    ASSERT_EQ(StabilityDetector::MAX_SAMPLES, d.getSampleCount());
+
+    double mean = 0;
+    for (int i = 100 - StabilityDetector::MAX_SAMPLES; i < 100; i++) mean += values[i];
+    mean /= StabilityDetector::MAX_SAMPLES;
+    ASSERT_FLOAT_EQ(mean, d.getMean(), 1e-3);
+    ASSERT_FLOAT_EQ(1.0, d.getSlope(), 0.1);   // 0.5 per 0.5 s
+
+    TEST_PASS();
+}
+
+// Test: readings near zero use the absolute tolerance
+void test_absolute_tolerance_near_zero() {
+    StabilityDetector d = makeDetector();
+    for (int i = 0; i < 5; i++) {
+        d.addSample(i * 1.0f, 0.0f);
+    }
+    ASSERT_FLOAT_EQ(0.03, d.getTolerance(), 1e-6);
+    ASSERT_TRUE(d.isStable());
+
+    TEST_PASS();
+}
+
+// Test: NaN readings are ignored
+void test_nan_sample_ignored() {
+    StabilityDetector d = makeDetector();
+    d.addSample(0.0f, 25.0f);
+    d.addSample(1.0f, NAN);
+    ASSERT_EQ(1, d.getSampleCount());
+
+    TEST_PASS();
+}
+
+int main() {
+    TEST_SUITE("StabilityDetector");
+
+    RUN_TEST(flat_reading_stable_at_min_samples);
+    RUN_TEST(linear_drift_not_stable);
+    RUN_TEST(step_restarts_window);
+    RUN_TEST(quantised_change_is_not_step);
+    RUN_TEST(exponential_settling_extrapolated);
+    RUN_TEST(no_prediction_when_flat);
+    RUN_TEST(noise_floor_extends_window);
+    RUN_TEST(window_cap_matches_direct_stats);
+    RUN_TEST(absolute_tolerance_near_zero);
+    RUN_TEST(nan_sample_ignored);
+
+    TEST_SUMMARY();
+}
@@ -0,0 +1,272 @@
+/**
+ * Tests for TimeService — 64-bit monotonic clock, source priority, drift
+ * estimation — and the TimestampBackfill line repair that uses it
+ */
+
+#include <Arduino.h>
+#include "test_framework.h"
+#define private public
+#include "../src/system/TimeService.h"
+#include "../src/storage/TimestampBackfill.h"
+#undef private
+#include "../config/hardware_config.h"
+
+static const int64_t T0 = 1735689600LL * 1000;  // 2025-01-01T00:00:00Z
+
+// Test: monotonic ms keep counting through the millis() wrap
+void test_monotonic_wrap() {
+    TimeService ts;
+    ts.update(0x7FFFFFFFUL);
+    ts.update(0xFFFFFF00UL);
+    ASSERT_TRUE(ts.monoMs(0xFFFFFF00UL) == 0xFFFFFF00ULL);
+
+    ts.update(0x00000100UL);
+    ASSERT_TRUE(ts.monoMs(0x00000100UL) == 0x100000100ULL);
+
+    // A stamp from just before the wrap still maps to the first period
+    ASSERT_TRUE(ts.monoMs(0xFFFFFFF0UL) == 0xFFFFFFF0ULL);
+
+    // Second wrap
+    ts.update(0x80000000UL);
+    ts.update(0xF0000000UL);
+    ts.update(0x00000010UL);
+    ASSERT_TRUE(ts.monoMs(0x00000010UL) == 0x200000010ULL);
+
+    TEST_PASS();
+}
+
+// Test: a stale now from the other core is not a wrap
+void test_stale_update_ignored() {
+    TimeService ts;
+    ts.update(5000);
+    ts.update(4900);
+    ASSERT_EQ(0u, ts._wraps);
+    ASSERT_TRUE(ts.monoMs(5000) == 5000ULL);
+
+    TEST_PASS();
+}
+
+// Test: GNSS beats NTP; NTP only after the GNSS holdover
+void test_source_priority() {
+    TimeService ts;
+    ASSERT_FALSE(ts.isSynced());
+    ASSERT_TRUE(ts.epochMs(1000) == 0);
+
+    ASSERT_TRUE(ts.sync(TimeSource::NTP, T0, 1000));
+    ASSERT_TRUE(ts.isSynced());
+    ASSERT_TRUE(ts.getSource() == TimeSource::NTP);
+
+    // First GNSS time takes over immediately
+    ASSERT_TRUE(ts.sync(TimeSource::GPS, T0 + 1050, 2000));
+    ASSERT_TRUE(ts.getSource() == TimeSource::GPS);
+    ASSERT_EQ(50, ts.getLastStepMs());
+
+    // NTP ignored while GNSS is fresh
+    unsigned long later = 2000 + TIME_GNSS_HOLDOVER_MS - 1;
+    ts.update(later);
+    ASSERT_FALSE(ts.sync(TimeSource::NTP, T0 + later, later));
+    ASSERT_TRUE(ts.getSource() == TimeSource::GPS);
+
+    // ... and accepted once GNSS has been silent for the holdover
+    later = 2000 + TIME_GNSS_HOLDOVER_MS;
+    ts.update(later);
+    ASSERT_TRUE(ts.sync(TimeSource::NTP, T0 + later, later));
+    ASSERT_TRUE(ts.getSource() == TimeSource::NTP);
+    ASSERT_EQ(3u, ts.getSyncCount());
+
+    ASSERT_FALSE(ts.sync(TimeSource::NONE, T0, later));
+    ASSERT_FALSE(ts.sync(TimeSource::GPS, 0, later));
+
+    TEST_PASS();
+}
+
+// Test: GNSS re-anchors at most once per resync interval
+void test_resync_rate_limit() {
+    TimeService ts;
+    ASSERT_TRUE(ts.sync(TimeSource::N2K, T0, 0));
+    ASSERT_FALSE(ts.sync(TimeSource::N2K, T0 + 1000, 1000));
+    ASSERT_FALSE(ts.sync(TimeSource::GPS, T0 + 2000, 2000));
+
+    unsigned long next = TIME_RESYNC_INTERVAL_MS;
+    ts.update(next);
+    ASSERT_TRUE(ts.sync(TimeSource::N2K, T0 + next, next));
+    ASSERT_EQ(2u, ts.getSyncCount());
+
+    TEST_PASS();
+}
+
+// Test: drift converges to the crystal error and is applied in holdover
+void test_drift_estimation() {
+    TimeService ts;
+    const double ppm = 50.0;  // our crystal runs 50 ppm slow
+    unsigned long ms = 0;
+    ts.sync(TimeSource::GPS, T0, ms);
+
+    // Hourly GPS syncs: true time advances 1 h + 180 ms per local hour
+    for (int h = 1; h <= 12; h++) {
+        ms += TIME_DRIFT_MIN_SPAN_MS;
+        ts.update(ms);
+        int64_t truth = T0 + (int64_t)((double)ms * (1.0 + ppm * 1e-6));
+        ASSERT_TRUE(ts.sync(TimeSource::GPS, truth, ms));
+    }
+    ASSERT_FLOAT_EQ(ppm, ts.getDriftPpm(), 3.0);
+    ASSERT_TRUE(abs(ts.getLastStepMs()) < 15);
+
+    // Holdover: six hours without GPS stays within tens of ms
+    unsigned long holdover = ms + 6 * 3600000UL;
+    ts.update(holdover);
+    int64_t truth = T0 + (int64_t)((double)holdover * (1.0 + ppm * 1e-6));
+    ASSERT_TRUE(llabs(ts.epochMs(holdover) - truth) < 100);
+
+    TEST_PASS();
+}
+
+// Test: short spans and source changes don't move the drift estimate;
+// a wild reference is clamped
+void test_drift_guards() {
+    TimeService ts;
+    ts.sync(TimeSource::GPS, T0, 0);
+
+    // Over the resync interval but under the drift span: step only
+    unsigned long ms = TIME_RESYNC_INTERVAL_MS;
+    ts.update(ms);
+    ts.sync(TimeSource::GPS, T0 + ms + 500, ms);
+    ASSERT_FLOAT_EQ(0.0, ts.getDriftPpm(), 0.0001);
+    ASSERT_EQ(500, ts.getLastStepMs());
+
+    // A GNSS source change over a long span: step only
+    ms += TIME_DRIFT_MIN_SPAN_MS;
+    ts.update(ms);
+    ts.sync(TimeSource::N2K, T0 + ms + 900, ms);
+    ASSERT_FLOAT_EQ(0.0, ts.getDriftPpm(), 0.0001);
+
+    // Same source, minutes of error over an hour: clamped
+    ms += TIME_DRIFT_MIN_SPAN_MS;
+    ts.update(ms);
+    ts.sync(TimeSource::N2K, T0 + ms + 900 + 600000, ms);
+    ASSERT_FLOAT_EQ(TIME_MAX_DRIFT_PPM, ts.getDriftPpm(), 0.0001);
+
+    TEST_PASS();
+}
+
+// Test: UTC formatting and the placeholder have the fixed width back-fill needs
+void test_format_utc() {
+    ASSERT_STR_EQ("2025-01-01T00:00:00Z", TimeService::formatUTC(T0));
+    ASSERT_STR_EQ("2025-01-01T00:00:01Z", TimeService::formatUTC(T0 + 1999));
+    ASSERT_EQ((size_t)TimeService::UTC_LENGTH, strlen(TimeService::UNSYNCED_UTC));
+    ASSERT_EQ((size_t)TimeService::UTC_LENGTH, TimeService::formatUTC(T0).length());
+
+    TimeService ts;
+    ts.sync(TimeSource::GPS, T0, 1000);
+    ts.update(61000);
+    ASSERT_STR_EQ("2025-01-01T00:01:00Z", ts.nowUTC(61000));
+
+    TEST_PASS();
+}
+
+// Test: a placeholder line gets the UTC of its millis; others are left alone
+void test_backfill_stamp_for() {
+    TimeService ts;
+    String stamp;
+    String line = String("5000,") + TimeService::UNSYNCED_UTC + ",,,,0,,Temperature,EZO-RTD,,0,,20.10,C,GOOD";
+
+    // Not synced yet: nothing to write
+    ASSERT_EQ(-1, TimestampBackfill::stampFor(line, ts, 10000, stamp));
+
+    ts.update(65000);
+    ts.sync(TimeSource::GPS, T0, 65000);  // boot was 65 s before T0
+    ASSERT_EQ(5, TimestampBackfill::stampFor(line, ts, 65000, stamp));
+    ASSERT_STR_EQ("2024-12-31T23:59:00Z", stamp);
+
+    // Already stamped, short or malformed lines
+    String stamped = "5000,2025-01-01T00:00:00Z,,,,0,,Temperature";
+    ASSERT_EQ(-1, TimestampBackfill::stampFor(stamped, ts, 65000, stamp));
+    ASSERT_EQ(-1, TimestampBackfill::stampFor(String("5000,0000-00"), ts, 65000, stamp));
+    ASSERT_EQ(-1, TimestampBackfill::stampFor(String(""), ts, 65000, stamp));
+
+    // millis() past 2^31 parses as unsigned
+    ts.update(0x90000000UL);
+    String high = String("2415919104,") + TimeService::UNSYNCED_UTC + ",x";
+    ASSERT_EQ(11, TimestampBackfill::stampFor(high, ts, 0x90000000UL, stamp));
+    ASSERT_STR_EQ(TimeService::formatUTC(ts.epochMs(0x90000000UL)).c_str(), stamp);
+
+    TEST_PASS();
+}
+
+// Test: back-fill cursor starts at the first unsynced line and follows trims
+void test_backfill_cursor() {
+    TimestampBackfill bf;
+    bf.noteWrite(100, false);
+    ASSERT_FALSE(bf.isPending());
+
+    bf.noteWrite(200, true);
+    bf.noteWrite(300, true);
+    ASSERT_TRUE(bf.isPending());
+    ASSERT_EQ(200u, bf._cursor);
+
+    // Trim kept old bytes from 150 on, now starting at 60
+    bf.rebase(150, 60);
+    ASSERT_EQ(110u, bf._cursor);
+
+    // Trim cut past the cursor: resume at the first kept line
+    bf.rebase(500, 60);
+    ASSERT_EQ(60u, bf._cursor);
+
+    bf.reset();
+    ASSERT_FALSE(bf.isPending());
+
+    // Nothing to do until synced
+    TimeService ts;
+    bf.noteWrite(40, true);
+    File f;
+    ASSERT_EQ(0, bf.run(f, ts, 1000, TIME_BACKFILL_BATCH));
+    ASSERT_TRUE(bf.isPending());
+
+    TEST_PASS();
+}
+
+// Test: a data file that keeps failing to open stops blocking after a while
+void test_backfill_gives_up_on_open_failure() {
+    TimestampBackfill bf;
+    bf.noteWrite(0, true);
+
+    ASSERT_FALSE(bf.openFailed(1000));
+    ASSERT_FALSE(bf.openFailed(1000 + TIME_BACKFILL_GIVE_UP_MS - 1));
+    ASSERT_TRUE(bf.isPending());
+
+    ASSERT_TRUE(bf.openFailed(1000 + TIME_BACKFILL_GIVE_UP_MS));
+    ASSERT_FALSE(bf.isPending());
+    ASSERT_EQ(1u, bf.getAbandonedCount());
+
+    // New placeholders after that: a fresh window
+    bf.noteWrite(500, true);
+    ASSERT_FALSE(bf.openFailed(100000));
+    ASSERT_TRUE(bf.isPending());
+
+    ASSERT_TRUE(bf.openFailed(100000 + TIME_BACKFILL_GIVE_UP_MS));
+    ASSERT_FALSE(bf.isPending());
+    ASSERT_EQ(2u, bf.getAbandonedCount());
+
+    // Nothing pending: failures are not counted
+    ASSERT_FALSE(bf.openFailed(500000));
+    ASSERT_EQ(2u, bf.getAbandonedCount());
+
+    TEST_PASS();
+}
+
+int main() {
+    TEST_SUITE("TimeService");
+
+    RUN_TEST(monotonic_wrap);
+    RUN_TEST(stale_update_ignored);
+    RUN_TEST(source_priority);
+    RUN_TEST(resync_rate_limit);
+    RUN_TEST(drift_estimation);
+    RUN_TEST(drift_guards);
+    RUN_TEST(format_utc);
+    RUN_TEST(backfill_stamp_for);
+    RUN_TEST(backfill_cursor);
+    RUN_TEST(backfill_gives_up_on_open_failure);
+
+    TEST_SUMMARY();
+}
@@ -10,6 +10,7 @@
 
 #include <Arduino.h>
 #include "test_framework.h"
+#include "../config/hardware_config.h"
 
 // ============================================================================
 // Extract of APIUploader timing logic (mirrors real implementation exactly)
@@ -54,6 +55,12 @@ struct UploadTimer {
         retryCount++;
     }
 
+    // Timestamp back-fill still running: not a failure
+    void deferForBackfill() {
+        lastScheduledTime = _mock_millis;
+        currentIntervalMs = TIME_BACKFILL_RECHECK_MS;
+    }
+
     void forceUpload() {
         lastScheduledTime = 0;
         currentIntervalMs = 0;
@@ -213,6 +220,32 @@ void test_success_resets_retry() {
     TEST_PASS();
 }
 
+// Test: waiting on the back-fill re-checks soon and leaves the backoff alone
+void test_backfill_defer_keeps_backoff() {
+    _mock_millis = 100000;
+    UploadTimer t;
+    t.configIntervalMs = 300000;
+    t.begin();
+
+    _mock_millis = 500000;
+    t.scheduleRetry();  // retryCount = 1
+    t.scheduleRetry();  // retryCount = 2
+
+    t.deferForBackfill();
+    ASSERT_EQ((uint8_t)2, t.retryCount);
+    ASSERT_EQ((unsigned long)TIME_BACKFILL_RECHECK_MS, t.getTimeUntilNext());
+    _mock_millis += TIME_BACKFILL_RECHECK_MS;
+    ASSERT_TRUE(t.shouldProcess());
+    t.deferForBackfill();
+    ASSERT_EQ((uint8_t)2, t.retryCount);
+
+    // The next real failure continues where the backoff left off
+    t.scheduleRetry();
+    ASSERT_EQ(RETRY_INTERVALS[2], t.currentIntervalMs);
+
+    TEST_PASS();
+}
+
 // Test: timing across millis() rollover
 void test_timing_across_rollover() {
     UploadTimer t;
@@ -290,6 +323,7 @@ int main() {
     RUN_TEST(retry_exponential_backoff);
     RUN_TEST(force_upload_fires_immediately);
     RUN_TEST(success_resets_retry);
+    RUN_TEST(backfill_defer_keeps_backoff);
     RUN_TEST(timing_across_rollover);
     RUN_TEST(retry_across_rollover);
     RUN_TEST(time_until_next_past_due);
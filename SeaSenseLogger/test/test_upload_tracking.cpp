@@ -295,6 +295,65 @@ void test_readRecords_default_skipRecords() {
     TEST_PASS();
 }
 
+// Test: advancing the cursor by acknowledged records leaves the rest pending
+void test_advance_cursor_by_acked_records() {
+    SPIFFSStorage storage(1000);
+    storage._mounted = true;
+    storage._cachedRecordCount = 0;
+
+    for (int i = 0; i < 10; i++) {
+        storage.writeRecord(makeRecord(i * 1000));
+    }
+
+    // Broker acked the first 4 (not persisted yet)
+    storage._metadataDirtyCount = 3;
+    ASSERT_TRUE(storage.advanceUploadCursor(4, 3000, false));
+    ASSERT_EQ((uint16_t)3, storage._metadataDirtyCount);
+    uint32_t total = 0, pending = 0;
+    storage.getUploadProgress(total, pending);
+    ASSERT_EQ((uint32_t)10, total);
+    ASSERT_EQ((uint32_t)6, pending);
+    ASSERT_EQ((unsigned long)3000, storage.getLastUploadedMillis());
+    ASSERT_EQ((uint32_t)6, storage.getStats().recordsSinceUpload);
+
+    // More acked than stored (records trimmed meanwhile): clamped
+    ASSERT_TRUE(storage.advanceUploadCursor(20, 9000));
+    ASSERT_EQ((uint16_t)0, storage._metadataDirtyCount);
+    storage.getUploadProgress(total, pending);
+    ASSERT_EQ((uint32_t)0, pending);
+    ASSERT_EQ((uint32_t)10, storage._metadata.recordsAtLastUpload);
+
+    TEST_PASS();
+}
+
+// Test: trimmed and cleared records keep the numbers of the ones after them
+void test_removed_records_keep_positions() {
+    SPIFFSStorage storage(50);
+    storage._mounted = true;
+
+    // 80 stored, 60 uploaded: the first pending record is number 60
+    storage._cachedRecordCount = 80;
+    storage._metadata.recordsAtLastUpload = 60;
+    ASSERT_EQ((uint32_t)0, storage.getRemovedRecords());
+
+    // Trimming 30 uploaded records renumbers nothing
+    storage.trimOldRecords();
+    ASSERT_EQ((uint32_t)30, storage.getRemovedRecords());
+    ASSERT_EQ((uint32_t)60, storage.getRemovedRecords() + storage._metadata.recordsAtLastUpload);
+
+    // Trimming past the cursor moves the first pending record on
+    storage._cachedRecordCount = 100;
+    storage.trimOldRecords();
+    ASSERT_EQ((uint32_t)80, storage.getRemovedRecords());
+    ASSERT_EQ((uint32_t)0, storage._metadata.recordsAtLastUpload);
+
+    // Clearing removes every stored record
+    storage.clear();
+    ASSERT_EQ((uint32_t)130, storage.getRemovedRecords());
+
+    TEST_PASS();
+}
+
 int main() {
     TEST_SUITE("Upload Tracking (SPIFFSStorage)");
 
@@ -308,6 +367,8 @@ int main() {
     RUN_TEST(total_bytes_uploaded);
     RUN_TEST(readRecords_skipRecords_param);
     RUN_TEST(readRecords_default_skipRecords);
+    RUN_TEST(advance_cursor_by_acked_records);
+    RUN_TEST(removed_records_keep_positions);
 
     TEST_SUMMARY();
 }
@@ -0,0 +1,130 @@
+/**
+ * Host listener for the UDP live broadcast (UdpBroadcaster)
+ *
+ * Binds the NMEA0183 and binary ports on all interfaces and prints what
+ * the logger sends: sentences as received (checksum verified), datagrams
+ * decoded through the firmware's own parser, plus gaps in the datagram
+ * sequence. Run it on a laptop joined to the logger's AP or the boat WiFi.
+ *
+ * Build: make listen
+ * Run:   build/udp_listen [nmea_port] [binary_port]
+ */
+
+#include <Arduino.h>
+#include "../src/broadcast/LiveMessage.h"
+#include "../config/hardware_config.h"
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <string>
+
+static const char* FIELD_NAMES[] = {
+    "water_temp", "conductivity", "ph", "do", "salinity", "sog", "cog",
+    "stw", "depth", "wind_speed", "wind_angle", "air_temp", "baro_pa"
+};
+static_assert(sizeof(FIELD_NAMES) / sizeof(FIELD_NAMES[0]) == (size_t)LiveField::COUNT,
+              "one name per LiveField");
+
+static int openSocket(uint16_t port) {
+    int fd = socket(AF_INET, SOCK_DGRAM, 0);
+    if (fd < 0) {
+        perror("socket");
+        return -1;
+    }
+    int on = 1;
+    setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &on, sizeof(on));
+    setsockopt(fd, SOL_SOCKET, SO_BROADCAST, &on, sizeof(on));
+    sockaddr_in addr = {};
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_ANY);
+    addr.sin_port = htons(port);
+    if (bind(fd, (sockaddr*)&addr, sizeof(addr)) < 0) {
+        perror("bind");
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+static void printNmea(const char* from, const char* data, size_t len) {
+    std::string text(data, len);
+    size_t pos = 0;
+    while (pos < text.size()) {
+        size_t end = text.find("\r\n", pos);
+        if (end == std::string::npos) end = text.size();
+        std::string line = text.substr(pos, end - pos);
+        pos = end + 2;
+        if (line.empty()) continue;
+
+        const char* check = "bad";
+        size_t star = line.find('*');
+        if (line[0] == '$' && star != std::string::npos) {
+            unsigned int sum = strtoul(line.substr(star + 1).c_str(), nullptr, 16);
+            if (sum == nmeaChecksum(line.c_str() + 1, star - 1)) check = "ok";
+        }
+        printf("%-15s nmea   %-40s [%s]\n", from, line.c_str(), check);
+    }
+}
+
+static void printDatagram(const char* from, const uint8_t* data, size_t len, int& lastSeq) {
+    LiveSnapshot snap;
+    uint16_t seq;
+    if (!parseLiveDatagram(data, len, snap, seq)) {
+        printf("%-15s binary %zu bytes, not a live datagram\n", from, len);
+        return;
+    }
+    if (lastSeq >= 0 && seq != (uint16_t)(lastSeq + 1)) {
+        printf("%-15s binary gap: %u datagram(s) missed\n", from, (uint16_t)(seq - lastSeq - 1));
+    }
+    lastSeq = seq;
+
+    printf("%-15s binary seq=%u epoch=%u", from, seq, snap.epoch);
+    if (!isnan(snap.latitude)) {
+        printf(" pos=%.6f,%.6f", snap.latitude, snap.longitude);
+    }
+    for (int i = 0; i < (int)LiveField::COUNT; i++) {
+        if (!isnan(snap.fields[i])) {
+            printf(" %s=%g", FIELD_NAMES[i], snap.fields[i]);
+        }
+    }
+    printf("\n");
+}
+
+int main(int argc, char** argv) {
+    uint16_t nmeaPort = argc > 1 ? (uint16_t)atoi(argv[1]) : UDP_LIVE_NMEA_PORT;
+    uint16_t binaryPort = argc > 2 ? (uint16_t)atoi(argv[2]) : UDP_LIVE_BINARY_PORT;
+
+    pollfd fds[2];
+    fds[0].fd = openSocket(nmeaPort);
+    fds[1].fd = openSocket(binaryPort);
+    if (fds[0].fd < 0 || fds[1].fd < 0) {
+        return 1;
+    }
+    fds[0].events = fds[1].events = POLLIN;
+    printf("Listening: NMEA0183 on UDP %u, binary on UDP %u\n", nmeaPort, binaryPort);
+    fflush(stdout);
+
+    int lastSeq = -1;
+    uint8_t buf[2048];
+    while (poll(fds, 2, -1) > 0) {
+        for (int i = 0; i < 2; i++) {
+            if (!(fds[i].revents & POLLIN)) continue;
+            sockaddr_in src = {};
+            socklen_t srcLen = sizeof(src);
+            ssize_t n = recvfrom(fds[i].fd, buf, sizeof(buf), 0, (sockaddr*)&src, &srcLen);
+            if (n <= 0) continue;
+            char from[INET_ADDRSTRLEN];
+            inet_ntop(AF_INET, &src.sin_addr, from, sizeof(from));
+            if (i == 0) {
+                printNmea(from, (const char*)buf, (size_t)n);
+            } else {
+                printDatagram(from, buf, (size_t)n, lastSeq);
+            }
+        }
+        fflush(stdout);
+    }
+    return 0;
+}